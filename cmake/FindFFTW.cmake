@@ -44,6 +44,18 @@ endif (FFTW_USE_STATIC_LIBS)
       /sw/lib
   )
 
+  # the single precision library is optional, it enables the single precision FFT path
+  find_library(FFTWF_LIBRARY
+    NAMES
+      libfftw3f${LIBFFTW_LIB_SUFFIX}
+      fftw3f
+    PATHS
+      /usr/lib
+      /usr/local/lib
+      /opt/local/lib
+      /sw/lib
+  )
+
   set(FFTW_INCLUDE_DIRS
     ${FFTW_INCLUDE_DIR}
   )
@@ -60,6 +72,9 @@ endif (FFTW_USE_STATIC_LIBS)
       message(STATUS "Found libfftw3:")
 	  message(STATUS " - Includes: ${FFTW_INCLUDE_DIRS}")
 	  message(STATUS " - Libraries: ${FFTW_LIBRARIES}")
+	  if (FFTWF_LIBRARY)
+	    message(STATUS " - Single precision: ${FFTWF_LIBRARY}")
+	  endif (FFTWF_LIBRARY)
     endif (NOT FFTW_FIND_QUIETLY)
   else (FFTW_FOUND)
     if (FFTW_FIND_REQUIRED)
@@ -68,6 +83,6 @@ endif (FFTW_USE_STATIC_LIBS)
   endif (FFTW_FOUND)
 
   # show the FFTW_INCLUDE_DIRS and FFTW_LIBRARIES variables only in the advanced view
-  mark_as_advanced(FFTW_INCLUDE_DIRS FFTW_LIBRARIES)
+  mark_as_advanced(FFTW_INCLUDE_DIRS FFTW_LIBRARIES FFTWF_LIBRARY)
 
 endif (FFTW_LIBRARIES AND FFTW_INCLUDE_DIRS)
@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/// \file benchmarks.cpp
+/// \brief Micro benchmark suite for the hot processing kernels.
+/// Built as the optional `benchmarks` target (cmake -DBUILD_BENCHMARKS=ON), it runs
+/// the raw sample conversion, the trigger search, every math channel mode, the
+/// spectrum window + FFT path and the voltage graph generation on synthetic blocks
+/// of the full SAMPLESIZE record length and prints one timing line per kernel.
+/// The numbers are meant for before/after comparisons on the same machine, e.g.
+/// when touching one of the conversion loops, not as absolute benchmarks.
+/// A tiny self-contained harness (median of repeated timed loops) keeps the suite
+/// free of extra dependencies.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "hantekdso/controlsettings.h"
+#include "hantekdso/controlspecification.h"
+#include "hantekdso/convertsimd.h"
+#include "hantekdso/dsosamples.h"
+#include "hantekdso/mathchannel.h"
+#include "hantekdso/mathmodes.h"
+#include "hantekdso/triggering.h"
+#include "post/graphgenerator.h"
+#include "post/ppresult.h"
+#include "post/processor.h"
+#include "post/spectrumgenerator.h"
+#include "scopesettings.h"
+#include "viewconstants.h"
+#include "viewsettings.h"
+
+#include "golden.h"
+
+
+/// \brief Time one kernel and print its result line.
+/// The body runs once for warmup, then the iteration count is sized so that one
+/// timed loop takes roughly 100 ms; the median of five such loops removes scheduler
+/// noise without the long runtime of a full statistics pass.
+/// \param name The printed kernel name.
+/// \param body The kernel invocation, including its per call argument variation.
+static void benchmark( const char *name, const std::function< void() > &body ) {
+    QElapsedTimer timer;
+    timer.start();
+    body(); // warmup, also measures one call to size the loop
+    qint64 once = std::max( timer.nsecsElapsed(), qint64( 100 ) );
+    unsigned iterations = unsigned( std::min( qint64( 100000 ), std::max( qint64( 1 ), 100000000 / once ) ) );
+    double perCall[ 5 ];
+    for ( double &loop : perCall ) {
+        timer.start();
+        for ( unsigned iteration = 0; iteration < iterations; ++iteration )
+            body();
+        loop = double( timer.nsecsElapsed() ) / iterations;
+    }
+    std::sort( perCall, perCall + 5 );
+    printf( "%-48s %12.2f µs/call  (%u iterations)\n", name, perCall[ 2 ] / 1e3, iterations );
+    fflush( stdout );
+}
+
+
+/// xorshift32, the deterministic noise source also used by the demo mode.
+static uint32_t noiseState = 0x6022A5A5;
+static double noise() {
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return double( noiseState % 1000 ) / 1e5; // 0 .. 0.01 V
+}
+
+
+/// \brief Fill a DSOsamples block with a synthetic two channel signal.
+/// CH1 is a 1 Vpp sine with a little noise (plenty of trigger crossings), CH2 a ramp;
+/// the math channel slot stays empty. The stats and the fixed point companion trace
+/// of CH1 are filled like the raw conversion would, so the trigger search and the
+/// math DC/AC modes take their fast paths.
+static void buildSamples( DSOsamples &samples, double samplerate, bool withTriggerFP ) {
+    const unsigned count = SAMPLESIZE;
+    samples.data.resize( 3 );
+    samples.stats.resize( 3 );
+    std::vector< double > &ch1 = samples.modifiableData( 0 );
+    std::vector< double > &ch2 = samples.modifiableData( 1 );
+    samples.modifiableData( 2 ).clear();
+    ch1.resize( count );
+    ch2.resize( count );
+    for ( unsigned index = 0; index < count; ++index ) {
+        double t = double( index ) / count;
+        ch1[ index ] = 0.5 * sin( 2 * M_PI * 10 * t ) + noise();
+        ch2[ index ] = 1.0 - 2.0 * t;
+    }
+    for ( unsigned channel = 0; channel < 2; ++channel ) {
+        DSOsamples::ChannelStats &stats = samples.stats[ channel ];
+        sampleStatsSimd( samples.data[ channel ]->data(), count, stats.mean, stats.rms, stats.vmin, stats.vmax );
+        stats.valid = true;
+    }
+    if ( withTriggerFP ) { // same scaling as the raw conversion: 128 counts per volt at 1 V/div
+        samples.triggerFPgain = 128.0;
+        samples.triggerFP.resize( count );
+        for ( unsigned index = 0; index < count; ++index )
+            samples.triggerFP[ index ] = int16_t( lround( ch1[ index ] * samples.triggerFPgain ) );
+        samples.triggerFPchannel = 0;
+    } else {
+        samples.triggerFP.clear();
+        samples.triggerFPchannel = -1;
+    }
+    samples.samplerate = samplerate;
+    samples.clipped = 0;
+    samples.tag = 1;
+}
+
+
+/// \brief Fill a PPresult with the synthetic block for the post processing kernels.
+/// The voltage buffers of both channels are shared with the DSOsamples block, the
+/// interval is chosen so that the full record is displayed (dots on screen = record
+/// length divided by the decimation the caller wants to benchmark).
+static void buildResult( PPresult &result, const DSOsamples &samples, double timebase, unsigned dotsOnScreen ) {
+    for ( ChannelID channel = 0; channel < 2; ++channel ) {
+        DataChannel *data = result.modifiableData( channel );
+        data->voltage.samples = samples.data[ channel ];
+        data->voltage.interval = timebase * DIVS_TIME / dotsOnScreen;
+    }
+    result.modifiableData( 2 )->voltage.samples->clear();
+    result.tag = 1;
+}
+
+
+int main( int argc, char **argv ) {
+    QCoreApplication app( argc, argv ); // Qt plumbing (timers, translated enum strings)
+
+    // regression mode: replay a raw stream recording (or the built-in deterministic
+    // stream) through the pipeline kernels and compare against a committed baseline
+    if ( argc > 1 && std::string( argv[ 1 ] ) == "--golden" ) {
+        QString stream = argc > 2 ? QString( argv[ 2 ] ) : QString( "demo" );
+        QString baseline = argc > 3 ? QString( argv[ 3 ] ) : QString( "golden_baseline.txt" );
+        return runGoldenPath( stream, baseline );
+    }
+
+    const double samplerate = 2e6;             // 20000 samples = 10 ms on screen ..
+    const double timebase = 1e-3;              // .. at 1 ms/div
+    DsoSettingsScope scope;
+    scope.voltage.resize( 3 );
+    scope.spectrum.resize( 3 );
+    for ( ChannelID channel = 0; channel < 3; ++channel ) {
+        scope.voltage[ channel ].used = true;
+        scope.spectrum[ channel ].used = channel < 2; // no math spectrum
+    }
+    scope.horizontal.timebase = timebase;
+    scope.horizontal.samplerate = samplerate;
+    scope.horizontal.dotsOnScreen = SAMPLESIZE;
+    scope.toolTipVisible = 0;
+
+    DSOsamples samples;
+    buildSamples( samples, samplerate, true );
+
+    printf( "OpenHantek kernel benchmarks, %d samples per block\n\n", SAMPLESIZE );
+
+    // --- raw ADC byte to voltage conversion (the convertRawDataToSamples() kernels) ---
+    {
+        std::vector< unsigned char > raw( 2 * SAMPLESIZE ); // interleaved two channel block
+        for ( unsigned index = 0; index < SAMPLESIZE; ++index ) {
+            raw[ 2 * index ] = ( unsigned char )( 128 + lround( 100 * sin( 2 * M_PI * 10 * index / SAMPLESIZE ) ) );
+            raw[ 2 * index + 1 ] = ( unsigned char )( index * 255 / SAMPLESIZE );
+        }
+        std::vector< double > out( SAMPLESIZE );
+        benchmark( "convertRawSimd (1 ch of 2, stride 2)", [ & ]() { //
+            convertRawSimd( raw.data(), out.data(), SAMPLESIZE, 2, 130.0, 0.01 );
+        } );
+        benchmark( "rawMinMaxSimd (1 ch of 2, stride 2)", [ & ]() {
+            unsigned char rawMin, rawMax;
+            rawMinMaxSimd( raw.data(), SAMPLESIZE, 2, rawMin, rawMax );
+        } );
+        benchmark( "sampleStatsSimd", [ & ]() {
+            double mean, rms, vmin, vmax;
+            sampleStatsSimd( out.data(), SAMPLESIZE, mean, rms, vmin, vmax );
+        } );
+    }
+    printf( "\n" );
+
+    // --- trigger search (Triggering::searchTriggeredPosition incl. searchTriggerPoint) ---
+    {
+        Dso::ControlSpecification spec( 2 );
+        Dso::ControlSettings control( &spec.samplerate.multi, 2 );
+        control.samplerate.current = samplerate;
+        control.samplerate.target.duration = 5e-3; // half of the block on screen
+        control.trigger.source = 0;
+        control.trigger.level[ 0 ] = 0.0;
+        control.trigger.position = 0.5;
+        unsigned tag = 1;
+        for ( int smooth = 0; smooth < 2; ++smooth ) {
+            control.trigger.smooth = smooth;
+            { // fixed point companion trace available, the fast path of the live stream
+                Triggering triggering( &scope, control );
+                benchmark( smooth ? "trigger search (int16 trace, smooth 1)" : "trigger search (int16 trace, smooth 0)",
+                           [ & ]() { // a fresh tag per call defeats the per block memoization
+                               samples.tag = ++tag;
+                               triggering.searchTriggeredPosition( samples );
+                           } );
+            }
+            { // double trace only, the fallback path (e.g. recalled history blocks)
+                samples.triggerFPchannel = -1;
+                Triggering triggering( &scope, control );
+                benchmark( smooth ? "trigger search (double trace, smooth 1)" : "trigger search (double trace, smooth 0)",
+                           [ & ]() {
+                               samples.tag = ++tag;
+                               triggering.searchTriggeredPosition( samples );
+                           } );
+                samples.triggerFPchannel = 0;
+            }
+        }
+        control.trigger.smooth = 0;
+    }
+    printf( "\n" );
+
+    // --- math channel, one line per mode ---
+    {
+        MathChannel mathChannel( &scope );
+        for ( Dso::MathMode mode : Dso::MathModeEnum ) {
+            scope.voltage[ 2 ].couplingOrMathIndex = unsigned( mode );
+            std::string name = "math " + Dso::mathModeString( mode ).toStdString();
+            benchmark( name.c_str(), [ & ]() { mathChannel.calculate( samples ); } );
+        }
+        scope.voltage[ 2 ].couplingOrMathIndex = 0;
+    }
+    printf( "\n" );
+
+    // --- spectrum window + FFT path ---
+    {
+        DsoSettingsAnalysis analysis; // FFTW_ESTIMATE plans, Hamming window
+        PPresult result( 3 );
+        buildResult( result, samples, timebase, SAMPLESIZE );
+        SpectrumGenerator spectrumGenerator( &scope, &analysis );
+        Processor *processor = &spectrumGenerator;
+        benchmark( "SpectrumGenerator::process (2 ch)", [ & ]() { processor->process( &result ); } );
+#ifdef HAVE_FFTWF
+        analysis.singlePrecisionFft = true;
+        benchmark( "SpectrumGenerator::process (2 ch, single prec)", [ & ]() { processor->process( &result ); } );
+        analysis.singlePrecisionFft = false;
+#endif
+    }
+    printf( "\n" );
+
+    // --- voltage graph generation, with and without sinc upsampling ---
+    {
+        DsoSettingsView view;
+        view.screenWidth = 1920;
+        view.screenHeight = 1080;
+        GraphGenerator graphGenerator( &scope, &view );
+        Processor *processor = &graphGenerator;
+        PPresult result( 3 );
+        buildResult( result, samples, timebase, SAMPLESIZE ); // dense trace, one dot per sample
+        view.interpolation = Dso::INTERPOLATION_OFF;
+        benchmark( "GraphGenerator TY voltage (off)", [ & ]() { processor->process( &result ); } );
+        view.interpolation = Dso::INTERPOLATION_LINEAR;
+        benchmark( "GraphGenerator TY voltage (linear)", [ & ]() { processor->process( &result ); } );
+        view.interpolation = Dso::INTERPOLATION_STEP;
+        benchmark( "GraphGenerator TY voltage (step)", [ & ]() { processor->process( &result ); } );
+        // the sinc upsampler engages only when fewer dots than screen pixels are shown
+        PPresult sparse( 3 );
+        buildResult( sparse, samples, timebase, 500 );
+        view.interpolation = Dso::INTERPOLATION_LINEAR;
+        benchmark( "GraphGenerator TY voltage (500 dots, linear)", [ & ]() { processor->process( &sparse ); } );
+        view.interpolation = Dso::INTERPOLATION_SINC;
+        benchmark( "GraphGenerator TY voltage (500 dots, sinc)", [ & ]() { processor->process( &sparse ); } );
+        view.interpolation = Dso::INTERPOLATION_CATMULLROM;
+        benchmark( "GraphGenerator TY voltage (500 dots, catmull)", [ & ]() { processor->process( &sparse ); } );
+        view.interpolation = Dso::INTERPOLATION_SINC_SHORT;
+        benchmark( "GraphGenerator TY voltage (500 dots, short sinc)", [ & ]() { processor->process( &sparse ); } );
+    }
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/// \file golden.cpp
+/// \brief Golden path regression check of the processing pipeline.
+/// Invoked as `benchmarks --golden [stream] [baseline]`, it replays a raw stream
+/// recording (option --recordStream of the main program) - or a built-in
+/// deterministic stream when no recording is given - through the same kernels the
+/// live pipeline runs: raw conversion, trigger search, math channel and spectrum.
+/// A digest of every stage output plus the measured per stage throughput is
+/// compared against a committed baseline; on the first run the baseline is
+/// written instead. Output digests must match exactly, throughput may degrade up
+/// to the tolerance factor before the check fails, so aggressive kernel changes
+/// (LUT conversion, float FFT, wider SIMD) can be accepted with numbers instead
+/// of eyeballs. Like the benchmark timings, baselines are only meaningful for
+/// one machine and build configuration - different SIMD widths reassociate the
+/// floating point reductions, so a baseline is committed per bench box.
+
+#include "golden.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "hantekdso/controlsettings.h"
+#include "hantekdso/controlspecification.h"
+#include "hantekdso/convertsimd.h"
+#include "hantekdso/dsosamples.h"
+#include "hantekdso/mathchannel.h"
+#include "hantekdso/triggering.h"
+#include "post/analysissettings.h"
+#include "post/ppresult.h"
+#include "post/processor.h"
+#include "post/spectrumgenerator.h"
+#include "scopesettings.h"
+#include "viewconstants.h"
+
+// the raw stream recording format, see CapturingThread::recordBlock()
+static const quint32 rawStreamMagic = 0x4F485253; // "OHRS"
+static const quint32 rawStreamVersion = 1;
+
+/// Throughput may degrade by this factor before the check fails; scheduler noise
+/// on a loaded bench box stays below it, a kernel regression does not.
+static const double throughputTolerance = 1.5;
+
+
+/// One replayed raw block with the metadata the conversion needs.
+struct GoldenBlock {
+    unsigned channels = 2;
+    double samplerate = 0;
+    unsigned gainValue[ 2 ] = { 1, 1 };
+    std::vector< unsigned char > data;
+};
+
+
+/// FNV-1a 64 bit running digest; doubles are quantized to 1e-6 so the digest
+/// pins the numeric output without tripping over the printf rounding of a dump.
+struct Digest {
+    quint64 hash = 0xcbf29ce484222325ULL;
+    void add( quint64 value ) {
+        for ( int byte = 0; byte < 8; ++byte ) {
+            hash ^= ( value >> ( 8 * byte ) ) & 0xFF;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    void add( double value ) { add( quint64( qint64( llround( value * 1e6 ) ) ) ); }
+    void add( const std::vector< double > &values ) {
+        for ( double value : values )
+            add( value );
+    }
+};
+
+
+/// Accumulated busy time and sample count of one pipeline stage.
+struct StageMeter {
+    qint64 ns = 0;
+    quint64 samples = 0;
+    double rate() const { return ns ? double( samples ) * 1e3 / double( ns ) : 0.0; } // MS/s
+};
+
+
+/// \brief Read all blocks of a raw stream recording.
+/// \return false if the file is missing or damaged.
+static bool readStream( const QString &path, std::vector< GoldenBlock > &blocks ) {
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        fprintf( stderr, "golden: cannot open %s\n", qPrintable( path ) );
+        return false;
+    }
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if ( magic != rawStreamMagic || version != rawStreamVersion ) {
+        fprintf( stderr, "golden: not a raw stream recording: %s\n", qPrintable( path ) );
+        return false;
+    }
+    while ( !stream.atEnd() ) {
+        quint32 tag, channels, oversampling, gain[ 2 ], index[ 2 ], received, size;
+        quint64 ns;
+        quint8 freeRun, valid, rollMode;
+        double samplerate;
+        stream >> tag >> ns >> channels >> samplerate >> oversampling >> gain[ 0 ] >> gain[ 1 ] >> index[ 0 ] >> index[ 1 ] >>
+            freeRun >> valid >> rollMode >> received >> size;
+        if ( stream.status() != QDataStream::Ok || 0 == size ) {
+            fprintf( stderr, "golden: damaged raw stream recording: %s\n", qPrintable( path ) );
+            return false;
+        }
+        GoldenBlock block;
+        block.channels = channels ? channels : 1;
+        block.samplerate = samplerate;
+        block.gainValue[ 0 ] = gain[ 0 ] ? gain[ 0 ] : 1;
+        block.gainValue[ 1 ] = gain[ 1 ] ? gain[ 1 ] : 1;
+        block.data.resize( size );
+        if ( stream.readRawData( reinterpret_cast< char * >( block.data.data() ), int( size ) ) != int( size ) ) {
+            fprintf( stderr, "golden: truncated raw stream recording: %s\n", qPrintable( path ) );
+            return false;
+        }
+        blocks.push_back( std::move( block ) );
+    }
+    return !blocks.empty();
+}
+
+
+/// \brief Build the deterministic built-in stream: 20 interleaved two channel
+/// blocks, CH1 a sine with xorshift noise (the demo generator's noise source),
+/// CH2 a ramp - enough trigger crossings and spectral content to exercise every
+/// stage without a checked-in binary recording.
+static void buildDemoStream( std::vector< GoldenBlock > &blocks ) {
+    uint32_t noiseState = 0x6022A5A5;
+    for ( unsigned blockIndex = 0; blockIndex < 20; ++blockIndex ) {
+        GoldenBlock block;
+        block.samplerate = 2e6;
+        block.data.resize( 2 * SAMPLESIZE );
+        for ( unsigned index = 0; index < SAMPLESIZE; ++index ) {
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            double t = double( index ) / SAMPLESIZE;
+            block.data[ 2 * index ] =
+                ( unsigned char )( 128 + lround( 100 * sin( 2 * M_PI * 10 * ( t + 0.1 * blockIndex ) ) ) + int( noiseState % 5 ) );
+            block.data[ 2 * index + 1 ] = ( unsigned char )( index * 255 / SAMPLESIZE );
+        }
+        blocks.push_back( std::move( block ) );
+    }
+}
+
+
+/// \brief Load a baseline file of "name value" lines.
+static bool readBaseline( const QString &path, std::map< QString, QString > &values ) {
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        return false;
+    QTextStream stream( &file );
+    while ( !stream.atEnd() ) {
+        QString line = stream.readLine().trimmed();
+        int space = line.indexOf( ' ' );
+        if ( space > 0 )
+            values[ line.left( space ) ] = line.mid( space + 1 );
+    }
+    return true;
+}
+
+
+int runGoldenPath( const QString &streamPath, const QString &baselinePath ) {
+    std::vector< GoldenBlock > blocks;
+    if ( streamPath == "demo" )
+        buildDemoStream( blocks );
+    else if ( !readStream( streamPath, blocks ) )
+        return 1;
+
+    // the same fixed settings for every run, so the digests pin the kernels only
+    DsoSettingsScope scope;
+    scope.voltage.resize( 3 );
+    scope.spectrum.resize( 3 );
+    for ( ChannelID channel = 0; channel < 3; ++channel ) {
+        scope.voltage[ channel ].used = true;
+        scope.spectrum[ channel ].used = channel < 2;
+    }
+    scope.voltage[ 2 ].couplingOrMathIndex = 0; // first math mode
+    scope.horizontal.timebase = 1e-3;
+    scope.horizontal.samplerate = 2e6;
+    scope.horizontal.dotsOnScreen = SAMPLESIZE;
+    scope.toolTipVisible = 0;
+    Dso::ControlSpecification spec( 2 );
+    Dso::ControlSettings control( &spec.samplerate.multi, 2 );
+    control.trigger.source = 0;
+    control.trigger.level[ 0 ] = 0.0;
+    control.trigger.position = 0.5;
+    DsoSettingsAnalysis analysis;
+    Triggering triggering( &scope, control );
+    MathChannel mathChannel( &scope );
+    SpectrumGenerator spectrumGenerator( &scope, &analysis );
+    Processor *spectrum = &spectrumGenerator;
+
+    Digest convertDigest, triggerDigest, mathDigest, spectrumDigest;
+    StageMeter convertMeter, triggerMeter, mathMeter, spectrumMeter;
+    QElapsedTimer timer;
+    unsigned tag = 0;
+
+    for ( const GoldenBlock &block : blocks ) {
+        const unsigned count = unsigned( block.data.size() ) / block.channels;
+        DSOsamples samples;
+        samples.data.resize( 3 );
+        samples.stats.resize( 3 );
+
+        // raw conversion with a fixed nominal calibration (offset 128, 128 counts
+        // per volt scaled by the block gain), like convertRawDataToSamples() does
+        // with the device calibration applied
+        timer.start();
+        for ( unsigned channel = 0; channel < block.channels && channel < 2; ++channel ) {
+            std::vector< double > &out = samples.modifiableData( channel );
+            out.resize( count );
+            const double scale = 1.0 / ( 128.0 * block.gainValue[ channel ] );
+            if ( convertRawSimd( block.data.data() + channel, out.data(), count, block.channels, 128.0, scale ) )
+                samples.clipped |= 1 << channel;
+            DSOsamples::ChannelStats &stats = samples.stats[ channel ];
+            sampleStatsSimd( out.data(), count, stats.mean, stats.rms, stats.vmin, stats.vmax );
+            stats.valid = true;
+        }
+        // fixed point companion trace of CH1, volts * gain counts like the live conversion
+        samples.triggerFPgain = 128.0 * block.gainValue[ 0 ];
+        samples.triggerFP.resize( count );
+        for ( unsigned index = 0; index < count; ++index )
+            samples.triggerFP[ index ] = int16_t( int( block.data[ index * block.channels ] ) - 128 );
+        samples.triggerFPchannel = 0;
+        samples.samplerate = block.samplerate;
+        samples.tag = ++tag;
+        convertMeter.ns += timer.nsecsElapsed();
+        convertMeter.samples += block.data.size();
+        for ( unsigned channel = 0; channel < 2; ++channel )
+            convertDigest.add( *samples.data[ channel ] );
+
+        // trigger search on the converted block
+        control.samplerate.current = block.samplerate;
+        control.samplerate.target.duration = count / block.samplerate / 2; // half of the block on screen
+        timer.start();
+        int triggeredPosition = triggering.searchTriggeredPosition( samples );
+        triggerMeter.ns += timer.nsecsElapsed();
+        triggerMeter.samples += count;
+        triggerDigest.add( quint64( qint64( triggeredPosition ) ) );
+
+        // math channel, first mode
+        timer.start();
+        mathChannel.calculate( samples );
+        mathMeter.ns += timer.nsecsElapsed();
+        mathMeter.samples += count;
+        if ( samples.data[ 2 ] )
+            mathDigest.add( *samples.data[ 2 ] );
+
+        // spectrum of both channels
+        PPresult result( 3 );
+        for ( ChannelID channel = 0; channel < 2; ++channel ) {
+            DataChannel *data = result.modifiableData( channel );
+            data->voltage.samples = samples.data[ channel ];
+            data->voltage.interval = 1.0 / block.samplerate;
+        }
+        result.modifiableData( 2 )->voltage.samples->clear();
+        result.tag = tag;
+        timer.start();
+        spectrum->process( &result );
+        spectrumMeter.ns += timer.nsecsElapsed();
+        spectrumMeter.samples += 2 * count;
+        for ( ChannelID channel = 0; channel < 2; ++channel )
+            if ( result.data( channel )->spectrum.samples )
+                spectrumDigest.add( *result.data( channel )->spectrum.samples );
+    }
+
+    // collect the current numbers and compare (or create) the baseline
+    struct Row {
+        const char *name;
+        quint64 digest;
+        double rate;
+    } rows[] = { { "convert", convertDigest.hash, convertMeter.rate() },
+                 { "trigger", triggerDigest.hash, triggerMeter.rate() },
+                 { "math", mathDigest.hash, mathMeter.rate() },
+                 { "spectrum", spectrumDigest.hash, spectrumMeter.rate() } };
+
+    std::map< QString, QString > baseline;
+    if ( !readBaseline( baselinePath, baseline ) ) { // first run: record the baseline
+        QFile file( baselinePath );
+        if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+            fprintf( stderr, "golden: cannot write baseline %s\n", qPrintable( baselinePath ) );
+            return 1;
+        }
+        QTextStream stream( &file );
+        stream << "blocks " << blocks.size() << "\n";
+        for ( const Row &row : rows )
+            stream << "digest." << row.name << " " << QString::number( row.digest, 16 ) << "\n"
+                   << "rate." << row.name << " " << QString::number( row.rate, 'f', 1 ) << "\n";
+        printf( "golden: baseline written to %s (%u blocks), commit it to pin the output\n", qPrintable( baselinePath ),
+                unsigned( blocks.size() ) );
+        return 0;
+    }
+
+    int failures = 0;
+    for ( const Row &row : rows ) {
+        const quint64 wantDigest = baseline[ QString( "digest." ) + row.name ].toULongLong( nullptr, 16 );
+        const double wantRate = baseline[ QString( "rate." ) + row.name ].toDouble();
+        const bool digestOk = wantDigest == row.digest;
+        const bool rateOk = row.rate * throughputTolerance >= wantRate;
+        if ( !digestOk || !rateOk )
+            ++failures;
+        printf( "%-10s digest %016llx %s   %8.1f MS/s (baseline %.1f) %s\n", row.name,
+                ( unsigned long long )( row.digest ), digestOk ? "ok  " : "FAIL",
+                row.rate, wantRate, rateOk ? "ok" : "FAIL" );
+    }
+    if ( failures )
+        fprintf( stderr, "golden: %d stage(s) deviate from %s\n", failures, qPrintable( baselinePath ) );
+    return failures ? 1 : 0;
+}
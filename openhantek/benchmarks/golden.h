@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QString>
+
+/// \brief Run the golden path regression check, see golden.cpp.
+/// \param streamPath A raw stream recording (option --recordStream) or "demo" for
+///        the built-in deterministic stream.
+/// \param baselinePath The committed baseline; created if it does not exist yet.
+/// \return 0 on pass (or on a freshly written baseline), 1 on any mismatch.
+int runGoldenPath( const QString &streamPath, const QString &baselinePath );
@@ -27,16 +27,36 @@ DsoConfigAnalysisPage::DsoConfigAnalysisPage( DsoSettings *settings, QWidget *pa
     minimumMagnitudeLayout->addWidget( minimumMagnitudeSpinBox );
     minimumMagnitudeLayout->addWidget( minimumMagnitudeUnitLabel );
 
+    // FFT length decoupled from the record length: shorter transforms slide over the
+    // record as overlapping segments whose power spectra are averaged (Welch's method),
+    // trading frequency resolution for faster updates and a smoother noise floor
+    spectrumLengthLabel = new QLabel( tr( "FFT length" ) );
+    spectrumLengthComboBox = new QComboBox();
+    spectrumLengthComboBox->addItem( tr( "Full record" ), 0 );
+    for ( unsigned length = 512; length <= 16384; length *= 2 )
+        spectrumLengthComboBox->addItem( tr( "%1 points, averaged segments" ).arg( length ), length );
+    int lengthIndex = spectrumLengthComboBox->findData( settings->analysis.spectrumLength );
+    spectrumLengthComboBox->setCurrentIndex( lengthIndex < 0 ? 0 : lengthIndex );
+
     reuseFftPlanCheckBox = new QCheckBox( tr( "Optimize FFT (slower startup, but lower CPU load)" ) );
     reuseFftPlanCheckBox->setChecked( settings->analysis.reuseFftPlan );
 
+    singlePrecisionCheckBox = new QCheckBox( tr( "Single precision FFT (lower CPU load, slightly less accurate)" ) );
+    singlePrecisionCheckBox->setChecked( settings->analysis.singlePrecisionFft );
+#ifndef HAVE_FFTWF // built without libfftw3f, the option would have no effect
+    singlePrecisionCheckBox->setEnabled( false );
+#endif
+
     spectrumLayout = new QGridLayout();
     int row = 0;
     spectrumLayout->addWidget( windowFunctionLabel, row, 0 );
     spectrumLayout->addWidget( windowFunctionComboBox, row, 1 );
     spectrumLayout->addWidget( minimumMagnitudeLabel, ++row, 0 );
     spectrumLayout->addLayout( minimumMagnitudeLayout, row, 1 );
+    spectrumLayout->addWidget( spectrumLengthLabel, ++row, 0 );
+    spectrumLayout->addWidget( spectrumLengthComboBox, row, 1 );
     spectrumLayout->addWidget( reuseFftPlanCheckBox, ++row, 0 );
+    spectrumLayout->addWidget( singlePrecisionCheckBox, ++row, 0 );
     spectrumGroup = new QGroupBox( tr( "Spectrum" ) );
     spectrumGroup->setLayout( spectrumLayout );
 
@@ -122,21 +142,94 @@ DsoConfigAnalysisPage::DsoConfigAnalysisPage( DsoSettings *settings, QWidget *pa
     showNoteCheckBox = new QCheckBox( tr( "Show note values for audio frequencies" ) );
     showNoteCheckBox->setChecked( settings->scope.analysis.showNoteValue );
 
+    // quality knob for the scalar measurements (min/max scan over the displayed trace);
+    // the exported data and the spectrum always keep the full record resolution
+    measurementLabel = new QLabel( tr( "Measurement resolution" ) );
+    measurementComboBox = new QComboBox();
+    measurementComboBox->addItem( tr( "Full (every sample)" ), 1 );
+    measurementComboBox->addItem( tr( "Reduced (every 2nd sample)" ), 2 );
+    measurementComboBox->addItem( tr( "Coarse (every 4th sample)" ), 4 );
+    measurementComboBox->addItem( tr( "Minimal (every 8th sample)" ), 8 );
+    int strideIndex = measurementComboBox->findData( int( settings->analysis.measurementStride ) );
+    measurementComboBox->setCurrentIndex( strideIndex < 0 ? 0 : strideIndex );
+
     analysisLayout = new QGridLayout();
     row = 0;
     analysisLayout->addWidget( dummyLoadCheckbox, row, 0 );
     analysisLayout->addLayout( dummyLoadLayout, row, 1 );
     analysisLayout->addWidget( thdCheckBox, ++row, 0 );
     analysisLayout->addWidget( showNoteCheckBox, ++row, 0 );
+    analysisLayout->addWidget( measurementLabel, ++row, 0 );
+    analysisLayout->addWidget( measurementComboBox, row, 1 );
 
     analysisGroup = new QGroupBox( tr( "Analysis" ) );
     analysisGroup->setLayout( analysisLayout );
 
+    // Protocol decoder group
+    decoderModeLabel = new QLabel( tr( "Protocol" ) );
+    decoderModeComboBox = new QComboBox();
+    decoderModeComboBox->addItem( tr( "Off" ) );
+    decoderModeComboBox->addItem( tr( "UART (8N1)" ) );
+    decoderModeComboBox->addItem( tr( "I2C (SDA + SCL)" ) );
+    decoderModeComboBox->addItem( tr( "SPI (MOSI + SCK)" ) );
+    decoderModeComboBox->setCurrentIndex( int( settings->analysis.decoderMode ) );
+
+    decoderDataLabel = new QLabel( tr( "Data channel (RX / SDA / MOSI)" ) );
+    decoderDataComboBox = new QComboBox();
+    decoderClockLabel = new QLabel( tr( "Clock channel (SCL / SCK)" ) );
+    decoderClockComboBox = new QComboBox();
+    // the scope channels only, the calculated MATH channel has no serial levels
+    for ( ChannelID channel = 0; channel < qMin( settings->scope.countChannels(), ChannelID( 2 ) ); ++channel ) {
+        decoderDataComboBox->addItem( settings->scope.voltage[ channel ].name );
+        decoderClockComboBox->addItem( settings->scope.voltage[ channel ].name );
+    }
+    decoderDataComboBox->setCurrentIndex( int( settings->analysis.decoderDataChannel ) );
+    decoderClockComboBox->setCurrentIndex( int( settings->analysis.decoderClockChannel ) );
+
+    decoderBaudLabel = new QLabel( tr( "UART baud rate (0 = auto)" ) );
+    decoderBaudSpinBox = new QDoubleSpinBox();
+    decoderBaudSpinBox->setDecimals( 0 );
+    decoderBaudSpinBox->setMinimum( 0.0 );
+    decoderBaudSpinBox->setMaximum( 10000000.0 );
+    decoderBaudSpinBox->setValue( settings->analysis.decoderBaud );
+
+    decoderSpiModeLabel = new QLabel( tr( "SPI mode" ) );
+    decoderSpiModeComboBox = new QComboBox();
+    for ( int mode = 0; mode < 4; ++mode )
+        decoderSpiModeComboBox->addItem( tr( "Mode %1" ).arg( mode ) );
+    decoderSpiModeComboBox->setCurrentIndex( int( settings->analysis.decoderSpiMode ) );
+
+    decoderThresholdLabel = new QLabel( tr( "Logic threshold (0 = auto)" ) );
+    decoderThresholdSpinBox = new QDoubleSpinBox();
+    decoderThresholdSpinBox->setDecimals( 2 );
+    decoderThresholdSpinBox->setMinimum( -20.0 );
+    decoderThresholdSpinBox->setMaximum( 20.0 );
+    decoderThresholdSpinBox->setSuffix( tr( " V" ) );
+    decoderThresholdSpinBox->setValue( settings->analysis.decoderThreshold );
+
+    decoderLayout = new QGridLayout();
+    row = 0;
+    decoderLayout->addWidget( decoderModeLabel, row, 0 );
+    decoderLayout->addWidget( decoderModeComboBox, row, 1 );
+    decoderLayout->addWidget( decoderDataLabel, ++row, 0 );
+    decoderLayout->addWidget( decoderDataComboBox, row, 1 );
+    decoderLayout->addWidget( decoderClockLabel, ++row, 0 );
+    decoderLayout->addWidget( decoderClockComboBox, row, 1 );
+    decoderLayout->addWidget( decoderBaudLabel, ++row, 0 );
+    decoderLayout->addWidget( decoderBaudSpinBox, row, 1 );
+    decoderLayout->addWidget( decoderSpiModeLabel, ++row, 0 );
+    decoderLayout->addWidget( decoderSpiModeComboBox, row, 1 );
+    decoderLayout->addWidget( decoderThresholdLabel, ++row, 0 );
+    decoderLayout->addWidget( decoderThresholdSpinBox, row, 1 );
+    decoderGroup = new QGroupBox( tr( "Protocol decoder" ) );
+    decoderGroup->setLayout( decoderLayout );
+
     // Put all in the main layout
     mainLayout = new QVBoxLayout();
     mainLayout->addWidget( referenceGroup );
     mainLayout->addWidget( spectrumGroup );
     mainLayout->addWidget( analysisGroup );
+    mainLayout->addWidget( decoderGroup );
     mainLayout->addWidget( cursorsGroup );
     mainLayout->addStretch( 1 );
 
@@ -150,10 +243,19 @@ void DsoConfigAnalysisPage::saveSettings() {
     settings->scope.analysis.spectrumReference = referenceLevelSpinBox->value();
     settings->analysis.spectrumWindow = Dso::WindowFunction( windowFunctionComboBox->currentIndex() );
     settings->analysis.spectrumLimit = minimumMagnitudeSpinBox->value();
+    settings->analysis.spectrumLength = spectrumLengthComboBox->currentData().toUInt();
     settings->analysis.reuseFftPlan = reuseFftPlanCheckBox->isChecked();
+    settings->analysis.singlePrecisionFft = singlePrecisionCheckBox->isChecked();
     settings->scope.analysis.calculateDummyLoad = dummyLoadCheckbox->isChecked();
     settings->scope.analysis.dummyLoad = unsigned( dummyLoadSpinBox->value() );
     settings->scope.analysis.calculateTHD = thdCheckBox->isChecked();
     settings->scope.analysis.showNoteValue = showNoteCheckBox->isChecked();
+    settings->analysis.measurementStride = measurementComboBox->currentData().toUInt();
+    settings->analysis.decoderMode = Dso::DecoderMode( decoderModeComboBox->currentIndex() );
+    settings->analysis.decoderDataChannel = unsigned( decoderDataComboBox->currentIndex() );
+    settings->analysis.decoderClockChannel = unsigned( decoderClockComboBox->currentIndex() );
+    settings->analysis.decoderBaud = decoderBaudSpinBox->value();
+    settings->analysis.decoderSpiMode = unsigned( decoderSpiModeComboBox->currentIndex() );
+    settings->analysis.decoderThreshold = decoderThresholdSpinBox->value();
     settings->view.cursorGridPosition = Qt::ToolBarArea( cursorsComboBox->currentData().toUInt() );
 }
@@ -56,7 +56,11 @@ class DsoConfigAnalysisPage : public QWidget {
     QLabel *minimumMagnitudeUnitLabel;
     QHBoxLayout *minimumMagnitudeLayout;
 
+    QLabel *spectrumLengthLabel;
+    QComboBox *spectrumLengthComboBox;
+
     QCheckBox *reuseFftPlanCheckBox;
+    QCheckBox *singlePrecisionCheckBox;
     QCheckBox *showNoteCheckBox;
 
     QGroupBox *analysisGroup;
@@ -73,4 +77,22 @@ class DsoConfigAnalysisPage : public QWidget {
     QHBoxLayout *dummyLoadLayout;
 
     QCheckBox *thdCheckBox;
+
+    QLabel *measurementLabel;
+    QComboBox *measurementComboBox;
+
+    QGroupBox *decoderGroup;
+    QGridLayout *decoderLayout;
+    QLabel *decoderModeLabel;
+    QComboBox *decoderModeComboBox;
+    QLabel *decoderDataLabel;
+    QComboBox *decoderDataComboBox;
+    QLabel *decoderClockLabel;
+    QComboBox *decoderClockComboBox;
+    QLabel *decoderBaudLabel;
+    QDoubleSpinBox *decoderBaudSpinBox;
+    QLabel *decoderSpiModeLabel;
+    QComboBox *decoderSpiModeComboBox;
+    QLabel *decoderThresholdLabel;
+    QDoubleSpinBox *decoderThresholdSpinBox;
 };
@@ -148,12 +148,47 @@ DsoConfigColorsPage::DsoConfigColorsPage( DsoSettings *settings, QWidget *parent
     colorsGroup = new QGroupBox( tr( "Screen and Print Colors" ) );
     colorsGroup->setLayout( colorsLayout );
 
+    // Static previews of both schemes, the live scope stays untouched while editing
+    screenPreview = new ColorPreview( colorSettings.screen );
+    printPreview = new ColorPreview( colorSettings.print );
+    previewLayout = new QHBoxLayout();
+    previewLayout->addWidget( screenPreview );
+    previewLayout->addWidget( printPreview );
+    previewGroup = new QGroupBox( tr( "Preview (screen and print)" ) );
+    previewGroup->setLayout( previewLayout );
+
     // Main layout
     mainLayout = new QVBoxLayout();
     mainLayout->addWidget( colorsGroup );
+    mainLayout->addWidget( previewGroup );
     mainLayout->addStretch( 1 );
 
     setLayout( mainLayout );
+
+    // The previews follow each color tweak; DsoWidget and GlScope get the final
+    // scheme in one batch when the dialog applies the settings.
+    connect( backgroundColorBox, &ColorBox::colorChanged, screenPreview, &ColorPreview::setBackground );
+    connect( gridColorBox, &ColorBox::colorChanged, screenPreview, &ColorPreview::setGrid );
+    connect( axesColorBox, &ColorBox::colorChanged, screenPreview, &ColorPreview::setAxes );
+    connect( borderColorBox, &ColorBox::colorChanged, screenPreview, &ColorPreview::setBorder );
+    connect( markersColorBox, &ColorBox::colorChanged, screenPreview, &ColorPreview::setMarkers );
+    connect( textColorBox, &ColorBox::colorChanged, screenPreview, &ColorPreview::setText );
+    connect( printBackgroundColorBox, &ColorBox::colorChanged, printPreview, &ColorPreview::setBackground );
+    connect( printGridColorBox, &ColorBox::colorChanged, printPreview, &ColorPreview::setGrid );
+    connect( printAxesColorBox, &ColorBox::colorChanged, printPreview, &ColorPreview::setAxes );
+    connect( printBorderColorBox, &ColorBox::colorChanged, printPreview, &ColorPreview::setBorder );
+    connect( printMarkersColorBox, &ColorBox::colorChanged, printPreview, &ColorPreview::setMarkers );
+    connect( printTextColorBox, &ColorBox::colorChanged, printPreview, &ColorPreview::setText );
+    for ( ChannelID channel = 0; channel < settings->scope.voltage.size(); ++channel ) {
+        connect( screenChannelColorBox[ channel ], &ColorBox::colorChanged, screenPreview,
+                 [ this, channel ]( QColor color ) { screenPreview->setVoltage( channel, color ); } );
+        connect( screenSpectrumColorBox[ channel ], &ColorBox::colorChanged, screenPreview,
+                 [ this, channel ]( QColor color ) { screenPreview->setSpectrum( channel, color ); } );
+        connect( printChannelColorBox[ channel ], &ColorBox::colorChanged, printPreview,
+                 [ this, channel ]( QColor color ) { printPreview->setVoltage( channel, color ); } );
+        connect( printSpectrumColorBox[ channel ], &ColorBox::colorChanged, printPreview,
+                 [ this, channel ]( QColor color ) { printPreview->setSpectrum( channel, color ); } );
+    }
 }
 
 /// \brief Saves the new settings.
@@ -15,6 +15,7 @@
 #include <QDebug>
 
 #include "colorbox.h"
+#include "colorpreview.h"
 #include "dsosettings.h"
 
 
@@ -60,4 +61,9 @@ class DsoConfigColorsPage : public QWidget {
     QLabel *themeLabel;
     QComboBox *themeComboBox;
     QGridLayout *themeLayout;
+
+    QGroupBox *previewGroup;
+    QHBoxLayout *previewLayout;
+    ColorPreview *screenPreview; ///< Static demo trace in the edited screen colors
+    ColorPreview *printPreview;  ///< Static demo trace in the edited print colors
 };
@@ -1,11 +1,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "DsoConfigScopePage.h"
+#include <QThread>
 
 DsoConfigScopePage::DsoConfigScopePage( DsoSettings *settings, QWidget *parent ) : QWidget( parent ), settings( settings ) {
     // Initialize lists for comboboxes
     QStringList interpolationStrings;
-    interpolationStrings << tr( "Off" ) << tr( "Linear" ) << tr( "Step" ) << tr( "Sinc" );
+    // list order must match Dso::InterpolationMode, the ladder rungs are appended
+    interpolationStrings << tr( "Off" ) << tr( "Linear" ) << tr( "Step" ) << tr( "Sinc" ) << tr( "Catmull-Rom" )
+                         << tr( "Sinc (short)" );
     QList< double > timebaseSteps = { 1.0, 2.0, 5.0, 10.0 };
 
     // Horizontal group
@@ -99,6 +102,20 @@ DsoConfigScopePage::DsoConfigScopePage( DsoSettings *settings, QWidget *parent )
     } else {
         configurationLayout->addWidget( hasACmodificationCheckBox, ++row, 0, 1, 2 ); // show it
     }
+#ifdef Q_OS_LINUX
+    captureCoreLabel = new QLabel( tr( "Pin capture and USB transfers to CPU core, -1 = off<br/>"
+                                       "(restart needed to apply the change)" ) );
+    captureCoreSpinBox = new QSpinBox();
+    captureCoreSpinBox->setMinimum( -1 );
+    captureCoreSpinBox->setMaximum( QThread::idealThreadCount() - 1 );
+    captureCoreSpinBox->setValue( settings->scope.captureCpuCore );
+    captureRealTimeCheckBox = new QCheckBox( tr( "Capture with realtime priority, needs realtime rights "
+                                                 "(restart needed to apply the change)" ) );
+    captureRealTimeCheckBox->setChecked( settings->scope.captureRealTime );
+    configurationLayout->addWidget( captureCoreLabel, ++row, 0 );
+    configurationLayout->addWidget( captureCoreSpinBox, row, 1 );
+    configurationLayout->addWidget( captureRealTimeCheckBox, ++row, 0, 1, 2 );
+#endif
     configurationGroup = new QGroupBox( tr( "Configuration" ) );
     configurationGroup->setLayout( configurationLayout );
 
@@ -116,6 +133,10 @@ DsoConfigScopePage::DsoConfigScopePage( DsoSettings *settings, QWidget *parent )
 /// \brief Saves the new settings.
 void DsoConfigScopePage::saveSettings() {
     settings->scope.hasACmodification = hasACmodificationCheckBox->isChecked();
+#ifdef Q_OS_LINUX
+    settings->scope.captureCpuCore = captureCoreSpinBox->value();
+    settings->scope.captureRealTime = captureRealTimeCheckBox->isChecked();
+#endif
     settings->scope.toolTipVisible = toolTipVisibleCheckBox->isChecked();
     settings->scope.horizontal.maxTimebase = maxTimebaseSiSpinBox->value();
     settings->scope.horizontal.acquireInterval = acquireIntervalSiSpinBox->value();
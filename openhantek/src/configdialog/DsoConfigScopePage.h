@@ -52,6 +52,11 @@ class DsoConfigScopePage : public QWidget {
     QGroupBox *configurationGroup;
     QGridLayout *configurationLayout;
     QCheckBox *hasACmodificationCheckBox;
+#ifdef Q_OS_LINUX
+    QLabel *captureCoreLabel;
+    QSpinBox *captureCoreSpinBox;
+    QCheckBox *captureRealTimeCheckBox;
+#endif
     QCheckBox *saveOnExitCheckBox;
     QCheckBox *defaultSettingsCheckBox;
     QCheckBox *toolTipVisibleCheckBox;
@@ -41,13 +41,9 @@ DsoConfigDialog::DsoConfigDialog( DsoSettings *settings, QWidget *parent ) : QDi
     contentsWidget->setMinimumWidth( CONFIG_LIST_WIDTH );
     contentsWidget->setMinimumHeight( CONFIG_LIST_ITEMHEIGHT * 3 + 2 * ( contentsWidget->frameWidth() ) );
 
+    // the pages are created lazily in changePage() when they are selected for the
+    // first time, opening the dialog only pays for the initially shown scope page
     pagesWidget = new QStackedWidget;
-    scopePage = new DsoConfigScopePage( settings );
-    pagesWidget->addWidget( scopePage );
-    analysisPage = new DsoConfigAnalysisPage( settings );
-    pagesWidget->addWidget( analysisPage );
-    colorsPage = new DsoConfigColorsPage( settings );
-    pagesWidget->addWidget( colorsPage );
 
     acceptButton = new QPushButton( tr( "&Ok" ) );
     acceptButton->setDefault( true );
@@ -119,11 +115,15 @@ void DsoConfigDialog::accept() {
 }
 
 
-/// \brief Saves the settings.
+/// \brief Saves the settings of all pages that were shown (and possibly edited).
 void DsoConfigDialog::apply() {
-    scopePage->saveSettings();
-    analysisPage->saveSettings();
-    colorsPage->saveSettings();
+    if ( scopePage )
+        scopePage->saveSettings();
+    if ( analysisPage )
+        analysisPage->saveSettings();
+    if ( colorsPage )
+        colorsPage->saveSettings();
+    emit settingsSaved();
 }
 
 
@@ -133,5 +133,21 @@ void DsoConfigDialog::apply() {
 void DsoConfigDialog::changePage( QListWidgetItem *current, QListWidgetItem *previous ) {
     if ( !current )
         current = previous;
-    pagesWidget->setCurrentIndex( contentsWidget->row( current ) );
+    switch ( contentsWidget->row( current ) ) {
+    case 0:
+        if ( !scopePage )
+            pagesWidget->addWidget( scopePage = new DsoConfigScopePage( settings ) );
+        pagesWidget->setCurrentWidget( scopePage );
+        break;
+    case 1:
+        if ( !analysisPage )
+            pagesWidget->addWidget( analysisPage = new DsoConfigAnalysisPage( settings ) );
+        pagesWidget->setCurrentWidget( analysisPage );
+        break;
+    case 2:
+        if ( !colorsPage )
+            pagesWidget->addWidget( colorsPage = new DsoConfigColorsPage( settings ) );
+        pagesWidget->setCurrentWidget( colorsPage );
+        break;
+    }
 }
@@ -43,10 +43,14 @@ class DsoConfigDialog : public QDialog {
     QListWidget *contentsWidget;
     QStackedWidget *pagesWidget;
 
-    DsoConfigScopePage *scopePage;
-    DsoConfigAnalysisPage *analysisPage;
-    DsoConfigColorsPage *colorsPage;
+    // created on first selection, nullptr until then
+    DsoConfigScopePage *scopePage = nullptr;
+    DsoConfigAnalysisPage *analysisPage = nullptr;
+    DsoConfigColorsPage *colorsPage = nullptr;
 
     QPushButton *acceptButton, *applyButton, *rejectButton;
     QShortcut *rejectShortcut;
+
+  signals:
+    void settingsSaved(); ///< The edited settings were written back by apply()
 };
@@ -59,6 +59,19 @@ HorizontalDock::HorizontalDock( DsoSettingsScope *scope, const Dso::ControlSpeci
     for ( Dso::GraphFormat format : Dso::GraphFormatEnum )
         formatComboBox->addItem( Dso::graphFormatString( format ) );
 
+    recordLengthLabel = new QLabel( tr( "Record length" ) );
+    // 0 = classic 20 kS capture, bigger values enable the deep memory mode
+    recordLengthSteps << 0 << 1000000 << 2000000 << 4000000 << 8000000 << 16000000;
+    recordLengthComboBox = new QComboBox();
+    if ( scope->toolTipVisible )
+        recordLengthComboBox->setToolTip( tr( "Deep memory: capture up to 16 MS in one block" ) );
+    for ( int recordLengthStep : qAsConst( recordLengthSteps ) ) {
+        if ( recordLengthStep )
+            recordLengthComboBox->addItem( valueToString( recordLengthStep, UNIT_SAMPLES, 3 ) );
+        else
+            recordLengthComboBox->addItem( tr( "Standard" ) );
+    }
+
     calfreqLabel = new QLabel( tr( "Calibration out" ) );
     calfreqSteps = spec->calfreqSteps;
     std::reverse( calfreqSteps.begin(), calfreqSteps.end() ); // put highest value on top of the list
@@ -68,6 +81,22 @@ HorizontalDock::HorizontalDock( DsoSettingsScope *scope, const Dso::ControlSpeci
     for ( double calfreqStep : qAsConst( calfreqSteps ) )
         calfreqComboBox->addItem( valueToString( calfreqStep, UNIT_HERTZ, calfreqStep < 10e3 ? 2 : 0 ) );
 
+    averageLabel = new QLabel( tr( "Average" ) );
+    averageSteps << 1 << 2 << 4 << 8 << 16 << 32 << 64 << 128 << 256;
+    averageComboBox = new QComboBox();
+    if ( scope->toolTipVisible )
+        averageComboBox->setToolTip( tr( "Reduce noise by averaging this many trigger aligned frames" ) );
+    for ( int averageStep : qAsConst( averageSteps ) ) {
+        if ( averageStep > 1 )
+            averageComboBox->addItem( tr( "%1 frames" ).arg( averageStep ) );
+        else
+            averageComboBox->addItem( tr( "Off" ) );
+    }
+
+    envelopeCheckBox = new QCheckBox( tr( "Envelope" ) );
+    if ( scope->toolTipVisible )
+        envelopeCheckBox->setToolTip( tr( "Accumulate a min/max band over all triggered frames to catch rare excursions" ) );
+
     dockLayout = new QGridLayout();
     dockLayout->setColumnMinimumWidth( 0, 64 );
     dockLayout->setColumnStretch( 1, 1 );
@@ -78,10 +107,15 @@ HorizontalDock::HorizontalDock( DsoSettingsScope *scope, const Dso::ControlSpeci
     dockLayout->addWidget( timebaseSiSpinBox, row++, 1 );
     dockLayout->addWidget( samplerateLabel, row, 0 );
     dockLayout->addWidget( samplerateSiSpinBox, row++, 1 );
+    dockLayout->addWidget( recordLengthLabel, row, 0 );
+    dockLayout->addWidget( recordLengthComboBox, row++, 1 );
     dockLayout->addWidget( formatLabel, row, 0 );
     dockLayout->addWidget( formatComboBox, row++, 1 );
     dockLayout->addWidget( calfreqLabel, row, 0 );
     dockLayout->addWidget( calfreqComboBox, row++, 1 );
+    dockLayout->addWidget( averageLabel, row, 0 );
+    dockLayout->addWidget( averageComboBox, row++, 1 );
+    dockLayout->addWidget( envelopeCheckBox, row++, 1 );
 
     dockWidget = new QWidget();
     SetupDockWidget( this, dockWidget, dockLayout );
@@ -94,10 +128,15 @@ HorizontalDock::HorizontalDock( DsoSettingsScope *scope, const Dso::ControlSpeci
              [ this ]( double samplerate ) { this->samplerateSelected( samplerate ); } );
     connect( timebaseSiSpinBox, SELECT< double >::OVERLOAD_OF( &QDoubleSpinBox::valueChanged ), this,
              [ this ]( double timebase ) { this->timebaseSelected( timebase ); } );
+    connect( recordLengthComboBox, SELECT< int >::OVERLOAD_OF( &QComboBox::currentIndexChanged ), this,
+             [ this ]( int index ) { this->recordLengthSelected( index ); } );
     connect( formatComboBox, SELECT< int >::OVERLOAD_OF( &QComboBox::currentIndexChanged ), this,
              [ this ]( int index ) { this->formatSelected( index ); } );
     connect( calfreqComboBox, SELECT< int >::OVERLOAD_OF( &QComboBox::currentIndexChanged ), this,
              [ this ]( int index ) { this->calfreqIndexSelected( index ); } );
+    connect( averageComboBox, SELECT< int >::OVERLOAD_OF( &QComboBox::currentIndexChanged ), this,
+             [ this ]( int index ) { this->averageSelected( index ); } );
+    connect( envelopeCheckBox, &QCheckBox::toggled, this, [ this ]( bool checked ) { this->envelopeChecked( checked ); } );
 }
 
 
@@ -105,8 +144,11 @@ void HorizontalDock::loadSettings( DsoSettingsScope *scope ) {
     // Set values
     setSamplerate( scope->horizontal.samplerate );
     setTimebase( scope->horizontal.timebase );
+    setRecordLength( scope->horizontal.recordLength );
     setFormat( scope->horizontal.format );
     setCalfreq( scope->horizontal.calfreq );
+    setAverage( scope->horizontal.acquireAverage );
+    setEnvelope( scope->horizontal.acquireEnvelope );
 }
 
 
@@ -158,6 +200,17 @@ double HorizontalDock::setTimebase( double timebase ) {
 }
 
 
+void HorizontalDock::setRecordLength( int recordLength ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  HDock::setRecordLength()" << recordLength;
+    int index = recordLengthSteps.indexOf( recordLength );
+    if ( index < 0 )
+        return;
+    QSignalBlocker blocker( recordLengthComboBox );
+    recordLengthComboBox->setCurrentIndex( index );
+}
+
+
 int HorizontalDock::setFormat( Dso::GraphFormat format ) {
     if ( scope->verboseLevel > 2 )
         qDebug() << "  HDock::setFormat()" << format;
@@ -183,6 +236,25 @@ double HorizontalDock::setCalfreq( double calfreq ) {
 }
 
 
+void HorizontalDock::setAverage( unsigned average ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  HDock::setAverage()" << average;
+    int index = averageSteps.indexOf( int( average ) );
+    if ( index < 0 )
+        index = 0; // unsupported depth, fall back to "Off"
+    QSignalBlocker blocker( averageComboBox );
+    averageComboBox->setCurrentIndex( index );
+}
+
+
+void HorizontalDock::setEnvelope( bool envelope ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  HDock::setEnvelope()" << envelope;
+    QSignalBlocker blocker( envelopeCheckBox );
+    envelopeCheckBox->setChecked( envelope );
+}
+
+
 void HorizontalDock::setSamplerateLimits( double minimum, double maximum ) {
     if ( scope->verboseLevel > 2 )
         qDebug() << "  HDock::setSamplerateLimits()" << minimum << maximum;
@@ -271,6 +343,17 @@ void HorizontalDock::calculateSamplerateSteps( double timebase ) {
 }
 
 
+/// \brief Called when the record length combo box changes its value.
+/// \param index The index of the combo box item.
+void HorizontalDock::recordLengthSelected( int index ) {
+    int recordLength = recordLengthSteps[ index ];
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  HDock::recordLengthSelected()" << index << recordLength;
+    scope->horizontal.recordLength = recordLength;
+    emit recordLengthChanged( recordLength );
+}
+
+
 /// \brief Called when the format combo box changes its value.
 /// \param index The index of the combo box item.
 void HorizontalDock::formatSelected( int index ) {
@@ -290,3 +373,23 @@ void HorizontalDock::calfreqIndexSelected( int index ) {
     scope->horizontal.calfreq = calfreq;
     emit calfreqChanged( calfreq );
 }
+
+
+/// \brief Called when the average combobox changes its value.
+/// \param index The item index.
+void HorizontalDock::averageSelected( int index ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  HDock::averageSelected()" << index << averageSteps[ index ];
+    // no signal needed, the acquisition reads the setting with every frame
+    scope->horizontal.acquireAverage = unsigned( averageSteps[ index ] );
+}
+
+
+/// \brief Called when the envelope checkbox is toggled.
+/// \param checked true to accumulate the min/max band.
+void HorizontalDock::envelopeChecked( bool checked ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  HDock::envelopeChecked()" << checked;
+    // no signal needed, the acquisition reads the setting with every frame
+    scope->horizontal.acquireEnvelope = checked;
+}
@@ -58,6 +58,12 @@ class HorizontalDock : public QDockWidget {
     /// \brief Changes the calibration frequency.
     /// \param calfreq The calibration frequency in hertz.
     double setCalfreq( double calfreq );
+    /// \brief Changes the acquisition average depth if the value is supported.
+    /// \param average The number of trigger aligned frames to average, 1 = off.
+    void setAverage( unsigned average );
+    /// \brief Switches the acquisition envelope (min/max band) accumulation.
+    /// \param envelope true to accumulate and display the band.
+    void setEnvelope( bool envelope );
 
   public slots:
     /// \brief Loads settings into GUI
@@ -75,22 +81,32 @@ class HorizontalDock : public QDockWidget {
     QLabel *calfreqLabel;           ///< The label for the calibration frequency spinbox
     SiSpinBox *samplerateSiSpinBox; ///< Selects the samplerate for acquisitions
     SiSpinBox *timebaseSiSpinBox;   ///< Selects the timebase for voltage graphs
+    QLabel *recordLengthLabel;      ///< The label for the record length combobox
     QComboBox *formatComboBox;      ///< Selects the way the sampled data is
                                     ///  interpreted and shown
+    QComboBox *recordLengthComboBox; ///< Selects the capture depth (deep memory mode)
     QComboBox *calfreqComboBox;     ///< Selects the calibration frequency
+    QLabel *averageLabel;           ///< The label for the average combobox
+    QComboBox *averageComboBox;     ///< Selects the acquisition average depth
+    QCheckBox *envelopeCheckBox;    ///< Switches the acquisition envelope band
 
     DsoSettingsScope *scope;         ///< The settings provided by the parent class
     QList< double > timebaseSteps;   ///< Steps for the timebase spinbox
     QList< double > calfreqSteps;    ///< Steps for the calfreq spinbox
     QList< double > samplerateSteps; ///< Possible sampe rates
+    QList< int > recordLengthSteps;  ///< Selectable record lengths, 0 = standard 20 kS
+    QList< int > averageSteps;       ///< Selectable average depths, 1 = off
 
     QStringList formatStrings; ///< Strings for the formats
 
   protected slots:
     void samplerateSelected( double samplerate );
     void timebaseSelected( double timebase );
+    void recordLengthSelected( int index );
     void formatSelected( int index );
     void calfreqIndexSelected( int index );
+    void averageSelected( int index );
+    void envelopeChecked( bool checked );
 
   private:
     double samplerateRequest = 0;
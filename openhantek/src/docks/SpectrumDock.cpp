@@ -35,6 +35,7 @@ SpectrumDock::SpectrumDock( DsoSettingsScope *scope, QWidget *parent ) : QDockWi
     magnitudeSteps = { 1, 2, 3, 6, 10, 20, 40, 60, 80, 100 };
     for ( const auto &magnitude : magnitudeSteps )
         magnitudeStrings << valueToString( magnitude, UNIT_DECIBEL, 0 );
+    modeStrings << tr( "Normal" ) << tr( "Average" ) << tr( "Max hold" );
 
     dockLayout = new QGridLayout();
     dockLayout->setColumnMinimumWidth( 0, 64 );
@@ -48,6 +49,9 @@ SpectrumDock::SpectrumDock( DsoSettingsScope *scope, QWidget *parent ) : QDockWi
         b.magnitudeComboBox = ( new QComboBox() );
         if ( scope->toolTipVisible )
             b.magnitudeComboBox->setToolTip( tr( "Magnitude per vertical screen division" ) );
+        b.modeComboBox = ( new QComboBox() );
+        if ( scope->toolTipVisible )
+            b.modeComboBox->setToolTip( tr( "Accumulation of consecutive spectra" ) );
         QString name = scope->spectrum[ channel ].name;
         name.insert( int( channel ), '&' ); // &SP1, S&P2, SP&M
         b.usedCheckBox = ( new QCheckBox( name ) );
@@ -56,8 +60,10 @@ SpectrumDock::SpectrumDock( DsoSettingsScope *scope, QWidget *parent ) : QDockWi
 
         dockLayout->addWidget( b.usedCheckBox, int( channel ), 0 );
         dockLayout->addWidget( b.magnitudeComboBox, int( channel ), 1 );
+        dockLayout->addWidget( b.modeComboBox, int( channel ), 2 );
 
         b.magnitudeComboBox->addItems( magnitudeStrings );
+        b.modeComboBox->addItems( modeStrings );
 
         // Connect signals and slots
         connect( b.usedCheckBox, &QCheckBox::toggled, this, [ this, channel ]( bool checked ) {
@@ -72,6 +78,13 @@ SpectrumDock::SpectrumDock( DsoSettingsScope *scope, QWidget *parent ) : QDockWi
                          this->setMagnitude( channel, this->magnitudeSteps.at( index ) );
                      }
                  } );
+
+        connect( b.modeComboBox, SELECT< int >::OVERLOAD_OF( &QComboBox::currentIndexChanged ), this,
+                 [ this, channel ]( int index ) {
+                     if ( channel < this->scope->voltage.size() ) {
+                         this->setMode( channel, SpectrumMode( index ) );
+                     }
+                 } );
     }
     frequencybaseLabel = new QLabel( tr( "Frequencybase" ) );
     frequencybaseSiSpinBox = new SiSpinBox( UNIT_HERTZ );
@@ -84,6 +97,35 @@ SpectrumDock::SpectrumDock( DsoSettingsScope *scope, QWidget *parent ) : QDockWi
     connect( frequencybaseSiSpinBox, SELECT< double >::OVERLOAD_OF( &QDoubleSpinBox::valueChanged ), this,
              [ this ]() { this->frequencybaseSelected( this->frequencybaseSiSpinBox->value() ); } );
 
+    // Zoom FFT: narrowband analysis around a center frequency
+    zoomCheckBox = new QCheckBox( tr( "Zoom" ) );
+    if ( scope->toolTipVisible )
+        zoomCheckBox->setToolTip( tr( "Analyze only a narrow band around the center frequency" ) );
+    zoomCenterSiSpinBox = new SiSpinBox( UNIT_HERTZ );
+    if ( scope->toolTipVisible )
+        zoomCenterSiSpinBox->setToolTip( tr( "Center frequency of the zoomed band" ) );
+    zoomCenterSiSpinBox->setMinimum( 1 );
+    zoomCenterSiSpinBox->setMaximum( 15e6 );
+    zoomSpanLabel = new QLabel( tr( "Span" ) );
+    zoomSpanSiSpinBox = new SiSpinBox( UNIT_HERTZ );
+    if ( scope->toolTipVisible )
+        zoomSpanSiSpinBox->setToolTip( tr( "Width of the zoomed band" ) );
+    zoomSpanSiSpinBox->setMinimum( 1 );
+    zoomSpanSiSpinBox->setMaximum( 1e6 );
+    dockLayout->addWidget( zoomCheckBox, int( channel ) + 1, 0 );
+    dockLayout->addWidget( zoomCenterSiSpinBox, int( channel ) + 1, 1 );
+    dockLayout->addWidget( zoomSpanLabel, int( channel ) + 2, 0 );
+    dockLayout->addWidget( zoomSpanSiSpinBox, int( channel ) + 2, 1 );
+    connect( zoomCheckBox, &QCheckBox::toggled, this, [ this ]( bool checked ) {
+        this->scope->analysis.spectrumZoom = checked; // picked up by the spectrum generator with the next block
+        this->zoomCenterSiSpinBox->setEnabled( checked );
+        this->zoomSpanSiSpinBox->setEnabled( checked );
+    } );
+    connect( zoomCenterSiSpinBox, SELECT< double >::OVERLOAD_OF( &QDoubleSpinBox::valueChanged ), this,
+             [ this ]( double value ) { this->scope->analysis.spectrumZoomCenter = value; } );
+    connect( zoomSpanSiSpinBox, SELECT< double >::OVERLOAD_OF( &QDoubleSpinBox::valueChanged ), this,
+             [ this ]( double value ) { this->scope->analysis.spectrumZoomSpan = value; } );
+
     // Load settings into GUI
     loadSettings( scope );
 
@@ -98,11 +140,17 @@ void SpectrumDock::loadSettings( DsoSettingsScope *scope ) {
     // Initialize elements
     for ( ChannelID channel = 0; channel < scope->voltage.size(); ++channel ) {
         setMagnitude( channel, scope->spectrum[ channel ].magnitude );
+        setMode( channel, scope->spectrum[ channel ].mode );
         setUsed( channel, scope->spectrum[ channel ].used );
         scope->spectrum[ channel ].visible = scope->spectrum[ channel ].used;
         channelBlocks[ channel ].usedCheckBox->setEnabled( scope->horizontal.format == Dso::GraphFormat::TY );
     }
     setFrequencybase( scope->horizontal.frequencybase );
+    zoomCenterSiSpinBox->setValue( scope->analysis.spectrumZoomCenter );
+    zoomSpanSiSpinBox->setValue( scope->analysis.spectrumZoomSpan );
+    zoomCenterSiSpinBox->setEnabled( scope->analysis.spectrumZoom );
+    zoomSpanSiSpinBox->setEnabled( scope->analysis.spectrumZoom );
+    zoomCheckBox->setChecked( scope->analysis.spectrumZoom );
 }
 
 
@@ -132,6 +180,21 @@ int SpectrumDock::setMagnitude( ChannelID channel, double magnitude ) {
 }
 
 
+int SpectrumDock::setMode( ChannelID channel, SpectrumMode mode ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  SDock::setMode()" << channel << int( mode );
+    if ( channel >= scope->voltage.size() )
+        return -1;
+    int index = int( mode );
+    if ( index < 0 || index >= modeStrings.size() )
+        return -1;
+    QSignalBlocker blocker( channelBlocks[ channel ].modeComboBox );
+    channelBlocks[ channel ].modeComboBox->setCurrentIndex( index );
+    scope->spectrum[ channel ].mode = mode; // picked up by the spectrum generator with the next block
+    return index;
+}
+
+
 unsigned SpectrumDock::setUsed( ChannelID channel, bool used ) {
     if ( scope->verboseLevel > 2 )
         qDebug() << "  SDock::setUsed()" << channel << used;
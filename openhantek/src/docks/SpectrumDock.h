@@ -32,6 +32,12 @@ class SpectrumDock : public QDockWidget {
     /// \return Index of magnitude-value, -1 on error.
     int setMagnitude( ChannelID channel, double magnitude );
 
+    /// \brief Sets the accumulation mode for a channel.
+    /// \param channel The channel, whose mode should be set.
+    /// \param mode The accumulation mode (single / average / max hold).
+    /// \return Index of the mode, -1 on error.
+    int setMode( ChannelID channel, SpectrumMode mode );
+
     /// \brief Enables/disables a channel.
     /// \param channel The channel, that should be enabled/disabled.
     /// \param used True if the channel should be enabled, false otherwise.
@@ -67,6 +73,7 @@ class SpectrumDock : public QDockWidget {
     struct ChannelBlock {
         QCheckBox *usedCheckBox;      ///< Enable/disable a specific channel
         QComboBox *magnitudeComboBox; ///< Select the vertical magnitude for the spectrums
+        QComboBox *modeComboBox;      ///< Select the accumulation over consecutive spectra
     };
 
     std::vector< ChannelBlock > channelBlocks;
@@ -75,8 +82,13 @@ class SpectrumDock : public QDockWidget {
 
     std::vector< double > magnitudeSteps; ///< The selectable magnitude steps in dB/div
     QStringList magnitudeStrings;         ///< String representations for the magnitude steps
+    QStringList modeStrings;              ///< String representations for the accumulation modes
     QLabel *frequencybaseLabel;           ///< The label for the frequencybase spinbox
     SiSpinBox *frequencybaseSiSpinBox;    ///< Selects the frequencybase for spectrum graphs
+    QCheckBox *zoomCheckBox;              ///< Enables the zoom FFT around the center frequency
+    SiSpinBox *zoomCenterSiSpinBox;       ///< Center frequency of the zoomed band
+    QLabel *zoomSpanLabel;                ///< The label for the zoom span spinbox
+    SiSpinBox *zoomSpanSiSpinBox;         ///< Width of the zoomed band
 
   signals:
     void magnitudeChanged( ChannelID channel, double magnitude ); ///< A magnitude has been selected
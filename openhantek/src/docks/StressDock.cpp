@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCloseEvent>
+#include <QDebug>
+
+#include "StressDock.h"
+#include "dockwindows.h"
+
+#include "dsosettings.h"
+#include "glscope.h"
+#include "hantekdso/hantekdsocontrol.h"
+#include "post/postprocessing.h"
+
+
+StressDock::StressDock( DsoSettingsScope *scope, HantekDsoControl *dsoControl, PostProcessing *postProcessing, QWidget *parent )
+    : QDockWidget( tr( "Diagnostics" ), parent ), dsoControl( dsoControl ), postProcessing( postProcessing ), scope( scope ) {
+
+    if ( scope->verboseLevel > 1 )
+        qDebug() << " StressDock::StressDock()";
+
+    captureLabel = new QLabel( tr( "Captured" ) );
+    captureValue = new QLabel( "-" );
+    if ( scope->toolTipVisible )
+        captureValue->setToolTip( tr( "Raw blocks captured per second and the resulting USB throughput" ) );
+    convertedLabel = new QLabel( tr( "Converted" ) );
+    convertedValue = new QLabel( "-" );
+    if ( scope->toolTipVisible )
+        convertedValue->setToolTip( tr( "Frames delivered by the processing chain per second" ) );
+    displayedLabel = new QLabel( tr( "Displayed" ) );
+    displayedValue = new QLabel( "-" );
+    if ( scope->toolTipVisible )
+        displayedValue->setToolTip( tr( "New waveforms painted on screen per second (repaints not counted)" ) );
+    stagesLabel = new QLabel( tr( "Stages" ) );
+    stagesValue = new QLabel( "-" );
+    if ( scope->toolTipVisible )
+        stagesValue->setToolTip( tr( "Smoothed busy time of each processing stage per block" ) );
+    dropsLabel = new QLabel( tr( "Drops" ) );
+    dropsValue = new QLabel( "-" );
+    if ( scope->toolTipVisible )
+        dropsValue->setToolTip( tr( "Pipeline health counters: USB short reads / retries, zero filled blocks, untriggered blocks" ) );
+
+    dockLayout = new QGridLayout();
+    dockLayout->setColumnMinimumWidth( 0, 50 );
+    dockLayout->setColumnStretch( 1, 1 );
+    dockLayout->setSpacing( DOCK_LAYOUT_SPACING );
+    dockLayout->addWidget( captureLabel, 0, 0 );
+    dockLayout->addWidget( captureValue, 0, 1 );
+    dockLayout->addWidget( convertedLabel, 1, 0 );
+    dockLayout->addWidget( convertedValue, 1, 1 );
+    dockLayout->addWidget( displayedLabel, 2, 0 );
+    dockLayout->addWidget( displayedValue, 2, 1 );
+    dockLayout->addWidget( stagesLabel, 3, 0, Qt::AlignTop );
+    dockLayout->addWidget( stagesValue, 3, 1 );
+    dockLayout->addWidget( dropsLabel, 4, 0, Qt::AlignTop );
+    dockLayout->addWidget( dropsValue, 4, 1 );
+
+    dockWidget = new QWidget();
+    SetupDockWidget( this, dockWidget, dockLayout );
+
+    // count the delivered results; queued connection, the chain runs on its own thread
+    connect( postProcessing, &PostProcessing::processingFinished, this,
+             [ this ]( std::shared_ptr< PPresult > ) { ++convertedFrames; } );
+
+    refreshTimer.setInterval( 1000 );
+    connect( &refreshTimer, &QTimer::timeout, this, &StressDock::refresh );
+}
+
+
+void StressDock::refresh() {
+    const double seconds = qMax( interval.restart(), qint64( 1 ) ) / 1000.0;
+
+    unsigned tag = 0, blockBytes = 0;
+    dsoControl->captureProgress( tag, blockBytes );
+    // raw.tag counts the published blocks, the delta over the poll interval is the
+    // block rate; each block moves blockBytes over USB
+    const unsigned blocks = tag >= lastTag ? tag - lastTag : 0; // fresh start after a restart
+    lastTag = tag;
+    captureValue->setText( tr( "%1 blocks/s, %2 MB/s" )
+                               .arg( blocks / seconds, 0, 'f', 1 )
+                               .arg( blocks * double( blockBytes ) / seconds / 1e6, 0, 'f', 1 ) );
+
+    const unsigned converted = convertedFrames;
+    convertedValue->setText( tr( "%1 frames/s" ).arg( ( converted - lastConverted ) / seconds, 0, 'f', 1 ) );
+    lastConverted = converted;
+
+    const unsigned painted = GlScope::paintedFrames();
+    displayedValue->setText( tr( "%1 frames/s" ).arg( ( painted - lastPainted ) / seconds, 0, 'f', 1 ) );
+    lastPainted = painted;
+
+    QString stages;
+    for ( const PostProcessing::StageReport &report : postProcessing->stageReports() ) {
+        if ( !stages.isEmpty() )
+            stages += "\n";
+        stages += tr( "%1: %2 µs" ).arg( QLatin1String( report.name ) ).arg( report.meanMicros, 0, 'f', 0 );
+    }
+    stagesValue->setText( stages.isEmpty() ? "-" : stages );
+
+    const HantekDsoControl::PipelineHealth health = dsoControl->pipelineHealth();
+    dropsValue->setText( tr( "%1 short, %2 retry\n%3 zero filled\n%4 untriggered" )
+                             .arg( health.shortReads - lastShortReads )
+                             .arg( health.usbRetries - lastUsbRetries )
+                             .arg( health.zeroFilledBlocks - lastZeroFilled )
+                             .arg( health.triggerOverruns - lastOverruns ) );
+    lastShortReads = health.shortReads;
+    lastUsbRetries = health.usbRetries;
+    lastZeroFilled = health.zeroFilledBlocks;
+    lastOverruns = health.triggerOverruns;
+}
+
+
+void StressDock::showEvent( QShowEvent *event ) {
+    // resynchronize all deltas so the first visible refresh shows clean rates,
+    // then poll once per second while the dock is visible
+    unsigned blockBytes = 0;
+    dsoControl->captureProgress( lastTag, blockBytes );
+    lastConverted = convertedFrames;
+    lastPainted = GlScope::paintedFrames();
+    const HantekDsoControl::PipelineHealth health = dsoControl->pipelineHealth();
+    lastShortReads = health.shortReads;
+    lastUsbRetries = health.usbRetries;
+    lastZeroFilled = health.zeroFilledBlocks;
+    lastOverruns = health.triggerOverruns;
+    interval.start();
+    refreshTimer.start();
+    QDockWidget::showEvent( event );
+}
+
+
+void StressDock::hideEvent( QHideEvent *event ) {
+    refreshTimer.stop();
+    QDockWidget::hideEvent( event );
+}
+
+
+/// \brief Don't close the dock, just hide it
+/// \param event The close event that should be handled.
+void StressDock::closeEvent( QCloseEvent *event ) {
+    hide();
+
+    event->accept();
+}
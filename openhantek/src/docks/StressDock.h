@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QLabel>
+#include <QTimer>
+
+class HantekDsoControl;
+class PostProcessing;
+struct DsoSettingsScope;
+
+/// \brief Dock window with the live waveform rate and stress numbers.
+/// Deployments are tuned by waveforms per second, so the dock shows the
+/// captured blocks/s, converted and displayed frames/s, the USB throughput,
+/// the per stage busy times from the processing budget table and the pipeline
+/// health drop counters - the numbers a bench operator needs to judge a setup
+/// without attaching a profiler. All inputs are existing counters; the dock
+/// polls them once per second while it is visible and costs nothing when it
+/// is hidden (the startup default).
+class StressDock : public QDockWidget {
+    Q_OBJECT
+
+  public:
+    /// \brief Initializes the diagnostics docking window.
+    /// \param scope The scope settings (verbose level, tooltips).
+    /// \param dsoControl Queried for the capture progress and health counters.
+    /// \param postProcessing Queried for the per stage budget table.
+    /// \param parent The parent widget.
+    StressDock( DsoSettingsScope *scope, HantekDsoControl *dsoControl, PostProcessing *postProcessing, QWidget *parent );
+
+  protected:
+    void closeEvent( QCloseEvent *event ) override;
+    void showEvent( QShowEvent *event ) override;
+    void hideEvent( QHideEvent *event ) override;
+
+    /// \brief Poll all counters, compute the per second rates and update the labels.
+    void refresh();
+
+    QGridLayout *dockLayout;     ///< The main layout for the dock window
+    QWidget *dockWidget;         ///< The main widget for the dock window
+    QLabel *captureLabel;        ///< The label for the captured blocks/s value
+    QLabel *captureValue;        ///< Captured blocks/s and USB throughput
+    QLabel *convertedLabel;      ///< The label for the converted frames/s value
+    QLabel *convertedValue;      ///< Results delivered by the processing chain per second
+    QLabel *displayedLabel;      ///< The label for the displayed frames/s value
+    QLabel *displayedValue;      ///< New waveforms painted on screen per second
+    QLabel *stagesLabel;         ///< The label for the stage cost rows
+    QLabel *stagesValue;         ///< Smoothed busy time of each processing stage
+    QLabel *dropsLabel;          ///< The label for the drop counters
+    QLabel *dropsValue;          ///< Pipeline health counters, new drops per interval
+
+    HantekDsoControl *dsoControl;
+    PostProcessing *postProcessing;
+    DsoSettingsScope *scope; ///< The settings provided by the parent class
+
+    QTimer refreshTimer;     ///< 1 Hz poll, runs only while the dock is visible
+    QElapsedTimer interval;  ///< measures the real poll interval for the rates
+    // the counter states of the previous poll, the rates come from the deltas
+    unsigned lastTag = 0;           ///< raw.tag of the previous poll
+    unsigned lastConverted = 0;     ///< delivered results counted so far
+    unsigned lastPainted = 0;       ///< GlScope::paintedFrames() of the previous poll
+    unsigned lastShortReads = 0;    ///< health counter states of the previous poll ..
+    unsigned lastUsbRetries = 0;    //
+    unsigned lastZeroFilled = 0;    //
+    unsigned lastOverruns = 0;      // .. up to here
+    unsigned convertedFrames = 0;   ///< delivered results, counted via processingFinished
+};
@@ -57,6 +57,32 @@ TriggerDock::TriggerDock( DsoSettingsScope *scope, const Dso::ControlSpecificati
         smoothComboBox->setToolTip( tr( "Trigger on fast, normal, or slow signals" ) );
     smoothComboBox->addItems( smoothStandardStrings );
 
+    qualifyLabel = new QLabel( tr( "Qualify" ) );
+    qualifyComboBox = new QComboBox();
+    if ( scope->toolTipVisible )
+        qualifyComboBox->setToolTip( tr( "Trigger on any edge, on pulses inside the width range or on runt pulses" ) );
+    for ( Dso::TriggerQualify qualify : Dso::TriggerQualifyEnum )
+        qualifyComboBox->addItem( Dso::triggerQualifyString( qualify ) );
+
+    widthLabel = new QLabel( tr( "Width" ) );
+    widthMinSiSpinBox = new SiSpinBox( UNIT_SECONDS );
+    if ( scope->toolTipVisible )
+        widthMinSiSpinBox->setToolTip( tr( "Lower pulse width limit" ) );
+    widthMinSiSpinBox->setMinimum( 1e-7 );
+    widthMinSiSpinBox->setMaximum( 1e1 );
+    widthMaxSiSpinBox = new SiSpinBox( UNIT_SECONDS );
+    if ( scope->toolTipVisible )
+        widthMaxSiSpinBox->setToolTip( tr( "Upper pulse width limit" ) );
+    widthMaxSiSpinBox->setMinimum( 1e-7 );
+    widthMaxSiSpinBox->setMaximum( 1e1 );
+
+    holdoffLabel = new QLabel( tr( "Holdoff" ) );
+    holdoffSiSpinBox = new SiSpinBox( UNIT_SECONDS );
+    if ( scope->toolTipVisible )
+        holdoffSiSpinBox->setToolTip( tr( "Minimum time between two triggers (0 = off)" ) );
+    holdoffSiSpinBox->setMinimum( 0 );
+    holdoffSiSpinBox->setMaximum( 1e2 );
+
     dockLayout = new QGridLayout();
     dockLayout->setColumnMinimumWidth( 0, 50 );
     dockLayout->setColumnStretch( 1, 1 ); // stretch 2nd (middle) column 1x
@@ -69,6 +95,13 @@ TriggerDock::TriggerDock( DsoSettingsScope *scope, const Dso::ControlSpecificati
     dockLayout->addWidget( slopeLabel, 2, 0 );
     dockLayout->addWidget( slopeComboBox, 2, 1 );
     dockLayout->addWidget( smoothComboBox, 2, 2 );
+    dockLayout->addWidget( qualifyLabel, 3, 0 );
+    dockLayout->addWidget( qualifyComboBox, 3, 1, 1, 2 ); // fill 1 row, 2 col
+    dockLayout->addWidget( widthLabel, 4, 0 );
+    dockLayout->addWidget( widthMinSiSpinBox, 4, 1 );
+    dockLayout->addWidget( widthMaxSiSpinBox, 4, 2 );
+    dockLayout->addWidget( holdoffLabel, 5, 0 );
+    dockLayout->addWidget( holdoffSiSpinBox, 5, 1, 1, 2 ); // fill 1 row, 2 col
 
     dockWidget = new QWidget();
     SetupDockWidget( this, dockWidget, dockLayout );
@@ -97,6 +130,27 @@ TriggerDock::TriggerDock( DsoSettingsScope *scope, const Dso::ControlSpecificati
                  this->scope->trigger.smooth = index;
                  emit smoothChanged( index );
              } );
+    connect( qualifyComboBox, static_cast< void ( QComboBox::* )( int ) >( &QComboBox::currentIndexChanged ), this,
+             [ this ]( int index ) {
+                 this->scope->trigger.qualify = Dso::TriggerQualify( index );
+                 enableWidthLimits();
+                 emit qualifyChanged( this->scope->trigger.qualify );
+             } );
+    connect( widthMinSiSpinBox, static_cast< void ( QDoubleSpinBox::* )( double ) >( &QDoubleSpinBox::valueChanged ), this,
+             [ this ]( double min ) {
+                 this->scope->trigger.pulseWidthMin = min;
+                 emit pulseWidthChanged( min, this->scope->trigger.pulseWidthMax );
+             } );
+    connect( widthMaxSiSpinBox, static_cast< void ( QDoubleSpinBox::* )( double ) >( &QDoubleSpinBox::valueChanged ), this,
+             [ this ]( double max ) {
+                 this->scope->trigger.pulseWidthMax = max;
+                 emit pulseWidthChanged( this->scope->trigger.pulseWidthMin, max );
+             } );
+    connect( holdoffSiSpinBox, static_cast< void ( QDoubleSpinBox::* )( double ) >( &QDoubleSpinBox::valueChanged ), this,
+             [ this ]( double holdoff ) {
+                 this->scope->trigger.holdoff = holdoff;
+                 emit holdoffChanged( holdoff );
+             } );
 }
 
 void TriggerDock::loadSettings( DsoSettingsScope *scope ) {
@@ -109,6 +163,16 @@ void TriggerDock::loadSettings( DsoSettingsScope *scope ) {
     setSlope( scope->trigger.slope );
     setSource( scope->trigger.source );
     setSmooth( scope->trigger.smooth );
+    setQualify( scope->trigger.qualify );
+    setPulseWidth( scope->trigger.pulseWidthMin, scope->trigger.pulseWidthMax );
+    setHoldoff( scope->trigger.holdoff );
+}
+
+
+void TriggerDock::enableWidthLimits() { // the width limits only apply to a pulse qualification
+    widthLabel->setEnabled( scope->trigger.qualify != Dso::TriggerQualify::Edge );
+    widthMinSiSpinBox->setEnabled( scope->trigger.qualify != Dso::TriggerQualify::Edge );
+    widthMaxSiSpinBox->setEnabled( scope->trigger.qualify == Dso::TriggerQualify::Pulse );
 }
 
 
@@ -165,3 +229,27 @@ void TriggerDock::setSmooth( int smooth ) {
     QSignalBlocker blocker( smoothComboBox );
     smoothComboBox->setCurrentIndex( int( smooth ) );
 }
+
+void TriggerDock::setQualify( Dso::TriggerQualify qualify ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  TDock::setQualify()" << int( qualify );
+    QSignalBlocker blocker( qualifyComboBox );
+    qualifyComboBox->setCurrentIndex( int( qualify ) );
+    enableWidthLimits();
+}
+
+void TriggerDock::setPulseWidth( double min, double max ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  TDock::setPulseWidth()" << min << max;
+    QSignalBlocker blockerMin( widthMinSiSpinBox );
+    widthMinSiSpinBox->setValue( min );
+    QSignalBlocker blockerMax( widthMaxSiSpinBox );
+    widthMaxSiSpinBox->setValue( max );
+}
+
+void TriggerDock::setHoldoff( double holdoff ) {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  TDock::setHoldoff()" << holdoff;
+    QSignalBlocker blocker( holdoffSiSpinBox );
+    holdoffSiSpinBox->setValue( holdoff );
+}
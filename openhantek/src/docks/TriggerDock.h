@@ -45,6 +45,19 @@ class TriggerDock : public QDockWidget {
     /// \param slope The trigger slope.
     void setSlope( Dso::Slope slope );
 
+    /// \brief Changes the pulse qualification of the trigger edge.
+    /// \param qualify Edge, pulse width or runt qualification.
+    void setQualify( Dso::TriggerQualify qualify );
+
+    /// \brief Changes the qualifying pulse width range.
+    /// \param min The lower pulse width limit in s.
+    /// \param max The upper pulse width limit in s.
+    void setPulseWidth( double min, double max );
+
+    /// \brief Changes the trigger holdoff time.
+    /// \param holdoff The minimum time between two triggers in s.
+    void setHoldoff( double holdoff );
+
   public slots:
     /// \brief Loads settings into GUI
     /// \param scope Settings to load
@@ -54,6 +67,9 @@ class TriggerDock : public QDockWidget {
   protected:
     void closeEvent( QCloseEvent *event ) override;
 
+    /// \brief Enable the pulse width limits matching the selected qualification.
+    void enableWidthLimits();
+
     QGridLayout *dockLayout;   ///< The main layout for the dock window
     QWidget *dockWidget;       ///< The main widget for the dock window
     QLabel *modeLabel;         ///< The label for the trigger mode combobox
@@ -63,6 +79,13 @@ class TriggerDock : public QDockWidget {
     QComboBox *sourceComboBox; ///< Select the source for triggering
     QComboBox *smoothComboBox; ///< Select the filter for triggering
     QComboBox *slopeComboBox;  ///< Select the slope that causes triggering
+    QLabel *qualifyLabel;      ///< The label for the pulse qualification combobox
+    QComboBox *qualifyComboBox; ///< Select edge, pulse width or runt qualification
+    QLabel *widthLabel;        ///< The label for the pulse width limits
+    SiSpinBox *widthMinSiSpinBox; ///< Lower pulse width limit
+    SiSpinBox *widthMaxSiSpinBox; ///< Upper pulse width limit
+    QLabel *holdoffLabel;      ///< The label for the holdoff spinbox
+    SiSpinBox *holdoffSiSpinBox; ///< Minimum time between two triggers
 
     DsoSettingsScope *scope; ///< The settings provided by the parent class
     const Dso::ControlSpecification *mSpec;
@@ -71,8 +94,11 @@ class TriggerDock : public QDockWidget {
     QStringList smoothStandardStrings; ///< Strings for the standard trigger filtering
 
   signals:
-    void modeChanged( Dso::TriggerMode ); ///< The trigger mode has been changed
-    void sourceChanged( int id );         ///< The trigger source has been changed
-    void smoothChanged( int smooth );     ///< The trigger smoothing has been changed
-    void slopeChanged( Dso::Slope );      ///< The trigger slope has been changed
+    void modeChanged( Dso::TriggerMode );          ///< The trigger mode has been changed
+    void sourceChanged( int id );                  ///< The trigger source has been changed
+    void smoothChanged( int smooth );              ///< The trigger smoothing has been changed
+    void slopeChanged( Dso::Slope );               ///< The trigger slope has been changed
+    void qualifyChanged( Dso::TriggerQualify );    ///< The pulse qualification has been changed
+    void pulseWidthChanged( double min, double max ); ///< The pulse width limits have been changed
+    void holdoffChanged( double holdoff );         ///< The holdoff time has been changed
 };
@@ -29,6 +29,7 @@ void registerDockMetaTypes() {
     qRegisterMetaType< Dso::TriggerMode >();
     qRegisterMetaType< Dso::MathMode >();
     qRegisterMetaType< Dso::Slope >();
+    qRegisterMetaType< Dso::TriggerQualify >();
     qRegisterMetaType< Dso::Coupling >();
     qRegisterMetaType< Dso::GraphFormat >();
     qRegisterMetaType< Dso::ChannelMode >();
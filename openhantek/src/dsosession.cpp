@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QDebug>
+
+#include "dsosession.h"
+
+#include "hantekdso/capturing.h"
+#include "hantekdso/processing.h"
+#include "mainwindow.h"
+#include "remote/scpiserver.h"
+#include "usb/scopedevice.h"
+
+
+DsoSession::DsoSession( std::unique_ptr< ScopeDevice > device, const DsoSessionConfig &config )
+    : scopeDevice( std::move( device ) ), dsoControl( scopeDevice.get(), scopeDevice->getModel(), config.verboseLevel ),
+      settings( scopeDevice.get(), config.verboseLevel, config.resetSettings ),
+      exportRegistry( scopeDevice->getModel()->spec(), &settings ), samplesToExportRaw( &exportRegistry ),
+      postProcessing( settings.scope.countChannels(), config.verboseLevel ),
+      spectrumGenerator( &settings.scope, &settings.analysis ), decoder( &settings.scope, &settings.analysis ),
+      graphGenerator( &settings.scope, &settings.view ),
+      verboseLevel( config.verboseLevel ) {
+    if ( verboseLevel > 1 )
+        qDebug() << " DsoSession::DsoSession()" << scopeDevice->getModel()->name << scopeDevice->getSerialNumber();
+
+    if ( !config.configFileName.isEmpty() )
+        settings.loadFromFile( config.configFileName );
+
+    // the presentation settings are shared by all sessions, MainWindow uses them
+    settings.scope.toolTipVisible = config.toolTipVisible;
+    settings.view.styleFusion = config.styleFusion;
+    settings.view.theme = config.theme;
+    settings.view.fontSize = config.fontSize;
+
+    // demo device signal generator setup, unused when real scope HW is connected
+    if ( config.demoShape == "sine" )
+        dsoControl.demoShape = HantekDsoControl::DemoShape::Sine;
+    else if ( config.demoShape == "square" )
+        dsoControl.demoShape = HantekDsoControl::DemoShape::Square;
+    else if ( config.demoShape == "noise" )
+        dsoControl.demoShape = HantekDsoControl::DemoShape::Noise;
+    if ( config.demoFrequency > 0 )
+        dsoControl.demoFrequency = config.demoFrequency;
+    dsoControl.recordFileName = config.recordFileName;
+
+    dsoControlThread.setObjectName( "dsoControlThread" );
+    dsoControl.moveToThread( &dsoControlThread );
+    connect( &dsoControl, &HantekDsoControl::communicationError, QCoreApplication::instance(), &QCoreApplication::quit );
+    connect( scopeDevice.get(), &ScopeDevice::deviceDisconnected, QCoreApplication::instance(), &QCoreApplication::quit );
+
+    exportRegistry.registerExporter( &exporterCSV );
+    exportRegistry.registerExporter( &exporterJSON );
+    exportRegistry.registerExporter( &exporterWAV );
+    exportRegistry.registerExporter( &exporterBIN );
+    exportRegistry.registerExporter( &exporterSEG );
+    // the recorder taps the unpaced raw block stream directly in the processing thread
+    connect( &dsoControl, &HantekDsoControl::rawBlockCaptured, &dsoControl,
+             [ this ]( const std::vector< unsigned char > *data, unsigned channels, double samplerate, unsigned oversampling,
+                       const unsigned *gainValue, unsigned tag ) {
+                 exporterBIN.rawBlock( data, channels, samplerate, oversampling, gainValue, tag );
+             },
+             Qt::DirectConnection );
+
+    postProcessing.registerProcessor( &samplesToExportRaw );
+    postProcessing.registerProcessor( &spectrumGenerator );
+    if ( !config.headless ) { // nobody consumes vertex arrays or annotations without a scope window
+        postProcessing.registerProcessor( &decoder );
+        postProcessing.registerProcessor( &graphGenerator );
+    }
+
+    postProcessingThread.setObjectName( "postProcessingThread" );
+    postProcessing.moveToThread( &postProcessingThread );
+    // count each block directly in the acquisition thread, then process it queued in
+    // the processing thread; input() drops blocks that were superseded in the meantime
+    connect( &dsoControl, &HantekDsoControl::samplesAvailable, &postProcessing, &PostProcessing::announceBlock,
+             Qt::DirectConnection );
+    connect( &dsoControl, &HantekDsoControl::samplesAvailable, &postProcessing, &PostProcessing::input );
+    // feed the measured stage times back into the display pacing governor; the slot
+    // only bumps an atomic counter, so deliver it directly from the emitting thread
+    connect( &postProcessing, &PostProcessing::processTime, &dsoControl, &HantekDsoControl::reportProcessingTime,
+             Qt::DirectConnection );
+    connect( &postProcessing, &PostProcessing::processingFinished, &exportRegistry, &ExporterRegistry::input,
+             Qt::DirectConnection );
+
+    if ( config.scpiPort > 0 ) { // TCP remote control, also available in headless mode
+        scpiServer = std::unique_ptr< ScpiServer >( new ScpiServer( &dsoControl, quint16( config.scpiPort ), verboseLevel ) );
+        // queued into the main thread, the server pushes the blocks from there
+        connect( &postProcessing, &PostProcessing::processingFinished, scpiServer.get(), &ScpiServer::sendSamples );
+    }
+
+    if ( config.headless ) { // acquisition-only rig: capture starts with start(), the
+        if ( verboseLevel )  // exporters are configured via --config / the settings file
+            qDebug() << " headless session, no scope window" << scopeDevice->getSerialNumber();
+        return;
+    }
+
+    mainWindow = std::unique_ptr< MainWindow >( new MainWindow( &dsoControl, &settings, &exportRegistry, &postProcessing ) );
+    connect( &postProcessing, &PostProcessing::processingFinished, mainWindow.get(), &MainWindow::showNewData );
+    connect( &exportRegistry, &ExporterRegistry::exporterProgressChanged, mainWindow.get(),
+             &MainWindow::exporterProgressChanged );
+    connect( &exportRegistry, &ExporterRegistry::exporterStatusChanged, mainWindow.get(), &MainWindow::exporterStatusChanged );
+    mainWindow->show();
+}
+
+
+DsoSession::~DsoSession() {
+    if ( verboseLevel > 1 )
+        qDebug() << " DsoSession::~DsoSession()";
+}
+
+
+void DsoSession::start() {
+    if ( verboseLevel > 1 )
+        qDebug() << " DsoSession::start()" << scopeDevice->getSerialNumber();
+    dsoControl.enableSamplingUI();
+    postProcessingThread.start();
+    dsoControlThread.start();
+    processingThread = std::unique_ptr< ProcessingThread >( new ProcessingThread( &dsoControl ) );
+    processingThread->start();
+    capturingThread = std::unique_ptr< CapturingThread >( new CapturingThread( &dsoControl ) );
+    capturingThread->start();
+}
+
+
+void DsoSession::shutdown() {
+    if ( verboseLevel > 1 )
+        qDebug() << " DsoSession::shutdown()" << scopeDevice->getSerialNumber();
+    dsoControl.quitSampling(); // send USB control command, stop bulk transfer
+
+    // stop the capturing thread
+    // wait 2 * record time (delay is ms) for dso to finish
+    unsigned waitForDso = unsigned( 2000 * dsoControl.getSamplesize() / dsoControl.getSamplerate() );
+    waitForDso = qMax( waitForDso, 10000U ); // wait for at least 10 s
+    if ( capturingThread ) {
+        capturingThread->requestInterruption();
+        capturingThread->wait( waitForDso );
+    }
+
+    // stop the processing thread, the capture thread already stopped the state machine
+    if ( processingThread ) {
+        processingThread->quitProcessing();
+        processingThread->wait( 10000 );
+    }
+
+    // now quit the data acquisition thread
+    dsoControlThread.quit();
+    dsoControlThread.wait( waitForDso );
+
+    // next stop the data processing
+    postProcessing.stop();
+    postProcessingThread.quit();
+    postProcessingThread.wait( 10000 );
+    postProcessing.waitForTail(); // the last block may still be in the pipelined tail stage
+
+    dsoControl.prepareForShutdown();
+
+    // finally shut down the device, must happen before libusb_exit()
+    scopeDevice.reset();
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QString>
+#include <QThread>
+#include <memory>
+
+#include "dsosettings.h"
+
+#include "hantekdso/hantekdsocontrol.h"
+
+#include "exporting/exportbin.h"
+#include "exporting/exportcsv.h"
+#include "exporting/exporterprocessor.h"
+#include "exporting/exporterregistry.h"
+#include "exporting/exportjson.h"
+#include "exporting/exportseg.h"
+#include "exporting/exportwav.h"
+
+#include "post/decoder.h"
+#include "post/graphgenerator.h"
+#include "post/postprocessing.h"
+#include "post/spectrumgenerator.h"
+
+class CapturingThread;
+class MainWindow;
+class ProcessingThread;
+class ScopeDevice;
+class ScpiServer;
+
+/// \brief Global presentation and startup parameters shared by all sessions.
+struct DsoSessionConfig {
+    int verboseLevel = 0;
+    bool resetSettings = false;
+    QString configFileName;
+    int fontSize = 0;
+    bool styleFusion = false;
+    int theme = 0;
+    int toolTipVisible = 1;
+    QString demoShape = "ramp";    ///< waveform of the demo device generator
+    double demoFrequency = 1000.0; ///< CH1 demo frequency in Hz
+    QString recordFileName;        ///< record the captured raw stream for later replay, empty = off
+    bool headless = false;         ///< acquisition-only: no scope window, no graph generation
+    int scpiPort = 0;              ///< TCP remote control port (+1 = streaming), 0 = off
+};
+
+/// \brief One complete capture pipeline for a single scope:
+/// ScopeDevice -> CapturingThread -> HantekDsoControl -> PostProcessing -> MainWindow.
+/// Several sessions can run in parallel in one process (option --allDevices), each
+/// with its own capture and processing threads, its own settings (selected by the
+/// device serial number) and its own scope window, so a multi scope bench does not
+/// need one process with full Qt/OpenGL startup per device.
+class DsoSession : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Wires the complete pipeline for one connected (or demo) device.
+    /// \param device The scope device, the session takes ownership.
+    /// \param config Global presentation and startup parameters.
+    DsoSession( std::unique_ptr< ScopeDevice > device, const DsoSessionConfig &config );
+    ~DsoSession() override;
+
+    /// \brief Start capture, control and post processing threads and begin sampling.
+    void start();
+
+    /// \brief Stop sampling and all threads, save the calibration. Blocks until done.
+    void shutdown();
+
+    HantekDsoControl *control() { return &dsoControl; }
+    MainWindow *window() { return mainWindow.get(); }
+
+  private:
+    // Construction order matters, do not shuffle the members!
+    std::unique_ptr< ScopeDevice > scopeDevice;
+    QThread dsoControlThread;
+    HantekDsoControl dsoControl;
+    DsoSettings settings;
+    ExporterRegistry exportRegistry;
+    ExporterCSV exporterCSV;
+    ExporterJSON exporterJSON;
+    ExporterWAV exporterWAV;
+    ExporterBIN exporterBIN;
+    ExporterSEG exporterSEG;
+    ExporterProcessor samplesToExportRaw;
+    QThread postProcessingThread;
+    PostProcessing postProcessing;
+    SpectrumGenerator spectrumGenerator;
+    Decoder decoder;
+    GraphGenerator graphGenerator;
+    std::unique_ptr< CapturingThread > capturingThread;
+    std::unique_ptr< ProcessingThread > processingThread;
+    std::unique_ptr< ScpiServer > scpiServer;
+    std::unique_ptr< MainWindow > mainWindow;
+    int verboseLevel;
+};
@@ -2,6 +2,7 @@
 
 #include <QApplication>
 #include <QColor>
+#include <QDataStream>
 #include <QFileInfo>
 #include <QSettings>
 
@@ -144,6 +145,12 @@ void DsoSettings::load() {
         scope.horizontal.samplerate = storeSettings->value( "samplerate" ).toDouble();
     if ( storeSettings->contains( "calfreq" ) )
         scope.horizontal.calfreq = storeSettings->value( "calfreq" ).toDouble();
+    if ( storeSettings->contains( "captureHistory" ) )
+        scope.horizontal.captureHistory = storeSettings->value( "captureHistory" ).toInt();
+    if ( storeSettings->contains( "acquireAverage" ) )
+        scope.horizontal.acquireAverage = qBound( 1u, storeSettings->value( "acquireAverage" ).toUInt(), 256u );
+    if ( storeSettings->contains( "acquireEnvelope" ) )
+        scope.horizontal.acquireEnvelope = storeSettings->value( "acquireEnvelope" ).toBool();
     storeSettings->endGroup(); // horizontal
     // Trigger
     storeSettings->beginGroup( "trigger" );
@@ -157,84 +164,26 @@ void DsoSettings::load() {
         scope.trigger.source = storeSettings->value( "source" ).toInt();
     if ( storeSettings->contains( "smooth" ) )
         scope.trigger.smooth = storeSettings->value( "smooth" ).toInt();
+    if ( storeSettings->contains( "qualify" ) )
+        scope.trigger.qualify = Dso::TriggerQualify( storeSettings->value( "qualify" ).toUInt() );
+    if ( storeSettings->contains( "pulseWidthMin" ) )
+        scope.trigger.pulseWidthMin = storeSettings->value( "pulseWidthMin" ).toDouble();
+    if ( storeSettings->contains( "pulseWidthMax" ) )
+        scope.trigger.pulseWidthMax = storeSettings->value( "pulseWidthMax" ).toDouble();
+    if ( storeSettings->contains( "holdoff" ) )
+        scope.trigger.holdoff = storeSettings->value( "holdoff" ).toDouble();
     storeSettings->endGroup(); // trigger
-    // Spectrum
-    for ( ChannelID channel = 0; channel < scope.spectrum.size(); ++channel ) {
-        storeSettings->beginGroup( QString( "spectrum%1" ).arg( channel ) );
-        if ( storeSettings->contains( "magnitude" ) )
-            scope.spectrum[ channel ].magnitude = storeSettings->value( "magnitude" ).toDouble();
-        if ( storeSettings->contains( "offset" ) )
-            scope.spectrum[ channel ].offset = storeSettings->value( "offset" ).toDouble();
-        if ( storeSettings->contains( "used" ) )
-            scope.spectrum[ channel ].used = storeSettings->value( "used" ).toBool();
-        storeSettings->beginGroup( "cursor" );
-        if ( storeSettings->contains( "shape" ) )
-            scope.spectrum[ channel ].cursor.shape =
-                DsoSettingsScopeCursor::CursorShape( storeSettings->value( "shape" ).toUInt() );
-        for ( int marker = 0; marker < 2; ++marker ) {
-            QString name;
-            name = QString( "x%1" ).arg( marker );
-            if ( storeSettings->contains( name ) )
-                scope.spectrum[ channel ].cursor.pos[ marker ].setX( storeSettings->value( name ).toDouble() );
-            name = QString( "y%1" ).arg( marker );
-            if ( storeSettings->contains( name ) )
-                scope.spectrum[ channel ].cursor.pos[ marker ].setY( storeSettings->value( name ).toDouble() );
-        }
-        storeSettings->endGroup(); // cursor
-        storeSettings->endGroup(); // spectrum%1
-    }
-    // Voltage
-    bool defaultConfig = false;
-    // defaultConfig = deviceSpecification->isDemoDevice; // use default channel setting in demo mode
+    // Spectrum and voltage channels, one binary blob per config since the per
+    // channel settings were split over dozens of keys; fall back to the legacy
+    // per key groups of older configs
     if ( storeSettings->contains( "hasACmodification" ) )
         scope.hasACmodification = storeSettings->value( "hasACmodification" ).toBool();
-    for ( ChannelID channel = 0; channel < scope.voltage.size(); ++channel ) {
-        storeSettings->beginGroup( QString( "voltage%1" ).arg( channel ) );
-        if ( storeSettings->contains( "gainStepIndex" ) )
-            scope.voltage[ channel ].gainStepIndex = storeSettings->value( "gainStepIndex" ).toUInt();
-        if ( storeSettings->contains( "couplingOrMathIndex" ) ) {
-            scope.voltage[ channel ].couplingOrMathIndex = storeSettings->value( "couplingOrMathIndex" ).toUInt();
-            if ( channel < deviceSpecification->channels ) {
-                if ( scope.voltage[ channel ].couplingOrMathIndex >= deviceSpecification->couplings.size() ||
-                     ( !scope.hasACcoupling && !scope.hasACmodification ) )
-                    scope.voltage[ channel ].couplingOrMathIndex = 0; // set to default if out of range
-            } else {
-                if ( scope.voltage[ channel ].couplingOrMathIndex > unsigned( Dso::LastMathMode ) )
-                    scope.voltage[ channel ].couplingOrMathIndex = 0;
-            }
-        }
-        if ( storeSettings->contains( "inverted" ) )
-            scope.voltage[ channel ].inverted = storeSettings->value( "inverted" ).toBool();
-        if ( storeSettings->contains( "offset" ) )
-            scope.voltage[ channel ].offset = storeSettings->value( "offset" ).toDouble();
-        if ( storeSettings->contains( "trigger" ) )
-            scope.voltage[ channel ].trigger = storeSettings->value( "trigger" ).toDouble();
-        if ( storeSettings->contains( "probeAttn" ) )
-            scope.voltage[ channel ].probeAttn = storeSettings->value( "probeAttn" ).toDouble();
-        if ( storeSettings->contains( "used" ) )
-            scope.voltage[ channel ].used = storeSettings->value( "used" ).toBool();
-        else                      // no config file found, e.g. 1st run
-            defaultConfig = true; // start with default config
-
-        if ( defaultConfig ) { // useful default: show both voltage channels
-            setDefaultConfig();
-        }
-
-        storeSettings->beginGroup( "cursor" );
-        if ( storeSettings->contains( "shape" ) )
-            scope.voltage[ channel ].cursor.shape = DsoSettingsScopeCursor::CursorShape( storeSettings->value( "shape" ).toUInt() );
-        for ( int marker = 0; marker < 2; ++marker ) {
-            QString name;
-            name = QString( "x%1" ).arg( marker );
-            if ( storeSettings->contains( name ) )
-                scope.voltage[ channel ].cursor.pos[ marker ].setX( storeSettings->value( name ).toDouble() );
-            name = QString( "y%1" ).arg( marker );
-            if ( storeSettings->contains( name ) )
-                scope.voltage[ channel ].cursor.pos[ marker ].setY( storeSettings->value( name ).toDouble() );
-        }
-        storeSettings->endGroup(); // cursor
-        storeSettings->endGroup(); // voltage%1
-    }
+    if ( storeSettings->contains( "captureCpuCore" ) )
+        scope.captureCpuCore = storeSettings->value( "captureCpuCore" ).toInt();
+    if ( storeSettings->contains( "captureRealTime" ) )
+        scope.captureRealTime = storeSettings->value( "captureRealTime" ).toBool();
+    if ( !( storeSettings->contains( "channels" ) && loadChannelBlob( storeSettings->value( "channels" ).toByteArray() ) ) )
+        loadChannelsLegacy();
 
     // Post processing
     if ( storeSettings->contains( "spectrumLimit" ) )
@@ -256,10 +205,37 @@ void DsoSettings::load() {
         scope.analysis.dummyLoad = storeSettings->value( "dummyLoad" ).toUInt();
     if ( storeSettings->contains( "calculateTHD" ) )
         scope.analysis.calculateTHD = storeSettings->value( "calculateTHD" ).toBool();
+    if ( storeSettings->contains( "spectrumZoom" ) )
+        scope.analysis.spectrumZoom = storeSettings->value( "spectrumZoom" ).toBool();
+    if ( storeSettings->contains( "spectrumZoomCenter" ) )
+        scope.analysis.spectrumZoomCenter = storeSettings->value( "spectrumZoomCenter" ).toDouble();
+    if ( storeSettings->contains( "spectrumZoomSpan" ) )
+        scope.analysis.spectrumZoomSpan = storeSettings->value( "spectrumZoomSpan" ).toDouble();
     if ( storeSettings->contains( "reuseFftPlan" ) )
         analysis.reuseFftPlan = storeSettings->value( "reuseFftPlan" ).toBool();
+    if ( storeSettings->contains( "singlePrecisionFft" ) )
+        analysis.singlePrecisionFft = storeSettings->value( "singlePrecisionFft" ).toBool();
+    if ( storeSettings->contains( "spectrumLength" ) )
+        analysis.spectrumLength = storeSettings->value( "spectrumLength" ).toUInt();
+    if ( storeSettings->contains( "measurementStride" ) )
+        analysis.measurementStride = qMax( 1u, storeSettings->value( "measurementStride" ).toUInt() );
     if ( storeSettings->contains( "showNoteValue" ) )
         scope.analysis.showNoteValue = storeSettings->value( "showNoteValue" ).toBool();
+    if ( storeSettings->contains( "decoderMode" ) ) {
+        analysis.decoderMode = Dso::DecoderMode( storeSettings->value( "decoderMode" ).toInt() );
+        if ( analysis.decoderMode > Dso::LastDecoderMode )
+            analysis.decoderMode = Dso::DecoderMode::OFF; // fall back to no decoding
+    }
+    if ( storeSettings->contains( "decoderDataChannel" ) )
+        analysis.decoderDataChannel = storeSettings->value( "decoderDataChannel" ).toUInt();
+    if ( storeSettings->contains( "decoderClockChannel" ) )
+        analysis.decoderClockChannel = storeSettings->value( "decoderClockChannel" ).toUInt();
+    if ( storeSettings->contains( "decoderBaud" ) )
+        analysis.decoderBaud = storeSettings->value( "decoderBaud" ).toDouble();
+    if ( storeSettings->contains( "decoderSpiMode" ) )
+        analysis.decoderSpiMode = storeSettings->value( "decoderSpiMode" ).toUInt() & 3;
+    if ( storeSettings->contains( "decoderThreshold" ) )
+        analysis.decoderThreshold = storeSettings->value( "decoderThreshold" ).toDouble();
     storeSettings->endGroup(); // analysis
     storeSettings->endGroup(); // scope
 
@@ -305,6 +281,8 @@ void DsoSettings::load() {
     // Other view settings
     if ( storeSettings->contains( "histogram" ) )
         scope.histogram = storeSettings->value( "histogram" ).toBool();
+    if ( storeSettings->contains( "waterfall" ) )
+        scope.waterfall = storeSettings->value( "waterfall" ).toBool();
     if ( storeSettings->contains( "digitalPhosphor" ) )
         view.digitalPhosphor = storeSettings->value( "digitalPhosphor" ).toBool();
     if ( storeSettings->contains( "interpolation" ) )
@@ -332,6 +310,88 @@ void DsoSettings::load() {
 }
 
 
+// load the per channel settings from the legacy per key groups of older configs
+void DsoSettings::loadChannelsLegacy() {
+    // Spectrum
+    for ( ChannelID channel = 0; channel < scope.spectrum.size(); ++channel ) {
+        storeSettings->beginGroup( QString( "spectrum%1" ).arg( channel ) );
+        if ( storeSettings->contains( "magnitude" ) )
+            scope.spectrum[ channel ].magnitude = storeSettings->value( "magnitude" ).toDouble();
+        if ( storeSettings->contains( "offset" ) )
+            scope.spectrum[ channel ].offset = storeSettings->value( "offset" ).toDouble();
+        if ( storeSettings->contains( "used" ) )
+            scope.spectrum[ channel ].used = storeSettings->value( "used" ).toBool();
+        if ( storeSettings->contains( "mode" ) )
+            scope.spectrum[ channel ].mode = SpectrumMode( storeSettings->value( "mode" ).toInt() );
+        storeSettings->beginGroup( "cursor" );
+        if ( storeSettings->contains( "shape" ) )
+            scope.spectrum[ channel ].cursor.shape =
+                DsoSettingsScopeCursor::CursorShape( storeSettings->value( "shape" ).toUInt() );
+        for ( int marker = 0; marker < 2; ++marker ) {
+            QString name;
+            name = QString( "x%1" ).arg( marker );
+            if ( storeSettings->contains( name ) )
+                scope.spectrum[ channel ].cursor.pos[ marker ].setX( storeSettings->value( name ).toDouble() );
+            name = QString( "y%1" ).arg( marker );
+            if ( storeSettings->contains( name ) )
+                scope.spectrum[ channel ].cursor.pos[ marker ].setY( storeSettings->value( name ).toDouble() );
+        }
+        storeSettings->endGroup(); // cursor
+        storeSettings->endGroup(); // spectrum%1
+    }
+    // Voltage
+    bool defaultConfig = false;
+    // defaultConfig = deviceSpecification->isDemoDevice; // use default channel setting in demo mode
+    for ( ChannelID channel = 0; channel < scope.voltage.size(); ++channel ) {
+        storeSettings->beginGroup( QString( "voltage%1" ).arg( channel ) );
+        if ( storeSettings->contains( "gainStepIndex" ) )
+            scope.voltage[ channel ].gainStepIndex = storeSettings->value( "gainStepIndex" ).toUInt();
+        if ( storeSettings->contains( "couplingOrMathIndex" ) ) {
+            scope.voltage[ channel ].couplingOrMathIndex = storeSettings->value( "couplingOrMathIndex" ).toUInt();
+            if ( channel < deviceSpecification->channels ) {
+                if ( scope.voltage[ channel ].couplingOrMathIndex >= deviceSpecification->couplings.size() ||
+                     ( !scope.hasACcoupling && !scope.hasACmodification ) )
+                    scope.voltage[ channel ].couplingOrMathIndex = 0; // set to default if out of range
+            } else {
+                if ( scope.voltage[ channel ].couplingOrMathIndex > unsigned( Dso::LastMathMode ) )
+                    scope.voltage[ channel ].couplingOrMathIndex = 0;
+            }
+        }
+        if ( storeSettings->contains( "inverted" ) )
+            scope.voltage[ channel ].inverted = storeSettings->value( "inverted" ).toBool();
+        if ( storeSettings->contains( "offset" ) )
+            scope.voltage[ channel ].offset = storeSettings->value( "offset" ).toDouble();
+        if ( storeSettings->contains( "trigger" ) )
+            scope.voltage[ channel ].trigger = storeSettings->value( "trigger" ).toDouble();
+        if ( storeSettings->contains( "probeAttn" ) )
+            scope.voltage[ channel ].probeAttn = storeSettings->value( "probeAttn" ).toDouble();
+        if ( storeSettings->contains( "used" ) )
+            scope.voltage[ channel ].used = storeSettings->value( "used" ).toBool();
+        else                      // no config file found, e.g. 1st run
+            defaultConfig = true; // start with default config
+
+        if ( defaultConfig ) { // useful default: show both voltage channels
+            setDefaultConfig();
+        }
+
+        storeSettings->beginGroup( "cursor" );
+        if ( storeSettings->contains( "shape" ) )
+            scope.voltage[ channel ].cursor.shape = DsoSettingsScopeCursor::CursorShape( storeSettings->value( "shape" ).toUInt() );
+        for ( int marker = 0; marker < 2; ++marker ) {
+            QString name;
+            name = QString( "x%1" ).arg( marker );
+            if ( storeSettings->contains( name ) )
+                scope.voltage[ channel ].cursor.pos[ marker ].setX( storeSettings->value( name ).toDouble() );
+            name = QString( "y%1" ).arg( marker );
+            if ( storeSettings->contains( name ) )
+                scope.voltage[ channel ].cursor.pos[ marker ].setY( storeSettings->value( name ).toDouble() );
+        }
+        storeSettings->endGroup(); // cursor
+        storeSettings->endGroup(); // voltage%1
+    }
+}
+
+
 // save the persistent scope settings
 // called by "DsoSettings::saveToFile()", "MainWindow::closeEvent" and explicitly by "ui->actionSave"
 void DsoSettings::save() {
@@ -347,104 +407,91 @@ void DsoSettings::save() {
     }
     if ( verboseLevel > 1 )
         qDebug() << " DsoSettings::save()" << storeSettings->fileName();
-    // now store individual device values
-
-    // Date and Time of last storage
-    storeSettings->beginGroup( "ConfigurationSaved" );
-    storeSettings->setValue( "Date", QDate::currentDate().toString( "yyyy-MM-dd" ) );
-    storeSettings->setValue( "Time", QTime::currentTime().toString( "HH:mm:ss" ) );
-    storeSettings->endGroup(); // ConfigurationSaved
+    // now store individual device values, but only the changed ones - if nothing
+    // differs from the stored configuration QSettings stays clean and does not
+    // rewrite the file at all (a full rewrite takes seconds on network homes)
+    storeDirty = false;
 
     // Device ID (helps to identify the connection of a "Save as" file with a specific device)
     storeSettings->beginGroup( "DeviceID" );
-    storeSettings->setValue( "Model", deviceName );
-    storeSettings->setValue( "SerialNumber", deviceID );
+    setChanged( "Model", deviceName );
+    setChanged( "SerialNumber", deviceID );
     storeSettings->endGroup(); // DeviceID
 
     // Configuration settings
     storeSettings->beginGroup( "configuration" );
-    storeSettings->setValue( "version", configVersion );
-    storeSettings->setValue( "alwaysSave", alwaysSave );
+    setChanged( "version", configVersion );
+    setChanged( "alwaysSave", alwaysSave );
     storeSettings->endGroup(); // configuration
 
     // Oszilloskope settings
     storeSettings->beginGroup( "scope" );
     // Horizontal axis
     storeSettings->beginGroup( "horizontal" );
-    storeSettings->setValue( "format", scope.horizontal.format );
-    storeSettings->setValue( "frequencybase", scope.horizontal.frequencybase );
+    setChanged( "format", scope.horizontal.format );
+    setChanged( "frequencybase", scope.horizontal.frequencybase );
     for ( int marker = 0; marker < 2; ++marker )
-        storeSettings->setValue( QString( "marker%1" ).arg( marker ), scope.getMarker( marker ) );
-    storeSettings->setValue( "timebase", scope.horizontal.timebase );
-    storeSettings->setValue( "maxTimebase", scope.horizontal.maxTimebase );
-    storeSettings->setValue( "acquireInterval", scope.horizontal.acquireInterval );
-    storeSettings->setValue( "recordLength", scope.horizontal.recordLength );
-    storeSettings->setValue( "samplerate", scope.horizontal.samplerate );
-    storeSettings->setValue( "calfreq", scope.horizontal.calfreq );
+        setChanged( QString( "marker%1" ).arg( marker ), scope.getMarker( marker ) );
+    setChanged( "timebase", scope.horizontal.timebase );
+    setChanged( "maxTimebase", scope.horizontal.maxTimebase );
+    setChanged( "acquireInterval", scope.horizontal.acquireInterval );
+    setChanged( "recordLength", scope.horizontal.recordLength );
+    setChanged( "samplerate", scope.horizontal.samplerate );
+    setChanged( "calfreq", scope.horizontal.calfreq );
+    setChanged( "captureHistory", scope.horizontal.captureHistory );
+    setChanged( "acquireAverage", scope.horizontal.acquireAverage );
+    setChanged( "acquireEnvelope", scope.horizontal.acquireEnvelope );
     storeSettings->endGroup(); // horizontal
     // Trigger
     storeSettings->beginGroup( "trigger" );
-    storeSettings->setValue( "mode", unsigned( scope.trigger.mode ) );
-    storeSettings->setValue( "position", scope.trigger.position );
-    storeSettings->setValue( "slope", unsigned( scope.trigger.slope ) );
-    storeSettings->setValue( "source", scope.trigger.source );
-    storeSettings->setValue( "smooth", scope.trigger.smooth );
+    setChanged( "mode", unsigned( scope.trigger.mode ) );
+    setChanged( "position", scope.trigger.position );
+    setChanged( "slope", unsigned( scope.trigger.slope ) );
+    setChanged( "source", scope.trigger.source );
+    setChanged( "smooth", scope.trigger.smooth );
+    setChanged( "qualify", unsigned( scope.trigger.qualify ) );
+    setChanged( "pulseWidthMin", scope.trigger.pulseWidthMin );
+    setChanged( "pulseWidthMax", scope.trigger.pulseWidthMax );
+    setChanged( "holdoff", scope.trigger.holdoff );
     storeSettings->endGroup(); // trigger
-    // Spectrum
-    for ( ChannelID channel = 0; channel < scope.spectrum.size(); ++channel ) {
-        storeSettings->beginGroup( QString( "spectrum%1" ).arg( channel ) );
-        storeSettings->setValue( "magnitude", scope.spectrum[ channel ].magnitude );
-        storeSettings->setValue( "offset", scope.spectrum[ channel ].offset );
-        storeSettings->setValue( "used", scope.spectrum[ channel ].used );
-        storeSettings->beginGroup( "cursor" );
-        storeSettings->setValue( "shape", scope.spectrum[ channel ].cursor.shape );
-        for ( int marker = 0; marker < 2; ++marker ) {
-            QString name;
-            name = QString( "x%1" ).arg( marker );
-            storeSettings->setValue( name, scope.spectrum[ channel ].cursor.pos[ marker ].x() );
-            name = QString( "y%1" ).arg( marker );
-            storeSettings->setValue( name, scope.spectrum[ channel ].cursor.pos[ marker ].y() );
-        }
-        storeSettings->endGroup(); // cursor
-        storeSettings->endGroup(); // spectrum%1
-    }
-    // Voltage
-    storeSettings->setValue( "hasACmodification", scope.hasACmodification );
-    for ( ChannelID channel = 0; channel < scope.voltage.size(); ++channel ) {
-        storeSettings->beginGroup( QString( "voltage%1" ).arg( channel ) );
-        storeSettings->setValue( "gainStepIndex", scope.voltage[ channel ].gainStepIndex );
-        storeSettings->setValue( "couplingOrMathIndex", scope.voltage[ channel ].couplingOrMathIndex );
-        storeSettings->setValue( "inverted", scope.voltage[ channel ].inverted );
-        storeSettings->setValue( "offset", scope.voltage[ channel ].offset );
-        storeSettings->setValue( "trigger", scope.voltage[ channel ].trigger );
-        storeSettings->setValue( "used", scope.voltage[ channel ].used );
-        storeSettings->setValue( "probeAttn", scope.voltage[ channel ].probeAttn );
-        storeSettings->beginGroup( "cursor" );
-        storeSettings->setValue( "shape", scope.voltage[ channel ].cursor.shape );
-        for ( int marker = 0; marker < 2; ++marker ) {
-            QString name;
-            name = QString( "x%1" ).arg( marker );
-            storeSettings->setValue( name, scope.voltage[ channel ].cursor.pos[ marker ].x() );
-            name = QString( "y%1" ).arg( marker );
-            storeSettings->setValue( name, scope.voltage[ channel ].cursor.pos[ marker ].y() );
+    // Spectrum and voltage channels, one binary blob instead of dozens of
+    // individual keys (see load())
+    setChanged( "hasACmodification", scope.hasACmodification );
+    setChanged( "captureCpuCore", scope.captureCpuCore );
+    setChanged( "captureRealTime", scope.captureRealTime );
+    setChanged( "channels", channelBlob() );
+    if ( storeSettings->childGroups().contains( "spectrum0" ) ) { // drop the legacy per key groups
+        for ( ChannelID channel = 0; channel < scope.spectrum.size(); ++channel ) {
+            storeSettings->remove( QString( "spectrum%1" ).arg( channel ) );
+            storeSettings->remove( QString( "voltage%1" ).arg( channel ) );
         }
-        storeSettings->endGroup(); // cursor
-        storeSettings->endGroup(); // voltage%1
     }
 
     // Post processing
-    storeSettings->setValue( "spectrumLimit", analysis.spectrumLimit );
-    storeSettings->setValue( "spectrumWindow", unsigned( analysis.spectrumWindow ) );
+    setChanged( "spectrumLimit", analysis.spectrumLimit );
+    setChanged( "spectrumWindow", unsigned( analysis.spectrumWindow ) );
 
     // Analysis
     storeSettings->beginGroup( "analysis" );
-    storeSettings->setValue( "spectrumReference", scope.analysis.spectrumReference );
-    storeSettings->setValue( "dBsuffixIndex", scope.analysis.dBsuffixIndex );
-    storeSettings->setValue( "calculateDummyLoad", scope.analysis.calculateDummyLoad );
-    storeSettings->setValue( "dummyLoad", scope.analysis.dummyLoad );
-    storeSettings->setValue( "calculateTHD", scope.analysis.calculateTHD );
-    storeSettings->setValue( "reuseFftPlan", analysis.reuseFftPlan );
-    storeSettings->setValue( "showNoteValue", scope.analysis.showNoteValue );
+    setChanged( "spectrumReference", scope.analysis.spectrumReference );
+    setChanged( "dBsuffixIndex", scope.analysis.dBsuffixIndex );
+    setChanged( "calculateDummyLoad", scope.analysis.calculateDummyLoad );
+    setChanged( "dummyLoad", scope.analysis.dummyLoad );
+    setChanged( "calculateTHD", scope.analysis.calculateTHD );
+    setChanged( "spectrumZoom", scope.analysis.spectrumZoom );
+    setChanged( "spectrumZoomCenter", scope.analysis.spectrumZoomCenter );
+    setChanged( "spectrumZoomSpan", scope.analysis.spectrumZoomSpan );
+    setChanged( "reuseFftPlan", analysis.reuseFftPlan );
+    setChanged( "singlePrecisionFft", analysis.singlePrecisionFft );
+    setChanged( "spectrumLength", analysis.spectrumLength );
+    setChanged( "measurementStride", analysis.measurementStride );
+    setChanged( "showNoteValue", scope.analysis.showNoteValue );
+    setChanged( "decoderMode", int( analysis.decoderMode ) );
+    setChanged( "decoderDataChannel", analysis.decoderDataChannel );
+    setChanged( "decoderClockChannel", analysis.decoderClockChannel );
+    setChanged( "decoderBaud", analysis.decoderBaud );
+    setChanged( "decoderSpiMode", analysis.decoderSpiMode );
+    setChanged( "decoderThreshold", analysis.decoderThreshold );
     storeSettings->endGroup(); // analysis
     storeSettings->endGroup(); // scope
 
@@ -462,38 +509,114 @@ void DsoSettings::save() {
             storeSettings->beginGroup( "print" );
         }
 
-        storeSettings->setValue( "axes", colors->axes.name( QColor::HexArgb ) );
-        storeSettings->setValue( "background", colors->background.name( QColor::HexArgb ) );
-        storeSettings->setValue( "border", colors->border.name( QColor::HexArgb ) );
-        storeSettings->setValue( "grid", colors->grid.name( QColor::HexArgb ) );
-        storeSettings->setValue( "markers", colors->markers.name( QColor::HexArgb ) );
+        setChanged( "axes", colors->axes.name( QColor::HexArgb ) );
+        setChanged( "background", colors->background.name( QColor::HexArgb ) );
+        setChanged( "border", colors->border.name( QColor::HexArgb ) );
+        setChanged( "grid", colors->grid.name( QColor::HexArgb ) );
+        setChanged( "markers", colors->markers.name( QColor::HexArgb ) );
         for ( ChannelID channel = 0; channel < scope.spectrum.size(); ++channel )
-            storeSettings->setValue( QString( "spectrum%1" ).arg( channel ), colors->spectrum[ channel ].name( QColor::HexArgb ) );
-        storeSettings->setValue( "text", colors->text.name( QColor::HexArgb ) );
+            setChanged( QString( "spectrum%1" ).arg( channel ), colors->spectrum[ channel ].name( QColor::HexArgb ) );
+        setChanged( "text", colors->text.name( QColor::HexArgb ) );
         for ( ChannelID channel = 0; channel < scope.voltage.size(); ++channel )
-            storeSettings->setValue( QString( "voltage%1" ).arg( channel ), colors->voltage[ channel ].name( QColor::HexArgb ) );
+            setChanged( QString( "voltage%1" ).arg( channel ), colors->voltage[ channel ].name( QColor::HexArgb ) );
         storeSettings->endGroup(); // screen / print
     }
     storeSettings->endGroup(); // color
 
     // Other view settings
-    storeSettings->setValue( "histogram", scope.histogram );
-    storeSettings->setValue( "digitalPhosphor", view.digitalPhosphor );
-    storeSettings->setValue( "interpolation", view.interpolation );
-    storeSettings->setValue( "printerColorImages", view.printerColorImages );
-    storeSettings->setValue( "zoom", view.zoom );
-    storeSettings->setValue( "zoomHeightIndex", view.zoomHeightIndex );
-    storeSettings->setValue( "zoomImage", view.zoomImage );
-    storeSettings->setValue( "exportScaleValue", view.exportScaleValue );
-    storeSettings->setValue( "cursorGridPosition", view.cursorGridPosition );
-    storeSettings->setValue( "cursorsVisible", view.cursorsVisible );
+    setChanged( "histogram", scope.histogram );
+    setChanged( "waterfall", scope.waterfall );
+    setChanged( "digitalPhosphor", view.digitalPhosphor );
+    setChanged( "interpolation", view.interpolation );
+    setChanged( "printerColorImages", view.printerColorImages );
+    setChanged( "zoom", view.zoom );
+    setChanged( "zoomHeightIndex", view.zoomHeightIndex );
+    setChanged( "zoomImage", view.zoomImage );
+    setChanged( "exportScaleValue", view.exportScaleValue );
+    setChanged( "cursorGridPosition", view.cursorGridPosition );
+    setChanged( "cursorsVisible", view.cursorsVisible );
     storeSettings->endGroup(); // view
 
     // Program window geometry and state
     storeSettings->beginGroup( "window" );
-    storeSettings->setValue( "geometry", mainWindowGeometry );
-    storeSettings->setValue( "state", mainWindowState );
+    setChanged( "geometry", mainWindowGeometry );
+    setChanged( "state", mainWindowState );
     storeSettings->endGroup(); // window
+
+    // Date and Time of last storage - only if a setting really changed, writing the
+    // timestamp unconditionally would dirty the store and force a full rewrite
+    if ( storeDirty ) {
+        storeSettings->beginGroup( "ConfigurationSaved" );
+        storeSettings->setValue( "Date", QDate::currentDate().toString( "yyyy-MM-dd" ) );
+        storeSettings->setValue( "Time", QTime::currentTime().toString( "HH:mm:ss" ) );
+        storeSettings->endGroup(); // ConfigurationSaved
+    } else if ( verboseLevel > 1 )
+        qDebug() << " DsoSettings::save() nothing changed, store stays untouched";
+}
+
+
+void DsoSettings::setChanged( const QString &key, const QVariant &value ) {
+    if ( storeSettings->value( key ) != value ) {
+        storeSettings->setValue( key, value );
+        storeDirty = true;
+    }
+}
+
+
+QByteArray DsoSettings::channelBlob() const {
+    QByteArray blob;
+    QDataStream stream( &blob, QIODevice::WriteOnly );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    stream << quint32( 1 ) << quint32( scope.spectrum.size() ); // blob version and channel count
+    for ( ChannelID channel = 0; channel < scope.spectrum.size(); ++channel ) {
+        const DsoSettingsScopeSpectrum &spectrum = scope.spectrum[ channel ];
+        stream << spectrum.magnitude << spectrum.offset << spectrum.used << qint32( spectrum.mode );
+        stream << quint32( spectrum.cursor.shape ) << spectrum.cursor.pos[ 0 ] << spectrum.cursor.pos[ 1 ];
+        const DsoSettingsScopeVoltage &voltage = scope.voltage[ channel ];
+        stream << quint32( voltage.gainStepIndex ) << quint32( voltage.couplingOrMathIndex ) << voltage.inverted
+               << voltage.offset << voltage.trigger << voltage.probeAttn << voltage.used;
+        stream << quint32( voltage.cursor.shape ) << voltage.cursor.pos[ 0 ] << voltage.cursor.pos[ 1 ];
+    }
+    return blob;
+}
+
+
+bool DsoSettings::loadChannelBlob( const QByteArray &blob ) {
+    QDataStream stream( blob );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> version >> count;
+    if ( version != 1 || count != scope.spectrum.size() )
+        return false; // let the caller fall back to the legacy keys / defaults
+    for ( ChannelID channel = 0; channel < count; ++channel ) {
+        DsoSettingsScopeSpectrum &spectrum = scope.spectrum[ channel ];
+        qint32 spectrumMode = 0;
+        quint32 cursorShape = 0;
+        quint32 unsignedValue = 0;
+        stream >> spectrum.magnitude >> spectrum.offset >> spectrum.used >> spectrumMode;
+        spectrum.mode = SpectrumMode( spectrumMode );
+        stream >> cursorShape >> spectrum.cursor.pos[ 0 ] >> spectrum.cursor.pos[ 1 ];
+        spectrum.cursor.shape = DsoSettingsScopeCursor::CursorShape( cursorShape );
+        DsoSettingsScopeVoltage &voltage = scope.voltage[ channel ];
+        stream >> unsignedValue;
+        voltage.gainStepIndex = unsignedValue;
+        stream >> unsignedValue;
+        voltage.couplingOrMathIndex = unsignedValue;
+        stream >> voltage.inverted >> voltage.offset >> voltage.trigger >> voltage.probeAttn >> voltage.used;
+        stream >> cursorShape >> voltage.cursor.pos[ 0 ] >> voltage.cursor.pos[ 1 ];
+        voltage.cursor.shape = DsoSettingsScopeCursor::CursorShape( cursorShape );
+        // the same range checks as for the legacy keys
+        if ( channel < deviceSpecification->channels ) {
+            if ( voltage.couplingOrMathIndex >= deviceSpecification->couplings.size() ||
+                 ( !scope.hasACcoupling && !scope.hasACmodification ) )
+                voltage.couplingOrMathIndex = 0; // set to default if out of range
+        } else {
+            if ( voltage.couplingOrMathIndex > unsigned( Dso::LastMathMode ) )
+                voltage.couplingOrMathIndex = 0;
+        }
+    }
+    return stream.status() == QDataStream::Ok;
 }
 
 
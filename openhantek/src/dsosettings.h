@@ -29,6 +29,7 @@ class DsoSettings {
     DsoSettingsView view;                    ///< All view related settings
     DsoSettingsAnalysis analysis;            ///< All post processing analysis related settings
     bool exportProcessedSamples = true;      ///< Used for exporting
+    unsigned exportSegmentCount = 1000;      ///< Trigger segments collected by the segmented capture exporter
     bool alwaysSave = true;                  ///< Always save the settings on exit
     unsigned configVersion = CONFIG_VERSION; ///< Handle incompatible changes
     const QString deviceName;                ///< the human readable device name, e.g. DSO-6022BE
@@ -48,6 +49,14 @@ class DsoSettings {
     std::unique_ptr< QSettings > storeSettings;
     const Dso::ControlSpecification *deviceSpecification;
     void setDefaultConfig();
+    /// \brief Write a key only if the stored value differs. QSettings marks the
+    /// store dirty on every setValue(), even with an identical value, and then
+    /// rewrites the whole file on sync - expensive on network homes.
+    void setChanged( const QString &key, const QVariant &value );
+    QByteArray channelBlob() const;                 ///< all per channel settings serialized into one value
+    bool loadChannelBlob( const QByteArray &blob ); ///< false if version or channel layout does not match
+    void loadChannelsLegacy();                      ///< per key channel groups of configs from before the blob
+    bool storeDirty = false;                        ///< a setChanged() call wrote a new value
     int verboseLevel = 0;
     bool resetSettings = false;
 };
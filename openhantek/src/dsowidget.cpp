@@ -25,9 +25,18 @@
 #include "widgets/levelslider.h"
 
 
+/// \brief Change a label text only if it differs from the displayed one.
+/// QLabel::setText() triggers fontmetrics and layout work even for an unchanged
+/// string, which adds up over a dozen measurement labels at display rate.
+static void setLabelText( QLabel *label, const QString &text ) {
+    if ( label->text() != text )
+        label->setText( text );
+}
+
+
 DsoWidget::DsoWidget( DsoSettingsScope *scope, DsoSettingsView *view, const Dso::ControlSpecification *spec, QWidget *parent )
     : QWidget( parent ), scope( scope ), view( view ), spec( spec ), mainScope( GlScope::createNormal( scope, view ) ),
-      zoomScope( GlScope::createZoomed( scope, view ) ) {
+      zoomScope( GlScope::createZoomed( scope, view, mainScope ) ) {
 
     if ( scope->verboseLevel > 1 )
         qDebug() << " DsoWidget::DsoWidget()";
@@ -57,6 +66,18 @@ DsoWidget::DsoWidget( DsoSettingsScope *scope, DsoSettingsView *view, const Dso:
         zoomScope->updateCursor( cursorIndex );
     } );
 
+    // The measurement labels follow the data at 10 Hz instead of at frame rate;
+    // the first block of a burst is shown at once, later ones coalesce into the
+    // next timer tick (unchanged labels are skipped there anyway).
+    measurementTimer.setInterval( 100 );
+    measurementTimer.setSingleShot( true );
+    connect( &measurementTimer, &QTimer::timeout, this, [ this ]() {
+        if ( measurementData && measurementData->tag != measurementShownTag ) {
+            updateMeasurements();
+            measurementTimer.start(); // keep the cadence while new data arrives
+        }
+    } );
+
     // do cursor measurement when right button pressed/moved _inside_ window borders
     connect( mainScope, &GlScope::cursorMeasurement, this, [ this ]( QPointF mPos, QPoint gPos, bool status ) {
         cursorMeasurementPosition = mPos;
@@ -89,9 +110,13 @@ DsoWidget::DsoWidget( DsoSettingsScope *scope, DsoSettingsView *view, const Dso:
     swTriggerStatus->setMinimumWidth( 20 );
     swTriggerStatus->setAutoFillBackground( true );
     swTriggerStatus->setVisible( false );
+    pipelineHealthLabel = new QLabel();
+    pipelineHealthLabel->setPalette( palette );
+    pipelineHealthLabel->setVisible( false ); // shown on the first counted data loss
     settingsLayout = new QHBoxLayout();
     settingsLayout->addWidget( swTriggerStatus, 0, Qt::AlignCenter );
     settingsLayout->addWidget( settingsTriggerLabel );
+    settingsLayout->addWidget( pipelineHealthLabel, 0, Qt::AlignLeft );
     settingsLayout->addWidget( settingsSamplesOnScreen, 1, Qt::AlignRight );
     settingsLayout->addWidget( settingsSamplerateLabel, 1, Qt::AlignRight );
     settingsLayout->addWidget( settingsTimebaseLabel, 1, Qt::AlignRight );
@@ -323,6 +348,31 @@ void DsoWidget::restoreScreenColors() {
 }
 
 
+/// \brief Apply an edited color scheme to the labels, the sliders and both scope
+/// screens in one batch after the config dialog saved it.
+void DsoWidget::updateColors() {
+    setColors();
+    mainScope->update();
+    zoomScope->update();
+}
+
+
+void DsoWidget::freezeReferenceTrace() {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  DsoWidget::freezeReferenceTrace()";
+    mainScope->freezeReferenceTrace();
+    zoomScope->update();
+}
+
+
+void DsoWidget::clearReferenceTrace() {
+    if ( scope->verboseLevel > 2 )
+        qDebug() << "  DsoWidget::clearReferenceTrace()";
+    mainScope->clearReferenceTrace();
+    zoomScope->update();
+}
+
+
 void DsoWidget::setColors() {
     if ( scope->verboseLevel > 2 )
         qDebug() << "  DsoWidget::setColors()";
@@ -563,9 +613,46 @@ void DsoWidget::setMeasurementVisible( ChannelID channel ) {
 
 
 /// \brief Update the label about the marker measurements
+/// All displayed values derive from the settings (marker and cursor positions,
+/// time/frequency base, gain and magnitude) - not from the sample data - so one
+/// computation per distinct input set is enough. The change handlers call this
+/// liberally (every step of a marker drag, several times per settings change);
+/// an unchanged input signature skips the formatting and QLabel relayout work.
+/// A future data dependent cursor measurement (e.g. area between the markers)
+/// belongs into the post processing chain with its result tag joining the
+/// signature, not into this GUI thread path.
 void DsoWidget::updateMarkerDetails() {
     if ( nullptr == cursorDataGrid ) // not yet initialized
         return;
+    markerSignature.clear();
+    markerSignature.push_back( scope->horizontal.cursor.pos[ 0 ].x() );
+    markerSignature.push_back( scope->horizontal.cursor.pos[ 1 ].x() );
+    markerSignature.push_back( scope->horizontal.timebase );
+    markerSignature.push_back( scope->horizontal.frequencybase );
+    markerSignature.push_back( view->zoom ? 1.0 : 0.0 );
+    markerSignature.push_back( double( scope->analysis.dBsuffixIndex ) );
+    for ( ChannelID channel = 0; channel < scope->voltage.size(); ++channel ) {
+        const DsoSettingsScopeCursor &cursor = scope->voltage[ channel ].cursor;
+        markerSignature.push_back( scope->voltage[ channel ].used ? double( cursor.shape ) : -1.0 );
+        markerSignature.push_back( cursor.pos[ 0 ].x() );
+        markerSignature.push_back( cursor.pos[ 0 ].y() );
+        markerSignature.push_back( cursor.pos[ 1 ].x() );
+        markerSignature.push_back( cursor.pos[ 1 ].y() );
+        markerSignature.push_back( scope->gain( channel ) );
+        markerSignature.push_back( double( voltageUnits[ channel ] ) );
+    }
+    for ( ChannelID channel = 0; channel < scope->spectrum.size(); ++channel ) {
+        const DsoSettingsScopeCursor &cursor = scope->spectrum[ channel ].cursor;
+        markerSignature.push_back( scope->spectrum[ channel ].used ? double( cursor.shape ) : -1.0 );
+        markerSignature.push_back( cursor.pos[ 0 ].x() );
+        markerSignature.push_back( cursor.pos[ 0 ].y() );
+        markerSignature.push_back( cursor.pos[ 1 ].x() );
+        markerSignature.push_back( cursor.pos[ 1 ].y() );
+        markerSignature.push_back( scope->spectrum[ channel ].magnitude );
+    }
+    if ( markerSignature == lastMarkerSignature )
+        return; // the shown labels are still valid
+    lastMarkerSignature.swap( markerSignature );
     if ( scope->verboseLevel > 2 )
         qDebug() << "  DsoWidget::updateMarkerDetails()";
     double m1 = scope->horizontal.cursor.pos[ 0 ].x() + DIVS_TIME / 2; // zero at center -> zero at left margin
@@ -646,30 +733,30 @@ void DsoWidget::updateMarkerDetails() {
                 zoomFactor = 1000;
                 mInfo = tr( "Zoom ---  " );
             }
-            markerTimebaseLabel->setText( "  " + valueToString( time / DIVS_TIME, UNIT_SECONDS, 3 ) + tr( "/div" ) );
+            setLabelText( markerTimebaseLabel, "  " + valueToString( time / DIVS_TIME, UNIT_SECONDS, 3 ) + tr( "/div" ) );
             markerTimebaseLabel->setVisible( timeUsed );
-            markerFrequencybaseLabel->setText( "  " + valueToString( freq / DIVS_TIME, UNIT_HERTZ, 3 ) + tr( "/div" ) );
+            setLabelText( markerFrequencybaseLabel, "  " + valueToString( freq / DIVS_TIME, UNIT_HERTZ, 3 ) + tr( "/div" ) );
             markerFrequencybaseLabel->setVisible( freqUsed );
         }
-        markerInfoLabel->setText( mInfo );
+        setLabelText( markerInfoLabel, mInfo );
         if ( timeUsed ) {
             mTime += QString( "%1" ).arg( valueToString( time0, UNIT_SECONDS, 3 ) );
             if ( time > 0 )
                 mTime += QString( " ... %1,  Δt: %2 (%3) " )
                              .arg( valueToString( time1, UNIT_SECONDS, 3 ), valueToString( time, UNIT_SECONDS, 3 ),
                                    valueToString( 1 / time, UNIT_HERTZ, 3 ) );
-            markerTimeLabel->setText( mTime );
+            setLabelText( markerTimeLabel, mTime );
         } else {
-            markerTimeLabel->setText( "" );
+            setLabelText( markerTimeLabel, "" );
         }
         if ( freqUsed ) {
             mFreq += QString( "%1" ).arg( valueToString( freq0, UNIT_HERTZ, 3 ) );
             if ( freq > 0 )
                 mFreq += QString( " ... %2,  Δf: %3 " )
                              .arg( valueToString( freq1, UNIT_HERTZ, 3 ), valueToString( freq, UNIT_HERTZ, 3 ) );
-            markerFrequencyLabel->setText( mFreq );
+            setLabelText( markerFrequencyLabel, mFreq );
         } else
-            markerFrequencyLabel->setText( "" );
+            setLabelText( markerFrequencyLabel, "" );
     }
 
     QString markerMeasureTimeLabel;
@@ -717,12 +804,12 @@ void DsoWidget::updateTriggerDetails() {
         pulseWidthString += " (" + QString::number( dutyCyle ) + "%)";
     }
     if ( !scope->liveCalibrationActive && scope->trigger.mode != Dso::TriggerMode::ROLL ) {
-        settingsTriggerLabel->setText( tr( "%1  %2  %3  %4  %5" )
-                                           .arg( scope->voltage[ unsigned( scope->trigger.source ) ].name,
-                                                 Dso::slopeString( scope->trigger.slope ), levelString, pretriggerString,
-                                                 pulseWidthString ) );
+        setLabelText( settingsTriggerLabel, tr( "%1  %2  %3  %4  %5" )
+                                                .arg( scope->voltage[ unsigned( scope->trigger.source ) ].name,
+                                                      Dso::slopeString( scope->trigger.slope ), levelString, pretriggerString,
+                                                      pulseWidthString ) );
     } else {
-        settingsTriggerLabel->setText( "" );
+        setLabelText( settingsTriggerLabel, "" );
     }
 }
 
@@ -887,7 +974,7 @@ void DsoWidget::updateVoltageUsed( ChannelID channel, bool used ) {
 
 /// \brief Change the record length.
 void DsoWidget::updateRecordLength( int size ) {
-    settingsSamplesOnScreen->setText( valueToString( double( size ), UNIT_SAMPLES, -1 ) + tr( " on screen" ) );
+    setLabelText( settingsSamplesOnScreen, valueToString( double( size ), UNIT_SAMPLES, -1 ) + tr( " on screen" ) );
 }
 
 
@@ -936,7 +1023,33 @@ void DsoWidget::wheelEvent( QWheelEvent *event ) {
 
 
 /// \brief Prints analyzed data.
-void DsoWidget::showNew( std::shared_ptr< PPresult > analysedData ) {
+/// \brief Show the pipeline health counters at the screen top. The overlay stays
+/// hidden as long as no data was lost; the untriggered block count alone does not
+/// reveal it, a free running trace without signal is not a degradation.
+void DsoWidget::showPipelineHealth( unsigned shortReads, unsigned usbRetries, unsigned zeroFilled, unsigned triggerOverruns,
+                                    int captureCpu ) {
+    if ( shortReads == lastPipelineHealth[ 0 ] && usbRetries == lastPipelineHealth[ 1 ] &&
+         zeroFilled == lastPipelineHealth[ 2 ] && triggerOverruns == lastPipelineHealth[ 3 ] )
+        return; // unchanged, keep the displayed text
+    lastPipelineHealth[ 0 ] = shortReads;
+    lastPipelineHealth[ 1 ] = usbRetries;
+    lastPipelineHealth[ 2 ] = zeroFilled;
+    lastPipelineHealth[ 3 ] = triggerOverruns;
+    if ( shortReads || usbRetries || zeroFilled ) {
+        QString text = tr( "Lost: %1 short, %2 retried, %3 filled, %4 untriggered" )
+                           .arg( shortReads )
+                           .arg( usbRetries )
+                           .arg( zeroFilled )
+                           .arg( triggerOverruns );
+        if ( captureCpu >= 0 ) // where the stream path runs helps to judge cross-cluster losses
+            text += tr( ", capture on CPU %1" ).arg( captureCpu );
+        pipelineHealthLabel->setText( text );
+        pipelineHealthLabel->setVisible( true );
+    }
+}
+
+
+void DsoWidget::showNew( const std::shared_ptr< PPresult > &analysedData ) {
     if ( scope->verboseLevel > 4 )
         qDebug() << "    DsoWidget::showNew()" << analysedData->tag;
     mainScope->showData( analysedData );
@@ -944,7 +1057,7 @@ void DsoWidget::showNew( std::shared_ptr< PPresult > analysedData ) {
 
     QPalette triggerLabelPalette = palette();
     if ( scope->liveCalibrationActive ) {
-        swTriggerStatus->setText( tr( "<b> OFFSET CALIBRATION </b>" ) );
+        setLabelText( swTriggerStatus, tr( "<b> OFFSET CALIBRATION </b>" ) );
         triggerLabelPalette.setColor( QPalette::WindowText, Qt::black );
         triggerLabelPalette.setColor( QPalette::Window, Qt::red );
         swTriggerStatus->setPalette( triggerLabelPalette );
@@ -952,12 +1065,29 @@ void DsoWidget::showNew( std::shared_ptr< PPresult > analysedData ) {
     } else if ( scope->trigger.mode == Dso::TriggerMode::ROLL ) {
         swTriggerStatus->setVisible( false );
     } else {
-        swTriggerStatus->setText( tr( "TR" ) );
+        setLabelText( swTriggerStatus, tr( "TR" ) );
         triggerLabelPalette.setColor( QPalette::WindowText, Qt::black );
         triggerLabelPalette.setColor( QPalette::Window, analysedData->softwareTriggerTriggered ? Qt::green : Qt::red );
         swTriggerStatus->setPalette( triggerLabelPalette );
         swTriggerStatus->setVisible( true );
     }
+
+    // Defer the label work to the coalescing timer; only the first block after an
+    // idle period is shown immediately so single shots appear without delay.
+    measurementData = analysedData;
+    if ( !measurementTimer.isActive() ) {
+        updateMeasurements();
+        measurementTimer.start();
+    }
+}
+
+
+/// \brief Refresh the measurement labels from the newest result.
+/// Runs at the pace of the coalescing timer, not once per frame; unchanged
+/// formatted values are skipped to avoid needless QLabel relayout.
+void DsoWidget::updateMeasurements() {
+    const std::shared_ptr< PPresult > &analysedData = measurementData;
+    measurementShownTag = analysedData->tag;
     const size_t CH1 = 0;
     // const size_t CH2 = 1;
     const size_t MATH = 2;
@@ -1001,43 +1131,43 @@ void DsoWidget::showNew( std::shared_ptr< PPresult > analysedData ) {
                 }
             }
             // Vpp Amplitude string representation (3 significant digits)
-            measurementVppLabel[ channel ]->setText( valueToString( data->vmax - data->vmin, voltageUnit, 3 ) + tr( "pp" ) );
+            setLabelText( measurementVppLabel[ channel ], valueToString( data->vmax - data->vmin, voltageUnit, 3 ) + tr( "pp" ) );
             // DC Amplitude string representation (3 significant digits)
-            measurementDCLabel[ channel ]->setText( valueToString( data->dc, voltageUnit, 3 ) + "=" );
+            setLabelText( measurementDCLabel[ channel ], valueToString( data->dc, voltageUnit, 3 ) + "=" );
             // AC Amplitude string representation (3 significant digits)
-            measurementACLabel[ channel ]->setText( valueToString( data->ac, voltageUnit, 3 ) + "~" );
+            setLabelText( measurementACLabel[ channel ], valueToString( data->ac, voltageUnit, 3 ) + "~" );
             // RMS Amplitude string representation (3 significant digits)
-            measurementRMSLabel[ channel ]->setText( valueToString( data->rms, voltageUnit, 3 ) + tr( "rms" ) );
+            setLabelText( measurementRMSLabel[ channel ], valueToString( data->rms, voltageUnit, 3 ) + tr( "rms" ) );
             // dB Amplitude string representation (3 significant digits)
-            measurementdBLabel[ channel ]->setText( valueToString( data->dB, UNIT_DECIBEL, 3 ) + scope->analysis.dBsuffix() );
+            setLabelText( measurementdBLabel[ channel ], valueToString( data->dB, UNIT_DECIBEL, 3 ) + scope->analysis.dBsuffix() );
             // Frequency string representation (3 significant digits)
-            measurementFrequencyLabel[ channel ]->setText( valueToString( data->frequency, UNIT_HERTZ, 4 ) );
+            setLabelText( measurementFrequencyLabel[ channel ], valueToString( data->frequency, UNIT_HERTZ, 4 ) );
             // Frequency note representation
             if ( scope->analysis.showNoteValue ) {
                 measurementLayout->setColumnStretch( 12, 3 );
-                measurementNoteLabel[ channel ]->setText( data->note );
+                setLabelText( measurementNoteLabel[ channel ], data->note );
             } else { // do not show this label
-                measurementNoteLabel[ channel ]->setText( "" );
+                setLabelText( measurementNoteLabel[ channel ], "" );
                 measurementLayout->setColumnStretch( 12, 0 ); // Note
             }
             // RMS Amplitude string representation (3 significant digits)
             if ( scope->analysis.calculateDummyLoad && scope->analysis.dummyLoad > 0 ) {
                 measurementLayout->setColumnStretch( 9, 3 );
-                measurementRMSPowerLabel[ channel ]->setText(
-                    valueToString( ( data->rms * data->rms ) / scope->analysis.dummyLoad, UNIT_WATTS, 3 ) );
+                setLabelText( measurementRMSPowerLabel[ channel ],
+                              valueToString( ( data->rms * data->rms ) / scope->analysis.dummyLoad, UNIT_WATTS, 3 ) );
             } else { // do not show this label
-                measurementRMSPowerLabel[ channel ]->setText( "" );
+                setLabelText( measurementRMSPowerLabel[ channel ], "" );
                 measurementLayout->setColumnStretch( 9, 0 ); // Power
             }
             if ( scope->analysis.calculateTHD ) {
                 double thd = data->thd;
                 measurementLayout->setColumnStretch( 10, 2 );
                 if ( thd > 0 ) // display either xx.x% or xxx%
-                    measurementTHDLabel[ channel ]->setText( QString( "%1%" ).arg( thd * 100, 4, 'f', thd < 1 ? 1 : 0 ) );
+                    setLabelText( measurementTHDLabel[ channel ], QString( "%1%" ).arg( thd * 100, 4, 'f', thd < 1 ? 1 : 0 ) );
                 else // invalid, blank label
-                    measurementTHDLabel[ channel ]->setText( "" );
+                    setLabelText( measurementTHDLabel[ channel ], "" );
             } else { // do not show this label
-                measurementTHDLabel[ channel ]->setText( "" );
+                setLabelText( measurementTHDLabel[ channel ], "" );
                 measurementLayout->setColumnStretch( 10, 0 ); // THD
             }
         }
@@ -6,6 +6,7 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QList>
+#include <QTimer>
 #include <memory>
 
 #include "glscope.h"
@@ -41,7 +42,11 @@ class DsoWidget : public QWidget {
     ~DsoWidget() override;
 
     // Data arrived
-    void showNew( std::shared_ptr< PPresult > analysedData );
+    void showNew( const std::shared_ptr< PPresult > &analysedData );
+
+    // Capture pipeline health counters, see HantekDsoControl::pipelineHealth()
+    void showPipelineHealth( unsigned shortReads, unsigned usbRetries, unsigned zeroFilled, unsigned triggerOverruns,
+                             int captureCpu );
 
     void switchToPrintColors();
     void restoreScreenColors();
@@ -53,6 +58,7 @@ class DsoWidget : public QWidget {
     void adaptTriggerPositionSlider();
     void setMeasurementVisible( ChannelID channel );
     void updateMarkerDetails();
+    void updateMeasurements();
     void updateSpectrumDetails( ChannelID channel );
     void updateTriggerDetails();
     void updateVoltageDetails( ChannelID channel );
@@ -74,6 +80,9 @@ class DsoWidget : public QWidget {
 
     QLabel *swTriggerStatus; ///< The status of SW trigger
 
+    QLabel *pipelineHealthLabel;           ///< Small statistics overlay, visible only after data loss
+    unsigned lastPipelineHealth[ 4 ] = { 0, 0, 0, 0 }; ///< last shown counters, update only on change
+
     QHBoxLayout *markerLayout;        ///< The table for the marker details
     QLabel *markerInfoLabel;          ///< The info about the zoom factor
     QLabel *markerTimeLabel;          ///< The time period between the markers
@@ -106,6 +115,15 @@ class DsoWidget : public QWidget {
     GlScope *zoomScope; ///< The optional magnified scope screen
 
   private:
+    /// The measurement labels are refreshed from here at timer pace, not at frame
+    /// rate - QLabel relayout and fontmetrics work is surprisingly expensive.
+    std::shared_ptr< PPresult > measurementData; ///< the newest result, shown at the next refresh
+    unsigned measurementShownTag = 0;            ///< tag of the last refreshed result
+    QTimer measurementTimer;                     ///< coalesces the label updates to 10 Hz
+    /// All inputs of the marker/cursor labels flattened into one vector; a call of
+    /// updateMarkerDetails() with an unchanged signature skips the recomputation.
+    std::vector< double > markerSignature;     ///< scratch, rebuilt on every call
+    std::vector< double > lastMarkerSignature; ///< inputs of the currently shown labels
     double samplerate;
     double timebase;
     double pulseWidth1 = 0.0;
@@ -155,6 +173,11 @@ class DsoWidget : public QWidget {
 
     // Scope control
     void updateSlidersSettings();
+    void updateColors();
+
+    // Reference trace overlay (menu View)
+    void freezeReferenceTrace();
+    void clearReferenceTrace();
 
   private slots:
     // Sliders
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "exportbin.h"
+#include "exporterregistry.h"
+#include "utils/samplecodec.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QMessageBox>
+#include <QStandardPaths>
+
+#include <cstring>
+
+ExporterBIN::ExporterBIN() {}
+
+ExporterBIN::~ExporterBIN() {
+    writer.wait();
+    if ( file.isOpen() )
+        file.close();
+}
+
+void ExporterBIN::create( ExporterRegistry *newRegistry ) {
+    registry = newRegistry;
+    writer.wait(); // no job in flight beyond this point
+    QMutexLocker lock( &mutex );
+    if ( file.isOpen() )
+        file.close();
+    stageBuffer.clear();
+    active = false;
+    writeFailed = false;
+    lastTag = 0;
+    droppedBlocks = 0;
+    totalBytes = 0;
+}
+
+QString ExporterBIN::name() { return tr( "Record &binary" ); }
+
+QString ExporterBIN::format() { return "OHRECB02"; }
+
+ExporterInterface::Type ExporterBIN::type() { return Type::ContinuousExport; }
+
+bool ExporterBIN::samples( const std::shared_ptr< PPresult > & ) {
+    // The registry result stream only starts and keeps the recording alive, the
+    // recorded data arrives unpaced through rawBlock().
+    QMutexLocker lock( &mutex );
+    if ( !active && !writeFailed )
+        active = openFile();
+    return true; // continuous, keep receiving until the user disables the exporter
+}
+
+bool ExporterBIN::openFile() {
+    QString dir = QStandardPaths::writableLocation( QStandardPaths::DocumentsLocation );
+    if ( dir.isEmpty() )
+        dir = QDir::homePath();
+    file.setFileName( dir + "/" + QCoreApplication::applicationName() + "_" +
+                      QDateTime::currentDateTime().toString( "yyyy-MM-dd_hh-mm-ss" ) + ".ohrec" );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        writeFailed = true;
+        return false;
+    }
+    FileHeader header;
+    memcpy( header.magic, "OHRECB02", sizeof( header.magic ) ); // 02: SampleCodec compressed payload
+    header.fileHeaderBytes = sizeof( FileHeader );
+    header.blockHeaderBytes = sizeof( BlockHeader );
+    if ( file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) ) != sizeof( header ) ) {
+        writeFailed = true;
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+void ExporterBIN::rawBlock( const std::vector< unsigned char > *data, unsigned channels, double samplerate, unsigned oversampling,
+                            const unsigned *gainValue, unsigned tag ) {
+    QMutexLocker lock( &mutex );
+    if ( !active || writeFailed || data->empty() )
+        return;
+    if ( tag == lastTag ) // a refresh re-conversion of an already recorded block
+        return;
+    lastTag = tag;
+    // delta compress the block before staging; several hundred MB/s, so this costs
+    // far less than it saves in disk bandwidth and staging headroom
+    codecBuffer.resize( SampleCodec::compressBound( data->size() ) );
+    const size_t compressedBytes = SampleCodec::compress( data->data(), data->size(), channels, codecBuffer.data() );
+    if ( stageBuffer.size() + sizeof( BlockHeader ) + compressedBytes > stageLimit ) {
+        ++droppedBlocks; // the disk cannot keep up, drop the block instead of growing
+        return;
+    }
+    BlockHeader header;
+    memcpy( header.magic, "RBLK", sizeof( header.magic ) );
+    header.dataBytes = uint32_t( compressedBytes );
+    header.samplerate = samplerate;
+    header.tag = tag;
+    header.channels = uint16_t( channels );
+    header.oversampling = uint16_t( oversampling );
+    header.gainValue[ 0 ] = uint16_t( gainValue[ 0 ] );
+    header.gainValue[ 1 ] = uint16_t( gainValue[ 1 ] );
+    header.rawBytes = uint32_t( data->size() );
+    const unsigned char *headerBytes = reinterpret_cast< const unsigned char * >( &header );
+    stageBuffer.insert( stageBuffer.end(), headerBytes, headerBytes + sizeof( header ) );
+    stageBuffer.insert( stageBuffer.end(), codecBuffer.begin(), codecBuffer.begin() + long( compressedBytes ) );
+    if ( writerIdle ) { // kick the background writer, it drains until the staging is empty
+        writerIdle = false;
+        writer.start( [ this ]() { drain(); } );
+    }
+}
+
+void ExporterBIN::drain() {
+    QMutexLocker lock( &mutex );
+    while ( !stageBuffer.empty() && !writeFailed ) {
+        writeBuffer.swap( stageBuffer ); // both keep their capacity across blocks
+        stageBuffer.clear();
+        lock.unlock(); // write without blocking the capture side
+        qint64 written = file.write( reinterpret_cast< const char * >( writeBuffer.data() ), qint64( writeBuffer.size() ) );
+        lock.relock();
+        if ( written != qint64( writeBuffer.size() ) )
+            writeFailed = true;
+        else
+            totalBytes += written;
+    }
+    writerIdle = true;
+}
+
+bool ExporterBIN::save() {
+    { // stop accepting blocks, then flush what is still staged
+        QMutexLocker lock( &mutex );
+        active = false;
+    }
+    writer.wait(); // the background writer is idle now
+    drain();       // write the remainder inline
+    QMutexLocker lock( &mutex );
+    if ( file.isOpen() )
+        file.close();
+    if ( writeFailed ) {
+        QMessageBox::critical( nullptr, QCoreApplication::applicationName(), tr( "Write error\n%1" ).arg( file.fileName() ) );
+        return false;
+    }
+    if ( totalBytes == 0 ) {
+        file.remove(); // nothing recorded, don't leave an empty file behind
+        return false;
+    }
+    QString message = tr( "Recorded %1 MB to\n%2" ).arg( double( totalBytes ) / 1e6, 0, 'f', 1 ).arg( file.fileName() );
+    if ( droppedBlocks )
+        message += tr( "\n%1 blocks dropped (storage too slow)" ).arg( droppedBlocks );
+    QMessageBox::information( nullptr, QCoreApplication::applicationName(), message );
+    return true;
+}
+
+float ExporterBIN::progress() {
+    QMutexLocker lock( &mutex );
+    return active || totalBytes > 0 ? 1.0f : 0.0f;
+}
+
+
+size_t ExporterBIN::memoryFootprint() const {
+    QMutexLocker lock( &mutex );
+    return codecBuffer.capacity() + stageBuffer.capacity() + writeBuffer.capacity();
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+#include "exporterinterface.h"
+#include "hantekdso/convertworker.h"
+
+#include <QFile>
+#include <QMutex>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Continuous binary recorder. While enabled it appends every captured raw block to
+ * one file: the 8 bit ADC samples (losslessly delta compressed) plus the per block
+ * metadata needed to convert them offline. The blocks are fed directly from the capture path (see
+ * HantekDsoControl::rawBlockCaptured()), not from the displayed results, so the
+ * display frame pacing never drops a block from the recording.
+ *
+ * The capture side only copies each block into a staging buffer; a background
+ * writer thread appends full staging buffers to the file in large chunks, so a
+ * slow disk stalls neither the capture nor the processing thread. If the disk
+ * falls behind the staging limit, whole blocks are dropped (visible as gaps in
+ * the block tags) instead of growing without bound.
+ *
+ * File layout: one FileHeader, then a sequence of [ BlockHeader + payload ].
+ * All fields are little endian, raw samples are CH1/CH2 interleaved when both
+ * channels are active. Since format version 02 the payload is SampleCodec delta
+ * compressed (rawBytes in the header is the uncompressed count, the codec falls
+ * back to a verbatim copy for incompressible blocks), which cuts the disk rate
+ * and file size of typical signals to a half or third.
+ */
+class ExporterBIN : public ExporterInterface {
+    Q_DECLARE_TR_FUNCTIONS( ExporterBIN )
+
+  public:
+    ExporterBIN();
+    ~ExporterBIN() override;
+    void create( ExporterRegistry *registry ) override;
+    QString name() override;
+    QString format() override;
+    Type type() override;
+    bool samples( const std::shared_ptr< PPresult > & ) override;
+    bool save() override;
+    float progress() override;
+    size_t memoryFootprint() const override;
+
+    /// \brief Record one captured raw block, called via Qt::DirectConnection from the
+    /// processing thread; the block is copied into the staging buffer during the call.
+    /// \param data The raw 8 bit samples, interleaved when channels == 2.
+    /// \param channels Number of interleaved channels in the data.
+    /// \param samplerate The raw samplerate in S/s.
+    /// \param oversampling Raw samples that are averaged into one displayed sample.
+    /// \param gainValue The gain step (1, 2, 5, 10, ...) per channel.
+    /// \param tag The capture tag of the block, gaps reveal dropped blocks.
+    void rawBlock( const std::vector< unsigned char > *data, unsigned channels, double samplerate, unsigned oversampling,
+                   const unsigned *gainValue, unsigned tag );
+
+#pragma pack( push, 1 )
+    /// Once at the start of the file.
+    struct FileHeader {
+        char magic[ 8 ];          ///< "OHRECB01", includes the format version
+        uint32_t fileHeaderBytes; ///< sizeof( FileHeader ), decoder skip offset
+        uint32_t blockHeaderBytes; ///< sizeof( BlockHeader ), decoder skip offset
+    };
+    /// Before each block, immediately followed by dataBytes payload bytes.
+    struct BlockHeader {
+        char magic[ 4 ];           ///< "RBLK", resync mark
+        uint32_t dataBytes;        ///< size of the following compressed payload
+        double samplerate;         ///< raw samplerate in S/s
+        uint32_t tag;              ///< capture tag of the block
+        uint16_t channels;         ///< 1 or 2 interleaved channels
+        uint16_t oversampling;     ///< raw samples averaged into one displayed sample
+        uint16_t gainValue[ 2 ];   ///< gain step (1, 2, 5, 10, ...) per channel
+        uint32_t rawBytes;         ///< uncompressed sample count of the payload, for SampleCodec::decompress()
+    };
+#pragma pack( pop )
+
+  private:
+    bool openFile();
+    void drain(); ///< write all staged data, runs on the writer thread (or inline in save())
+
+    QFile file;
+    mutable QMutex mutex; ///< guards the staging buffer, the counters and the writer handshake
+    std::vector< unsigned char > codecBuffer; ///< compression scratch, keeps its capacity
+    std::vector< unsigned char > stageBuffer; ///< blocks staged by the capture side
+    std::vector< unsigned char > writeBuffer; ///< blocks currently going to disk
+    ConvertWorker writer;                     ///< runs drain() in the background
+    bool writerIdle = true;
+    bool active = false;      ///< samples() started, save() stopped the recording
+    bool writeFailed = false; ///< a file write failed, recording stopped
+    unsigned lastTag = 0;     ///< skip refresh re-conversions of the same block
+    unsigned droppedBlocks = 0;
+    qint64 totalBytes = 0;
+    /// Upper staging bound; at 60 MB/s (dual channel 30 MS/s) this absorbs about
+    /// one second of disk stall before blocks are dropped.
+    static const size_t stageLimit = 64 * 1024 * 1024;
+};
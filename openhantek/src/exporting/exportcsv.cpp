@@ -3,6 +3,7 @@
 #include "exportcsv.h"
 #include "dsosettings.h"
 #include "exporterregistry.h"
+#include "fixedformat.h"
 #include "post/ppresult.h"
 
 #include <QCoreApplication>
@@ -12,6 +13,10 @@
 #include <QMessageBox>
 #include <QTextStream>
 
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
 ExporterCSV::ExporterCSV() {}
 
 void ExporterCSV::create( ExporterRegistry *newRegistry ) {
@@ -25,12 +30,12 @@ QString ExporterCSV::format() { return "CSV"; }
 
 ExporterInterface::Type ExporterCSV::type() { return Type::SnapshotExport; }
 
-bool ExporterCSV::samples( const std::shared_ptr< PPresult > newData ) {
-    data = std::move( newData );
+bool ExporterCSV::samples( const std::shared_ptr< PPresult > &newData ) {
+    data = newData; // keep shared ownership until save() has written the snapshot
     return false;
 }
 
-QFile *ExporterCSV::getFile() {
+QFile *ExporterCSV::chooseDestination() {
     QFileDialog fileDialog( nullptr, tr( "Save CSV" ), QString(), tr( "Comma-Separated Values (*.csv)" ) );
     fileDialog.setFileMode( QFileDialog::AnyFile );
     fileDialog.setAcceptMode( QFileDialog::AcceptSave );
@@ -73,41 +78,51 @@ void ExporterCSV::fillHeaders( QTextStream &csvStream, const ExporterData &dto,
 }
 
 
-void ExporterCSV::fillData( QTextStream &csvStream, const ExporterData &dto, const char *sep ) {
+void ExporterCSV::fillData( QFile *file, const ExporterData &dto, const char *sep ) {
     std::vector< const SampleValues * > voltageData = dto.getVoltageData();
     std::vector< const SampleValues * > spectrumData = dto.getSpectrumData();
 
+    const char decimalPoint = QLocale().decimalPoint().toLatin1();
+    const char separator = sep[ 0 ];
+    const size_t chunkSize = 1 << 20; // one write() per MiB instead of one per cell
+    std::vector< char > chunk( chunkSize + 1024 ); // headroom for the longest row
+    char *p = chunk.data();
+
     for ( unsigned int row = 0; row < dto.getMaxRow(); ++row ) {
 
-        csvStream << QLocale().toString( dto.getTimeInterval() * row );
+        p = formatFixed( p, dto.getTimeInterval() * row, decimalPoint );
         for ( ChannelID channel = 0; channel < dto.getChannelsCount(); ++channel ) {
             if ( voltageData[ channel ] != nullptr ) {
-                csvStream << sep;
-                if ( row < voltageData[ channel ]->samples.size() ) {
-                    csvStream << QLocale().toString( voltageData[ channel ]->samples[ row ] );
+                *p++ = separator;
+                if ( row < voltageData[ channel ]->samples->size() ) {
+                    p = formatFixed( p, ( *voltageData[ channel ]->samples )[ row ], decimalPoint );
                 }
             }
         }
         if ( dto.isSpectrumUsed() ) {
-            csvStream << sep << QLocale().toString( dto.getFreqInterval() * row );
+            *p++ = separator;
+            p = formatFixed( p, dto.getFreqInterval() * row, decimalPoint );
             for ( ChannelID channel = 0; channel < dto.getChannelsCount(); ++channel ) {
                 if ( spectrumData[ channel ] != nullptr ) {
-                    csvStream << sep;
-                    if ( row < spectrumData[ channel ]->samples.size() ) {
-                        csvStream << QLocale().toString( spectrumData[ channel ]->samples[ row ] );
+                    *p++ = separator;
+                    if ( row < spectrumData[ channel ]->samples->size() ) {
+                        p = formatFixed( p, ( *spectrumData[ channel ]->samples )[ row ], decimalPoint );
                     }
                 }
             }
         }
-        csvStream << "\n";
+        *p++ = '\n';
+
+        if ( size_t( p - chunk.data() ) >= chunkSize ) { // chunk full, flush it
+            file->write( chunk.data(), p - chunk.data() );
+            p = chunk.data();
+        }
     }
+    if ( p != chunk.data() )
+        file->write( chunk.data(), p - chunk.data() );
 }
 
-bool ExporterCSV::save() {
-    QFile *file = getFile();
-    if ( file == nullptr )
-        return false;
-
+bool ExporterCSV::write( QFile *file ) {
     QTextStream csvStream( file );
     csvStream.setRealNumberNotation( QTextStream::FixedNotation );
     csvStream.setRealNumberPrecision( 10 );
@@ -118,12 +133,20 @@ bool ExporterCSV::save() {
     const char *sep = QLocale().decimalPoint() == ',' ? ";" : ",";
 
     fillHeaders( csvStream, dto, sep );
-    fillData( csvStream, dto, sep );
+    csvStream.flush(); // the data rows below bypass the stream and write directly
+    fillData( file, dto, sep );
 
+    return true;
+}
+
+bool ExporterCSV::save() { // synchronous fallback, the registry prefers the split path
+    QFile *file = chooseDestination();
+    if ( file == nullptr )
+        return false;
+    bool ok = write( file );
     file->close();
     delete file;
-
-    return true;
+    return ok;
 }
 
 
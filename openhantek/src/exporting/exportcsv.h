@@ -16,13 +16,19 @@ class ExporterCSV : public ExporterInterface {
     QString name() override;
     QString format() override;
     Type type() override;
-    bool samples( const std::shared_ptr< PPresult > newData ) override;
+    bool samples( const std::shared_ptr< PPresult > &newData ) override;
     bool save() override;
+    bool asyncSave() const override { return true; }
+    QFile *chooseDestination() override;
+    bool write( QFile *file ) override;
     float progress() override;
+    size_t memoryFootprint() const override { return data ? data->memoryFootprint() : 0; }
 
   private:
-    QFile *getFile();
     void fillHeaders( QTextStream &jsonStream, const ExporterData &dto, const char *sep );
-    void fillData( QTextStream &jsonStream, const ExporterData &dto, const char *sep );
+    /// \brief Serialize all rows with a fast fixed notation formatter into a chunk
+    /// buffer and write it with one QFile::write() per chunk - per value
+    /// QLocale::toString() formatting dominated the export time on small boards.
+    void fillData( QFile *file, const ExporterData &dto, const char *sep );
     std::shared_ptr< PPresult > data;
 };
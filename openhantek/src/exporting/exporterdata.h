@@ -9,6 +9,12 @@
 #include <memory>
 #include <vector>
 
+/// \brief Immutable per-channel view of one result for the exporters.
+/// Construction only snapshots pointers to the used channels - no samples are
+/// copied, the sample buffers stay the shared snapshots inside the PPresult.
+/// The view shares ownership of the result, so it stays valid (and the result
+/// pool cannot recycle the block) for as long as the ExporterData exists, even
+/// after the exporter dropped its own reference.
 class ExporterData {
   public:
     ExporterData( const std::shared_ptr< PPresult > &data, const DsoSettingsScope &scope );
@@ -22,6 +28,7 @@ class ExporterData {
     std::vector< const SampleValues * > const &getSpectrumData() const { return _spectrumData; }
 
   private:
+    std::shared_ptr< const PPresult > _source; ///< keeps the viewed channel data alive
     size_t _chCount;
     size_t _maxRow;
     bool _isSpectrumUsed;
@@ -6,10 +6,12 @@
 #include <QIcon>
 #include <QString>
 
+#include <cstddef>
 #include <memory>
 
 class ExporterRegistry;
 class PPresult;
+class QFile;
 
 /**
  * Implement this interface and register your Exporter to the ExporterRegistry instance
@@ -52,9 +54,11 @@ class ExporterInterface {
     /**
      * A new sample set from the ExporterRegistry. The exporter needs to be active to receive samples.
      * If it is a snapshot exporter, only one set of samples will be received.
+     * The result is borrowed for the duration of the call; an exporter that needs
+     * it afterwards (e.g. for save()) keeps its own shared_ptr copy explicitly.
      * @return Return true if you want to receive another sample or false if you are done (progress()==1).
      */
-    virtual bool samples( const std::shared_ptr< PPresult > ) = 0;
+    virtual bool samples( const std::shared_ptr< PPresult > & ) = 0;
 
     /**
      * Exporter: Save your received data and perform any conversions necessary.
@@ -64,6 +68,28 @@ class ExporterInterface {
      */
     virtual bool save() = 0;
 
+    /**
+     * Exporters returning true use the split save path instead of save(): the
+     * registry calls chooseDestination() on the GUI thread (modal dialogs allowed)
+     * and runs write() on its save worker, so a slow disk never blocks the GUI
+     * thread. Exporters with their own write pipeline (BIN, SEG) keep save().
+     */
+    virtual bool asyncSave() const { return false; }
+
+    /**
+     * Split save path: pick and open the destination, GUI thread context.
+     * @return The opened file, ownership passes to the caller; nullptr = cancelled.
+     */
+    virtual QFile *chooseDestination() { return nullptr; }
+
+    /**
+     * Split save path: serialize the collected snapshot into the destination.
+     * Runs on the registry's save worker and must not touch the GUI; the registry
+     * closes the file and resets the exporter afterwards.
+     * @return Return true if writing succeeded.
+     */
+    virtual bool write( QFile * ) { return false; }
+
     /**
      * @brief The progress of receiving and processing samples. If the exporter returns 1, it will
      * be called back by the GUI via the save() method.
@@ -74,6 +100,14 @@ class ExporterInterface {
      */
     virtual float progress() = 0;
 
+    /**
+     * @return Allocated bytes of sample data this exporter currently holds on to
+     * (a pinned result snapshot, staging buffers); memory telemetry sampled by the
+     * registry, see FrameTrace::counter(). Exporters that only borrow the result
+     * during samples() report 0.
+     */
+    virtual size_t memoryFootprint() const { return 0; }
+
   protected:
     ExporterRegistry *registry;
 };
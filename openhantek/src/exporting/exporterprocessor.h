@@ -10,6 +10,7 @@ class ExporterProcessor : public Processor {
   public:
     explicit ExporterProcessor( ExporterRegistry *registry );
     void process( PPresult * ) override;
+    const char *name() const override { return "export"; }
 
   private:
     ExporterRegistry *registry;
@@ -3,17 +3,21 @@
 #include "exporterregistry.h"
 #include "exporterinterface.h"
 
+#include <QFile>
+
 #include <algorithm>
 
 #include "controlspecification.h"
 #include "dsosettings.h"
 #include "post/ppresult.h"
+#include "utils/frametrace.h"
 
 ExporterRegistry::ExporterRegistry( const Dso::ControlSpecification *deviceSpecification, DsoSettings *settings, QObject *parent )
     : QObject( parent ), deviceSpecification( deviceSpecification ), settings( settings ) {}
 
-bool ExporterRegistry::processData( std::shared_ptr< PPresult > &data, ExporterInterface *const &exporter ) {
+bool ExporterRegistry::processData( const std::shared_ptr< PPresult > &data, ExporterInterface *const &exporter ) {
     if ( !exporter->samples( data ) ) {
+        QMutexLocker lock( &mutex );
         waitToSaveExporters.insert( exporter );
         emit exporterProgressChanged();
         return true;
@@ -24,14 +28,51 @@ bool ExporterRegistry::processData( std::shared_ptr< PPresult > &data, ExporterI
 void ExporterRegistry::addRawSamples( PPresult *d ) {
     if ( settings->exportProcessedSamples )
         return;
-    std::shared_ptr< PPresult > data( d );
-    enabledExporters.remove_if( [ &data, this ]( ExporterInterface *const &i ) { return processData( data, i ); } );
+    // rejoin the shared ownership of the result pool instead of creating a second
+    // owner of the same object - the pool must not recycle the block while an
+    // exporter still holds it
+    deposit( d->shared_from_this() );
 }
 
 void ExporterRegistry::input( std::shared_ptr< PPresult > data ) {
     if ( !settings->exportProcessedSamples )
         return;
-    enabledExporters.remove_if( [ &data, this ]( ExporterInterface *const &i ) { return processData( data, i ); } );
+    deposit( std::move( data ) );
+}
+
+void ExporterRegistry::deposit( std::shared_ptr< PPresult > data ) {
+    QMutexLocker lock( &mutex );
+    if ( enabledExporters.empty() )
+        return;
+    mailbox = std::move( data ); // newest wins while the worker is still busy
+    if ( !exporterBusy ) {
+        exporterBusy = true;
+        exporterWorker.start( [ this ]() { runExporters(); } );
+    }
+}
+
+void ExporterRegistry::runExporters() {
+    saveWorker.wait(); // an in-flight write still reads the exporters' snapshots
+    QMutexLocker lock( &mutex );
+    while ( mailbox ) {
+        std::shared_ptr< PPresult > data = std::move( mailbox );
+        std::vector< ExporterInterface * > active( enabledExporters.begin(), enabledExporters.end() );
+        lock.unlock(); // serialize and write without blocking the depositing chain
+        std::vector< ExporterInterface * > finished;
+        for ( ExporterInterface *exporter : active )
+            if ( processData( data, exporter ) )
+                finished.push_back( exporter );
+        lock.relock();
+        for ( ExporterInterface *exporter : finished )
+            enabledExporters.remove( exporter );
+    }
+    // per deposit memory telemetry of the export side: results pinned and blocks
+    // staged by the exporters, see FrameTrace::counter()
+    size_t exportBytes = 0;
+    for ( ExporterInterface *exporter : exporters )
+        exportBytes += exporter->memoryFootprint();
+    FrameTrace::counter( "mem.export", exportBytes );
+    exporterBusy = false;
 }
 
 void ExporterRegistry::registerExporter( ExporterInterface *exporter ) {
@@ -40,6 +81,8 @@ void ExporterRegistry::registerExporter( ExporterInterface *exporter ) {
 }
 
 void ExporterRegistry::setExporterEnabled( ExporterInterface *exporter, bool enabled ) {
+    saveWorker.wait(); // create() below must not reset a snapshot that is being written
+    QMutexLocker lock( &mutex );
     bool wasInList = false;
     enabledExporters.remove_if( [ exporter, &wasInList ]( ExporterInterface *inlist ) {
         if ( inlist == exporter ) {
@@ -69,7 +112,35 @@ void ExporterRegistry::setExporterEnabled( ExporterInterface *exporter, bool ena
 }
 
 void ExporterRegistry::checkForWaitingExporters() {
-    for ( ExporterInterface *exporter : waitToSaveExporters ) {
+    std::set< ExporterInterface * > waiting;
+    { // take the waiting list, save() below shows dialogs and must not hold the lock
+        QMutexLocker lock( &mutex );
+        waiting.swap( waitToSaveExporters );
+    }
+    for ( ExporterInterface *exporter : waiting ) {
+        if ( exporter->asyncSave() ) {
+            // split path: only the file dialog runs here on the GUI thread, the
+            // serialization goes to the save worker so a slow disk never blocks
+            // the display refresh
+            QFile *file = exporter->chooseDestination();
+            if ( file == nullptr ) {
+                emit exporterStatusChanged( exporter->name(), tr( "No data exported" ) );
+                exporter->create( this );
+                continue;
+            }
+            emit exporterStatusChanged( exporter->name(), tr( "Saving ..." ) );
+            saveWorker.wait(); // one background save at a time
+            saveWorker.start( [ this, exporter, file ]() {
+                const bool ok = exporter->write( file );
+                file->close();
+                if ( !ok )
+                    file->remove(); // don't leave an empty file behind
+                delete file;
+                emit exporterStatusChanged( exporter->name(), ok ? tr( "Data saved" ) : tr( "No data exported" ) );
+                exporter->create( this ); // release the pinned snapshot
+            } );
+            continue;
+        }
         if ( exporter->save() ) {
             emit exporterStatusChanged( exporter->name(), tr( "Data saved" ) );
         } else {
@@ -77,7 +148,6 @@ void ExporterRegistry::checkForWaitingExporters() {
         }
         exporter->create( this );
     }
-    waitToSaveExporters.clear();
 }
 
 std::vector< ExporterInterface * >::const_iterator ExporterRegistry::begin() { return exporters.begin(); }
@@ -2,11 +2,14 @@
 
 #pragma once
 
+#include <QMutex>
 #include <QObject>
 #include <memory>
 #include <set>
 #include <vector>
 
+#include "hantekdso/convertworker.h"
+
 // Post processing forwards
 class Processor;
 class PPresult;
@@ -29,6 +32,9 @@ class ExporterRegistry : public QObject {
 
     // Sample input. This will probably be performed in the post processing
     // thread context. Do not open GUI dialogs or interrupt the control flow.
+    // Both only deposit the result into a mailbox and return immediately; the
+    // exporters run on a worker thread, so a slow disk or network share never
+    // stalls the processing chain.
     void addRawSamples( PPresult *data );
     void input( std::shared_ptr< PPresult > data );
 
@@ -54,11 +60,23 @@ class ExporterRegistry : public QObject {
     std::set< ExporterInterface * > waitToSaveExporters;
 
     /// Process data from addRawSamples() or input() in the given exporter. Add the
-    /// exporter to waitToSaveExporters if it finishes.
+    /// exporter to waitToSaveExporters if it finishes. Runs on the exporter worker.
     ///
     /// @return Return true if the exporter has finished and want to be removed from the
     ///     enabledExporters list.
-    bool processData( std::shared_ptr< PPresult > &data, ExporterInterface *const &exporter );
+    bool processData( const std::shared_ptr< PPresult > &data, ExporterInterface *const &exporter );
+
+    /// Put one result into the mailbox and kick the worker if it is idle. A newer
+    /// deposit replaces an unconsumed one, so a slow exporter skips blocks instead
+    /// of queueing a backlog (the same newest-wins scheme as the display path).
+    void deposit( std::shared_ptr< PPresult > data );
+    /// Drain the mailbox through all enabled exporters, runs on the worker thread.
+    void runExporters();
+    ConvertWorker exporterWorker;        ///< runs the exporters off the depositing thread
+    ConvertWorker saveWorker;            ///< runs the split snapshot writes off the GUI thread
+    QMutex mutex;                        ///< guards mailbox, worker handshake and the exporter lists
+    std::shared_ptr< PPresult > mailbox; ///< the waiting slot: deposited, not yet exported
+    bool exporterBusy = false;           ///< the worker is draining the mailbox
 
   signals:
     void exporterStatusChanged( const QString &exporterName, const QString &status );
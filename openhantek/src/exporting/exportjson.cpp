@@ -4,14 +4,16 @@
 #include "exportjson.h"
 #include "dsosettings.h"
 #include "exporterregistry.h"
+#include "fixedformat.h"
 #include "post/ppresult.h"
 
 #include <QCoreApplication>
 #include <QFile>
 #include <QFileDialog>
-#include <QLocale>
 #include <QMessageBox>
-#include <QTextStream>
+
+#include <cstring>
+#include <vector>
 
 ExporterJSON::ExporterJSON() {}
 
@@ -26,12 +28,12 @@ QString ExporterJSON::format() { return "JSON"; }
 
 ExporterInterface::Type ExporterJSON::type() { return Type::SnapshotExport; }
 
-bool ExporterJSON::samples( const std::shared_ptr< PPresult > newData ) {
-    data = std::move( newData );
+bool ExporterJSON::samples( const std::shared_ptr< PPresult > &newData ) {
+    data = newData; // keep shared ownership until save() has written the snapshot
     return false;
 }
 
-QFile *ExporterJSON::getFile() {
+QFile *ExporterJSON::chooseDestination() {
     QFileDialog fileDialog( nullptr, tr( "Save JSON" ), QString(), tr( "Java Script Object Notation (*.json)" ) );
     fileDialog.setFileMode( QFileDialog::AnyFile );
     fileDialog.setAcceptMode( QFileDialog::AcceptSave );
@@ -47,72 +49,91 @@ QFile *ExporterJSON::getFile() {
     return jsonFile;
 }
 
-void ExporterJSON::fillData( QTextStream &jsonStream, const ExporterData &dto ) {
-    std::vector< const SampleValues * > voltageData = dto.getVoltageData();
-    std::vector< const SampleValues * > spectrumData = dto.getSpectrumData();
-
-    jsonStream << "[\n";
-    const char *indent = "  ";
+void ExporterJSON::fillData( QFile *file, const ExporterData &dto ) {
+    const std::vector< const SampleValues * > &voltageData = dto.getVoltageData();
+    const std::vector< const SampleValues * > &spectrumData = dto.getSpectrumData();
+
+    // pre-rendered '"name": ' fragments, so the row loop only copies bytes
+    std::vector< std::pair< QByteArray, const SampleValues * > > voltageFields;
+    std::vector< std::pair< QByteArray, const SampleValues * > > spectrumFields;
+    for ( ChannelID channel = 0; channel < dto.getChannelsCount(); ++channel ) {
+        if ( voltageData[ channel ] != nullptr )
+            voltageFields.push_back(
+                { "    \"" + registry->settings->scope.voltage[ channel ].name.toUtf8() + "\": ", voltageData[ channel ] } );
+        if ( dto.isSpectrumUsed() && spectrumData[ channel ] != nullptr )
+            spectrumFields.push_back(
+                { "    \"" + registry->settings->scope.spectrum[ channel ].name.toUtf8() + "\": ", spectrumData[ channel ] } );
+    }
 
+    const size_t chunkSize = 1 << 20; // one write() per MiB, memory stays O(1) in rows
+    std::vector< char > chunk( chunkSize + 4096 ); // headroom for the longest row
+    char *p = chunk.data();
+    auto putLiteral = [ &p ]( const char *text ) {
+        size_t length = strlen( text );
+        memcpy( p, text, length );
+        p += length;
+    };
+    auto putBytes = [ &p ]( const QByteArray &bytes ) {
+        memcpy( p, bytes.constData(), size_t( bytes.size() ) );
+        p += bytes.size();
+    };
+
+    putLiteral( "[\n" );
     for ( unsigned int row = 0; row < dto.getMaxRow(); ++row ) {
-        jsonStream << indent << "{\n";
-
-        QString objInString; // to easily remove latest comma in json object
-        QTextStream objInStream( &objInString );
-        objInStream.setRealNumberNotation( QTextStream::FixedNotation );
-        objInStream.setRealNumberPrecision( 10 );
-
-        objInStream << indent << indent << "\"time\": " << dto.getTimeInterval() * row << ",\n";
-
-        for ( ChannelID channel = 0; channel < dto.getChannelsCount(); ++channel )
-            if ( voltageData[ channel ] != nullptr ) {
-                objInStream << indent << indent << '\"' << registry->settings->scope.voltage[ channel ].name << "\": ";
-                if ( row < voltageData[ channel ]->samples.size() )
-                    objInStream << voltageData[ channel ]->samples[ row ];
-                else
-                    objInStream << "\": null";
-                objInStream << ",\n";
-            }
+        putLiteral( "  {\n    \"time\": " );
+        p = formatFixed( p, dto.getTimeInterval() * row, '.' ); // JSON always uses '.'
+
+        for ( auto &field : voltageFields ) {
+            putLiteral( ",\n" );
+            putBytes( field.first );
+            if ( row < field.second->samples->size() )
+                p = formatFixed( p, ( *field.second->samples )[ row ], '.' );
+            else
+                putLiteral( "null" );
+        }
 
         if ( dto.isSpectrumUsed() ) {
-            objInStream << indent << indent << "\"freq\": " << dto.getFreqInterval() * row << ",\n";
-            for ( ChannelID channel = 0; channel < dto.getChannelsCount(); ++channel ) {
-                if ( spectrumData[ channel ] != nullptr ) {
-                    objInStream << indent << indent << '\"' << registry->settings->scope.spectrum[ channel ].name << "\": ";
-                    if ( row < spectrumData[ channel ]->samples.size() )
-                        objInStream << spectrumData[ channel ]->samples[ row ];
-                    else
-                        objInStream << "null";
-                    objInStream << ",\n";
-                }
+            putLiteral( ",\n    \"freq\": " );
+            p = formatFixed( p, dto.getFreqInterval() * row, '.' );
+            for ( auto &field : spectrumFields ) {
+                putLiteral( ",\n" );
+                putBytes( field.first );
+                if ( row < field.second->samples->size() )
+                    p = formatFixed( p, ( *field.second->samples )[ row ], '.' );
+                else
+                    putLiteral( "null" );
             }
         }
 
-        jsonStream << objInString.mid( 0, objInString.length() - 2 ) << '\n' << indent << '}';
+        putLiteral( "\n  }" );
         if ( row != dto.getMaxRow() - 1 )
-            jsonStream << ',';
-        jsonStream << '\n';
+            *p++ = ',';
+        *p++ = '\n';
+
+        if ( size_t( p - chunk.data() ) >= chunkSize ) { // chunk full, flush it
+            file->write( chunk.data(), p - chunk.data() );
+            p = chunk.data();
+        }
     }
-    jsonStream << "]\n";
+    putLiteral( "]\n" );
+    file->write( chunk.data(), p - chunk.data() );
 }
 
-bool ExporterJSON::save() {
-    QFile *jsonFile = getFile();
-    if ( jsonFile == nullptr )
-        return false;
-
-    QTextStream jsonStream( jsonFile );
-    jsonStream.setRealNumberNotation( QTextStream::FixedNotation );
-    jsonStream.setRealNumberPrecision( 10 );
-
+bool ExporterJSON::write( QFile *file ) {
     ExporterData dto = ExporterData( data, registry->settings->scope );
-    fillData( jsonStream, dto );
-
-    jsonFile->close();
-    delete jsonFile;
-
+    fillData( file, dto );
     return true;
 }
 
+bool ExporterJSON::save() { // synchronous fallback, the registry prefers the split path
+    QFile *file = chooseDestination();
+    if ( file == nullptr )
+        return false;
+    bool ok = write( file );
+    file->close();
+    delete file;
+    return ok;
+}
+
 
 float ExporterJSON::progress() { return data ? 1.0f : 0; }
@@ -6,7 +6,6 @@
 #include "exporterinterface.h"
 
 #include <QFile>
-#include <QTextStream>
 
 class ExporterJSON : public ExporterInterface {
     Q_DECLARE_TR_FUNCTIONS( LegacyExportDrawer )
@@ -17,12 +16,18 @@ class ExporterJSON : public ExporterInterface {
     QString name() override;
     QString format() override;
     Type type() override;
-    bool samples( const std::shared_ptr< PPresult > newData ) override;
+    bool samples( const std::shared_ptr< PPresult > &newData ) override;
     bool save() override;
+    bool asyncSave() const override { return true; }
+    QFile *chooseDestination() override;
+    bool write( QFile *file ) override;
     float progress() override;
+    size_t memoryFootprint() const override { return data ? data->memoryFootprint() : 0; }
 
   private:
-    QFile *getFile();
-    void fillData( QTextStream &jsonStream, const ExporterData &dto );
+    /// \brief Stream all rows through a fixed size chunk buffer that is flushed as
+    /// it fills, so the export memory stays O(1) in the record length - no second
+    /// copy of a deep capture as text in RAM.
+    void fillData( QFile *file, const ExporterData &dto );
     std::shared_ptr< PPresult > data;
 };
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "exportseg.h"
+#include "dsosettings.h"
+#include "exporterregistry.h"
+#include "post/ppresult.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QMessageBox>
+#include <QStandardPaths>
+
+#include <cstring>
+
+ExporterSEG::ExporterSEG() {}
+
+ExporterSEG::~ExporterSEG() {
+    writer.wait();
+    if ( file.isOpen() )
+        file.close();
+}
+
+void ExporterSEG::create( ExporterRegistry *newRegistry ) {
+    registry = newRegistry;
+    writer.wait(); // no job in flight beyond this point
+    QMutexLocker lock( &mutex );
+    if ( file.isOpen() )
+        file.close();
+    stageBuffer.clear();
+    active = false;
+    writeFailed = false;
+    lastTag = 0;
+    segmentCount = 0;
+    droppedSegments = 0;
+    totalBytes = 0;
+}
+
+QString ExporterSEG::name() { return tr( "Capture trigger &segments" ); }
+
+QString ExporterSEG::format() { return "OHSEGB01"; }
+
+ExporterInterface::Type ExporterSEG::type() { return Type::ContinuousExport; }
+
+bool ExporterSEG::samples( const std::shared_ptr< PPresult > &data ) {
+    QMutexLocker lock( &mutex );
+    if ( writeFailed )
+        return false; // finish the capture, save() reports the error
+    if ( !active ) {
+        segmentTarget = qMax( 1U, registry->settings->exportSegmentCount );
+        active = openFile();
+        if ( !active )
+            return false;
+    }
+    if ( !data || !data->softwareTriggerTriggered || data->tag == lastTag )
+        return true; // untriggered, or a screen refresh of an already captured trace
+    lastTag = data->tag;
+    stageSegment( *data );
+    return segmentCount < segmentTarget; // false hands the full file over to save()
+}
+
+bool ExporterSEG::openFile() {
+    QString dir = QStandardPaths::writableLocation( QStandardPaths::DocumentsLocation );
+    if ( dir.isEmpty() )
+        dir = QDir::homePath();
+    file.setFileName( dir + "/" + QCoreApplication::applicationName() + "_" +
+                      QDateTime::currentDateTime().toString( "yyyy-MM-dd_hh-mm-ss" ) + ".ohseg" );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        writeFailed = true;
+        return false;
+    }
+    FileHeader header;
+    memcpy( header.magic, "OHSEGB01", sizeof( header.magic ) );
+    header.fileHeaderBytes = sizeof( FileHeader );
+    header.segmentHeaderBytes = sizeof( SegmentHeader );
+    if ( file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) ) != sizeof( header ) ) {
+        writeFailed = true;
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+void ExporterSEG::stageSegment( const PPresult &result ) {
+    // the triggered window: everything from the trigger point to the end of the trace
+    const size_t skip = size_t( qMax( 0, result.triggeredPosition ) );
+    uint32_t channelMask = 0;
+    size_t sampleCount = 0;
+    double interval = 0.0;
+    for ( ChannelID channel = 0; channel < result.channelCount(); ++channel ) {
+        const SampleValues &voltage = result.data( channel )->voltage;
+        if ( voltage.samples->size() <= skip )
+            continue;
+        channelMask |= 1U << channel;
+        size_t available = voltage.samples->size() - skip;
+        sampleCount = sampleCount ? qMin( sampleCount, available ) : available;
+        interval = voltage.interval;
+    }
+    if ( !channelMask )
+        return;
+    unsigned channels = 0;
+    for ( uint32_t mask = channelMask; mask; mask >>= 1 )
+        channels += mask & 1;
+    const size_t dataBytes = channels * sampleCount * sizeof( float );
+    if ( stageBuffer.size() + sizeof( SegmentHeader ) + dataBytes > stageLimit ) {
+        ++droppedSegments; // the disk cannot keep up, drop the segment instead of growing
+        return;
+    }
+    SegmentHeader header;
+    memcpy( header.magic, "TSEG", sizeof( header.magic ) );
+    header.dataBytes = uint32_t( dataBytes );
+    header.timestampMs = uint64_t( QDateTime::currentMSecsSinceEpoch() );
+    header.interval = interval;
+    header.triggerSub = result.triggeredPositionSub;
+    header.tag = result.tag;
+    header.channelMask = channelMask;
+    header.sampleCount = uint32_t( sampleCount );
+    header.reserved = 0;
+    const unsigned char *headerBytes = reinterpret_cast< const unsigned char * >( &header );
+    size_t offset = stageBuffer.size();
+    stageBuffer.resize( offset + sizeof( header ) + dataBytes );
+    memcpy( stageBuffer.data() + offset, headerBytes, sizeof( header ) );
+    float *out = reinterpret_cast< float * >( stageBuffer.data() + offset + sizeof( header ) );
+    for ( ChannelID channel = 0; channel < result.channelCount(); ++channel ) {
+        if ( !( channelMask & ( 1U << channel ) ) )
+            continue;
+        const std::vector< double > &samples = *result.data( channel )->voltage.samples;
+        for ( size_t index = 0; index < sampleCount; ++index ) // plain narrowing loop, vectorizable
+            *out++ = float( samples[ skip + index ] );
+    }
+    ++segmentCount;
+    if ( writerIdle ) { // kick the background writer, it drains until the staging is empty
+        writerIdle = false;
+        writer.start( [ this ]() { drain(); } );
+    }
+}
+
+void ExporterSEG::drain() {
+    QMutexLocker lock( &mutex );
+    while ( !stageBuffer.empty() && !writeFailed ) {
+        writeBuffer.swap( stageBuffer ); // both keep their capacity across segments
+        stageBuffer.clear();
+        lock.unlock(); // write without blocking the result side
+        qint64 written = file.write( reinterpret_cast< const char * >( writeBuffer.data() ), qint64( writeBuffer.size() ) );
+        lock.relock();
+        if ( written != qint64( writeBuffer.size() ) )
+            writeFailed = true;
+        else
+            totalBytes += written;
+    }
+    writerIdle = true;
+}
+
+bool ExporterSEG::save() {
+    { // stop accepting segments, then flush what is still staged
+        QMutexLocker lock( &mutex );
+        active = false;
+    }
+    writer.wait(); // the background writer is idle now
+    drain();       // write the remainder inline
+    QMutexLocker lock( &mutex );
+    if ( file.isOpen() )
+        file.close();
+    if ( writeFailed ) {
+        QMessageBox::critical( nullptr, QCoreApplication::applicationName(), tr( "Write error\n%1" ).arg( file.fileName() ) );
+        return false;
+    }
+    if ( segmentCount == 0 ) {
+        file.remove(); // no trigger event seen, don't leave an empty file behind
+        return false;
+    }
+    QString message = tr( "Captured %1 of %2 trigger segments (%3 MB) to\n%4" )
+                          .arg( segmentCount )
+                          .arg( segmentTarget )
+                          .arg( double( totalBytes ) / 1e6, 0, 'f', 1 )
+                          .arg( file.fileName() );
+    if ( droppedSegments )
+        message += tr( "\n%1 segments dropped (storage too slow)" ).arg( droppedSegments );
+    QMessageBox::information( nullptr, QCoreApplication::applicationName(), message );
+    return true;
+}
+
+float ExporterSEG::progress() {
+    QMutexLocker lock( &mutex );
+    if ( !active && segmentCount == 0 )
+        return 0.0f;
+    return qMin( 1.0f, float( segmentCount ) / float( segmentTarget ) );
+}
+
+
+size_t ExporterSEG::memoryFootprint() const {
+    QMutexLocker lock( &mutex );
+    return stageBuffer.capacity() + writeBuffer.capacity();
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+#include "exporterinterface.h"
+#include "hantekdso/convertworker.h"
+
+#include <QFile>
+#include <QMutex>
+
+#include <cstdint>
+#include <vector>
+
+class PPresult;
+
+/**
+ * Segmented capture: append the triggered window of each fresh trigger event to
+ * one file until the configured number of segments is collected, then hand the
+ * file over via the usual save() path. This records e.g. 1000 rare protocol
+ * glitches unattended instead of one manual snapshot export per event.
+ *
+ * Segments are taken from the processed result stream, so they contain the
+ * calibrated voltages (including the math channel) starting at the trigger
+ * point of each trace. Trigger bursts arriving faster than post processing are
+ * thinned by the registry's newest-wins delivery - the segments are individual
+ * events, not a gap-free recording (that is what ExporterBIN is for).
+ *
+ * Like the binary recorder the result side only serializes each segment into a
+ * staging buffer, a background writer thread appends to the file in large
+ * chunks; a slow disk drops whole segments instead of stalling the exporters.
+ *
+ * File layout: one FileHeader, then a sequence of [ SegmentHeader + payload ].
+ * The payload holds sampleCount float32 samples per channel, channel after
+ * channel in ascending channel order of the channelMask bits. All fields are
+ * little endian.
+ */
+class ExporterSEG : public ExporterInterface {
+    Q_DECLARE_TR_FUNCTIONS( ExporterSEG )
+
+  public:
+    ExporterSEG();
+    ~ExporterSEG() override;
+    void create( ExporterRegistry *registry ) override;
+    QString name() override;
+    QString format() override;
+    Type type() override;
+    bool samples( const std::shared_ptr< PPresult > &data ) override;
+    bool save() override;
+    float progress() override;
+    size_t memoryFootprint() const override;
+
+#pragma pack( push, 1 )
+    /// Once at the start of the file.
+    struct FileHeader {
+        char magic[ 8 ];             ///< "OHSEGB01", includes the format version
+        uint32_t fileHeaderBytes;    ///< sizeof( FileHeader ), decoder skip offset
+        uint32_t segmentHeaderBytes; ///< sizeof( SegmentHeader ), decoder skip offset
+    };
+    /// Before each segment, immediately followed by the float32 sample payload.
+    struct SegmentHeader {
+        char magic[ 4 ];      ///< "TSEG", resync mark
+        uint32_t dataBytes;   ///< size of the following sample payload in bytes
+        uint64_t timestampMs; ///< ms since epoch when the segment was captured
+        double interval;      ///< seconds between two samples
+        double triggerSub;    ///< fraction of one sample the crossing precedes the first sample
+        uint32_t tag;         ///< capture tag of the source block, for correlation
+        uint32_t channelMask; ///< bit n set = channel n present, in ascending order
+        uint32_t sampleCount; ///< samples per channel
+        uint32_t reserved;    ///< zero, keeps the header at 48 bytes
+    };
+#pragma pack( pop )
+
+  private:
+    bool openFile();
+    void stageSegment( const PPresult &result ); ///< serialize the triggered window, caller holds the mutex
+    void drain(); ///< write all staged data, runs on the writer thread (or inline in save())
+
+    QFile file;
+    mutable QMutex mutex; ///< guards the staging buffer, the counters and the writer handshake
+    std::vector< unsigned char > stageBuffer; ///< segments staged by the result side
+    std::vector< unsigned char > writeBuffer; ///< segments currently going to disk
+    ConvertWorker writer;                     ///< runs drain() in the background
+    bool writerIdle = true;
+    bool active = false;          ///< samples() started, save() stopped the capture
+    bool writeFailed = false;     ///< a file write failed, capture stopped
+    unsigned lastTag = 0;         ///< one segment per trigger event, not per screen refresh
+    unsigned segmentCount = 0;    ///< segments staged so far
+    unsigned segmentTarget = 1;   ///< settings->exportSegmentCount, latched at start
+    unsigned droppedSegments = 0;
+    qint64 totalBytes = 0;
+    /// Upper staging bound, segments are small compared to raw blocks so this
+    /// absorbs many seconds of disk stall before segments are dropped.
+    static const size_t stageLimit = 64 * 1024 * 1024;
+};
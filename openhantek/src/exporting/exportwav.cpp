@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "exportwav.h"
+#include "dsosettings.h"
+#include "exporterregistry.h"
+#include "hantekdso/convertsimd.h"
+#include "post/ppresult.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+ExporterWAV::ExporterWAV() {}
+
+void ExporterWAV::create( ExporterRegistry *newRegistry ) {
+    registry = newRegistry;
+    data.reset();
+}
+
+QString ExporterWAV::name() { return tr( "Export &WAV .." ); }
+
+QString ExporterWAV::format() { return "WAV"; }
+
+ExporterInterface::Type ExporterWAV::type() { return Type::SnapshotExport; }
+
+bool ExporterWAV::samples( const std::shared_ptr< PPresult > &newData ) {
+    data = newData; // keep shared ownership until save() has written the snapshot
+    return false;
+}
+
+QFile *ExporterWAV::chooseDestination() {
+    QFileDialog fileDialog( nullptr, tr( "Save WAV" ), QString(), tr( "Waveform Audio (*.wav)" ) );
+    fileDialog.setFileMode( QFileDialog::AnyFile );
+    fileDialog.setAcceptMode( QFileDialog::AcceptSave );
+    fileDialog.setOption( QFileDialog::DontUseNativeDialog );
+    if ( fileDialog.exec() != QDialog::Accepted )
+        return nullptr;
+
+    QFile *wavFile = new QFile( fileDialog.selectedFiles().first() );
+    if ( !wavFile->open( QIODevice::WriteOnly ) ) {
+        QMessageBox::critical( nullptr, QCoreApplication::applicationName(), tr( "Write error\n%1" ).arg( wavFile->fileName() ) );
+        return nullptr;
+    }
+    return wavFile;
+}
+
+#pragma pack( push, 1 )
+/// Canonical 44 byte PCM WAV header, all fields little endian.
+struct WavHeader {
+    char riff[ 4 ];        ///< "RIFF"
+    uint32_t riffSize;     ///< 36 + dataBytes
+    char wave[ 4 ];        ///< "WAVE"
+    char fmt[ 4 ];         ///< "fmt "
+    uint32_t fmtSize;      ///< 16 for PCM
+    uint16_t audioFormat;  ///< 1 = PCM
+    uint16_t channels;     ///< interleaved channel count
+    uint32_t sampleRate;   ///< frames per second
+    uint32_t byteRate;     ///< sampleRate * channels * 2
+    uint16_t blockAlign;   ///< channels * 2
+    uint16_t bitsPerSample; ///< 16
+    char dataTag[ 4 ];     ///< "data"
+    uint32_t dataBytes;    ///< payload size
+};
+#pragma pack( pop )
+
+bool ExporterWAV::write( QFile *file ) {
+    ExporterData dto = ExporterData( data, registry->settings->scope );
+    const std::vector< const SampleValues * > &voltageData = dto.getVoltageData();
+
+    // collect the used voltage channels and the common full scale
+    std::vector< const std::vector< double > * > channels;
+    double maxAbs = 0.0;
+    for ( ChannelID channel = 0; channel < dto.getChannelsCount(); ++channel ) {
+        if ( voltageData[ channel ] == nullptr || voltageData[ channel ]->samples->empty() )
+            continue;
+        const std::vector< double > *samples = voltageData[ channel ]->samples.get();
+        channels.push_back( samples );
+        double vMin, vMax;
+        minMaxSimd( samples->data(), unsigned( samples->size() ), vMin, vMax );
+        maxAbs = std::max( maxAbs, std::max( fabs( vMin ), fabs( vMax ) ) );
+    }
+    if ( channels.empty() )
+        return false;
+
+    // normalize to int16 full scale and interleave; the inner loop is a plain
+    // multiply / round per sample, so the compiler vectorizes it
+    const double scale = maxAbs > 0.0 ? 32767.0 / maxAbs : 0.0;
+    const size_t frames = dto.getMaxRow();
+    const size_t channelCount = channels.size();
+    std::vector< int16_t > pcm( frames * channelCount, 0 );
+    for ( size_t channel = 0; channel < channelCount; ++channel ) {
+        const std::vector< double > &samples = *channels[ channel ];
+        const size_t count = std::min( frames, samples.size() );
+        int16_t *out = pcm.data() + channel;
+        for ( size_t index = 0; index < count; ++index, out += channelCount )
+            *out = int16_t( lround( samples[ index ] * scale ) );
+    }
+
+    WavHeader header;
+    memcpy( header.riff, "RIFF", 4 );
+    memcpy( header.wave, "WAVE", 4 );
+    memcpy( header.fmt, "fmt ", 4 );
+    memcpy( header.dataTag, "data", 4 );
+    header.fmtSize = 16;
+    header.audioFormat = 1; // PCM
+    header.channels = uint16_t( channelCount );
+    header.sampleRate = uint32_t( lround( 1.0 / dto.getTimeInterval() ) );
+    header.byteRate = header.sampleRate * uint32_t( channelCount ) * 2;
+    header.blockAlign = uint16_t( channelCount * 2 );
+    header.bitsPerSample = 16;
+    header.dataBytes = uint32_t( pcm.size() * sizeof( int16_t ) );
+    header.riffSize = 36 + header.dataBytes;
+
+    file->write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+    file->write( reinterpret_cast< const char * >( pcm.data() ), qint64( pcm.size() * sizeof( int16_t ) ) );
+
+    return true;
+}
+
+bool ExporterWAV::save() { // synchronous fallback, the registry prefers the split path
+    QFile *file = chooseDestination();
+    if ( file == nullptr )
+        return false;
+    bool ok = write( file );
+    file->close();
+    delete file;
+    return ok;
+}
+
+
+float ExporterWAV::progress() { return data ? 1.0f : 0; }
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+#include "exporterdata.h"
+#include "exporterinterface.h"
+
+#include <QFile>
+
+/**
+ * Snapshot exporter that writes the captured voltage channels as an int16 PCM
+ * WAV file, used channels interleaved. The samples are normalized to full scale
+ * and converted in one vectorizable pass and the whole block is written with a
+ * single blit - no per value text formatting, so external audio analysis tools
+ * can ingest a frame in microseconds instead of the seconds a CSV export costs.
+ */
+class ExporterWAV : public ExporterInterface {
+    Q_DECLARE_TR_FUNCTIONS( ExporterWAV )
+
+  public:
+    ExporterWAV();
+    void create( ExporterRegistry *registry ) override;
+    QString name() override;
+    QString format() override;
+    Type type() override;
+    bool samples( const std::shared_ptr< PPresult > &newData ) override;
+    bool save() override;
+    bool asyncSave() const override { return true; }
+    QFile *chooseDestination() override;
+    bool write( QFile *file ) override;
+    float progress() override;
+    size_t memoryFootprint() const override { return data ? data->memoryFootprint() : 0; }
+
+  private:
+    std::shared_ptr< PPresult > data;
+};
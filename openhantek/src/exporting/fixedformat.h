@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+/// \brief Append one value in fixed notation (up to 10 fractional digits, trailing
+/// zeros trimmed) to the buffer, the fast serializer of the text exporters. Plain
+/// integer digit emission instead of a QLocale object and locale aware formatting
+/// per cell; the locale only contributes its decimal point. Ties round half up, so
+/// the last digit may differ by one from printf's exact conversion - half an ulp
+/// of the 10th decimal, far below the 8 bit ADC resolution. Values outside the
+/// exact integer range fall back to snprintf.
+/// \param p Write position, must have at least 32 bytes of room.
+/// \param value The value to serialize.
+/// \param decimalPoint The decimal point character, '.' or the locale's.
+/// \return The new write position one past the last emitted character.
+inline char *formatFixed( char *p, double value, char decimalPoint ) {
+    if ( !std::isfinite( value ) || fabs( value ) >= 9e7 ) {
+        char fallback[ 32 ];
+        int length = snprintf( fallback, sizeof fallback, "%.10f", value );
+        for ( int index = 0; index < length; ++index ) // patch the C locale decimal point
+            *p++ = fallback[ index ] == '.' ? decimalPoint : fallback[ index ];
+        return p;
+    }
+    const bool negative = std::signbit( value );
+    const unsigned long long scale = 10000000000ULL; // 10 fractional digits
+    unsigned long long scaled = ( unsigned long long )( ( negative ? -value : value ) * double( scale ) + 0.5 );
+    unsigned long long integral = scaled / scale;
+    unsigned long long fraction = scaled % scale;
+    if ( negative && scaled )
+        *p++ = '-';
+    char digits[ 20 ];
+    int count = 0;
+    do {
+        digits[ count++ ] = char( '0' + integral % 10 );
+        integral /= 10;
+    } while ( integral );
+    while ( count )
+        *p++ = digits[ --count ];
+    if ( fraction ) {
+        char frac[ 10 ];
+        for ( int index = 9; index >= 0; --index ) {
+            frac[ index ] = char( '0' + fraction % 10 );
+            fraction /= 10;
+        }
+        int last = 9;
+        while ( frac[ last ] == '0' ) // fraction != 0, at least one digit remains
+            --last;
+        *p++ = decimalPoint;
+        for ( int index = 0; index <= last; ++index )
+            *p++ = frac[ index ];
+    }
+    return p;
+}
@@ -5,20 +5,26 @@
 
 #include <QColor>
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QDebug>
+#include <QFile>
+#include <QFileInfo>
 #include <QGuiApplication>
 #include <QMatrix4x4>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QOpenGLShaderProgram>
 #include <QPainter>
+#include <QSettings>
 
 #include <QOffscreenSurface>
+#include <QOpenGLContext>
 #include <QOpenGLFunctions>
 
 #include "glscope.h"
 
 #include "post/graphgenerator.h"
+#include "utils/frametrace.h"
 #include "post/ppresult.h"
 #include "scopesettings.h"
 #include "viewconstants.h"
@@ -28,18 +34,24 @@
 // static info strings
 QString GlScope::OpenGLversion;
 QString GlScope::GLSLversion;
+std::atomic< unsigned > GlScope::paintedFramesCount{ 0 };
 
 
 QString GlScope::getOpenGLversion() {
     if ( OpenGLversion.isNull() ) {
-        QOffscreenSurface surface;
-        surface.create();
-        QOpenGLContext context;
-        context.create();
-        context.makeCurrent( &surface );
-        OpenGLversion = reinterpret_cast< const char * >( context.functions()->glGetString( GL_VERSION ) );
-        // qDebug() << OpenGLversion;
-        surface.destroy();
+        QOpenGLContext *current = QOpenGLContext::currentContext();
+        if ( current ) { // called with an active context (e.g. from initializeGL), just ask it
+            OpenGLversion = reinterpret_cast< const char * >( current->functions()->glGetString( GL_VERSION ) );
+        } else { // no context yet, probe with a throwaway offscreen context (expensive)
+            QOffscreenSurface surface;
+            surface.create();
+            QOpenGLContext context;
+            context.create();
+            context.makeCurrent( &surface );
+            OpenGLversion = reinterpret_cast< const char * >( context.functions()->glGetString( GL_VERSION ) );
+            // qDebug() << OpenGLversion;
+            surface.destroy();
+        }
     }
     return OpenGLversion;
 }
@@ -90,14 +102,16 @@ GlScope::~GlScope() { // virtual destructor necessary
 GlScope *GlScope::createNormal( DsoSettingsScope *scope, DsoSettingsView *view, QWidget *parent ) {
     GlScope *s = new GlScope( scope, view, parent );
     s->zoomed = false;
+    s->loadReferenceTrace(); // restore the frozen overlay of an earlier session
     return s;
 }
 
 
 // static
-GlScope *GlScope::createZoomed( DsoSettingsScope *scope, DsoSettingsView *view, QWidget *parent ) {
+GlScope *GlScope::createZoomed( DsoSettingsScope *scope, DsoSettingsView *view, GlScope *source, QWidget *parent ) {
     GlScope *s = new GlScope( scope, view, parent );
     s->zoomed = true;
+    s->graphSource = source; // draw from the normal view's vertex buffers, no own upload
     return s;
 }
 
@@ -150,46 +164,26 @@ void GlScope::mousePressEvent( QMouseEvent *event ) {
         qDebug() << "   GLS::mPE()" << event;
     if ( !( zoomed && selectedCursor == 0 ) && event->button() == Qt::LeftButton ) {
         selectedMarker = NO_MARKER;
-        DsoSettingsScopeCursor *cursor = cursorInfo[ size_t( selectedCursor ) ];
-        // Capture nearest marker located within snap area (+/- 1% of full scale).
-        double dX0 = fabs( cursor->pos[ 0 ].x() - position.x() );
-        double dX1 = fabs( cursor->pos[ 1 ].x() - position.x() );
-        double dY0 = fabs( cursor->pos[ 0 ].y() - position.y() );
-        double dY1 = fabs( cursor->pos[ 1 ].y() - position.y() );
-
-        switch ( cursor->shape ) {
-        case DsoSettingsScopeCursor::RECTANGULAR:
-            if ( std::min( dX0, dX1 ) < 1.0 / DIVS_SUB && std::min( dY0, dY1 ) < 1.0 / DIVS_SUB ) {
-                // Do we need to swap Y-coords?
-                if ( ( dX0 < dX1 && dY0 > dY1 ) || ( dX0 > dX1 && dY0 < dY1 ) ) {
-                    std::swap( cursor->pos[ 0 ].ry(), cursor->pos[ 1 ].ry() );
-                }
-                selectedMarker = ( dX0 < dX1 ) ? 0 : 1;
+        // Capture nearest marker located within snap area (+/- 1% of full scale):
+        // test the prepared hit zones instead of redoing the per-shape geometry.
+        const HitZone *hit = nullptr;
+        double nearest = 0.0;
+        for ( const HitZone &candidate : hitZones ) {
+            if ( !candidate.zone.contains( position ) )
+                continue;
+            QPointF d = candidate.zone.center() - position;
+            double distance = QPointF::dotProduct( d, d );
+            if ( !hit || distance < nearest ) {
+                hit = &candidate;
+                nearest = distance;
             }
-            break;
-        case DsoSettingsScopeCursor::VERTICAL:
-            if ( dX0 < dX1 ) {
-                if ( dX0 < 1.0 / DIVS_SUB )
-                    selectedMarker = 0;
-            } else {
-                if ( dX1 < 1.0 / DIVS_SUB )
-                    selectedMarker = 1;
-            }
-            break;
-        case DsoSettingsScopeCursor::HORIZONTAL:
-            if ( dY0 < dY1 ) {
-                if ( dY0 < 1.0 / DIVS_SUB )
-                    selectedMarker = 0;
-            } else {
-                if ( dY1 < 1.0 / DIVS_SUB )
-                    selectedMarker = 1;
-            }
-            break;
-        case DsoSettingsScopeCursor::NONE:
-            break;
         }
-        if ( selectedMarker != NO_MARKER ) {
-            cursorInfo[ size_t( selectedCursor ) ]->pos[ size_t( selectedMarker ) ] = position;
+        if ( hit ) {
+            DsoSettingsScopeCursor *cursor = cursorInfo[ size_t( selectedCursor ) ];
+            if ( hit->swapY ) // rectangular cursor grabbed at a mixed corner
+                std::swap( cursor->pos[ 0 ].ry(), cursor->pos[ 1 ].ry() );
+            selectedMarker = hit->marker;
+            cursor->pos[ size_t( selectedMarker ) ] = position;
             if ( selectedCursor == 0 )
                 emit markerMoved( selectedCursor, selectedMarker );
         }
@@ -338,6 +332,21 @@ void GlScope::paintEvent( QPaintEvent *event ) {
 }
 
 
+/// \brief Add a shader to the program, using the persistent program binary cache.
+/// With cacheable shaders Qt stores the linked program binary on disk, keyed by the
+/// driver and version strings, and loads it via glProgramBinary on the next startups
+/// instead of compiling from source - several hundred ms per program on some Mesa
+/// versions, twice on our startup critical path (normal + zoomed context). A cache
+/// miss or a driver change falls back to source compilation transparently.
+static bool addShaderCached( QOpenGLShaderProgram *program, QOpenGLShader::ShaderType type, const char *source ) {
+#if ( QT_VERSION >= QT_VERSION_CHECK( 5, 9, 0 ) )
+    return program->addCacheableShaderFromSourceCode( type, source );
+#else
+    return program->addShaderFromSourceCode( type, source );
+#endif
+}
+
+
 void GlScope::initializeGL() {
     if ( scope->verboseLevel )
         qDebug() << "GLScope::initializeGL()";
@@ -408,35 +417,44 @@ void GlScope::initializeGL() {
     QString GLEShint;
     if ( GLES100 != GLSLversion )                                 // regular OpenGL
         GLEShint = tr( "Try command line option '--useGLES'\n" ); // offer OpenGL ES as fall back solution
-    QString OpenGLinfo = "Graphic: " + OpenGLversion;
+    QString OpenGLinfo = "Graphic: " + getOpenGLversion(); // our context is current, the lazy probe is free here
     renderInfo = OpenGLinfo + " - GLSL version " + GLSLversion;
     if ( !zoomed )
         qDebug() << renderInfo.toLocal8Bit().data();
     if ( GLSL150 == GLSLversion ) { // use version 150 if supported by OpenGL version >= 3.2
-        if ( !program->addShaderFromSourceCode( QOpenGLShader::Vertex, vertexShaderGLSL150 ) ||
-             !program->addShaderFromSourceCode( QOpenGLShader::Fragment, fragmentShaderGLSL150 ) ) {
+        if ( !addShaderCached( program.get(), QOpenGLShader::Vertex, vertexShaderGLSL150 ) ||
+             !addShaderCached( program.get(), QOpenGLShader::Fragment, fragmentShaderGLSL150 ) ) {
             qWarning() << "Switching to GLSL version 1.20, use the command line option '--useGLSL120' or '--useGLES'";
             GLSLversion = GLSL120; // in case of error try version 120 as fall back
         }
     }
     if ( GLSL120 == GLSLversion ) { // this version is supported by OpenGL version >= 2.1 (older HW/SW)
-        if ( !program->addShaderFromSourceCode( QOpenGLShader::Vertex, vertexShaderGLSL120 ) ||
-             !program->addShaderFromSourceCode( QOpenGLShader::Fragment, fragmentShaderGLSL120 ) ) {
+        if ( !addShaderCached( program.get(), QOpenGLShader::Vertex, vertexShaderGLSL120 ) ||
+             !addShaderCached( program.get(), QOpenGLShader::Fragment, fragmentShaderGLSL120 ) ) {
             errorMessage =
                 tr( "Failed to compile OpenGL shader programs.\n" ) + GLEShint + OpenGLinfo + QString( "\n" ) + program->log();
             return; // in case of error propose the use of OpenGLES (OpenGL for embedded systems) and stop
         }
     }
     if ( GLES100 == GLSLversion ) { // use OpenGLES
-        if ( !program->addShaderFromSourceCode( QOpenGLShader::Vertex, vertexShaderGL100ES ) ||
-             !program->addShaderFromSourceCode( QOpenGLShader::Fragment, fragmentShaderGL100ES ) ) {
+        if ( !addShaderCached( program.get(), QOpenGLShader::Vertex, vertexShaderGL100ES ) ||
+             !addShaderCached( program.get(), QOpenGLShader::Fragment, fragmentShaderGL100ES ) ) {
             errorMessage = tr( "Failed to compile OpenGL shader programs.\n" ) + OpenGLinfo + QString( "\n" ) + program->log();
             return;
         }
     }
 
-    // Link shader pipeline
-    if ( !program->link() || !program->bind() ) {
+    // Link shader pipeline; with cacheable shaders a compile error may surface only
+    // here instead of above, so give the link one retry on the GLSL 1.20 fall back
+    if ( !program->link() && GLSL150 == GLSLversion ) {
+        qWarning() << "Switching to GLSL version 1.20, use the command line option '--useGLSL120' or '--useGLES'";
+        GLSLversion = GLSL120;
+        program.reset( new QOpenGLShaderProgram( context() ) );
+        if ( addShaderCached( program.get(), QOpenGLShader::Vertex, vertexShaderGLSL120 ) &&
+             addShaderCached( program.get(), QOpenGLShader::Fragment, fragmentShaderGLSL120 ) )
+            program->link();
+    }
+    if ( !program->isLinked() || !program->bind() ) {
         errorMessage =
             tr( "Failed to link/bind OpenGL shader programs.\n" ) + GLEShint + renderInfo + QString( "\n" ) + program->log();
         return;
@@ -466,11 +484,20 @@ void GlScope::initializeGL() {
     QColor bg = view->colors->background;
     gl->glClearColor( GLfloat( bg.redF() ), GLfloat( bg.greenF() ), GLfloat( bg.blueF() ), GLfloat( bg.alphaF() ) );
 
+    if ( graphSource ) { // zoomed view: borrow the normal view's vertex buffers
+        if ( graphSource->context() && QOpenGLContext::areSharing( context(), graphSource->context() ) )
+            m_vaoShared.create();
+        else // no share group (e.g. driver quirks): fall back to own uploads
+            graphSource = nullptr;
+    }
+
+    m_vaoReference.create(); // scratch attribute state for the reference trace overlay
+
     m_vaoMarker.create();
     QOpenGLVertexArrayObject::Binder b( &m_vaoMarker );
     m_marker.create();
     m_marker.bind();
-    m_marker.setUsagePattern( QOpenGLBuffer::StaticDraw );
+    m_marker.setUsagePattern( QOpenGLBuffer::DynamicDraw ); // cursor moves update it in place
     m_marker.allocate( int( vaMarker.size() * sizeof( Vertices ) ) );
     program->enableAttributeArray( vertexLocation );
     program->setAttributeBuffer( vertexLocation, GL_FLOAT, 0, 3, 0 );
@@ -481,20 +508,295 @@ void GlScope::initializeGL() {
 
     generateGrid(); // initialize the grid draw structures
 
+    initializeWaterfall(); // optional, the waterfall stays off if its shader fails
+
+    initializePhosphor(); // optional, falls back to the per-history redraw
+
     shaderCompileSuccess = true;
 }
 
 
+void GlScope::initializePhosphor() {
+    // the composite pass reuses the waterfall texture shader
+    if ( !m_waterfallProgram || !QOpenGLFramebufferObject::hasOpenGLFramebufferObjects() )
+        return;
+    // full screen quad in div space, shared by the decay pass (trace program,
+    // position only) and the composite pass (texture program, position + texcoord)
+    const float left = -float( DIVS_TIME ) / 2, right = float( DIVS_TIME ) / 2;
+    const float top = float( DIVS_VOLTAGE ) / 2, bottom = -float( DIVS_VOLTAGE ) / 2;
+    const float quad[ 4 ][ 5 ] = { { left, top, 0.0f, 0.0f, 0.0f },
+                                   { left, bottom, 0.0f, 0.0f, 1.0f },
+                                   { right, top, 0.0f, 1.0f, 0.0f },
+                                   { right, bottom, 0.0f, 1.0f, 1.0f } };
+    m_phosphorQuad.create();
+    m_phosphorQuad.bind();
+    m_phosphorQuad.setUsagePattern( QOpenGLBuffer::StaticDraw );
+    m_phosphorQuad.allocate( quad, int( sizeof( quad ) ) );
+    m_vaoPhosphorDecay.create();
+    {
+        QOpenGLVertexArrayObject::Binder b( &m_vaoPhosphorDecay );
+        m_phosphorQuad.bind();
+        m_program->enableAttributeArray( vertexLocation );
+        m_program->setAttributeBuffer( vertexLocation, GL_FLOAT, 0, 3, 5 * sizeof( float ) );
+    }
+    m_vaoPhosphorComposite.create();
+    {
+        QOpenGLVertexArrayObject::Binder b( &m_vaoPhosphorComposite );
+        m_phosphorQuad.bind();
+        m_waterfallProgram->enableAttributeArray( wfVertexLocation );
+        m_waterfallProgram->setAttributeBuffer( wfVertexLocation, GL_FLOAT, 0, 3, 5 * sizeof( float ) );
+        m_waterfallProgram->enableAttributeArray( wfTexCoordLocation );
+        m_waterfallProgram->setAttributeBuffer( wfTexCoordLocation, GL_FLOAT, 3 * sizeof( float ), 2, 5 * sizeof( float ) );
+    }
+    m_phosphorQuad.release();
+    phosphorReady = true;
+}
+
+
+void GlScope::drawPhosphor() {
+    auto *gl = context()->functions();
+    // the accumulator keeps one texel per pixel, recreate it when the widget resizes
+    bool fresh = phosphorRestart || !m_phosphorFbo || m_phosphorFbo->size() != size();
+    if ( !m_phosphorFbo || m_phosphorFbo->size() != size() )
+        m_phosphorFbo.reset( new QOpenGLFramebufferObject( size() ) );
+    m_phosphorFbo->bind();
+    gl->glDisable( GL_CULL_FACE ); // draw the quads independent of their winding
+    if ( fresh ) { // start from a fully transparent accumulator
+        gl->glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
+        gl->glClear( GL_COLOR_BUFFER_BIT );
+        phosphorRestart = false;
+    } else { // decay: scale the accumulated trace light down, it reaches 10% after depth frames
+        const float decay = 1.0f - float( pow( 0.1, 1.0 / view->digitalPhosphorDepth ) );
+        m_program->setUniformValue( matrixLocation, pmvMatrix ); // the quad must cover the whole accumulator
+        gl->glBlendFunc( GL_ZERO, GL_ONE_MINUS_SRC_ALPHA );      // dst *= 1 - decay, fade toward transparent
+        m_program->setUniformValue( colorLocation, QColor::fromRgbF( 0.0, 0.0, 0.0, qreal( decay ) ) );
+        m_vaoPhosphorDecay.bind();
+        gl->glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+        m_vaoPhosphorDecay.release();
+        gl->glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+        // restore the trace transformation of this view
+        m_program->setUniformValue( matrixLocation, zoomed ? pmvMatrix * zoomMatrix() : pmvMatrix );
+    }
+    // draw only the newest traces into the accumulator, the old ones are already there
+    if ( !graphHistory().empty() ) {
+        Graph &graph = graphHistory().front();
+        for ( ChannelID channel = 0; channel < scope->voltage.size(); ++channel ) {
+            if ( scope->horizontal.format == Dso::GraphFormat::TY ) {
+                drawSpectrumChannelGraph( channel, graph, 0 );
+                if ( scope->histogram )
+                    drawHistogramChannelGraph( channel, graph, 0 );
+                drawEnvelopeChannelGraph( channel, graph, 0 ); // band behind the trace
+            }
+            drawVoltageChannelGraph( channel, graph, 0 );
+        }
+    }
+    // back to the scene framebuffer of this paint, composite the accumulator over it
+    gl->glBindFramebuffer( GL_FRAMEBUFFER, sceneRenderTarget );
+    m_waterfallProgram->bind();
+    m_waterfallProgram->setUniformValue( wfMatrixLocation, pmvMatrix );
+    m_waterfallProgram->setUniformValue( wfScrollLocation, 1.0f ); // v_tex = 1 - texCoord, plain quad
+    gl->glActiveTexture( GL_TEXTURE0 );
+    gl->glBindTexture( GL_TEXTURE_2D, m_phosphorFbo->texture() );
+    m_waterfallProgram->setUniformValue( wfTextureLocation, 0 );
+    gl->glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA ); // the faded accumulator is premultiplied
+    gl->glDepthMask( GL_FALSE ); // the quad must not write depth, the grid still draws on top
+    m_vaoPhosphorComposite.bind();
+    gl->glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+    m_vaoPhosphorComposite.release();
+    gl->glDepthMask( GL_TRUE );
+    gl->glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+    gl->glEnable( GL_CULL_FACE );
+    m_waterfallProgram->release();
+    m_program->bind(); // paintGL() continues with the grid
+}
+
+
+/// Draw the cached scene texture as a full screen quad into the widget framebuffer.
+/// The cache is a complete opaque frame, so the pass replaces the (undefined)
+/// framebuffer content instead of blending over it; the cleared depth lets the
+/// markers draw in front afterwards.
+void GlScope::compositeSceneCache() {
+    auto *gl = context()->functions();
+    gl->glBindFramebuffer( GL_FRAMEBUFFER, defaultFramebufferObject() );
+    QColor bg = view->colors->background;
+    gl->glClearColor( GLfloat( bg.redF() ), GLfloat( bg.greenF() ), GLfloat( bg.blueF() ), GLfloat( bg.alphaF() ) );
+    gl->glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT ); // the quad spares the pixelization border
+    m_waterfallProgram->bind();
+    m_waterfallProgram->setUniformValue( wfMatrixLocation, pmvMatrix );
+    m_waterfallProgram->setUniformValue( wfScrollLocation, 1.0f ); // v_tex = 1 - texCoord, plain quad
+    gl->glActiveTexture( GL_TEXTURE0 );
+    gl->glBindTexture( GL_TEXTURE_2D, m_sceneFbo->texture() );
+    m_waterfallProgram->setUniformValue( wfTextureLocation, 0 );
+    gl->glDisable( GL_BLEND );     // the scene is the finished frame, no blending
+    gl->glDisable( GL_CULL_FACE ); // draw the quad independent of its winding
+    gl->glDepthMask( GL_FALSE );
+    m_vaoPhosphorComposite.bind();
+    gl->glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+    m_vaoPhosphorComposite.release();
+    gl->glDepthMask( GL_TRUE );
+    gl->glEnable( GL_CULL_FACE );
+    gl->glEnable( GL_BLEND );
+    m_waterfallProgram->release();
+}
+
+
+void GlScope::initializeWaterfall() {
+    const char *vertexShaderGL100ES = R"(
+          #version 100
+          attribute highp vec3 vertex;
+          attribute highp vec2 texCoord;
+          uniform mat4 matrix;
+          uniform highp float scroll;
+          varying highp vec2 v_tex;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              v_tex = vec2(texCoord.x, scroll - texCoord.y);
+          }
+    )";
+
+    const char *vertexShaderGLSL120 = R"(
+          #version 120
+          attribute highp vec3 vertex;
+          attribute highp vec2 texCoord;
+          uniform mat4 matrix;
+          uniform highp float scroll;
+          varying highp vec2 v_tex;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              v_tex = vec2(texCoord.x, scroll - texCoord.y);
+          }
+    )";
+
+    const char *vertexShaderGLSL150 = R"(
+          #version 150
+          in highp vec3 vertex;
+          in highp vec2 texCoord;
+          uniform mat4 matrix;
+          uniform highp float scroll;
+          out highp vec2 v_tex;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              v_tex = vec2(texCoord.x, scroll - texCoord.y);
+          }
+    )";
+
+    const char *fragmentShaderGL100ES = R"(
+          #version 100
+          uniform sampler2D waterfall;
+          varying highp vec2 v_tex;
+          void main() { gl_FragColor = texture2D(waterfall, v_tex); }
+    )";
+
+    const char *fragmentShaderGLSL120 = R"(
+          #version 120
+          uniform sampler2D waterfall;
+          varying highp vec2 v_tex;
+          void main() { gl_FragColor = texture2D(waterfall, v_tex); }
+    )";
+
+    const char *fragmentShaderGLSL150 = R"(
+          #version 150
+          uniform sampler2D waterfall;
+          in highp vec2 v_tex;
+          out vec4 texColor;
+          void main() { texColor = texture(waterfall, v_tex); }
+    )";
+
+    auto program = std::unique_ptr< QOpenGLShaderProgram >( new QOpenGLShaderProgram( context() ) );
+    const char *vertexShader = vertexShaderGLSL120;
+    const char *fragmentShader = fragmentShaderGLSL120;
+    if ( GLSL150 == GLSLversion ) {
+        vertexShader = vertexShaderGLSL150;
+        fragmentShader = fragmentShaderGLSL150;
+    } else if ( GLES100 == GLSLversion ) {
+        vertexShader = vertexShaderGL100ES;
+        fragmentShader = fragmentShaderGL100ES;
+    }
+    if ( !addShaderCached( program.get(), QOpenGLShader::Vertex, vertexShader ) ||
+         !addShaderCached( program.get(), QOpenGLShader::Fragment, fragmentShader ) || !program->link() || !program->bind() ) {
+        qWarning() << "Failed to compile the waterfall shader, the spectrogram stays off." << program->log();
+        return;
+    }
+    wfVertexLocation = program->attributeLocation( "vertex" );
+    wfTexCoordLocation = program->attributeLocation( "texCoord" );
+    wfMatrixLocation = program->uniformLocation( "matrix" );
+    wfScrollLocation = program->uniformLocation( "scroll" );
+    wfTextureLocation = program->uniformLocation( "waterfall" );
+    if ( wfVertexLocation == -1 || wfTexCoordLocation == -1 || wfMatrixLocation == -1 || wfScrollLocation == -1 ||
+         wfTextureLocation == -1 ) {
+        qWarning() << "Failed to locate a waterfall shader variable, the spectrogram stays off.";
+        program->release();
+        return;
+    }
+
+    // full screen quad with interleaved position and texture coordinates; the top
+    // edge samples the newest row, the bottom edge the oldest one still kept
+    const float left = -float( DIVS_TIME ) / 2, right = float( DIVS_TIME ) / 2;
+    const float top = float( DIVS_VOLTAGE ) / 2, bottom = -float( DIVS_VOLTAGE ) / 2;
+    const float vMax = float( waterfallRows - 1 ) / float( waterfallRows );
+    const float quad[ 4 ][ 5 ] = { { left, top, 0.0f, 0.0f, 0.0f },
+                                   { left, bottom, 0.0f, 0.0f, vMax },
+                                   { right, top, 0.0f, 1.0f, 0.0f },
+                                   { right, bottom, 0.0f, 1.0f, vMax } };
+    m_vaoWaterfall.create();
+    QOpenGLVertexArrayObject::Binder b( &m_vaoWaterfall );
+    m_waterfallQuad.create();
+    m_waterfallQuad.bind();
+    m_waterfallQuad.setUsagePattern( QOpenGLBuffer::StaticDraw );
+    m_waterfallQuad.allocate( quad, int( sizeof( quad ) ) );
+    program->enableAttributeArray( wfVertexLocation );
+    program->setAttributeBuffer( wfVertexLocation, GL_FLOAT, 0, 3, 5 * sizeof( float ) );
+    program->enableAttributeArray( wfTexCoordLocation );
+    program->setAttributeBuffer( wfTexCoordLocation, GL_FLOAT, 3 * sizeof( float ), 2, 5 * sizeof( float ) );
+    program->release();
+    m_waterfallProgram = std::move( program );
+}
+
+
 void GlScope::showData( std::shared_ptr< PPresult > newData ) {
     if ( !shaderCompileSuccess )
         return;
-    makeCurrent();
+    if ( graphSource ) { // the normal view uploads the shared vertex buffers, just repaint
+        sceneCacheValid = false; // the borrowed buffers change, the cached scene is stale
+        update();
+        return;
+    }
+    if ( !zoomed && scope->waterfall ) { // append one spectrum row to the ring texture
+        makeCurrent();                   // a single row upload, cheap enough for the signal path
+        appendWaterfallRow( newData.get() );
+    }
+    { // publish the newest result, paintGL() picks it up; an unpainted older block is dropped
+        QMutexLocker lock( &pendingDataMutex );
+        pendingData = std::move( newData );
+    }
+    update();
+}
+
+
+void GlScope::uploadPendingData() {
+    std::shared_ptr< PPresult > newData;
+    { // take the newest published result, if any
+        QMutexLocker lock( &pendingDataMutex );
+        newData.swap( pendingData );
+    }
+    if ( !newData )
+        return; // repaint without new data (resize, marker or grid update)
+
+    tracePaintTag = newData->tag; // the paint that follows completes this block
+
+    // with GPU accumulation the persistence lives in the phosphor FBO,
+    // a single graph is enough; without it keep the full redraw history
+    const size_t draws = phosphorReady ? 1 : view->digitalPhosphorDraws();
+
     // Remove too much entries
-    while ( view->digitalPhosphorDraws() < m_GraphHistory.size() )
+    while ( draws < m_GraphHistory.size() )
         m_GraphHistory.pop_back();
 
     // Add if missing
-    if ( view->digitalPhosphorDraws() > m_GraphHistory.size() ) {
+    if ( draws > m_GraphHistory.size() ) {
         m_GraphHistory.resize( m_GraphHistory.size() + 1 );
     }
 
@@ -503,12 +805,217 @@ void GlScope::showData( std::shared_ptr< PPresult > newData ) {
 
     // Add new entry
     m_GraphHistory.front().writeData( newData.get(), m_program.get(), vertexLocation );
-    // doneCurrent();
 
+    m_annotations = newData->decoderAnnotations; // empty unless protocol decoding is enabled
+    lastResult = newData;                        // kept as the source of a reference trace freeze
+}
+
+
+QString GlScope::referenceFileName() const {
+    // next to the persisted settings, like the FFTW wisdom of the spectrum generator
+    return QFileInfo( QSettings().fileName() ).absolutePath() + "/reference_traces.dat";
+}
+
+
+/// Freeze the voltage traces of the newest displayed block into the reference
+/// overlay. The same linear gain/offset map that drawVoltageChannelGraph() folds
+/// into the matrix uniform is baked into the vertices here, so the frozen picture
+/// stays in place when the live gain, offset or trigger settings change afterwards.
+void GlScope::freezeReferenceTrace() {
+    if ( graphSource ) { // the overlay lives in the normal view, like the graph buffers
+        graphSource->freezeReferenceTrace();
+        return;
+    }
+    if ( !lastResult )
+        return; // nothing on the screen yet
+    referenceTraces.assign( scope->voltage.size(), std::vector< GraphVertex >() );
+    for ( ChannelID channel = 0; channel < scope->voltage.size() && channel < lastResult->vaChannelVoltage.size(); ++channel ) {
+        if ( !scope->voltage[ channel ].used )
+            continue;
+        const ChannelGraph &graph = lastResult->vaChannelVoltage[ channel ];
+        std::vector< GraphVertex > &reference = referenceTraces[ channel ];
+        reference.resize( graph.size() );
+        // TY traces map only y, XY graphs (stored at the odd y channel) map both axes
+        float xScale = 1.0f, xShift = 0.0f;
+        if ( scope->horizontal.format == Dso::GraphFormat::XY && ( channel & 1 ) ) {
+            xScale = 1.0f / float( scope->gain( channel - 1 ) );
+            xShift = float( ( scope->trigger.position - 0.5 ) * DIVS_TIME );
+        }
+        const float yScale = 1.0f / float( scope->gain( channel ) );
+        const float yShift = float( scope->voltage[ channel ].offset );
+        for ( size_t vertex = 0; vertex < graph.size(); ++vertex ) {
+            reference[ vertex ].x = graph[ vertex ].x * xScale + xShift;
+            reference[ vertex ].y = graph[ vertex ].y * yScale + yShift;
+        }
+    }
+    referenceUpload = true;
+    saveReferenceTrace();
+    update();
+}
+
+
+void GlScope::clearReferenceTrace() {
+    if ( graphSource ) {
+        graphSource->clearReferenceTrace();
+        return;
+    }
+    referenceTraces.clear();
+    referenceSections.clear();
+    referenceUpload = false;
+    QFile::remove( referenceFileName() );
     update();
 }
 
 
+void GlScope::saveReferenceTrace() const {
+    QFile file( referenceFileName() );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        qWarning() << "GlScope: cannot save the reference trace to" << file.fileName();
+        return;
+    }
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    stream << quint32( 0x52656631 ); // "Ref1"
+    stream << quint32( referenceTraces.size() );
+    for ( const std::vector< GraphVertex > &reference : referenceTraces ) {
+        stream << quint32( reference.size() );
+        for ( const GraphVertex &vertex : reference )
+            stream << vertex.x << vertex.y;
+    }
+    if ( scope->verboseLevel > 1 )
+        qDebug() << " GlScope: saved the reference trace to" << file.fileName();
+}
+
+
+void GlScope::loadReferenceTrace() {
+    QFile file( referenceFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return; // no frozen trace from an earlier session
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    quint32 magic = 0, channels = 0;
+    stream >> magic >> channels;
+    if ( magic != 0x52656631 || channels > 16 ) {
+        qWarning() << "GlScope: not a reference trace file:" << file.fileName();
+        return;
+    }
+    referenceTraces.resize( channels );
+    for ( std::vector< GraphVertex > &reference : referenceTraces ) {
+        quint32 count = 0;
+        stream >> count;
+        if ( count > 0x100000 ) { // far beyond any record length, the file is damaged
+            referenceTraces.clear();
+            return;
+        }
+        reference.resize( count );
+        for ( GraphVertex &vertex : reference )
+            stream >> vertex.x >> vertex.y;
+    }
+    if ( stream.status() != QDataStream::Ok )
+        referenceTraces.clear();
+    referenceUpload = !referenceTraces.empty();
+    if ( referenceUpload && scope->verboseLevel > 1 )
+        qDebug() << " GlScope: restored the reference trace from" << file.fileName();
+}
+
+
+/// Draw the frozen overlay. The vertices carry baked div coordinates, so only the
+/// shared (zoomed) projection applies and no per frame CPU work is needed; a fresh
+/// freeze or restore is uploaded once into the static buffer here.
+void GlScope::drawReferenceTraces() {
+    GlScope *source = graphSource ? graphSource : this;
+    if ( !graphSource && referenceUpload ) { // (re)upload the frozen vertices once
+        if ( !m_reference.isCreated() ) {
+            m_reference.create();
+            m_reference.setUsagePattern( QOpenGLBuffer::StaticDraw );
+        }
+        int neededMemory = 0;
+        for ( const std::vector< GraphVertex > &reference : referenceTraces )
+            neededMemory += int( reference.size() * sizeof( GraphVertex ) );
+        m_reference.bind();
+        m_reference.allocate( neededMemory );
+        referenceSections.resize( referenceTraces.size() );
+        int offset = 0;
+        for ( ChannelID channel = 0; channel < referenceTraces.size(); ++channel ) {
+            const std::vector< GraphVertex > &reference = referenceTraces[ channel ];
+            int dataSize = int( reference.size() * sizeof( GraphVertex ) );
+            m_reference.write( offset, reference.data(), dataSize );
+            referenceSections[ channel ].count = int( reference.size() );
+            referenceSections[ channel ].offset = offset;
+            offset += dataSize;
+        }
+        m_reference.release();
+        referenceUpload = false;
+    }
+    if ( source->referenceSections.empty() )
+        return;
+    auto *gl = context()->functions();
+    // the buffer of the normal view is visible here through the share group, its
+    // VAO is not - bind the scratch attribute state of this context instead
+    QOpenGLVertexArrayObject::Binder b( &m_vaoReference );
+    QOpenGLBuffer &buffer = source->m_reference;
+    for ( ChannelID channel = 0; channel < source->referenceSections.size() && channel < scope->voltage.size(); ++channel ) {
+        Graph::VaoCount &section = source->referenceSections[ channel ];
+        if ( !section.count )
+            continue;
+        // a dimmed channel color separates the frozen trace from the live one
+        m_program->setUniformValue( colorLocation, view->colors->voltage[ channel ].darker( 200 ) );
+        buffer.bind();
+        m_program->enableAttributeArray( vertexLocation );
+        m_program->setAttributeBuffer( vertexLocation, GL_FLOAT, section.offset, 2, 0 ); // x, y - the shader fills in z = 0
+        gl->glDrawArrays( GL_LINE_STRIP, 0, section.count );
+        buffer.release();
+    }
+}
+
+
+// Overlay the decoder annotations as a text band above the traces. The positions
+// come in scope divisions (the graph coordinate system) and are mapped to widget
+// pixels here; the zoomed view applies the same x transform as its zoomMatrix().
+void GlScope::drawAnnotations( QPainter &painter ) {
+    const std::vector< DecoderAnnotation > &annotations = graphSource ? graphSource->m_annotations : m_annotations;
+    if ( annotations.empty() )
+        return;
+    double zoomScale = 1.0, zoomCenter = 0.0;
+    if ( zoomed ) {
+        const double markerSpan = fabs( scope->getMarker( 1 ) - scope->getMarker( 0 ) );
+        if ( markerSpan <= 0.0 )
+            return;
+        zoomScale = DIVS_TIME / markerSpan;
+        zoomCenter = ( scope->getMarker( 0 ) + scope->getMarker( 1 ) ) / 2.0;
+    }
+    painter.setRenderHint( QPainter::Antialiasing, true );
+    const QFontMetrics metrics = painter.fontMetrics();
+    const double bandHeight = metrics.height() + 4.0;
+    const double bandTop = 4.0;
+    const QColor boxColor = view->colors->markers;
+    const QColor errorColor( Qt::red );
+    QColor fillColor = view->colors->background;
+    fillColor.setAlpha( 160 ); // keep the trace below shining through
+    for ( const DecoderAnnotation &annotation : annotations ) {
+        double xStart = ( ( annotation.xStart - zoomCenter ) * zoomScale / DIVS_TIME + 0.5 ) * width();
+        double xEnd = ( ( annotation.xEnd - zoomCenter ) * zoomScale / DIVS_TIME + 0.5 ) * width();
+        if ( xEnd < 0.0 || xStart > width() )
+            continue; // outside of the (zoomed) screen
+        if ( xEnd - xStart < 2.0 )
+            xEnd = xStart + 2.0; // zero width conditions (I2C start/stop) stay visible
+        const QRectF box( xStart, bandTop, xEnd - xStart, bandHeight );
+        painter.fillRect( box, fillColor );
+        painter.setPen( annotation.error ? errorColor : boxColor );
+        painter.drawRect( box );
+#if ( QT_VERSION >= QT_VERSION_CHECK( 5, 11, 0 ) )
+        const int textWidth = metrics.horizontalAdvance( annotation.text );
+#else
+        const int textWidth = metrics.width( annotation.text );
+#endif
+        if ( textWidth <= box.width() - 2.0 ) {
+            painter.setPen( annotation.error ? errorColor : view->colors->text );
+            painter.drawText( box, Qt::AlignCenter, annotation.text );
+        }
+    }
+}
+
+
 void GlScope::generateVertices( int marker, const DsoSettingsScopeCursor &cursor ) {
     const float Z_ORDER = 1.0f;
     switch ( cursor.shape ) {
@@ -553,16 +1060,60 @@ void GlScope::selectCursor( int index ) {
 
 
 void GlScope::updateCursor( int index ) {
+    // a cursor move changes only the overlay, tag the repaint so paintGL() can
+    // reuse the cached scene; the zoomed view maps its traces between the markers
+    // (zoomMatrix()), so a marker change needs the full scene there
+    const bool overlay = index > 0 || !zoomed;
     if ( index > 0 ) {
         generateVertices( index, *cursorInfo[ size_t( index ) ] );
-    } else
+        // Write only the four vertices of this cursor to GPU
+        makeCurrent();
+        m_marker.bind();
+        m_marker.write( int( size_t( index ) * sizeof( Vertices ) ), &vaMarker[ size_t( index ) ], int( sizeof( Vertices ) ) );
+    } else {
         for ( index = 0; index < int( cursorInfo.size() ); ++index ) {
             generateVertices( index, *cursorInfo[ size_t( index ) ] );
         }
-    // Write coordinates to GPU
-    makeCurrent();
-    m_marker.bind();
-    m_marker.write( 0, vaMarker.data(), int( vaMarker.size() * sizeof( Vertices ) ) );
+        // Write all coordinates to GPU
+        makeCurrent();
+        m_marker.bind();
+        m_marker.write( 0, vaMarker.data(), int( vaMarker.size() * sizeof( Vertices ) ) );
+    }
+    updateHitZones(); // the layout changed, refresh the snap areas of the handles
+    if ( overlay )
+        ++overlayPaints;
+    update();
+}
+
+
+/// Rebuild the snap zones of the selected cursor's handles, called whenever the
+/// cursor layout changes; the press handler then only tests ready-made rectangles.
+void GlScope::updateHitZones() {
+    hitZones.clear();
+    const DsoSettingsScopeCursor &cursor = *cursorInfo[ size_t( selectedCursor ) ];
+    const double snap = 1.0 / DIVS_SUB; // +/- 1% of full scale
+    switch ( cursor.shape ) {
+    case DsoSettingsScopeCursor::NONE:
+        break;
+    case DsoSettingsScopeCursor::VERTICAL:
+        for ( int marker = 0; marker < 2; ++marker )
+            hitZones.push_back( { QRectF( cursor.pos[ marker ].x() - snap, -double( DIVS_VOLTAGE ), 2 * snap,
+                                          2.0 * DIVS_VOLTAGE ),
+                                  marker, false } );
+        break;
+    case DsoSettingsScopeCursor::HORIZONTAL:
+        for ( int marker = 0; marker < 2; ++marker )
+            hitZones.push_back( { QRectF( -double( DIVS_TIME ), cursor.pos[ marker ].y() - snap, 2.0 * DIVS_TIME, 2 * snap ),
+                                  marker, false } );
+        break;
+    case DsoSettingsScopeCursor::RECTANGULAR: // one zone per corner, a mixed corner swaps the y coordinates on grab
+        for ( int xIndex = 0; xIndex < 2; ++xIndex )
+            for ( int yIndex = 0; yIndex < 2; ++yIndex )
+                hitZones.push_back( { QRectF( cursor.pos[ xIndex ].x() - snap, cursor.pos[ yIndex ].y() - snap, 2 * snap,
+                                              2 * snap ),
+                                      xIndex, xIndex != yIndex } );
+        break;
+    }
 }
 
 
@@ -570,48 +1121,122 @@ void GlScope::paintGL() {
     if ( !shaderCompileSuccess )
         return;
 
+    // upload at most one new block per paint, results between two paints collapse
+    // to the latest (frame-latest semantics)
+    uploadPendingData();
+
     auto *gl = context()->functions();
 
-    QColor bg = view->colors->background;
-    gl->glClearColor( GLfloat( bg.redF() ), GLfloat( bg.greenF() ), GLfloat( bg.blueF() ), GLfloat( bg.alphaF() ) );
+    // A repaint caused only by cursor moves (tagged by updateCursor()) reuses the
+    // cached scene: composite it and redraw just the markers on top, the waterfall,
+    // trace and grid passes are skipped completely. Everything else (a new block,
+    // settings changes, expose, resize) renders the full scene and refreshes the cache.
+    const bool overlayOnly =
+        overlayPaints > 0 && !tracePaintTag && sceneCacheValid && m_sceneFbo && m_sceneFbo->size() == size();
+    overlayPaints = 0;
+
+    if ( !overlayOnly ) {
+        sceneCacheValid = false;
+        if ( phosphorReady ) { // render the scene into the cache, the composite pass shows it
+            if ( !m_sceneFbo || m_sceneFbo->size() != size() )
+                m_sceneFbo.reset( new QOpenGLFramebufferObject( size(), QOpenGLFramebufferObject::CombinedDepthStencil ) );
+            sceneRenderTarget = m_sceneFbo->handle();
+        } else { // no FBO or texture shader support, draw directly into the widget
+            sceneRenderTarget = defaultFramebufferObject();
+        }
+        gl->glBindFramebuffer( GL_FRAMEBUFFER, sceneRenderTarget );
 
-    // Clear OpenGL buffer and configure settings
-    // TODO Don't clear if view->digitalPhosphorDraws()>1
-    gl->glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-    gl->glLineWidth( 1 );
+        QColor bg = view->colors->background;
+        gl->glClearColor( GLfloat( bg.redF() ), GLfloat( bg.greenF() ), GLfloat( bg.blueF() ), GLfloat( bg.alphaF() ) );
 
-    m_program->bind();
+        // Clear OpenGL buffer and configure settings
+        // TODO Don't clear if view->digitalPhosphorDraws()>1
+        gl->glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+        gl->glLineWidth( 1 );
 
-    // Apply zoom settings via matrix transformation
-    if ( zoomed ) {
-        QMatrix4x4 m;
-        m.scale( QVector3D( GLfloat( DIVS_TIME ) / GLfloat( fabs( scope->getMarker( 1 ) - scope->getMarker( 0 ) ) ), 1.0f, 1.0f ) );
-        m.translate( -GLfloat( scope->getMarker( 0 ) + scope->getMarker( 1 ) ) / 2, 0.0f, 0.0f );
-        m_program->setUniformValue( matrixLocation, pmvMatrix * m );
-    }
+        if ( !zoomed && scope->waterfall ) // the spectrogram lies behind grid and traces
+            drawWaterfall();
 
-    drawMarkers();
+        m_program->bind();
 
-    unsigned historyIndex = 0;
-    for ( Graph &graph : m_GraphHistory ) {
-        for ( ChannelID channel = 0; channel < scope->voltage.size(); ++channel ) {
-            if ( scope->horizontal.format == Dso::GraphFormat::TY ) {
-                drawSpectrumChannelGraph( channel, graph, int( historyIndex ) );
-                if ( scope->histogram ) {
-                    drawHistogramChannelGraph( channel, graph, int( historyIndex ) );
+        // Apply zoom settings via matrix transformation
+        if ( zoomed )
+            m_program->setUniformValue( matrixLocation, pmvMatrix * zoomMatrix() );
+
+        drawReferenceTraces(); // the frozen overlay lies behind the live traces
+
+        if ( phosphorReady && view->digitalPhosphor ) {
+            drawPhosphor(); // decay, accumulate and composite - cost independent of the depth
+        } else {
+            phosphorRestart = true; // restart the accumulation cleanly when re-enabled
+            unsigned historyIndex = 0;
+            for ( Graph &graph : graphHistory() ) {
+                for ( ChannelID channel = 0; channel < scope->voltage.size(); ++channel ) {
+                    if ( scope->horizontal.format == Dso::GraphFormat::TY ) {
+                        drawSpectrumChannelGraph( channel, graph, int( historyIndex ) );
+                        if ( scope->histogram ) {
+                            drawHistogramChannelGraph( channel, graph, int( historyIndex ) );
+                        }
+                        drawEnvelopeChannelGraph( channel, graph, int( historyIndex ) ); // band behind the trace
+                    }
+                    drawVoltageChannelGraph( channel, graph, int( historyIndex ) );
                 }
+                ++historyIndex;
             }
-            drawVoltageChannelGraph( channel, graph, int( historyIndex ) );
         }
-        ++historyIndex;
+
+        if ( zoomed ) {
+            m_program->setUniformValue( matrixLocation, pmvMatrix );
+        }
+
+        drawGrid();
+        m_program->release();
+
+        sceneCacheValid = phosphorReady; // the cache now matches the screen
     }
 
-    if ( zoomed ) {
+    if ( phosphorReady ) // show the fresh or cached scene in the widget framebuffer
+        compositeSceneCache();
+
+    // the markers draw after the composite so a cursor-only repaint can reuse the
+    // cached scene untouched; their Z_ORDER keeps them in front of the traces anyway
+    m_program->bind();
+    if ( zoomed )
+        m_program->setUniformValue( matrixLocation, pmvMatrix * zoomMatrix() );
+    drawMarkers();
+    if ( zoomed )
         m_program->setUniformValue( matrixLocation, pmvMatrix );
+    m_program->release();
+
+    // decoder annotations paint over the finished GL frame with QPainter (text),
+    // the painter renders into the same framebuffer as the GL calls above
+    if ( !( graphSource ? graphSource->m_annotations : m_annotations ).empty() ) {
+        QPainter painter( this );
+        drawAnnotations( painter );
     }
 
-    drawGrid();
-    m_program->release();
+    if ( tracePaintTag ) { // a freshly uploaded block reached the screen with this frame
+        FrameTrace::record( "paint", tracePaintTag );
+        tracePaintTag = 0;
+        if ( !graphSource ) { // the zoomed view borrows these buffers, count them once
+            ++paintedFramesCount; // new waveforms on screen, not cursor-only repaints
+            // per frame memory telemetry of the GL side: the vertex buffer rings of
+            // the history graphs, see FrameTrace::counter()
+            size_t glBytes = 0;
+            for ( const Graph &graph : m_GraphHistory )
+                for ( unsigned slot = 0; slot < Graph::bufferCount; ++slot )
+                    glBytes += size_t( graph.allocatedMem[ slot ] );
+            FrameTrace::counter( "mem.gl", glBytes );
+        }
+    }
+}
+
+
+QMatrix4x4 GlScope::zoomMatrix() const {
+    QMatrix4x4 m;
+    m.scale( QVector3D( GLfloat( DIVS_TIME ) / GLfloat( fabs( scope->getMarker( 1 ) - scope->getMarker( 0 ) ) ), 1.0f, 1.0f ) );
+    m.translate( -GLfloat( scope->getMarker( 0 ) + scope->getMarker( 1 ) ) / 2, 0.0f, 0.0f );
+    return m;
 }
 
 
@@ -663,17 +1288,54 @@ void GlScope::generateGrid( int index, double value, bool pressed ) {
     if ( program == nullptr )
         return;
 
-    for ( int iii = 0; iii < gridItems; ++iii )
-        gridDrawCounts[ iii ] = 0;
+    makeCurrent();
 
+    // the grid, axes and border geometry never changes - build it once; the
+    // slider paths that call in per mouse move only touch the trigger line below
     if ( !m_grid.isCreated() )
-        m_grid.create();
+        generateStaticGrid();
+
+    // dynamic trigger level marker line, two vertices updated in place
+    int item = gridItems - 1;
+    if ( !m_triggerLine.isCreated() ) {
+        m_triggerLine.create();
+        m_triggerLine.bind();
+        m_triggerLine.setUsagePattern( QOpenGLBuffer::DynamicDraw );
+        m_triggerLine.allocate( int( 2 * sizeof( QVector3D ) ) );
+        if ( !m_vaoGrid[ item ].isCreated() )
+            m_vaoGrid[ item ].create();
+        QOpenGLVertexArrayObject::Binder b( &m_vaoGrid[ item ] );
+        m_triggerLine.bind();
+        program->enableAttributeArray( vertexLocation );
+        program->setAttributeBuffer( vertexLocation, GL_FLOAT, 0, 3, 0 );
+    }
+    gridDrawCounts[ item ] = 0;
+    if ( pressed && index >= 0 ) {
+        triggerLineColor = view->colors->voltage[ unsigned( index ) ];
+        if ( index != int( scope->trigger.source ) )
+            triggerLineColor = triggerLineColor.darker();
+        float yPos = float( ( value / scope->gain( unsigned( index ) ) + scope->voltage[ unsigned( index ) ].offset ) );
+        const QVector3D line[ 2 ] = { QVector3D( -DIVS_TIME / 2, yPos, 0 ), QVector3D( DIVS_TIME / 2, yPos, 0 ) };
+        m_triggerLine.bind();
+        m_triggerLine.write( 0, line, int( sizeof( line ) ) );
+        m_triggerLine.release();
+        gridDrawCounts[ item ] = 2;
+    }
+}
+
+
+// build the static grid sections (dots, axes, border) into their own buffer
+void GlScope::generateStaticGrid() {
+    QOpenGLShaderProgram *program = m_program.get();
+
+    m_grid.create();
     m_grid.bind();
     m_grid.setUsagePattern( QOpenGLBuffer::StaticDraw );
 
     std::vector< QVector3D > vaGrid;
 
     int item = 0;
+    gridDrawCounts[ item ] = 0;
 
     { // Bind draw vertical lines
         if ( !m_vaoGrid[ item ].isCreated() )
@@ -710,6 +1372,7 @@ void GlScope::generateGrid( int index, double value, bool pressed ) {
     }
 
     ++item;
+    gridDrawCounts[ item ] = 0;
 
     { // Bind draw axes
         if ( !m_vaoGrid[ item ].isCreated() )
@@ -764,6 +1427,7 @@ void GlScope::generateGrid( int index, double value, bool pressed ) {
     }
 
     ++item;
+    gridDrawCounts[ item ] = 0;
 
     { // Border
         if ( !m_vaoGrid[ item ].isCreated() )
@@ -779,26 +1443,6 @@ void GlScope::generateGrid( int index, double value, bool pressed ) {
     vaGrid.push_back( QVector3D( DIVS_TIME / 2, DIVS_VOLTAGE / 2, 0 ) );
     vaGrid.push_back( QVector3D( -DIVS_TIME / 2, DIVS_VOLTAGE / 2, 0 ) );
 
-    ++item;
-
-    { // prepare (dynamic) trigger level marker line
-        if ( !m_vaoGrid[ item ].isCreated() )
-            m_vaoGrid[ item ].create();
-        QOpenGLVertexArrayObject::Binder b( &m_vaoGrid[ item ] );
-        m_grid.bind();
-        program->enableAttributeArray( vertexLocation );
-        program->setAttributeBuffer( vertexLocation, GL_FLOAT, int( vaGrid.size() * sizeof( QVector3D ) ), 3 );
-    }
-    if ( pressed && index >= 0 ) {
-        triggerLineColor = view->colors->voltage[ unsigned( index ) ];
-        if ( index != int( scope->trigger.source ) )
-            triggerLineColor = triggerLineColor.darker();
-        float yPos = float( ( value / scope->gain( unsigned( index ) ) + scope->voltage[ unsigned( index ) ].offset ) );
-        gridDrawCounts[ item ] += 2;
-        vaGrid.push_back( QVector3D( -DIVS_TIME / 2, yPos, 0 ) );
-        vaGrid.push_back( QVector3D( DIVS_TIME / 2, yPos, 0 ) );
-    }
-
     m_grid.allocate( &vaGrid[ 0 ], int( vaGrid.size() * sizeof( QVector3D ) ) );
     m_grid.release();
 }
@@ -878,16 +1522,51 @@ void GlScope::drawMarkers() {
 }
 
 
+void GlScope::drawGraphSection( Graph &graph, Graph::VaoCount &section, GLenum mode ) {
+    if ( graphSource ) {
+        // the vertices live in the normal view's buffer objects, which are visible in
+        // this context through the share group; its VAOs are not, so bind the buffer
+        // of the frame's ring slot directly and point into the section
+        QOpenGLVertexArrayObject::Binder b( &m_vaoShared );
+        QOpenGLBuffer &buffer = graph.buffers[ graph.bufferIndex ];
+        buffer.bind();
+        m_program->enableAttributeArray( vertexLocation );
+        m_program->setAttributeBuffer( vertexLocation, GL_FLOAT, section.offset, 2, 0 ); // x, y - the shader fills in z = 0
+        context()->functions()->glDrawArrays( mode, 0, section.count );
+        buffer.release();
+    } else {
+        QOpenGLVertexArrayObject::Binder b( section.vao );
+        context()->functions()->glDrawArrays( mode, 0, section.count );
+    }
+}
+
+
 void GlScope::drawVoltageChannelGraph( ChannelID channel, Graph &graph, int historyIndex ) {
     if ( !scope->voltage[ channel ].used )
         return;
 
-    m_program->setUniformValue( colorLocation, view->colors->voltage[ channel ].darker( 100 + 10 * historyIndex ) );
-    Graph::VaoCount &v = graph.vaoVoltage[ channel ];
+    // The voltage vertices hold raw sample values; gain and offset are a linear
+    // map that is folded into the matrix uniform here, so changing them costs a
+    // uniform update instead of a full trace regeneration and re-upload.
+    // TY traces map only y, XY graphs (stored at the odd y channel) map both axes.
+    QMatrix4x4 m = zoomed ? pmvMatrix * zoomMatrix() : pmvMatrix;
+    if ( scope->horizontal.format == Dso::GraphFormat::XY ) {
+        if ( channel & 1 ) {
+            m.translate( float( ( scope->trigger.position - 0.5 ) * DIVS_TIME ), float( scope->voltage[ channel ].offset ) );
+            m.scale( 1.0f / float( scope->gain( channel - 1 ) ), 1.0f / float( scope->gain( channel ) ) );
+        }
+    } else {
+        m.translate( 0.0f, float( scope->voltage[ channel ].offset ) );
+        m.scale( 1.0f, 1.0f / float( scope->gain( channel ) ) );
+    }
+    m_program->setUniformValue( matrixLocation, m );
 
-    QOpenGLVertexArrayObject::Binder b( v.first );
+    m_program->setUniformValue( colorLocation, view->colors->voltage[ channel ].darker( 100 + 10 * historyIndex ) );
     const GLenum dMode = ( view->interpolation == Dso::INTERPOLATION_OFF ) ? GL_POINTS : GL_LINE_STRIP;
-    context()->functions()->glDrawArrays( dMode, 0, v.second );
+    drawGraphSection( graph, graph.vaoVoltage[ channel ], dMode );
+
+    // restore the shared trace transformation
+    m_program->setUniformValue( matrixLocation, zoomed ? pmvMatrix * zoomMatrix() : pmvMatrix );
 }
 
 
@@ -896,11 +1575,27 @@ void GlScope::drawHistogramChannelGraph( ChannelID channel, Graph &graph, int hi
         return;
 
     m_program->setUniformValue( colorLocation, view->colors->voltage[ channel ].darker( 100 + 10 * historyIndex ) );
-    Graph::VaoCount &h = graph.vaoHistogram[ channel ];
+    drawGraphSection( graph, graph.vaoHistogram[ channel ], GL_LINES ); // display histogram with lines
+}
 
-    QOpenGLVertexArrayObject::Binder b( h.first );
-    const GLenum dMode = GL_LINES; // display histogram with lines
-    context()->functions()->glDrawArrays( dMode, 0, h.second );
+
+void GlScope::drawEnvelopeChannelGraph( ChannelID channel, Graph &graph, int historyIndex ) {
+    if ( channel >= graph.vaoEnvelope.size() || !scope->voltage[ channel ].used )
+        return;
+
+    // The band vertices hold raw sample values like the trace, map them with the
+    // same gain/offset matrix so both stay aligned while a slider is dragged.
+    QMatrix4x4 m = zoomed ? pmvMatrix * zoomMatrix() : pmvMatrix;
+    m.translate( 0.0f, float( scope->voltage[ channel ].offset ) );
+    m.scale( 1.0f, 1.0f / float( scope->gain( channel ) ) );
+    m_program->setUniformValue( matrixLocation, m );
+
+    // a dimmed channel color keeps the band readable behind the live trace
+    m_program->setUniformValue( colorLocation, view->colors->voltage[ channel ].darker( 250 + 10 * historyIndex ) );
+    drawGraphSection( graph, graph.vaoEnvelope[ channel ], GL_LINE_STRIP );
+
+    // restore the shared trace transformation
+    m_program->setUniformValue( matrixLocation, zoomed ? pmvMatrix * zoomMatrix() : pmvMatrix );
 }
 
 
@@ -909,9 +1604,95 @@ void GlScope::drawSpectrumChannelGraph( ChannelID channel, Graph &graph, int his
         return;
 
     m_program->setUniformValue( colorLocation, view->colors->spectrum[ channel ].darker( 100 + 10 * historyIndex ) );
-    Graph::VaoCount &v = graph.vaoSpectrum[ channel ];
-
-    QOpenGLVertexArrayObject::Binder b( v.first );
     const GLenum dMode = ( view->interpolation == Dso::INTERPOLATION_OFF ) ? GL_POINTS : GL_LINE_STRIP;
-    context()->functions()->glDrawArrays( dMode, 0, v.second );
+    drawGraphSection( graph, graph.vaoSpectrum[ channel ], dMode );
+}
+
+
+void GlScope::appendWaterfallRow( const PPresult *data ) {
+    if ( !m_waterfallProgram )
+        return;
+    // take the first used spectrum channel of this result for the spectrogram
+    ChannelID channel = 0;
+    const std::vector< double > *samples = nullptr;
+    for ( ; channel < scope->spectrum.size(); ++channel ) {
+        if ( scope->spectrum[ channel ].used && data->data( channel ) && !data->data( channel )->spectrum.samples->empty() ) {
+            samples = data->data( channel )->spectrum.samples.get();
+            break;
+        }
+    }
+    if ( !samples )
+        return;
+    auto *gl = context()->functions();
+    if ( !waterfallTexture ) { // create the ring texture once, prefilled with the background
+        gl->glGenTextures( 1, &waterfallTexture );
+        gl->glBindTexture( GL_TEXTURE_2D, waterfallTexture );
+        gl->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+        gl->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        gl->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+        gl->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT ); // the ring scrolls through the v coordinate
+        QColor bg = view->colors->background;
+        std::vector< unsigned char > blank( size_t( waterfallColumns * waterfallRows ) * 4 );
+        for ( size_t pixel = 0; pixel < blank.size(); pixel += 4 ) {
+            blank[ pixel ] = uchar( bg.red() );
+            blank[ pixel + 1 ] = uchar( bg.green() );
+            blank[ pixel + 2 ] = uchar( bg.blue() );
+            blank[ pixel + 3 ] = 0xFF;
+        }
+        gl->glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, waterfallColumns, waterfallRows, 0, GL_RGBA, GL_UNSIGNED_BYTE, blank.data() );
+    } else {
+        gl->glBindTexture( GL_TEXTURE_2D, waterfallTexture );
+    }
+    // build one row: max-decimate the dB bins into the fixed columns (the maximum
+    // keeps narrow EMI spikes visible) and map them through the same magnitude and
+    // offset scaling as the displayed trace into a brightness of the channel color
+    waterfallLine.resize( size_t( waterfallColumns ) * 4 );
+    const QColor color = view->colors->spectrum[ channel ];
+    const double magnitude = scope->spectrum[ channel ].magnitude;
+    const double offset = scope->spectrum[ channel ].offset;
+    const size_t binCount = samples->size();
+    unsigned char *pixel = waterfallLine.data();
+    for ( int column = 0; column < waterfallColumns; ++column ) {
+        size_t from = size_t( column ) * binCount / waterfallColumns;
+        size_t to = size_t( column + 1 ) * binCount / waterfallColumns;
+        if ( to <= from ) // less bins than columns, repeat the bin
+            to = from + 1;
+        double dB = ( *samples )[ from ];
+        for ( size_t bin = from + 1; bin < to && bin < binCount; ++bin )
+            if ( ( *samples )[ bin ] > dB )
+                dB = ( *samples )[ bin ];
+        double divs = dB / magnitude + offset; // same mapping as the trace
+        double brightness = qBound( 0.0, ( divs + DIVS_VOLTAGE / 2 ) / DIVS_VOLTAGE, 1.0 );
+        *pixel++ = uchar( color.red() * brightness );
+        *pixel++ = uchar( color.green() * brightness );
+        *pixel++ = uchar( color.blue() * brightness );
+        *pixel++ = 0xFF;
+    }
+    // incremental update, upload just this row instead of the whole texture
+    gl->glTexSubImage2D( GL_TEXTURE_2D, 0, 0, waterfallRow, waterfallColumns, 1, GL_RGBA, GL_UNSIGNED_BYTE, waterfallLine.data() );
+    waterfallRow = ( waterfallRow + 1 ) % waterfallRows;
+    waterfallValid = true;
+}
+
+
+void GlScope::drawWaterfall() {
+    if ( !waterfallValid || !m_waterfallProgram )
+        return;
+    auto *gl = context()->functions();
+    m_waterfallProgram->bind();
+    m_waterfallProgram->setUniformValue( wfMatrixLocation, pmvMatrix );
+    // scroll the ring so that the newest row shows at the top edge
+    int newestRow = ( waterfallRow + waterfallRows - 1 ) % waterfallRows;
+    m_waterfallProgram->setUniformValue( wfScrollLocation, ( float( newestRow ) + 0.5f ) / float( waterfallRows ) );
+    gl->glActiveTexture( GL_TEXTURE0 );
+    gl->glBindTexture( GL_TEXTURE_2D, waterfallTexture );
+    m_waterfallProgram->setUniformValue( wfTextureLocation, 0 );
+    gl->glDisable( GL_CULL_FACE ); // draw the quad independent of its winding
+    gl->glDepthMask( GL_FALSE );   // keep it behind grid and traces
+    m_vaoWaterfall.bind();
+    gl->glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+    m_vaoWaterfall.release();
+    gl->glDepthMask( GL_TRUE );
+    gl->glEnable( GL_CULL_FACE );
+    m_waterfallProgram->release();
 }
@@ -2,14 +2,19 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <memory>
 
+#include <QMutex>
 #include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWidget>
+#include <QRectF>
+#include <QVector3D>
 #include <QtGlobal>
 
 #include "glscopegraph.h"
@@ -20,6 +25,7 @@ struct DsoSettingsView;
 struct DsoSettingsScope;
 struct DsoSettingsScopeCursor;
 class PPresult;
+class QPainter;
 
 #define GLES100 "1.00 ES"
 #define GLSL120 "1.20"
@@ -31,16 +37,27 @@ class GlScope : public QOpenGLWidget {
 
   public:
     static GlScope *createNormal( DsoSettingsScope *scope, DsoSettingsView *view, QWidget *parent = nullptr );
-    static GlScope *createZoomed( DsoSettingsScope *scope, DsoSettingsView *view, QWidget *parent = nullptr );
+    /// \brief Create the zoomed view; it draws from the vertex buffers of \a source
+    /// (the normal view, same context share group) instead of uploading its own copy.
+    static GlScope *createZoomed( DsoSettingsScope *scope, DsoSettingsView *view, GlScope *source, QWidget *parent = nullptr );
 
     static void useOpenGLSLversion( QString version = GLSL120 );
     static QString getOpenGLversion();
     static QString getGLSLversion() { return GLSLversion; }
+    /// \brief Total painted frames of the normal (unzoomed) scope views, process
+    /// wide; input of the displayed frames/s rate in the diagnostics dock.
+    static unsigned paintedFrames() { return paintedFramesCount; }
     /**
      * Show new post processed data
      * @param data
      */
     void showData( std::shared_ptr< PPresult > newData );
+    /// \brief Freeze the currently displayed voltage traces into the persistent
+    /// reference overlay (golden unit comparison) and save them to the settings
+    /// directory; a frozen trace from an earlier session is restored on start.
+    void freezeReferenceTrace();
+    /// \brief Remove the reference overlay and delete its persisted file.
+    void clearReferenceTrace();
     void selectCursor( int index );
     void updateCursor( int index = 0 );
     void generateGrid( int index = -1, double value = 0.0, bool pressed = false );
@@ -82,8 +99,24 @@ class GlScope : public QOpenGLWidget {
     void drawVoltageChannelGraph( ChannelID channel, Graph &graph, int historyIndex );
     void drawHistogramChannelGraph( ChannelID channel, Graph &graph, int historyIndex );
     void drawSpectrumChannelGraph( ChannelID channel, Graph &graph, int historyIndex );
+    void drawEnvelopeChannelGraph( ChannelID channel, Graph &graph, int historyIndex );
+    /// \brief Draw one section of a graph, via its VAO in the own context or directly
+    /// from the shared vertex buffer when the graph belongs to the normal view.
+    void drawGraphSection( Graph &graph, Graph::VaoCount &section, GLenum mode );
+    /// \brief Compile the waterfall texture shader and create the screen quad.
+    void initializeWaterfall();
+    /// \brief Build one waterfall row from the newest spectrum and upload it into the ring texture.
+    void appendWaterfallRow( const PPresult *data );
+    /// \brief Draw the scrolled ring texture as a full screen quad behind the traces.
+    void drawWaterfall();
+    /// \brief Create the full screen quad and the VAOs of the phosphor accumulator.
+    void initializePhosphor();
+    /// \brief Fade the accumulator, draw the newest traces into it and composite it.
+    void drawPhosphor();
     QPointF posToScopePos( QPointF pos );
     void rightMouseEvent( QMouseEvent *event );
+    /// \brief The horizontal scale and shift of the zoomed view between the markers.
+    QMatrix4x4 zoomMatrix() const;
 
   signals:
     void markerMoved( int cursorIndex, int marker );
@@ -113,8 +146,25 @@ class GlScope : public QOpenGLWidget {
     int selectedCursor = 0;
     bool rightMouseInside = false;
 
+    // Hit zones: the snap areas of the selected cursor's handles as ready-made
+    // rectangles in scope-div coordinates, rebuilt by updateCursor() when the
+    // cursor layout changes; mousePressEvent() only tests containment, so the
+    // per-shape geometry is not redone on every mouse event. The vector keeps
+    // its capacity (at most four corner zones), a rebuild does not allocate.
+    struct HitZone {
+        QRectF zone; ///< snap rectangle around one handle
+        int marker;  ///< handle index the zone belongs to
+        bool swapY;  ///< rectangular mixed corner: swap the y coordinates on grab
+    };
+    std::vector< HitZone > hitZones;
+    /// \brief Rebuild the snap zones of the selected cursor's handles.
+    void updateHitZones();
+
     // Grid
-    QOpenGLBuffer m_grid;
+    QOpenGLBuffer m_grid;        ///< static sections: dots, axes, border - built once
+    QOpenGLBuffer m_triggerLine; ///< dynamic trigger level line, two vertices updated in place
+    /// \brief Build the static grid sections into m_grid, done once on first use.
+    void generateStaticGrid();
     static const int gridItems = 4;
     QOpenGLVertexArrayObject m_vaoGrid[ gridItems ];
     GLsizei gridDrawCounts[ gridItems ];
@@ -123,7 +173,93 @@ class GlScope : public QOpenGLWidget {
 
     // Graphs
     std::list< Graph > m_GraphHistory;
+    /// The normal view whose vertex buffers this zoomed view draws from. The contexts
+    /// of all QOpenGLWidgets in one window form a share group, so buffer objects are
+    /// visible in both views and the geometry is uploaded only once per frame.
+    GlScope *graphSource = nullptr;
+    QOpenGLVertexArrayObject m_vaoShared; ///< attribute state for drawing the borrowed buffers
+    /// The graph list to draw from: the own history, or the normal view's when this
+    /// zoomed view shares its vertex buffers.
+    std::list< Graph > &graphHistory() { return graphSource ? graphSource->m_GraphHistory : m_GraphHistory; }
     unsigned currentGraphInHistory = 0;
+    // Newest result published by showData(), picked up and uploaded by the next
+    // paintGL(). Blocks arriving faster than the display paints collapse to the
+    // latest one instead of queueing vertex uploads on the GUI thread.
+    std::shared_ptr< PPresult > pendingData;
+    QMutex pendingDataMutex;   ///< guards pendingData
+    unsigned tracePaintTag = 0; ///< tag of the block uploaded for this paint, 0 = repaint only
+    /// \brief Move a pending result into the graph history and upload its vertices.
+    void uploadPendingData();
+
+    // Reference traces: frozen copies of the voltage traces for visual comparison
+    // against a golden unit. Gain and offset are baked into the vertices at freeze
+    // time, so the overlay stays put when the live settings change; the vertices
+    // are uploaded once into their own static buffer and drawn from it every frame
+    // at zero CPU cost. Like the graph buffers they live in the normal view only,
+    // the zoomed view draws them through the share group.
+    std::vector< std::vector< GraphVertex > > referenceTraces; ///< one frozen trace per channel, div coordinates
+    std::vector< Graph::VaoCount > referenceSections; ///< per channel section of m_reference (the vao member is unused)
+    QOpenGLBuffer m_reference;                        ///< the one time uploaded reference vertices
+    QOpenGLVertexArrayObject m_vaoReference;          ///< scratch attribute state of this context
+    bool referenceUpload = false;                     ///< referenceTraces changed, (re)upload before the next draw
+    std::shared_ptr< PPresult > lastResult;           ///< the newest uploaded block, source of a freeze
+    QString referenceFileName() const;
+    void saveReferenceTrace() const;
+    void loadReferenceTrace();
+    /// \brief Upload the frozen traces if needed and draw the overlay.
+    void drawReferenceTraces();
+
+    /// Protocol annotations of the displayed block, kept from the last uploaded
+    /// result; the zoomed view reads them from its graphSource like the vertices.
+    std::vector< DecoderAnnotation > m_annotations;
+    /// \brief Draw the decoder annotations as a text band above the traces.
+    void drawAnnotations( QPainter &painter );
+
+    // Waterfall (spectrogram): the last rows of spectra in a ring texture,
+    // one incremental row upload per block instead of a full re-upload
+    static const int waterfallColumns = 2048; ///< fixed row width, bins are max-decimated into it
+    static const int waterfallRows = 256;     ///< number of kept spectra (texture height)
+    GLuint waterfallTexture = 0;              ///< the ring texture, row = one spectrum
+    int waterfallRow = 0;                     ///< ring index of the next row to write
+    bool waterfallValid = false;              ///< the texture contains at least one row
+    std::vector< unsigned char > waterfallLine; ///< one RGBA row, built on the CPU
+    std::unique_ptr< QOpenGLShaderProgram > m_waterfallProgram;
+    QOpenGLBuffer m_waterfallQuad;
+    QOpenGLVertexArrayObject m_vaoWaterfall;
+    int wfVertexLocation = -1;
+    int wfTexCoordLocation = -1;
+    int wfMatrixLocation = -1;
+    int wfScrollLocation = -1;
+    int wfTextureLocation = -1;
+
+    // Phosphor persistence: instead of re-drawing up to depth old graphs every
+    // frame, the traces accumulate in an offscreen framebuffer that is faded
+    // toward transparent once per frame - one full screen blend, independent of
+    // the persistence depth
+    std::unique_ptr< QOpenGLFramebufferObject > m_phosphorFbo; ///< the accumulator, one texel per pixel
+    QOpenGLBuffer m_phosphorQuad;                    ///< full screen quad, position + texcoord interleaved
+    QOpenGLVertexArrayObject m_vaoPhosphorDecay;     ///< the quad with the trace program layout
+    QOpenGLVertexArrayObject m_vaoPhosphorComposite; ///< the quad with the texture program layout
+    bool phosphorReady = false;                      ///< FBO support present, quad and VAOs are set up
+    bool phosphorRestart = true;                     ///< clear the accumulator before the next use
+
+    // Scene cache: every full paint renders the scene (waterfall, traces, grid -
+    // everything except the cursors) into an offscreen framebuffer and composites
+    // it into the widget. A repaint caused only by a cursor move (tagged by
+    // updateCursor()) re-composites the cached scene and redraws just the markers,
+    // so dragging a cursor with the capture stopped no longer re-renders all
+    // channel graphs at mouse event rate. Untagged repaints (new block, settings
+    // change, expose, resize) rebuild the cache first.
+    std::unique_ptr< QOpenGLFramebufferObject > m_sceneFbo; ///< the cached scene, one texel per pixel
+    GLuint sceneRenderTarget = 0; ///< framebuffer the scene passes of this paint render into
+    bool sceneCacheValid = false; ///< m_sceneFbo holds the currently displayed scene
+    int overlayPaints = 0;        ///< pending repaints caused only by cursor moves
+    /// \brief Draw the cached scene framebuffer into the widget framebuffer.
+    void compositeSceneCache();
+
+    /// Painted frames of all normal views, see paintedFrames(). Process wide so the
+    /// diagnostics dock does not need a path into the private DsoWidget scope views.
+    static std::atomic< unsigned > paintedFramesCount;
 
     // OpenGL shader, matrix, var-locations
     static QString OpenGLversion;
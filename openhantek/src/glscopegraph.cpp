@@ -4,93 +4,128 @@
 #include <QDebug>
 #include <stdexcept>
 
-Graph::Graph() : buffer( QOpenGLBuffer::VertexBuffer ) {
-    buffer.create();
-    buffer.setUsagePattern( QOpenGLBuffer::DynamicDraw );
+Graph::Graph() {
+    for ( QOpenGLBuffer &buffer : buffers ) {
+        buffer.create();
+        buffer.setUsagePattern( QOpenGLBuffer::DynamicDraw );
+    }
 }
 
 void Graph::writeData( PPresult *data, QOpenGLShaderProgram *program, int vertexLocation ) {
     // Determine memory
     int neededMemory = 0;
     for ( ChannelGraph &cg : data->vaChannelVoltage )
-        neededMemory += int( cg.size() * sizeof( QVector3D ) );
+        neededMemory += int( cg.size() * sizeof( GraphVertex ) );
     for ( ChannelGraph &cg : data->vaChannelHistogram )
-        neededMemory += int( cg.size() * sizeof( QVector3D ) );
+        neededMemory += int( cg.size() * sizeof( GraphVertex ) );
     for ( ChannelGraph &cg : data->vaChannelSpectrum )
-        neededMemory += int( cg.size() * sizeof( QVector3D ) );
+        neededMemory += int( cg.size() * sizeof( GraphVertex ) );
+    for ( ChannelGraph &cg : data->vaChannelEnvelope )
+        neededMemory += int( cg.size() * sizeof( GraphVertex ) );
 
+    // Cycle to the next ring slot; the buffer written two or three frames ago is
+    // no longer referenced by a pending draw, and orphaning its storage below
+    // detaches even a late straggler instead of waiting for it
+    bufferIndex = ( bufferIndex + 1 ) % bufferCount;
+    QOpenGLBuffer &buffer = buffers[ bufferIndex ];
     buffer.bind();
     program->bind();
 
-    // Allocate space if necessary
-    if ( neededMemory > allocatedMem ) {
-        buffer.allocate( neededMemory );
-        allocatedMem = neededMemory;
-    }
+    // Orphan the old storage (glBufferData with no data) so the writes below
+    // never stall behind a draw that still reads the previous content
+    if ( neededMemory > allocatedMem[ bufferIndex ] )
+        allocatedMem[ bufferIndex ] = neededMemory;
+    buffer.allocate( allocatedMem[ bufferIndex ] );
 
     // Write data to buffer
     int offset = 0;
     vaoVoltage.resize( data->vaChannelVoltage.size() );
     vaoHistogram.resize( data->vaChannelHistogram.size() );
     vaoSpectrum.resize( data->vaChannelSpectrum.size() );
-    for ( ChannelID channel = 0; channel < std::max( std::max( vaoVoltage.size(), vaoHistogram.size() ), vaoSpectrum.size() );
+    vaoEnvelope.resize( data->vaChannelEnvelope.size() );
+    for ( ChannelID channel = 0;
+          channel < std::max( std::max( std::max( vaoVoltage.size(), vaoHistogram.size() ), vaoSpectrum.size() ),
+                              vaoEnvelope.size() );
           ++channel ) {
         int dataSize;
 
         // Voltage channel
         if ( channel < vaoVoltage.size() ) {
             VaoCount &v = vaoVoltage[ channel ];
-            if ( !v.first ) {
-                v.first = new QOpenGLVertexArrayObject;
-                if ( !v.first->create() )
+            if ( !v.vao ) {
+                v.vao = new QOpenGLVertexArrayObject;
+                if ( !v.vao->create() )
                     throw new std::runtime_error( "QOpenGLVertexArrayObject create failed" );
             }
             ChannelGraph &gVoltage = data->vaChannelVoltage[ channel ];
-            v.first->bind();
-            dataSize = int( gVoltage.size() * sizeof( QVector3D ) );
+            v.vao->bind();
+            dataSize = int( gVoltage.size() * sizeof( GraphVertex ) );
             buffer.write( offset, gVoltage.data(), dataSize );
             program->enableAttributeArray( vertexLocation );
-            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 3, 0 );
-            v.first->release();
-            v.second = int( gVoltage.size() );
+            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 2, 0 ); // x, y - the shader fills in z = 0
+            v.vao->release();
+            v.count = int( gVoltage.size() );
+            v.offset = offset;
             offset += dataSize;
         }
 
         // Histogram channel
         if ( channel < vaoHistogram.size() ) {
             VaoCount &h = vaoHistogram[ channel ];
-            if ( !h.first ) {
-                h.first = new QOpenGLVertexArrayObject;
-                if ( !h.first->create() )
+            if ( !h.vao ) {
+                h.vao = new QOpenGLVertexArrayObject;
+                if ( !h.vao->create() )
                     throw new std::runtime_error( "QOpenGLVertexArrayObject create failed" );
             }
             ChannelGraph &gHistogram = data->vaChannelHistogram[ channel ];
-            h.first->bind();
-            dataSize = int( gHistogram.size() * sizeof( QVector3D ) );
+            h.vao->bind();
+            dataSize = int( gHistogram.size() * sizeof( GraphVertex ) );
             buffer.write( offset, gHistogram.data(), dataSize );
             program->enableAttributeArray( vertexLocation );
-            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 3, 0 );
-            h.first->release();
-            h.second = int( gHistogram.size() );
+            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 2, 0 ); // x, y - the shader fills in z = 0
+            h.vao->release();
+            h.count = int( gHistogram.size() );
+            h.offset = offset;
             offset += dataSize;
         }
 
         // Spectrum channel
         if ( channel < vaoSpectrum.size() ) {
             VaoCount &s = vaoSpectrum[ channel ];
-            if ( !s.first ) {
-                s.first = new QOpenGLVertexArrayObject;
-                if ( !s.first->create() )
+            if ( !s.vao ) {
+                s.vao = new QOpenGLVertexArrayObject;
+                if ( !s.vao->create() )
                     throw new std::runtime_error( "QOpenGLVertexArrayObject create failed" );
             }
             ChannelGraph &gSpectrum = data->vaChannelSpectrum[ channel ];
-            s.first->bind();
-            dataSize = int( gSpectrum.size() * sizeof( QVector3D ) );
+            s.vao->bind();
+            dataSize = int( gSpectrum.size() * sizeof( GraphVertex ) );
             buffer.write( offset, gSpectrum.data(), dataSize );
             program->enableAttributeArray( vertexLocation );
-            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 3, 0 );
-            s.first->release();
-            s.second = int( gSpectrum.size() );
+            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 2, 0 ); // x, y - the shader fills in z = 0
+            s.vao->release();
+            s.count = int( gSpectrum.size() );
+            s.offset = offset;
+            offset += dataSize;
+        }
+
+        // Envelope band channel
+        if ( channel < vaoEnvelope.size() ) {
+            VaoCount &e = vaoEnvelope[ channel ];
+            if ( !e.vao ) {
+                e.vao = new QOpenGLVertexArrayObject;
+                if ( !e.vao->create() )
+                    throw new std::runtime_error( "QOpenGLVertexArrayObject create failed" );
+            }
+            ChannelGraph &gEnvelope = data->vaChannelEnvelope[ channel ];
+            e.vao->bind();
+            dataSize = int( gEnvelope.size() * sizeof( GraphVertex ) );
+            buffer.write( offset, gEnvelope.data(), dataSize );
+            program->enableAttributeArray( vertexLocation );
+            program->setAttributeBuffer( vertexLocation, GL_FLOAT, offset, 2, 0 ); // x, y - the shader fills in z = 0
+            e.vao->release();
+            e.count = int( gEnvelope.size() );
+            e.offset = offset;
             offset += dataSize;
         }
     }
@@ -99,19 +134,23 @@ void Graph::writeData( PPresult *data, QOpenGLShaderProgram *program, int vertex
 }
 
 Graph::~Graph() {
-    for ( auto &vao : vaoVoltage ) {
-        vao.first->destroy();
-        delete vao.first;
+    for ( auto &section : vaoVoltage ) {
+        section.vao->destroy();
+        delete section.vao;
     }
-    for ( auto &vao : vaoHistogram ) {
-        vao.first->destroy();
-        delete vao.first;
+    for ( auto &section : vaoHistogram ) {
+        section.vao->destroy();
+        delete section.vao;
     }
-    for ( auto &vao : vaoSpectrum ) {
-        vao.first->destroy();
-        delete vao.first;
+    for ( auto &section : vaoSpectrum ) {
+        section.vao->destroy();
+        delete section.vao;
     }
-    if ( buffer.isCreated() ) {
-        buffer.destroy();
+    for ( auto &section : vaoEnvelope ) {
+        section.vao->destroy();
+        delete section.vao;
     }
+    for ( QOpenGLBuffer &buffer : buffers )
+        if ( buffer.isCreated() )
+            buffer.destroy();
 }
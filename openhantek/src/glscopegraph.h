@@ -19,12 +19,26 @@ struct Graph {
     Graph( const Graph && ) = delete;
     ~Graph();
     void writeData( PPresult *data, QOpenGLShaderProgram *program, int vertexLocation );
-    typedef std::pair< QOpenGLVertexArrayObject *, GLsizei > VaoCount;
+    /// One drawable section of the frame's vertex buffer: the VAO that captures the
+    /// attribute setup for the owning context, the vertex count and the byte offset
+    /// into the buffer. The offset lets a sharing context (the zoomed view) draw the
+    /// section directly from the buffer - VAOs are not shareable between contexts.
+    struct VaoCount {
+        QOpenGLVertexArrayObject *vao = nullptr;
+        GLsizei count = 0;
+        int offset = 0;
+    };
 
   public:
-    int allocatedMem = 0;
-    QOpenGLBuffer buffer;
+    /// Ring of vertex buffers, cycled on every writeData() call. Rewriting the
+    /// buffer the driver still reads for the previous frame's draw forces an
+    /// implicit CPU/GPU sync; cycling plus orphaning the storage avoids it.
+    static const unsigned bufferCount = 3;
+    unsigned bufferIndex = 0;                 ///< The ring slot written last
+    QOpenGLBuffer buffers[ bufferCount ];     ///< One VBO per ring slot
+    int allocatedMem[ bufferCount ] = { 0 };  ///< Allocated size per ring slot
     std::vector< VaoCount > vaoVoltage;
     std::vector< VaoCount > vaoHistogram;
     std::vector< VaoCount > vaoSpectrum;
+    std::vector< VaoCount > vaoEnvelope;
 };
@@ -4,8 +4,16 @@
 
 #include "capturing.h"
 #include "usb/scopedevice.h"
+#include "utils/dsotrace.h"
+#include "utils/frametrace.h"
 #include <QDebug>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 
 CapturingThread::CapturingThread( HantekDsoControl *hdc ) : hdc( hdc ) {
@@ -26,18 +34,77 @@ void CapturingThread::run() {
             return;                  // stop this thread
         }
         if ( hdc->scope ) { // device is initialized
+            if ( !placementDone ) { // the scope settings are available now
+                placementDone = true;
+                applyPlacement();
+            }
             if ( hdc->samplingUI ) {
                 capture();
-                // add user defined hold-off time to lower CPU load
-                QThread::msleep( unsigned( 1000 * hdc->scope->horizontal.acquireInterval ) );
+                // add user defined hold-off time to lower CPU load, but keep draining a
+                // streaming ADC to avoid FIFO overflow and capture gaps; a queued control
+                // command or a stop request ends the hold-off early
+                if ( !adcRunning || !hdc->samplingStarted )
+                    hdc->holdOffCapturing( unsigned( 1000 * hdc->scope->horizontal.acquireInterval ) );
             } else {
-                QThread::msleep( unsigned( hdc->displayInterval ) ); // run slowly
+                hdc->idleCapturing(); // sleep without periodic wakeups until sampling restarts
             }
         }
     }
 }
 
 
+/// \brief Pin this thread to the configured CPU core, raise it to SCHED_FIFO and
+/// place the capture buffer pool next to the pinned core.
+/// The USB bulk transfers and the libusb event handling run synchronously in this
+/// thread (getRealSamples()), so pinning keeps the complete stream path in the caches
+/// of one (ideally isolated) core; the realtime priority protects the capture from
+/// preemption by background load that otherwise causes USB overruns.
+void CapturingThread::applyPlacement() {
+#ifdef Q_OS_LINUX
+    const int core = hdc->scope->captureCpuCore;
+    if ( core >= 0 && core < QThread::idealThreadCount() ) {
+        cpu_set_t cpuSet;
+        CPU_ZERO( &cpuSet );
+        CPU_SET( core, &cpuSet );
+        if ( pthread_setaffinity_np( pthread_self(), sizeof cpuSet, &cpuSet ) )
+            qWarning() << "CapturingThread: pinning to CPU core" << core << "failed";
+        else if ( hdc->verboseLevel > 1 )
+            qDebug() << " CapturingThread: pinned to CPU core" << core;
+    }
+    if ( hdc->scope->captureRealTime ) {
+        // this works only if the user has realtime rights, see the comment in main()
+        struct sched_param schedParam;
+        schedParam.sched_priority = 10; // one level above the process wide setting
+        if ( pthread_setschedparam( pthread_self(), SCHED_FIFO, &schedParam ) )
+            qWarning() << "CapturingThread: switching to SCHED_FIFO failed, no realtime rights?";
+        else if ( hdc->verboseLevel > 1 )
+            qDebug() << " CapturingThread: running with realtime priority";
+    }
+    hdc->captureCpuSeen = sched_getcpu(); // effective placement, shown in the pipeline health overlay
+#endif
+    // Pre-fault the capture pool from this (now pinned) thread: with the kernel's
+    // first-touch policy the pages land on the memory node of the capture core instead
+    // of wherever the GUI thread ran during construction, so the stream path never
+    // reads across a cluster/socket boundary and the first live block does not pay
+    // the page fault storm. A deeper record length selected later grows the slots
+    // lazily, again from this thread. The converted result buffers need no treatment,
+    // they are first written by the processing thread that also reads them.
+    const size_t prefault = size_t( hdc->getRecordLength() ) * hdc->specification->channels;
+    for ( auto &slot : pool )
+        slot.resize( prefault, 0x80 );
+}
+
+
+/// \brief Monotonic clock in ns, taken at USB block completion. The timestamps
+/// correlate blocks with external events and feed the samplerate drift fit of
+/// HantekDsoControl, so they must come from a clock that never steps backwards.
+static uint64_t monotonicNs() {
+    return uint64_t(
+        std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() )
+            .count() );
+}
+
+
 static double id2sr( uint8_t timediv ) {
     if ( timediv < 100 ) {   // 1, 2, ..., 48 MS/s
         if ( 11 == timediv ) // fix brain dead coding of sigrok DDS120 FW
@@ -49,19 +116,41 @@ static double id2sr( uint8_t timediv ) {
 
 
 void CapturingThread::xferSamples() {
-    QWriteLocker locker( &hdc->raw.lock );
-    if ( !freeRun )
-        swap( data, hdc->raw.data );
-    hdc->raw.channels = channels;
-    hdc->raw.samplerate = samplerate;
-    hdc->raw.oversampling = oversampling;
-    hdc->raw.gainValue[ 0 ] = gainValue[ 0 ];
-    hdc->raw.gainValue[ 1 ] = gainValue[ 1 ];
-    hdc->raw.gainIndex[ 0 ] = gainIndex[ 0 ];
-    hdc->raw.gainIndex[ 1 ] = gainIndex[ 1 ];
-    hdc->raw.freeRun = freeRun;
-    hdc->raw.valid = valid;
-    hdc->raw.tag = tag;
+    size_t rawCapacity = 0;
+    {
+        QWriteLocker locker( &hdc->raw.lock );
+        if ( !freeRun && !progressive ) { // in place modes already captured into raw.data
+            swap( pool[ poolIndex ], hdc->raw.data );
+            poolIndex = ( poolIndex + 1 ) % poolSlots; // capture the next block into another pre-allocated slot
+        }
+        hdc->raw.channels = channels;
+        hdc->raw.samplerate = samplerate;
+        hdc->raw.oversampling = oversampling;
+        hdc->raw.gainValue[ 0 ] = gainValue[ 0 ];
+        hdc->raw.gainValue[ 1 ] = gainValue[ 1 ];
+        hdc->raw.gainIndex[ 0 ] = gainIndex[ 0 ];
+        hdc->raw.gainIndex[ 1 ] = gainIndex[ 1 ];
+        hdc->raw.freeRun = freeRun;
+        hdc->raw.valid = valid;
+        hdc->raw.tag = tag;
+        hdc->raw.timestampNs = timestamp; // completion time of the block carrying this tag
+        hdc->raw.partial = partial;
+        if ( partial )                 // announcing the still empty block of a progressive capture:
+            hdc->raw.received = 0;     // a conversion tick must not show the stale previous content
+        if ( !partial && !hdc->recordFileName.isEmpty() ) // dump the published block, see --recordStream;
+            recordBlock();                                // under the lock, the conversion may swap raw.data
+        rawCapacity = hdc->raw.data.capacity();           // the published block, read under the lock
+    }
+    if ( !partial ) { // the progress announcement is not a captured block
+        FrameTrace::record( "capture", tag );
+        // per block memory telemetry of the raw side: the pool slots plus the
+        // published block; after warmup this stays a flat line, see FrameTrace::counter()
+        size_t captureBytes = rawCapacity;
+        for ( const auto &slot : pool )
+            captureBytes += slot.capacity();
+        FrameTrace::counter( "mem.capture", captureBytes );
+    }
+    hdc->wakeProcessing(); // process the block now, don't wait for a timer tick
 }
 
 
@@ -69,8 +158,11 @@ void CapturingThread::capture() {
     if ( !hdc->samplingStarted )
         return;
     int errorCode;
-    // Send all pending control commands
-    ControlCommand *controlCommand = hdc->firstControlCommand;
+    // Send all pending control commands, normally handed over by the lock-free SPSC queue.
+    // After a queue overflow or a failed send walk the complete command list instead.
+    const bool walkList = hdc->commandQueue.rescanNeeded();
+    ControlCommand *controlCommand = walkList ? hdc->firstControlCommand : hdc->commandQueue.pop();
+    bool sentCommand = false;
     while ( controlCommand ) {
         if ( controlCommand->pending ) {
             switch ( int( controlCommand->code ) ) {
@@ -98,13 +190,15 @@ void CapturingThread::capture() {
                 effectiveSamplerate = hdc->specification->fixedSampleRates[ sampleIndex ].samplerate;
                 if ( !realSlow && effectiveSamplerate < 10e3 &&
                      hdc->scope->trigger.mode == Dso::TriggerMode::ROLL ) { // switch to real slow rolling
-                    for ( auto it = data.begin(); it != data.end(); ) {
+                    std::vector< unsigned char > &slot = pool[ poolIndex ];
+                    for ( auto it = slot.begin(); it != slot.end(); ) {
                         *it++ = hdc->channelOffset[ 0 ]; // fill ch0 with "zeros"
                         *it++ = hdc->channelOffset[ 1 ]; // fill ch1 with "zeros"
                     }
                     QWriteLocker locker( &hdc->raw.lock );
                     hdc->raw.rollMode = false;
-                    swap( data, hdc->raw.data ); // "clear screen"
+                    swap( slot, hdc->raw.data ); // "clear screen"
+                    poolIndex = ( poolIndex + 1 ) % poolSlots;
                 }
                 realSlow = effectiveSamplerate < 10e3;
                 if ( realSlow ) {        // roll mode possible?
@@ -123,40 +217,78 @@ void CapturingThread::capture() {
                                 .arg( QString::number( controlCommand->code, 16 ), name,
                                       hexdecDump( controlCommand->data(), unsigned( controlCommand->size() ) ) ) );
             if ( hdc->scopeDevice->isRealHW() ) { // do the USB communication with scope HW
-                errorCode = hdc->scopeDevice->controlWrite( controlCommand );
-                if ( errorCode < 0 ) {
-                    qWarning( "Sending control command %2x failed: %s", uint8_t( controlCommand->code ),
-                              libUsbErrorString( errorCode ).toLocal8Bit().data() );
+                if ( controlCommand->lastSent == static_cast< const std::vector< uint8_t > & >( *controlCommand ) ) {
+                    // the device already has this state, skip the synchronous USB
+                    // round trip and don't force an ADC restart for it
+                    controlCommand->pending = false;
+                } else {
+                    errorCode = hdc->scopeDevice->controlWrite( controlCommand );
+                    if ( errorCode < 0 ) {
+                        qWarning( "Sending control command %2x failed: %s", uint8_t( controlCommand->code ),
+                                  libUsbErrorString( errorCode ).toLocal8Bit().data() );
+                        hdc->commandQueue.requestRescan(); // command stays pending, retry from the list
 
-                    if ( errorCode == LIBUSB_ERROR_NO_DEVICE ) {
-                        return;
+                        if ( errorCode == LIBUSB_ERROR_NO_DEVICE ) {
+                            return;
+                        }
+                    } else {
+                        controlCommand->lastSent = *controlCommand; // remember the device state for the dedup
+                        controlCommand->pending = false;
+                        sentCommand = true;
                     }
-                } else {
-                    controlCommand->pending = false;
                 }
             } else {
                 controlCommand->pending = false;
             }
         }
-        controlCommand = controlCommand->next;
+        controlCommand = walkList ? controlCommand->next : hdc->commandQueue.pop();
+    }
+    if ( sentCommand )       // device setup has changed ..
+        adcRunning = false; // .. restart the ADC for a clean channel sync
+    if ( hdc->scopeDevice->isReplayDevice() ) { // serve recorded blocks instead of capturing;
+        replayBlock();                          // the device settings consumed above are ignored,
+        return;                                 // the recording brings its own metadata
     }
     valid = true;
     freeRun = hdc->triggerModeNONE() && realSlow;
-    // sample step by step into the target if rollMode, else buffer and switch one big block
-    dp = freeRun ? &hdc->raw.data : &data;
     rawSamplesize = hdc->grossSampleCount( hdc->getSamplesize() * oversampling ) * channels;
-    dp->resize( rawSamplesize, 0x80 );
+    // Slow captures (blocks that take longer than half a second to fill) publish their
+    // progress: sample in place into raw.data like roll mode and announce the partially
+    // filled block, the periodic processing ticks then show the trace growing on screen
+    // instead of a frozen display until xferSamples() swaps the complete block. Live
+    // calibration needs complete blocks and keeps the classic one-shot delivery.
+    progressive = !freeRun && samplerate > 0 && !hdc->scope->liveCalibrationActive &&
+                  double( rawSamplesize ) / channels / samplerate > 0.5;
+    // sample step by step into the target if rollMode or progressive, else capture into a pool slot and swap one big block
+    dp = ( freeRun || progressive ) ? &hdc->raw.data : &pool[ poolIndex ];
+    if ( freeRun || progressive ) { // the conversion may swap raw.data around, sync the resize
+        QWriteLocker locker( &hdc->raw.lock );
+        dp->resize( rawSamplesize, 0x80 );
+    } else {
+        dp->resize( rawSamplesize, 0x80 );
+    }
     if ( tag && freeRun ) // in free run mode transfer settings immediately
         xferSamples();
     if ( 0 == ++tag )
         ++tag; // skip tag==0
+    if ( progressive ) { // announce the empty block, it fills under the eyes of the user
+        partial = true;
+        xferSamples();
+    }
     if ( hdc->scopeDevice->isRealHW() ) {
         received = getRealSamples();
     } else {
         received = getDemoSamples();
     }
+    partial = false; // from here on the block is complete (or replaced by "zeros" below)
     if ( received != rawSamplesize ) {
         // qDebug() << "retval != rawSamplesize" << received << rawSamplesize;
+        if ( hdc->scopeDevice->isRealHW() ) { // count the data loss, see HantekDsoControl::pipelineHealth()
+            if ( received )
+                ++hdc->shortReadCount; // USB delivered only a part of the requested block
+            ++hdc->zeroFilledCount;    // the block is replaced by "zero" samples below
+        }
+        adcRunning = false; // short block, re-arm the ADC to resync the channel interleave
         auto end = dp->end();
         for ( auto it = dp->begin(); it != end; ) {
             *it++ = hdc->channelOffset[ 0 ]; // fill ch0 with "zeros"
@@ -174,85 +306,236 @@ void CapturingThread::capture() {
 
 unsigned CapturingThread::getRealSamples() {
     int errorCode;
-    errorCode = hdc->scopeDevice->controlWrite( hdc->getCommand( ControlCode::CONTROL_STARTSAMPLING ) );
-    if ( errorCode < 0 ) {
-        qWarning() << "controlWrite: Getting sample data failed: " << libUsbErrorString( errorCode );
-        dp->clear();
-        return 0;
+    // The FX2 streams continuously once started; re-arm it only after a settings
+    // change or an incomplete block, otherwise drain the stream without dead time
+    // between consecutive frames so no glitch is lost in a capture gap.
+    if ( !adcRunning ) {
+        errorCode = hdc->scopeDevice->controlWrite( hdc->getCommand( ControlCode::CONTROL_STARTSAMPLING ) );
+        if ( errorCode < 0 ) {
+            qWarning() << "controlWrite: Getting sample data failed: " << libUsbErrorString( errorCode );
+            dp->clear();
+            return 0;
+        }
+        adcRunning = true;
     }
     // Save raw data to temporary buffer
     // timestampDebug( QString( "Request packet %1: %2 bytes" ).arg( tag ).arg( rawSamplesize ) );
     hdc->raw.received = 0;
     int retval = hdc->scopeDevice->bulkReadMulti( dp->data(), rawSamplesize, realSlow, hdc->raw.received );
     if ( retval < 0 ) {
+        adcRunning = false;
         if ( retval == LIBUSB_ERROR_NO_DEVICE )
             hdc->scopeDevice->disconnectFromDevice();
         qWarning() << "bulkReadMulti: Getting sample data failed: " << libUsbErrorString( retval );
         dp->clear();
         return 0;
     }
+    timestamp = monotonicNs(); // the block is complete in memory from now on
     // timestampDebug( QString( "Received packet %1: %2 bytes" ).arg( tag ).arg( retval ) );
     return unsigned( retval );
 }
 
 
-unsigned CapturingThread::getDemoSamples() {
-    const uint8_t binaryOffset = 0x80; // ADC format: binary offset
-    const int8_t V_zero = 0;           // ADC = 0V
-    const int8_t V_plus_1 = 25;        // ADC = 1V
-    const int8_t V_plus_2 = 50;        // ADC = 2V
-    const int8_t V_minus_1 = -25;      // ADC = -1V
-    const int8_t V_minus_2 = -50;      // ADC = -2V
+/// \brief Precompute one interleaved period of the demo signal as final raw ADC bytes.
+/// The table already contains gain, binary offset and clipping, so getDemoSamples()
+/// serves a block with a few memcpy calls instead of deriving every single sample.
+void CapturingThread::buildDemoTable( bool couplingAC2 ) {
+    const int binaryOffset = 0x80; // ADC format: binary offset
+    demoSamplerate = samplerate;
+    demoChannels = channels;
+    demoGain[ 0 ] = gainValue[ 0 ];
+    demoGain[ 1 ] = gainValue[ 1 ];
+    demoCouplingAC2 = couplingAC2;
+    demoPhase = 0;
+    const double frequency = qBound( 1.0, hdc->demoFrequency, samplerate / 2 );
+    const size_t len1 = size_t( qBound( 2.0, round( samplerate / frequency ), 1048576.0 ) );
+    const size_t len2 = 2 * len1; // CH2 runs at half the CH1 frequency
     const int gain1 = int( gainValue[ 0 ] );
     const int gain2 = int( gainValue[ 1 ] );
-    static int ch1 = 0;
-    static int ch2 = 0;
-    static int counter = 0;
-    unsigned received = 0;
+    // CH1: one period of the selected shape, 50 ADC steps = 2 V amplitude
+    std::vector< int > period1( len1 );
+    for ( size_t i = 0; i < len1; ++i ) {
+        double t = double( i ) / double( len1 ); // phase 0 .. 1
+        switch ( hdc->demoShape ) {
+        case HantekDsoControl::DemoShape::Sine:
+            period1[ i ] = int( lround( 50 * sin( 2 * M_PI * t ) ) );
+            break;
+        case HantekDsoControl::DemoShape::Square:
+            period1[ i ] = t < 0.5 ? 50 : -50; // -2V <-> +2V
+            break;
+        case HantekDsoControl::DemoShape::Noise:
+            noiseState ^= noiseState << 13; // xorshift32, the pattern repeats with the table
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            period1[ i ] = int( noiseState % 101 ) - 50;
+            break;
+        case HantekDsoControl::DemoShape::Ramp:
+            period1[ i ] = int( lround( 50 - 100 * t ) ); // falling ramp +2V .. -2V
+            break;
+        }
+    }
+    if ( 2 == channels ) { // interleave one common period of both channels
+        demoTable.resize( 2 * len2 );
+        for ( size_t i = 0; i < len2; ++i ) {
+            // CH2: square wave, -1V <-> +1V for AC coupling, 0V <-> +2V else
+            int ch2 = couplingAC2 ? ( i < len1 ? 25 : -25 ) : ( i < len1 ? 50 : 0 );
+            demoTable[ 2 * i ] = uint8_t( qBound( 0, period1[ i % len1 ] * gain1 + binaryOffset, 0xFF ) ); // clip to 8bit
+            demoTable[ 2 * i + 1 ] = uint8_t( qBound( 0, ch2 * gain2 + binaryOffset, 0xFF ) );             // clip ..
+        }
+    } else {
+        demoTable.resize( len1 );
+        for ( size_t i = 0; i < len1; ++i )
+            demoTable[ i ] = uint8_t( qBound( 0, period1[ i ] * gain1 + binaryOffset, 0xFF ) ); // clip to 8bit
+    }
+    traceCapture( hdc->verboseLevel > 3, "   CT::buildDemoTable()" << frequency << "Hz," << demoTable.size() << "bytes" );
+}
+
+
+unsigned CapturingThread::getDemoSamples() {
+    // The waveform comes from a precomputed period table (see buildDemoTable()), so a
+    // block costs a handful of memcpy calls plus the stream pacing sleep; the former
+    // per sample synthesis made the demo source the pipeline bottleneck at high rates.
+    bool couplingAC2 = hdc->scope->coupling( 1, hdc->specification ) == Dso::Coupling::AC;
+    if ( demoTable.empty() || samplerate != demoSamplerate || channels != demoChannels || gainValue[ 0 ] != demoGain[ 0 ] ||
+         gainValue[ 1 ] != demoGain[ 1 ] || couplingAC2 != demoCouplingAC2 )
+        buildDemoTable( couplingAC2 );
     hdc->raw.received = 0;
     // timestampDebug( QString( "Request dummy packet %1: %2 bytes" ).arg( tag ).arg( rawSamplesize ) );
-    int deltaT = 99;
-    // deltaT (=99) defines the frequency of the dummy signals:
-    // ch1 = 1 kHz and ch2 = 500 Hz
-    // uncomment the next two lines to disable sample slowdown for low sample rates
-    // if ( samplerate < 10e6 )
-    //    deltaT = int( round( deltaT * samplerate / 10e6 ) );
-    // adapt demo samples for high sample rates >10 MS/s
-    if ( samplerate > 10e6 )
-        deltaT = int( round( deltaT * samplerate / 10e6 ) );
     const unsigned packetLength = 512 * 78; // 50 blocks for one screen width of 20000
-    unsigned block = 0;
-    dp->resize( rawSamplesize, binaryOffset );
-    auto end = dp->end();
-    unsigned packet = 0;
-    // bool couplingAC1 = hdc->scope->coupling( 0, hdc->specification ) == Dso::Coupling::AC; // not yet used
-    bool couplingAC2 = hdc->scope->coupling( 1, hdc->specification ) == Dso::Coupling::AC;
-    for ( auto it = dp->begin(); it != end; ++it ) {
-        if ( ++counter >= deltaT ) {
-            counter = 0;
-            if ( --ch1 < V_minus_2 ) {
-                ch1 = V_plus_2;
-                if ( couplingAC2 )
-                    ch2 = ch2 <= V_zero ? V_plus_1 : V_minus_1; // -1V <-> +1V
-                else
-                    ch2 = ch2 <= V_plus_1 ? V_plus_2 : V_zero; // 0V <-> 2V
-            }
+    const size_t tableBytes = demoTable.size();
+    uint8_t *out = dp->data(); // dp was already sized to rawSamplesize by capture()
+    unsigned received = 0;
+    while ( received < rawSamplesize ) {
+        unsigned packet = qMin( packetLength, rawSamplesize - received );
+        unsigned todo = packet;
+        while ( todo ) { // copy with phase wrap around, the signal is continuous over block borders
+            size_t chunk = qMin( size_t( todo ), tableBytes - demoPhase );
+            memcpy( out, demoTable.data() + demoPhase, chunk );
+            out += chunk;
+            todo -= unsigned( chunk );
+            demoPhase = ( demoPhase + chunk ) % tableBytes;
+        }
+        received += packet;
+        hdc->raw.received = received;
+        // pace the delivery like the streaming ADC of the real scope
+        QThread::usleep( unsigned( 1e6 * packet / channels / samplerate ) );
+        if ( !hdc->capturing || hdc->scopeDevice->hasStopped() )
+            break;
+    }
+    timestamp = monotonicNs(); // the block is complete in memory from now on
+    // timestampDebug( QString( "Received dummy packet %1: %2 bytes" ).arg( tag ).arg( received ) );
+    return received;
+}
+
+
+// Raw stream file format (options --recordStream / --replayStream): a QDataStream
+// (version Qt_5_4) starting with magic and format version, followed by one record
+// per published block: tag, completion time (monotonic ns), channels, samplerate,
+// oversampling, gain values and indices, the freeRun / valid / rollMode flags, the
+// fill level and the raw ADC bytes with a length prefix.
+static const quint32 rawStreamMagic = 0x4F485253; // "OHRS"
+static const quint32 rawStreamVersion = 1;
+static const qint64 rawStreamHeaderSize = 2 * qint64( sizeof( quint32 ) );
+
+
+/// \brief Append the just published block to the raw stream recording; called from
+/// xferSamples() under the raw data lock, so the bytes cannot be swapped away.
+void CapturingThread::recordBlock() {
+    if ( recordFailed )
+        return;
+    if ( !recordFile.isOpen() ) {
+        recordFile.setFileName( hdc->recordFileName );
+        if ( !recordFile.open( QIODevice::WriteOnly ) ) {
+            qWarning() << "CapturingThread: cannot record the raw stream to" << hdc->recordFileName;
+            recordFailed = true;
+            return;
         }
-        *it = uint8_t( qBound( 0, ch1 * gain1 + binaryOffset, 0xFF ) ); // clip if outside 8bit range
-        ++received;
-        if ( 2 == channels ) {
-            *++it = uint8_t( qBound( 0, ch2 * gain2 + binaryOffset, 0xFF ) ); // clip ..
-            ++received;
+        recordStream.setDevice( &recordFile );
+        recordStream.setVersion( QDataStream::Qt_5_4 );
+        recordStream << rawStreamMagic << rawStreamVersion;
+        if ( hdc->verboseLevel > 1 )
+            qDebug() << " CapturingThread: recording the raw stream to" << hdc->recordFileName;
+    }
+    recordStream << quint32( tag ) << quint64( timestamp ) << quint32( channels ) << samplerate << quint32( oversampling )
+                 << quint32( gainValue[ 0 ] ) << quint32( gainValue[ 1 ] ) << quint32( gainIndex[ 0 ] )
+                 << quint32( gainIndex[ 1 ] ) << quint8( freeRun ) << quint8( valid ) << quint8( hdc->raw.rollMode )
+                 << quint32( hdc->raw.received ) << quint32( hdc->raw.data.size() );
+    recordStream.writeRawData( reinterpret_cast< const char * >( hdc->raw.data.data() ), int( hdc->raw.data.size() ) );
+    if ( recordStream.status() != QDataStream::Ok ) {
+        qWarning() << "CapturingThread: recording the raw stream failed, disk full?";
+        recordFailed = true;
+    }
+}
+
+
+/// \brief Serve the next block of a recorded raw stream: restore its metadata, pace
+/// it like the original capture (scaled by the replay speed multiplier) and publish
+/// it through xferSamples(), so the unchanged pipeline processes bit identical input
+/// on every run. The recording loops at its end for open ended stress tests.
+void CapturingThread::replayBlock() {
+    if ( !replayFile.isOpen() ) {
+        replayFile.setFileName( hdc->scopeDevice->replayFileName() );
+        quint32 magic = 0, version = 0;
+        if ( replayFile.open( QIODevice::ReadOnly ) ) {
+            replayStream.setDevice( &replayFile );
+            replayStream.setVersion( QDataStream::Qt_5_4 );
+            replayStream >> magic >> version;
         }
-        if ( ( block += channels ) >= packetLength ) {
-            ++packet;
-            block = 0;
-            hdc->raw.received = received;
-            QThread::usleep( unsigned( 1e6 * packetLength / channels / samplerate ) );
-            if ( !hdc->capturing || hdc->scopeDevice->hasStopped() )
-                break;
+        if ( magic != rawStreamMagic || version != rawStreamVersion ) {
+            qWarning() << "CapturingThread: not a raw stream recording:" << replayFile.fileName();
+            hdc->capturing = false; // stop capture and processing, see run()
+            return;
         }
+        if ( hdc->verboseLevel > 1 )
+            qDebug() << " CapturingThread: replaying the raw stream from" << replayFile.fileName() << "at"
+                     << hdc->scopeDevice->replaySpeedFactor() << "x speed";
     }
-    // timestampDebug( QString( "Received dummy packet %1: %2 bytes" ).arg( packet ).arg( rawSamplesize ) );
-    return received;
+    if ( replayStream.atEnd() ) { // loop the recording, the pipeline keeps running
+        replayFile.seek( rawStreamHeaderSize );
+        replayLastNs = 0;
+    }
+    quint32 blockTag, blockChannels, blockOversampling, blockGain[ 2 ], blockIndex[ 2 ], blockReceived, blockSize;
+    quint64 blockNs;
+    quint8 blockFreeRun, blockValid, blockRollMode;
+    double blockSamplerate;
+    replayStream >> blockTag >> blockNs >> blockChannels >> blockSamplerate >> blockOversampling >> blockGain[ 0 ] >>
+        blockGain[ 1 ] >> blockIndex[ 0 ] >> blockIndex[ 1 ] >> blockFreeRun >> blockValid >> blockRollMode >>
+        blockReceived >> blockSize;
+    if ( replayStream.status() != QDataStream::Ok || 0 == blockSize ) {
+        qWarning() << "CapturingThread: damaged raw stream recording:" << replayFile.fileName();
+        hdc->capturing = false;
+        return;
+    }
+    channels = blockChannels;
+    samplerate = blockSamplerate;
+    oversampling = blockOversampling;
+    gainValue[ 0 ] = blockGain[ 0 ];
+    gainValue[ 1 ] = blockGain[ 1 ];
+    gainIndex[ 0 ] = blockIndex[ 0 ];
+    gainIndex[ 1 ] = blockIndex[ 1 ];
+    freeRun = blockFreeRun;
+    valid = blockValid;
+    partial = false;
+    progressive = false;
+    rawSamplesize = blockSize;
+    // Pace like the original stream: sleep the recorded block distance scaled by the
+    // speed multiplier, capped so a gap in the recording cannot stall the shutdown.
+    const double speed = hdc->scopeDevice->replaySpeedFactor();
+    if ( speed > 0 && replayLastNs && blockNs > replayLastNs )
+        QThread::usleep( unsigned( qMin( 1e6, double( blockNs - replayLastNs ) / 1000.0 / speed ) ) );
+    replayLastNs = blockNs;
+    dp = freeRun ? &hdc->raw.data : &pool[ poolIndex ]; // same split as capture()
+    {
+        QWriteLocker locker( &hdc->raw.lock ); // only needed for the in place free run target
+        dp->resize( blockSize );
+        replayStream.readRawData( reinterpret_cast< char * >( dp->data() ), int( blockSize ) );
+        hdc->raw.received = blockReceived; // the roll conversion locates the write head here
+    }
+    if ( 0 == ++tag ) // own monotonic tags, the recorded ones restart when the file loops
+        ++tag;
+    received = blockSize;
+    hdc->raw.rollMode = blockRollMode;
+    timestamp = monotonicNs(); // replay delivery time, keeps the drift fit clock monotonic
+    adcRunning = true;         // suppress the capture hold off, the recording paces itself
+    xferSamples();
 }
@@ -3,24 +3,35 @@
 #pragma once
 
 #include "hantekdsocontrol.h"
+#include <QDataStream>
+#include <QFile>
 
 class CapturingThread : public QThread {
     Q_OBJECT
 
   public:
     CapturingThread( HantekDsoControl *hdc );
-    void quitCapturing() { hdc->capturing = false; }
+    void quitCapturing() {
+        hdc->capturing = false;
+        hdc->wakeCapturing();
+    }
 
   private:
     void run() override;
     void capture();
     unsigned getRealSamples();
     unsigned getDemoSamples();
+    DSO_COLD void buildDemoTable( bool couplingAC2 );
+    void recordBlock();
+    void replayBlock();
+    DSO_COLD void applyPlacement();
     void xferSamples();
+    bool placementDone = false; ///< CPU core and priority were applied once at sampling start
     HantekDsoControl *hdc;
     unsigned channels = 0;
     double effectiveSamplerate = 0;
     bool realSlow = false;
+    bool adcRunning = false; ///< FX2 is streaming gapless, no per-block restart needed
     double samplerate = 0;
     unsigned oversampling = 0;
     unsigned rawSamplesize = 0;
@@ -28,8 +39,34 @@ class CapturingThread : public QThread {
     unsigned gainValue[ 2 ] = { 0, 0 }; // 1,2,5,10,..
     unsigned gainIndex[ 2 ] = { 0, 0 }; // index 0..7
     unsigned tag = 0;
+    uint64_t timestamp = 0; ///< monotonic ns of the last USB block completion
     bool valid = true;
     bool freeRun = false;
-    std::vector< unsigned char > data;
-    std::vector< unsigned char > *dp = &data;
+    bool progressive = false; ///< slow block is captured in place, its progress is published
+    bool partial = false;     ///< the in place capture is still running, data valid up to received
+    // Rotating pool of pre-allocated raw buffers, handed to HantekDsoControl by pointer swap.
+    // With three slots the capture of block N+1 never waits for the conversion of block N.
+    static const unsigned poolSlots = 3;
+    std::vector< unsigned char > pool[ poolSlots ];
+    unsigned poolIndex = 0;
+    std::vector< unsigned char > *dp = &pool[ 0 ];
+    // Demo device signal generator: one precomputed interleaved signal period as
+    // final raw ADC bytes, served by getDemoSamples() with a wrapping phase index.
+    std::vector< uint8_t > demoTable; ///< one common period of all active channels
+    size_t demoPhase = 0;             ///< byte position in demoTable, keeps the phase between blocks
+    double demoSamplerate = 0;        ///< table was built for this samplerate ..
+    unsigned demoChannels = 0;        ///< .. this channel count ..
+    unsigned demoGain[ 2 ] = { 0, 0 }; ///< .. these gain values ..
+    bool demoCouplingAC2 = false;      ///< .. and this CH2 coupling
+    uint32_t noiseState = 0x6022A5A5;  ///< xorshift32 state for the noise shape
+    // Raw stream recorder and replay (options --recordStream / --replayStream): every
+    // published block goes verbatim to disk resp. comes verbatim from a recording, so
+    // the unchanged pipeline can be re-fed with bit identical input for reproducible
+    // before/after measurements, also faster than realtime for stress testing.
+    QFile recordFile;          ///< sink of the raw stream recorder
+    QDataStream recordStream;  ///< writes block metadata + raw bytes
+    bool recordFailed = false; ///< open or write failed, logged once, don't retry
+    QFile replayFile;          ///< source of the replayed raw stream
+    QDataStream replayStream;  ///< reads block metadata + raw bytes
+    uint64_t replayLastNs = 0; ///< recorded completion time of the previous block
 };
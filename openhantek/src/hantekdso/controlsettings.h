@@ -38,6 +38,10 @@ struct ControlSettingsTrigger {
     Dso::Slope slope = Dso::Slope::Positive;        ///< The trigger slope
     int source = 0;                                 ///< The trigger source
     int smooth = 0;                                 ///< Don't trigger on glitches
+    Dso::TriggerQualify qualify = Dso::TriggerQualify::Edge; ///< Pulse width qualification of the edge
+    double pulseWidthMin = 1e-6;                    ///< Lower pulse width limit in s
+    double pulseWidthMax = 1e-3;                    ///< Upper pulse width limit in s
+    double holdoff = 0.0;                           ///< Minimum time between two triggers in s (0 = off)
 };
 
 /// \brief Stores the current amplification settings of the device.
@@ -51,18 +55,24 @@ struct ControlSettingsVoltage {
 };
 
 /// \brief Stores the current settings of the device.
+/// The setting groups are cache line aligned: the GUI setters write one group on the
+/// control thread while the processing thread reads another for every converted block
+/// (the conversion reads voltage, the trigger search reads trigger). Without the
+/// alignment a slider drag writing e.g. the trigger position bounces the cache line
+/// that also holds the per block voltage reads between the cores - measurable as
+/// cross cluster traffic on big.LITTLE parts.
 struct ControlSettings {
     ControlSettings( const ControlSamplerateLimits *limits, size_t channelCount );
     ~ControlSettings();
     ControlSettings( const ControlSettings & ) = delete;
     ControlSettings operator=( const ControlSettings & ) = delete;
-    ControlSettingsSamplerate samplerate;          ///< The samplerate settings
-    std::vector< ControlSettingsVoltage > voltage; ///< The amplification settings
-    ControlSettingsTrigger trigger;                ///< The trigger settings
-    RecordLengthID recordLengthId = 1;             ///< The id in the record length array
-    unsigned channelCount = 0;                     ///< Number of activated channels
-    Hantek::CalibrationValues *calibrationValues;  ///< Calibration data for the channel offsets & gains
-    Hantek::CalibrationValues *correctionValues;   ///< Online correction data for the channel offsets
+    alignas( 64 ) ControlSettingsSamplerate samplerate;          ///< The samplerate settings
+    alignas( 64 ) std::vector< ControlSettingsVoltage > voltage; ///< The amplification settings
+    alignas( 64 ) ControlSettingsTrigger trigger;                ///< The trigger settings
+    alignas( 64 ) RecordLengthID recordLengthId = 1;  ///< The id in the record length array
+    unsigned channelCount = 0;                        ///< Number of activated channels
+    Hantek::CalibrationValues *calibrationValues;     ///< Calibration data for the channel offsets & gains
+    Hantek::CalibrationValues *correctionValues;      ///< Online correction data for the channel offsets
     Hantek::ControlGetCalibration cmdGetCalibration;
 };
 } // namespace Dso
@@ -0,0 +1,805 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "convertsimd.h"
+#include "utils/cpucaps.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// Select the vector instruction sets available at compile time
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define CONVERT_SIMD_X86 1 // SSE2 is part of the x86-64 baseline, AVX2 is dispatched at runtime
+#include <immintrin.h>
+#elif defined( __aarch64__ )
+#define CONVERT_SIMD_NEON 1 // Advanced SIMD with double support is mandatory on AArch64
+#include <arm_neon.h>
+#endif
+
+
+// Scalar reference version, also used for the leftover samples of the vector kernels
+// and for any channel stride the specialized kernels do not cover
+static bool convertRawScalar( const unsigned char *in, double *out, unsigned count, unsigned stride, double offset,
+                              double scale ) {
+    bool clipped = false;
+    for ( unsigned index = 0; index < count; ++index ) {
+        unsigned char rawSample = in[ index * stride ];
+        if ( rawSample == 0x00 || rawSample == 0xFF ) // min or max -> clipped
+            clipped = true;
+        out[ index ] = ( double( rawSample ) - offset ) * scale;
+    }
+    return clipped;
+}
+
+
+#if !defined( CONVERT_SIMD_X86 ) && !defined( CONVERT_SIMD_NEON )
+
+// Scalar version with the channel stride as a compile time constant, the compiler
+// auto-vectorizes the unit stride case itself on platforms without a hand written kernel
+template < unsigned Stride >
+static bool convertRawScalarStride( const unsigned char *in, double *out, unsigned count, double offset, double scale ) {
+    bool clipped = false;
+    for ( unsigned index = 0; index < count; ++index ) {
+        unsigned char rawSample = in[ index * Stride ];
+        if ( rawSample == 0x00 || rawSample == 0xFF ) // min or max -> clipped
+            clipped = true;
+        out[ index ] = ( double( rawSample ) - offset ) * scale;
+    }
+    return clipped;
+}
+
+#endif
+
+
+#ifdef CONVERT_SIMD_X86
+
+// Convert 16 raw samples per iteration, SSE2 only (x86-64 baseline); the channel
+// stride is a template parameter, so the load path is selected at compile time
+template < unsigned Stride >
+static bool convertRawSSE2( const unsigned char *in, double *out, unsigned count, double offset, double scale ) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi8( char( 0xFF ) );
+    const __m128i loByte = _mm_set1_epi16( 0x00FF );
+    const __m128d vOffset = _mm_set1_pd( offset );
+    const __m128d vScale = _mm_set1_pd( scale );
+    __m128i clipAcc = _mm_setzero_si128();
+    unsigned blocks = count / 16;
+    if ( 2 == Stride && blocks )
+        --blocks; // the deinterleaving loads read one byte past the last sample pair
+    for ( unsigned block = 0; block < blocks; ++block, in += 16 * Stride, out += 16 ) {
+        __m128i bytes;
+        if ( 1 == Stride ) {
+            bytes = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+        } else { // deinterleave CH1/CH2: keep every 2nd byte of two loads
+            __m128i lo = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+            __m128i hi = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in + 16 ) );
+            bytes = _mm_packus_epi16( _mm_and_si128( lo, loByte ), _mm_and_si128( hi, loByte ) );
+        }
+        clipAcc = _mm_or_si128( clipAcc, _mm_cmpeq_epi8( bytes, zero ) );
+        clipAcc = _mm_or_si128( clipAcc, _mm_cmpeq_epi8( bytes, full ) );
+        __m128i w0 = _mm_unpacklo_epi8( bytes, zero ); // 2 x 8 x u16
+        __m128i w1 = _mm_unpackhi_epi8( bytes, zero );
+        __m128i quads[ 4 ] = { _mm_unpacklo_epi16( w0, zero ), _mm_unpackhi_epi16( w0, zero ), // 4 x 4 x u32
+                               _mm_unpacklo_epi16( w1, zero ), _mm_unpackhi_epi16( w1, zero ) };
+        for ( int iii = 0; iii < 4; ++iii ) {
+            __m128d lo = _mm_cvtepi32_pd( quads[ iii ] );
+            __m128d hi = _mm_cvtepi32_pd( _mm_shuffle_epi32( quads[ iii ], _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+            _mm_storeu_pd( out + iii * 4, _mm_mul_pd( _mm_sub_pd( lo, vOffset ), vScale ) );
+            _mm_storeu_pd( out + iii * 4 + 2, _mm_mul_pd( _mm_sub_pd( hi, vOffset ), vScale ) );
+        }
+    }
+    bool clipped = _mm_movemask_epi8( clipAcc ) != 0;
+    return convertRawScalar( in, out, count - blocks * 16, Stride, offset, scale ) || clipped;
+}
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define CONVERT_SIMD_AVX2 1
+
+// Convert 16 raw samples per iteration with 256 bit wide double math,
+// compiled for AVX2 and only called when the CPU supports it
+template < unsigned Stride >
+__attribute__( ( target( "avx2" ) ) ) static bool convertRawAVX2( const unsigned char *in, double *out, unsigned count,
+                                                                  double offset, double scale ) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi8( char( 0xFF ) );
+    const __m128i loByte = _mm_set1_epi16( 0x00FF );
+    const __m256d vOffset = _mm256_set1_pd( offset );
+    const __m256d vScale = _mm256_set1_pd( scale );
+    __m128i clipAcc = _mm_setzero_si128();
+    unsigned blocks = count / 16;
+    if ( 2 == Stride && blocks )
+        --blocks; // the deinterleaving loads read one byte past the last sample pair
+    for ( unsigned block = 0; block < blocks; ++block, in += 16 * Stride, out += 16 ) {
+        __m128i bytes;
+        if ( 1 == Stride ) {
+            bytes = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+        } else { // deinterleave CH1/CH2: keep every 2nd byte of two loads
+            __m128i lo = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+            __m128i hi = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in + 16 ) );
+            bytes = _mm_packus_epi16( _mm_and_si128( lo, loByte ), _mm_and_si128( hi, loByte ) );
+        }
+        clipAcc = _mm_or_si128( clipAcc, _mm_cmpeq_epi8( bytes, zero ) );
+        clipAcc = _mm_or_si128( clipAcc, _mm_cmpeq_epi8( bytes, full ) );
+        __m128i w0 = _mm_unpacklo_epi8( bytes, zero ); // 2 x 8 x u16
+        __m128i w1 = _mm_unpackhi_epi8( bytes, zero );
+        __m128i quads[ 4 ] = { _mm_unpacklo_epi16( w0, zero ), _mm_unpackhi_epi16( w0, zero ), // 4 x 4 x u32
+                               _mm_unpacklo_epi16( w1, zero ), _mm_unpackhi_epi16( w1, zero ) };
+        for ( int iii = 0; iii < 4; ++iii ) {
+            __m256d quad = _mm256_cvtepi32_pd( quads[ iii ] );
+            _mm256_storeu_pd( out + iii * 4, _mm256_mul_pd( _mm256_sub_pd( quad, vOffset ), vScale ) );
+        }
+    }
+    bool clipped = _mm_movemask_epi8( clipAcc ) != 0;
+    return convertRawScalar( in, out, count - blocks * 16, Stride, offset, scale ) || clipped;
+}
+
+#endif // __GNUC__ || __clang__
+
+#endif // CONVERT_SIMD_X86
+
+
+#ifdef CONVERT_SIMD_NEON
+
+// Convert 16 raw samples per iteration with NEON double math (AArch64); the channel
+// stride is a template parameter, so the load path is selected at compile time
+template < unsigned Stride >
+static bool convertRawNEON( const unsigned char *in, double *out, unsigned count, double offset, double scale ) {
+    const float64x2_t vOffset = vdupq_n_f64( offset );
+    const float64x2_t vScale = vdupq_n_f64( scale );
+    uint8x16_t clipAcc = vdupq_n_u8( 0 );
+    unsigned blocks = count / 16;
+    if ( 2 == Stride && blocks )
+        --blocks; // the deinterleaving loads read one byte past the last sample pair
+    for ( unsigned block = 0; block < blocks; ++block, in += 16 * Stride, out += 16 ) {
+        uint8x16_t bytes;
+        if ( 1 == Stride ) {
+            bytes = vld1q_u8( in );
+        } else { // deinterleaving CH1/CH2 load
+            bytes = vld2q_u8( in ).val[ 0 ];
+        }
+        clipAcc = vorrq_u8( clipAcc, vceqq_u8( bytes, vdupq_n_u8( 0x00 ) ) );
+        clipAcc = vorrq_u8( clipAcc, vceqq_u8( bytes, vdupq_n_u8( 0xFF ) ) );
+        uint16x8_t w0 = vmovl_u8( vget_low_u8( bytes ) );
+        uint16x8_t w1 = vmovl_u8( vget_high_u8( bytes ) );
+        uint32x4_t quads[ 4 ] = { vmovl_u16( vget_low_u16( w0 ) ), vmovl_u16( vget_high_u16( w0 ) ),
+                                  vmovl_u16( vget_low_u16( w1 ) ), vmovl_u16( vget_high_u16( w1 ) ) };
+        for ( int iii = 0; iii < 4; ++iii ) {
+            float64x2_t lo = vcvtq_f64_u64( vmovl_u32( vget_low_u32( quads[ iii ] ) ) );
+            float64x2_t hi = vcvtq_f64_u64( vmovl_u32( vget_high_u32( quads[ iii ] ) ) );
+            vst1q_f64( out + iii * 4, vmulq_f64( vsubq_f64( lo, vOffset ), vScale ) );
+            vst1q_f64( out + iii * 4 + 2, vmulq_f64( vsubq_f64( hi, vOffset ), vScale ) );
+        }
+    }
+    bool clipped = vmaxvq_u8( clipAcc ) != 0;
+    return convertRawScalar( in, out, count - blocks * 16, Stride, offset, scale ) || clipped;
+}
+
+#endif // CONVERT_SIMD_NEON
+
+
+// Kernel selection with the channel stride fixed at compile time
+template < unsigned Stride >
+static bool convertRawStride( const unsigned char *in, double *out, unsigned count, double offset, double scale ) {
+#if defined( CONVERT_SIMD_X86 )
+#if defined( CONVERT_SIMD_AVX2 )
+    static const bool hasAVX2 = CpuCaps::hasAVX2(); // shared detection, see utils/cpucaps.h
+    if ( hasAVX2 )
+        return convertRawAVX2< Stride >( in, out, count, offset, scale );
+#endif
+    return convertRawSSE2< Stride >( in, out, count, offset, scale );
+#elif defined( CONVERT_SIMD_NEON )
+    return convertRawNEON< Stride >( in, out, count, offset, scale );
+#else
+    return convertRawScalarStride< Stride >( in, out, count, offset, scale );
+#endif
+}
+
+
+bool convertRawSimd( const unsigned char *in, double *out, unsigned count, unsigned stride, double offset, double scale ) {
+    // Dispatch the stride of the two real cases into a compile time constant once per
+    // block, the kernels then run without the per-iteration channel count indirection
+    if ( 1 == stride ) // single channel: contiguous loads
+        return convertRawStride< 1 >( in, out, count, offset, scale );
+    if ( 2 == stride ) // CH1/CH2 interleaved: deinterleaving loads
+        return convertRawStride< 2 >( in, out, count, offset, scale );
+    return convertRawScalar( in, out, count, stride, offset, scale ); // the kernels deinterleave at most two channels
+}
+
+
+// Scalar min/max reference version, also used for the leftover samples of the vector kernels
+static void rawMinMaxScalar( const unsigned char *in, unsigned count, unsigned stride, unsigned char &minValue,
+                             unsigned char &maxValue ) {
+    for ( unsigned index = 0; index < count; ++index ) {
+        unsigned char rawSample = in[ index * stride ];
+        if ( rawSample < minValue )
+            minValue = rawSample;
+        if ( rawSample > maxValue )
+            maxValue = rawSample;
+    }
+}
+
+
+// Min/max kernel with the channel stride fixed at compile time, the scalar
+// reference also covers the leftover samples of the vector loops
+template < unsigned Stride >
+static void rawMinMaxStride( const unsigned char *in, unsigned count, unsigned char &minValue, unsigned char &maxValue ) {
+#if defined( CONVERT_SIMD_X86 )
+    const __m128i loByte = _mm_set1_epi16( 0x00FF );
+    __m128i minAcc = _mm_set1_epi8( char( 0xFF ) );
+    __m128i maxAcc = _mm_setzero_si128();
+    unsigned blocks = count / 16;
+    if ( 2 == Stride && blocks )
+        --blocks; // the deinterleaving loads read one byte past the last sample pair
+    for ( unsigned block = 0; block < blocks; ++block, in += 16 * Stride ) {
+        __m128i bytes;
+        if ( 1 == Stride ) {
+            bytes = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+        } else { // deinterleave CH1/CH2: keep every 2nd byte of two loads
+            __m128i lo = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+            __m128i hi = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in + 16 ) );
+            bytes = _mm_packus_epi16( _mm_and_si128( lo, loByte ), _mm_and_si128( hi, loByte ) );
+        }
+        minAcc = _mm_min_epu8( minAcc, bytes );
+        maxAcc = _mm_max_epu8( maxAcc, bytes );
+    }
+    if ( blocks ) { // horizontal reduction of the 16 byte accumulators
+        unsigned char lanes[ 16 ];
+        _mm_storeu_si128( reinterpret_cast< __m128i * >( lanes ), minAcc );
+        for ( int iii = 0; iii < 16; ++iii )
+            if ( lanes[ iii ] < minValue )
+                minValue = lanes[ iii ];
+        _mm_storeu_si128( reinterpret_cast< __m128i * >( lanes ), maxAcc );
+        for ( int iii = 0; iii < 16; ++iii )
+            if ( lanes[ iii ] > maxValue )
+                maxValue = lanes[ iii ];
+    }
+    count -= blocks * 16;
+#elif defined( CONVERT_SIMD_NEON )
+    uint8x16_t minAcc = vdupq_n_u8( 0xFF );
+    uint8x16_t maxAcc = vdupq_n_u8( 0x00 );
+    unsigned blocks = count / 16;
+    if ( 2 == Stride && blocks )
+        --blocks; // the deinterleaving loads read one byte past the last sample pair
+    for ( unsigned block = 0; block < blocks; ++block, in += 16 * Stride ) {
+        uint8x16_t bytes;
+        if ( 1 == Stride ) {
+            bytes = vld1q_u8( in );
+        } else { // deinterleaving CH1/CH2 load
+            bytes = vld2q_u8( in ).val[ 0 ];
+        }
+        minAcc = vminq_u8( minAcc, bytes );
+        maxAcc = vmaxq_u8( maxAcc, bytes );
+    }
+    if ( blocks ) {
+        minValue = vminvq_u8( minAcc );
+        maxValue = vmaxvq_u8( maxAcc );
+    }
+    count -= blocks * 16;
+#endif
+    rawMinMaxScalar( in, count, Stride, minValue, maxValue );
+}
+
+
+bool rawMinMaxSimd( const unsigned char *in, unsigned count, unsigned stride, unsigned char &minValue, unsigned char &maxValue ) {
+    minValue = 0xFF;
+    maxValue = 0x00;
+    if ( 1 == stride ) // single channel: contiguous loads
+        rawMinMaxStride< 1 >( in, count, minValue, maxValue );
+    else if ( 2 == stride ) // CH1/CH2 interleaved: deinterleaving loads
+        rawMinMaxStride< 2 >( in, count, minValue, maxValue );
+    else // the kernels deinterleave at most two channels
+        rawMinMaxScalar( in, count, stride, minValue, maxValue );
+    return minValue == 0x00 || maxValue == 0xFF;
+}
+
+
+// Scalar statistics reference, also used for the leftover samples of the vector kernels
+static void sampleStatsScalar( const double *in, unsigned count, double &sum, double &squareSum, double &minValue,
+                               double &maxValue ) {
+    for ( unsigned index = 0; index < count; ++index ) {
+        double sample = in[ index ];
+        sum += sample;
+        squareSum += sample * sample;
+        if ( sample < minValue )
+            minValue = sample;
+        if ( sample > maxValue )
+            maxValue = sample;
+    }
+}
+
+
+void sampleStatsSimd( const double *in, unsigned count, double &mean, double &rms, double &minValue, double &maxValue ) {
+    if ( !count ) {
+        mean = rms = minValue = maxValue = 0.0;
+        return;
+    }
+    double sum = 0.0;
+    double squareSum = 0.0;
+    double vMin = in[ 0 ];
+    double vMax = in[ 0 ];
+    unsigned index = 0;
+#if defined( CONVERT_SIMD_X86 )
+    if ( count >= 4 ) {
+        __m128d sumAcc0 = _mm_setzero_pd();
+        __m128d sumAcc1 = _mm_setzero_pd();
+        __m128d sqAcc0 = _mm_setzero_pd();
+        __m128d sqAcc1 = _mm_setzero_pd();
+        __m128d minAcc = _mm_set1_pd( vMin );
+        __m128d maxAcc = minAcc;
+        for ( ; index + 4 <= count; index += 4 ) { // two independent accumulator pairs
+            __m128d lo = _mm_loadu_pd( in + index );
+            __m128d hi = _mm_loadu_pd( in + index + 2 );
+            sumAcc0 = _mm_add_pd( sumAcc0, lo );
+            sumAcc1 = _mm_add_pd( sumAcc1, hi );
+            sqAcc0 = _mm_add_pd( sqAcc0, _mm_mul_pd( lo, lo ) );
+            sqAcc1 = _mm_add_pd( sqAcc1, _mm_mul_pd( hi, hi ) );
+            minAcc = _mm_min_pd( minAcc, _mm_min_pd( lo, hi ) );
+            maxAcc = _mm_max_pd( maxAcc, _mm_max_pd( lo, hi ) );
+        }
+        double lanes[ 2 ]; // horizontal reduction of the two lane accumulators
+        _mm_storeu_pd( lanes, _mm_add_pd( sumAcc0, sumAcc1 ) );
+        sum = lanes[ 0 ] + lanes[ 1 ];
+        _mm_storeu_pd( lanes, _mm_add_pd( sqAcc0, sqAcc1 ) );
+        squareSum = lanes[ 0 ] + lanes[ 1 ];
+        _mm_storeu_pd( lanes, minAcc );
+        vMin = lanes[ 0 ] < lanes[ 1 ] ? lanes[ 0 ] : lanes[ 1 ];
+        _mm_storeu_pd( lanes, maxAcc );
+        vMax = lanes[ 0 ] > lanes[ 1 ] ? lanes[ 0 ] : lanes[ 1 ];
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    if ( count >= 4 ) {
+        float64x2_t sumAcc0 = vdupq_n_f64( 0.0 );
+        float64x2_t sumAcc1 = vdupq_n_f64( 0.0 );
+        float64x2_t sqAcc0 = vdupq_n_f64( 0.0 );
+        float64x2_t sqAcc1 = vdupq_n_f64( 0.0 );
+        float64x2_t minAcc = vdupq_n_f64( vMin );
+        float64x2_t maxAcc = minAcc;
+        for ( ; index + 4 <= count; index += 4 ) { // two independent accumulator pairs
+            float64x2_t lo = vld1q_f64( in + index );
+            float64x2_t hi = vld1q_f64( in + index + 2 );
+            sumAcc0 = vaddq_f64( sumAcc0, lo );
+            sumAcc1 = vaddq_f64( sumAcc1, hi );
+            sqAcc0 = vfmaq_f64( sqAcc0, lo, lo );
+            sqAcc1 = vfmaq_f64( sqAcc1, hi, hi );
+            minAcc = vminq_f64( minAcc, vminq_f64( lo, hi ) );
+            maxAcc = vmaxq_f64( maxAcc, vmaxq_f64( lo, hi ) );
+        }
+        sum = vaddvq_f64( vaddq_f64( sumAcc0, sumAcc1 ) );
+        squareSum = vaddvq_f64( vaddq_f64( sqAcc0, sqAcc1 ) );
+        vMin = vminvq_f64( minAcc );
+        vMax = vmaxvq_f64( maxAcc );
+    }
+#endif
+    sampleStatsScalar( in + index, count - index, sum, squareSum, vMin, vMax );
+    mean = sum / count;
+    rms = sqrt( squareSum / count );
+    minValue = vMin;
+    maxValue = vMax;
+}
+
+
+// Scalar min/max reference over doubles, also used for the leftover samples of the vector kernel
+static void minMaxScalar( const double *in, unsigned count, double &minValue, double &maxValue ) {
+    for ( unsigned index = 0; index < count; ++index ) {
+        double sample = in[ index ];
+        if ( sample < minValue )
+            minValue = sample;
+        if ( sample > maxValue )
+            maxValue = sample;
+    }
+}
+
+
+void minMaxSimd( const double *in, unsigned count, double &minValue, double &maxValue ) {
+    if ( !count ) {
+        minValue = maxValue = 0.0;
+        return;
+    }
+    double vMin = in[ 0 ];
+    double vMax = in[ 0 ];
+    unsigned index = 0;
+#if defined( CONVERT_SIMD_X86 )
+    if ( count >= 4 ) {
+        __m128d minAcc = _mm_set1_pd( vMin );
+        __m128d maxAcc = minAcc;
+        for ( ; index + 4 <= count; index += 4 ) {
+            __m128d lo = _mm_loadu_pd( in + index );
+            __m128d hi = _mm_loadu_pd( in + index + 2 );
+            minAcc = _mm_min_pd( minAcc, _mm_min_pd( lo, hi ) );
+            maxAcc = _mm_max_pd( maxAcc, _mm_max_pd( lo, hi ) );
+        }
+        double lanes[ 2 ]; // horizontal reduction of the two lane accumulators
+        _mm_storeu_pd( lanes, minAcc );
+        vMin = lanes[ 0 ] < lanes[ 1 ] ? lanes[ 0 ] : lanes[ 1 ];
+        _mm_storeu_pd( lanes, maxAcc );
+        vMax = lanes[ 0 ] > lanes[ 1 ] ? lanes[ 0 ] : lanes[ 1 ];
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    if ( count >= 4 ) {
+        float64x2_t minAcc = vdupq_n_f64( vMin );
+        float64x2_t maxAcc = minAcc;
+        for ( ; index + 4 <= count; index += 4 ) {
+            float64x2_t lo = vld1q_f64( in + index );
+            float64x2_t hi = vld1q_f64( in + index + 2 );
+            minAcc = vminq_f64( minAcc, vminq_f64( lo, hi ) );
+            maxAcc = vmaxq_f64( maxAcc, vmaxq_f64( lo, hi ) );
+        }
+        vMin = vminvq_f64( minAcc );
+        vMax = vmaxvq_f64( maxAcc );
+    }
+#endif
+    minMaxScalar( in + index, count - index, vMin, vMax );
+    minValue = vMin;
+    maxValue = vMax;
+}
+
+
+// Scalar histogram reference, also used for the leftover samples of the vector kernel.
+// trunc( x + 0.5 ) equals round( x ) for all samples that land in the accepted bin
+// range 1 .. binCount - 1, the differing negative cases are rejected either way.
+static void histogramScalar( const double *in, unsigned count, double scale, double offset, unsigned *bins, unsigned binCount ) {
+    for ( unsigned index = 0; index < count; ++index ) {
+        int bin = int( in[ index ] * scale + offset + 0.5 );
+        if ( bin > 0 && unsigned( bin ) < binCount )
+            ++bins[ bin ];
+    }
+}
+
+
+void histogramSimd( const double *in, unsigned count, double scale, double offset, unsigned *bins, unsigned binCount ) {
+    unsigned index = 0;
+#if defined( CONVERT_SIMD_X86 )
+    if ( count >= 4 ) {
+        const __m128d vScale = _mm_set1_pd( scale );
+        const __m128d vOffset = _mm_set1_pd( offset + 0.5 );
+        int32_t binIndex[ 4 ];
+        for ( ; index + 4 <= count; index += 4 ) {
+            __m128d lo = _mm_add_pd( _mm_mul_pd( _mm_loadu_pd( in + index ), vScale ), vOffset );
+            __m128d hi = _mm_add_pd( _mm_mul_pd( _mm_loadu_pd( in + index + 2 ), vScale ), vOffset );
+            // truncating conversion, see histogramScalar() for the rounding equivalence
+            _mm_storeu_si128( reinterpret_cast< __m128i * >( binIndex ),
+                              _mm_unpacklo_epi64( _mm_cvttpd_epi32( lo ), _mm_cvttpd_epi32( hi ) ) );
+            // the increments stay scalar - a vector scatter would lose conflicting lanes
+            for ( int lane = 0; lane < 4; ++lane ) {
+                int bin = binIndex[ lane ];
+                if ( bin > 0 && unsigned( bin ) < binCount )
+                    ++bins[ bin ];
+            }
+        }
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    if ( count >= 4 ) {
+        const float64x2_t vScale = vdupq_n_f64( scale );
+        const float64x2_t vOffset = vdupq_n_f64( offset + 0.5 );
+        int32_t binIndex[ 4 ];
+        for ( ; index + 4 <= count; index += 4 ) {
+            float64x2_t lo = vfmaq_f64( vOffset, vld1q_f64( in + index ), vScale );
+            float64x2_t hi = vfmaq_f64( vOffset, vld1q_f64( in + index + 2 ), vScale );
+            // truncating conversion, see histogramScalar() for the rounding equivalence
+            vst1q_s32( binIndex, vcombine_s32( vmovn_s64( vcvtq_s64_f64( lo ) ), vmovn_s64( vcvtq_s64_f64( hi ) ) ) );
+            // the increments stay scalar - a vector scatter would lose conflicting lanes
+            for ( int lane = 0; lane < 4; ++lane ) {
+                int bin = binIndex[ lane ];
+                if ( bin > 0 && unsigned( bin ) < binCount )
+                    ++bins[ bin ];
+            }
+        }
+    }
+#endif
+    histogramScalar( in + index, count - index, scale, offset, bins, binCount );
+}
+
+
+// Scalar half-complex to power reference, also used for the leftover bin pairs of the vector kernels
+static void hcPowerScalar( const double *hc, unsigned sampleCount, unsigned from, unsigned to, double *spectrum, double *power,
+                           double norm ) {
+    for ( unsigned bin = from; bin < to; ++bin ) {
+        double s = hc[ bin ] * hc[ bin ] + hc[ sampleCount - bin ] * hc[ sampleCount - bin ];
+        spectrum[ bin ] = s;
+        power[ bin ] = s * norm;
+    }
+}
+
+
+void hcPowerSimd( const double *hcSpectrum, unsigned sampleCount, double *spectrum, double *power, double norm ) {
+    unsigned dftLength = sampleCount / 2;
+    spectrum[ 0 ] = hcSpectrum[ 0 ] * hcSpectrum[ 0 ]; // spectrum[ 0 ] is only real
+    power[ 0 ] = spectrum[ 0 ] * norm;
+    unsigned bin = 1;
+#if defined( CONVERT_SIMD_X86 )
+    const __m128d vNorm = _mm_set1_pd( norm );
+    for ( ; bin + 2 <= dftLength; bin += 2 ) {
+        __m128d fwd = _mm_loadu_pd( hcSpectrum + bin );
+        __m128d rev = _mm_loadu_pd( hcSpectrum + sampleCount - bin - 1 );
+        rev = _mm_shuffle_pd( rev, rev, 0x1 ); // reverse to pair with the forward bins
+        __m128d s = _mm_add_pd( _mm_mul_pd( fwd, fwd ), _mm_mul_pd( rev, rev ) );
+        _mm_storeu_pd( spectrum + bin, s );
+        _mm_storeu_pd( power + bin, _mm_mul_pd( s, vNorm ) );
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    const float64x2_t vNorm = vdupq_n_f64( norm );
+    for ( ; bin + 2 <= dftLength; bin += 2 ) {
+        float64x2_t fwd = vld1q_f64( hcSpectrum + bin );
+        float64x2_t rev = vld1q_f64( hcSpectrum + sampleCount - bin - 1 );
+        rev = vextq_f64( rev, rev, 1 ); // reverse to pair with the forward bins
+        float64x2_t s = vfmaq_f64( vmulq_f64( fwd, fwd ), rev, rev );
+        vst1q_f64( spectrum + bin, s );
+        vst1q_f64( power + bin, vmulq_f64( s, vNorm ) );
+    }
+#endif
+    hcPowerScalar( hcSpectrum, sampleCount, bin, dftLength, spectrum, power, norm );
+    spectrum[ dftLength ] = hcSpectrum[ dftLength ] * hcSpectrum[ dftLength ]; // Nyquist bin is only real
+    power[ dftLength ] = spectrum[ dftLength ] * norm;
+    for ( bin = dftLength + 1; bin < sampleCount; ++bin ) // complex values, all zero for the autocorrelation
+        power[ bin ] = 0.0;
+}
+
+
+// Scalar single precision reference, also used for the leftover bin pairs of the vector kernel
+static void hcPowerScalarF( const float *hc, unsigned sampleCount, unsigned from, unsigned to, double *spectrum, float *power,
+                            float norm ) {
+    for ( unsigned bin = from; bin < to; ++bin ) {
+        float s = hc[ bin ] * hc[ bin ] + hc[ sampleCount - bin ] * hc[ sampleCount - bin ];
+        spectrum[ bin ] = double( s );
+        power[ bin ] = s * norm;
+    }
+}
+
+
+void hcPowerSimd( const float *hcSpectrum, unsigned sampleCount, double *spectrum, float *power, float norm ) {
+    unsigned dftLength = sampleCount / 2;
+    spectrum[ 0 ] = double( hcSpectrum[ 0 ] ) * double( hcSpectrum[ 0 ] );
+    power[ 0 ] = float( spectrum[ 0 ] * norm );
+    unsigned bin = 1;
+#if defined( CONVERT_SIMD_X86 )
+    const __m128 vNorm = _mm_set1_ps( norm );
+    for ( ; bin + 4 <= dftLength; bin += 4 ) {
+        __m128 fwd = _mm_loadu_ps( hcSpectrum + bin );
+        __m128 rev = _mm_loadu_ps( hcSpectrum + sampleCount - bin - 3 );
+        rev = _mm_shuffle_ps( rev, rev, _MM_SHUFFLE( 0, 1, 2, 3 ) ); // reverse to pair with the forward bins
+        __m128 s = _mm_add_ps( _mm_mul_ps( fwd, fwd ), _mm_mul_ps( rev, rev ) );
+        _mm_storeu_pd( spectrum + bin, _mm_cvtps_pd( s ) ); // displayed bins stay double
+        _mm_storeu_pd( spectrum + bin + 2, _mm_cvtps_pd( _mm_movehl_ps( s, s ) ) );
+        _mm_storeu_ps( power + bin, _mm_mul_ps( s, vNorm ) );
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    const float32x4_t vNorm = vdupq_n_f32( norm );
+    for ( ; bin + 4 <= dftLength; bin += 4 ) {
+        float32x4_t fwd = vld1q_f32( hcSpectrum + bin );
+        float32x4_t rev = vld1q_f32( hcSpectrum + sampleCount - bin - 3 );
+        rev = vextq_f32( vrev64q_f32( rev ), vrev64q_f32( rev ), 2 ); // reverse to pair with the forward bins
+        float32x4_t s = vfmaq_f32( vmulq_f32( fwd, fwd ), rev, rev );
+        vst1q_f64( spectrum + bin, vcvt_f64_f32( vget_low_f32( s ) ) ); // displayed bins stay double
+        vst1q_f64( spectrum + bin + 2, vcvt_f64_f32( vget_high_f32( s ) ) );
+        vst1q_f32( power + bin, vmulq_f32( s, vNorm ) );
+    }
+#endif
+    hcPowerScalarF( hcSpectrum, sampleCount, bin, dftLength, spectrum, power, norm );
+    spectrum[ dftLength ] = double( hcSpectrum[ dftLength ] ) * double( hcSpectrum[ dftLength ] );
+    power[ dftLength ] = float( spectrum[ dftLength ] * norm );
+    for ( bin = dftLength + 1; bin < sampleCount; ++bin ) // complex values, all zero for the autocorrelation
+        power[ bin ] = 0.0f;
+}
+
+
+// Constants of the fast log10 approximation, shared by the scalar and the vector kernels:
+// log2( m ) = 2 atanh( t ) / ln( 2 ) with t = ( m - 1 ) / ( m + 1 ), atanh as its
+// first four series terms; with m reduced to [1/sqrt(2), sqrt(2)) the error of the
+// truncated series stays below 4e-8, far finer than the 0.1 dB display granularity.
+static const double LOG_C1 = 2.0 / M_LN2;
+static const double LOG_C3 = 2.0 / ( 3.0 * M_LN2 );
+static const double LOG_C5 = 2.0 / ( 5.0 * M_LN2 );
+static const double LOG_C7 = 2.0 / ( 7.0 * M_LN2 );
+static const double LOG10_2 = 0.30102999566398120; // log10( 2 )
+
+
+// Scalar reference of the fast log10, also used for the leftover bins of the vector kernels
+static inline double fastLog10( double x ) {
+    int64_t bits;
+    memcpy( &bits, &x, sizeof bits );
+    int exponent = int( ( bits >> 52 ) & 0x7FF ) - 1023;
+    bits = ( bits & 0x000FFFFFFFFFFFFFll ) | 0x3FF0000000000000ll; // mantissa m in [1, 2)
+    double m;
+    memcpy( &m, &bits, sizeof m );
+    if ( m > M_SQRT2 ) { // reduce to [1/sqrt(2), sqrt(2))
+        m *= 0.5;
+        ++exponent;
+    }
+    double t = ( m - 1.0 ) / ( m + 1.0 );
+    double t2 = t * t;
+    double log2m = t * ( LOG_C1 + t2 * ( LOG_C3 + t2 * ( LOG_C5 + t2 * LOG_C7 ) ) );
+    return ( exponent + log2m ) * LOG10_2; // zero and denormal inputs end up below any display limit
+}
+
+
+int spectrumDbSimd( double *spectrum, unsigned count, double offset, double limit, double &minValue, double &maxValue ) {
+    double vMin = DBL_MAX;
+    double vMax = limit; // the peak has to rise above the display limit
+    int peakPos = 0;
+    unsigned index = 0;
+#if defined( CONVERT_SIMD_X86 )
+    if ( count >= 2 ) {
+        const __m128d mantMask = _mm_castsi128_pd( _mm_set1_epi64x( 0x000FFFFFFFFFFFFFll ) );
+        const __m128d oneBits = _mm_castsi128_pd( _mm_set1_epi64x( 0x3FF0000000000000ll ) );
+        const __m128i expMask = _mm_set1_epi64x( 0x7FF );
+        const __m128d vOne = _mm_set1_pd( 1.0 );
+        const __m128d vHalf = _mm_set1_pd( 0.5 );
+        const __m128d vSqrt2 = _mm_set1_pd( M_SQRT2 );
+        const __m128d vC1 = _mm_set1_pd( LOG_C1 );
+        const __m128d vC3 = _mm_set1_pd( LOG_C3 );
+        const __m128d vC5 = _mm_set1_pd( LOG_C5 );
+        const __m128d vC7 = _mm_set1_pd( LOG_C7 );
+        const __m128d vScale = _mm_set1_pd( 10.0 * LOG10_2 ); // power -> dB in one factor
+        const __m128d vOffset = _mm_set1_pd( offset );
+        const __m128d vLimit = _mm_set1_pd( limit );
+        __m128d minAcc = _mm_set1_pd( DBL_MAX );
+        __m128d maxAcc = vLimit;
+        __m128d idxAcc = _mm_setzero_pd();
+        __m128d idxCur = _mm_set_pd( 1.0, 0.0 ); // bin positions as doubles, exact up to 2^53
+        const __m128d idxStep = _mm_set1_pd( 2.0 );
+        for ( ; index + 2 <= count; index += 2 ) {
+            __m128d v = _mm_loadu_pd( spectrum + index );
+            // split into exponent and mantissa m in [1/sqrt(2), sqrt(2))
+            __m128i expBits = _mm_and_si128( _mm_srli_epi64( _mm_castpd_si128( v ), 52 ), expMask );
+            __m128d e = _mm_cvtepi32_pd( _mm_shuffle_epi32( expBits, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+            e = _mm_sub_pd( e, _mm_set1_pd( 1023.0 ) );
+            __m128d m = _mm_or_pd( _mm_and_pd( v, mantMask ), oneBits );
+            __m128d reduce = _mm_cmpgt_pd( m, vSqrt2 );
+            m = _mm_mul_pd( m, _mm_or_pd( _mm_and_pd( reduce, vHalf ), _mm_andnot_pd( reduce, vOne ) ) );
+            e = _mm_add_pd( e, _mm_and_pd( reduce, vOne ) );
+            // truncated atanh series for log2( m )
+            __m128d t = _mm_div_pd( _mm_sub_pd( m, vOne ), _mm_add_pd( m, vOne ) );
+            __m128d t2 = _mm_mul_pd( t, t );
+            __m128d poly = _mm_add_pd( vC5, _mm_mul_pd( t2, vC7 ) );
+            poly = _mm_add_pd( vC3, _mm_mul_pd( t2, poly ) );
+            poly = _mm_mul_pd( t, _mm_add_pd( vC1, _mm_mul_pd( t2, poly ) ) );
+            __m128d dB = _mm_add_pd( _mm_mul_pd( _mm_add_pd( e, poly ), vScale ), vOffset );
+            dB = _mm_max_pd( dB, vLimit ); // clamp to the display limit
+            _mm_storeu_pd( spectrum + index, dB );
+            minAcc = _mm_min_pd( minAcc, dB );
+            __m128d newMax = _mm_cmpgt_pd( dB, maxAcc ); // remember the first position of the peak
+            maxAcc = _mm_max_pd( maxAcc, dB );
+            idxAcc = _mm_or_pd( _mm_and_pd( newMax, idxCur ), _mm_andnot_pd( newMax, idxAcc ) );
+            idxCur = _mm_add_pd( idxCur, idxStep );
+        }
+        double lanes[ 2 ], positions[ 2 ]; // horizontal reduction of the two lane accumulators
+        _mm_storeu_pd( lanes, minAcc );
+        vMin = lanes[ 0 ] < lanes[ 1 ] ? lanes[ 0 ] : lanes[ 1 ];
+        _mm_storeu_pd( lanes, maxAcc );
+        _mm_storeu_pd( positions, idxAcc );
+        int best = ( lanes[ 1 ] > lanes[ 0 ] || ( lanes[ 1 ] == lanes[ 0 ] && positions[ 1 ] < positions[ 0 ] ) ) ? 1 : 0;
+        if ( lanes[ best ] > limit ) {
+            vMax = lanes[ best ];
+            peakPos = int( positions[ best ] );
+        }
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    if ( count >= 2 ) {
+        const uint64x2_t mantMask = vdupq_n_u64( 0x000FFFFFFFFFFFFFull );
+        const uint64x2_t oneBits = vdupq_n_u64( 0x3FF0000000000000ull );
+        const float64x2_t vOne = vdupq_n_f64( 1.0 );
+        const float64x2_t vHalf = vdupq_n_f64( 0.5 );
+        const float64x2_t vSqrt2 = vdupq_n_f64( M_SQRT2 );
+        const float64x2_t vC1 = vdupq_n_f64( LOG_C1 );
+        const float64x2_t vC3 = vdupq_n_f64( LOG_C3 );
+        const float64x2_t vC5 = vdupq_n_f64( LOG_C5 );
+        const float64x2_t vC7 = vdupq_n_f64( LOG_C7 );
+        const float64x2_t vScale = vdupq_n_f64( 10.0 * LOG10_2 ); // power -> dB in one factor
+        const float64x2_t vOffset = vdupq_n_f64( offset );
+        const float64x2_t vLimit = vdupq_n_f64( limit );
+        float64x2_t minAcc = vdupq_n_f64( DBL_MAX );
+        float64x2_t maxAcc = vLimit;
+        float64x2_t idxAcc = vdupq_n_f64( 0.0 );
+        float64x2_t idxCur = { 0.0, 1.0 }; // bin positions as doubles, exact up to 2^53
+        const float64x2_t idxStep = vdupq_n_f64( 2.0 );
+        for ( ; index + 2 <= count; index += 2 ) {
+            float64x2_t v = vld1q_f64( spectrum + index );
+            // split into exponent and mantissa m in [1/sqrt(2), sqrt(2))
+            uint64x2_t bits = vreinterpretq_u64_f64( v );
+            int64x2_t expBits = vreinterpretq_s64_u64( vandq_u64( vshrq_n_u64( bits, 52 ), vdupq_n_u64( 0x7FF ) ) );
+            float64x2_t e = vsubq_f64( vcvtq_f64_s64( expBits ), vdupq_n_f64( 1023.0 ) );
+            float64x2_t m = vreinterpretq_f64_u64( vorrq_u64( vandq_u64( bits, mantMask ), oneBits ) );
+            uint64x2_t reduce = vcgtq_f64( m, vSqrt2 );
+            m = vbslq_f64( reduce, vmulq_f64( m, vHalf ), m );
+            e = vbslq_f64( reduce, vaddq_f64( e, vOne ), e );
+            // truncated atanh series for log2( m )
+            float64x2_t t = vdivq_f64( vsubq_f64( m, vOne ), vaddq_f64( m, vOne ) );
+            float64x2_t t2 = vmulq_f64( t, t );
+            float64x2_t poly = vfmaq_f64( vC5, t2, vC7 );
+            poly = vfmaq_f64( vC3, t2, poly );
+            poly = vmulq_f64( t, vfmaq_f64( vC1, t2, poly ) );
+            float64x2_t dB = vfmaq_f64( vOffset, vaddq_f64( e, poly ), vScale );
+            dB = vmaxq_f64( dB, vLimit ); // clamp to the display limit
+            vst1q_f64( spectrum + index, dB );
+            minAcc = vminq_f64( minAcc, dB );
+            uint64x2_t newMax = vcgtq_f64( dB, maxAcc ); // remember the first position of the peak
+            maxAcc = vmaxq_f64( maxAcc, dB );
+            idxAcc = vbslq_f64( newMax, idxCur, idxAcc );
+            idxCur = vaddq_f64( idxCur, idxStep );
+        }
+        vMin = vminvq_f64( minAcc );
+        double lane0 = vgetq_lane_f64( maxAcc, 0 ), lane1 = vgetq_lane_f64( maxAcc, 1 );
+        double pos0 = vgetq_lane_f64( idxAcc, 0 ), pos1 = vgetq_lane_f64( idxAcc, 1 );
+        int best = ( lane1 > lane0 || ( lane1 == lane0 && pos1 < pos0 ) ) ? 1 : 0;
+        if ( ( best ? lane1 : lane0 ) > limit ) {
+            vMax = best ? lane1 : lane0;
+            peakPos = int( best ? pos1 : pos0 );
+        }
+    }
+#endif
+    for ( ; index < count; ++index ) { // leftover bins and the non SIMD fallback
+        double dB = 10.0 * fastLog10( spectrum[ index ] ) + offset;
+        if ( dB < limit ) // clamp to the display limit
+            dB = limit;
+        spectrum[ index ] = dB;
+        if ( dB > vMax ) { // detect frequency peak
+            vMax = dB;
+            peakPos = int( index );
+        }
+        if ( dB < vMin )
+            vMin = dB;
+    }
+    if ( !count ) {
+        minValue = maxValue = limit;
+        return 0;
+    }
+    minValue = vMin;
+    maxValue = vMax;
+    return peakPos;
+}
+
+
+// Scalar crossing search reference, also used for the leftover samples of the vector kernels
+static int findCrossingScalar( const int16_t *samples, int begin, int end, int level, int slope ) {
+    if ( slope > 0 ) {
+        for ( int i = begin; i < end; ++i )
+            if ( samples[ i ] >= level && samples[ i - 1 ] < level )
+                return i;
+    } else {
+        for ( int i = begin; i < end; ++i )
+            if ( samples[ i ] <= level && samples[ i - 1 ] > level )
+                return i;
+    }
+    return -1;
+}
+
+
+int findCrossingSimd( const int16_t *samples, int begin, int end, int level, int slope ) {
+    int i = begin;
+#if defined( CONVERT_SIMD_X86 )
+    const __m128i lv = _mm_set1_epi16( short( level ) );
+    for ( ; i + 8 <= end; i += 8 ) {
+        const __m128i cur = _mm_loadu_si128( reinterpret_cast< const __m128i * >( samples + i ) );
+        const __m128i prv = _mm_loadu_si128( reinterpret_cast< const __m128i * >( samples + i - 1 ) );
+        __m128i hit;
+        if ( slope > 0 ) // cur >= level && prv < level
+            hit = _mm_andnot_si128( _mm_cmpgt_epi16( lv, cur ), _mm_cmpgt_epi16( lv, prv ) );
+        else // cur <= level && prv > level
+            hit = _mm_andnot_si128( _mm_cmpgt_epi16( cur, lv ), _mm_cmpgt_epi16( prv, lv ) );
+        const int mask = _mm_movemask_epi8( hit );
+        if ( mask ) // extract the first hit lane from the byte mask
+            for ( int lane = 0; lane < 8; ++lane )
+                if ( mask & ( 1 << ( 2 * lane ) ) )
+                    return i + lane;
+    }
+#elif defined( CONVERT_SIMD_NEON )
+    const int16x8_t lv = vdupq_n_s16( int16_t( level ) );
+    for ( ; i + 8 <= end; i += 8 ) {
+        const int16x8_t cur = vld1q_s16( samples + i );
+        const int16x8_t prv = vld1q_s16( samples + i - 1 );
+        uint16x8_t hit;
+        if ( slope > 0 ) // cur >= level && prv < level
+            hit = vandq_u16( vcgeq_s16( cur, lv ), vcltq_s16( prv, lv ) );
+        else // cur <= level && prv > level
+            hit = vandq_u16( vcleq_s16( cur, lv ), vcgtq_s16( prv, lv ) );
+        if ( vmaxvq_u16( hit ) ) { // extract the first hit lane
+            uint16_t lanes[ 8 ];
+            vst1q_u16( lanes, hit );
+            for ( int lane = 0; lane < 8; ++lane )
+                if ( lanes[ lane ] )
+                    return i + lane;
+        }
+    }
+#endif
+    return findCrossingScalar( samples, i, end, level, slope );
+}
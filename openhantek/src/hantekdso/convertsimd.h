@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstdint>
+
+#include "utils/hotpath.h"
+
+/// \brief Vectorized conversion of interleaved 8 bit raw ADC data to voltage values.
+/// Computes out[ i ] = ( in[ i * stride ] - offset ) * scale, 16 samples per iteration,
+/// with SSE2/AVX2 (runtime dispatched) on x86-64 or NEON on AArch64 and falls back to
+/// a scalar loop on other platforms.
+/// \param in First raw sample of the channel (stride 2 skips the interleaved other channel).
+/// \param out Target buffer for the converted samples.
+/// \param count Number of samples to convert.
+/// \param stride Distance between two raw samples of this channel (1 or 2).
+/// \param offset Combined calibration offset that is subtracted from each raw value.
+/// \param scale Combined gain / probe / polarity / voltage scale factor.
+/// \return true if any raw sample was clipped (0x00 or 0xFF).
+DSO_HOT bool convertRawSimd( const unsigned char *in, double *out, unsigned count, unsigned stride, double offset, double scale );
+
+/// \brief Vectorized min/max reduction over the raw bytes of one channel.
+/// One pass over the bytes replaces the two compares plus clipping branch per sample
+/// inside a conversion loop; the clipping state follows directly from the extremes.
+/// \param in First raw sample of the channel (stride 2 skips the interleaved other channel).
+/// \param count Number of samples to scan.
+/// \param stride Distance between two raw samples of this channel (1 or 2).
+/// \param minValue Receives the smallest raw byte of the channel.
+/// \param maxValue Receives the largest raw byte of the channel.
+/// \return true if any scanned byte was clipped (0x00 or 0xFF).
+bool rawMinMaxSimd( const unsigned char *in, unsigned count, unsigned stride, unsigned char &minValue, unsigned char &maxValue );
+
+/// \brief Vectorized one pass statistics over a converted channel buffer.
+/// Accumulates sum, sum of squares, minimum and maximum in a single sweep and derives
+/// the mean and the total rms from the sums. Filled once per block so the downstream
+/// consumers (math channel DC modes, spectrum generator) do not repeat the full pass.
+/// \param in The converted samples of the channel.
+/// \param count Number of samples to scan.
+/// \param mean Receives the mean (DC component) of the samples.
+/// \param rms Receives the total rms (AC + DC) of the samples.
+/// \param minValue Receives the smallest sample value.
+/// \param maxValue Receives the largest sample value.
+void sampleStatsSimd( const double *in, unsigned count, double &mean, double &rms, double &minValue, double &maxValue );
+
+/// \brief Vectorized min/max reduction over a converted sample range, used e.g. for
+/// the per-pixel envelope decimation of dense traces.
+/// \param in The converted samples.
+/// \param count Number of samples to scan, 0 yields min = max = 0.
+/// \param minValue Receives the smallest sample value.
+/// \param maxValue Receives the largest sample value.
+void minMaxSimd( const double *in, unsigned count, double &minValue, double &maxValue );
+
+/// \brief Vectorized histogram binning over a converted sample range.
+/// Counts bins[ round( in[ i ] * scale + offset ) ] for every sample whose bin
+/// falls into 1 .. binCount - 1; out of range samples are skipped. The bin index
+/// computation runs four samples per iteration, the increments stay scalar.
+/// \param in The converted samples.
+/// \param count Number of samples to bin.
+/// \param scale Factor from sample value to (fractional) bin index.
+/// \param offset Offset added to the scaled value before rounding.
+/// \param bins The histogram counters, not cleared here.
+/// \param binCount Number of histogram bins.
+void histogramSimd( const double *in, unsigned count, double scale, double offset, unsigned *bins, unsigned binCount );
+
+/// \brief Vectorized conversion of the half-complex FFT result to the power spectrum.
+/// Writes spectrum[ i ] = re² + im² of bin i for display and a normalized copy into
+/// power (the input of the lazy autocorrelation); the mirrored second half of power
+/// is zeroed. The forward and the mirrored reverse half are squared and summed two
+/// bin pairs per iteration.
+/// \param hcSpectrum The half-complex FFT result (FFTW R2HC layout).
+/// \param sampleCount Length of the transform, spectrum gets sampleCount / 2 + 1 bins.
+/// \param spectrum Target for the displayed power bins.
+/// \param power Target for the normalized power copy, sampleCount values.
+/// \param norm Normalization factor of the power copy.
+void hcPowerSimd( const double *hcSpectrum, unsigned sampleCount, double *spectrum, double *power, double norm );
+/// \brief Single precision overload of hcPowerSimd(), the displayed bins stay double.
+void hcPowerSimd( const float *hcSpectrum, unsigned sampleCount, double *spectrum, float *power, float norm );
+
+/// \brief Vectorized in-place conversion of the power spectrum bins into dB using a
+/// fast log10 approximation (error < 1e-7, the display granularity is 0.1 dB), fused
+/// with the lower limit clamp and the peak / min / max bookkeeping into one pass.
+/// \param spectrum The power bins, replaced by 10 * log10( bin ) + offset in place.
+/// \param count Number of bins.
+/// \param offset Offset added to each dB value (reference level and FFT scaling).
+/// \param limit Lower display limit, smaller dB values are clamped to it.
+/// \param minValue Receives the smallest clamped dB value.
+/// \param maxValue Receives the largest clamped dB value.
+/// \return The position of the first occurrence of the peak above limit, 0 if none.
+int spectrumDbSimd( double *spectrum, unsigned count, double offset, double limit, double &minValue, double &maxValue );
+
+/// \brief Vectorized search for the next trigger level crossing in int16 samples,
+/// comparing 8 samples per iteration and extracting the first hit from the mask.
+/// A crossing at index i means samples[ i ] >= level && samples[ i - 1 ] < level
+/// for a rising slope, samples[ i ] <= level && samples[ i - 1 ] > level for a
+/// falling one.
+/// \param samples The fixed point sample buffer.
+/// \param begin First index to check, must be >= 1 (the predecessor is read).
+/// \param end One past the last index to check.
+/// \param level The crossing level, must fit into int16.
+/// \param slope > 0 searches a rising slope, < 0 a falling one.
+/// \return The index of the first crossing in [begin, end), -1 if there is none.
+DSO_HOT int findCrossingSimd( const int16_t *samples, int begin, int end, int level, int slope );
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// Persistent worker thread that runs one half of a data pass concurrently with
+/// the other half on the calling thread (channel conversion, IIR filter passes).
+/// The halves write disjoint result buffers, so the split is race-free; one
+/// long-lived thread avoids the start overhead of a per-block spawn at up to
+/// 100 blocks/s.
+class ConvertWorker {
+  public:
+    ConvertWorker() : worker( [ this ]() { run(); } ) {}
+    ~ConvertWorker() {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            quit = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+    /// Execute the job asynchronously on the worker thread.
+    void start( std::function< void() > newJob ) {
+        std::lock_guard< std::mutex > lock( mutex );
+        job = std::move( newJob );
+        busy = true;
+        wake.notify_one();
+    }
+    /// Block until the current job has finished.
+    void wait() {
+        std::unique_lock< std::mutex > lock( mutex );
+        done.wait( lock, [ this ]() { return !busy; } );
+    }
+
+  private:
+    void run() {
+        std::unique_lock< std::mutex > lock( mutex );
+        while ( true ) {
+            wake.wait( lock, [ this ]() { return busy || quit; } );
+            if ( quit )
+                return;
+            std::function< void() > currentJob = std::move( job );
+            lock.unlock();
+            currentJob();
+            lock.lock();
+            busy = false;
+            done.notify_one();
+        }
+    }
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function< void() > job;
+    bool busy = false;
+    bool quit = false;
+    std::thread worker; ///< must be the last member, its start runs run()
+};
@@ -2,24 +2,108 @@
 
 #pragma once
 
+#include "utils/bufferpool.h"
 #include "utils/printutils.h"
-#include <QReadLocker>
-#include <QReadWriteLock>
-#include <QWriteLocker>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
-struct DSOsamples {
-    std::vector< std::vector< double > > data; ///< Pointer to input data from device
-    double samplerate = 0.0;                   ///< The samplerate of the input data
+/// The struct is cache line aligned: HantekDsoControl rotates through an array of
+/// three slots, the producer fills one slot while the consumer still reads another,
+/// so neighbouring slots must not share a cache line at their boundaries (false
+/// sharing bounces the line between cores, measurable on big.LITTLE parts where the
+/// threads often end up on different clusters).
+struct alignas( 64 ) DSOsamples {
+    /// Per block sample statistics of one channel, filled during the raw conversion.
+    /// The downstream consumers (math channel DC modes, spectrum generator) read the
+    /// cached mean instead of repeating a full pass over the block; the min/max cover
+    /// the whole block, the displayed-part extremes stay with the spectrum generator.
+    struct ChannelStats {
+        bool valid = false; ///< filled by the last conversion
+        double mean = 0.0;  ///< DC component
+        double rms = 0.0;   ///< total rms (AC + DC)
+        double vmin = 0.0;  ///< smallest sample value of the whole block
+        double vmax = 0.0;  ///< largest sample value of the whole block
+        /// Readout of the continuous zero crossing counter (see HantekDsoControl),
+        /// gated over one second across block borders; 0.0 until the gate settles.
+        double counterFrequency = 0.0;
+    };
+    /// The channel sample buffers are shared pointers so that the last triggered trace
+    /// can be saved and restored (NORMAL trigger mode) without copying any samples.
+    /// Writers get their buffer via modifiableData(), which unshares it first.
+    std::vector< std::shared_ptr< std::vector< double > > > data; ///< Input data from device
+    std::vector< ChannelStats > stats;                            ///< one entry per channel in data
+    /// Compact fixed point companion trace of the trigger source channel, generated
+    /// during the raw conversion. The trigger search makes several passes over this
+    /// channel; reading 2 byte int16 samples instead of the 8 byte doubles quarters
+    /// its memory traffic. Volts stay double at all display and measurement edges.
+    /// Per sample min/max envelope accumulated across successive trigger aligned
+    /// frames (see HantekDsoControl::accumulateEnvelope()), shared into the post
+    /// processing like the channel buffers above; empty unless envelope mode is on.
+    std::vector< std::shared_ptr< std::vector< double > > > envelopeMin;
+    std::vector< std::shared_ptr< std::vector< double > > > envelopeMax;
+    /// Display fast path: the raw 8 bit block of this frame plus the per channel
+    /// byte -> volts LUT of the conversion. The dense trace decimation in the graph
+    /// generator scans these bytes (1 B per sample) instead of the converted doubles
+    /// (8 B per sample) and maps only the two extremes of each pixel column through
+    /// the LUT; the doubles stay the source for all measurements and exports.
+    /// Null when the block is oversampled, rolling, partial or does not match the
+    /// presented trace (averaging, restored NORMAL mode trace).
+    std::shared_ptr< std::vector< unsigned char > > rawDisplay; ///< interleaved raw samples
+    std::vector< std::shared_ptr< std::vector< double > > > rawDisplayLUT; ///< 256 volt entries per channel
+    unsigned rawDisplayStride = 0; ///< byte distance between consecutive samples of a channel
+    std::vector< int16_t > triggerFP; ///< fixed point samples, volts * triggerFPgain
+    int triggerFPchannel = -1;        ///< source channel of triggerFP, -1 = not available
+    double triggerFPgain = 0.0;       ///< fixed point counts per volt
+    double samplerate = 0.0;          ///< The samplerate of the input data
+    uint64_t timestampNs = 0;         ///< monotonic clock at USB completion of the raw block
+    double effectiveSamplerate = 0.0; ///< drift corrected rate from block timestamps, 0.0 until settled
     unsigned char clipped = 0;                 ///< Bitmask of clipped channels
     bool liveTrigger = false;                  ///< live samples are triggered
     int triggeredPosition = 0;                 ///< position for a triggered trace, 0 = not triggered
+    double triggeredPositionSub = 0.0;         ///< fraction of one sample the crossing precedes triggeredPosition
     double pulseWidth1 = 0.0;                  ///< width from trigger point to next opposite slope
     double pulseWidth2 = 0.0;                  ///< width from next opposite slope to third slope
     Unit mathVoltageUnit = UNIT_VOLTS;         ///< unless UNIT_VOLTSQUARE for some math functions
     bool freeRunning = false;                  ///< trigger: NONE, half sample count
     unsigned tag = 0;                          ///< track individual sample blocks (debug support)
-    mutable QReadWriteLock lock;
+
+    /// Handshake of the lock-free snapshot rotation (one producer, one post processing
+    /// consumer). The producer rotates through several DSOsamples slots and only ever
+    /// writes into a slot that is neither the published one nor claimed by the reader;
+    /// the reader claims the announced snapshot and double checks that the producer did
+    /// not pick it meanwhile. Both sides use the default sequentially consistent order,
+    /// so at least one of them always sees the other (Dekker style) and backs off.
+    /// Each flag sits on its own cache line: they are stored by different threads, and
+    /// on a shared line every claim/release would invalidate the other side's line
+    /// together with the adjacent metadata fields.
+    alignas( 64 ) mutable std::atomic< bool > readerActive{ false }; ///< the consumer reads this slot
+    alignas( 64 ) std::atomic< bool > writerActive{ false };         ///< the producer writes this slot
+
+    /// \brief Claim this snapshot for reading, \return false if the producer got there
+    /// first - a newer snapshot is on its way then and this one would be dropped as
+    /// superseded anyway.
+    bool claimRead() const {
+        readerActive.store( true ); // announce before checking, see handshake comment above
+        if ( writerActive.load() ) {
+            readerActive.store( false );
+            return false;
+        }
+        return true;
+    }
+    void releaseRead() const { readerActive.store( false ); }
+
+    /// \brief Get a channel buffer that is safe to overwrite.
+    /// Unshares a buffer that is still referenced by a saved trace by taking a
+    /// recycled one from the pool (copy-on-write without the copy - the caller
+    /// overwrites the content anyway, and the pool keeps the frames allocation-free).
+    std::vector< double > &modifiableData( size_t channel ) {
+        std::shared_ptr< std::vector< double > > &channelData = data[ channel ];
+        if ( !channelData || channelData.use_count() > 1 )
+            channelData = BufferPool::acquire();
+        return *channelData;
+    }
 };
 
 const int SAMPLESIZE = 20000;
@@ -6,6 +6,7 @@
 namespace Dso {
 Enum< Dso::TriggerMode, Dso::TriggerMode::AUTO, Dso::TriggerMode::ROLL > TriggerModeEnum;
 Enum< Dso::Slope, Dso::Slope::Positive, Dso::Slope::Both > SlopeEnum;
+Enum< Dso::TriggerQualify, Dso::TriggerQualify::Edge, Dso::TriggerQualify::Runt > TriggerQualifyEnum;
 Enum< Dso::GraphFormat, Dso::GraphFormat::TY, Dso::GraphFormat::XY > GraphFormatEnum;
 
 /// \brief Return string representation of the given graph format.
@@ -54,6 +55,21 @@ QString triggerModeString( TriggerMode mode ) {
     return QString();
 }
 
+/// \brief Return string representation of the given trigger qualification.
+/// \param qualify The ::TriggerQualify that should be returned as string.
+/// \return The string that should be used in labels etc.
+QString triggerQualifyString( TriggerQualify qualify ) {
+    switch ( qualify ) {
+    case TriggerQualify::Edge:
+        return QCoreApplication::tr( "Edge" );
+    case TriggerQualify::Pulse:
+        return QCoreApplication::tr( "Pulse" );
+    case TriggerQualify::Runt:
+        return QCoreApplication::tr( "Runt" );
+    }
+    return QString();
+}
+
 /// \brief Return string representation of the given trigger slope.
 /// \param slope The ::Slope that should be returned as string.
 /// \return The string that should be used in labels etc.
@@ -49,6 +49,15 @@ enum class Slope : uint8_t {
 };
 extern Enum< Dso::Slope, Dso::Slope::Positive, Dso::Slope::Both > SlopeEnum;
 
+/// \enum TriggerQualify
+/// \brief Pulse qualification of the trigger edge.
+enum class TriggerQualify : uint8_t {
+    Edge = 0,  ///< Plain edge trigger, no pulse width check
+    Pulse = 1, ///< Trigger only on pulses inside the width range
+    Runt = 2   ///< Trigger only on pulses shorter than the minimum width
+};
+extern Enum< Dso::TriggerQualify, Dso::TriggerQualify::Edge, Dso::TriggerQualify::Runt > TriggerQualifyEnum;
+
 /// \enum InterpolationMode
 /// \brief The different interpolation modes for the graphs.
 enum InterpolationMode {
@@ -56,7 +65,11 @@ enum InterpolationMode {
     INTERPOLATION_LINEAR,  ///< Sample dots connected by straight lines
     INTERPOLATION_STEP,    ///< Sample dots connected by one step
     INTERPOLATION_SINC,    ///< Sample dots upsampled by bandlimited sinc
-    INTERPOLATION_COUNT    ///< Total number of interpolation modes
+    // the cheaper upsampling rungs came later and are appended here so that the
+    // stored settings index of the classic modes stays valid
+    INTERPOLATION_CATMULLROM, ///< Sample dots upsampled by a 4 tap Catmull-Rom cubic
+    INTERPOLATION_SINC_SHORT, ///< Sinc with a shorter kernel and less oversampling
+    INTERPOLATION_COUNT       ///< Total number of interpolation modes
 };
 
 /// \enum Themes
@@ -72,11 +85,13 @@ QString graphFormatString( GraphFormat format );
 QString couplingString( Coupling coupling );
 QString triggerModeString( TriggerMode mode );
 QString slopeString( Slope slope );
+QString triggerQualifyString( TriggerQualify qualify );
 // QString interpolationModeString(InterpolationMode interpolation);
 } // namespace Dso
 
 Q_DECLARE_METATYPE( Dso::TriggerMode )
 Q_DECLARE_METATYPE( Dso::Slope )
+Q_DECLARE_METATYPE( Dso::TriggerQualify )
 Q_DECLARE_METATYPE( Dso::Coupling )
 Q_DECLARE_METATYPE( Dso::GraphFormat )
 Q_DECLARE_METATYPE( Dso::ChannelMode )
@@ -3,15 +3,20 @@
 // #define TIMESTAMPDEBUG
 
 #include <QDebug>
-#include <QTimer>
 
 #include <QtCore>
 
+#include <algorithm>
+
+#include "convertsimd.h"
 #include "hantekdsocontrol.h"
 #include "hantekprotocol/controlStructs.h"
 #include "mathchannel.h"
 #include "scopesettings.h"
 #include "usb/scopedevice.h"
+#include "utils/dsotrace.h"
+#include "utils/frametrace.h"
+#include "utils/samplecodec.h"
 
 using namespace Hantek;
 using namespace Dso;
@@ -26,11 +31,15 @@ HantekDsoControl::HantekDsoControl( ScopeDevice *device, const DSOModel *model,
     qRegisterMetaType< DSOsamples * >();
     qRegisterMetaType< QList< double > >();
 
+    writeResult().writerActive.store( true ); // the initial write slot, see publishResult()
+
     if ( device && specification->fixedUSBinLength )
         device->overwriteInPacketLength( unsigned( specification->fixedUSBinLength ) );
     // Apply special requirements by the devices model
     model->applyRequirements( this );
 
+    buildLookupTables(); // the specification is final now
+
     getCalibrationFromIniFile();
 
     stateMachineRunning = true;
@@ -69,18 +78,41 @@ void HantekDsoControl::restoreTargets() {
 }
 
 
+/// Build the sorted setter lookup tables and the per-configuration samplerate
+/// step lists once; the specification never changes after applyRequirements(),
+/// so the slider-rate setters only binary search or pick a ready-made list.
+void HantekDsoControl::buildLookupTables() {
+    samplerateIndexTable.clear();
+    for ( uint8_t index = 0; index < specification->fixedSampleRates.size(); ++index )
+        samplerateIndexTable.emplace_back( long( round( specification->fixedSampleRates[ index ].samplerate ) ), index );
+    std::stable_sort( samplerateIndexTable.begin(), samplerateIndexTable.end(),
+                      []( const std::pair< long, uint8_t > &a, const std::pair< long, uint8_t > &b ) { return a.first < b.first; } );
+    gainIndexTable.clear();
+    for ( uint8_t index = 0; index < specification->gain.size(); ++index )
+        gainIndexTable.emplace_back( specification->gain[ index ].Vdiv, index );
+    std::stable_sort( gainIndexTable.begin(), gainIndexTable.end(),
+                      []( const std::pair< double, uint8_t > &a, const std::pair< double, uint8_t > &b ) { return a.first < b.first; } );
+    sampleStepsSingle.clear();
+    sampleStepsMulti.clear();
+    for ( auto &v : specification->fixedSampleRates ) {
+        if ( v.samplerate <= specification->samplerate.single.max )
+            sampleStepsSingle << v.samplerate;
+        if ( v.samplerate <= specification->samplerate.multi.max )
+            sampleStepsMulti << v.samplerate;
+    }
+}
+
+
 void HantekDsoControl::updateSamplerateLimits() {
-    QList< double > sampleSteps;
     double limit = isSingleChannel() ? specification->samplerate.single.max : specification->samplerate.multi.max;
 
     if ( controlsettings.samplerate.current > limit ) {
         setSamplerate( limit );
     }
-    for ( auto &v : specification->fixedSampleRates ) {
-        if ( v.samplerate <= limit ) {
-            sampleSteps << v.samplerate;
-        }
-    }
+    const QList< double > &sampleSteps = isSingleChannel() ? sampleStepsSingle : sampleStepsMulti;
+    if ( sampleSteps == lastSampleSteps )
+        return; // the channel configuration is unchanged, the docks already show this list
+    lastSampleSteps = sampleSteps;
     if ( verboseLevel > 3 )
         qDebug() << "   HDC::updateSamplerateLimits()" << sampleSteps;
     else if ( verboseLevel > 2 )
@@ -90,17 +122,16 @@ void HantekDsoControl::updateSamplerateLimits() {
 
 
 void HantekDsoControl::controlSetSamplerate( uint8_t sampleIndex ) {
-    static uint8_t lastIndex = 0xFF;
     uint8_t id = specification->fixedSampleRates[ sampleIndex ].id;
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::controlSetSamplerate()" << sampleIndex << "id:" << id;
     if ( verboseLevel > 3 )
         qDebug() << "   ThreadID:" << QThread::currentThreadId();
     modifyCommand< ControlSetSamplerate >( ControlCode::CONTROL_SETSAMPLERATE )->setSamplerate( id, sampleIndex );
-    if ( sampleIndex != lastIndex ) { // samplerate has changed, start new sampling
+    if ( sampleIndex != lastSamplerateIndex ) { // samplerate has changed, start new sampling
         restartSampling();
     }
-    lastIndex = sampleIndex;
+    lastSamplerateIndex = sampleIndex;
 }
 
 
@@ -116,12 +147,13 @@ Dso::ErrorCode HantekDsoControl::setSamplerate( double samplerate ) {
         controlsettings.samplerate.target.samplerate = samplerate;
         controlsettings.samplerate.target.samplerateSet = ControlSettingsSamplerateTarget::Samplerrate;
     }
-    uint8_t sampleIndex;
-    for ( sampleIndex = 0; sampleIndex < specification->fixedSampleRates.size() - 1; ++sampleIndex ) {
-        if ( long( round( specification->fixedSampleRates[ sampleIndex ].samplerate ) ) ==
-             long( round( samplerate ) ) ) // dont compare double == double
-            break;
-    }
+    // binary search the rounded rate (dont compare double == double), no match -> highest index
+    const long rounded = long( round( samplerate ) );
+    uint8_t sampleIndex = uint8_t( specification->fixedSampleRates.size() - 1 );
+    auto it = std::lower_bound( samplerateIndexTable.begin(), samplerateIndexTable.end(), rounded,
+                                []( const std::pair< long, uint8_t > &entry, long value ) { return entry.first < value; } );
+    if ( it != samplerateIndexTable.end() && it->first == rounded )
+        sampleIndex = it->second;
     controlSetSamplerate( sampleIndex );
     setDownsampling( specification->fixedSampleRates[ sampleIndex ].oversampling );
     controlsettings.samplerate.current = samplerate;
@@ -154,8 +186,10 @@ Dso::ErrorCode HantekDsoControl::setRecordTime( double duration ) {
         srLimit = ( specification->samplerate.single ).max;
     else
         srLimit = ( specification->samplerate.multi ).max;
-    // For now - we go for the SAMPLESIZE (= 20000) size sampling, defined in dsosamples.h
+    // Capture getSamplesize() samples, either the classic SAMPLESIZE (= 20000, see dsosamples.h)
+    // or the deep memory record length selected in the HorizontalDock.
     // Find highest samplerate using less equal half of these samples to obtain our duration.
+    const unsigned sampleSize = getSamplesize();
     uint8_t sampleIndex = 0;
     for ( uint8_t iii = 0; iii < specification->fixedSampleRates.size(); ++iii ) {
         double sRate = specification->fixedSampleRates[ iii ].samplerate;
@@ -163,7 +197,7 @@ Dso::ErrorCode HantekDsoControl::setRecordTime( double duration ) {
             qDebug() << "   sampleIndex:" << sampleIndex << "sRate:" << sRate << "sRate*duration:" << sRate * duration;
         // Ensure that at least 1/2 of remaining samples are available for SW trigger algorithm
         // for stability reason avoid the highest sample rate as default
-        if ( sRate < srLimit && sRate * duration <= SAMPLESIZE / 2 ) {
+        if ( sRate < srLimit && sRate * duration <= sampleSize / 2 ) {
             sampleIndex = iii;
         }
     }
@@ -242,6 +276,7 @@ Dso::ErrorCode HantekDsoControl::setChannelInverted( ChannelID channel, bool inv
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::setChannelInverted()" << channel << inverted;
     controlsettings.voltage[ channel ].inverted = inverted;
+    requestRefresh(); // the inversion is applied during conversion, reconvert the current block
     return Dso::ErrorCode::NONE;
 }
 
@@ -255,26 +290,27 @@ Dso::ErrorCode HantekDsoControl::setGain( ChannelID channel, double gain ) {
 
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::setGain()" << channel << gain;
-    static uint8_t lastGain[ 2 ] = { 0xFF, 0xFF };
     gain /= controlsettings.voltage[ channel ].probeAttn; // gain needs to be scaled by probe attenuation
-    // Find lowest gain voltage that's at least as high as the requested
-    uint8_t gainID;
-    for ( gainID = 0; gainID < specification->gain.size() - 1; ++gainID )
-        if ( specification->gain[ gainID ].Vdiv >= gain )
-            break;
+    // Find lowest gain voltage that's at least as high as the requested one,
+    // binary search in the sorted table; none high enough -> the highest step
+    uint8_t gainID = uint8_t( specification->gain.size() - 1 );
+    auto it = std::lower_bound( gainIndexTable.begin(), gainIndexTable.end(), gain,
+                                []( const std::pair< double, uint8_t > &entry, double value ) { return entry.first < value; } );
+    if ( it != gainIndexTable.end() )
+        gainID = it->second;
     uint8_t gainValue = specification->gain[ gainID ].gainValue;
     if ( channel == 0 ) {
         modifyCommand< ControlSetGain_CH1 >( ControlCode::CONTROL_SETGAIN_CH1 )->setGainCH1( gainValue, gainID );
-        if ( lastGain[ 0 ] != gainValue ) { // HW gain changed, start new samples
+        if ( lastGainValue[ 0 ] != gainValue ) { // HW gain changed, start new samples
             restartSampling();
         }
-        lastGain[ 0 ] = gainValue;
+        lastGainValue[ 0 ] = gainValue;
     } else if ( channel == 1 ) {
         modifyCommand< ControlSetGain_CH2 >( ControlCode::CONTROL_SETGAIN_CH2 )->setGainCH2( gainValue, gainID );
-        if ( lastGain[ 1 ] != gainValue ) { // HW gain changed, start new samples
+        if ( lastGainValue[ 1 ] != gainValue ) { // HW gain changed, start new samples
             restartSampling();
         }
-        lastGain[ 1 ] = gainValue;
+        lastGainValue[ 1 ] = gainValue;
     } else if ( channel == 2 ) {
         // do nothing
     } else
@@ -291,6 +327,7 @@ Dso::ErrorCode HantekDsoControl::setProbe( ChannelID channel, double probeAttn )
     controlsettings.voltage[ channel ].probeAttn = probeAttn;
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::setProbe()" << channel << probeAttn;
+    requestRefresh(); // attenuation only rescales the conversion, the raw block stays valid
     return Dso::ErrorCode::NONE;
 }
 
@@ -302,15 +339,17 @@ Dso::ErrorCode HantekDsoControl::setCoupling( ChannelID channel, Dso::Coupling c
     if ( channel >= specification->channels )
         return Dso::ErrorCode::PARAMETER;
 
-    static int lastCoupling[ 2 ] = { -1, -1 };
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::setCoupling()" << channel << int( coupling );
     if ( hasCommand( ControlCode::CONTROL_SETCOUPLING ) ) // don't send command if it is not implemented (like on the 6022)
         modifyCommand< ControlSetCoupling >( ControlCode::CONTROL_SETCOUPLING )
             ->setCoupling( channel, coupling == Dso::Coupling::DC );
     controlsettings.voltage[ channel ].coupling = coupling;
-    if ( lastCoupling[ channel ] != int( coupling ) ) { // HW coupling changed, start new samples
-        restartSampling();
+    if ( lastCoupling[ channel ] != int( coupling ) ) {
+        if ( hasCommand( ControlCode::CONTROL_SETCOUPLING ) )
+            restartSampling(); // HW coupling changed, start new samples
+        else                   // 6022: the AC coupling is emulated in the conversion,
+            requestRefresh();  // reconverting the current raw block covers the switch
     }
     lastCoupling[ channel ] = int( coupling );
     return Dso::ErrorCode::NONE;
@@ -323,17 +362,16 @@ Dso::ErrorCode HantekDsoControl::setTriggerMode( Dso::TriggerMode mode ) {
 
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::setTriggerMode()" << int( mode );
-    static Dso::TriggerMode lastMode;
     controlsettings.trigger.mode = mode;
     if ( Dso::TriggerMode::SINGLE != mode )
         enableSamplingUI();
     // trigger mode changed NONE <-> !NONE
-    if ( ( Dso::TriggerMode::ROLL == mode && Dso::TriggerMode::ROLL != lastMode ) ||
-         ( Dso::TriggerMode::ROLL != mode && Dso::TriggerMode::ROLL == lastMode ) ) {
+    if ( ( Dso::TriggerMode::ROLL == mode && Dso::TriggerMode::ROLL != lastTriggerMode ) ||
+         ( Dso::TriggerMode::ROLL != mode && Dso::TriggerMode::ROLL == lastTriggerMode ) ) {
         restartSampling(); // invalidate old samples
         raw.freeRun = Dso::TriggerMode::ROLL == mode;
     }
-    lastMode = mode;
+    lastTriggerMode = mode;
     requestRefresh();
     return Dso::ErrorCode::NONE;
 }
@@ -369,7 +407,12 @@ Dso::ErrorCode HantekDsoControl::setTriggerLevel( ChannelID channel, double leve
         return Dso::ErrorCode::PARAMETER;
     if ( verboseLevel > 2 )
         qDebug() << "  HDC::setTriggerLevel()" << channel << level;
-    controlsettings.trigger.level[ channel ] = level;
+    // Deposit the level in the mailbox instead of writing it directly, a slider
+    // drag queues one call per mouse move and the trigger search reads the level
+    // on the processing thread. applyPendingTriggerLevels() picks up the newest
+    // value once per state machine cycle.
+    pendingTriggerLevel[ channel ].store( level, std::memory_order_relaxed );
+    pendingTriggerLevelMask.fetch_or( 1U << channel, std::memory_order_release );
     requestRefresh();
     displayInterval = 0; // update screen immediately
     return Dso::ErrorCode::NONE;
@@ -399,11 +442,51 @@ Dso::ErrorCode HantekDsoControl::setTriggerPosition( double position ) {
 }
 
 
+Dso::ErrorCode HantekDsoControl::setTriggerQualify( Dso::TriggerQualify qualify ) {
+    if ( deviceNotConnected() )
+        return Dso::ErrorCode::CONNECTION;
+    if ( verboseLevel > 2 )
+        qDebug() << "  HDC::setTriggerQualify()" << int( qualify );
+    controlsettings.trigger.qualify = qualify;
+    requestRefresh();
+    return Dso::ErrorCode::NONE;
+}
+
+
+Dso::ErrorCode HantekDsoControl::setTriggerPulseWidth( double min, double max ) {
+    if ( deviceNotConnected() )
+        return Dso::ErrorCode::CONNECTION;
+    if ( verboseLevel > 2 )
+        qDebug() << "  HDC::setTriggerPulseWidth()" << min << max;
+    controlsettings.trigger.pulseWidthMin = min;
+    controlsettings.trigger.pulseWidthMax = max;
+    requestRefresh();
+    return Dso::ErrorCode::NONE;
+}
+
+
+Dso::ErrorCode HantekDsoControl::setTriggerHoldoff( double holdoff ) {
+    if ( deviceNotConnected() )
+        return Dso::ErrorCode::CONNECTION;
+    if ( verboseLevel > 2 )
+        qDebug() << "  HDC::setTriggerHoldoff()" << holdoff;
+    controlsettings.trigger.holdoff = holdoff;
+    requestRefresh();
+    return Dso::ErrorCode::NONE;
+}
+
+
 // Initialize the device with the current settings.
+// One transaction: the setters below queue their control commands (coalesced per
+// command code) and skip unchanged hardware values, the sampling is restarted at
+// most once at the end instead of once per setter - a profile switch through
+// DsoSettings::loadFromFile() no longer stops the device several times in a row.
 void HantekDsoControl::applySettings( DsoSettingsScope *dsoSettingsScope ) {
     if ( verboseLevel > 1 )
         qDebug() << " HDC::applySettings()";
     scope = dsoSettingsScope;
+    applyingSettings = true;
+    restartPending = false;
     bool mathUsed = dsoSettingsScope->anyUsed( specification->channels );
     for ( ChannelID channel = 0; channel <= specification->channels; ++channel ) {
         setProbe( channel, dsoSettingsScope->voltage[ channel ].probeAttn );
@@ -422,20 +505,89 @@ void HantekDsoControl::applySettings( DsoSettingsScope *dsoSettingsScope ) {
     setTriggerSlope( dsoSettingsScope->trigger.slope );
     setTriggerSource( dsoSettingsScope->trigger.source );
     setTriggerSmooth( dsoSettingsScope->trigger.smooth );
+    setTriggerQualify( dsoSettingsScope->trigger.qualify );
+    setTriggerPulseWidth( dsoSettingsScope->trigger.pulseWidthMin, dsoSettingsScope->trigger.pulseWidthMax );
+    setTriggerHoldoff( dsoSettingsScope->trigger.holdoff );
     mathChannel = std::unique_ptr< MathChannel >( new MathChannel( scope ) );
     triggering = std::unique_ptr< Triggering >( new Triggering( scope, controlsettings ) );
+    applyingSettings = false;
+    if ( restartPending ) { // one restart covers all changed settings
+        restartPending = false;
+        restartSampling();
+    }
 }
 
 
+// Invalidation matrix of the settings setters above. A change is either
+// raw-invalidating (the captured bytes are wrong for the new setup, restart the
+// sampling), conversion-invalidating (the raw block stays valid, reconvert it
+// via requestRefresh()) or display-only (the next paint picks it up, this class
+// is not involved):
+//   raw:        samplerate, HW gain value, HW coupling relay, channel count,
+//               roll mode transitions (ROLL <-> triggered)
+//   conversion: trigger level / slope / position / source / smooth / qualify /
+//               pulse width / holdoff, probe attenuation, channel inversion,
+//               software AC coupling (6022, no HW coupling command), gain steps
+//               that map to the same HW gain value
+//   display:    colors, zoom, cursors, graph format
+// The raw setters guard with the last sent hardware value, so repeating a
+// setting or a profile switch that ends in the same hardware state does not
+// restart and in-flight data survives.
+
 /// \brief Starts a new sampling block.
 void HantekDsoControl::restartSampling() {
-    if ( verboseLevel > 4 )
-        qDebug() << "    HDC::restartSampling()";
+    if ( applyingSettings ) { // collect the restarts of the whole transaction
+        restartPending = true;
+        return;
+    }
+    traceControl( verboseLevel > 4, "    HDC::restartSampling()" );
     scopeDevice->stopSampling();
     raw.rollMode = false;
 }
 
 
+/// \brief Step through the raw capture history while the sampling is stopped.
+void HantekDsoControl::stepHistory( int delta ) {
+    if ( isSamplingUI() || samplingStarted ) // only available after stop
+        return;
+    QMutexLocker historyLocker( &historyMutex );
+    const int available = int( rawHistory.size() );
+    if ( !available )
+        return;
+    if ( verboseLevel > 3 )
+        qDebug() << "   HDC::stepHistory()" << delta;
+    int index = historyIndex < 0 ? available - 1 : historyIndex; // the newest block is on screen
+    index = qBound( 0, index + delta, available - 1 );
+    if ( index == historyIndex )
+        return;
+    historyIndex = index;
+    const RawHistoryBlock &block = rawHistory[ size_t( index ) ];
+    {
+        QWriteLocker rawLocker( &raw.lock );
+        raw.channels = block.channels;
+        raw.samplerate = block.samplerate;
+        raw.oversampling = block.oversampling;
+        raw.gainValue[ 0 ] = block.gainValue[ 0 ];
+        raw.gainValue[ 1 ] = block.gainValue[ 1 ];
+        raw.gainIndex[ 0 ] = block.gainIndex[ 0 ];
+        raw.gainIndex[ 1 ] = block.gainIndex[ 1 ];
+        raw.tag = block.tag;
+        raw.timestampNs = block.timestampNs;
+        raw.freeRun = false;
+        raw.partial = false; // a recorded block is always complete
+        raw.valid = true;
+        raw.rollMode = block.rollMode;
+        raw.received = block.rawSize;
+        raw.data.resize( block.rawSize ); // the conversion may swap the buffer out, inflate a copy
+        SampleCodec::decompress( block.data.data(), block.data.size(), raw.data.data(), block.rawSize, block.channels );
+    }
+    emit statusMessage( tr( "History block %1 of %2" ).arg( index + 1 ).arg( available ), 0 );
+    requestRefresh();
+    historyRecall = true; // process this block although sampling is stopped
+    wakeProcessing();     // convert and display it now
+}
+
+
 /// \brief Start sampling process.
 void HantekDsoControl::enableSamplingUI( bool enabled ) {
     if ( verboseLevel > 3 )
@@ -444,7 +596,10 @@ void HantekDsoControl::enableSamplingUI( bool enabled ) {
         triggering->resetTriggeredPositionRaw(); // invalidate previous result, wait for new trigger
     else if ( controlsettings.trigger.mode == Dso::TriggerMode::ROLL )
         samplingStarted = enabled; // start / stop roll mode sampling (almost) immediately
+    if ( enabled )
+        historyIndex = -1; // back to live capturing, leave the history recall position
     samplingUI = enabled;
+    wakeCapturing(); // end the idle sleep of the capture thread immediately
     updateSamplerateLimits();
     emit showSamplingStatus( enabled );
 }
@@ -454,16 +609,120 @@ unsigned HantekDsoControl::getRecordLength() const {
     unsigned rawsize = getSamplesize();
     rawsize *= downsamplingNumber;         // take multiple samples for oversampling
     rawsize = grossSampleCount( rawsize ); // adjust for skipping of minimal 2048 leading samples
-    if ( verboseLevel > 4 )
-        qDebug() << "    HDC::getRecordLength() ->" << rawsize;
+    traceControl( verboseLevel > 4, "    HDC::getRecordLength() ->" << rawsize );
     return rawsize;
 }
 
 
+// The merged calibration state (EEPROM content + ini overrides) is cached in a small
+// binary file next to the calibration ini. A valid cache hit on reconnect of a known
+// scope skips both the ini parse and the EEPROM control transfer.
+#pragma pack( push, 1 )
+struct CalibrationCacheHeader {
+    char magic[ 8 ];       ///< "OHCALC01", includes the format version
+    uint32_t payloadBytes; ///< size of the payload after this header
+    uint32_t checksum;     ///< FNV-1a over the payload
+    uint32_t fwVersion;    ///< the cache is only valid for the same firmware
+    int64_t iniModifiedMs; ///< calibration ini mtime when cached, 0 = no ini file
+    int64_t iniSize;       ///< calibration ini size when cached
+};
+#pragma pack( pop )
+
+
+static uint32_t calibrationChecksum( const QByteArray &payload ) {
+    uint32_t hash = 2166136261UL; // FNV-1a
+    for ( char byte : payload )
+        hash = ( hash ^ uint8_t( byte ) ) * 16777619UL;
+    return hash;
+}
+
+
+QString HantekDsoControl::calibrationPath( const QString &suffix ) const {
+    // same naming and directory as the calibration ini, but without parsing it
+    QSettings probe( QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(), "probe" );
+    return QFileInfo( probe.fileName() ).path() + "/" + scopeDevice->getModel()->name + "_" + scopeDevice->getSerialNumber() +
+           "_calibration" + suffix;
+}
+
+
+bool HantekDsoControl::loadCalibrationCache() {
+    QFile cache( calibrationPath( ".cache" ) );
+    if ( !cache.open( QIODevice::ReadOnly ) )
+        return false;
+    CalibrationCacheHeader header;
+    if ( cache.read( reinterpret_cast< char * >( &header ), sizeof header ) != qint64( sizeof header ) )
+        return false;
+    if ( memcmp( header.magic, "OHCALC01", sizeof header.magic ) )
+        return false;
+    if ( header.fwVersion != scopeDevice->getFwVersion() )
+        return false;
+    QFileInfo ini( calibrationPath( ".ini" ) ); // an externally edited ini invalidates the cache
+    if ( header.iniModifiedMs != ( ini.exists() ? ini.lastModified().toMSecsSinceEpoch() : 0 ) ||
+         header.iniSize != ( ini.exists() ? ini.size() : 0 ) )
+        return false;
+    QByteArray payload = cache.read( header.payloadBytes + 1 ); // one extra byte detects trailing garbage
+    if ( uint32_t( payload.size() ) != header.payloadBytes || calibrationChecksum( payload ) != header.checksum )
+        return false;
+    QDataStream stream( payload );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    quint8 replaceEEPROM;
+    quint32 gainSteps, channels;
+    stream >> replaceEEPROM >> gainSteps >> channels;
+    if ( gainSteps != HANTEK_GAIN_STEPS || channels != HANTEK_CHANNEL_NUMBER )
+        return false;
+    // a failure below leaves partial values, the caller then falls back to
+    // the full ini + EEPROM path which overwrites all of them again
+    for ( int index = 0; index < HANTEK_GAIN_STEPS; ++index )
+        for ( int ch = 0; ch < HANTEK_CHANNEL_NUMBER; ++ch )
+            stream >> offsetCorrection[ index ][ ch ] >> gainCorrection[ index ][ ch ];
+    if ( stream.readRawData( reinterpret_cast< char * >( controlsettings.calibrationValues ), sizeof( CalibrationValues ) ) !=
+             int( sizeof( CalibrationValues ) ) ||
+         stream.status() != QDataStream::Ok )
+        return false;
+    memcpy( controlsettings.cmdGetCalibration.data(), controlsettings.calibrationValues, sizeof( CalibrationValues ) );
+    replaceCalibrationEEPROM = replaceEEPROM;
+    invalidateCalibrationCache();
+    return true;
+}
+
+
+void HantekDsoControl::saveCalibrationCache() {
+    QByteArray payload;
+    QDataStream stream( &payload, QIODevice::WriteOnly );
+    stream.setVersion( QDataStream::Qt_5_4 );
+    stream << quint8( replaceCalibrationEEPROM );
+    stream << quint32( HANTEK_GAIN_STEPS ) << quint32( HANTEK_CHANNEL_NUMBER );
+    for ( int index = 0; index < HANTEK_GAIN_STEPS; ++index )
+        for ( int ch = 0; ch < HANTEK_CHANNEL_NUMBER; ++ch )
+            stream << offsetCorrection[ index ][ ch ] << gainCorrection[ index ][ ch ];
+    stream.writeRawData( reinterpret_cast< const char * >( controlsettings.calibrationValues ), sizeof( CalibrationValues ) );
+
+    CalibrationCacheHeader header;
+    memcpy( header.magic, "OHCALC01", sizeof header.magic );
+    header.payloadBytes = uint32_t( payload.size() );
+    header.checksum = calibrationChecksum( payload );
+    header.fwVersion = scopeDevice->getFwVersion();
+    QFileInfo ini( calibrationPath( ".ini" ) );
+    header.iniModifiedMs = ini.exists() ? ini.lastModified().toMSecsSinceEpoch() : 0;
+    header.iniSize = ini.exists() ? ini.size() : 0;
+
+    QFile cache( calibrationPath( ".cache" ) );
+    if ( !cache.open( QIODevice::WriteOnly ) )
+        return; // failing to cache is no error, the next start just takes the slow path
+    cache.write( reinterpret_cast< const char * >( &header ), sizeof header );
+    cache.write( payload );
+}
+
+
 Dso::ErrorCode HantekDsoControl::getCalibrationFromIniFile() {
     // Persistent storage: unique offset/gain calibration file:
     // Linux, Unix, macOS: "$HOME/.config/OpenHantek/DSO-6022BE_NNNNNNNNNNNN_calibration.ini"
     // Windows: "%APPDATA%\OpenHantek\DSO-6022BE_NNNNNNNNNNNN_calibration.ini"
+    if ( loadCalibrationCache() ) { // known scope, merged state from the last run is still valid
+        if ( verboseLevel > 2 )
+            qDebug() << "  Calibration data from cache:" << calibrationPath( ".cache" );
+        return Dso::ErrorCode::NONE;
+    }
     QString calName = scopeDevice->getModel()->name + "_" + scopeDevice->getSerialNumber() + "_calibration";
     if ( verboseLevel > 2 )
         qDebug() << "  Calibration data:" << calName + ".ini";
@@ -503,20 +762,51 @@ Dso::ErrorCode HantekDsoControl::getCalibrationFromIniFile() {
     replaceCalibrationEEPROM = calibrationSettings->value( "replace_eeprom", false ).toBool();
     calibrationSettings->endGroup(); // eeprom
 
-    if ( replaceCalibrationEEPROM ) // values created by python tool "calibrate_6022.py" replace the EEPROM content
+    if ( replaceCalibrationEEPROM ) { // values created by python tool "calibrate_6022.py" replace the EEPROM content
         memset( controlsettings.cmdGetCalibration.data(), 0xFF, sizeof( CalibrationValues ) );
-    else // enhance the intrinsic calibration values from EEPROM
-        getCalibrationFromEEPROM();
+        memcpy( controlsettings.calibrationValues, controlsettings.cmdGetCalibration.data(), sizeof( CalibrationValues ) );
+        invalidateCalibrationCache();
+    } else { // enhance the intrinsic calibration values from EEPROM
+        if ( Dso::ErrorCode::NONE != getCalibrationFromEEPROM() )
+            return Dso::ErrorCode::CONNECTION; // do not cache an incomplete state
+    }
+    saveCalibrationCache();
 
     return Dso::ErrorCode::NONE;
 }
 
 
+HantekDsoControl::PipelineHealth HantekDsoControl::pipelineHealth() const {
+    PipelineHealth health;
+    health.shortReads = shortReadCount;
+    health.usbRetries = scopeDevice ? scopeDevice->bulkRetries() : 0;
+    health.zeroFilledBlocks = zeroFilledCount;
+    if ( triggering ) { // untriggered blocks: the scan ran over the block without an event
+        const Triggering::Stats &trigger = triggering->stats();
+        health.triggerOverruns = trigger.blocksScanned - trigger.blocksTriggered;
+    }
+    health.captureCpu = captureCpuSeen;
+    return health;
+}
+
+
+void HantekDsoControl::captureProgress( unsigned &tag, unsigned &blockBytes ) const {
+    QReadLocker locker( &raw.lock );
+    tag = raw.tag;
+    blockBytes = unsigned( raw.data.size() );
+}
+
+
 Dso::ErrorCode HantekDsoControl::updateCalibrationValues( bool useEEPROM ) {
     if ( calibrationHasChanged ) {
         if ( verboseLevel > 2 )
             qDebug() << "  Write calibration data into" << ( useEEPROM ? "EEPROM" : "iniFile" );
 
+        if ( !calibrationSettings ) // we started from the binary cache, attach the ini store now
+            calibrationSettings = std::unique_ptr< QSettings >( new QSettings(
+                QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(),
+                scopeDevice->getModel()->name + "_" + scopeDevice->getSerialNumber() + "_calibration" ) );
+
         calibrationSettings->beginGroup( "gain" );
         for ( int ch = 0; ch < HANTEK_CHANNEL_NUMBER; ++ch ) {
             calibrationSettings->beginGroup( "ch" + QString::number( ch ) );
@@ -553,6 +843,11 @@ Dso::ErrorCode HantekDsoControl::updateCalibrationValues( bool useEEPROM ) {
         calibrationSettings->setValue( "replace_eeprom", !useEEPROM );
         calibrationSettings->endGroup(); // eeprom
 
+        calibrationSettings->sync();
+        // the merged state of the next start differs from the live one (new ini values,
+        // maybe new EEPROM content), drop the cache and let that start rebuild it
+        QFile::remove( calibrationPath( ".cache" ) );
+
         if ( useEEPROM )
             writeCalibrationToEEPROM();
     }
@@ -570,6 +865,7 @@ Dso::ErrorCode HantekDsoControl::getCalibrationFromEEPROM() {
     if ( errorCode < 0 ) {
         // invalidate the calibration values.
         memset( controlsettings.calibrationValues, 0xFF, sizeof( CalibrationValues ) );
+        invalidateCalibrationCache();
         if ( scopeDevice->isRealHW() ) {
             QString message = tr( "Couldn't get calibration data from oscilloscope's EEPROM. Use a config file for calibration!" );
             qWarning() << message;
@@ -581,6 +877,7 @@ Dso::ErrorCode HantekDsoControl::getCalibrationFromEEPROM() {
         }
     }
     memcpy( controlsettings.calibrationValues, controlsettings.cmdGetCalibration.data(), sizeof( CalibrationValues ) );
+    invalidateCalibrationCache();
     if ( verboseLevel > 3 ) {
         QDebug line = qDebug().noquote();
         line << "   HDC::calibrationValues" << sizeof( CalibrationValues );
@@ -669,6 +966,7 @@ void HantekDsoControl::quitSampling() {
         qDebug() << "  HDC::quitSampling()";
     enableSamplingUI( false );
     capturing = false;
+    wakeCapturing(); // let the capture thread see the stop request at once
     scopeDevice->stopSampling();
     if ( scopeDevice->isDemoDevice() )
         return;
@@ -726,58 +1024,524 @@ static uint8_t offsetToFine( double offset ) {
 }
 
 
+/// \brief Convert one channel of contiguous oversampled raw data.
+/// The raw bytes of each output sample are accumulated in an integer (one uint32
+/// addition per byte instead of a double add) and converted once per output sample;
+/// the conversion is linear, so averaging before the scale/offset step is exact:
+/// (sum / N - offset) * scale == sum * (scale / N) - offset * scale.
+/// The oversampling factor and the channel stride are template parameters, so the
+/// compiler unrolls and vectorizes the inner loop for each factor used by
+/// fixedSampleRates and the single channel case reads one contiguous run of N bytes
+/// per output sample.
+/// \return true if any raw sample was clipped (0x00 or 0xFF).
+template < unsigned N, unsigned Stride >
+static bool convertRawOversampled( const unsigned char *in, double *out, unsigned count, double offset, double scale ) {
+    const double scaleN = scale / N;
+    const double offsetTerm = offset * scale;
+    bool clipped = false;
+    for ( unsigned index = 0; index < count; ++index, in += Stride * N ) {
+        unsigned sum = 0;
+        for ( unsigned iii = 0; iii < N; ++iii ) {
+            const unsigned rawSample = in[ iii * Stride ];
+            if ( 0x00 == rawSample || 0xFF == rawSample ) // min or max -> clipped
+                clipped = true;
+            sum += rawSample;
+        }
+        out[ index ] = double( sum ) * scaleN - offsetTerm;
+    }
+    return clipped;
+}
+
+
+/// \brief Stride dispatch for convertRawOversampled(): the 6022 delivers either one
+/// channel (stride 1) or the CH1/CH2 interleave (stride 2), both become compile time
+/// constants here.
+template < unsigned N >
+static bool convertRawOversampled( const unsigned char *in, double *out, unsigned count, unsigned stride, double offset,
+                                   double scale ) {
+    if ( 1 == stride )
+        return convertRawOversampled< N, 1 >( in, out, count, offset, scale );
+    return convertRawOversampled< N, 2 >( in, out, count, offset, scale );
+}
+
+
+/// \brief Fold one block completion timestamp into the samplerate drift fit.
+/// The cumulative sample count advances by the tag delta, so blocks dropped by the
+/// display pacing still count - the ADC delivered them, only their conversion was
+/// skipped. A nominal rate or block size change, a backwards clock (history recall)
+/// or a capture gap larger than the expected block spacing restarts the fit; roll
+/// mode re-conversions of the same block (same timestamp) are folded only once.
+/// \param tag The raw block tag, one increment per captured block.
+/// \param timestampNs Monotonic completion time of the block, see Raw::timestampNs.
+/// \param blockSamples Effective samples per channel and block.
+/// \param nominalRate The nominal effective samplerate derived from the FX2 crystal.
+/// \return The fitted samplerate, 0.0 until enough contiguous blocks are available.
+double HantekDsoControl::updateEffectiveSamplerate( unsigned tag, uint64_t timestampNs, unsigned blockSamples,
+                                                    double nominalRate ) {
+    if ( 0 == timestampNs || nominalRate <= 0.0 || 0 == blockSamples ) {
+        measuredSamplerate.store( 0.0 );
+        return 0.0; // no hardware timestamp for this block
+    }
+    if ( nominalRate != rateFitNominal || blockSamples != rateFitBlockSize || timestampNs < rateFitLastNs ) {
+        rateFitNominal = nominalRate;
+        rateFitBlockSize = blockSamples;
+        rateFitEntries = 0;
+        measuredSamplerate.store( 0.0 );
+    }
+    if ( timestampNs == rateFitLastNs )
+        return measuredSamplerate.load(); // refresh or roll re-conversion of the same block
+    const unsigned tagDelta = tag - rateFitLastTag;
+    if ( rateFitEntries ) {
+        // a gap well beyond the expected block spacing means the stream was not
+        // contiguous (capture hold-off, ADC re-arm after a short block) - restart
+        const double expectedNs = 1e9 * tagDelta * blockSamples / nominalRate;
+        if ( 0 == tagDelta || double( timestampNs - rateFitLastNs ) > 2.5 * expectedNs )
+            rateFitEntries = 0;
+        else
+            rateFitCumulative += double( tagDelta ) * blockSamples;
+    }
+    if ( 0 == rateFitEntries ) { // (re)start the fit with this block as origin
+        rateFitHead = 0;
+        rateFitCumulative = 0.0;
+        measuredSamplerate.store( 0.0 );
+    }
+    rateFitLastTag = tag;
+    rateFitLastNs = timestampNs;
+    rateFitNs[ rateFitHead ] = timestampNs;
+    rateFitSamples[ rateFitHead ] = rateFitCumulative;
+    rateFitHead = ( rateFitHead + 1 ) % rateFitSlots;
+    if ( rateFitEntries < rateFitSlots )
+        ++rateFitEntries;
+    if ( rateFitEntries < 4 )
+        return 0.0; // too few points for a meaningful slope
+    // least squares slope of the cumulative sample count over the time since the
+    // oldest point; the relative times keep the sums small and the slope precise
+    const unsigned oldest = ( rateFitHead + rateFitSlots - rateFitEntries ) % rateFitSlots;
+    const uint64_t originNs = rateFitNs[ oldest ];
+    double sumT = 0.0, sumS = 0.0, sumTT = 0.0, sumTS = 0.0;
+    for ( unsigned iii = 0; iii < rateFitEntries; ++iii ) {
+        const unsigned index = ( oldest + iii ) % rateFitSlots;
+        const double t = 1e-9 * double( rateFitNs[ index ] - originNs );
+        const double s = rateFitSamples[ index ];
+        sumT += t;
+        sumS += s;
+        sumTT += t * t;
+        sumTS += t * s;
+    }
+    const double points = double( rateFitEntries );
+    const double det = points * sumTT - sumT * sumT;
+    if ( det <= 0.0 )
+        return 0.0; // all timestamps identical, no usable time base
+    const double fitted = ( points * sumTS - sumT * sumS ) / det;
+    measuredSamplerate.store( fitted );
+    traceControl( verboseLevel > 5, "     HDC::updateEffectiveSamplerate()" << fitted << "nominal" << nominalRate );
+    return fitted;
+}
+
+
+/// \brief The crossing scan of countZeroCrossings() with the channel stride as a
+/// compile time constant, dispatched once per block like the conversion kernels:
+/// the single channel scan walks the raw bytes contiguously, the interleaved scan
+/// gets a fixed stride the compiler folds into the addressing.
+/// \return The hysteresis state after the block.
+template < unsigned Stride >
+static int scanZeroCrossings( const unsigned char *in, unsigned count, int low, int high, int state, uint64_t base,
+                              bool &haveCross, uint64_t &firstCross, uint64_t &lastCross, uint64_t &cycles ) {
+    for ( unsigned index = 0; index < count; ++index, in += Stride ) {
+        const int sample = *in;
+        if ( sample <= low )
+            state = -1;
+        else if ( sample >= high && state < 0 ) { // armed below, rising through the band
+            state = 1;
+            if ( haveCross )
+                ++cycles;
+            else {
+                haveCross = true;
+                firstCross = base + index;
+            }
+            lastCross = base + index;
+        }
+    }
+    return state;
+}
+
+
+/// \brief Fold one contiguous raw block into the continuous zero crossing counter.
+/// Counts rising crossings of the calibrated zero level with a small hysteresis band
+/// (integer compares on the raw bytes, no conversion involved) and reads the counter
+/// out reciprocally - cycles divided by the exact first-to-last crossing span - once
+/// per one second gate. Runs per channel, possibly on the concurrent CH2 worker; the
+/// state lives in per channel structs, so the passes never touch shared data.
+/// \param channel The channel, selects the FreqCounter state.
+/// \param in First raw byte of this channel in the block.
+/// \param count Raw samples of this channel in the block.
+/// \param stride Byte distance of consecutive samples (the active channel count).
+/// \param zeroLevel The calibrated zero of the channel in raw counts.
+/// \param tag The block tag; a refresh re-conversion is skipped, a gap restarts.
+/// \param samplerate The raw samplerate, the time base of the readout.
+void HantekDsoControl::countZeroCrossings( ChannelID channel, const unsigned char *in, unsigned count, unsigned stride,
+                                           double zeroLevel, unsigned tag, double samplerate ) {
+    FreqCounter &fc = freqCounter[ channel ];
+    if ( tag == fc.lastTag )
+        return; // a refresh re-conversion of an already counted block
+    const bool contiguous = tag - fc.lastTag == 1 && samplerate == fc.samplerate;
+    fc.lastTag = tag;
+    if ( !contiguous ) { // capture gap or reconfiguration: restart the stream
+        fc.samplerate = samplerate;
+        fc.state = 0;
+        fc.haveCross = false;
+        fc.sampleIndex = 0;
+        fc.cycles = 0;
+        fc.frequency = 0.0;
+    }
+    const int zero = int( lround( zeroLevel ) );
+    const int low = zero - 2, high = zero + 2; // +-2 count hysteresis against noise
+    const uint64_t base = fc.sampleIndex;
+    // the 6022 delivers one channel (stride 1) or the CH1/CH2 interleave (stride 2)
+    if ( 1 == stride ) // single channel: contiguous bytes, the common 30 MS/s setup
+        fc.state = scanZeroCrossings< 1 >( in, count, low, high, fc.state, base, fc.haveCross, fc.firstCross, fc.lastCross,
+                                           fc.cycles );
+    else
+        fc.state = scanZeroCrossings< 2 >( in, count, low, high, fc.state, base, fc.haveCross, fc.firstCross, fc.lastCross,
+                                           fc.cycles );
+    fc.sampleIndex += count;
+    const double gateSamples = fc.samplerate; // one second gate
+    if ( fc.haveCross && fc.cycles && double( fc.sampleIndex - fc.firstCross ) >= gateSamples ) {
+        fc.frequency = double( fc.cycles ) * fc.samplerate / double( fc.lastCross - fc.firstCross );
+        fc.firstCross = fc.lastCross; // gates share their border crossing, no dead time
+        fc.cycles = 0;
+    } else if ( double( fc.sampleIndex - ( fc.haveCross ? fc.lastCross : base ) ) > 10 * gateSamples ) {
+        fc.frequency = 0.0; // the signal stopped crossing: DC or slower than 0.1 Hz
+        fc.haveCross = false;
+        fc.cycles = 0;
+    }
+}
+
+
+/// \brief Accumulate trigger aligned frames into an incremental running average.
+/// Noise reduction without keeping N frames in memory: each channel carries one
+/// running sum in the coordinates of the first (anchor) frame, every new triggered
+/// frame is aligned against the anchor with its sub sample trigger phase (linear
+/// interpolation, one multiply-add per sample) and added. While warming up the sum
+/// is a plain sum divided by the frame count, at the target depth it switches to
+/// exponential forgetting so the display keeps following slow signal changes.
+/// \param result The converted and trigger searched block, averaged in place.
+/// \return true if result now holds the averaged trace (the caller must recompute
+/// the math channel from it), false if the frame passed through unchanged.
+bool HantekDsoControl::accumulateAverage( DSOsamples &result ) {
+    const unsigned target = scope ? scope->horizontal.acquireAverage : 1;
+    if ( target < 2 || !result.liveTrigger || result.triggeredPosition <= 0 ) {
+        avgCount = 0; // an untriggered frame would smear the sum, restart at the next hit
+        return false;
+    }
+    const unsigned channels = qMin( activeChannels, unsigned( result.data.size() ) );
+    const size_t size = channels && result.data[ 0 ] ? result.data[ 0 ]->size() : 0;
+    const int margin = 8; // headroom on both sides for the alignment shift
+    if ( !channels || size < unsigned( 4 * margin ) ) {
+        avgCount = 0;
+        return false;
+    }
+    if ( channels != avgChannels || size != avgSize || result.samplerate != avgSamplerate || target != avgTarget )
+        avgCount = 0; // any configuration change invalidates the accumulated frames
+    double shift = 0.0; // of this frame against the anchor, in (fractional) samples
+    if ( avgCount ) {
+        shift = ( double( result.triggeredPosition ) - result.triggeredPositionSub ) - ( double( avgAnchor ) - avgAnchorSub );
+        if ( fabs( shift ) > double( margin - 1 ) )
+            avgCount = 0; // the trigger point jumped beyond the headroom, e.g. a timebase change
+    }
+    if ( !avgCount ) { // seed the sum with the current frame, it becomes the anchor
+        avgChannels = channels;
+        avgSize = size;
+        avgSamplerate = result.samplerate;
+        avgTarget = target;
+        avgAnchor = result.triggeredPosition;
+        avgAnchorSub = result.triggeredPositionSub;
+        avgSum.resize( channels );
+        for ( ChannelID channel = 0; channel < channels; ++channel ) {
+            if ( result.data[ channel ] )
+                avgSum[ channel ].assign( result.data[ channel ]->begin(), result.data[ channel ]->end() );
+            else
+                avgSum[ channel ].assign( size, 0.0 );
+        }
+        avgCount = 1;
+        return false; // a single frame displays as is
+    }
+    const int off = int( floor( shift ) );
+    const double frac = shift - off; // in [0, 1), weight of the right neighbour sample
+    // plain sum while warming up, exponential forgetting at the target depth
+    const double decay = avgCount >= target ? double( target - 1 ) / double( target ) : 1.0;
+    for ( ChannelID channel = 0; channel < channels; ++channel ) {
+        if ( !result.data[ channel ] )
+            continue;
+        const std::vector< double > &in = *result.data[ channel ];
+        std::vector< double > &sum = avgSum[ channel ];
+        for ( size_t index = unsigned( margin ); index < size - unsigned( margin ); ++index )
+            sum[ index ] = sum[ index ] * decay + in[ index + size_t( off ) ] * ( 1.0 - frac ) //
+                           + in[ index + size_t( off ) + 1 ] * frac;
+    }
+    if ( avgCount < target )
+        ++avgCount;
+    // Write the averaged trace back; the edge samples inside the margin just repeat
+    // the border value, they are outside of the displayed window anyway.
+    for ( ChannelID channel = 0; channel < channels; ++channel ) {
+        if ( !result.data[ channel ] )
+            continue;
+        std::vector< double > &out = result.modifiableData( channel );
+        out.resize( size );
+        const std::vector< double > &sum = avgSum[ channel ];
+        const double scale = 1.0 / avgCount;
+        for ( size_t index = unsigned( margin ); index < size - unsigned( margin ); ++index )
+            out[ index ] = sum[ index ] * scale;
+        for ( int index = 0; index < margin; ++index )
+            out[ unsigned( index ) ] = out[ unsigned( margin ) ];
+        for ( size_t index = size - unsigned( margin ); index < size; ++index )
+            out[ index ] = out[ size - unsigned( margin ) - 1 ];
+        if ( channel < result.stats.size() ) { // refresh the cached statistics of the averaged trace
+            DSOsamples::ChannelStats &channelStats = result.stats[ channel ];
+            sampleStatsSimd( out.data(), unsigned( size ), channelStats.mean, channelStats.rms, channelStats.vmin,
+                             channelStats.vmax );
+            // counterFrequency stays valid, the zero crossing counter runs on the raw stream
+        }
+    }
+    // the average lives in anchor coordinates, the trigger marks move with it
+    result.triggeredPosition = avgAnchor;
+    result.triggeredPositionSub = avgAnchorSub;
+    return true;
+}
+
+
+/// \brief Accumulate a per sample min/max envelope across trigger aligned frames.
+/// An always-on amplitude excursion catcher: each triggered frame widens the band
+/// where the signal exceeded what was seen before, a one-shot glitch stays visible
+/// until the accumulation restarts. One compare per sample and bound, the band is
+/// handed downstream as two extra traces that the graph generator renders behind
+/// the live trace. The frames align on the trigger position (nearest sample, an
+/// interpolated min/max would shrink the very excursions this mode hunts for);
+/// only the overlapping part of a shifted frame contributes, so a slowly drifting
+/// trigger never discards the collected band.
+/// \param result The converted and trigger searched block, band buffers filled.
+void HantekDsoControl::accumulateEnvelope( DSOsamples &result ) {
+    if ( !scope || !scope->horizontal.acquireEnvelope ) {
+        envValid = false;
+        result.envelopeMin.clear(); // no band downstream
+        result.envelopeMax.clear();
+        return;
+    }
+    const unsigned channels = qMin( activeChannels, unsigned( result.data.size() ) );
+    const size_t size = channels && result.data[ 0 ] ? result.data[ 0 ]->size() : 0;
+    const int margin = 8; // headroom for the alignment shift, as with the averaging
+    if ( !channels || size < unsigned( 4 * margin ) || result.triggeredPosition <= 0 ) {
+        result.envelopeMin.clear(); // nothing to accumulate without a trigger anchor
+        result.envelopeMax.clear();
+        return;
+    }
+    if ( envValid && ( channels != envChannels || size != envSize || result.samplerate != envSamplerate ) )
+        envValid = false; // any configuration change restarts the accumulation
+    // fractional trigger phase of this frame against the integer anchor
+    const double phase = ( double( result.triggeredPosition ) - result.triggeredPositionSub ) - double( envAnchor );
+    if ( result.liveTrigger ) { // a frozen frame (NORMAL mode redraw) only re-renders the band
+        if ( !envValid ) {      // seed with the current frame, it becomes the anchor
+            envChannels = channels;
+            envSize = size;
+            envSamplerate = result.samplerate;
+            envAnchor = result.triggeredPosition;
+            envMin.resize( channels );
+            envMax.resize( channels );
+            for ( ChannelID channel = 0; channel < channels; ++channel ) {
+                if ( result.data[ channel ] ) {
+                    envMin[ channel ].assign( result.data[ channel ]->begin(), result.data[ channel ]->end() );
+                    envMax[ channel ] = envMin[ channel ];
+                } else {
+                    envMin[ channel ].assign( size, 0.0 );
+                    envMax[ channel ].assign( size, 0.0 );
+                }
+            }
+            envValid = true;
+        } else {
+            const long shift = lround( phase );
+            // only the overlapping region of the shifted frame contributes
+            const long jBegin = std::max( long( margin ), -shift );
+            const long jEnd = std::min( long( size ) - margin, long( size ) - shift );
+            for ( ChannelID channel = 0; channel < channels; ++channel ) {
+                if ( !result.data[ channel ] || envMin[ channel ].size() != size )
+                    continue;
+                const double *in = result.data[ channel ]->data();
+                double *eMin = envMin[ channel ].data();
+                double *eMax = envMax[ channel ].data();
+                for ( long j = jBegin; j < jEnd; ++j ) { // plain compares, auto vectorizes
+                    const double sample = in[ j + shift ];
+                    if ( sample < eMin[ j ] )
+                        eMin[ j ] = sample;
+                    if ( sample > eMax[ j ] )
+                        eMax[ j ] = sample;
+                }
+            }
+        }
+    }
+    if ( !envValid ) { // never seeded, e.g. NORMAL mode presenting an old trace only
+        result.envelopeMin.clear();
+        result.envelopeMax.clear();
+        return;
+    }
+    // Hand the band over in the coordinates of the presented trace so the graph
+    // generator can use the common trigger alignment; the buffers come from the
+    // shared pool and are handed downstream like the channel buffers.
+    const long shiftOut = lround( phase );
+    result.envelopeMin.resize( channels );
+    result.envelopeMax.resize( channels );
+    for ( ChannelID channel = 0; channel < channels; ++channel ) {
+        std::shared_ptr< std::vector< double > > &outMinPtr = result.envelopeMin[ channel ];
+        std::shared_ptr< std::vector< double > > &outMaxPtr = result.envelopeMax[ channel ];
+        if ( envMin[ channel ].size() != size ) { // channel not accumulated
+            outMinPtr.reset();
+            outMaxPtr.reset();
+            continue;
+        }
+        if ( !outMinPtr || outMinPtr.use_count() > 1 ) // unshare, a snapshot may still reference it
+            outMinPtr = BufferPool::acquire();
+        if ( !outMaxPtr || outMaxPtr.use_count() > 1 )
+            outMaxPtr = BufferPool::acquire();
+        std::vector< double > &outMin = *outMinPtr;
+        std::vector< double > &outMax = *outMaxPtr;
+        outMin.resize( size );
+        outMax.resize( size );
+        const double *eMin = envMin[ channel ].data();
+        const double *eMax = envMax[ channel ].data();
+        for ( size_t index = 0; index < size; ++index ) {
+            long j = long( index ) - shiftOut; // clamp the edges inside the margin
+            if ( j < margin )
+                j = margin;
+            else if ( j >= long( size ) - margin )
+                j = long( size ) - margin - 1;
+            outMin[ index ] = eMin[ j ];
+            outMax[ index ] = eMax[ j ];
+        }
+    }
+}
+
+
 void HantekDsoControl::convertRawDataToSamples() {
-    QReadLocker rawLocker( &raw.lock );
+    QWriteLocker rawLocker( &raw.lock );
     activeChannels = raw.channels;
+    if ( !activeChannels )
+        return;
     const unsigned rawSampleCount = unsigned( raw.data.size() ) / activeChannels;
     if ( !rawSampleCount )
         return;
     const unsigned rawOversampling = raw.oversampling;
-    const bool freeRunning = rawSampleCount / rawOversampling < SAMPLESIZE; // amount needed for sw trigger
+    // amount needed for sw trigger, either the classic SAMPLESIZE or the deep memory record length
+    const unsigned triggerSampleCount =
+        ( scope && scope->horizontal.recordLength > 0 ) ? unsigned( scope->horizontal.recordLength ) : SAMPLESIZE;
+    const bool freeRunning = rawSampleCount / rawOversampling < triggerSampleCount;
     const unsigned sampleCount = freeRunning ? rawSampleCount : netSampleCount( rawSampleCount );
-    const unsigned resultSamples = freeRunning ? sampleCount / rawOversampling - 1 : sampleCount / rawOversampling;
+    unsigned resultSamples = freeRunning ? sampleCount / rawOversampling - 1 : sampleCount / rawOversampling;
     const unsigned skipSamples = rawSampleCount - sampleCount;
-    if ( verboseLevel > 4 )
-        qDebug() << "    HDC::convertRawDataToSamples()" << raw.tag;
-    QWriteLocker resultLocker( &result.lock );
+    const bool rollFreeRun = raw.freeRun;
+    const bool rawPartial = raw.partial;
+    const bool rollMode = raw.rollMode;
+    const unsigned rawReceived = raw.received;
+    const unsigned rawTag = raw.tag;
+    const uint64_t rawTimestampNs = raw.timestampNs;
+    const double rawSamplerate = raw.samplerate;
+    const unsigned rawGainIndex[ 2 ] = { raw.gainIndex[ 0 ], raw.gainIndex[ 1 ] };
+    const unsigned rawGainValue[ 2 ] = { raw.gainValue[ 0 ], raw.gainValue[ 1 ] };
+    traceControl( verboseLevel > 4, "    HDC::convertRawDataToSamples()" << raw.tag );
+    // A partial (progressive) block converts only the samples delivered so far, the
+    // trace grows from the left edge with every processing tick until it completes.
+    if ( rawPartial ) {
+        const unsigned receivedSamples = rawReceived / activeChannels;
+        const unsigned receivedGroups =
+            receivedSamples > skipSamples ? ( receivedSamples - skipSamples ) / rawOversampling : 0;
+        resultSamples = qMin( resultSamples, receivedGroups );
+        if ( !resultSamples )
+            return; // nothing displayable yet, keep the previous frame
+    }
+    // In normal capture mode take the block out of the shared structure and release the lock,
+    // so the conversion never blocks the capture thread delivering the next pool slot.
+    // In roll (free run) mode and during a partial (progressive) block the capture
+    // thread samples directly into raw.data, keep the lock.
+    if ( !rollFreeRun && !rawPartial ) {
+        rawBuffer.swap( raw.data );
+        rawLocker.unlock();
+    }
+    const std::vector< unsigned char > &rawData = ( rollFreeRun || rawPartial ) ? raw.data : rawBuffer;
+    DSOsamples &result = writeResult(); // current write slot, not visible to any reader
     result.freeRunning = freeRunning;
-    result.tag = raw.tag;
-    result.samplerate = raw.samplerate / raw.oversampling;
-    // Prepare result buffers
+    result.tag = rawTag;
+    result.samplerate = rawSamplerate / rawOversampling;
+    // A partial block keeps the timestamp and fit of the last completed one, its own
+    // USB completion time is not known yet (the same timestamp would be folded into
+    // the drift fit twice otherwise).
+    result.timestampNs = rawPartial ? 0 : rawTimestampNs;
+    result.effectiveSamplerate =
+        rawPartial ? measuredSamplerate.load()
+                   : updateEffectiveSamplerate( rawTag, rawTimestampNs, rawSampleCount / rawOversampling, result.samplerate );
+    // Prepare result buffers; the converted channels are resized in place and completely
+    // overwritten below, only the unused channels are emptied (capacity stays allocated).
+    // This avoids the full zero-fill of a clear() + resize() round trip on every block.
     result.data.resize( specification->channels + 1 ); // CH0, CH1, MATH
-    for ( ChannelID channelCounter = 0; channelCounter <= specification->channels; ++channelCounter )
-        result.data[ channelCounter ].clear();
+    for ( ChannelID channelCounter = activeChannels; channelCounter <= specification->channels; ++channelCounter )
+        result.modifiableData( channelCounter ).clear();
+
+    // Geometry of the incremental roll mode ring; any change invalidates the
+    // converted groups, leaving roll mode releases them until the next entry.
+    if ( rollFreeRun && rollMode ) {
+        const unsigned ringGroups = rawSampleCount / rawOversampling;
+        if ( ringGroups != rollRingGroups || rawOversampling != rollGroupSize ) {
+            rollRingGroups = ringGroups;
+            rollGroupSize = rawOversampling;
+            for ( ChannelID channel = 0; channel < HANTEK_CHANNEL_NUMBER; ++channel ) {
+                rollRing[ channel ].assign( ringGroups, 0.0 );
+                rollRingValid[ channel ] = false;
+            }
+        }
+    } else if ( rollRingGroups ) { // stale after any non-roll block in between
+        rollRingGroups = 0;
+        for ( ChannelID channel = 0; channel < HANTEK_CHANNEL_NUMBER; ++channel )
+            rollRingValid[ channel ] = false;
+    }
 
     // Convert channel data
-    // Channels are using their separate buffers
-    for ( ChannelID channel = 0; channel < activeChannels; ++channel ) {
-        const unsigned gainIndex = raw.gainIndex[ channel ];
+    // Channels are using their separate buffers, so the conversions are independent
+    // and can run concurrently; the clipping flag is reported back to the caller.
+    auto convertChannel = [ & ]( ChannelID channel ) -> bool {
+        bool clipped = false;
+        const unsigned gainIndex = rawGainIndex[ channel ];
         const double voltageScale = specification->voltageScale[ channel ][ gainIndex ];
         const double probeAttn = controlsettings.voltage[ channel ].probeAttn;
         const double sign = controlsettings.voltage[ channel ].inverted ? -1.0 : 1.0;
 
         // shift + individual offset for each channel and gain
         // get offset value from eeprom[ 8 .. 39 and (if available) 56 .. 87]
-        uint8_t offsetRaw;
-        uint8_t offsetFine;
-        if ( result.samplerate < 30e6 ) {
-            offsetRaw = controlsettings.calibrationValues->off.ls.step[ gainIndex ][ channel ];
-            offsetFine = controlsettings.calibrationValues->fine.ls.step[ gainIndex ][ channel ];
-        } else {
-            offsetRaw = controlsettings.calibrationValues->off.hs.step[ gainIndex ][ channel ];
-            offsetFine = controlsettings.calibrationValues->fine.hs.step[ gainIndex ][ channel ];
+        // the derived values are cached, a refresh is only needed when the gain
+        // index, the samplerate band or the calibration data have changed
+        CalibrationCache &cal = calibrationCache[ channel ];
+        const bool highSpeed = result.samplerate >= 30e6;
+        if ( cal.gainIndex != gainIndex || cal.highSpeed != highSpeed ) {
+            uint8_t offsetFine;
+            if ( !highSpeed ) {
+                cal.offsetRaw = controlsettings.calibrationValues->off.ls.step[ gainIndex ][ channel ];
+                offsetFine = controlsettings.calibrationValues->fine.ls.step[ gainIndex ][ channel ];
+            } else {
+                cal.offsetRaw = controlsettings.calibrationValues->off.hs.step[ gainIndex ][ channel ];
+                offsetFine = controlsettings.calibrationValues->fine.hs.step[ gainIndex ][ channel ];
+            }
+            cal.offsetCalibration = bytesToOffset( cal.offsetRaw, offsetFine );
+            cal.gainCalibration = byteToGain( controlsettings.calibrationValues->gain.step[ gainIndex ][ channel ] );
+            cal.gainIndex = gainIndex;
+            cal.highSpeed = highSpeed;
         }
         // calibration values from EEPROM
-        channelOffset[ channel ] = offsetRaw;
-        double offsetCalibration = bytesToOffset( offsetRaw, offsetFine );
-        double gainCalibration = byteToGain( controlsettings.calibrationValues->gain.step[ gainIndex ][ channel ] );
+        channelOffset[ channel ] = cal.offsetRaw;
+        double offsetCalibration = cal.offsetCalibration;
+        double gainCalibration = cal.gainCalibration;
         // Convert data from the oscilloscope and write it into the channel sample buffer
         unsigned rawBufPos = 0;
-        if ( raw.freeRun && raw.rollMode ) // show the "new" samples on the right screen side
-            rawBufPos = raw.received;      // start with remaining "old" samples in buffer
-        result.data[ channel ].resize( resultSamples );
+        if ( rollFreeRun && rollMode ) // show the "new" samples on the right screen side
+            rawBufPos = rawReceived;   // start with remaining "old" samples in buffer
+        std::vector< double > &channelData = result.modifiableData( channel ); // unshare a saved trace
+        channelData.resize( resultSamples );
         rawBufPos += skipSamples * activeChannels; // skip first unstable samples
-        result.clipped &= ~( 0x01 << channel );    // clear clipping flag
 
         double gainCorr = gainCorrection[ gainIndex ][ channel ];
         double offsetCorr = offsetCorrection[ gainIndex ][ channel ];
@@ -786,19 +1550,198 @@ void HantekDsoControl::convertRawDataToSamples() {
         int minValue = 0xFF;
         int maxValue = 0x00;
 
+        // The whole per-sample math collapses into one multiply-add: (raw - offset) * scale
+        const double lutScale = sign * gainCorr * gainCalibration * probeAttn / voltageScale;
+        // Software AC coupling: the coupling command has no effect on the 6022 (see
+        // setCoupling()), so an AC selection subtracts the running signal mean instead.
+        // The mean rides in the conversion offset (converted to raw ADC counts), which
+        // keeps the subtraction itself free - every conversion kernel, the byte -> volts
+        // LUT, the trigger fixed point trace and the zero crossing counter pick it up
+        // through the one multiply-add they do anyway.
+        const bool acCoupled =
+            controlsettings.voltage[ channel ].coupling == Dso::Coupling::AC && !scope->liveCalibrationActive;
+        if ( acCoupled != acCoupleActive[ channel ] ) { // coupling switched, restart the servo
+            acCoupleMean[ channel ] = 0.0;
+            acCoupleSeeded[ channel ] = false;
+            acCoupleActive[ channel ] = acCoupled;
+        }
+        const double lutOffset = offsetCalibration + offsetCorr + acCoupleMean[ channel ] / lutScale;
+        // Map each possible raw ADC byte directly to its scaled voltage; the table is
+        // rebuilt only when a gain switch, a calibration update or a probe setting
+        // changes the combined offset or scale of this channel.
+        double *lut = convLUT[ channel ];
+        if ( lutOffset != convLUToffset[ channel ] || lutScale != convLUTscale[ channel ] ) {
+            for ( int value = 0; value < 256; ++value )
+                lut[ value ] = ( double( value ) - lutOffset ) * lutScale;
+            convLUToffset[ channel ] = lutOffset;
+            convLUTscale[ channel ] = lutScale;
+            rollRingValid[ channel ] = false; // already converted roll groups use the old scale
+        }
+
+        // Continuous frequency counter on the raw bytes; incrementally growing blocks
+        // (roll, partial) and recalls are skipped, they would fold samples twice.
+        if ( samplingStarted && !rollFreeRun && !rawPartial && !scope->liveCalibrationActive )
+            countZeroCrossings( channel, rawData.data() + channel, rawSampleCount, activeChannels, lutOffset, rawTag,
+                                rawSamplerate );
+
+        // Fast paths for the normal capture; live calibration needs the per-sample
+        // statistics of the classic scalar loop below.
+        if ( !scope->liveCalibrationActive ) {
+            const bool contiguousBlock = !( rollFreeRun && rollMode ) &&
+                                         rawBufPos + resultSamples * rawOversampling * activeChannels <=
+                                             unsigned( rawData.size() );
+            if ( 1 == rawOversampling && contiguousBlock ) {
+                // contiguous data without oversampling: vectorized kernel
+                clipped = convertRawSimd( rawData.data() + rawBufPos + channel, channelData.data(), resultSamples,
+                                          activeChannels, lutOffset, lutScale );
+            } else if ( contiguousBlock ) {
+                // contiguous oversampled data: integer accumulation, specialized for
+                // each oversampling factor of fixedSampleRates (x10 and up are the
+                // low-rate modes where slow machines drop frames)
+                const unsigned char *in = rawData.data() + rawBufPos + channel;
+                double *out = channelData.data();
+                switch ( rawOversampling ) {
+                case 2:
+                    clipped = convertRawOversampled< 2 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                case 5:
+                    clipped = convertRawOversampled< 5 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                case 10:
+                    clipped = convertRawOversampled< 10 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                case 20:
+                    clipped = convertRawOversampled< 20 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                case 50:
+                    clipped = convertRawOversampled< 50 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                case 100:
+                    clipped = convertRawOversampled< 100 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                case 200:
+                    clipped = convertRawOversampled< 200 >( in, out, resultSamples, activeChannels, lutOffset, lutScale );
+                    break;
+                default: // unexpected factor: one table load per raw byte
+                    for ( unsigned index = 0; index < resultSamples; ++index ) {
+                        double sample = 0.0;
+                        for ( unsigned iii = 0; iii < rawOversampling * activeChannels; iii += activeChannels ) {
+                            int rawSample = rawData[ rawBufPos + channel + iii ]; // CH1/CH2/CH1/CH2 ...
+                            if ( rawSample == 0x00 || rawSample == 0xFF )        // min or max -> clipped
+                                clipped = true;
+                            sample += lut[ rawSample ];
+                        }
+                        channelData[ index ] = sample / rawOversampling;
+                        rawBufPos += activeChannels * rawOversampling;
+                    }
+                    break;
+                }
+            } else {
+                // Incremental roll conversion: the ring holds one converted value per
+                // oversampling group, aligned to the raw buffer, so only the groups
+                // captured since the last cycle are converted. The display order
+                // (oldest left, write head right) is assembled with two plain copies
+                // instead of re-converting the whole circular buffer every frame.
+                const unsigned over = rawOversampling;
+                const unsigned ringGroups = rollRingGroups;
+                const unsigned recvGroups = qMin( rawReceived / activeChannels / over, ringGroups );
+                if ( rawTag - rollLastTag[ channel ] > 1 ) // the capture lapped the display
+                    rollRingValid[ channel ] = false;
+                const bool wrapped = rawTag != rollLastTag[ channel ]; // a new capture pass began
+                rollLastTag[ channel ] = rawTag;
+                std::vector< double > &ring = rollRing[ channel ];
+                // convert the groups [ from, to ) of this channel into the ring
+                auto convertGroups = [ & ]( unsigned from, unsigned to ) {
+                    if ( from >= to )
+                        return;
+                    const unsigned char *in = rawData.data() + from * over * activeChannels + channel;
+                    double *out = ring.data() + from;
+                    const unsigned count = to - from;
+                    switch ( over ) { // clipping is tracked buffer-wide below
+                    case 1:
+                        convertRawSimd( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 2:
+                        convertRawOversampled< 2 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 5:
+                        convertRawOversampled< 5 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 10:
+                        convertRawOversampled< 10 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 20:
+                        convertRawOversampled< 20 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 50:
+                        convertRawOversampled< 50 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 100:
+                        convertRawOversampled< 100 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    case 200:
+                        convertRawOversampled< 200 >( in, out, count, activeChannels, lutOffset, lutScale );
+                        break;
+                    default: // unexpected factor: one table load per raw byte
+                        for ( unsigned group = from; group < to; ++group ) {
+                            const unsigned char *groupIn = rawData.data() + group * over * activeChannels + channel;
+                            double sample = 0.0;
+                            for ( unsigned iii = 0; iii < over; ++iii )
+                                sample += lut[ groupIn[ iii * activeChannels ] ];
+                            ring[ group ] = sample / over;
+                        }
+                        break;
+                    }
+                };
+                if ( !rollRingValid[ channel ] ) { // full reconversion after an invalidation
+                    convertGroups( 0, ringGroups );
+                    rollRingValid[ channel ] = true;
+                } else {
+                    if ( wrapped ) { // finish the tail groups of the previous pass first
+                        convertGroups( rollNextGroup[ channel ], ringGroups );
+                        rollNextGroup[ channel ] = 0;
+                    }
+                    convertGroups( rollNextGroup[ channel ], recvGroups );
+                }
+                rollNextGroup[ channel ] = recvGroups;
+                // clipping covers the whole visible buffer, one vectorized byte scan
+                unsigned char minRaw, maxRaw;
+                clipped = rawMinMaxSimd( rawData.data() + channel, rawSampleCount, activeChannels, minRaw, maxRaw );
+                // assemble the display order: the group after the write head is the
+                // oldest one and starts at the left edge, the head group is skipped
+                const unsigned firstGroup = recvGroups >= ringGroups ? 0 : ( recvGroups + 1 ) % ringGroups;
+                const unsigned tailGroups = qMin( resultSamples, ringGroups - firstGroup );
+                std::copy( ring.begin() + firstGroup, ring.begin() + firstGroup + tailGroups, channelData.begin() );
+                std::copy( ring.begin(), ring.begin() + ( resultSamples - tailGroups ), channelData.begin() + tailGroups );
+            }
+            return clipped; // live calibration housekeeping below is not needed
+        }
+
+        // Live calibration: get min/max and clipping of the contiguous block from one
+        // vectorized scan instead of three branches per raw byte in the loop below.
+        const bool contiguous = rawBufPos + resultSamples * rawOversampling * activeChannels <= unsigned( rawData.size() );
+        if ( contiguous ) {
+            unsigned char rawMin, rawMax;
+            clipped = rawMinMaxSimd( rawData.data() + rawBufPos + channel, resultSamples * rawOversampling, activeChannels,
+                                     rawMin, rawMax );
+            minValue = rawMin;
+            maxValue = rawMax;
+        }
         for ( unsigned index = 0; index < resultSamples;
               ++index, rawBufPos += activeChannels * rawOversampling ) { // advance either by one or two blocks
             if ( rawBufPos + rawOversampling * activeChannels > rawSampleCount * activeChannels )
                 rawBufPos = 0; // (roll mode) show "new" samples after the "old" samples
             double sample = 0.0;
             for ( unsigned iii = 0; iii < rawOversampling * activeChannels; iii += activeChannels ) {
-                int rawSample = raw.data[ rawBufPos + channel + iii ]; // CH1/CH2/CH1/CH2 ...
-                if ( rawSample == 0x00 || rawSample == 0xFF )          // min or max -> clipped
-                    result.clipped |= 0x01 << channel;
-                if ( rawSample > maxValue )
-                    maxValue = rawSample;
-                if ( rawSample < minValue )
-                    minValue = rawSample;
+                int rawSample = rawData[ rawBufPos + channel + iii ]; // CH1/CH2/CH1/CH2 ...
+                if ( !contiguous ) {                                  // statistics not scanned beforehand
+                    if ( rawSample == 0x00 || rawSample == 0xFF )     // min or max -> clipped
+                        clipped = true;
+                    if ( rawSample > maxValue )
+                        maxValue = rawSample;
+                    if ( rawSample < minValue )
+                        minValue = rawSample;
+                }
                 sample += double( rawSample ) - offsetCalibration;
             }
             sample /= rawOversampling;
@@ -809,7 +1752,7 @@ void HantekDsoControl::convertRawDataToSamples() {
             sample -= offsetCorr;
             sample *= gainCorr;
 
-            result.data[ channel ][ index ] = sign * sample / voltageScale * gainCalibration * probeAttn;
+            channelData[ index ] = sign * sample / voltageScale * gainCalibration * probeAttn;
         }
         liveOffset /= resultSamples;
 
@@ -832,7 +1775,159 @@ void HantekDsoControl::convertRawDataToSamples() {
                 controlsettings.correctionValues->gain.step[ gainIndex ][ channel ] = gainToByte( gainCorr * gainCalibration );
             }
         }
+        return clipped;
+    }; // convertChannel lambda
+
+    bool channelClipped[ HANTEK_CHANNEL_NUMBER ] = { false, false };
+    if ( 2 == activeChannels && !scope->liveCalibrationActive ) {
+        // dual channel: convert CH2 on the persistent worker while this thread does CH1;
+        // live calibration stays sequential, it touches shared correction values and
+        // may emit a signal from the worker context
+        convertWorker.start( [ & ]() { channelClipped[ 1 ] = convertChannel( 1 ); } );
+        channelClipped[ 0 ] = convertChannel( 0 );
+        convertWorker.wait();
+    } else {
+        for ( ChannelID channel = 0; channel < activeChannels; ++channel )
+            channelClipped[ channel ] = convertChannel( channel );
+    }
+    for ( ChannelID channel = 0; channel < activeChannels; ++channel ) {
+        if ( channelClipped[ channel ] )
+            result.clipped |= 0x01 << channel;
+        else
+            result.clipped &= ~( 0x01 << channel );
+    }
+
+    // Display fast path: hand the raw bytes and the byte -> volts LUT (rebuilt by
+    // convertChannel above) downstream, so the graph generator can decimate dense
+    // traces from the 1 byte raw samples instead of the 8 byte doubles; the doubles
+    // stay the source for all measurements and exports.
+    if ( 1 == rawOversampling && !( rollFreeRun && rollMode ) && !rawPartial && !scope->liveCalibrationActive &&
+         size_t( skipSamples + resultSamples ) * activeChannels <= rawData.size() ) {
+        if ( !result.rawDisplay || result.rawDisplay.use_count() > 1 ) // unshare, a snapshot may still reference it
+            result.rawDisplay = std::make_shared< std::vector< unsigned char > >();
+        const unsigned char *displayBegin = rawData.data() + size_t( skipSamples ) * activeChannels;
+        result.rawDisplay->assign( displayBegin, displayBegin + size_t( resultSamples ) * activeChannels );
+        result.rawDisplayStride = activeChannels;
+        result.rawDisplayLUT.resize( activeChannels );
+        for ( ChannelID channel = 0; channel < activeChannels; ++channel ) {
+            std::shared_ptr< std::vector< double > > &lut = result.rawDisplayLUT[ channel ];
+            if ( !lut || lut.use_count() > 1 )
+                lut = std::make_shared< std::vector< double > >();
+            lut->assign( convLUT[ channel ], convLUT[ channel ] + 256 );
+        }
+    } else {
+        result.rawDisplay.reset();
+        result.rawDisplayLUT.clear();
+    }
+
+    // One fused statistics pass (mean, rms, min, max) per converted channel; the math
+    // channel and the spectrum generator read the cached values instead of repeating
+    // their own full passes over the same block.
+    result.stats.resize( result.data.size() );
+    for ( auto &channelStats : result.stats )
+        channelStats.valid = false;
+    for ( ChannelID channel = 0; channel < activeChannels; ++channel ) {
+        const std::vector< double > &channelData = *result.data[ channel ];
+        if ( channelData.empty() )
+            continue;
+        DSOsamples::ChannelStats &channelStats = result.stats[ channel ];
+        sampleStatsSimd( channelData.data(), unsigned( channelData.size() ), channelStats.mean, channelStats.rms,
+                         channelStats.vmin, channelStats.vmax );
+        channelStats.counterFrequency = freqCounter[ channel ].frequency;
+        channelStats.valid = true;
+        // Software AC coupling servo: steer the subtracted mean toward a zero block
+        // mean. The first live block jumps onto the DC level, afterwards an EMA tracks
+        // slow drift; the deadband (a quarter ADC count) keeps the conversion offset -
+        // and with it the LUT and the roll ring - stable once the residual is noise.
+        if ( acCoupleActive[ channel ] && samplingStarted && !rawPartial ) {
+            if ( !acCoupleSeeded[ channel ] ) {
+                acCoupleMean[ channel ] += channelStats.mean;
+                acCoupleSeeded[ channel ] = true;
+            } else if ( fabs( channelStats.mean ) > fabs( convLUTscale[ channel ] ) / 4 ) {
+                acCoupleMean[ channel ] += channelStats.mean / 8;
+            }
+        }
+    }
+
+    // Fixed point companion trace of the trigger source channel, fp = (raw - offset) * 128.
+    // The trigger search reads these int16 samples instead of the converted doubles,
+    // a 4x memory traffic cut for its multiple passes (the limiter on Pi class boxes).
+    const int triggerChannel = controlsettings.trigger.source;
+    if ( !freeRunning && !scope->liveCalibrationActive && triggerChannel >= 0 && triggerChannel < int( activeChannels ) ) {
+        const ChannelID channel = ChannelID( triggerChannel );
+        const double lutScale = convLUTscale[ channel ]; // updated by convertChannel above
+        const double fpGain = 128.0 / fabs( lutScale );  // fixed point counts per volt
+        const double *lut = convLUT[ channel ];
+        int16_t fpLUT[ 256 ]; // raw ADC byte -> fixed point, |fp| <= (255 - offset) * 128
+        for ( int value = 0; value < 256; ++value )
+            fpLUT[ value ] = int16_t( lround( lut[ value ] * fpGain ) );
+        result.triggerFP.resize( resultSamples );
+        unsigned rawBufPos = 0; // same indexing as convertChannel
+        if ( rollFreeRun && rollMode )
+            rawBufPos = rawReceived;
+        rawBufPos += skipSamples * activeChannels;
+        if ( 1 == rawOversampling && !( rollFreeRun && rollMode ) &&
+             rawBufPos + resultSamples * activeChannels <= unsigned( rawData.size() ) ) {
+            const unsigned char *in = rawData.data() + rawBufPos + channel;
+            for ( unsigned index = 0; index < resultSamples; ++index, in += activeChannels )
+                result.triggerFP[ index ] = fpLUT[ *in ];
+        } else {
+            for ( unsigned index = 0; index < resultSamples; ++index, rawBufPos += activeChannels * rawOversampling ) {
+                if ( rawBufPos + rawOversampling * activeChannels > rawSampleCount * activeChannels )
+                    rawBufPos = 0; // (roll mode) show "new" samples after the "old" samples
+                int sample = 0;
+                for ( unsigned iii = 0; iii < rawOversampling * activeChannels; iii += activeChannels )
+                    sample += fpLUT[ rawData[ rawBufPos + channel + iii ] ];
+                result.triggerFP[ index ] = int16_t( sample / int( rawOversampling ) );
+            }
+        }
+        result.triggerFPchannel = triggerChannel;
+        result.triggerFPgain = fpGain;
+    } else {
+        result.triggerFPchannel = -1; // fall back to the double trace
+    }
+
+    // Record the live block into the raw history ring, recalled blocks are not re-recorded
+    // (samplingStarted is false then). Roll (free run) and still incomplete partial
+    // blocks grow incrementally, skip them until they are complete.
+    if ( samplingStarted && !rollFreeRun && !rawPartial && scope && scope->horizontal.captureHistory > 0 ) {
+        QMutexLocker historyLocker( &historyMutex );
+        if ( rawHistory.empty() || rawHistory.back().tag != rawTag ) { // don't re-record a refresh conversion
+            rawHistory.push_back( RawHistoryBlock() );
+            RawHistoryBlock &block = rawHistory.back();
+            block.channels = activeChannels;
+            block.samplerate = rawSamplerate;
+            block.oversampling = rawOversampling;
+            block.gainValue[ 0 ] = rawGainValue[ 0 ];
+            block.gainValue[ 1 ] = rawGainValue[ 1 ];
+            block.gainIndex[ 0 ] = rawGainIndex[ 0 ];
+            block.gainIndex[ 1 ] = rawGainIndex[ 1 ];
+            block.tag = rawTag;
+            block.timestampNs = rawTimestampNs;
+            block.rollMode = rollMode;
+            // delta compress the 8 bit block, typical signals shrink 2-3x so the same
+            // RAM budget holds a correspondingly deeper history
+            block.rawSize = unsigned( rawData.size() );
+            block.data.resize( SampleCodec::compressBound( rawData.size() ) );
+            block.data.resize( SampleCodec::compress( rawData.data(), rawData.size(), activeChannels, block.data.data() ) );
+            block.data.shrink_to_fit(); // the saved bytes are the point of the compression
+            while ( rawHistory.size() > unsigned( scope->horizontal.captureHistory ) )
+                rawHistory.pop_front();
+        }
+    }
+
+    // Hand the unconverted block to a continuous recorder, if one listens. Direct
+    // connected slots copy what they need during the emit; incrementally growing
+    // roll (free run) and partial blocks are skipped, they would be recorded repeatedly.
+    if ( samplingStarted && !rollFreeRun && !rawPartial )
+        emit rawBlockCaptured( &rawData, activeChannels, rawSamplerate, rawOversampling, rawGainValue, rawTag );
+
+    if ( !rollFreeRun && !rawPartial ) {
+        rawLocker.relock();
+        if ( raw.tag == rawTag )        // no newer block arrived meanwhile ..
+            rawBuffer.swap( raw.data ); // .. put the block back for a possible refresh re-conversion
     }
+    FrameTrace::record( "convert", rawTag );
 } // convertRawDataToSamples()
 
 
@@ -848,70 +1943,140 @@ void HantekDsoControl::updateInterval() {
         acquireInterval = int( 1000 * scope->horizontal.acquireInterval );
     else
         acquireInterval = 1;
-#ifdef Q_PROCESSOR_ARM
-    displayInterval = 200; // update display at least every 200 ms
-#else
-    displayInterval = 100; // update display at least every 100 ms
-#endif
+    // Closed loop display pacing instead of the former fixed 100 / 200 ms rate: emit
+    // frames so fast that one converted and post processed block costs about half of
+    // the frame interval, bounded below for responsiveness on fast machines and above
+    // so an overloaded small board still paints twice a second. A fresh trigger after
+    // an untriggered phase bypasses the pacing in stateMachine() either way.
+    displayInterval = qBound( displayIntervalMin, int( frameCostAverage * 2e-3 ), displayIntervalMax );
     acquireInterval = qMin( qMax( sampleInterval, acquireInterval ), 100 ); // at least every 100 ms
 }
 
 
-/// \brief State machine for the device communication
+/// \brief Apply the newest slider value of each channel once per cycle (latest-wins
+/// coalescing). A fast drag fires dozens of setTriggerLevel() calls between two
+/// cycles; only the last level per channel reaches the next trigger search.
+void HantekDsoControl::applyPendingTriggerLevels() {
+    unsigned mask = pendingTriggerLevelMask.exchange( 0, std::memory_order_acquire );
+    for ( ChannelID channel = 0; mask && channel < controlsettings.trigger.level.size(); ++channel, mask >>= 1 )
+        if ( mask & 1 )
+            controlsettings.trigger.level[ channel ] = pendingTriggerLevel[ channel ].load( std::memory_order_relaxed );
+}
+
+
+/// \brief Publish the write slot as the newest immutable snapshot and rotate to a
+/// free slot. Preferably not the previous snapshot (a queued announcement may still
+/// point at it), and the claim is verified Dekker style against a concurrent reader;
+/// with a single consumer one of the two other slots is always free.
+void HantekDsoControl::publishResult() {
+    DSOsamples *published = &resultSlots[ resultWriteIndex ];
+    unsigned candidates[ 2 ];
+    unsigned count = 0;
+    for ( unsigned slot = 0; slot < 3; ++slot ) // the slot of the previous snapshot goes last
+        if ( slot != resultWriteIndex && &resultSlots[ slot ] != publishedResult )
+            candidates[ count++ ] = slot;
+    for ( unsigned slot = 0; slot < 3; ++slot )
+        if ( slot != resultWriteIndex && &resultSlots[ slot ] == publishedResult )
+            candidates[ count++ ] = slot;
+    for ( unsigned iii = 0;; iii = ( iii + 1 ) % count ) {
+        DSOsamples &slot = resultSlots[ candidates[ iii ] ];
+        if ( slot.readerActive.load() )
+            continue; // the reader holds this one, take the other candidate
+        slot.writerActive.store( true ); // claim first, then double check (see DSOsamples)
+        if ( !slot.readerActive.load() ) {
+            resultWriteIndex = candidates[ iii ];
+            break;
+        }
+        slot.writerActive.store( false ); // the reader got there first
+    }
+    published->writerActive.store( false ); // complete and immutable from now on
+    publishedResult = published;
+}
+
+
+/// \brief One processing pass for the device communication, runs on the ProcessingThread
 void HantekDsoControl::stateMachine() {
 
     bool triggered = false;
-    if ( verboseLevel > 4 )
-        qDebug() << "    HDC::stateMachine()" << raw.tag;
+    qint64 conversionMicros = 0; // own share of the per frame cost, see updateInterval()
+    traceControl( verboseLevel > 4, "    HDC::stateMachine()" << raw.tag );
+    if ( !displayTimer.isValid() )
+        displayTimer.start();
+    applyPendingTriggerLevels(); // newest slider value, before the next block converts
 
     // we have a sample available ...
-    // ... that is either a new sample or we are in free run mode or a new trigger search is needed
-    static unsigned lastTag = UINT32_MAX; // detect new raw data
-    if ( samplingStarted && raw.valid && ( raw.tag != lastTag || raw.freeRun || refreshNeeded() ) ) {
-        lastTag = raw.tag;
+    // ... that is either a new sample, a recalled history block, free run mode,
+    // a partially captured slow block or a needed trigger search
+    if ( ( samplingStarted || historyRecall ) && raw.valid &&
+         ( raw.tag != lastRawTag || raw.freeRun || raw.partial || refreshNeeded() ) ) {
+        if ( !raw.partial ) // a partial block keeps converting every tick until it completes
+            lastRawTag = raw.tag;
+        historyRecall = false;
+        QElapsedTimer costTimer;
+        costTimer.start();
         convertRawDataToSamples(); // process samples, apply gain settings etc.
+        DSOsamples &result = writeResult();
         mathChannel->calculate( result );
-        QWriteLocker resultLocker( &result.lock );
         if ( !result.freeRunning ) { // trigger mode != NONE
             // trigger functions below are in separate file "triggering.cpp"
             triggering->searchTriggeredPosition( result );          // detect trigger point
             triggered = triggering->provideTriggeredData( result ); // present either free running or last triggered trace
-        } else {                                                    // free running display
+            if ( !result.liveTrigger && controlsettings.trigger.mode == Dso::TriggerMode::NORMAL )
+                result.rawDisplay.reset(); // a restored old trace no longer matches the raw block
+            if ( accumulateAverage( result ) ) {  // running average over trigger aligned frames
+                mathChannel->calculate( result ); // recompute the math trace from the averaged inputs
+                result.rawDisplay.reset();        // the averaged trace no longer matches the raw block
+            }
+            accumulateEnvelope( result ); // min/max band across trigger aligned frames
+        } else {                                  // free running display
             triggered = false;
             result.triggeredPosition = 0;
+            avgCount = 0;     // the averaging only accumulates triggered frames ...
+            envValid = false; // ... and so does the envelope
+            result.envelopeMin.clear();
+            result.envelopeMax.clear();
         }
+        resultSlotDirty = true; // publish this slot with the next emitted frame
+        conversionMicros = costTimer.nsecsElapsed() / 1000;
     } else { // TODO: check if this is needed anymore: start with correct calibration frequency
-        static bool firstFreq = true;
         if ( firstFreq && scope ) {
             setCalFreq( scope->horizontal.calfreq );
             firstFreq = false;
         }
     }
-    static int delayDisplay = 0;                // timer for display
-    static bool lastTriggered = false;          // state of last frame
-    static bool skipEven = true;                // even or odd frames were skipped
-    delayDisplay += qMax( acquireInterval, 1 ); // count up with every state machine loop
     // always run the display (slowly at t=displayInterval) to allow user interaction
     // ... but update immediately if new triggered data is available after untriggered
     // skip an even number of frames when slope == Dso::Slope::Both
     if ( ( triggered && !lastTriggered )                                 // show new data immediately
-         || ( ( delayDisplay >= displayInterval )                        // or wait some time ...
+         || ( ( displayTimer.elapsed() >= displayInterval )              // or wait some time ...
               && ( ( controlsettings.trigger.slope != Dso::Slope::Both ) // ... for ↗ or ↘ slope
                    || skipEven ) ) ) {                                   // and drop even no. of frames
         skipEven = true;                                                 // zero frames -> even
-        delayDisplay = 0;
-        timestampDebug( QString( "samplesAvailable %1" ).arg( result.tag ) );
-        emit samplesAvailable( &result ); // via signal/slot -> PostProcessing::input()
+        displayTimer.restart();
+        // Close the pacing loop: smooth the total cost of a frame, i.e. the own
+        // conversion / trigger time plus the stage times the post processing chain
+        // reported since the last emitted frame. The reports arrive one frame late,
+        // the averaging absorbs that misalignment.
+        double frameCost = double( conversionMicros + downstreamCost.exchange( 0, std::memory_order_relaxed ) );
+        frameCostAverage += ( frameCost - frameCostAverage ) / 4;
+        if ( resultSlotDirty ) { // new data since the last frame: rotate the write slot out
+            resultSlotDirty = false;
+            publishResult();
+        }
+        if ( publishedResult ) { // pacing ticks before the first conversion have nothing to show
+            timestampDebug( QString( "samplesAvailable %1" ).arg( publishedResult->tag ) );
+            emit samplesAvailable( publishedResult ); // via signal/slot -> PostProcessing::input()
+        }
     } else {
         skipEven = !skipEven;
     }
     lastTriggered = triggered; // save state
 
-    static bool skipFirstSingle = true; // skip 1st triggered single trace to avoid old data
-    // Stop sampling if we're in single trigger mode and have a triggered trace (txh No13)
-    if ( isSamplingUI() && controlsettings.trigger.mode == Dso::TriggerMode::SINGLE && triggering->getTriggeredPositionRaw() ) {
-        if ( verboseLevel > 5 )
-            qDebug() << "     HDC::stateMachine() stop sampling" << raw.tag;
+    // Stop sampling if we're in single trigger mode and have a triggered trace (txh No13);
+    // a trigger found in a partially captured block waits until the block is complete
+    if ( isSamplingUI() && controlsettings.trigger.mode == Dso::TriggerMode::SINGLE && !raw.partial &&
+         triggering->getTriggeredPositionRaw() ) {
+        traceControl( verboseLevel > 5, "     HDC::stateMachine() stop sampling" << raw.tag );
         if ( skipFirstSingle ) { // skip the 1st measurement in single mode
             skipFirstSingle = false;
         } else {
@@ -921,21 +2086,15 @@ void HantekDsoControl::stateMachine() {
     }
 
     if ( isSamplingUI() ) { // triggered by action "start sampling" and call to enableSampling()
-        lastTag = raw.tag;
+        lastRawTag = raw.tag;
         // Sampling hasn't started, update the expected sample count
         expectedSampleCount = getSampleCount();
         timestampDebug( "Starting to capture" );
         samplingStarted = true;
+        wakeCapturing(); // the capture thread can fetch the next block immediately
     }
 
-    updateInterval(); // calculate new acquire timing
-    if ( stateMachineRunning ) {
-#if ( QT_VERSION >= QT_VERSION_CHECK( 5, 4, 0 ) )
-        QTimer::singleShot( acquireInterval, this, &HantekDsoControl::stateMachine );
-#else
-        QTimer::singleShot( acquireInterval, this, SLOT( stateMachine() ) );
-#endif
-    }
+    updateInterval(); // calculate new acquire timing, defines the max. hold-off of the processing thread
 }
 
 
@@ -944,6 +2103,10 @@ void HantekDsoControl::addCommand( ControlCommand *newCommand, bool pending ) {
     control[ newCommand->code ] = newCommand;
     newCommand->next = firstControlCommand;
     firstControlCommand = newCommand;
+    if ( pending ) {
+        commandQueue.push( newCommand );
+        wakeCapturing();
+    }
 }
 
 
@@ -8,15 +8,23 @@
 #endif
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 #include "controlsettings.h"
 #include "controlspecification.h"
+#include "convertworker.h"
 #include "dsosamples.h"
 #include "errorcodes.h"
 #include "mathchannel.h"
 #include "scopesettings.h"
 #include "triggering.h"
+#include "utils/hotpath.h"
 #include "utils/printutils.h"
 #include "viewconstants.h"
 
@@ -27,12 +35,54 @@
 
 #include <vector>
 
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QReadWriteLock>
 #include <QSettings>
 #include <QThread>
+#include <QWaitCondition>
 
 class CapturingThread;
+class ProcessingThread;
 class ScopeDevice;
 
+/// Lock-free single-producer / single-consumer queue that hands pending control
+/// commands from the GUI thread to the capture thread, replacing the unsynchronized
+/// walk of the complete command list on every captured block.
+/// If the ring overflows or a send fails, the consumer falls back to a full list walk.
+class ControlCommandQueue {
+  public:
+    bool push( ControlCommand *cmd ) {
+        unsigned h = head.load( std::memory_order_relaxed );
+        unsigned n = ( h + 1 ) % ringSize;
+        if ( n == tail.load( std::memory_order_acquire ) ) {
+            rescan.store( true, std::memory_order_release ); // ring full, consumer shall walk the list
+            return false;
+        }
+        ring[ h ] = cmd;
+        head.store( n, std::memory_order_release );
+        return true;
+    }
+    ControlCommand *pop() {
+        unsigned t = tail.load( std::memory_order_relaxed );
+        if ( t == head.load( std::memory_order_acquire ) )
+            return nullptr;
+        ControlCommand *cmd = ring[ t ];
+        tail.store( ( t + 1 ) % ringSize, std::memory_order_release );
+        return cmd;
+    }
+    void requestRescan() { rescan.store( true, std::memory_order_release ); }
+    bool rescanNeeded() { return rescan.exchange( false, std::memory_order_acq_rel ); }
+
+  private:
+    static const unsigned ringSize = 64;
+    ControlCommand *ring[ ringSize ] = { nullptr };
+    std::atomic< unsigned > head{ 0 };
+    std::atomic< unsigned > tail{ 0 };
+    std::atomic< bool > rescan{ false };
+};
+
+
 struct Raw {
     unsigned channels = 0;
     double samplerate = 0;
@@ -40,13 +90,20 @@ struct Raw {
     unsigned gainValue[ 2 ] = { 1, 1 }; // 1,2,5,10,..
     unsigned gainIndex[ 2 ] = { 7, 7 }; // index 0..7
     unsigned tag = 0;
+    uint64_t timestampNs = 0; // monotonic clock at USB completion of the block carrying this tag
     bool freeRun = false;  // small buffer, no trigger
+    bool partial = false;  // slow block still captured in place, data valid up to received
     bool valid = false;    // samples can be processed
     bool rollMode = false; // one complete buffer received, start to roll
     unsigned size = 0;
-    unsigned received = 0;
+    /// The capture thread updates the progress counter for every USB packet (by
+    /// reference from bulkReadMulti) while the processing thread polls the metadata
+    /// above; its own cache line keeps that write storm from bouncing the line that
+    /// holds the per tick metadata reads (false sharing across the clusters of
+    /// big.LITTLE parts). The lock gets an own line for the same reason.
+    alignas( 64 ) unsigned received = 0;
     std::vector< unsigned char > data;
-    mutable QReadWriteLock lock;
+    alignas( 64 ) mutable QReadWriteLock lock;
 };
 
 
@@ -55,6 +112,7 @@ struct Raw {
 class HantekDsoControl : public QObject {
     Q_OBJECT
     friend CapturingThread;
+    friend ProcessingThread;
 
   public:
     /**
@@ -70,18 +128,28 @@ class HantekDsoControl : public QObject {
     /// \brief Cleans up
     ~HantekDsoControl() override;
 
-    /// Call this to start the processing.
-    /// This method will call itself periodically from there on.
-    /// Move this class object to an own thread and call run from there.
+    /// One pass of the convert -> math -> trigger chain plus the display pacing
+    /// and sampling start/stop housekeeping. Driven by the ProcessingThread, which
+    /// is woken for every raw block delivered by CapturingThread::xferSamples().
     void stateMachine();
 
-    void stopStateMachine() { stateMachineRunning = false; }
+    void stopStateMachine() {
+        stateMachineRunning = false;
+        wakeProcessing();
+    }
 
     double getSamplerate() const { return controlsettings.samplerate.current; }
 
+    /// \return The drift corrected effective samplerate, measured as a regression
+    /// over the monotonic USB completion timestamps of the recent blocks; 0.0 until
+    /// the fit has settled (see updateEffectiveSamplerate()). Thread-safe.
+    double getMeasuredSamplerate() const { return measuredSamplerate.load(); }
+
     unsigned getSamplesize() const {
         if ( controlsettings.trigger.mode == Dso::TriggerMode::ROLL )
             return SAMPLESIZE_ROLL;
+        else if ( scope && scope->horizontal.recordLength > 0 ) // deep memory mode selected in HorizontalDock
+            return unsigned( scope->horizontal.recordLength );
         else
             return SAMPLESIZE;
     }
@@ -109,8 +177,48 @@ class HantekDsoControl : public QObject {
     void addCommand( ControlCommand *newCommand, bool pending = true );
 
     template < class T > T *modifyCommand( Hantek::ControlCode code ) {
-        control[ uint8_t( code ) ]->pending = true;
-        return static_cast< T * >( control[ uint8_t( code ) ] );
+        ControlCommand *cmd = control[ uint8_t( code ) ];
+        cmd->pending = true;
+        commandQueue.push( cmd ); // hand it to the capture thread
+        wakeCapturing();          // .. and send it without waiting for the next wakeup
+        return static_cast< T * >( cmd );
+    }
+
+    /// \brief Wake the capture thread from its hold-off or idle wait,
+    /// e.g. after queueing a command, toggling sampling or on shutdown.
+    void wakeCapturing() {
+        captureMutex.lock(); // sync with the predicate check of the waiting capture thread
+        captureMutex.unlock();
+        captureWait.wakeAll();
+    }
+
+    /// \brief Hold off the capture thread for up to msecs ms, a wakeup ends the wait early.
+    void holdOffCapturing( unsigned long msecs ) {
+        QMutexLocker locker( &captureMutex );
+        captureWait.wait( &captureMutex, msecs );
+    }
+
+    /// \brief Let the stopped capture thread really sleep (no periodic wakeups)
+    /// until sampling is started again or capturing is shut down.
+    void idleCapturing() {
+        QMutexLocker locker( &captureMutex );
+        while ( capturing && !samplingUI )
+            captureWait.wait( &captureMutex );
+    }
+
+    /// \brief Wake the processing thread, e.g. when a new raw block was published
+    /// by the capture thread or on shutdown.
+    void wakeProcessing() {
+        processMutex.lock(); // sync with the predicate check of the waiting processing thread
+        processMutex.unlock();
+        processWait.wakeAll();
+    }
+
+    /// \brief Let the processing thread wait for the next raw block; the periodic
+    /// timeout keeps display updates and sampling housekeeping alive without new data.
+    void holdOffProcessing() {
+        QMutexLocker locker( &processMutex );
+        processWait.wait( &processMutex, static_cast< unsigned long >( qMax( acquireInterval, 1 ) ) );
     }
 
     bool hasCommand( Hantek::ControlCode code ) { return ( control[ uint8_t( code ) ] != nullptr ); }
@@ -123,6 +231,22 @@ class HantekDsoControl : public QObject {
     /// \brief Saves calibration settings e.g. to the scope's EEPROM
     void prepareForShutdown();
 
+    /// \brief Monotonic health counters of the capture pipeline. Data loss used to be
+    /// invisible: bulkReadMulti() retries silently and capture() zero-fills incomplete
+    /// blocks, so the first symptom of a degraded pipeline was a flat trace segment.
+    struct PipelineHealth {
+        unsigned shortReads = 0;       ///< USB delivered fewer bytes than requested
+        unsigned usbRetries = 0;       ///< timed out bulk transfers that were retried
+        unsigned zeroFilledBlocks = 0; ///< incomplete blocks replaced by "zero" samples
+        unsigned triggerOverruns = 0;  ///< scanned blocks without a trigger event
+        int captureCpu = -1;           ///< CPU the capture thread runs on, -1 = not placed
+    };
+    PipelineHealth pipelineHealth() const; ///< snapshot of all pipeline health counters
+
+    /// \brief Capture progress snapshot for the diagnostics dock: tag and byte size
+    /// of the newest published raw block, read under the raw lock.
+    void captureProgress( unsigned &tag, unsigned &blockBytes ) const;
+
   private:
     std::unique_ptr< MathChannel > mathChannel;
     std::unique_ptr< Triggering > triggering;
@@ -133,6 +257,14 @@ class HantekDsoControl : public QObject {
     bool triggerModeNONE() { return controlsettings.trigger.mode == Dso::TriggerMode::ROLL; }
     unsigned getRecordLength() const;
     void setDownsampling( unsigned downsampling ) { downsamplingNumber = downsampling; }
+    std::atomic< unsigned > shortReadCount{ 0 };  ///< incremented by the capture thread
+    std::atomic< unsigned > zeroFilledCount{ 0 }; ///< incremented by the capture thread
+    std::atomic< int > captureCpuSeen{ -1 };      ///< effective placement, written by the capture thread
+    /// Waveform shapes of the demo device signal generator
+    enum class DemoShape { Ramp, Sine, Square, Noise };
+    DemoShape demoShape = DemoShape::Ramp; ///< CH1 demo waveform, CH2 is always a square wave
+    double demoFrequency = 1000.0;         ///< CH1 demo frequency in Hz, CH2 runs at half of it
+    QString recordFileName;                ///< dump every published raw block here for later replay, empty = off
     bool replaceCalibrationEEPROM = false;
     Dso::ErrorCode getCalibrationFromIniFile();
     Dso::ErrorCode getCalibrationFromEEPROM();
@@ -153,7 +285,7 @@ class HantekDsoControl : public QObject {
     void updateInterval();
 
     /// \brief Converts raw oscilloscope data to sample data
-    void convertRawDataToSamples();
+    DSO_HOT void convertRawDataToSamples();
 
     /// \brief Restore the samplerate/timebase targets after divider updates.
     void restoreTargets();
@@ -166,6 +298,7 @@ class HantekDsoControl : public QObject {
     /// Pointers to control commands
     ControlCommand *control[ 255 ] = { nullptr };
     ControlCommand *firstControlCommand = nullptr;
+    ControlCommandQueue commandQueue; ///< pending commands on their way to the capture thread
 
     // Communication with device
     ScopeDevice *scopeDevice;  ///< The USB device for the oscilloscope
@@ -180,18 +313,173 @@ class HantekDsoControl : public QObject {
 
     // Results
     unsigned downsamplingNumber = 1; ///< Number of downsamples to reduce sample rate
-    DSOsamples result;
+    /// Conversion results, published without locks: the conversion always writes into
+    /// `resultSlots[ resultWriteIndex ]`; when a frame is emitted the slot is published
+    /// as an immutable snapshot and the writer rotates to a slot that is neither the
+    /// published one nor claimed by the post processing reader (see the handshake in
+    /// DSOsamples). Three slots are enough for the one-producer / one-consumer pipeline:
+    /// one being written, one published, one possibly still being read.
+    DSOsamples resultSlots[ 3 ];
+    unsigned resultWriteIndex = 0;          ///< slot the next conversion writes into
+    DSOsamples *publishedResult = nullptr;  ///< newest immutable snapshot, nullptr before the first frame
+    bool resultSlotDirty = false;           ///< the write slot holds unpublished data
+    DSOsamples &writeResult() { return resultSlots[ resultWriteIndex ]; }
+    void publishResult();                   ///< rotate the write slot out as the published snapshot
     unsigned expectedSampleCount = 0; ///< The expected total number of samples at
                                       /// the last check before sampling started
     bool calibrationHasChanged = false;
     std::unique_ptr< QSettings > calibrationSettings;
+    QString calibrationPath( const QString &suffix ) const; ///< calibration file of this scope in the config dir
+    bool loadCalibrationCache();                            ///< restore the merged calibration, true on a valid hit
+    void saveCalibrationCache();                            ///< cache the merged calibration for the next start
     double offsetCorrection[ HANTEK_GAIN_STEPS ][ HANTEK_CHANNEL_NUMBER ];
     double gainCorrection[ HANTEK_GAIN_STEPS ][ HANTEK_CHANNEL_NUMBER ];
+    ConvertWorker convertWorker; ///< converts CH2 concurrently to the CH1 conversion
+    /// Ready-to-use calibration of one channel, derived from the EEPROM byte values.
+    /// Refreshed only when the gain index, the samplerate band (ls/hs) or the
+    /// calibration data change instead of re-deriving it for every captured block.
+    struct CalibrationCache {
+        unsigned gainIndex = UINT_MAX; ///< UINT_MAX forces the initial refresh
+        bool highSpeed = false;        ///< samplerate >= 30 MS/s selects the hs calibration steps
+        uint8_t offsetRaw = 0x80;
+        double offsetCalibration = 0x80;
+        double gainCalibration = 1.0;
+    };
+    CalibrationCache calibrationCache[ HANTEK_CHANNEL_NUMBER ];
+    void invalidateCalibrationCache() {
+        for ( CalibrationCache &cache : calibrationCache )
+            cache.gainIndex = UINT_MAX;
+    }
+    /// Raw ADC byte -> voltage lookup tables, rebuilt only when gain or calibration changes
+    double convLUT[ HANTEK_CHANNEL_NUMBER ][ 256 ];
+    double convLUToffset[ HANTEK_CHANNEL_NUMBER ] = { 1e99, 1e99 }; // force the initial build
+    double convLUTscale[ HANTEK_CHANNEL_NUMBER ] = { 0.0, 0.0 };
+    /// Software AC coupling: the 6022 front end has no switchable input path (the
+    /// coupling command is not sent, see setCoupling()), so an AC selection is
+    /// emulated by folding the running signal mean into the conversion offset;
+    /// the mean is an EMA across blocks, fed by the fused statistics pass.
+    double acCoupleMean[ HANTEK_CHANNEL_NUMBER ] = { 0.0, 0.0 };     ///< subtracted volts, servo toward zero mean
+    bool acCoupleActive[ HANTEK_CHANNEL_NUMBER ] = { false, false }; ///< last coupling state, switch restarts the servo
+    bool acCoupleSeeded[ HANTEK_CHANNEL_NUMBER ] = { false, false }; ///< first block jumps onto the DC level
+    /// Incremental roll mode conversion: the converted trace is kept as a ring of
+    /// averaged oversampling groups aligned to the raw buffer, so each display cycle
+    /// only converts the groups captured since the last one and assembles the display
+    /// order with two copies instead of re-converting the whole circular buffer.
+    /// A LUT rebuild, a geometry change or a capture lap invalidates the ring.
+    std::vector< double > rollRing[ HANTEK_CHANNEL_NUMBER ];    ///< converted groups, circular
+    unsigned rollRingGroups = 0;                                ///< ring capacity in groups
+    unsigned rollGroupSize = 0;                                 ///< raw samples per group (oversampling)
+    unsigned rollNextGroup[ HANTEK_CHANNEL_NUMBER ] = { 0, 0 }; ///< next group to convert
+    unsigned rollLastTag[ HANTEK_CHANNEL_NUMBER ] = { 0, 0 };   ///< one tag per capture pass, detects laps
+    bool rollRingValid[ HANTEK_CHANNEL_NUMBER ] = { false, false };
+    /// Drift corrected effective samplerate: the nominal rate is derived from the
+    /// FX2 crystal, which is off by up to ~100 ppm and drifts with temperature, so
+    /// sample positions reconstructed from the nominal rate diverge over a long
+    /// recording. A least squares line through the cumulative sample count over the
+    /// monotonic block completion timestamps (see Raw::timestampNs) measures the
+    /// rate the ADC actually delivers; a capture gap (hold-off, ADC re-arm) or a
+    /// geometry change restarts the fit.
+    static const unsigned rateFitSlots = 32;        ///< fit window in blocks
+    uint64_t rateFitNs[ rateFitSlots ];             ///< block completion timestamps (ring)
+    double rateFitSamples[ rateFitSlots ];          ///< cumulative samples per channel at that time
+    unsigned rateFitHead = 0;                       ///< next ring slot to fill
+    unsigned rateFitEntries = 0;                    ///< filled ring slots
+    double rateFitCumulative = 0.0;                 ///< running sample count of the fit
+    unsigned rateFitLastTag = 0;                    ///< tag of the last folded block
+    uint64_t rateFitLastNs = 0;                     ///< timestamp of the last folded block
+    double rateFitNominal = 0.0;                    ///< geometry key: nominal effective samplerate
+    unsigned rateFitBlockSize = 0;                  ///< geometry key: effective samples per block
+    std::atomic< double > measuredSamplerate{ 0.0 }; ///< last fit result, read by getMeasuredSamplerate()
+    double updateEffectiveSamplerate( unsigned tag, uint64_t timestampNs, unsigned blockSamples, double nominalRate );
+    /// Continuous frequency counter: rising zero crossings are accumulated over the
+    /// contiguous raw block stream with pure integer compares during the conversion
+    /// pass, then read out reciprocally (cycles over the exact crossing-to-crossing
+    /// span) once per gate. Unlike the per block FFT estimate the resolution is not
+    /// limited by the record length, a one second gate resolves mHz for almost free.
+    struct FreqCounter {
+        unsigned lastTag = 0;     ///< last folded block, a tag gap restarts the stream
+        double samplerate = 0.0;  ///< raw samplerate of the stream, change restarts
+        int state = 0;            ///< -1 below / +1 above the hysteresis band, 0 unknown
+        bool haveCross = false;   ///< firstCross / lastCross are valid
+        uint64_t sampleIndex = 0; ///< raw samples folded since the stream (re)start
+        uint64_t firstCross = 0;  ///< stream position of the first crossing of the gate
+        uint64_t lastCross = 0;   ///< stream position of the newest crossing
+        uint64_t cycles = 0;      ///< full periods between firstCross and lastCross
+        double frequency = 0.0;   ///< latest gated readout, 0.0 = not settled / no signal
+    };
+    FreqCounter freqCounter[ HANTEK_CHANNEL_NUMBER ];
+    void countZeroCrossings( ChannelID channel, const unsigned char *in, unsigned count, unsigned stride, double zeroLevel,
+                             unsigned tag, double samplerate );
+    /// Acquisition averaging: incremental running sum over trigger aligned frames,
+    /// one multiply-add per sample, see accumulateAverage().
+    std::vector< std::vector< double > > avgSum; ///< per channel running sum in anchor coordinates
+    unsigned avgCount = 0;                       ///< frames accumulated so far, 0 = empty
+    unsigned avgTarget = 0;                      ///< frame count N of the running average
+    unsigned avgChannels = 0;                    ///< channel count of the accumulation
+    size_t avgSize = 0;                          ///< samples per channel of the accumulation
+    double avgSamplerate = 0.0;                  ///< samplerate of the accumulation, change restarts
+    int avgAnchor = 0;                           ///< trigger position of the first frame, alignment reference
+    double avgAnchorSub = 0.0;                   ///< sub sample trigger phase of the anchor
+    bool accumulateAverage( DSOsamples &result );
+    /// Envelope mode: per sample min/max accumulated across trigger aligned frames,
+    /// anchored like the averaging above, see accumulateEnvelope().
+    std::vector< std::vector< double > > envMin; ///< per channel minimum trace in anchor coordinates
+    std::vector< std::vector< double > > envMax; ///< per channel maximum trace in anchor coordinates
+    bool envValid = false;                       ///< the envelope holds at least one frame
+    unsigned envChannels = 0;                    ///< channel count of the accumulation
+    size_t envSize = 0;                          ///< samples per channel of the accumulation
+    double envSamplerate = 0.0;                  ///< samplerate of the accumulation, change restarts
+    int envAnchor = 0;                           ///< trigger position of the first frame, alignment reference
+    void accumulateEnvelope( DSOsamples &result );
     bool capturing = false;
+    QMutex captureMutex;        ///< Guards the sleep/wakeup handshake with the capture thread
+    QWaitCondition captureWait; ///< Ends the hold-off / idle sleep of the capture thread
+    QMutex processMutex;        ///< Guards the sleep/wakeup handshake with the processing thread
+    QWaitCondition processWait; ///< Ends the wait of the processing thread for a new raw block
     bool samplingStarted = false;
     bool stateMachineRunning = false;
+    /// applySettings() batches the setter cascade of a loaded profile into one
+    /// transaction: the setters request the sampling restart here instead of
+    /// stopping the device one by one, applySettings() restarts at most once.
+    bool applyingSettings = false;
+    bool restartPending = false;
+    // Last values sent to the hardware, the setters skip the sampling restart when
+    // they are unchanged (members instead of function local statics, shared statics
+    // break multiple parallel sessions)
+    uint8_t lastSamplerateIndex = 0xFF;
+    uint8_t lastGainValue[ 2 ] = { 0xFF, 0xFF };
+    int lastCoupling[ 2 ] = { -1, -1 };
+    Dso::TriggerMode lastTriggerMode = Dso::TriggerMode::AUTO;
+    // Sorted lookup tables over the fixed model specification, built once after
+    // applyRequirements(); the setters binary search them instead of scanning the
+    // spec arrays on every slider event
+    std::vector< std::pair< long, uint8_t > > samplerateIndexTable; ///< rounded samplerate -> fixedSampleRates index
+    std::vector< std::pair< double, uint8_t > > gainIndexTable;     ///< Vdiv -> gain table index, ascending
+    QList< double > sampleStepsSingle;                              ///< samplerate steps within the single channel limit
+    QList< double > sampleStepsMulti;                               ///< samplerate steps within the two channel limit
+    QList< double > lastSampleSteps;                                ///< last emitted list, duplicate emits are skipped
+    void buildLookupTables();
     int acquireInterval = 0;
     int displayInterval = 0;
+    /// Busy time (µs) reported by the post processing chain since the last emitted
+    /// frame, written by reportProcessingTime() on the control thread and consumed
+    /// by the state machine on the processing thread.
+    std::atomic< int > downstreamCost{ 0 };
+    double frameCostAverage = 0.0; ///< smoothed conversion + post processing cost per frame (µs)
+#ifdef Q_PROCESSOR_ARM
+    static const int displayIntervalMin = 50; ///< lower pace bound (ms), higher on small ARM boards
+#else
+    static const int displayIntervalMin = 20; ///< lower pace bound (ms)
+#endif
+    static const int displayIntervalMax = 500; ///< upper pace bound (ms) when the machine is overloaded
+    // State of the processing loop, was function local static before the move to the
+    // dedicated processing thread (shared statics break multiple parallel sessions)
+    unsigned lastRawTag = UINT32_MAX; ///< detect new raw data
+    bool firstFreq = true;            ///< start with correct calibration frequency
+    QElapsedTimer displayTimer;       ///< paces the display updates to displayInterval
+    bool lastTriggered = false;       ///< trigger state of the last frame
+    bool skipEven = true;             ///< even or odd frames were skipped
+    bool skipFirstSingle = true;      ///< skip 1st triggered single trace to avoid old data
     unsigned activeChannels = 2;
     bool refresh = false; // parameter changed -> new raw to result conversion and trigger search needed
     void requestRefresh( bool active = true ) { refresh = active; }
@@ -200,7 +488,40 @@ class HantekDsoControl : public QObject {
         refresh = false;
         return changed;
     }
+    /// Latest-wins mailbox for the trigger level sliders: a fast drag fires one
+    /// setTriggerLevel() per mouse move on the control thread while the trigger
+    /// search reads the level on the processing thread. The pending values are
+    /// applied once per state machine cycle, before the next block converts, so
+    /// any number of drag events costs at most one re-search per cycle.
+    std::atomic< double > pendingTriggerLevel[ HANTEK_CHANNEL_NUMBER + 1 ] = {}; ///< one slot per channel incl. math
+    std::atomic< unsigned > pendingTriggerLevelMask{ 0 };                        ///< one bit per pending channel
+    void applyPendingTriggerLevels();
     Raw raw;
+    /// Conversion side slot of the capture buffer pool. The current raw block is swapped
+    /// out of `raw.data` so the conversion runs without holding `raw.lock` and the
+    /// capture thread can deliver the next block meanwhile.
+    std::vector< unsigned char > rawBuffer;
+    /// One captured raw block with the metadata needed to re-run the conversion on recall.
+    struct RawHistoryBlock {
+        unsigned channels = 0;
+        double samplerate = 0;
+        unsigned oversampling = 0;
+        unsigned gainValue[ 2 ] = { 1, 1 }; // 1,2,5,10,..
+        unsigned gainIndex[ 2 ] = { 7, 7 }; // index 0..7
+        unsigned tag = 0;
+        uint64_t timestampNs = 0;
+        bool rollMode = false;
+        unsigned rawSize = 0;               ///< uncompressed byte count of data
+        std::vector< unsigned char > data;  ///< SampleCodec compressed raw bytes
+    };
+    /// Ring of the last captured raw blocks (scope->horizontal.captureHistory deep).
+    /// Storing the 8 bit raw bytes instead of converted doubles keeps the history
+    /// 8x smaller, and the delta compression (see SampleCodec) shrinks typical
+    /// signals by another 2-3x; re-running the conversion of a recalled block is cheap.
+    std::deque< RawHistoryBlock > rawHistory;
+    QMutex historyMutex;        ///< recording (processing thread) vs. recall (control thread)
+    int historyIndex = -1;      ///< recall position, -1 = live / newest block
+    bool historyRecall = false; ///< process a recalled block although sampling is stopped
     unsigned debugLevel = 0;
     uint8_t channelOffset[ 2 ] = { 0x80, 0x80 };
 
@@ -216,6 +537,11 @@ class HantekDsoControl : public QObject {
     /// \param enabled Enables/Disables sampling
     void enableSamplingUI( bool enabled = true );
 
+    /// \brief Feed the measured busy time of one post processing stage into the
+    /// display pacing governor, see updateInterval().
+    /// \param micros Busy time of the stage for one block (µs).
+    void reportProcessingTime( int micros ) { downstreamCost.fetch_add( micros, std::memory_order_relaxed ); }
+
     /// \brief Sets the samplerate of the oscilloscope.
     /// \param samplerate The samplerate that should be met (S/s), 0.0 to restore
     /// current samplerate.
@@ -289,6 +615,22 @@ class HantekDsoControl : public QObject {
     /// \return The trigger position that has been set.
     Dso::ErrorCode setTriggerPosition( double position );
 
+    /// \brief Set the pulse qualification of the trigger edge.
+    /// \param qualify Edge, pulse width or runt qualification.
+    /// \return See ::Dso::ErrorCode.
+    Dso::ErrorCode setTriggerQualify( Dso::TriggerQualify qualify );
+
+    /// \brief Set the qualifying pulse width range.
+    /// \param min The lower pulse width limit (in s).
+    /// \param max The upper pulse width limit (in s).
+    /// \return See ::Dso::ErrorCode.
+    Dso::ErrorCode setTriggerPulseWidth( double min, double max );
+
+    /// \brief Set the trigger holdoff time.
+    /// \param holdoff The minimum time between two triggers (in s, 0 = off).
+    /// \return See ::Dso::ErrorCode.
+    Dso::ErrorCode setTriggerHoldoff( double holdoff );
+
     /// \brief Sets the calibration frequency of the oscilloscope.
     /// \param calfreq The calibration frequency.
     /// \return The tfrequency that has been set, ::Dso::ErrorCode on error.
@@ -301,6 +643,11 @@ class HantekDsoControl : public QObject {
     /// \brief Starts a new sampling block.
     void restartSampling();
 
+    /// \brief Step back (delta < 0) or forward (delta > 0) through the raw capture
+    /// history after the sampling was stopped; the recalled block is converted and
+    /// displayed with the normal convert -> math -> trigger chain.
+    void stepHistory( int delta );
+
     /// \brief enable/disable offset calibration
     void calibrateOffset( bool enable );
 
@@ -309,6 +656,13 @@ class HantekDsoControl : public QObject {
     void statusMessage( const QString &message, int timeout ); ///< Status message about the oscilloscope
     void samplesAvailable( const DSOsamples *samples );        ///< New sample data is available
 
+    /// One captured raw block was converted, emitted from the processing thread for
+    /// continuous recording. Unlike samplesAvailable() this fires for every block,
+    /// unaffected by the display frame pacing. The pointed-to data is only valid
+    /// during the emit: connect with Qt::DirectConnection and copy what is needed.
+    void rawBlockCaptured( const std::vector< unsigned char > *data, unsigned channels, double samplerate, unsigned oversampling,
+                           const unsigned *gainValue, unsigned tag );
+
     /// The available samplerate range has changed
     void samplerateLimitsChanged( double minimum, double maximum );
     /// The available samplerate for fixed samplerate devices has changed
@@ -15,117 +15,262 @@ MathChannel::MathChannel( const DsoSettingsScope *scope ) : scope( scope ) {
 }
 
 
-void MathChannel::calculate( DSOsamples &result ) {
-    const size_t CH1 = 0;
-    const size_t CH2 = 1;
-    const size_t MATH = 2;
-    const double sign = scope->voltage[ MATH ].inverted ? -1.0 : 1.0;
-    QWriteLocker resultLocker( &result.lock );
-    std::vector< double > &mathChannel = result.data[ MATH ];
-    const size_t resultSamples = result.data[ CH1 ].size();
-    const Dso::MathMode mathMode = Dso::getMathMode( scope->voltage[ MATH ] );
-    mathChannel.resize( resultSamples );
-    if ( mathMode <= Dso::LastBinaryMathMode ) { // binary operations
-        if ( result.data[ CH1 ].empty() || result.data[ CH2 ].empty() )
-            return;
-
-        // Calculate values and write them into the sample buffer
-        std::vector< double >::const_iterator ch1Iterator = result.data[ CH1 ].begin();
-        std::vector< double >::const_iterator ch2Iterator = result.data[ CH2 ].begin();
-
-        if ( result.clipped & 0x03 ) // at least one channel has clipped
-            result.clipped |= 0x04;  // .. the math channel is not reliable
-        else
-            result.clipped &= ~0x04; // clear clipping
-
-        switch ( mathMode ) {
+// Math kernels with mode and inversion as compile time parameters: the switch on the
+// template parameter folds away and the remaining contiguous pointer loop is branch
+// free per sample, so the compiler can auto vectorize it (the iterator version did
+// not vectorize because of possible aliasing between source and target vectors).
+template < Dso::MathMode mode, bool inverted >
+static void binaryMathKernel( const double *__restrict ch1, const double *__restrict ch2, double *__restrict out, size_t count,
+                              double triggerLevel1, double triggerLevel2 ) {
+    const double sign = inverted ? -1.0 : 1.0;
+    for ( size_t i = 0; i < count; ++i ) {
+        switch ( mode ) { // compile time constant
         case Dso::MathMode::ADD_CH1_CH2:
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator ) {
-                *it = sign * ( *ch1Iterator + *ch2Iterator );
-            }
+            out[ i ] = sign * ( ch1[ i ] + ch2[ i ] );
             break;
         case Dso::MathMode::SUB_CH2_FROM_CH1:
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator ) {
-                *it = sign * ( *ch1Iterator - *ch2Iterator );
-            }
+            out[ i ] = sign * ( ch1[ i ] - ch2[ i ] );
             break;
         case Dso::MathMode::SUB_CH1_FROM_CH2:
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator ) {
-                *it = sign * ( *ch2Iterator - *ch1Iterator );
-            }
+            out[ i ] = sign * ( ch2[ i ] - ch1[ i ] );
             break;
         case Dso::MathMode::MUL_CH1_CH2:
             // multiply e.g. voltage and current (measured with a 1 ohm shunt) to get momentary power
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator ) {
-                *it = sign * ( *ch1Iterator * *ch2Iterator );
-            }
+            out[ i ] = sign * ( ch1[ i ] * ch2[ i ] );
             break;
+        // logic values: above / below trigger level
         case Dso::MathMode::AND_CH1_CH2:
-            // logic values: above / below trigger level
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator )
-                *it = ( ( *ch1Iterator >= scope->voltage[ CH1 ].trigger ) && ( *ch2Iterator >= scope->voltage[ CH2 ].trigger )
-                            ? 1.0
-                            : 0.0 );
+            out[ i ] = ( ch1[ i ] >= triggerLevel1 ) && ( ch2[ i ] >= triggerLevel2 ) ? 1.0 : 0.0;
             break;
         case Dso::MathMode::AND_NOT_CH1_CH2:
-            // logic values: above / below trigger level
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator )
-                *it = ( !( *ch1Iterator >= scope->voltage[ CH1 ].trigger ) && ( *ch2Iterator >= scope->voltage[ CH2 ].trigger )
-                            ? 1.0
-                            : 0.0 );
+            out[ i ] = !( ch1[ i ] >= triggerLevel1 ) && ( ch2[ i ] >= triggerLevel2 ) ? 1.0 : 0.0;
             break;
         case Dso::MathMode::AND_CH1_NOT_CH2:
-            // logic values: above / below trigger level
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator )
-                *it = ( ( *ch1Iterator >= scope->voltage[ CH1 ].trigger ) && !( *ch2Iterator >= scope->voltage[ CH2 ].trigger )
-                            ? 1.0
-                            : 0.0 );
+            out[ i ] = ( ch1[ i ] >= triggerLevel1 ) && !( ch2[ i ] >= triggerLevel2 ) ? 1.0 : 0.0;
             break;
         case Dso::MathMode::AND_NOT_CH1_NOT_CH2:
-            // logic values: above / below trigger level
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator )
-                *it = ( !( *ch1Iterator >= scope->voltage[ CH1 ].trigger ) && !( *ch2Iterator >= scope->voltage[ CH2 ].trigger )
-                            ? 1.0
-                            : 0.0 );
+            out[ i ] = !( ch1[ i ] >= triggerLevel1 ) && !( ch2[ i ] >= triggerLevel2 ) ? 1.0 : 0.0;
             break;
         case Dso::MathMode::EQU_CH1_CH2:
-            // logic values: above / below trigger level
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it, ++ch1Iterator, ++ch2Iterator )
-                *it = ( ( *ch1Iterator >= scope->voltage[ CH1 ].trigger ) == ( *ch2Iterator >= scope->voltage[ CH2 ].trigger )
-                            ? 1.0
-                            : 0.0 );
+            out[ i ] = ( ch1[ i ] >= triggerLevel1 ) == ( ch2[ i ] >= triggerLevel2 ) ? 1.0 : 0.0;
             break;
         default:
-            for ( auto it = mathChannel.begin(), end = mathChannel.end(); it != end; ++it )
-                *it = 0.0;
+            out[ i ] = 0.0;
             break;
         }
-    } else {           // unary operators (calculate square, AC, DC, abs, sign, ...)
-        unsigned src = // alternating 0 and 1 for the unary math functions
-            ( unsigned( mathMode ) - unsigned( Dso::LastBinaryMathMode ) - 1 ) & 0x01;
+    }
+}
+
+typedef void ( *BinaryMathKernel )( const double *, const double *, double *, size_t, double, double );
+
+// Dispatch table in Dso::MathMode order, [ mode ][ inverted ]
+static const BinaryMathKernel binaryMathKernels[][ 2 ] = {
+    { binaryMathKernel< Dso::MathMode::ADD_CH1_CH2, false >, binaryMathKernel< Dso::MathMode::ADD_CH1_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::SUB_CH2_FROM_CH1, false >, binaryMathKernel< Dso::MathMode::SUB_CH2_FROM_CH1, true > },
+    { binaryMathKernel< Dso::MathMode::SUB_CH1_FROM_CH2, false >, binaryMathKernel< Dso::MathMode::SUB_CH1_FROM_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::MUL_CH1_CH2, false >, binaryMathKernel< Dso::MathMode::MUL_CH1_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::AND_CH1_CH2, false >, binaryMathKernel< Dso::MathMode::AND_CH1_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::AND_NOT_CH1_NOT_CH2, false >,
+      binaryMathKernel< Dso::MathMode::AND_NOT_CH1_NOT_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::AND_NOT_CH1_CH2, false >, binaryMathKernel< Dso::MathMode::AND_NOT_CH1_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::AND_CH1_NOT_CH2, false >, binaryMathKernel< Dso::MathMode::AND_CH1_NOT_CH2, true > },
+    { binaryMathKernel< Dso::MathMode::EQU_CH1_CH2, false >, binaryMathKernel< Dso::MathMode::EQU_CH1_CH2, true > },
+};
+
+// The simple unary modes (everything except the sequential LP filters) share one
+// kernel template; src is CH1 or CH2 depending on the mode.
+template < Dso::MathMode mode, bool inverted >
+static void unaryMathKernel( const double *__restrict src, double *__restrict out, size_t count, double average,
+                             double triggerLevel ) {
+    const double sign = inverted ? -1.0 : 1.0;
+    for ( size_t i = 0; i < count; ++i ) {
+        switch ( mode ) { // compile time constant
+        case Dso::MathMode::SQ_CH1:
+        case Dso::MathMode::SQ_CH2:
+            out[ i ] = sign * ( src[ i ] * src[ i ] );
+            break;
+        case Dso::MathMode::AC_CH1:
+        case Dso::MathMode::AC_CH2:
+            // remove DC component to get AC
+            out[ i ] = sign * ( src[ i ] - average );
+            break;
+        case Dso::MathMode::DC_CH1:
+        case Dso::MathMode::DC_CH2:
+            // and show DC component
+            out[ i ] = sign * average;
+            break;
+        case Dso::MathMode::ABS_CH1:
+        case Dso::MathMode::ABS_CH2:
+            // absolute value of signal
+            out[ i ] = sign * ( src[ i ] < 0 ? -src[ i ] : src[ i ] );
+            break;
+        case Dso::MathMode::SIGN_CH1:
+        case Dso::MathMode::SIGN_CH2:
+            // positive: 1, zero: 0, negative -1
+            out[ i ] = sign * ( src[ i ] < 0 ? -1.0 : 1.0 );
+            break;
+        case Dso::MathMode::SIGN_AC_CH1:
+        case Dso::MathMode::SIGN_AC_CH2:
+            // same for AC part of signal
+            out[ i ] = sign * ( src[ i ] < average ? -1.0 : 1.0 );
+            break;
+        case Dso::MathMode::TRIG_CH1:
+        case Dso::MathMode::TRIG_CH2:
+            // above / below trigger level
+            out[ i ] = src[ i ] < triggerLevel ? 0.0 : 1.0;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+typedef void ( *UnaryMathKernel )( const double *, double *, size_t, double, double );
+
+// Dispatch table in Dso::MathMode order starting at SQ_CH1, [ mode - SQ_CH1 ][ inverted ]
+static const UnaryMathKernel unaryMathKernels[][ 2 ] = {
+    { unaryMathKernel< Dso::MathMode::SQ_CH1, false >, unaryMathKernel< Dso::MathMode::SQ_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::SQ_CH2, false >, unaryMathKernel< Dso::MathMode::SQ_CH2, true > },
+    { unaryMathKernel< Dso::MathMode::AC_CH1, false >, unaryMathKernel< Dso::MathMode::AC_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::AC_CH2, false >, unaryMathKernel< Dso::MathMode::AC_CH2, true > },
+    { unaryMathKernel< Dso::MathMode::DC_CH1, false >, unaryMathKernel< Dso::MathMode::DC_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::DC_CH2, false >, unaryMathKernel< Dso::MathMode::DC_CH2, true > },
+    { unaryMathKernel< Dso::MathMode::ABS_CH1, false >, unaryMathKernel< Dso::MathMode::ABS_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::ABS_CH2, false >, unaryMathKernel< Dso::MathMode::ABS_CH2, true > },
+    { unaryMathKernel< Dso::MathMode::SIGN_CH1, false >, unaryMathKernel< Dso::MathMode::SIGN_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::SIGN_CH2, false >, unaryMathKernel< Dso::MathMode::SIGN_CH2, true > },
+    { unaryMathKernel< Dso::MathMode::SIGN_AC_CH1, false >, unaryMathKernel< Dso::MathMode::SIGN_AC_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::SIGN_AC_CH2, false >, unaryMathKernel< Dso::MathMode::SIGN_AC_CH2, true > },
+    { unaryMathKernel< Dso::MathMode::TRIG_CH1, false >, unaryMathKernel< Dso::MathMode::TRIG_CH1, true > },
+    { unaryMathKernel< Dso::MathMode::TRIG_CH2, false >, unaryMathKernel< Dso::MathMode::TRIG_CH2, true > },
+};
+
+
+void MathChannel::calculate( DSOsamples &result ) {
+    const ChannelID MATH = 2;
+    // `result` is the unpublished write slot of the conversion, no reader sees it yet
+    if ( !scope->anyUsed( MATH ) ) {           // neither trace nor spectrum is shown, skip the full pass
+        result.modifiableData( MATH ).clear(); // .. but leave no stale trace for the consumers
+        return;                                // enabling MATH requests a refresh that recalculates this block
+    }
+    // Describe the math work of this block as a list of slots. The app exposes one
+    // MATH channel today, but a slot source may also be the output of another slot
+    // (e.g. a filtered version of the CH1 * CH2 power product), so the slots are
+    // evaluated in dependency order below.
+    const Dso::MathMode mathMode = Dso::getMathMode( scope->voltage[ MATH ] );
+    slots.clear();
+    MathSlot slot;
+    slot.out = MATH;
+    slot.mode = mathMode;
+    if ( mathMode <= Dso::LastBinaryMathMode ) {
+        slot.src1 = 0;
+        slot.src2 = 1;
+    } else { // alternating CH1 and CH2 for the unary math functions
+        slot.src1 = ( unsigned( mathMode ) - unsigned( Dso::LastBinaryMathMode ) - 1 ) & 0x01;
+        slot.src2 = slot.src1;
+    }
+    slot.inverted = scope->voltage[ MATH ].inverted;
+    slots.push_back( slot );
+
+    // Topological evaluation: run every slot whose sources are no longer the pending
+    // output of another slot; a cyclic definition makes no progress and is dropped.
+    std::vector< bool > evaluated( slots.size(), false );
+    for ( size_t pass = 0; pass < slots.size(); ++pass ) {
+        bool progress = false;
+        for ( size_t iii = 0; iii < slots.size(); ++iii ) {
+            if ( evaluated[ iii ] )
+                continue;
+            bool ready = true;
+            for ( size_t jjj = 0; jjj < slots.size(); ++jjj )
+                if ( jjj != iii && !evaluated[ jjj ] &&
+                     ( slots[ jjj ].out == slots[ iii ].src1 || slots[ jjj ].out == slots[ iii ].src2 ) )
+                    ready = false;
+            if ( ready ) {
+                evaluateSlot( result, slots[ iii ] );
+                evaluated[ iii ] = true;
+                progress = true;
+            }
+        }
+        if ( !progress )
+            break;
+    }
+    result.mathVoltageUnit = mathModeUnit( mathMode );
+}
+
+
+void MathChannel::evaluateSlot( DSOsamples &result, const MathSlot &slot ) {
+    const Dso::MathMode mathMode = slot.mode;
+    const unsigned invert = slot.inverted ? 1 : 0;
+    const unsigned char outClipBit = ( unsigned char )( 0x01 << slot.out );
+    std::vector< double > &mathChannel = result.modifiableData( slot.out ); // unshare a saved trace
+    const size_t resultSamples = result.data[ slot.src1 ]->size();
+    mathChannel.resize( resultSamples );
+    if ( mathMode <= Dso::LastBinaryMathMode ) { // binary operations
+        const ChannelID CH1 = slot.src1;
+        const ChannelID CH2 = slot.src2;
+        if ( result.data[ CH1 ]->empty() || result.data[ CH2 ]->empty() )
+            return;
+
+        if ( result.clipped & ( 0x01 << CH1 | 0x01 << CH2 ) ) // at least one source has clipped
+            result.clipped |= outClipBit;                     // .. the math channel is not reliable
+        else
+            result.clipped &= ~outClipBit; // clear clipping
+
+        // Calculate values and write them into the sample buffer; the mode specific
+        // kernel is selected once for the whole block.
+        binaryMathKernels[ unsigned( mathMode ) ][ invert ]( result.data[ CH1 ]->data(), result.data[ CH2 ]->data(),
+                                                             mathChannel.data(), resultSamples,
+                                                             scope->voltage[ CH1 ].trigger, scope->voltage[ CH2 ].trigger );
+    } else { // unary operators (calculate square, AC, DC, abs, sign, ...)
+        const ChannelID src = slot.src1;
 
-        if ( result.data[ src ].empty() )
+        if ( result.data[ src ]->empty() )
             return;
 
         if ( result.clipped & 0x01 << src ) // the input channel has clipped
-            result.clipped |= 0x04;         // .. the math channel is not reliable
+            result.clipped |= outClipBit;   // .. the math channel is not reliable
         else
-            result.clipped &= ~0x04; // clear clipping
+            result.clipped &= ~outClipBit; // clear clipping
 
         if ( mathMode == Dso::MathMode::SQ_CH1 || mathMode == Dso::MathMode::SQ_CH2 ) {
-            auto srcIt = result.data[ src ].begin();
-            for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt )
-                *dstIt = sign * ( *srcIt * *srcIt );
+            // square needs no DC average, dispatch directly
+            unaryMathKernels[ unsigned( mathMode ) - unsigned( Dso::MathMode::SQ_CH1 ) ][ invert ](
+                result.data[ src ]->data(), mathChannel.data(), resultSamples, 0.0, 0.0 );
+        } else if ( mathMode >= Dso::MathMode::SMOOTH10_CH1 ) {
+            // Centered boxcar smoothing over 10 or 100 samples in a single running sum
+            // pass: one add, one subtract and one divide per sample regardless of the
+            // window length; near the trace ends the window shrinks symmetrically.
+            // A decimating filter would break the common time axis of the display
+            // pipeline, so every output phase is produced at the full sample rate.
+            const int window = ( mathMode <= Dso::MathMode::SMOOTH10_CH2 ) ? 10 : 100;
+            const int half = window / 2;
+            const int count = int( resultSamples );
+            const double sign = invert ? -1.0 : 1.0;
+            const double *srcData = result.data[ src ]->data();
+            double *dst = mathChannel.data();
+            double runningSum = 0.0;
+            int lo = 0, hi = 0; // [ lo, hi ) is the window covered by runningSum
+            for ( int index = 0; index < count; ++index ) {
+                const int newLo = qMax( index - half, 0 );
+                const int newHi = qMin( index + half + 1, count );
+                while ( hi < newHi )
+                    runningSum += srcData[ hi++ ];
+                while ( lo < newLo )
+                    runningSum -= srcData[ lo++ ];
+                dst[ index ] = sign * runningSum / ( hi - lo );
+            }
         } else {
-            // calculate DC component of channel that's needed for some of the math functions...
+            // DC component of the channel that's needed for some of the math functions,
+            // taken from the conversion statistics when available
             double average = 0;
-            for ( auto srcIt = result.data[ src ].begin(), srcEnd = result.data[ src ].end(); srcIt != srcEnd; ++srcIt ) {
-                average += *srcIt;
+            if ( src < result.stats.size() && result.stats[ src ].valid ) {
+                average = result.stats[ src ].mean;
+            } else {
+                for ( auto srcIt = result.data[ src ]->begin(), srcEnd = result.data[ src ]->end(); srcIt != srcEnd; ++srcIt ) {
+                    average += *srcIt;
+                }
+                average /= double( result.data[ src ]->size() );
             }
-            average /= double( result.data[ src ].size() );
-
-            // also needed for all math functions
-            auto srcIt = result.data[ src ].begin();
 
             switch ( mathMode ) {
             case Dso::MathMode::LP10_CH1:
@@ -136,72 +281,48 @@ void MathChannel::calculate( DSOsamples &result ) {
                 // Steven W. Smith: The Scientist and Engineer's Guide to Digital Signal Processing, ch. 19
                 // set IIR filter coefficients a0 and b1 for tau = 10 or 100 samples (10000 samples on screen)
                 // for less on-screen-samples adapt the values according equation 19-4
-                double normalScreenSamples = double( result.data[ MATH ].size() ) / 2; // normally 10000
-                double a0, b1;
-                if ( mathMode == Dso::MathMode::LP10_CH1 || mathMode == Dso::MathMode::LP10_CH2 )
-                    b1 = exp( -normalScreenSamples / scope->horizontal.dotsOnScreen / 10 ); // eq. 19-4
-                else
-                    b1 = exp( -normalScreenSamples / scope->horizontal.dotsOnScreen / 100 ); // eq. 19-4
-                a0 = 1 - b1;
+                if ( lpSamples != mathChannel.size() || lpDotsOnScreen != scope->horizontal.dotsOnScreen ) {
+                    double normalScreenSamples = double( mathChannel.size() ) / 2; // normally 10000
+                    lpB1[ 0 ] = exp( -normalScreenSamples / scope->horizontal.dotsOnScreen / 10 );  // eq. 19-4
+                    lpB1[ 1 ] = exp( -normalScreenSamples / scope->horizontal.dotsOnScreen / 100 ); // eq. 19-4
+                    lpSamples = mathChannel.size();
+                    lpDotsOnScreen = scope->horizontal.dotsOnScreen;
+                }
+                const bool lp10 = mathMode == Dso::MathMode::LP10_CH1 || mathMode == Dso::MathMode::LP10_CH2;
+                const double b1 = lp10 ? lpB1[ 0 ] : lpB1[ 1 ];
+                const double a0 = 1 - b1;
+                const double *srcData = result.data[ src ]->data();
+                double *dst = mathChannel.data();
+                const size_t count = resultSamples;
+                // The two dependent recursions run concurrently: the backward pass fills
+                // its own scratch buffer on the worker while this thread filters from
+                // left to right, then one vectorizable sweep blends the two halves.
+                lpBackward.resize( count );
+                double *bwd = lpBackward.data();
+                lpWorker.start( [ srcData, bwd, count, a0, b1, average ]() {
+                    // filter from right to left
+                    double y = average;
+                    for ( size_t index = count; index-- > 0; ) {
+                        bwd[ index ] = y / 2; // the 2nd 50%
+                        y = a0 * srcData[ index ] + b1 * y;
+                    }
+                } );
                 // filter from left to right
                 double y = average;
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt = y / 2; // 50% contribution
-                    y = a0 * *srcIt + b1 * y;
-                }
-                // add the filter result from right to left
-                auto srcIt = result.data[ src ].rbegin();
-                y = average;
-                for ( auto dstIt = mathChannel.rbegin(), dstEnd = mathChannel.rend(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt += y / 2; // the 2nd 50%
-                    y = a0 * *srcIt + b1 * y;
+                for ( size_t index = 0; index < count; ++index ) {
+                    dst[ index ] = y / 2; // 50% contribution
+                    y = a0 * srcData[ index ] + b1 * y;
                 }
+                lpWorker.wait();
+                for ( size_t index = 0; index < count; ++index ) // blend both directions
+                    dst[ index ] += bwd[ index ];
             } break;
-            case Dso::MathMode::AC_CH1:
-            case Dso::MathMode::AC_CH2:
-                // remove DC component to get AC
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt )
-                    *dstIt = sign * ( *srcIt - average );
-                break;
-            case Dso::MathMode::DC_CH1:
-            case Dso::MathMode::DC_CH2:
-                // and show DC component
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt = sign * average;
-                }
-                break;
-            case Dso::MathMode::ABS_CH1:
-            case Dso::MathMode::ABS_CH2:
-                // absolute value of signal
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt = sign * ( *srcIt < 0 ? -*srcIt : *srcIt );
-                }
-                break;
-            case Dso::MathMode::SIGN_CH1:
-            case Dso::MathMode::SIGN_CH2:
-                // positive: 1, zero: 0, negative -1
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt = sign * ( *srcIt < 0 ? -1 : 1 );
-                }
-                break;
-            case Dso::MathMode::SIGN_AC_CH1:
-            case Dso::MathMode::SIGN_AC_CH2:
-                // same for AC part of signal
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt = sign * ( *srcIt < average ? -1 : 1 );
-                }
-                break;
-            case Dso::MathMode::TRIG_CH1:
-            case Dso::MathMode::TRIG_CH2:
-                // above / below trigger level
-                for ( auto dstIt = mathChannel.begin(), dstEnd = mathChannel.end(); dstIt != dstEnd; ++srcIt, ++dstIt ) {
-                    *dstIt = ( *srcIt < scope->voltage[ src ].trigger ? 0 : 1 );
-                }
-                break;
             default:
+                // all remaining unary modes are per sample kernels
+                unaryMathKernels[ unsigned( mathMode ) - unsigned( Dso::MathMode::SQ_CH1 ) ][ invert ](
+                    result.data[ src ]->data(), mathChannel.data(), resultSamples, average, scope->voltage[ src ].trigger );
                 break;
             }
         }
     }
-    result.mathVoltageUnit = mathModeUnit( mathMode );
 }
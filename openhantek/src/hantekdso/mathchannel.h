@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include "convertworker.h"
 #include "dsosamples.h"
+#include "mathmodes.h"
 #include "scopesettings.h"
+#include "hantekprotocol/types.h"
 
 class MathChannel {
   public:
@@ -11,5 +14,24 @@ class MathChannel {
     void calculate( DSOsamples &result );
 
   private:
+    /// One math evaluation slot: an output channel computed from one or two source
+    /// channels; a source may be the output of another slot, calculate() orders the
+    /// evaluation so that every source is computed before its consumers.
+    struct MathSlot {
+        ChannelID out = 0;                              ///< target channel index in DSOsamples::data
+        ChannelID src1 = 0;                             ///< first source (binary and unary modes)
+        ChannelID src2 = 0;                             ///< second source (binary modes)
+        Dso::MathMode mode = Dso::MathMode::ADD_CH1_CH2; ///< function to apply
+        bool inverted = false;                          ///< negate the output
+    };
+    void evaluateSlot( DSOsamples &result, const MathSlot &slot );
     const DsoSettingsScope *scope;
+    std::vector< MathSlot > slots; ///< math work of the current block, capacity is reused
+    /// Cached LP10/LP100 coefficients, the exp() is recomputed only when the trace
+    /// length or the screen resolution changes.
+    size_t lpSamples = 0;             ///< trace length of the cached coefficients
+    double lpDotsOnScreen = 0.0;      ///< screen resolution of the cached coefficients
+    double lpB1[ 2 ] = { 0.0, 0.0 };  ///< b1 for tau = 10 resp. 100 samples
+    std::vector< double > lpBackward; ///< scratch of the backward IIR pass, capacity is reused
+    ConvertWorker lpWorker;           ///< runs the backward IIR pass concurrently to the forward one
 };
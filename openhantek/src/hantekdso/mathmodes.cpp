@@ -4,7 +4,7 @@
 namespace Dso {
 
 // Enum definition must match the "extern" declarations in "mathmodes.h"
-Enum< Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::TRIG_CH2 > MathModeEnum;
+Enum< Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::SMOOTH100_CH2 > MathModeEnum;
 
 Unit mathModeUnit( MathMode mode ) {
     if ( mode == MathMode::MUL_CH1_CH2 || mode == MathMode::SQ_CH1 || mode == MathMode::SQ_CH2 )
@@ -84,6 +84,14 @@ QString mathModeString( MathMode mode ) {
         return QCoreApplication::tr( "CH1 Trigger" );
     case MathMode::TRIG_CH2:
         return QCoreApplication::tr( "CH2 Trigger" );
+    case MathMode::SMOOTH10_CH1:
+        return QCoreApplication::tr( "CH1 Smooth10" );
+    case MathMode::SMOOTH10_CH2:
+        return QCoreApplication::tr( "CH2 Smooth10" );
+    case MathMode::SMOOTH100_CH1:
+        return QCoreApplication::tr( "CH1 Smooth100" );
+    case MathMode::SMOOTH100_CH2:
+        return QCoreApplication::tr( "CH2 Smooth100" );
     }
     return QString();
 }
@@ -42,13 +42,19 @@ enum class MathMode : unsigned {
     SIGN_AC_CH2,
     // unary logical functions
     TRIG_CH1,
-    TRIG_CH2
+    TRIG_CH2,
+    // unary boxcar smoothing, appended after the older modes so that stored
+    // couplingOrMathIndex settings keep their meaning
+    SMOOTH10_CH1,
+    SMOOTH10_CH2,
+    SMOOTH100_CH1,
+    SMOOTH100_CH2
 };
 // this "extern" declaration must match the Enum definition in "mathchannel.cpp"
-extern Enum< Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::TRIG_CH2 > MathModeEnum;
+extern Enum< Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::SMOOTH100_CH2 > MathModeEnum;
 
 const auto LastBinaryMathMode = MathMode::EQU_CH1_CH2;
-const auto LastMathMode = MathMode::TRIG_CH2;
+const auto LastMathMode = MathMode::SMOOTH100_CH2;
 
 Unit mathModeUnit( MathMode mode );
 
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "processing.h"
+#include <QDebug>
+
+
+ProcessingThread::ProcessingThread( HantekDsoControl *hdc ) : hdc( hdc ) {
+    if ( hdc->verboseLevel > 1 ) {
+        qDebug() << " ProcessingThread::ProcessingThread()";
+        if ( hdc->verboseLevel > 2 )
+            qDebug() << "  processingThread ID: " << currentThreadId();
+    }
+}
+
+
+void ProcessingThread::run() {
+    forever {
+        if ( !hdc->stateMachineRunning || QThread::currentThread()->isInterruptionRequested() )
+            return; // stop this thread
+        hdc->stateMachine();      // one convert -> math -> trigger pass
+        hdc->holdOffProcessing(); // wait for the next raw block (or the periodic timeout)
+    }
+}
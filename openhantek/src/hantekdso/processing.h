@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "hantekdsocontrol.h"
+
+/// \brief Dedicated thread for the convert -> math -> trigger chain.
+/// CapturingThread::xferSamples() wakes it directly after publishing a raw block,
+/// so the processing starts immediately instead of waiting for the next tick of
+/// the former QTimer::singleShot() state machine on the control event loop.
+/// Without new data it still runs periodically (acquireInterval) to keep the
+/// display and the sampling start/stop housekeeping alive. Only the emitted
+/// signals (samplesAvailable, sampling status) cross back to the event loops
+/// of their receivers via queued connections.
+class ProcessingThread : public QThread {
+    Q_OBJECT
+
+  public:
+    ProcessingThread( HantekDsoControl *hdc );
+    void quitProcessing() {
+        hdc->stopStateMachine();
+        hdc->wakeProcessing();
+    }
+
+  private:
+    void run() override;
+    HantekDsoControl *hdc;
+};
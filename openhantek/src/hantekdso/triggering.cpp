@@ -1,9 +1,12 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "triggering.h"
+#include "convertsimd.h"
 #include "hantekdsocontrol.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <cmath>
+#include <cstdint>
 
 
 Triggering::Triggering( const DsoSettingsScope *scope, const Dso::ControlSettings &controlsettings )
@@ -13,9 +16,121 @@ Triggering::Triggering( const DsoSettingsScope *scope, const Dso::ControlSetting
 }
 
 
+Triggering::~Triggering() {
+    if ( scope->verboseLevel > 1 )
+        qDebug() << " Triggering::~Triggering()";
+    if ( scope->verboseLevel > 0 && triggerStats.blocksScanned ) { // print the summary at exit
+        qDebug() << "Triggering statistics:";
+        qDebug() << "  blocks scanned:" << triggerStats.blocksScanned << " triggered:" << triggerStats.blocksTriggered << "("
+                 << 100.0 * triggerStats.blocksTriggered / triggerStats.blocksScanned << "% )";
+        qDebug() << "  scan time mean:" << triggerStats.scanTimeTotal / triggerStats.blocksScanned
+                 << "µs  max:" << triggerStats.scanTimeMax << "µs";
+        qDebug() << "  candidates rejected by smoothing:" << triggerStats.candidatesRejected;
+    }
+}
+
+
+// Build the running sum of the samples once so that any windowed mean of the
+// verification below becomes two loads and a subtraction instead of summing up
+// to triggerAverage = 400 samples (smooth level 2) per candidate crossing.
+// Accum is int64_t for the fixed point trace (exact) and double otherwise.
+// The prefix vector is reused across blocks, only its content is rewritten.
+template < typename Accum, typename Sample >
+static void prefixSum( const std::vector< Sample > &samples, std::vector< Accum > &prefix ) {
+    prefix.resize( samples.size() + 1 );
+    Accum sum = 0;
+    prefix[ 0 ] = 0;
+    for ( size_t i = 0; i < samples.size(); ++i )
+        prefix[ i + 1 ] = sum += samples[ i ];
+}
+
+
+// Check the neighbourhood of a crossing candidate: the average of up to triggerAverage
+// samples before and after it must lie on the correct side of the trigger level.
+// Use different averaging sizes for HF, normal and LF signals.
+// prefix[ k ] holds the sum of the first k samples, so the mean over [ a, b ) is
+// ( prefix[ b ] - prefix[ a ] ) / ( b - a ).
+template < typename Accum >
+static bool verifyTriggerCandidate( const std::vector< Accum > &prefix, int i, double triggerLevel, int slope,
+                                    int triggerAverage, int sampleCount ) {
+    // check for the previous few SampleSet samples, if they are also above/below the trigger value
+    bool triggerBefore = false;
+    int lo = qMax( i - triggerAverage, 0 ); // mean over [ lo, i )
+    if ( i > lo ) {
+        double mean = double( prefix[ size_t( i ) ] - prefix[ size_t( lo ) ] ) / ( i - lo );
+        triggerBefore = slope * mean < slope * triggerLevel;
+    }
+    // check for the next few SampleSet samples, if they are also above/below the trigger value
+    bool triggerAfter = false;
+    if ( triggerBefore ) { // search right side only if left side condition is met
+        int hi = qMin( i + triggerAverage + 1, sampleCount ); // mean over [ i + 1, hi )
+        if ( hi > i + 1 ) {
+            double mean = double( prefix[ size_t( hi ) ] - prefix[ size_t( i ) + 1 ] ) / ( hi - i - 1 );
+            triggerAfter = slope * mean > slope * triggerLevel;
+        }
+    }
+    // at least triggerAverage samples before and after the candidate meet the condition
+    return triggerBefore && triggerAfter;
+}
+
+
+// The slope search only compares samples against the level, so it runs unchanged on
+// the converted double samples as well as on other sample domains.
+template < typename Sample >
+static int searchTriggerSlope( const std::vector< Sample > &samples, const std::vector< double > &prefix, double triggerLevel,
+                               int slope, int searchBegin, int searchEnd, int triggerAverage, int sampleCount,
+                               unsigned &rejected ) {
+    double prev = INT_MAX;
+    for ( int i = searchBegin; i < searchEnd; i++ ) {
+        if ( slope * samples[ size_t( i ) ] >= slope * triggerLevel &&
+             slope * prev < slope * triggerLevel ) { // trigger condition met
+            if ( verifyTriggerCandidate( prefix, i, triggerLevel, slope, triggerAverage, sampleCount ) )
+                return i;
+            ++rejected;
+        }
+        prev = samples[ size_t( i ) ];
+    }
+    return 0;
+}
+
+
+// Overload for the int16 fixed point trace: a vectorized scan (8 compares per
+// iteration) finds the crossing candidates, the verification is identical to the
+// generic version. The crossing level is snapped to the integer grid so that the
+// int16 compares match the double compares of the generic loop exactly.
+static int searchTriggerSlope( const std::vector< int16_t > &samples, const std::vector< int64_t > &prefix, double triggerLevel,
+                               int slope, int searchBegin, int searchEnd, int triggerAverage, int sampleCount,
+                               unsigned &rejected ) {
+    if ( searchBegin >= searchEnd )
+        return 0;
+    // fp >= levelD <=> fp >= ceil( levelD ); fp <= levelD <=> fp <= floor( levelD )
+    const double levelD = slope > 0 ? ceil( triggerLevel ) : floor( triggerLevel );
+    if ( levelD < INT16_MIN || levelD > INT16_MAX ) // no int16 sample can cross this level
+        return 0;
+    const int level = int( levelD );
+    // mirror the generic loop start: prev = INT_MAX counts as "above" for a falling slope
+    if ( slope < 0 && samples[ size_t( searchBegin ) ] <= level ) {
+        if ( verifyTriggerCandidate( prefix, searchBegin, triggerLevel, slope, triggerAverage, sampleCount ) )
+            return searchBegin;
+        ++rejected;
+    }
+    int from = searchBegin + 1;
+    while ( from < searchEnd ) {
+        const int candidate = findCrossingSimd( samples.data(), from, searchEnd, level, slope );
+        if ( candidate < 0 ) // no further crossing
+            return 0;
+        if ( verifyTriggerCandidate( prefix, candidate, triggerLevel, slope, triggerAverage, sampleCount ) )
+            return candidate;
+        ++rejected;
+        from = candidate + 1; // continue behind the rejected candidate
+    }
+    return 0;
+}
+
+
 // search for trigger point from defined point, default startPos = 0;
 // return trigger position > 0 (0: no trigger found)
-int Triggering::searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int startPos ) {
+int Triggering::searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int startPos, bool displayWindow ) {
     int slope;
     if ( dsoSlope == Dso::Slope::Positive )
         slope = 1;
@@ -25,7 +140,7 @@ int Triggering::searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int
         return 0;
 
     unsigned channel = unsigned( controlsettings.trigger.source );
-    const std::vector< double > &samples = result.data[ channel ];
+    const std::vector< double > &samples = *result.data[ channel ];
     int sampleCount = int( samples.size() ); ///< number of available samples
     if ( startPos < 0 || startPos >= sampleCount )
         return 0;
@@ -35,9 +150,11 @@ int Triggering::searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int
     int samplesDisplay = int( round( controlsettings.samplerate.target.duration * controlsettings.samplerate.current ) );
     int searchBegin;
     int searchEnd;
-    if ( 0 == startPos ) {                                                      // search 1st trigger slope
+    if ( displayWindow ) {                                                      // search 1st trigger slope
         searchBegin = int( controlsettings.trigger.position * samplesDisplay ); // samples left of trigger
         searchEnd = sampleCount - ( int( samplesDisplay ) - searchBegin );      // samples right of trigger
+        if ( startPos > searchBegin )                                           // continue a qualification scan ..
+            searchBegin = startPos;                                             // .. behind a rejected candidate
     } else {                                                                    // search next slopes for duty cycle
         searchBegin = startPos;                                                 // search from start point ..
         searchEnd = sampleCount;                                                // .. up to end of samples
@@ -61,46 +178,13 @@ int Triggering::searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int
     if ( scope->verboseLevel > 5 )
         qDebug() << "     begin:" << searchBegin << "end:" << searchEnd;
 
-    double prev = INT_MAX;
-    int swTriggerStart = 0;
-    for ( int i = searchBegin; i < searchEnd; i++ ) {
-        if ( slope * samples[ size_t( i ) ] >= slope * triggerLevel &&
-             slope * prev < slope * triggerLevel ) { // trigger condition met
-            // check for the previous few SampleSet samples, if they are also above/below the trigger value
-            // use different averaging sizes for HF, normal and LF signals
-            bool triggerBefore = false;
-            double mean = 0;
-            int iii = 0;
-            for ( int k = i - 1; k >= i - triggerAverage && k >= 0; k-- ) {
-                mean += samples[ size_t( k ) ];
-                iii++;
-            }
-            if ( iii ) {
-                mean /= iii;
-                triggerBefore = slope * mean < slope * triggerLevel;
-            }
-            // check for the next few SampleSet samples, if they are also above/below the trigger value
-            bool triggerAfter = false;
-            if ( triggerBefore ) { // search right side only if left side condition is met
-                mean = 0;
-                iii = 0;
-                for ( int k = i + 1; k <= i + triggerAverage && k < sampleCount; k++ ) {
-                    mean += samples[ size_t( k ) ];
-                    iii++;
-                }
-                if ( iii ) {
-                    mean /= iii;
-                    triggerAfter = slope * mean > slope * triggerLevel;
-                }
-            }
-            // if at least triggerAverage samples before and after trig meet the condition, set trigger
-            if ( triggerBefore && triggerAfter ) {
-                swTriggerStart = i;
-                break;
-            }
-        }
-        prev = samples[ size_t( i ) ];
-    }
+    int swTriggerStart;
+    if ( int( channel ) == result.triggerFPchannel && result.triggerFP.size() == samples.size() ) // fixed point trace available
+        swTriggerStart = searchTriggerSlope( result.triggerFP, scanPrefixFP, triggerLevel * result.triggerFPgain, slope,
+                                             searchBegin, searchEnd, triggerAverage, sampleCount, triggerStats.candidatesRejected );
+    else
+        swTriggerStart = searchTriggerSlope( samples, scanPrefix, triggerLevel, slope, searchBegin, searchEnd, triggerAverage,
+                                             sampleCount, triggerStats.candidatesRejected );
     if ( scope->verboseLevel > 5 )
         qDebug() << "     swT:" << swTriggerStart;
     return swTriggerStart;
@@ -108,18 +192,37 @@ int Triggering::searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int
 
 
 int Triggering::searchTriggeredPosition( DSOsamples &result ) {
-    static Dso::Slope nextSlope = Dso::Slope::Positive; // for alternating slope mode X
     ChannelID channel = ChannelID( controlsettings.trigger.source );
     // Trigger channel not in use
-    if ( !scope->anyUsed( channel ) || result.data.empty() || result.data[ channel ].empty() )
+    if ( !scope->anyUsed( channel ) || result.data.empty() || !result.data[ channel ] || result.data[ channel ]->empty() )
         return result.triggeredPosition = 0;
     if ( scope->verboseLevel > 4 )
         qDebug() << "    Triggering::searchTriggeredPosition()" << result.tag;
+    // A display refresh reprocesses the block that was already scanned; with the same
+    // trigger setup the memoized result is carried over instead of scanning again.
+    if ( lastSearch.valid && lastSearch.tag == result.tag && lastSearch.source == controlsettings.trigger.source &&
+         lastSearch.level == controlsettings.trigger.level[ channel ] && lastSearch.slope == controlsettings.trigger.slope &&
+         lastSearch.smooth == controlsettings.trigger.smooth && lastSearch.position == controlsettings.trigger.position &&
+         lastSearch.samplerate == controlsettings.samplerate.current &&
+         lastSearch.duration == controlsettings.samplerate.target.duration &&
+         lastSearch.qualify == controlsettings.trigger.qualify &&
+         lastSearch.pulseWidthMin == controlsettings.trigger.pulseWidthMin &&
+         lastSearch.pulseWidthMax == controlsettings.trigger.pulseWidthMax &&
+         lastSearch.holdoff == controlsettings.trigger.holdoff ) {
+        if ( scope->verboseLevel > 5 )
+            qDebug() << "     carry over memoized scan, pos:" << lastSearch.triggeredPosition;
+        triggeredPositionRaw = lastSearch.triggeredPosition;
+        result.triggeredPosition = lastSearch.triggeredPosition;
+        result.triggeredPositionSub = lastSearch.triggeredPositionSub;
+        result.pulseWidth1 = lastSearch.pulseWidth1;
+        result.pulseWidth2 = lastSearch.pulseWidth2;
+        return result.triggeredPosition;
+    }
     triggeredPositionRaw = 0;
     double pulseWidth1 = 0.0;
     double pulseWidth2 = 0.0;
 
-    size_t sampleCount = result.data[ channel ].size();              // number of available samples
+    size_t sampleCount = result.data[ channel ]->size();             // number of available samples
     double timeDisplay = controlsettings.samplerate.target.duration; // time for full screen width
     double sampleRate = result.samplerate;                           //
     unsigned samplesDisplay = unsigned( round( timeDisplay * controlsettings.samplerate.current ) );
@@ -130,11 +233,80 @@ int Triggering::searchTriggeredPosition( DSOsamples &result ) {
     if ( controlsettings.trigger.slope != Dso::Slope::Both ) // up or down
         nextSlope = controlsettings.trigger.slope;           // use this slope
 
+    QElapsedTimer scanTimer; // cheap per block statistics, see Triggering::Stats
+    scanTimer.start();
+
+    // Build the smoothing prefix sum once; all edge searches of this pass (trigger
+    // slope, pulse qualification, both duty cycle slopes) share it, so the three
+    // edges fall out of one traversal of the block instead of three full scans.
+    if ( int( channel ) == result.triggerFPchannel && result.triggerFP.size() == result.data[ channel ]->size() )
+        prefixSum( result.triggerFP, scanPrefixFP );
+    else
+        prefixSum( *result.data[ channel ], scanPrefix );
+
+    // Stream time bookkeeping for the holdoff: a new block of the gapless stream
+    // advances the absolute time axis by the duration of the previous block.
+    if ( result.tag != streamTag ) {
+        streamTime += streamBlockDuration;
+        streamBlockDuration = double( sampleCount ) / sampleRate;
+        streamTag = result.tag;
+    }
+    const Dso::TriggerQualify qualify = controlsettings.trigger.qualify;
+    const double holdoff = controlsettings.trigger.holdoff;
+
     triggeredPositionRaw = searchTriggerPoint( result, nextSlope ); // get 1st slope position
+    // Pulse qualification and holdoff are evaluated inside the same scan: a rejected
+    // candidate continues the search behind the already inspected samples, so the
+    // block is still processed in one forward pass.
+    while ( triggeredPositionRaw && ( qualify != Dso::TriggerQualify::Edge || holdoff > 0.0 ) ) {
+        int continueFrom = triggeredPositionRaw + 1;
+        bool accepted = true;
+        if ( holdoff > 0.0 && streamTime + triggeredPositionRaw / sampleRate < lastTriggerTime + holdoff ) {
+            accepted = false; // too close to the previously accepted trigger ..
+            continueFrom =    // .. jump to the first position outside the holdoff time
+                qMax( continueFrom, int( ceil( ( lastTriggerTime + holdoff - streamTime ) * sampleRate ) ) );
+        }
+        if ( accepted && qualify != Dso::TriggerQualify::Edge ) {
+            // width of the pulse that starts at the candidate edge
+            int opposite = searchTriggerPoint( result, mirrorSlope( nextSlope ), triggeredPositionRaw, false );
+            if ( opposite > triggeredPositionRaw ) {
+                double width = ( opposite - triggeredPositionRaw ) / sampleRate;
+                if ( qualify == Dso::TriggerQualify::Pulse ) // width inside the qualification range
+                    accepted = width >= controlsettings.trigger.pulseWidthMin && width <= controlsettings.trigger.pulseWidthMax;
+                else // Runt: only pulses shorter than the minimum width
+                    accepted = width < controlsettings.trigger.pulseWidthMin;
+                continueFrom = qMax( continueFrom, opposite ); // next same slope edge is behind the opposite one
+            } else {
+                accepted = false; // pulse runs out of the block, its width is unknown
+            }
+        }
+        if ( accepted )
+            break;
+        triggeredPositionRaw = searchTriggerPoint( result, nextSlope, continueFrom );
+    }
+    if ( triggeredPositionRaw && holdoff > 0.0 )
+        lastTriggerTime = streamTime + triggeredPositionRaw / sampleRate;
+
+    // Sub-sample trigger position: interpolate linearly between the two samples that
+    // bracket the level crossing. The graph generator shifts the trace by this fraction
+    // of one sample, removing the up to one sample jitter of the integer position.
+    double triggeredPositionSub = 0.0;
+    if ( triggeredPositionRaw > 0 ) {
+        const std::vector< double > &samples = *result.data[ channel ];
+        const double prev = samples[ size_t( triggeredPositionRaw ) - 1 ];
+        const double curr = samples[ size_t( triggeredPositionRaw ) ];
+        const double level = controlsettings.trigger.level[ channel ];
+        if ( curr != prev ) {
+            const double frac = ( level - prev ) / ( curr - prev ); // crossing between prev (0.0) and curr (1.0)
+            if ( frac > 0.0 && frac < 1.0 )
+                triggeredPositionSub = 1.0 - frac; // crossing precedes the sample by this fraction
+        }
+    }
+
     if ( triggeredPositionRaw ) { // triggered -> search also following other slope (calculate pulse width)
-        if ( int slopePos2 = searchTriggerPoint( result, mirrorSlope( nextSlope ), triggeredPositionRaw ) ) {
+        if ( int slopePos2 = searchTriggerPoint( result, mirrorSlope( nextSlope ), triggeredPositionRaw, false ) ) {
             pulseWidth1 = ( slopePos2 - triggeredPositionRaw ) / sampleRate;
-            if ( int slopePos3 = searchTriggerPoint( result, nextSlope, slopePos2 ) ) { // search 3rd slope
+            if ( int slopePos3 = searchTriggerPoint( result, nextSlope, slopePos2, false ) ) { // search 3rd slope
                 pulseWidth2 = ( slopePos3 - slopePos2 ) / sampleRate;
             }
         }
@@ -142,7 +314,37 @@ int Triggering::searchTriggeredPosition( DSOsamples &result ) {
             nextSlope = mirrorSlope( nextSlope );                // use opposite direction next time
     }
 
+    // Accumulate the trigger path counters of this scan
+    const double scanTime = double( scanTimer.nsecsElapsed() ) / 1000.0; // µs
+    ++triggerStats.blocksScanned;
+    if ( triggeredPositionRaw )
+        ++triggerStats.blocksTriggered;
+    triggerStats.scanTimeTotal += scanTime;
+    if ( scanTime > triggerStats.scanTimeMax )
+        triggerStats.scanTimeMax = scanTime;
+
+    // Memoize the scan together with its trigger setup; the alternation state
+    // (nextSlope) has already advanced and must not advance again on a carry over.
+    lastSearch.tag = result.tag;
+    lastSearch.valid = true;
+    lastSearch.source = controlsettings.trigger.source;
+    lastSearch.level = controlsettings.trigger.level[ channel ];
+    lastSearch.slope = controlsettings.trigger.slope;
+    lastSearch.smooth = controlsettings.trigger.smooth;
+    lastSearch.position = controlsettings.trigger.position;
+    lastSearch.samplerate = controlsettings.samplerate.current;
+    lastSearch.duration = controlsettings.samplerate.target.duration;
+    lastSearch.qualify = controlsettings.trigger.qualify;
+    lastSearch.pulseWidthMin = controlsettings.trigger.pulseWidthMin;
+    lastSearch.pulseWidthMax = controlsettings.trigger.pulseWidthMax;
+    lastSearch.holdoff = controlsettings.trigger.holdoff;
+    lastSearch.triggeredPosition = triggeredPositionRaw;
+    lastSearch.triggeredPositionSub = triggeredPositionSub;
+    lastSearch.pulseWidth1 = pulseWidth1;
+    lastSearch.pulseWidth2 = pulseWidth2;
+
     result.triggeredPosition = triggeredPositionRaw; // align trace to trigger position
+    result.triggeredPositionSub = triggeredPositionSub;
     result.pulseWidth1 = pulseWidth1;
     result.pulseWidth2 = pulseWidth2;
     if ( scope->verboseLevel > 5 ) // HACK: This assumes that positive=0 and negative=1
@@ -156,19 +358,25 @@ bool Triggering::provideTriggeredData( DSOsamples &result ) {
     if ( scope->verboseLevel > 4 )
         qDebug() << "    Triggering::provideTriggeredData()" << result.tag;
     static DSOsamples triggeredResult; // storage for last triggered trace samples
-    if ( result.triggeredPosition ) {  // live trace has triggered
+    // The channel buffers are shared pointers, saving and restoring the last triggered
+    // trace costs no sample copies; the next conversion unshares its target buffers.
+    if ( result.triggeredPosition ) { // live trace has triggered
         // Use this trace and save it also
         triggeredResult.data = result.data;
+        triggeredResult.stats = result.stats;
         triggeredResult.samplerate = result.samplerate;
         triggeredResult.clipped = result.clipped;
         triggeredResult.triggeredPosition = result.triggeredPosition;
+        triggeredResult.triggeredPositionSub = result.triggeredPositionSub;
         result.liveTrigger = true;
     } else if ( controlsettings.trigger.mode == Dso::TriggerMode::NORMAL ) { // Not triggered in NORMAL mode
         // Use saved trace (even if it is empty)
         result.data = triggeredResult.data;
+        result.stats = triggeredResult.stats;
         result.samplerate = triggeredResult.samplerate;
         result.clipped = triggeredResult.clipped;
         result.triggeredPosition = triggeredResult.triggeredPosition;
+        result.triggeredPositionSub = triggeredResult.triggeredPositionSub;
         result.liveTrigger = false; // show red "TR" top left
     } else {                        // Not triggered and not NORMAL mode
         // Use the free running trace, discard history
@@ -6,21 +6,69 @@
 #include "dsosamples.h"
 #include "errorcodes.h"
 #include "scopesettings.h"
+#include "utils/hotpath.h"
 
 class Triggering {
   public:
     explicit Triggering( const DsoSettingsScope *scope, const Dso::ControlSettings &controlsettings );
-    int searchTriggeredPosition( DSOsamples &result );
+    ~Triggering();
+    DSO_HOT int searchTriggeredPosition( DSOsamples &result );
     bool provideTriggeredData( DSOsamples &result );
     int getTriggeredPositionRaw() { return triggeredPositionRaw; }
     void resetTriggeredPositionRaw() { triggeredPositionRaw = 0; }
 
+    /// Cheap always-on counters of the trigger path, meant to quantify regressions
+    /// between releases; a summary is printed at exit when verboseLevel > 0.
+    struct Stats {
+        unsigned blocksScanned = 0;      ///< blocks that went through a full scan (memo hits excluded)
+        unsigned blocksTriggered = 0;    ///< scanned blocks that yielded a trigger
+        unsigned candidatesRejected = 0; ///< crossing candidates discarded by the smoothing verification
+        double scanTimeTotal = 0.0;      ///< summed scan time in µs
+        double scanTimeMax = 0.0;        ///< longest single scan in µs
+    };
+    const Stats &stats() const { return triggerStats; }
+
   private:
     const DsoSettingsScope *scope;
     const Dso::ControlSettings &controlsettings;
-    int searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int startPos = 0 );
+    DSO_HOT int searchTriggerPoint( DSOsamples &result, Dso::Slope dsoSlope, int startPos = 0, bool displayWindow = true );
     Dso::Slope mirrorSlope( Dso::Slope slope ) {
         return ( slope == Dso::Slope::Positive ? Dso::Slope::Negative : Dso::Slope::Positive );
     }
-    int triggeredPositionRaw = 0; // not triggered
+    int triggeredPositionRaw = 0;                   // not triggered
+    Dso::Slope nextSlope = Dso::Slope::Positive;    ///< for alternating slope mode X
+    /// Stream time bookkeeping for the trigger holdoff: the gapless stream blocks
+    /// advance an absolute time axis, the holdoff suppresses candidates that are
+    /// closer than the holdoff time to the previously accepted trigger.
+    double streamTime = 0.0;                        ///< stream time at the start of the current block
+    double streamBlockDuration = 0.0;               ///< duration of the current block in s
+    unsigned streamTag = 0;                         ///< block that streamTime refers to
+    double lastTriggerTime = -1e12;                 ///< stream time of the last accepted trigger
+    /// Smoothing prefix sums of the trigger trace, built once per scanned block and
+    /// shared by all edge searches of the pass; the capacity is reused across blocks.
+    std::vector< double > scanPrefix;               ///< running sum of the double trace
+    std::vector< int64_t > scanPrefixFP;            ///< running sum of the fixed point trace
+    Stats triggerStats;                             ///< accumulated trigger path counters
+    /// Memoized search result of the last scanned block. Display refreshes and holdOff
+    /// wakeups reprocess the same gapless stream block; with an unchanged trigger setup
+    /// the scan is carried over, so each incoming sample is inspected exactly once.
+    struct {
+        unsigned tag = 0;                           ///< block that was scanned
+        bool valid = false;                         ///< memo holds a usable result
+        int source = -1;                            ///< trigger setup of the scan ..
+        double level = 0.0;                         //
+        Dso::Slope slope = Dso::Slope::Positive;    //
+        int smooth = 0;                             //
+        double position = 0.0;                      //
+        double samplerate = 0.0;                    //
+        double duration = 0.0;                      //
+        Dso::TriggerQualify qualify = Dso::TriggerQualify::Edge; //
+        double pulseWidthMin = 0.0;                 //
+        double pulseWidthMax = 0.0;                 //
+        double holdoff = 0.0;                       // .. up to here
+        int triggeredPosition = 0;                  ///< scan result ..
+        double triggeredPositionSub = 0.0;          //
+        double pulseWidth1 = 0.0;                   //
+        double pulseWidth2 = 0.0;                   // .. to be restored
+    } lastSearch;
 };
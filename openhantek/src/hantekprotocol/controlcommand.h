@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <inttypes.h>
 #include <vector>
 
@@ -15,8 +16,12 @@ class ControlCommand : public std::vector< uint8_t > {
     ControlCommand( Hantek::ControlCode code, unsigned size );
 
   public:
-    bool pending = false;
+    /// set by the GUI thread, cleared by the capture thread after sending
+    std::atomic< bool > pending{ false };
     uint8_t code;
     uint8_t value = 0;
+    /// Payload of the last successful send; the capture thread compares it to
+    /// skip USB round trips that would re-send the state the device already has.
+    std::vector< uint8_t > lastSent;
     ControlCommand *next = nullptr;
 };
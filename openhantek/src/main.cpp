@@ -6,6 +6,7 @@
 #include <QElapsedTimer>
 #include <QLibraryInfo>
 #include <QLocale>
+#include <QSettings>
 #include <QStyleFactory>
 #include <QSurfaceFormat>
 #include <QTranslator>
@@ -25,30 +26,20 @@
 #endif
 #include <math.h>
 #include <memory>
+#include <thread>
 
 // Settings
-#include "dsosettings.h"
 #include "viewconstants.h"
 #include "viewsettings.h"
 
-// DSO core logic
-#include "capturing.h"
+// DSO core logic, one complete pipeline per device
 #include "dsomodel.h"
-#include "hantekdsocontrol.h"
+#include "dsosession.h"
+#include "utils/cpucaps.h"
+#include "utils/frametrace.h"
+#include "usb/finddevices.h"
 #include "usb/scopedevice.h"
 
-// Post processing
-#include "post/graphgenerator.h"
-// #include "post/mathchannelgenerator.h"
-#include "post/postprocessing.h"
-#include "post/spectrumgenerator.h"
-
-// Exporter
-#include "exporting/exportcsv.h"
-#include "exporting/exporterprocessor.h"
-#include "exporting/exporterregistry.h"
-#include "exporting/exportjson.h"
-
 // GUI
 #include "mainwindow.h"
 #include "selectdevice/selectsupporteddevice.h"
@@ -93,7 +84,16 @@ int main( int argc, char *argv[] ) {
 #endif
 
     bool demoMode = false;
+    QString demoShape = "ramp";  // waveform of the demo device generator
+    double demoFrequency = 1000; // CH1 demo frequency in Hz
+    QString traceFileName;       // dump the pipeline latency trace here at exit
+    QString recordFileName;      // record the captured raw stream for later replay
+    QString replayFileName;      // replay a recorded raw stream instead of capturing
+    double replaySpeed = 1.0;    // replay pacing multiplier, 0 = flat out
+    bool headless = false;       // acquisition-only mode without any widgets
+    int scpiPort = 0;            // TCP remote control port, 0 = no server
     bool autoConnect = true;
+    bool allDevices = false;
     bool useGLES = false;
     bool useGLSL120 = false;
     bool useGLSL150 = false;
@@ -138,7 +138,10 @@ int main( int argc, char *argv[] ) {
         QTranslator qtTranslator;
         QTranslator parserTranslator;
 
-        if ( useLocale && QLocale().name() != "en_US" ) { // somehow Qt on MacOS uses the german translation for en_US?!
+        // translated help texts matter only if there are arguments to parse, the
+        // common plain start skips these two extra .qm loads (the app translations
+        // for the UI itself are installed later, once, from the built-in resource)
+        if ( argc > 1 && useLocale && QLocale().name() != "en_US" ) { // somehow Qt on MacOS uses the german translation for en_US?!
             if ( qtTranslator.load( "qt_" + QLocale().name(), QLibraryInfo::location( QLibraryInfo::TranslationsPath ) ) ) {
                 parserApp.installTranslator( &qtTranslator );
             }
@@ -156,11 +159,22 @@ int main( int argc, char *argv[] ) {
         QCommandLineOption demoModeOption( { "d", "demoMode" },
                                            QCoreApplication::translate( "main", "Demo mode without scope HW" ) );
         p.addOption( demoModeOption );
+        QCommandLineOption demoShapeOption(
+            "demoShape", QCoreApplication::translate( "main", "Demo signal shape: ramp (default), sine, square, noise" ),
+            QCoreApplication::translate( "main", "Shape" ) );
+        p.addOption( demoShapeOption );
+        QCommandLineOption demoFrequencyOption(
+            "demoFrequency", QCoreApplication::translate( "main", "Demo signal frequency in Hz (default = 1000)" ),
+            QCoreApplication::translate( "main", "Hz" ) );
+        p.addOption( demoFrequencyOption );
         QCommandLineOption useGlesOption( { "e", "useGLES" },
                                           QCoreApplication::translate( "main", "Use OpenGL ES instead of OpenGL" ) );
         QCommandLineOption noAutoConnectOption( "noAutoConnect",
                                                 QCoreApplication::translate( "main", "Do not connect automatically" ) );
         p.addOption( noAutoConnectOption );
+        QCommandLineOption allDevicesOption(
+            "allDevices", QCoreApplication::translate( "main", "Open a parallel session for every connected scope" ) );
+        p.addOption( allDevicesOption );
         p.addOption( useGlesOption );
         QCommandLineOption useGLSL120Option( "useGLSL120", QCoreApplication::translate( "main", "Force OpenGL SL version 1.20" ) );
         p.addOption( useGLSL120Option );
@@ -189,11 +203,44 @@ int main( int argc, char *argv[] ) {
             "verbose", QCoreApplication::translate( "main", "Verbose tracing of program startup, ui and processing steps" ),
             QCoreApplication::translate( "main", "Level" ) );
         p.addOption( verboseOption );
+        QCommandLineOption headlessOption(
+            "headless",
+            QCoreApplication::translate(
+                "main", "Capture without scope window and rendering, for automated rigs (exporters are set up via --config)" ) );
+        p.addOption( headlessOption );
+        QCommandLineOption scpiPortOption(
+            "scpiPort",
+            QCoreApplication::translate( "main", "Listen for SCPI remote commands on this TCP port, stream data on port + 1" ),
+            QCoreApplication::translate( "main", "Port" ) );
+        p.addOption( scpiPortOption );
+        QCommandLineOption traceFileOption(
+            "traceFile", QCoreApplication::translate( "main", "Write the capture-to-display latency trace at exit (Chrome trace-event JSON)" ),
+            QCoreApplication::translate( "main", "File" ) );
+        p.addOption( traceFileOption );
+        QCommandLineOption recordStreamOption(
+            "recordStream", QCoreApplication::translate( "main", "Record the captured raw stream for later replay" ),
+            QCoreApplication::translate( "main", "File" ) );
+        p.addOption( recordStreamOption );
+        QCommandLineOption replayStreamOption(
+            "replayStream",
+            QCoreApplication::translate( "main", "Replay a recorded raw stream instead of capturing (no scope HW needed)" ),
+            QCoreApplication::translate( "main", "File" ) );
+        p.addOption( replayStreamOption );
+        QCommandLineOption replaySpeedOption(
+            "replaySpeed",
+            QCoreApplication::translate( "main", "Replay speed multiplier, >1 = faster than realtime, 0 = flat out (default = 1)" ),
+            QCoreApplication::translate( "main", "X" ) );
+        p.addOption( replaySpeedOption );
         p.process( parserApp );
         if ( p.isSet( configFileOption ) )
             configFileName = p.value( "config" );
         demoMode = p.isSet( demoModeOption );
+        if ( p.isSet( demoShapeOption ) )
+            demoShape = p.value( demoShapeOption ).toLower();
+        if ( p.isSet( demoFrequencyOption ) )
+            demoFrequency = p.value( demoFrequencyOption ).toDouble();
         autoConnect = !p.isSet( noAutoConnectOption );
+        allDevices = p.isSet( allDevicesOption );
         if ( p.isSet( fontOption ) )
             font = p.value( "font" );
         if ( p.isSet( sizeOption ) )
@@ -206,15 +253,32 @@ int main( int argc, char *argv[] ) {
         useLocale = !p.isSet( intOption );
         if ( p.isSet( verboseOption ) )
             verboseLevel = p.value( "verbose" ).toInt();
+        headless = p.isSet( headlessOption );
+        if ( p.isSet( scpiPortOption ) )
+            scpiPort = qBound( 0, p.value( scpiPortOption ).toInt(), 65534 );
+        if ( p.isSet( traceFileOption ) )
+            traceFileName = p.value( traceFileOption );
+        if ( p.isSet( recordStreamOption ) )
+            recordFileName = p.value( recordStreamOption );
+        if ( p.isSet( replayStreamOption ) ) {
+            replayFileName = p.value( replayStreamOption );
+            demoMode = true; // the replay pseudo device needs no USB hardware
+        }
+        if ( p.isSet( replaySpeedOption ) )
+            replaySpeed = qMax( 0.0, p.value( replaySpeedOption ).toDouble() );
         resetSettings = p.isSet( resetSettingsOption );
     } // ... and forget the no more needed variables
 
 
+    CpuCaps::detect(); // probe once here, the kernel dispatch just reads the result
     if ( verboseLevel ) {
         qDebug() << "Version:" << VERSION << "- build:" << __DATE__ << __TIME__;
+        qDebug() << "CPU features for the SIMD kernels:" << qPrintable( CpuCaps::summary() );
         qDebug() << startupTime.elapsed() << "ms:"
                  << "create openHantekApplication";
     }
+    if ( headless && qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" ); // no display connection needed on the rack
     QApplication openHantekApplication( argc, argv );
 
     // Qt5 linux styles ("Breeze", "Windows" or "Fusion")
@@ -329,6 +393,7 @@ int main( int argc, char *argv[] ) {
     libusb_context *context = nullptr;
 
     std::unique_ptr< ScopeDevice > scopeDevice = nullptr;
+    std::thread deviceProbeThread; // probes the remembered scope concurrently with the GUI warm up
 
     if ( !demoMode ) {
         if ( verboseLevel )
@@ -346,96 +411,45 @@ int main( int argc, char *argv[] ) {
         if ( useLocale ) // localize USB error messages, supported: "en", "nl", "fr", "ru"
             libusb_setlocale( QLocale().name().toLocal8Bit().constData() );
 
-        // SelectSupportedDevive returns a real device unless demoMode is true
-        if ( verboseLevel )
-            qDebug() << startupTime.elapsed() << "ms:"
-                     << "show splash screen";
-        scopeDevice = SelectSupportedDevice().showSelectDeviceModal( context, verboseLevel, autoConnect );
-        if ( scopeDevice && scopeDevice->isDemoDevice() ) {
-            libusb_exit( context ); // stop all USB activities
-            context = nullptr;
-        } else {
-            QString errorMessage;
-            if ( scopeDevice == nullptr || !scopeDevice->connectDevice( errorMessage ) ) {
-                libusb_exit( context ); // clean USB
-                context = nullptr;
-                if ( !errorMessage.isEmpty() )
-                    qCritical() << errorMessage;
-                return -1;
+        // Fast path for the common one-scope case: if the scope remembered from the
+        // last session is the only supported device on the bus and already has its
+        // firmware, connect it directly and skip the selection dialog round trips.
+        // The probe and connect take USB round trips that do not touch the GUI, so
+        // they run concurrently with the OpenGL and font setup below; the thread is
+        // joined before the selection dialog fallback needs the result.
+        deviceProbeThread = std::thread( [ &scopeDevice, context, &startupTime ]() {
+            QSettings storage;
+            const UniqueUSBid lastUSBid = storage.value( "device/lastUSBid", 0 ).toULongLong();
+            const QString lastModelName = storage.value( "device/lastModel" ).toString();
+            if ( lastUSBid ) {
+                if ( verboseLevel )
+                    qDebug() << startupTime.elapsed() << "ms:"
+                             << "probe last used device" << QString( "0x%1" ).arg( lastUSBid, 8, 16, QChar( '0' ) );
+                FindDevices findDevices( context, verboseLevel );
+                findDevices.updateDeviceList();
+                const FindDevices::DeviceList *devices = findDevices.getDevices();
+                FindDevices::DeviceList::const_iterator lastDevice = devices->find( lastUSBid );
+                if ( 1 == devices->size() && lastDevice != devices->end() && !lastDevice->second->needsFirmware() &&
+                     lastDevice->second->getModel()->name == lastModelName ) {
+                    scopeDevice = findDevices.takeDevice( lastUSBid );
+                    QString errorMessage;
+                    if ( scopeDevice && !scopeDevice->connectDevice( errorMessage ) ) {
+                        if ( !errorMessage.isEmpty() )
+                            qWarning() << errorMessage;
+                        scopeDevice.reset(); // fall back into the selection dialog
+                    }
+                }
             }
-        }
-    } else {
+        } );
+    } else if ( replayFileName.isEmpty() ) {
         scopeDevice = std::unique_ptr< ScopeDevice >( new ScopeDevice() );
+    } else {
+        scopeDevice = std::unique_ptr< ScopeDevice >( new ScopeDevice( replayFileName, replaySpeed ) );
     }
 
-    // Here we have either a connected scope device or a demo device w/o hardware
-    const DSOModel *model = scopeDevice->getModel();
-    if ( verboseLevel )
-        qDebug() << startupTime.elapsed() << "ms:"
-                 << "use device" << scopeDevice->getModel()->name << "serial number" << scopeDevice->getSerialNumber();
-
     if ( verboseLevel > 2 )
         qDebug() << "  main thread ID: " << QThread::currentThreadId();
 
-    //////// Create DSO control object and move it to a separate thread ////////
-    if ( verboseLevel )
-        qDebug() << startupTime.elapsed() << "ms:"
-                 << "create DSO control thread";
-    QThread dsoControlThread;
-    dsoControlThread.setObjectName( "dsoControlThread" );
-    HantekDsoControl dsoControl( scopeDevice.get(), model, verboseLevel );
-    dsoControl.moveToThread( &dsoControlThread );
-    QObject::connect( &dsoControlThread, &QThread::started, &dsoControl, &HantekDsoControl::stateMachine );
-    QObject::connect( &dsoControl, &HantekDsoControl::communicationError, QCoreApplication::instance(), &QCoreApplication::quit );
-    if ( scopeDevice )
-        QObject::connect( scopeDevice.get(), &ScopeDevice::deviceDisconnected, QCoreApplication::instance(),
-                          &QCoreApplication::quit );
-
-    const Dso::ControlSpecification *spec = model->spec();
-
-    //////// Create settings object specific to this scope, use unique serial number ////////
-    if ( verboseLevel )
-        qDebug() << startupTime.elapsed() << "ms:"
-                 << "create settings object";
-    DsoSettings settings( scopeDevice.get(), verboseLevel, resetSettings );
-
-    if ( !configFileName.isEmpty() )
-        settings.loadFromFile( configFileName );
-
-    //////// Create exporters ////////
-    if ( verboseLevel )
-        qDebug() << startupTime.elapsed() << "ms:"
-                 << "create exporters";
-    ExporterRegistry exportRegistry( spec, &settings );
-    ExporterCSV exporterCSV;
-    ExporterJSON exporterJSON;
-    ExporterProcessor samplesToExportRaw( &exportRegistry );
-    exportRegistry.registerExporter( &exporterCSV );
-    exportRegistry.registerExporter( &exporterJSON );
-
-    //////// Create post processing objects ////////
-    if ( verboseLevel )
-        qDebug() << startupTime.elapsed() << "ms:"
-                 << "create post processing objects";
-    QThread postProcessingThread;
-    postProcessingThread.setObjectName( "postProcessingThread" );
-    PostProcessing postProcessing( settings.scope.countChannels(), verboseLevel );
-
-    SpectrumGenerator spectrumGenerator( &settings.scope, &settings.analysis );
-    // math channel is now calculated in HantekDsoControl
-    // MathChannelGenerator mathchannelGenerator( &settings.scope, spec->channels );
-    GraphGenerator graphGenerator( &settings.scope, &settings.view );
-
-    postProcessing.registerProcessor( &samplesToExportRaw );
-    // postProcessing.registerProcessor( &mathchannelGenerator );
-    postProcessing.registerProcessor( &spectrumGenerator );
-    postProcessing.registerProcessor( &graphGenerator );
-
-    postProcessing.moveToThread( &postProcessingThread );
-    QObject::connect( &dsoControl, &HantekDsoControl::samplesAvailable, &postProcessing, &PostProcessing::input );
-    QObject::connect( &postProcessing, &PostProcessing::processingFinished, &exportRegistry, &ExporterRegistry::input,
-                      Qt::DirectConnection );
-
     if ( verboseLevel )
         qDebug() << startupTime.elapsed() << "ms:"
                  << "setup OpenGL";
@@ -458,10 +472,15 @@ int main( int argc, char *argv[] ) {
     GLSLversion = GLES100;
 #endif
 
-    // some fresh W10 installations announce this
-    // "OpenGL ES 2.0 (ANGLE ...)"
-    if ( QRegularExpression( "OpenGL ES " ).match( GlScope::getOpenGLversion() ).hasMatch() )
-        GLSLversion = GLES100; // set as default
+    // The GLES/ANGLE detection needs a throwaway OpenGL context which costs several
+    // 100 ms on small ARM boards; probe only when the result can change the choice:
+    // not when the command line forces a version and not when GLES is set anyway.
+    if ( !useGLES && !useGLSL120 && !useGLSL150 && GLES100 != GLSLversion ) {
+        // some fresh W10 installations announce this
+        // "OpenGL ES 2.0 (ANGLE ...)"
+        if ( QRegularExpression( "OpenGL ES " ).match( GlScope::getOpenGLversion() ).hasMatch() )
+            GLSLversion = GLES100; // set as default
+    }
 
     // override default with command line option
     if ( useGLES ) // 1st priority
@@ -475,15 +494,10 @@ int main( int argc, char *argv[] ) {
 
     //////// Prepare visual appearance ////////
     // prepare the font size, style and theme settings for the scope application
-    settings.scope.toolTipVisible = toolTipVisible; // show hints for beginners
-    settings.view.styleFusion = styleFusion;
-    settings.view.theme = theme;
     QFont appFont = openHantekApplication.font();
     if ( 0 == fontSize ) {                               // option -s0 -> use system font size
         fontSize = qBound( 6, appFont.pointSize(), 24 ); // values < 6 do not scale correctly
     }
-    // remember the actual fontsize setting
-    settings.view.fontSize = fontSize;
     appFont.setFamily( font ); // Fusion (or Windows) style + Arial (default) -> fit on small screen (Y >= 720)
     appFont.setStretch( condensed );
     appFont.setPointSize( fontSize ); // scales the widgets accordingly
@@ -494,27 +508,100 @@ int main( int argc, char *argv[] ) {
     openHantekApplication.setFont( appFont );
     openHantekApplication.setFont( appFont, "QWidget" ); // on some systems the 2nd argument is required
 
-    //////// Create main window ////////
+    //////// Finish the device selection ////////
+    if ( deviceProbeThread.joinable() ) // the probe overlapped the OpenGL and font setup above
+        deviceProbeThread.join();
+    if ( !demoMode ) {
+        // SelectSupportedDevive returns a real device unless demoMode is true
+        if ( !scopeDevice ) {
+            if ( verboseLevel )
+                qDebug() << startupTime.elapsed() << "ms:"
+                         << "show splash screen";
+            scopeDevice = SelectSupportedDevice().showSelectDeviceModal( context, verboseLevel, autoConnect );
+        }
+        if ( scopeDevice && scopeDevice->isDemoDevice() ) {
+            libusb_exit( context ); // stop all USB activities
+            context = nullptr;
+        } else {
+            QString errorMessage;
+            if ( scopeDevice == nullptr || !scopeDevice->connectDevice( errorMessage ) ) {
+                libusb_exit( context ); // clean USB
+                context = nullptr;
+                if ( !errorMessage.isEmpty() )
+                    qCritical() << errorMessage;
+                return -1;
+            }
+        }
+    }
+
+    // Here we have either a connected scope device or a demo device w/o hardware
     if ( verboseLevel )
         qDebug() << startupTime.elapsed() << "ms:"
-                 << "create main window";
-    MainWindow openHantekMainWindow( &dsoControl, &settings, &exportRegistry );
-    QObject::connect( &postProcessing, &PostProcessing::processingFinished, &openHantekMainWindow, &MainWindow::showNewData );
-    QObject::connect( &exportRegistry, &ExporterRegistry::exporterProgressChanged, &openHantekMainWindow,
-                      &MainWindow::exporterProgressChanged );
-    QObject::connect( &exportRegistry, &ExporterRegistry::exporterStatusChanged, &openHantekMainWindow,
-                      &MainWindow::exporterStatusChanged );
-    openHantekMainWindow.show();
-
-    //////// Start DSO thread and go into GUI main loop
+                 << "use device" << scopeDevice->getModel()->name << "serial number" << scopeDevice->getSerialNumber();
+
+    if ( scopeDevice->isRealHW() ) { // remember the scope for the fast reconnect on the next start
+        QSettings storage;
+        storage.setValue( "device/lastUSBid", quint64( scopeDevice->getUniqueUSBDeviceID() ) );
+        storage.setValue( "device/lastModel", scopeDevice->getModel()->name );
+    }
+
+    //////// Create one complete capture session per scope ////////
+    if ( verboseLevel )
+        qDebug() << startupTime.elapsed() << "ms:"
+                 << "create capture session(s)";
+    DsoSessionConfig sessionConfig;
+    sessionConfig.verboseLevel = verboseLevel;
+    sessionConfig.resetSettings = resetSettings;
+    sessionConfig.configFileName = configFileName;
+    sessionConfig.fontSize = fontSize;
+    sessionConfig.styleFusion = styleFusion;
+    sessionConfig.theme = theme;
+    sessionConfig.toolTipVisible = toolTipVisible;
+    sessionConfig.demoShape = demoShape;
+    sessionConfig.demoFrequency = demoFrequency;
+    sessionConfig.recordFileName = recordFileName;
+    sessionConfig.headless = headless;
+    sessionConfig.scpiPort = scpiPort;
+
+    const UniqueUSBid primaryUSBid = scopeDevice->getUniqueUSBDeviceID();
+    std::vector< std::unique_ptr< DsoSession > > sessions;
+    sessions.push_back( std::unique_ptr< DsoSession >( new DsoSession( std::move( scopeDevice ), sessionConfig ) ) );
+
+    if ( allDevices && context ) {
+        // Pick up all other ready-to-use supported scopes and give each one a parallel
+        // session with its own capture pipeline and scope window in this process.
+        FindDevices findDevices( context, verboseLevel );
+        findDevices.updateDeviceList();
+        std::vector< UniqueUSBid > foundIDs;
+        for ( const auto &entry : *findDevices.getDevices() )
+            foundIDs.push_back( entry.first );
+        for ( UniqueUSBid id : foundIDs ) {
+            if ( id == primaryUSBid ) // already running as the first session
+                continue;
+            std::unique_ptr< ScopeDevice > extraDevice = findDevices.takeDevice( id );
+            if ( !extraDevice || extraDevice->needsFirmware() )
+                continue;
+            QString errorMessage;
+            if ( !extraDevice->connectDevice( errorMessage ) ) {
+                if ( !errorMessage.isEmpty() )
+                    qWarning() << errorMessage;
+                continue;
+            }
+            if ( verboseLevel )
+                qDebug() << startupTime.elapsed() << "ms:"
+                         << "additional session for" << extraDevice->getModel()->name << extraDevice->getSerialNumber();
+            if ( sessionConfig.scpiPort > 0 ) // each session needs its own command + streaming port pair
+                sessionConfig.scpiPort += 2;
+            sessions.push_back( std::unique_ptr< DsoSession >( new DsoSession( std::move( extraDevice ), sessionConfig ) ) );
+        }
+    }
+
+    //////// Start DSO thread(s) and go into GUI main loop
     if ( verboseLevel )
         qDebug() << startupTime.elapsed() << "ms:"
-                 << "start DSO control thread";
-    dsoControl.enableSamplingUI();
-    postProcessingThread.start();
-    dsoControlThread.start();
-    CapturingThread capturingThread( &dsoControl ); // low level capture in separate thread
-    capturingThread.start();
+                 << "start DSO control thread(s)";
+    for ( auto &session : sessions )
+        session->start();
 
     if ( verboseLevel )
         qDebug() << startupTime.elapsed() << "ms:"
@@ -531,45 +618,26 @@ int main( int argc, char *argv[] ) {
     // the stepwise text output gives some hints about the shutdown timing
     // not needed with appropriate verbose level
     if ( verboseLevel < 2 )
-        std::cerr << "OpenHantek6022 "; // 1st part
+        std::cerr << "OpenHantek6022 has stopped "; // 1st part
 
-    dsoControl.quitSampling(); // send USB control command, stop bulk transfer
+    qint64 elapsed = headless ? startupTime.elapsed() : sessions.front()->window()->elapsedTime.elapsed();
+    for ( auto &session : sessions )
+        session->shutdown(); // stop sampling, all threads and the device, save calibration
 
-    // stop the capturing thread
-    // wait 2 * record time (delay is ms) for dso to finish
-    unsigned waitForDso = unsigned( 2000 * dsoControl.getSamplesize() / dsoControl.getSamplerate() );
-    waitForDso = qMax( waitForDso, 10000U ); // wait for at least 10 s
-    capturingThread.requestInterruption();
-    capturingThread.wait( waitForDso );
-    if ( verboseLevel < 2 )
-        std::cerr << "has "; // 2nd part
-
-    // now quit the data acquisition thread
-    // wait 2 * record time (delay is ms) for dso to finish
-    dsoControlThread.quit();
-    dsoControlThread.wait( waitForDso );
-    if ( verboseLevel < 2 )
-        std::cerr << "stopped "; // 3rd part
-
-    // next stop the data processing
-    postProcessing.stop();
-    postProcessingThread.quit();
-    postProcessingThread.wait( 10000 );
-    if ( verboseLevel < 2 )
-        std::cerr << "after "; // 4th part
+    sessions.clear();
 
-    dsoControl.prepareForShutdown();
+    // the pipeline stopped with the sessions, the trace ring is stable now
+    if ( !traceFileName.isEmpty() && !FrameTrace::dump( traceFileName ) )
+        qWarning() << "Could not write the latency trace to" << traceFileName;
 
-    // finally shut down the libUSB communication
-    if ( scopeDevice )
-        scopeDevice.reset(); // destroys unique_pointer, causes libusb_close(), must be called before libusb_exit()
+    // finally shut down the libUSB communication, all devices are closed now
     if ( context )
         libusb_exit( context );
 
     if ( verboseLevel >= 2 )
-        std::cerr << "OpenHantek6022 has stopped after "; // part 1..4
+        std::cerr << "OpenHantek6022 has stopped "; // 1st part
 
-    std::cerr << openHantekMainWindow.elapsedTime.elapsed() / 1000 << " s\n"; // last part
+    std::cerr << "after " << elapsed / 1000 << " s\n"; // last part
 
     return appStatus;
 }
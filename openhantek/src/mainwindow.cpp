@@ -5,6 +5,7 @@
 
 #include "HorizontalDock.h"
 #include "SpectrumDock.h"
+#include "StressDock.h"
 #include "TriggerDock.h"
 #include "VoltageDock.h"
 #include "dockwindows.h"
@@ -36,8 +37,10 @@
 
 #include "OH_VERSION.h"
 
-MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, ExporterRegistry *exporterRegistry, QWidget *parent )
-    : QMainWindow( parent ), ui( new Ui::MainWindow ), dsoSettings( settings ), exporterRegistry( exporterRegistry ) {
+MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, ExporterRegistry *exporterRegistry,
+                        PostProcessing *postProcessing, QWidget *parent )
+    : QMainWindow( parent ), ui( new Ui::MainWindow ), dsoControl( dsoControl ), dsoSettings( settings ),
+      exporterRegistry( exporterRegistry ) {
 
     if ( dsoSettings->scope.verboseLevel > 1 )
         qDebug() << " MainWindow::MainWindow()";
@@ -92,6 +95,11 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
         ui->actionHistogram->setToolTip( tr( "Show a histogram of the voltage levels on the right side of the trace" ) );
     else
         ui->actionHistogram->setToolTip( QString() );
+    ui->actionWaterfall->setShortcut( Qt::Key::Key_W );
+    if ( dsoSettings->scope.toolTipVisible )
+        ui->actionWaterfall->setToolTip( tr( "Show the spectra history as a scrolling waterfall behind the traces" ) );
+    else
+        ui->actionWaterfall->setToolTip( QString() );
     ui->actionZoom->setIcon( QIcon( iconPath + "zoom.svg" ) );
     ui->actionZoom->setShortcut( Qt::Key::Key_Z );
     if ( dsoSettings->scope.toolTipVisible )
@@ -151,7 +159,8 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
     action->setToolTip( tr( "Make an immediate (printable) hardcopy of the display and save it into the current directory" ) );
     connect( action, &QAction::triggered, this, [ this ]() {
         dsoWidget->switchToPrintColors();
-        QTimer::singleShot( 20, this, [ this ]() { screenShot( HARDCOPY, true ); } );
+        dsoWidget->repaint(); // synchronous, the scope scene redraws in print colors now
+        screenShot( HARDCOPY, true );
     } );
     ui->menuExport->addAction( action );
 
@@ -166,7 +175,8 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
     action->setToolTip( tr( "Make a (printable) hardcopy of the display and define the storage location" ) );
     connect( action, &QAction::triggered, this, [ this ]() {
         dsoWidget->switchToPrintColors();
-        QTimer::singleShot( 20, this, [ this ]() { screenShot( HARDCOPY ); } );
+        dsoWidget->repaint();
+        screenShot( HARDCOPY );
     } );
     ui->menuExport->addAction( action );
 
@@ -174,7 +184,8 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
     action->setToolTip( tr( "Send the hardcopy to a printer" ) );
     connect( action, &QAction::triggered, this, [ this ]() {
         dsoWidget->switchToPrintColors();
-        QTimer::singleShot( 20, this, [ this ]() { screenShot( PRINTER ); } );
+        dsoWidget->repaint();
+        screenShot( PRINTER );
     } );
     ui->menuExport->addAction( action );
 
@@ -211,11 +222,14 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
     HorizontalDock *horizontalDock = new HorizontalDock( scope, spec, this );
     TriggerDock *triggerDock = new TriggerDock( scope, spec, this );
     SpectrumDock *spectrumDock = new SpectrumDock( scope, this );
+    StressDock *stressDock = new StressDock( scope, dsoControl, postProcessing, this );
 
     addDockWidget( Qt::RightDockWidgetArea, voltageDock );
     addDockWidget( Qt::RightDockWidgetArea, horizontalDock );
     addDockWidget( Qt::RightDockWidgetArea, triggerDock );
     addDockWidget( Qt::RightDockWidgetArea, spectrumDock );
+    addDockWidget( Qt::RightDockWidgetArea, stressDock );
+    stressDock->hide(); // diagnostics on demand, restoreState() below restores a saved visibility
 
     restoreGeometry( dsoSettings->mainWindowGeometry );
     restoreState( dsoSettings->mainWindowState );
@@ -290,6 +304,11 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
              [ dsoControl, this ]() { dsoControl->setRecordTime( dsoSettings->scope.horizontal.timebase * DIVS_TIME ); } );
     connect( horizontalDock, &HorizontalDock::timebaseChanged, dsoWidget,
              [ this ]() { dsoWidget->updateTimebase( dsoSettings->scope.horizontal.timebase ); } );
+    // a new (deep memory) record length needs a matching samplerate and a fresh capture
+    connect( horizontalDock, &HorizontalDock::recordLengthChanged, dsoControl, [ dsoControl, this ]() {
+        dsoControl->setRecordTime( dsoSettings->scope.horizontal.timebase * DIVS_TIME );
+        dsoControl->restartSampling();
+    } );
     connect( spectrumDock, &SpectrumDock::frequencybaseChanged, dsoWidget,
              [ this ]( double frequencybase ) { dsoWidget->updateFrequencybase( frequencybase ); } );
     connect( dsoControl, &HantekDsoControl::samplerateChanged, horizontalDock,
@@ -323,6 +342,9 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
     // should we send the smooth mode also to dsoWidget?
     connect( triggerDock, &TriggerDock::slopeChanged, dsoControl, &HantekDsoControl::setTriggerSlope );
     connect( triggerDock, &TriggerDock::slopeChanged, dsoWidget, &DsoWidget::updateTriggerSlope );
+    connect( triggerDock, &TriggerDock::qualifyChanged, dsoControl, &HantekDsoControl::setTriggerQualify );
+    connect( triggerDock, &TriggerDock::pulseWidthChanged, dsoControl, &HantekDsoControl::setTriggerPulseWidth );
+    connect( triggerDock, &TriggerDock::holdoffChanged, dsoControl, &HantekDsoControl::setTriggerHoldoff );
     connect( dsoWidget, &DsoWidget::triggerPositionChanged, dsoControl, &HantekDsoControl::setTriggerPosition );
     connect( dsoWidget, &DsoWidget::triggerLevelChanged, dsoControl, &HantekDsoControl::setTriggerLevel );
 
@@ -392,6 +414,45 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
 
     connect( ui->actionRefresh, &QAction::triggered, dsoControl, &HantekDsoControl::restartSampling );
 
+    // Step back through the raw capture history ring after stop, e.g. to recall a
+    // one-off event that was on screen a few frames ago.
+    QAction *historyOlder = new QAction( tr( "History step back" ), this );
+    historyOlder->setShortcut( Qt::Key::Key_PageDown );
+    historyOlder->setToolTip( tr( "Show the previous captured block (only while stopped)" ) );
+    historyOlder->setEnabled( !dsoControl->isSamplingUI() );
+    connect( historyOlder, &QAction::triggered, dsoControl, [ dsoControl ]() { dsoControl->stepHistory( -1 ); } );
+    QAction *historyNewer = new QAction( tr( "History step forward" ), this );
+    historyNewer->setShortcut( Qt::Key::Key_PageUp );
+    historyNewer->setToolTip( tr( "Show the next captured block (only while stopped)" ) );
+    historyNewer->setEnabled( !dsoControl->isSamplingUI() );
+    connect( historyNewer, &QAction::triggered, dsoControl, [ dsoControl ]() { dsoControl->stepHistory( 1 ); } );
+    ui->menuView->addSeparator();
+    ui->menuView->addAction( historyOlder );
+    ui->menuView->addAction( historyNewer );
+
+    // Freeze the displayed traces into a persistent overlay, e.g. to compare a
+    // device under test visually against a golden unit captured earlier.
+    QAction *freezeReference = new QAction( tr( "Freeze reference trace" ), this );
+    freezeReference->setShortcut( Qt::Key::Key_R );
+    freezeReference->setToolTip( tr( "Keep the current trace on screen for comparison (persists across sessions)" ) );
+    connect( freezeReference, &QAction::triggered, dsoWidget, &DsoWidget::freezeReferenceTrace );
+    QAction *clearReference = new QAction( tr( "Clear reference trace" ), this );
+    clearReference->setToolTip( tr( "Remove the frozen comparison trace" ) );
+    connect( clearReference, &QAction::triggered, dsoWidget, &DsoWidget::clearReferenceTrace );
+    ui->menuView->addSeparator();
+    ui->menuView->addAction( freezeReference );
+    ui->menuView->addAction( clearReference );
+
+    // the diagnostics dock starts hidden, make it reachable from the view menu
+    QAction *stressAction = stressDock->toggleViewAction();
+    stressAction->setToolTip( tr( "Show the live waveform rate and pipeline stress numbers" ) );
+    ui->menuView->addSeparator();
+    ui->menuView->addAction( stressAction );
+    connect( dsoControl, &HantekDsoControl::showSamplingStatus, this, [ historyOlder, historyNewer ]( bool enabled ) {
+        historyOlder->setEnabled( !enabled );
+        historyNewer->setEnabled( !enabled );
+    } );
+
     connect( dsoControl, &HantekDsoControl::samplerateLimitsChanged, horizontalDock, &HorizontalDock::setSamplerateLimits );
     connect( dsoControl, &HantekDsoControl::samplerateSet, horizontalDock, &HorizontalDock::setSamplerateSteps );
 
@@ -448,6 +509,8 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
 
         DsoConfigDialog *configDialog = new DsoConfigDialog( dsoSettings, this );
         configDialog->setModal( true );
+        // refresh the color scheme in one batch when "Apply" or "Ok" saved the settings
+        connect( configDialog, &DsoConfigDialog::settingsSaved, dsoWidget, &DsoWidget::updateColors );
         configDialog->show();
     } );
 
@@ -472,6 +535,17 @@ MainWindow::MainWindow( HantekDsoControl *dsoControl, DsoSettings *settings, Exp
     ui->actionHistogram->setChecked( dsoSettings->scope.histogram );
     ui->actionHistogram->setEnabled( scope->horizontal.format == Dso::GraphFormat::TY );
 
+    connect( ui->actionWaterfall, &QAction::toggled, this, [ this ]( bool enabled ) {
+        dsoSettings->scope.waterfall = enabled;
+
+        if ( dsoSettings->scope.waterfall )
+            ui->actionWaterfall->setStatusTip( tr( "Hide waterfall" ) );
+        else
+            ui->actionWaterfall->setStatusTip( tr( "Show waterfall" ) );
+    } );
+    ui->actionWaterfall->setChecked( dsoSettings->scope.waterfall );
+    ui->actionWaterfall->setEnabled( scope->horizontal.format == Dso::GraphFormat::TY );
+
     connect( ui->actionZoom, &QAction::toggled, this, [ this ]( bool enabled ) {
         dsoSettings->view.zoom = enabled;
 
@@ -552,10 +626,20 @@ MainWindow::~MainWindow() {
 }
 
 
-void MainWindow::showNewData( std::shared_ptr< PPresult > newData ) {
+void MainWindow::showNewData( const std::shared_ptr< PPresult > &newData ) {
+    if ( firstFrameMs < 0 ) { // publish the startup budget, window creation to first trace
+        firstFrameMs = elapsedTime.elapsed();
+        if ( dsoSettings->scope.verboseLevel )
+            qDebug() << firstFrameMs << "ms:"
+                     << "first trace displayed";
+    }
     if ( dsoSettings->scope.verboseLevel > 5 )
         qDebug() << "     MainWindow::showNewData()" << newData->tag;
     dsoWidget->showNew( newData );
+    // refresh the health overlay with the displayed trace, just a few atomic reads
+    const HantekDsoControl::PipelineHealth health = dsoControl->pipelineHealth();
+    dsoWidget->showPipelineHealth( health.shortReads, health.usbRetries, health.zeroFilledBlocks, health.triggerOverruns,
+                                   health.captureCpu );
 }
 
 
@@ -629,9 +713,22 @@ void MainWindow::screenShot( screenshotType_t screenshotType, bool autoSafe ) {
         QStringList filters;
         fileName += ".png";
         if ( autoSafe ) { // save under default name as PNG without asking
-            if ( !screenshot.save( fileName ) )
-                QMessageBox::critical( this, QCoreApplication::applicationName(),
-                                       tr( "Write error\n%1" ).arg( QFileInfo{ fileName }.absoluteFilePath() ) );
+            // PNG compression of a full window takes tens of ms, encode and write in
+            // the background so periodic auto-screenshots don't stall the live display
+            screenshotWriter.wait(); // at most one save in flight, start() would overwrite a pending job
+            QImage image = screenshot.toImage();
+            screenshotWriter.start( [ this, image, fileName ]() {
+                if ( !image.save( fileName ) ) {
+#if ( QT_VERSION >= QT_VERSION_CHECK( 5, 10, 0 ) )
+                    QMetaObject::invokeMethod( this, [ this, fileName ]() { // dialogs belong to the GUI thread
+                        QMessageBox::critical( this, QCoreApplication::applicationName(),
+                                               tr( "Write error\n%1" ).arg( QFileInfo{ fileName }.absoluteFilePath() ) );
+                    } );
+#else
+                    qWarning() << "Write error" << QFileInfo{ fileName }.absoluteFilePath();
+#endif
+                }
+            } );
             return;
         }
         filters << tr( "Image (*.png *.jpg)" ) << tr( "Portable Document Format (*.pdf)" );
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #pragma once
+#include "hantekdso/convertworker.h"
 #include "post/ppresult.h"
 #include <QElapsedTimer>
 #include <QLineEdit>
@@ -11,6 +12,7 @@
 
 class SpectrumGenerator;
 class HantekDsoControl;
+class PostProcessing;
 class DsoSettings;
 class ExporterRegistry;
 class DsoWidget;
@@ -31,12 +33,12 @@ class MainWindow : public QMainWindow {
 
   public:
     explicit MainWindow( HantekDsoControl *dsoControl, DsoSettings *dsoSettings, ExporterRegistry *exporterRegistry,
-                         QWidget *parent = nullptr );
+                         PostProcessing *postProcessing, QWidget *parent = nullptr );
     ~MainWindow() override;
     QElapsedTimer elapsedTime;
 
   public slots:
-    void showNewData( std::shared_ptr< PPresult > newData );
+    void showNewData( const std::shared_ptr< PPresult > &newData );
     void exporterStatusChanged( const QString &exporterName, const QString &status );
     void exporterProgressChanged();
 
@@ -52,6 +54,9 @@ class MainWindow : public QMainWindow {
     // Central widgets
     DsoWidget *dsoWidget;
 
+    // Scope control, queried for the pipeline health counters
+    HantekDsoControl *dsoControl;
+
     // Settings used for the whole program
     DsoSettings *dsoSettings;
     ExporterRegistry *exporterRegistry;
@@ -60,6 +65,8 @@ class MainWindow : public QMainWindow {
     enum screenshotType_t { SCREENSHOT, HARDCOPY, PRINTER };
     screenshotType_t screenshotType;
     void screenShot( screenshotType_t screenshotType = SCREENSHOT, bool autoSave = false );
+    ConvertWorker screenshotWriter; ///< encodes and saves auto-screenshots off the GUI thread
+    qint64 firstFrameMs = -1;       ///< time from window creation to the first displayed trace
 
     bool openDocument( QString docName );
 
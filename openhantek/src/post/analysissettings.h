@@ -40,8 +40,33 @@ QString windowFunctionString( WindowFunction window );
 
 Q_DECLARE_METATYPE( Dso::WindowFunction )
 
+namespace Dso {
+
+/// \enum DecoderMode
+/// \brief The serial protocols the decoder stage (post/decoder.h) understands.
+enum class DecoderMode : int {
+    OFF,  ///< no decoding
+    UART, ///< async serial, 8N1, idle high, LSB first
+    I2C,  ///< SDA + SCL, 7 bit addressing
+    SPI   ///< SCK + MOSI, 8 bit words, MSB first, no chip select
+};
+
+const auto LastDecoderMode = DecoderMode::SPI;
+
+} // namespace Dso
+
 struct DsoSettingsAnalysis {
     Dso::WindowFunction spectrumWindow = Dso::WindowFunction::HAMMING; ///< Window function for DFT
     double spectrumLimit = -60.0;                                      ///< Minimum magnitude of the spectrum (Avoids peaks)
     bool reuseFftPlan = false;                                         ///< Optimize FFT plan and reuse it
+    bool singlePrecisionFft = false;                                   ///< Calculate the FFT in single precision
+    unsigned spectrumLength = 0; ///< FFT length (power of two), 0 = transform the full record; shorter
+                                 ///< transforms average overlapping segments (Welch's method)
+    unsigned measurementStride = 1;                                    ///< Scan every n-th sample for the scalar measurements
+    Dso::DecoderMode decoderMode = Dso::DecoderMode::OFF;              ///< Protocol decoded over the displayed trace
+    unsigned decoderDataChannel = 0;  ///< UART RX / I2C SDA / SPI MOSI channel
+    unsigned decoderClockChannel = 1; ///< I2C SCL / SPI SCK channel
+    double decoderBaud = 115200.0;    ///< UART baud rate, 0 = auto from the shortest bit
+    unsigned decoderSpiMode = 0;      ///< SPI mode 0..3 (CPOL * 2 + CPHA)
+    double decoderThreshold = 0.0;    ///< Logic threshold in V, 0.0 = auto (midpoint of the trace)
 };
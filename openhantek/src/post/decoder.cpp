@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cmath>
+
+#include <QDebug>
+
+#include "decoder.h"
+#include "viewconstants.h"
+
+
+Decoder::Decoder( const DsoSettingsScope *scope, const DsoSettingsAnalysis *analysis ) : scope( scope ), analysis( analysis ) {}
+
+
+void Decoder::process( PPresult *result ) {
+    result->decoderAnnotations.clear();
+    if ( analysis->decoderMode == Dso::DecoderMode::OFF ) {
+        lastSignature = Signature(); // invalidate, settings may change while off
+        return;
+    }
+
+    Signature signature;
+    signature.mode = analysis->decoderMode;
+    signature.dataChannel = analysis->decoderDataChannel;
+    signature.clockChannel = analysis->decoderClockChannel;
+    signature.baud = analysis->decoderBaud;
+    signature.spiMode = analysis->decoderSpiMode;
+    signature.threshold = analysis->decoderThreshold;
+    signature.timebase = scope->horizontal.timebase;
+    signature.triggerPosition = scope->trigger.position;
+    signature.tag = result->tag;
+    signature.triggeredPosition = result->triggeredPosition;
+    if ( signature == lastSignature ) { // identical re-display of an already decoded block
+        result->decoderAnnotations = cache;
+        return;
+    }
+
+    annotations.clear();
+    const DataChannel *channelData = result->data( analysis->decoderDataChannel );
+    if ( channelData && !channelData->voltage.samples->empty() ) {
+        // the same visible window mapping the graph generator uses, so the
+        // annotations line up with the drawn trace
+        sampleInterval = channelData->voltage.interval;
+        horizontalFactor = sampleInterval / scope->horizontal.timebase;
+        const int dotsOnScreen = int( ceil( DIVS_TIME / horizontalFactor ) );
+        const int preTrigSamples = int( scope->trigger.position * dotsOnScreen );
+        leftmostSample = result->triggeredPosition;
+        if ( leftmostSample )
+            leftmostSample -= preTrigSamples + 1;
+        leftmostPosition = 0;
+        if ( leftmostSample < 0 ) { // the trace starts right of the left margin
+            leftmostPosition = -leftmostSample;
+            leftmostSample = 0;
+        }
+        visibleSamples =
+            qMin( int( channelData->voltage.samples->size() ) - leftmostSample, dotsOnScreen + 1 - leftmostPosition );
+        if ( visibleSamples > 1 && digitize( result, analysis->decoderDataChannel, dataLevels ) ) {
+            switch ( analysis->decoderMode ) {
+            case Dso::DecoderMode::UART:
+                decodeUART( result );
+                break;
+            case Dso::DecoderMode::I2C:
+                if ( digitize( result, analysis->decoderClockChannel, clockLevels ) )
+                    decodeI2C( result );
+                break;
+            case Dso::DecoderMode::SPI:
+                if ( digitize( result, analysis->decoderClockChannel, clockLevels ) )
+                    decodeSPI( result );
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    if ( scope->verboseLevel > 4 )
+        qDebug() << "    Decoder::process()" << result->tag << int( analysis->decoderMode ) << "annotations:" << annotations.size();
+
+    result->decoderAnnotations = annotations;
+    cache = annotations; // reused as long as tag and settings stay unchanged
+    lastSignature = signature;
+}
+
+
+bool Decoder::digitize( const PPresult *result, unsigned channel, std::vector< bool > &levels ) {
+    const DataChannel *channelData = result->data( channel );
+    if ( !channelData || int( channelData->voltage.samples->size() ) < leftmostSample + visibleSamples )
+        return false;
+    const double *samples = channelData->voltage.samples->data() + leftmostSample;
+    double threshold = analysis->decoderThreshold;
+    if ( threshold == 0.0 ) // auto: midpoint of the displayed trace
+        threshold = 0.5 * ( channelData->vmin + channelData->vmax );
+    // hysteresis band against noise on slow edges; require a minimum swing,
+    // an idle or unconnected channel must not digitize into random bits
+    const double span = channelData->vmax - channelData->vmin;
+    if ( span < 0.1 )
+        return false;
+    const double hysteresis = qMax( 0.05 * span, 0.01 );
+    levels.resize( size_t( visibleSamples ) );
+    bool level = samples[ 0 ] > threshold;
+    for ( int i = 0; i < visibleSamples; ++i ) {
+        if ( samples[ i ] > threshold + hysteresis )
+            level = true;
+        else if ( samples[ i ] < threshold - hysteresis )
+            level = false;
+        levels[ size_t( i ) ] = level;
+    }
+    return true;
+}
+
+
+void Decoder::addAnnotation( double startSample, double endSample, const QString &text, bool error ) {
+    if ( annotations.size() >= annotationLimit )
+        return;
+    DecoderAnnotation annotation;
+    annotation.xStart = float( MARGIN_LEFT + ( leftmostPosition + startSample ) * horizontalFactor );
+    annotation.xEnd = float( MARGIN_LEFT + ( leftmostPosition + endSample ) * horizontalFactor );
+    annotation.text = text;
+    annotation.error = error;
+    annotations.push_back( annotation );
+}
+
+
+// Async serial, 8N1, idle high, LSB first. With baud = 0 the bit time is taken
+// from the shortest stable level run of the trace (auto baud).
+void Decoder::decodeUART( PPresult *result ) {
+    Q_UNUSED( result )
+    const size_t count = dataLevels.size();
+    double samplesPerBit = 0.0;
+    if ( analysis->decoderBaud > 0.0 ) {
+        samplesPerBit = 1.0 / ( analysis->decoderBaud * sampleInterval );
+    } else { // auto baud: the shortest run between two edges is one bit
+        size_t runStart = 0, minRun = count;
+        for ( size_t i = 1; i < count; ++i ) {
+            if ( dataLevels[ i ] != dataLevels[ i - 1 ] ) {
+                const size_t run = i - runStart;
+                if ( run >= 2 && run < minRun ) // ignore single sample glitches
+                    minRun = run;
+                runStart = i;
+            }
+        }
+        if ( minRun == count )
+            return; // no edges, nothing to decode
+        samplesPerBit = double( minRun );
+    }
+    if ( samplesPerBit < 2.0 )
+        return; // less than two samples per bit cannot be decoded reliably
+
+    size_t pos = 1;
+    while ( pos < count ) {
+        // find the falling start bit edge
+        while ( pos < count && !( dataLevels[ pos - 1 ] && !dataLevels[ pos ] ) )
+            ++pos;
+        if ( pos >= count )
+            break;
+        const double frameStart = double( pos );
+        if ( frameStart + 10.0 * samplesPerBit > double( count ) )
+            break; // incomplete frame at the right edge
+        if ( dataLevels[ size_t( frameStart + 0.5 * samplesPerBit ) ] ) {
+            ++pos; // start bit did not stay low, a glitch - resync on the next edge
+            continue;
+        }
+        unsigned byte = 0;
+        for ( unsigned bit = 0; bit < 8; ++bit ) // sample each data bit at its center
+            if ( dataLevels[ size_t( frameStart + ( 1.5 + bit ) * samplesPerBit ) ] )
+                byte |= 1u << bit;
+        const bool frameError = !dataLevels[ size_t( frameStart + 9.5 * samplesPerBit ) ]; // stop bit must be high
+        addAnnotation( frameStart, frameStart + 10.0 * samplesPerBit,
+                       QString( "%1" ).arg( byte, 2, 16, QChar( '0' ) ).toUpper(), frameError );
+        pos = size_t( frameStart + 10.0 * samplesPerBit );
+    }
+}
+
+
+// SDA (data channel) + SCL (clock channel), 7 bit addressing. Bytes are sampled
+// on the SCL rising edge, MSB first, followed by the ACK bit.
+void Decoder::decodeI2C( PPresult *result ) {
+    Q_UNUSED( result )
+    const size_t count = qMin( dataLevels.size(), clockLevels.size() );
+    bool inFrame = false;
+    bool addressByte = false;
+    unsigned bits = 0;
+    unsigned byte = 0;
+    size_t byteStart = 0;
+    for ( size_t i = 1; i < count; ++i ) {
+        const bool sdaRose = !dataLevels[ i - 1 ] && dataLevels[ i ];
+        const bool sdaFell = dataLevels[ i - 1 ] && !dataLevels[ i ];
+        if ( clockLevels[ i ] && clockLevels[ i - 1 ] ) { // SCL stable high: bus condition
+            if ( sdaFell ) {                              // START (or repeated START)
+                addAnnotation( double( i ), double( i ), "S" );
+                inFrame = true;
+                addressByte = true;
+                bits = 0;
+                byte = 0;
+            } else if ( sdaRose && inFrame ) { // STOP
+                addAnnotation( double( i ), double( i ), "P" );
+                inFrame = false;
+            }
+            continue;
+        }
+        if ( inFrame && !clockLevels[ i - 1 ] && clockLevels[ i ] ) { // SCL rising: sample SDA
+            if ( bits == 0 )
+                byteStart = i;
+            if ( bits < 8 ) {
+                byte = ( byte << 1 ) | unsigned( dataLevels[ i ] );
+                ++bits;
+            } else { // the 9th bit is the ACK, low = acknowledged
+                const bool ack = !dataLevels[ i ];
+                QString text;
+                if ( addressByte )
+                    text = QString( "%1 %2" )
+                               .arg( byte >> 1, 2, 16, QChar( '0' ) )
+                               .arg( ( byte & 1 ) ? "R" : "W" )
+                               .toUpper();
+                else
+                    text = QString( "%1" ).arg( byte, 2, 16, QChar( '0' ) ).toUpper();
+                if ( !ack )
+                    text += " N"; // NAK, an error only on the address byte
+                addAnnotation( double( byteStart ), double( i ), text, addressByte && !ack );
+                addressByte = false;
+                bits = 0;
+                byte = 0;
+            }
+        }
+    }
+}
+
+
+// SCK (clock channel) + MOSI (data channel), 8 bit words, MSB first, no chip
+// select on a two channel scope - word sync comes from the trigger anchor and
+// from clock gaps longer than four bit times.
+void Decoder::decodeSPI( PPresult *result ) {
+    Q_UNUSED( result )
+    const size_t count = qMin( dataLevels.size(), clockLevels.size() );
+    const unsigned cpol = ( analysis->decoderSpiMode >> 1 ) & 1;
+    const unsigned cpha = analysis->decoderSpiMode & 1;
+    const bool sampleRising = cpol == cpha; // modes 0 and 3 sample on the rising edge
+    unsigned bits = 0;
+    unsigned byte = 0;
+    size_t byteStart = 0;
+    size_t lastEdge = 0;
+    double edgeSpacing = 0.0; // running bit time estimate from the edge distances
+    for ( size_t i = 1; i < count; ++i ) {
+        const bool edge = sampleRising ? ( !clockLevels[ i - 1 ] && clockLevels[ i ] )
+                                       : ( clockLevels[ i - 1 ] && !clockLevels[ i ] );
+        if ( !edge )
+            continue;
+        if ( lastEdge ) {
+            const double spacing = double( i - lastEdge );
+            if ( edgeSpacing > 0.0 && spacing > 4.0 * edgeSpacing && bits ) {
+                bits = 0; // clock pause: drop the partial word and resync
+                byte = 0;
+            }
+            edgeSpacing = edgeSpacing > 0.0 ? qMin( edgeSpacing, spacing ) : spacing;
+        }
+        lastEdge = i;
+        if ( bits == 0 )
+            byteStart = i;
+        byte = ( byte << 1 ) | unsigned( dataLevels[ i ] );
+        if ( ++bits == 8 ) {
+            addAnnotation( double( byteStart ), double( i ), QString( "%1" ).arg( byte, 2, 16, QChar( '0' ) ).toUpper() );
+            bits = 0;
+            byte = 0;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "analysissettings.h"
+#include "ppresult.h"
+#include "processor.h"
+#include "scopesettings.h"
+
+/// \brief Serial protocol decoder stage (UART / I2C / SPI).
+/// Runs in the processor chain between the spectrum generator and the graph
+/// generator and decodes the converted in-memory samples of the displayed trace,
+/// anchored on the triggered position so the bit phase is stable from block to
+/// block - no export round trip through external decoders is needed. The decoded
+/// items land in `PPresult::decoderAnnotations` (positions in screen divisions,
+/// the coordinate system of the graph vertices) and are rendered by GlScope as an
+/// overlay above the traces.
+///
+/// Re-displays of the same block (refresh re-conversions, frozen traces carry the
+/// same `tag`) reuse the cached annotations of the previous pass instead of
+/// decoding again; the cache is dropped when the tag or any decode-relevant
+/// setting (protocol, channels, baud, threshold, timebase, trigger) changes.
+class Decoder : public Processor {
+
+  public:
+    Decoder( const DsoSettingsScope *scope, const DsoSettingsAnalysis *analysis );
+    const char *name() const override { return "decode"; }
+    void process( PPresult *result ) override;
+
+  private:
+    /// Everything the decode result depends on besides the samples themselves;
+    /// a cached result is only reused while this signature stays unchanged.
+    struct Signature {
+        Dso::DecoderMode mode = Dso::DecoderMode::OFF;
+        unsigned dataChannel = 0;
+        unsigned clockChannel = 0;
+        double baud = 0.0;
+        unsigned spiMode = 0;
+        double threshold = 0.0;
+        double timebase = 0.0;
+        double triggerPosition = 0.0;
+        unsigned tag = 0;
+        int triggeredPosition = 0;
+        bool operator==( const Signature &other ) const {
+            return mode == other.mode && dataChannel == other.dataChannel && clockChannel == other.clockChannel &&
+                   baud == other.baud && spiMode == other.spiMode && threshold == other.threshold &&
+                   timebase == other.timebase && triggerPosition == other.triggerPosition && tag == other.tag &&
+                   triggeredPosition == other.triggeredPosition;
+        }
+    };
+
+    /// \brief Digitize the visible part of one channel with hysteresis.
+    /// \return false if the channel has no samples or no level swing to digitize.
+    bool digitize( const PPresult *result, unsigned channel, std::vector< bool > &levels );
+    void decodeUART( PPresult *result );
+    void decodeI2C( PPresult *result );
+    void decodeSPI( PPresult *result );
+    void addAnnotation( double startSample, double endSample, const QString &text, bool error = false );
+
+    const DsoSettingsScope *scope;
+    const DsoSettingsAnalysis *analysis;
+
+    // Visible window of the current block, set up by process() with the same
+    // mapping the graph generator uses, so annotations line up with the trace.
+    int leftmostSample = 0;       ///< first displayed sample index
+    int leftmostPosition = 0;     ///< display position of that sample, > 0 right of the margin
+    int visibleSamples = 0;       ///< displayed sample count
+    double horizontalFactor = 0.0; ///< divs per sample
+    double sampleInterval = 0.0;  ///< seconds per sample
+
+    std::vector< bool > dataLevels;  ///< digitized data channel of the visible window
+    std::vector< bool > clockLevels; ///< digitized clock channel of the visible window
+
+    std::vector< DecoderAnnotation > annotations; ///< decode target, moved into the result
+    Signature lastSignature;                      ///< decode inputs of the cached annotations
+    std::vector< DecoderAnnotation > cache;       ///< annotations of the last decoded block
+
+    /// Upper bound on the annotations of one trace; a fast protocol on a slow
+    /// timebase could otherwise produce tens of thousands of unreadable labels.
+    static const size_t annotationLimit = 1000;
+};
@@ -3,9 +3,11 @@
 #include <QDebug>
 #include <QMutex>
 #include <math.h>
+#include <stdlib.h>
 
 #include "graphgenerator.h"
 #include "hantekdso/controlspecification.h"
+#include "hantekdso/convertsimd.h"
 #include "ppresult.h"
 #include "scopesettings.h"
 #include "utils/printutils.h"
@@ -37,15 +39,87 @@ GraphGenerator::GraphGenerator( const DsoSettingsScope *scope, const DsoSettings
 
 
 void GraphGenerator::prepareSinc( void ) {
-    // prepare a sinc table (without sinc(0))
-    sinc.clear();
-    sinc.resize( sincSize );
-    auto sincIt = sinc.begin();
-    for ( unsigned int pos = 1; pos <= sincSize; ++pos, ++sincIt ) {
+    // full quality rung: two period windowed sinc, 5 times oversampled
+    buildSincKernel( sincKernel, 2, 5 );
+    // cheap rung: one period only and 3 times oversampled, about a third of the work
+    buildSincKernel( sincShortKernel, 1, 3 );
+    buildCatmullKernel( catmullKernel, 5 );
+}
+
+
+void GraphGenerator::buildSincKernel( ResampleKernel &kernel, unsigned width, unsigned oversample ) {
+    kernel.width = width;
+    kernel.oversample = oversample;
+    const unsigned sincSize = width * oversample; // half size of the kernel
+    // the kernel values, taps[ 0 ] = sinc( 0 ) = 1
+    std::vector< double > taps( sincSize + 1 );
+    taps[ 0 ] = 1.0;
+    for ( unsigned int pos = 1; pos <= sincSize; ++pos ) {
         double t = pos * M_PI / oversample;
         // Hann window: 0.5 + 0.5 cos, Hamming: 0.54 + 0.46 cos
         double w = 0.54 + 0.46 * cos( pos * M_PI / sincSize );
-        *sincIt = w * sin( t ) / t;
+        taps[ pos ] = w * sin( t ) / t;
+    }
+    // reorder it into polyphase rows, see ResampleKernel
+    const unsigned rowTaps = 2 * width + 1;
+    kernel.phases.assign( oversample * rowTaps, 0.0 );
+    for ( unsigned p = 0; p < oversample; ++p )
+        for ( unsigned r = 0; r < rowTaps; ++r ) {
+            int offset = ( int( width ) - int( r ) ) * int( oversample ) + int( p );
+            if ( unsigned( abs( offset ) ) <= sincSize )
+                kernel.phases[ p * rowTaps + r ] = taps[ unsigned( abs( offset ) ) ];
+        }
+}
+
+
+void GraphGenerator::buildCatmullKernel( ResampleKernel &kernel, unsigned oversample ) {
+    // Catmull-Rom cubic in the polyphase scheme: the p-th output point between the
+    // input samples q and q + 1 interpolates the four neighbours q - 1 .. q + 2, so
+    // the rows use width 2 with a zero leftmost tap
+    kernel.width = 2;
+    kernel.oversample = oversample;
+    const unsigned rowTaps = 2 * kernel.width + 1;
+    kernel.phases.assign( oversample * rowTaps, 0.0 );
+    for ( unsigned p = 0; p < oversample; ++p ) {
+        double t = double( p ) / oversample;
+        double *row = kernel.phases.data() + p * rowTaps;
+        row[ 1 ] = 0.5 * ( -t + 2 * t * t - t * t * t );    // q - 1
+        row[ 2 ] = 0.5 * ( 2 - 5 * t * t + 3 * t * t * t ); // q
+        row[ 3 ] = 0.5 * ( t + 4 * t * t - 3 * t * t * t ); // q + 1
+        row[ 4 ] = 0.5 * ( -t * t + t * t * t );            // q + 2
+    }
+}
+
+
+void GraphGenerator::resampleRange( const ResampleKernel &kernel, const double *input, unsigned inputCount, unsigned qBegin,
+                                    unsigned qEnd ) {
+    const unsigned width = kernel.width;
+    const unsigned oversample = kernel.oversample;
+    const unsigned taps = 2 * width + 1;
+    for ( unsigned q = qBegin; q < qEnd; ++q ) {
+        double *out = resample.data() + size_t( q ) * oversample;
+        if ( q >= width && q + width < inputCount ) { // interior, no bounds checks needed
+            const double *in = input + ( q - width );
+            const double *row = kernel.phases.data();
+            for ( unsigned p = 0; p < oversample; ++p ) {
+                double sum = 0.0;
+                for ( unsigned r = 0; r < taps; ++r )
+                    sum += row[ r ] * in[ r ];
+                out[ p ] = sum;
+                row += taps;
+            }
+        } else { // trace edges, skip the taps that reach outside of the input
+            for ( unsigned p = 0; p < oversample; ++p ) {
+                const double *row = kernel.phases.data() + p * taps;
+                double sum = 0.0;
+                for ( unsigned r = 0; r < taps; ++r ) {
+                    int n = int( q ) - int( width ) + int( r );
+                    if ( n >= 0 && n < int( inputCount ) )
+                        sum += row[ r ] * input[ n ];
+                }
+                out[ p ] = sum;
+            }
+        }
     }
 }
 
@@ -67,18 +141,38 @@ void GraphGenerator::generateGraphsTYvoltage( PPresult *result ) {
         qDebug() << "     GraphGenerator::generateGraphsTYvoltage()" << result->tag;
     result->vaChannelVoltage.resize( scope->voltage.size() );
     result->vaChannelHistogram.resize( scope->voltage.size() );
+    result->vaChannelEnvelope.resize( scope->voltage.size() );
     bool interpolationStep = view->interpolation == Dso::INTERPOLATION_STEP;
-    bool interpolationSinc = view->interpolation == Dso::INTERPOLATION_SINC;
+    // pick the upsampling rung of the quality/speed ladder; over budget every rung
+    // degrades one step: full sinc runs with the short kernel, the remaining rungs
+    // fall back to the plain linear drawing
+    const bool over = overBudget.load( std::memory_order_relaxed );
+    const ResampleKernel *upsampler = nullptr;
+    switch ( view->interpolation ) {
+    case Dso::INTERPOLATION_SINC:
+        upsampler = over ? &sincShortKernel : &sincKernel;
+        break;
+    case Dso::INTERPOLATION_CATMULLROM:
+        upsampler = over ? nullptr : &catmullKernel;
+        break;
+    case Dso::INTERPOLATION_SINC_SHORT:
+        upsampler = over ? nullptr : &sincShortKernel;
+        break;
+    default:
+        break;
+    }
     for ( ChannelID channel = 0; channel < scope->voltage.size(); ++channel ) {
         ChannelGraph &graphVoltage = result->vaChannelVoltage[ channel ];
         ChannelGraph &graphHistogram = result->vaChannelHistogram[ channel ];
+        ChannelGraph &graphEnvelope = result->vaChannelEnvelope[ channel ];
         const SampleValues &sampleValues = useVoltSamplesOf( channel, result, scope );
 
         // Check if this channel is used and available at the data analyzer
-        if ( sampleValues.samples.empty() ) {
+        if ( sampleValues.samples->empty() ) {
             // Delete all vector arrays
             graphVoltage.clear();
             graphHistogram.clear();
+            graphEnvelope.clear();
             continue;
         }
 
@@ -97,72 +191,195 @@ void GraphGenerator::generateGraphsTYvoltage( PPresult *result ) {
             leftmostPosition = -leftmostSample;   // trace can't start on left margin
             leftmostSample = 0;                   // show as much as we have on left side
         }
+        // fractional phase shift from the sub-sample trigger interpolation; it keeps the
+        // level crossing exactly on the trigger mark instead of jittering by one sample
+        const double subSampleShift = result->triggeredPosition ? result->triggeredPositionSub * horizontalFactor : 0.0;
+
+        // Acquisition envelope band (min/max across frames, see HantekDsoControl):
+        // rendered as one alternating min/max zigzag line strip, the same trick the
+        // per column decimation below uses; the renderer draws it behind the trace.
+        const DataChannel *channelData = result->data( channel );
+        if ( channelData && !channelData->envelopeMin.samples->empty() &&
+             channelData->envelopeMax.samples->size() == channelData->envelopeMin.samples->size() ) {
+            const std::vector< double > &eMin = *channelData->envelopeMin.samples;
+            const std::vector< double > &eMax = *channelData->envelopeMax.samples;
+            const int available = int( eMin.size() ) - leftmostSample;
+            const unsigned screenDots = view->screenWidth;
+            graphEnvelope.resize( 2 * ( size_t( dotsOnScreen ) + 1 ) );
+            GraphVertex *bandVertex = graphEnvelope.data();
+            bool bandUpward = true; // alternating span direction shortens the connecting lines
+            if ( available > 0 && screenDots && dotsOnScreen >= 2 * screenDots ) {
+                // several samples per pixel column: reduce each column to its widest span
+                const double samplesPerColumn = double( dotsOnScreen ) / screenDots;
+                for ( unsigned col = 0; col < screenDots; ++col ) {
+                    int pBegin = int( col * samplesPerColumn );       // first position of this column
+                    int pEnd = int( ( col + 1 ) * samplesPerColumn ); // one past its last position
+                    int sBegin = pBegin - leftmostPosition;           // the matching sample range
+                    int sEnd = pEnd - leftmostPosition;
+                    if ( sEnd <= 0 )
+                        continue;
+                    if ( sBegin < 0 )
+                        sBegin = 0;
+                    if ( sBegin >= available )
+                        break;
+                    if ( sEnd > available )
+                        sEnd = available;
+                    double x = double( MARGIN_LEFT + subSampleShift + 0.5 * ( pBegin + pEnd - 1 ) * horizontalFactor );
+                    double yLo, yHi, other;
+                    minMaxSimd( eMin.data() + leftmostSample + sBegin, unsigned( sEnd - sBegin ), yLo, other );
+                    minMaxSimd( eMax.data() + leftmostSample + sBegin, unsigned( sEnd - sBegin ), other, yHi );
+                    *bandVertex++ = { float( x ), float( bandUpward ? yLo : yHi ) };
+                    *bandVertex++ = { float( x ), float( bandUpward ? yHi : yLo ) };
+                    bandUpward = !bandUpward;
+                }
+            } else if ( available > 0 ) {
+                for ( unsigned position = unsigned( leftmostPosition );
+                      position < dotsOnScreen && int( position ) - leftmostPosition < available; ++position ) {
+                    const size_t sample = size_t( leftmostSample + int( position ) - leftmostPosition );
+                    double x = double( MARGIN_LEFT + subSampleShift + position * horizontalFactor );
+                    *bandVertex++ = { float( x ), float( bandUpward ? eMin[ sample ] : eMax[ sample ] ) };
+                    *bandVertex++ = { float( x ), float( bandUpward ? eMax[ sample ] : eMin[ sample ] ) };
+                    bandUpward = !bandUpward;
+                }
+            }
+            graphEnvelope.resize( size_t( bandVertex - graphEnvelope.data() ) ); // drop the unwritten tail
+        } else
+            graphEnvelope.clear();
 
         const unsigned binsPerDiv = 50; // resolution of histogram
 
-        // Set size directly to avoid reallocations (n+1 dots to display n lines)
-        graphVoltage.reserve( ++dotsOnScreen * ( interpolationStep ? 2 : 1 ) ); // two dots per "Step"
-        graphHistogram.reserve( int( 2 * ( binsPerDiv * DIVS_VOLTAGE ) ) );
+        ++dotsOnScreen; // n+1 dots to display n lines
 
+        // gain and offset are only needed for the histogram binning here; the trace
+        // vertices store the raw voltage, the renderer folds the mapping into the
+        // matrix uniform (GlScope::drawVoltageChannelGraph) so a slider drag does
+        // not force a regeneration round-trip
         const double gain = scope->gain( channel );
         const double offset = scope->voltage[ channel ].offset;
 
-        auto sampleIterator = sampleValues.samples.cbegin() + leftmostSample; // -> visible samples
-        auto sampleEnd = sampleValues.samples.cend();
+        auto sampleIterator = sampleValues.samples->cbegin() + leftmostSample; // -> visible samples
+        auto sampleEnd = sampleValues.samples->cend();
 
-        // sinc interpolation if there are too less samples on screen
+        // polyphase interpolation if there are too less samples on screen
         // https://ccrma.stanford.edu/~jos/resample/resample.pdf
-        if ( interpolationSinc && dotsOnScreen < view->screenWidth ) {
-            // we would need sincWidth, but we take what we get
-            const unsigned int left = std::min( sincWidth, unsigned( leftmostSample ) );
-            horizontalFactor /= oversample;                                     // distance between (resampled) dots
+        if ( upsampler && dotsOnScreen < view->screenWidth ) {
+            // we would need the full kernel width, but we take what we get
+            const unsigned int left = std::min( upsampler->width, unsigned( leftmostSample ) );
+            horizontalFactor /= upsampler->oversample;                          // distance between (resampled) dots
             dotsOnScreen = unsigned( DIVS_TIME / horizontalFactor + 0.99 + 1 ); // dot count after resample
-            const unsigned int resampleSize = ( left + dotsOnScreen + sincWidth ) * oversample;
-            resample.clear();                // invalidate old content
-            resample.resize( resampleSize ); //  ... and init with zero because we accumulate the convolution
-            auto sampleIt = sampleValues.samples.cbegin() + leftmostSample;
-            for ( unsigned int resamplePos = 0; resamplePos < resampleSize; resamplePos += oversample ) {
-                resample[ resamplePos ] += *sampleIt; // sinc( 0 ) sum up, do NOT assign
-                auto sincIt = sinc.cbegin();          // -> one half of sinc pulse without sinc(0)
-                for ( unsigned int sincPos = 1; sincPos <= sincSize; ++sincPos ) {
-                    const double convolute = *sampleIt * *sincIt;
-                    if ( resamplePos >= sincPos ) // left half of sinc in visible range
-                        resample[ resamplePos - sincPos ] += convolute;
-                    if ( resamplePos + sincPos < resampleSize ) // right half of sinc visible
-                        resample[ resamplePos + sincPos ] += convolute;
-                    ++sincIt;
-                }
-                ++sampleIt;
-            }
-            leftmostPosition *= oversample;            // scale the position accordingly
-            graphVoltage.reserve( resampleSize );      // provide enough space for resampled dots
-            sampleIterator = resample.cbegin() + left; // now switch from samples -> resamples
-            sampleEnd = resample.cend();               // ... same for end of samples
+            const unsigned int resampleSize = ( left + dotsOnScreen + upsampler->width ) * upsampler->oversample;
+            resample.resize( resampleSize ); // every output point is assigned below
+            const unsigned inputCount = resampleSize / upsampler->oversample;
+            const double *input = sampleValues.samples->data() + leftmostSample;
+            // every output point is an independent dot product (resampleRange()), so
+            // overlap the two disjoint output halves: the worker computes the right
+            // one while this thread computes the left one
+            const unsigned qMid = inputCount / 2;
+            resampleWorker.start( [ this, upsampler, input, inputCount, qMid ]() {
+                resampleRange( *upsampler, input, inputCount, qMid, inputCount );
+            } );
+            resampleRange( *upsampler, input, inputCount, 0, qMid );
+            resampleWorker.wait();
+            leftmostPosition *= int( upsampler->oversample ); // scale the position accordingly
+            sampleIterator = resample.cbegin() + left;        // now switch from samples -> resamples
+            sampleEnd = resample.cend();                      // ... same for end of samples
         }
 
-        graphVoltage.clear();   // remove all previous dots and fill in new trace as GL_LINE_STRIP
+        // size the trace array once and write the vertices by index (GL_LINE_STRIP);
+        // the envelope branch below emits at most 2 * screenDots <= dotsOnScreen points
+        graphVoltage.resize( size_t( dotsOnScreen ) * ( interpolationStep ? 2 : 1 ) ); // two dots per "Step"
+        GraphVertex *vertex = graphVoltage.data();
         graphHistogram.clear(); // remove all previous line and fill in new histo as GL_LINES
         unsigned bins[ int( binsPerDiv * DIVS_VOLTAGE ) ] = { 0 };
-        for ( unsigned int position = unsigned( leftmostPosition ); position < dotsOnScreen && sampleIterator < sampleEnd - 1;
-              ++position ) {
-            double x = double( MARGIN_LEFT + position * horizontalFactor );
-            double y_1 = *sampleIterator++ / gain + offset;
-            double y = *sampleIterator / gain + offset;
-            if ( !scope->histogram ) { // show complete trace
-                if ( interpolationStep )
-                    graphVoltage.push_back( QVector3D( float( x ), float( y_1 ), 0.0f ) ); // insert horizontal step
-                graphVoltage.push_back( QVector3D( float( x ), float( y ), 0.0f ) );
-            } else { // histogram replaces trace in rightmost div
-                int bin = int( round( binsPerDiv * ( y + DIVS_VOLTAGE / 2 ) ) );
-                if ( bin > 0 && bin < binsPerDiv * DIVS_VOLTAGE ) // count value if trace is on screen
-                    ++bins[ bin ];
-                if ( x < MARGIN_RIGHT - 1.1 ) { // show trace unless in last div + 10% margin
+        // sample value -> fractional bin index mapping of the histogram kernel
+        const double binScale = binsPerDiv / gain;
+        const double binOffset = binsPerDiv * ( offset + DIVS_VOLTAGE / 2 );
+        const unsigned binCount = unsigned( binsPerDiv * DIVS_VOLTAGE );
+        const unsigned screenDots = view->screenWidth;
+        if ( screenDots && dotsOnScreen >= 2 * screenDots ) {
+            // envelope decimation: with several samples per pixel column one vertex per
+            // sample only costs vertex bandwidth and aliases visually; reduce each column
+            // to its min/max span and emit them as an alternating zigzag line strip, a
+            // narrow glitch still shows as a full-height spike in its column
+            const double *visible = sampleValues.samples->data() + leftmostSample;
+            const int available = int( sampleValues.samples->size() ) - leftmostSample;
+            const double samplesPerColumn = double( dotsOnScreen ) / screenDots;
+            // Display fast path: when the acquisition handed the raw 8 bit block over
+            // (see DSOsamples::rawDisplay), scan 1 byte instead of 8 byte samples per
+            // column and map only the two extremes through the byte -> volts LUT; the
+            // histogram keeps the doubles, its kernel bins every sample
+            const unsigned char *rawVisible = nullptr;
+            const double *rawLUT = nullptr;
+            unsigned rawStride = result->rawDisplayStride;
+            if ( !scope->histogram && result->rawDisplay && channel < result->rawDisplayLUT.size() &&
+                 result->rawDisplayLUT[ channel ] &&
+                 result->rawDisplay->size() == sampleValues.samples->size() * rawStride ) {
+                rawVisible = result->rawDisplay->data() + size_t( leftmostSample ) * rawStride + channel;
+                rawLUT = result->rawDisplayLUT[ channel ]->data();
+            }
+            bool upward = true; // alternating span direction shortens the connecting lines
+            for ( unsigned col = 0; col < screenDots; ++col ) {
+                int pBegin = int( col * samplesPerColumn );     // first position of this column
+                int pEnd = int( ( col + 1 ) * samplesPerColumn ); // one past its last position
+                int sBegin = pBegin - leftmostPosition;         // the matching sample range
+                int sEnd = pEnd - leftmostPosition;
+                if ( sEnd <= 0 )
+                    continue; // column is left of the first available sample
+                if ( sBegin < 0 )
+                    sBegin = 0;
+                if ( sBegin >= available )
+                    break; // no more samples for the columns on the right
+                if ( sEnd > available )
+                    sEnd = available;
+                double x = double( MARGIN_LEFT + subSampleShift + 0.5 * ( pBegin + pEnd - 1 ) * horizontalFactor );
+                double vMin, vMax;
+                if ( rawVisible ) { // 1 byte per sample scan, then two LUT lookups per column
+                    unsigned char bMin, bMax;
+                    rawMinMaxSimd( rawVisible + size_t( sBegin ) * rawStride, unsigned( sEnd - sBegin ), rawStride, bMin,
+                                   bMax );
+                    vMin = rawLUT[ bMin ];
+                    vMax = rawLUT[ bMax ];
+                    if ( vMin > vMax ) // an inverted channel has a falling LUT
+                        std::swap( vMin, vMax );
+                } else {
+                    minMaxSimd( visible + sBegin, unsigned( sEnd - sBegin ), vMin, vMax );
+                }
+                if ( scope->histogram ) { // bin every sample of the column with the vector kernel
+                    histogramSimd( visible + sBegin, unsigned( sEnd - sBegin ), binScale, binOffset, bins, binCount );
+                    if ( x >= MARGIN_RIGHT - 1.1 ) // histogram replaces trace in last div + 10% margin
+                        continue;
+                }
+                float yLo = float( vMin );
+                float yHi = float( vMax );
+                *vertex++ = { float( x ), upward ? yLo : yHi };
+                *vertex++ = { float( x ), upward ? yHi : yLo };
+                upward = !upward;
+            }
+        } else {
+            if ( scope->histogram && unsigned( leftmostPosition ) < dotsOnScreen && sampleEnd - sampleIterator > 1 ) {
+                // bin all displayed samples in one vectorized pass instead of per vertex
+                const ptrdiff_t available = sampleEnd - sampleIterator - 1;
+                const unsigned onScreen =
+                    unsigned( std::min< ptrdiff_t >( ptrdiff_t( dotsOnScreen - unsigned( leftmostPosition ) ), available ) );
+                histogramSimd( &*sampleIterator + 1, onScreen, binScale, binOffset, bins, binCount );
+            }
+            for ( unsigned int position = unsigned( leftmostPosition );
+                  position < dotsOnScreen && sampleIterator < sampleEnd - 1; ++position ) {
+                double x = double( MARGIN_LEFT + subSampleShift + position * horizontalFactor );
+                double y_1 = *sampleIterator++;
+                double y = *sampleIterator;
+                if ( !scope->histogram ) { // show complete trace
                     if ( interpolationStep )
-                        graphVoltage.push_back( QVector3D( float( x ), float( y_1 ), 0.0f ) ); // horizontal step
-                    graphVoltage.push_back( QVector3D( float( x ), float( y ), 0.0f ) );
+                        *vertex++ = { float( x ), float( y_1 ) }; // insert horizontal step
+                    *vertex++ = { float( x ), float( y ) };
+                } else if ( x < MARGIN_RIGHT - 1.1 ) { // histogram replaces trace in last div + 10% margin
+                    if ( interpolationStep )
+                        *vertex++ = { float( x ), float( y_1 ) }; // horizontal step
+                    *vertex++ = { float( x ), float( y ) };
                 }
             }
         }
+        graphVoltage.resize( size_t( vertex - graphVoltage.data() ) ); // drop the unwritten tail, keep the capacity
 
         if ( ( scope->horizontal.format == Dso::GraphFormat::TY ) && scope->histogram ) { // scale and display the histogram
             double max = 0;                                                               // find max histo count
@@ -171,14 +388,17 @@ void GraphGenerator::generateGraphsTYvoltage( PPresult *result ) {
                     max = bins[ bin ];
                 }
             }
+            graphHistogram.resize( 2 * size_t( binsPerDiv * DIVS_VOLTAGE ) ); // two points per possible bar
+            GraphVertex *bar = graphHistogram.data();
             for ( int bin = 0; bin < binsPerDiv * DIVS_VOLTAGE; ++bin ) {
                 if ( bins[ bin ] ) { // show bar (= start and end point) if value exists
                     double y = double( bin ) / binsPerDiv - DIVS_VOLTAGE / 2 - double( channel ) / binsPerDiv / 2;
                     // draw a line (as GL_LINES) with from MARGIN_RIGHT to the normalised histo size of this bin
-                    graphHistogram.push_back( QVector3D( float( MARGIN_RIGHT ), float( y ), 0 ) );
-                    graphHistogram.push_back( QVector3D( float( MARGIN_RIGHT - bins[ bin ] / max ), float( y ), 0 ) );
+                    *bar++ = { float( MARGIN_RIGHT ), float( y ) };
+                    *bar++ = { float( MARGIN_RIGHT - bins[ bin ] / max ), float( y ) };
                 }
             }
+            graphHistogram.resize( size_t( bar - graphHistogram.data() ) ); // only the occupied bins
         }
     }
 }
@@ -194,29 +414,27 @@ void GraphGenerator::generateGraphsTYspectrum( PPresult *result ) {
         const SampleValues &sampleValues = useSpecSamplesOf( channel, result, scope );
 
         // Check if this channel is used and available at the data analyzer
-        if ( sampleValues.samples.empty() ) {
+        if ( sampleValues.samples->empty() ) {
             // Delete all vector arrays
             graphSpectrum.clear();
             continue;
         }
-        // Check if the sample count has changed
-        size_t sampleCount = sampleValues.samples.size();
-        size_t neededSize = sampleCount * 2;
+        size_t sampleCount = sampleValues.samples->size();
 
-        // Set size directly to avoid reallocations
-        graphSpectrum.reserve( neededSize );
+        // Set size directly and write the vertices by index
+        graphSpectrum.resize( sampleCount );
+        GraphVertex *vertex = graphSpectrum.data();
 
         // What's the horizontal distance between sampling points?
         double horizontalFactor = sampleValues.interval / scope->horizontal.frequencybase;
 
         // Fill vector array
-        std::vector< double >::const_iterator dataIterator = sampleValues.samples.begin();
+        std::vector< double >::const_iterator dataIterator = sampleValues.samples->begin();
         const double magnitude = scope->spectrum[ channel ].magnitude;
         const double offset = scope->spectrum[ channel ].offset;
 
         for ( unsigned int position = 0; position < sampleCount; ++position ) {
-            graphSpectrum.push_back( QVector3D( float( position * horizontalFactor - DIVS_TIME / 2 ),
-                                                float( *dataIterator++ / magnitude + offset ), 0.0f ) );
+            *vertex++ = { float( position * horizontalFactor - DIVS_TIME / 2 ), float( *dataIterator++ / magnitude + offset ) };
         }
     }
 }
@@ -227,9 +445,11 @@ void GraphGenerator::generateGraphsXY( PPresult *result ) {
         qDebug() << "     GraphGenerator::generateGraphsXY()" << result->tag;
     result->vaChannelVoltage.resize( scope->voltage.size() );
 
-    // Delete all spectrum graphs
+    // Delete all spectrum and envelope graphs
     for ( ChannelGraph &data : result->vaChannelSpectrum )
         data.clear();
+    for ( ChannelGraph &data : result->vaChannelEnvelope )
+        data.clear();
 
     // Generate voltage graphs for pairs of channels
     for ( ChannelID channel = 0; channel < scope->voltage.size(); channel += 2 ) {
@@ -246,27 +466,27 @@ void GraphGenerator::generateGraphsXY( PPresult *result ) {
         const SampleValues &ySamples = useVoltSamplesOf( yChannel, result, scope );
 
         // The channels need to be active
-        if ( !xSamples.samples.size() || !ySamples.samples.size() ) {
+        if ( !xSamples.samples->size() || !ySamples.samples->size() ) {
             result->vaChannelVoltage[ xChannel ].clear();
             result->vaChannelVoltage[ yChannel ].clear();
             continue;
         }
 
-        // Check if the sample count has changed
-        const size_t sampleCount = std::min( xSamples.samples.size(), ySamples.samples.size() );
+        const size_t sampleCount = std::min( xSamples.samples->size(), ySamples.samples->size() );
         ChannelGraph &graphXY = result->vaChannelVoltage[ yChannel ]; // color of y channel
-        graphXY.reserve( sampleCount * 2 );
+        // Set size directly and write the vertices by index
+        graphXY.resize( sampleCount );
+        GraphVertex *vertex = graphXY.data();
 
-        // Fill vector array
-        std::vector< double >::const_iterator xIterator = xSamples.samples.begin();
-        std::vector< double >::const_iterator yIterator = ySamples.samples.begin();
-        const double xGain = scope->gain( xChannel );
-        const double yGain = scope->gain( yChannel );
-        const double xOffset = ( scope->trigger.position - 0.5 ) * DIVS_TIME;
-        const double yOffset = scope->voltage[ yChannel ].offset;
+        // Fill vector array with the raw sample pairs; gain and offset of both
+        // channels are a linear map that the renderer folds into the matrix
+        // uniform (GlScope::drawVoltageChannelGraph), so a gain or offset change
+        // costs a uniform update instead of a vertex rebuild
+        std::vector< double >::const_iterator xIterator = xSamples.samples->begin();
+        std::vector< double >::const_iterator yIterator = ySamples.samples->begin();
 
         for ( unsigned int position = 0; position < sampleCount; ++position ) {
-            graphXY.push_back( QVector3D( float( *xIterator++ / xGain + xOffset ), float( *yIterator++ / yGain + yOffset ), 0.0 ) );
+            *vertex++ = { float( *xIterator++ ), float( *yIterator++ ) };
         }
     }
 }
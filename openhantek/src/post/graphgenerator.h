@@ -2,11 +2,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <deque>
 
 #include <QObject>
-#include <QVector3D>
 
+#include "hantekdso/convertworker.h"
 #include "hantekdso/enums.h"
 #include "hantekprotocol/types.h"
 #include "processor.h"
@@ -24,6 +25,11 @@ class GraphGenerator : public QObject, public Processor {
 
   public:
     GraphGenerator( const DsoSettingsScope *scope, const DsoSettingsView *view );
+    const char *name() const override { return "graph"; }
+    /// Budget hint: when set, the upsampling degrades one quality rung - full sinc
+    /// runs with the short kernel, the remaining rungs fall back to the cheaper
+    /// plain linear drawing.
+    void setOverBudget( bool over ) override { overBudget = over; }
 
   private:
     void generateGraphsTYvoltage( PPresult *result );
@@ -31,15 +37,32 @@ class GraphGenerator : public QObject, public Processor {
     void generateGraphsXY( PPresult *result );
 
     bool ready = false;
+    std::atomic< bool > overBudget{ false }; ///< written by the budget evaluation, read in process()
     const DsoSettingsScope *scope;
     const DsoSettingsView *view;
 
-    void prepareSinc( void );                             // setup the sinc table used for upsampling
-    std::vector< double > sinc;                           // sinc function table for convolution
-    const unsigned int sincWidth = 2;                     // two periods
-    const unsigned int oversample = 5;                    // 5 time oversample
-    const unsigned int sincSize = sincWidth * oversample; // size of the table
-    std::vector< double > resample;                       // destination for overampled data
+    /// One polyphase upsampling kernel: row p holds the 2 * width + 1 taps that
+    /// contribute to the p-th output point between two input samples, already in
+    /// input order so that resampleRange() runs plain contiguous dot products.
+    struct ResampleKernel {
+        std::vector< double > phases; ///< oversample rows of 2 * width + 1 taps
+        unsigned width = 0;           ///< taps reach width input samples to each side
+        unsigned oversample = 0;      ///< output points per input sample
+    };
+    void prepareSinc( void ); // setup the upsampling kernels of the quality ladder
+    void buildSincKernel( ResampleKernel &kernel, unsigned width, unsigned oversample );
+    void buildCatmullKernel( ResampleKernel &kernel, unsigned oversample );
+    /// \brief Compute the oversampled output points of the input positions [ qBegin, qEnd ).
+    /// Gather formulation of the polyphase convolution: every output point is one
+    /// short dot product of a kernel row with its input neighbourhood, so
+    /// disjoint ranges write disjoint outputs and can run concurrently.
+    void resampleRange( const ResampleKernel &kernel, const double *input, unsigned inputCount, unsigned qBegin,
+                        unsigned qEnd );
+    /// The quality/speed ladder: full windowed sinc (best reconstruction), Catmull-Rom
+    /// (4 taps, local, no ringing) and a short sinc with less taps and oversampling.
+    ResampleKernel sincKernel, catmullKernel, sincShortKernel;
+    std::vector< double > resample; // destination for overampled data
+    ConvertWorker resampleWorker;   // computes the right half of the outputs
 
     // Processor interface
     void process( PPresult *data ) override;
@@ -2,6 +2,11 @@
 
 #include "postprocessing.h"
 
+#include "utils/bufferpool.h"
+#include "utils/frametrace.h"
+
+#include <QElapsedTimer>
+
 PostProcessing::PostProcessing( ChannelID channelCount, int verboseLevel )
     : channelCount( channelCount ), verboseLevel( verboseLevel ) {
     qRegisterMetaType< std::shared_ptr< PPresult > >();
@@ -11,48 +16,190 @@ PostProcessing::PostProcessing( ChannelID channelCount, int verboseLevel )
 void PostProcessing::registerProcessor( Processor *processor ) { processors.push_back( processor ); }
 
 
+// static
+void PostProcessing::runStage( Processor *processor, PPresult *result ) {
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+    processor->process( result );
+    FrameTrace::record( processor->name(), result->tag );
+    Processor::StageCost &cost = processor->cost; // written only by the thread that runs the stage
+    cost.lastMicros = int( stageTimer.nsecsElapsed() / 1000 );
+    cost.meanMicros += ( cost.lastMicros - cost.meanMicros ) / 8;
+    cost.lastSamples = result->sampleCount();
+    ++cost.blocks;
+}
+
+
+std::vector< PostProcessing::StageReport > PostProcessing::stageReports() const {
+    std::vector< StageReport > reports;
+    reports.reserve( processors.size() );
+    for ( Processor *processor : processors )
+        reports.push_back( { processor->name(), processor->cost.meanMicros } );
+    return reports;
+}
+
+
+void PostProcessing::updateBudget() {
+    double totalMicros = 0.0;
+    for ( Processor *processor : processors ) // the tail entry is written on the worker, an approximate read is fine
+        totalMicros += processor->cost.meanMicros;
+    const int budget = frameBudgetMicros;
+    // hysteresis: back to full quality only well below the budget, no flickering
+    const bool over = overBudget ? totalMicros > 0.75 * budget : totalMicros > budget;
+    if ( over != overBudget ) {
+        overBudget = over;
+        if ( verboseLevel > 2 )
+            qDebug() << "  PostProcessing::updateBudget()" << ( over ? "over" : "within" ) << "budget," << int( totalMicros )
+                     << "of" << budget << "µs";
+        for ( Processor *processor : processors )
+            processor->setOverBudget( over );
+    }
+    if ( verboseLevel > 3 && ++budgetDumpCounter >= 100 ) { // periodic budget table
+        budgetDumpCounter = 0;
+        for ( Processor *processor : processors )
+            qDebug() << "   stage" << processor->name() << "last" << processor->cost.lastMicros << "µs, mean"
+                     << int( processor->cost.meanMicros ) << "µs," << processor->cost.lastSamples << "samples,"
+                     << processor->cost.blocks << "blocks";
+    }
+}
+
+
 // static
 void PostProcessing::convertData( const DSOsamples *source, PPresult *destination ) {
     // printf( "PostProcessing::convertData()\n" );
-    QReadLocker locker( &source->lock );
+    // `source` is a claimed immutable snapshot (see input()), no lock is needed
     if ( source->triggeredPosition ) {
         destination->softwareTriggerTriggered = source->liveTrigger;
         destination->triggeredPosition = source->triggeredPosition;
+        destination->triggeredPositionSub = source->triggeredPositionSub;
         destination->pulseWidth1 = source->pulseWidth1;
         destination->pulseWidth2 = source->pulseWidth2;
     } else {
         destination->softwareTriggerTriggered = false;
         destination->triggeredPosition = 0;
+        destination->triggeredPositionSub = 0;
         destination->pulseWidth1 = 0;
         destination->pulseWidth2 = 0;
     }
 
     for ( ChannelID channel = 0; channel < source->data.size(); ++channel ) {
-        const std::vector< double > &rawChannelData = source->data.at( channel );
+        if ( !source->data.at( channel ) ) // channel buffer not yet allocated
+            continue;
+        const std::vector< double > &rawChannelData = *source->data.at( channel );
 
         if ( rawChannelData.empty() ) {
             continue;
         }
         DataChannel *const channelData = destination->modifiableData( channel );
         channelData->voltage.interval = 1.0 / source->samplerate;
-        channelData->voltage.samples = rawChannelData;
+        // share the conversion buffer instead of copying it; the raw conversion
+        // unshares its buffer before the next write, so the snapshot stays immutable
+        channelData->voltage.samples = source->data.at( channel );
+        // the acquisition envelope band travels the same way, if one is accumulating
+        if ( channel < source->envelopeMin.size() && channel < source->envelopeMax.size() && source->envelopeMin[ channel ] &&
+             source->envelopeMax[ channel ] && !source->envelopeMin[ channel ]->empty() ) {
+            channelData->envelopeMin.interval = channelData->voltage.interval;
+            channelData->envelopeMin.samples = source->envelopeMin[ channel ];
+            channelData->envelopeMax.interval = channelData->voltage.interval;
+            channelData->envelopeMax.samples = source->envelopeMax[ channel ];
+        }
+        // hand the conversion statistics over so the spectrum generator skips its mean pass
+        channelData->dcValid = channel < source->stats.size() && source->stats[ channel ].valid;
+        if ( channelData->dcValid ) {
+            channelData->dc = source->stats[ channel ].mean;
+            channelData->counterFrequency = source->stats[ channel ].counterFrequency;
+        }
         // printf( "PP CH%d: %d\n", channel+1, source->clipped );
         channelData->valid = !( source->clipped & ( 0x01 << channel ) );
     }
+    // display fast path block and LUTs travel shared like the channel buffers
+    destination->rawDisplay = source->rawDisplay;
+    destination->rawDisplayStride = source->rawDisplayStride;
+    destination->rawDisplayLUT.assign( source->rawDisplayLUT.begin(), source->rawDisplayLUT.end() );
     destination->modifiableData( 2 )->voltageUnit = source->mathVoltageUnit; // MATH channel unit
     destination->tag = source->tag;
+    destination->timestampNs = source->timestampNs;
+    destination->effectiveSamplerate = source->effectiveSamplerate;
+}
+
+
+/// \brief Per frame memory telemetry of the result side: the result pool slots plus
+/// the buffers parked on the recycling free list, sampled into the trace ring.
+/// Must run while no pool entry is being written (the tail worker is idle); the
+/// consumers of published results only read, their shared buffers do not move.
+void PostProcessing::sampleMemoryTelemetry() {
+    size_t resultBytes = BufferPool::pooledBytes();
+    for ( const auto &entry : resultPool )
+        resultBytes += entry->memoryFootprint();
+    FrameTrace::counter( "mem.results", resultBytes );
+}
+
+
+std::shared_ptr< PPresult > PostProcessing::getReusableResult() {
+    for ( auto &entry : resultPool ) {
+        if ( entry.use_count() == 1 ) { // only the pool holds it, all consumers are done
+            entry->recycle();
+            return entry;
+        }
+    }
+    if ( resultPool.size() < resultPoolSlots ) { // grow the pool up to its limit
+        resultPool.push_back( std::make_shared< PPresult >( channelCount ) );
+        return resultPool.back();
+    }
+    return std::make_shared< PPresult >( channelCount ); // all slots busy, one-shot allocation
 }
 
 
 void PostProcessing::input( const DSOsamples *data ) {
     if ( data && processing ) {
+        // Newest-wins frame dropping: every announced block queues one invocation of
+        // this slot, all pointing to the same DSOsamples buffer that always carries
+        // the newest capture (guarded by its lock). When the processor chain fell
+        // behind, more announcements are already waiting - skip the superseded ones
+        // so only blocks that will actually be displayed are processed and emitted,
+        // and a slow FFT can not back-pressure the acquisition chain.
+        if ( --queuedBlocks > 0 ) {
+            if ( verboseLevel > 4 )
+                qDebug() << "    PostProcessing::input() superseded, drop" << data->tag;
+            return;
+        }
+        // Claim the announced snapshot instead of the former read lock; if the producer
+        // started rewriting the slot meanwhile, a newer announcement is already queued
+        // and this block is dropped like any superseded one.
+        if ( !data->claimRead() ) {
+            if ( verboseLevel > 4 )
+                qDebug() << "    PostProcessing::input() snapshot reused, drop";
+            return;
+        }
         if ( verboseLevel > 4 )
             qDebug() << "    PostProcessing::input()" << data->tag;
-        currentData.reset( new PPresult( channelCount ) ); // start with a fresh data structure
-        convertData( data, currentData.get() );            // copy all relevant data over
-        for ( Processor *p : processors )                  // feed it into the PP chain
-            p->process( currentData.get() );
-        std::shared_ptr< PPresult > res = std::move( currentData );
-        emit processingFinished( res );
+        QElapsedTimer stageTimer; // busy time of the inline stages, feeds the display pacing governor
+        stageTimer.start();
+        std::shared_ptr< PPresult > res = getReusableResult(); // recycled, capacity preserved
+        convertData( data, res.get() );                        // copy all relevant data over
+        data->releaseRead(); // metadata copied, sample buffers stay shared immutable snapshots
+        if ( processors.size() < 2 ) {                         // nothing to overlap
+            for ( Processor *p : processors )
+                runStage( p, res.get() );
+            updateBudget();
+            sampleMemoryTelemetry();
+            emit processingFinished( res );
+            emit processTime( int( stageTimer.nsecsElapsed() / 1000 ) );
+            return;
+        }
+        for ( size_t stage = 0; stage + 1 < processors.size(); ++stage ) // head stage of this block
+            runStage( processors[ stage ], res.get() );
+        updateBudget();
+        emit processTime( int( stageTimer.nsecsElapsed() / 1000 ) );
+        tailWorker.wait(); // let the tail stage finish the previous block first
+        sampleMemoryTelemetry(); // the tail worker is idle now, no pool entry is being written
+        tailResult = res;
+        tailWorker.start( [ this ]() { // last processor and result delivery, one block behind
+            QElapsedTimer tailTimer;
+            tailTimer.start();
+            runStage( processors.back(), tailResult.get() );
+            emit processingFinished( tailResult );
+            emit processTime( int( tailTimer.nsecsElapsed() / 1000 ) );
+        } );
     }
 }
@@ -2,9 +2,11 @@
 
 #pragma once
 
+#include "convertworker.h"
 #include "dsosamples.h"
 #include "processor.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -16,6 +18,12 @@
  * Manages all post processing processors. Register another processor with `registerProcessor(p)`.
  * All processors, in the order of insertion, will process the input data, given by `input(data)`.
  * The final result will be made available via the `processingFinished` signal.
+ *
+ * The chain is pipelined two blocks deep: the last registered processor and the result
+ * delivery run as a tail stage on a worker thread, so while it still works on block N
+ * the processing thread already feeds block N+1 into the preceding processors. Each
+ * stage handles one block at a time, so no processor ever runs concurrently with
+ * itself, and results are delivered strictly in capture order.
  */
 class PostProcessing : public QObject {
     Q_OBJECT
@@ -30,6 +38,41 @@ class PostProcessing : public QObject {
      */
     void registerProcessor( Processor *processor );
     void stop() { processing = false; }
+    /**
+     * Block until the tail stage of the pipeline has delivered its last result.
+     * Call this after the processing thread has stopped and before any of the
+     * registered processors is destroyed.
+     */
+    void waitForTail() { tailWorker.wait(); }
+    /**
+     * Set the frame budget of the whole processor chain. When the summed smoothed
+     * stage cost exceeds it, every stage gets the over budget quality hint
+     * (Processor::setOverBudget()) until the cost drops below 3/4 of the budget.
+     * @param micros budget in microseconds per block
+     */
+    void setFrameBudget( int micros ) { frameBudgetMicros = micros; }
+
+    /// One row of the per stage cost report for the diagnostics dock.
+    struct StageReport {
+        const char *name;  ///< short stage name, see Processor::name()
+        double meanMicros; ///< exponentially smoothed busy time per block
+    };
+    /**
+     * Snapshot of the budget table for the diagnostics dock. The processor list is
+     * fixed before the threads start; the smoothed means are read without
+     * synchronization, an approximate value is good enough for a display refresh.
+     */
+    std::vector< StageReport > stageReports() const;
+
+  public slots:
+    /**
+     * Announce a new block, connect this directly (Qt::DirectConnection) to the same
+     * signal that feeds the queued input() slot, before connecting input(). Together
+     * they form a bounded newest-wins queue: input() drops every invocation that has
+     * already been superseded by a newer announcement, so a slow processor chain can
+     * never back-pressure the acquisition with a growing backlog of stale blocks.
+     */
+    void announceBlock() { ++queuedBlocks; }
 
 
   private:
@@ -37,10 +80,37 @@ class PostProcessing : public QObject {
     const unsigned channelCount;
     /// The list of processors. Processors are not memory managed by this class.
     std::vector< Processor * > processors;
-    ///
-    std::unique_ptr< PPresult > currentData;
+    /// Recycled result objects. A slot is reused as soon as all consumers dropped
+    /// their reference, so the sample and graph vectors keep their capacity across
+    /// blocks instead of being reallocated for every captured block.
+    static const unsigned resultPoolSlots = 4;
+    std::vector< std::shared_ptr< PPresult > > resultPool;
+    std::shared_ptr< PPresult > getReusableResult();
+    /// Sample the result pool and recycling pool sizes into the trace ring.
+    void sampleMemoryTelemetry();
     static void convertData( const DSOsamples *source, PPresult *destination );
+    /// Run one stage on one block and update its budget table entry.
+    static void runStage( Processor *processor, PPresult *result );
+    /// Evaluate the summed stage costs against the frame budget and distribute the
+    /// over budget quality hint; dumps the budget table periodically at high
+    /// verbose levels.
+    void updateBudget();
+    /// Frame budget of the whole chain in µs, see setFrameBudget(). The default is
+    /// lenient, it only reins in stages when the chain falls behind a 20 Hz display.
+    std::atomic< int > frameBudgetMicros{ 50000 };
+    bool overBudget = false;   ///< the hint currently distributed to the stages
+    int budgetDumpCounter = 0; ///< blocks since the last budget table dump
     bool processing = true;
+    /// Number of announced but not yet consumed blocks, written from the acquisition
+    /// thread (announceBlock()) and consumed in the processing thread (input()).
+    std::atomic< int > queuedBlocks{ 0 };
+    /// Tail stage of the pipeline: runs the last registered processor and emits the
+    /// result one block behind the processing thread, e.g. graph generation of block
+    /// N overlaps spectrum generation of block N+1 on a second core.
+    ConvertWorker tailWorker;
+    /// The block currently owned by the tail stage, only touched by input() while
+    /// the tail worker is idle.
+    std::shared_ptr< PPresult > tailResult;
     int verboseLevel = 0;
 
   public slots:
@@ -53,6 +123,10 @@ class PostProcessing : public QObject {
 
   signals:
     void processingFinished( std::shared_ptr< PPresult > result );
+    /// Measured busy time of one pipeline stage for one block (µs), emitted once for
+    /// the inline stages and once for the tail stage. Input of the display pacing
+    /// governor, see HantekDsoControl::reportProcessingTime().
+    void processTime( int micros );
 };
 
 Q_DECLARE_METATYPE( std::shared_ptr< PPresult > )
@@ -13,6 +13,66 @@ const DataChannel *PPresult::data( ChannelID channel ) const {
 
 DataChannel *PPresult::modifiableData( ChannelID channel ) { return &analyzedData[ channel ]; }
 
-unsigned int PPresult::sampleCount() const { return unsigned( analyzedData[ 0 ].voltage.samples.size() ); }
+unsigned int PPresult::sampleCount() const { return unsigned( analyzedData[ 0 ].voltage.samples->size() ); }
 
 unsigned int PPresult::channelCount() const { return unsigned( analyzedData.size() ); }
+
+void PPresult::recycle() {
+    softwareTriggerTriggered = false;
+    triggeredPosition = 0;
+    triggeredPositionSub = 0.0;
+    pulseWidth1 = 0.0;
+    pulseWidth2 = 0.0;
+    tag = 0;
+    timestampNs = 0;
+    effectiveSamplerate = 0.0;
+    decoderAnnotations.clear();
+    rawDisplay.reset();
+    rawDisplayLUT.clear();
+    rawDisplayStride = 0;
+    for ( DataChannel &channelData : analyzedData ) {
+        // clear() keeps the allocated capacity; a buffer that is still shared
+        // (e.g. with the acquisition side) is dropped instead of wiped
+        channelData.voltage.modifiableSamples().clear();
+        channelData.voltage.interval = 0.0;
+        channelData.spectrum.modifiableSamples().clear();
+        channelData.spectrum.interval = 0.0;
+        channelData.envelopeMin.modifiableSamples().clear();
+        channelData.envelopeMin.interval = 0.0;
+        channelData.envelopeMax.modifiableSamples().clear();
+        channelData.envelopeMax.interval = 0.0;
+        channelData.valid = true;
+        channelData.vmin = 0.0;
+        channelData.vmax = 0.0;
+        channelData.rms = 0.0;
+        channelData.dBmin = 0.0;
+        channelData.dBmax = 0.0;
+        channelData.dc = 0.0;
+        channelData.ac = 0.0;
+        channelData.dB = 0.0;
+        channelData.frequency = 0.0;
+        channelData.counterFrequency = 0.0;
+        channelData.note.clear();
+        channelData.thd = 0.0;
+        channelData.pulseWidth1 = 0.0;
+        channelData.pulseWidth2 = 0.0;
+        channelData.voltageUnit = UNIT_VOLTS;
+    }
+    for ( ChannelsGraphs *graphs : { &vaChannelSpectrum, &vaChannelVoltage, &vaChannelHistogram, &vaChannelEnvelope } )
+        for ( ChannelGraph &graph : *graphs )
+            graph.clear();
+}
+
+size_t PPresult::memoryFootprint() const {
+    size_t bytes = 0;
+    for ( const DataChannel &channelData : analyzedData )
+        for ( const SampleValues *values :
+              { &channelData.voltage, &channelData.spectrum, &channelData.envelopeMin, &channelData.envelopeMax } )
+            bytes += values->samples->capacity() * sizeof( double );
+    for ( const ChannelsGraphs *graphs : { &vaChannelSpectrum, &vaChannelVoltage, &vaChannelHistogram, &vaChannelEnvelope } )
+        for ( const ChannelGraph &graph : *graphs )
+            bytes += graph.capacity() * sizeof( GraphVertex );
+    if ( rawDisplay )
+        bytes += rawDisplay->capacity();
+    return bytes;
+}
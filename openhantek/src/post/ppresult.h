@@ -3,22 +3,42 @@
 #pragma once
 
 #include <QReadWriteLock>
-#include <QVector3D>
 
 #include "hantekprotocol/types.h"
+#include "utils/bufferpool.h"
 #include "utils/printutils.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 /// \brief Struct for a array of sample values.
+/// The sample buffer is a shared pointer so that the conversion buffers of
+/// `DSOsamples` can be handed over to a `PPresult` without copying 20 k doubles
+/// per channel and block. All consumers share the vector read-only; writers get
+/// their buffer via modifiableSamples(), which unshares it first.
 struct SampleValues {
-    std::vector< double > samples; ///< Vector holding the sampling data
-    double interval = 0.0;         ///< The interval between two sample values
+    /// Vector holding the sampling data, shared between producer and consumers,
+    /// never null - an unused channel holds an empty vector.
+    std::shared_ptr< std::vector< double > > samples = std::make_shared< std::vector< double > >();
+    double interval = 0.0; ///< The interval between two sample values
+
+    /// \brief Get a sample buffer that is safe to overwrite.
+    /// Unshares a buffer that is still referenced elsewhere by taking a recycled
+    /// one from the pool (copy-on-write without the copy - the caller overwrites
+    /// the content anyway, and the pool keeps the frames allocation-free).
+    std::vector< double > &modifiableSamples() {
+        if ( samples.use_count() > 1 )
+            samples = BufferPool::acquire();
+        return *samples;
+    }
 };
 
 /// \brief Struct for the analyzed data.
 struct DataChannel {
     SampleValues voltage;          ///< The time-domain voltage levels (V)
     SampleValues spectrum;         ///< The frequency-domain power levels (dB)
+    SampleValues envelopeMin;      ///< Lower bound of the acquisition envelope band, empty unless enabled
+    SampleValues envelopeMax;      ///< Upper bound of the acquisition envelope band
     bool valid = true;             ///< Not clipped, distorted, dropouts etc.
     double vmin = 0.0;             ///< The minimum sample value of _displayed_ part of trace
     double vmax = 0.0;             ///< The maximum sample value of _displayed_ part of trace
@@ -26,9 +46,11 @@ struct DataChannel {
     double dBmin = 0.0;            ///< The minimum magnitude value
     double dBmax = 0.0;            ///< The maximum magnitude value
     double dc = 0.0;               ///< The DC bias of the signal
+    bool dcValid = false;          ///< dc was prefilled from the conversion statistics
     double ac = 0.0;               ///< The AC rms value of the signal
     double dB = 0.0;               ///< The AC rms value as dB (dBV or other depending on config)
     double frequency = 0.0;        ///< The frequency of the signal
+    double counterFrequency = 0.0; ///< Zero crossing counter readout, 0.0 until its gate settles
     QString note = "";             ///< The note value of the frequency
     double thd = 0.0;              ///< The THD value
     double pulseWidth1 = 0.0;      ///< The width of the triggered pulse
@@ -36,11 +58,31 @@ struct DataChannel {
     Unit voltageUnit = UNIT_VOLTS; ///< unless UNIT_VOLTSQUARE for some math functions
 };
 
-typedef std::vector< QVector3D > ChannelGraph;
+/// \brief One decoded protocol item (byte, start/stop condition, error) of the
+/// displayed trace, produced by the decoder stage (post/decoder.h) and rendered
+/// by GlScope as an overlay. Positions are in screen divisions, the same
+/// horizontal coordinate system the graph vertices use.
+struct DecoderAnnotation {
+    float xStart = 0.0f; ///< left edge in divs
+    float xEnd = 0.0f;   ///< right edge in divs
+    QString text;        ///< short decoded text, e.g. a hex byte
+    bool error = false;  ///< framing/ACK error, rendered highlighted
+};
+
+/// \brief One screen vertex of a channel graph, two tightly packed floats.
+/// The vectors below are uploaded verbatim into the GL vertex buffer with a
+/// two component attribute layout, the shader expands each vertex to z = 0.
+struct GraphVertex {
+    float x, y;
+};
+
+typedef std::vector< GraphVertex > ChannelGraph;
 typedef std::vector< ChannelGraph > ChannelsGraphs;
 
-/// Post processing results
-class PPresult {
+/// Post processing results. Instances are always owned by a shared_ptr (the
+/// PostProcessing result pool), enable_shared_from_this lets consumers that only
+/// see the raw pointer (the processor chain) rejoin that ownership.
+class PPresult : public std::enable_shared_from_this< PPresult > {
   public:
     explicit PPresult( unsigned int channelCount );
 
@@ -53,18 +95,42 @@ class PPresult {
     /// \return The maximum sample count of the last analyzed data. This assumes there is at least one channel.
     unsigned int sampleCount() const;
     unsigned int channelCount() const;
+    /// \brief Reset the result like a freshly constructed object, but keep the
+    /// capacity of all sample and graph vectors for reuse from the recycling pool.
+    void recycle();
+    /// \brief Allocated bytes of all sample and graph vectors of this result.
+    /// Memory telemetry, not exact ownership: a sample buffer shared with another
+    /// holder is counted by every holder, growth is what the sampling looks for.
+    size_t memoryFootprint() const;
 
     /// sw trigger status
     bool softwareTriggerTriggered = false;
     /// skip samples at start of channel to get triggered trace on screen
-    int triggeredPosition = 0; ///< Not triggered
+    int triggeredPosition = 0;         ///< Not triggered
+    double triggeredPositionSub = 0.0; ///< fraction of one sample the crossing precedes triggeredPosition
     double pulseWidth1 = 0.0;  ///< The width of the triggered pulse
     double pulseWidth2 = 0.0;  ///< The width of the following pulse
     unsigned tag;              ///< track individual sample blocks (debug support)
+    uint64_t timestampNs = 0;  ///< monotonic clock at USB completion of the raw block
+    /// Drift corrected samplerate measured from the block timestamps, 0.0 until the
+    /// fit has settled; the nominal rate stays in the per channel voltage.interval.
+    double effectiveSamplerate = 0.0;
+
+    /// Protocol annotations of the displayed trace, empty unless decoding is enabled.
+    std::vector< DecoderAnnotation > decoderAnnotations;
+
+    /// Display fast path (see DSOsamples): the interleaved raw 8 bit block and the
+    /// per channel byte -> volts LUT, shared from the acquisition. The dense trace
+    /// decimation scans these bytes instead of the converted doubles; null when the
+    /// raw block does not match the presented trace.
+    std::shared_ptr< const std::vector< unsigned char > > rawDisplay;
+    std::vector< std::shared_ptr< const std::vector< double > > > rawDisplayLUT;
+    unsigned rawDisplayStride = 0;
 
     ChannelsGraphs vaChannelSpectrum;
     ChannelsGraphs vaChannelVoltage;
     ChannelsGraphs vaChannelHistogram;
+    ChannelsGraphs vaChannelEnvelope; ///< min/max band of the acquisition envelope mode
 
   private:
     std::vector< DataChannel > analyzedData; ///< The analyzed data for each channel
@@ -6,6 +6,23 @@
 
 class Processor {
   public:
+    /// \brief Per stage entry of the pipeline budget table, updated by
+    /// PostProcessing around every process() call. One writer per entry (the
+    /// thread that runs the stage); the budget evaluation reads the smoothed
+    /// mean across threads, an approximate value is good enough there.
+    struct StageCost {
+        int lastMicros = 0;       ///< busy time of the newest block
+        double meanMicros = 0.0;  ///< exponentially smoothed busy time
+        unsigned lastSamples = 0; ///< sample count of the newest block
+        unsigned blocks = 0;      ///< blocks processed since start
+    };
     virtual ~Processor();
     virtual void process( PPresult * ) = 0;
+    /// \brief Short stage name of this processor for the pipeline latency trace.
+    virtual const char *name() const = 0;
+    /// \brief Budget hint: ask the stage to trade quality for time (true) or to
+    /// restore full quality (false). Stages without a cheaper mode ignore it;
+    /// implementations must be callable concurrently with process().
+    virtual void setOverBudget( bool /* overBudget */ ) {}
+    StageCost cost; ///< the budget table entry of this stage
 };
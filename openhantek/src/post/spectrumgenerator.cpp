@@ -1,18 +1,23 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cmath>
 
 #include <QColor>
 #include <QDebug>
+#include <QFileInfo>
 #include <QMutex>
+#include <QSettings>
 #include <QTimer>
 #include <QToolTip>
 
+#include "convertsimd.h"
 #include "ppresult.h"
 #include "spectrumgenerator.h"
 
 
 #include "dsosettings.h"
+#include "utils/dsotrace.h"
 #include "utils/printutils.h"
 #include "viewconstants.h"
 
@@ -22,12 +27,35 @@ SpectrumGenerator::SpectrumGenerator( const DsoSettingsScope *scope, const DsoSe
     : scope( scope ), analysis( analysis ) {
     if ( scope->verboseLevel > 1 )
         qDebug() << " SpectrumGenerator::SpectrumGenerator()";
+    if ( analysis->reuseFftPlan ) {
+        // Measured quality plans (FFTW_MEASURE) take seconds per record length on small
+        // boxes; import the wisdom collected by earlier sessions from the config
+        // directory (next to the file handled by DsoSettings) so they are available
+        // instantly in every session. The import parses a sizeable text file, so it
+        // runs concurrently with the remaining session startup (scope window, OpenGL
+        // setup) and is joined in process() before the first planner call.
+        wisdomFile = QFileInfo( QSettings().fileName() ).absolutePath() + "/fftw_wisdom";
+#ifdef HAVE_FFTWF // the single precision plans have their own wisdom
+        wisdomFileF = QFileInfo( QSettings().fileName() ).absolutePath() + "/fftwf_wisdom";
+#endif
+        const int verboseLevel = scope->verboseLevel;
+        wisdomLoader = std::thread( [ this, verboseLevel ]() {
+            if ( fftw_import_wisdom_from_filename( wisdomFile.toLocal8Bit().constData() ) && verboseLevel > 1 )
+                qDebug() << " SpectrumGenerator: imported FFTW wisdom from" << wisdomFile;
+#ifdef HAVE_FFTWF
+            if ( fftwf_import_wisdom_from_filename( wisdomFileF.toLocal8Bit().constData() ) && verboseLevel > 1 )
+                qDebug() << " SpectrumGenerator: imported FFTW wisdom from" << wisdomFileF;
+#endif
+        } );
+    }
 }
 
 
 SpectrumGenerator::~SpectrumGenerator() {
     if ( scope->verboseLevel > 1 )
         qDebug() << " SpectrumGenerator::~SpectrumGenerator()";
+    if ( wisdomLoader.joinable() ) // may still run when no block was ever processed
+        wisdomLoader.join();
     if ( analysis->reuseFftPlan ) {
         if ( fftPlan_R2HC ) {
             fftw_destroy_plan( fftPlan_R2HC );
@@ -37,10 +65,130 @@ SpectrumGenerator::~SpectrumGenerator() {
             fftw_destroy_plan( fftPlan_HC2R );
             fftPlan_HC2R = nullptr;
         }
+#ifdef HAVE_FFTWF
+        if ( fftPlanF_R2HC ) {
+            fftwf_destroy_plan( fftPlanF_R2HC );
+            fftPlanF_R2HC = nullptr;
+        }
+        if ( fftPlanF_HC2R ) {
+            fftwf_destroy_plan( fftPlanF_HC2R );
+            fftPlanF_HC2R = nullptr;
+        }
+#endif
+    }
+    if ( fftPlan_zoom ) { // kept across blocks also without reuseFftPlan
+        fftw_destroy_plan( fftPlan_zoom );
+        fftPlan_zoom = nullptr;
+    }
+    for ( FftScratch &scratch : fftScratch ) {
+        fftw_free( scratch.d[ 0 ] );
+        fftw_free( scratch.d[ 1 ] );
+#ifdef HAVE_FFTWF
+        fftwf_free( scratch.f[ 0 ] );
+        fftwf_free( scratch.f[ 1 ] );
+#endif
+        fftw_free( scratch.z[ 0 ] );
+        fftw_free( scratch.z[ 1 ] );
+    }
+}
+
+
+/// \brief Provide the two aligned FFT scratch buffers of one channel, reallocated
+/// only when the record length grows; reusing them removes two large aligned
+/// allocations per channel per block from the post-processing path.
+bool SpectrumGenerator::ensureFftBuffers( FftScratch &scratch, size_t size ) {
+    if ( size > scratch.dSize ) {
+        for ( double *&buffer : scratch.d ) {
+            fftw_free( buffer );
+            buffer = fftw_alloc_real( size );
+            if ( nullptr == buffer ) { // allocation failed
+                scratch.dSize = 0;
+                return false;
+            }
+        }
+        scratch.dSize = size;
+    }
+    return true;
+}
+
+
+#ifdef HAVE_FFTWF
+/// \brief Same as ensureFftBuffers() for the single precision scratch buffers.
+bool SpectrumGenerator::ensureFftBuffersF( FftScratch &scratch, size_t size ) {
+    if ( size > scratch.fSize ) {
+        for ( float *&buffer : scratch.f ) {
+            fftwf_free( buffer );
+            buffer = fftwf_alloc_real( size );
+            if ( nullptr == buffer ) { // allocation failed
+                scratch.fSize = 0;
+                return false;
+            }
+        }
+        scratch.fSize = size;
+    }
+    return true;
+}
+#endif
+
+
+/// \brief Same as ensureFftBuffers() for the complex buffers of the zoom FFT.
+bool SpectrumGenerator::ensureZoomBuffers( FftScratch &scratch, size_t size ) {
+    if ( size > scratch.zSize ) {
+        for ( fftw_complex *&buffer : scratch.z ) {
+            fftw_free( buffer );
+            buffer = fftw_alloc_complex( size );
+            if ( nullptr == buffer ) { // allocation failed
+                scratch.zSize = 0;
+                return false;
+            }
+        }
+        scratch.zSize = size;
     }
+    return true;
 }
 
 
+/// \brief Persist the accumulated FFTW wisdom, called right after a new measured
+/// plan was built so the result survives even a session that does not exit cleanly.
+void SpectrumGenerator::saveWisdom() {
+    if ( wisdomFile.isEmpty() )
+        return;
+    if ( !fftw_export_wisdom_to_filename( wisdomFile.toLocal8Bit().constData() ) )
+        qDebug() << " SpectrumGenerator: could not save FFTW wisdom to" << wisdomFile;
+#ifdef HAVE_FFTWF
+    if ( !fftwf_export_wisdom_to_filename( wisdomFileF.toLocal8Bit().constData() ) )
+        qDebug() << " SpectrumGenerator: could not save FFTW wisdom to" << wisdomFileF;
+#endif
+}
+
+
+/// Map either the double or the single precision FFTW API onto the templated
+/// transform core, both APIs are declared in fftw3.h.
+struct FftwDouble {
+    typedef double Real;
+    typedef fftw_plan Plan;
+    static Plan plan( int n, Real *in, Real *out, fftw_r2r_kind kind, unsigned flags ) {
+        return fftw_plan_r2r_1d( n, in, out, kind, flags );
+    }
+    static void execute( Plan p, Real *in, Real *out ) { fftw_execute_r2r( p, in, out ); }
+    static void executeOnce( Plan p ) { fftw_execute( p ); }
+    static void destroy( Plan p ) { fftw_destroy_plan( p ); }
+};
+
+#ifdef HAVE_FFTWF
+struct FftwFloat {
+    typedef float Real;
+    typedef fftwf_plan Plan;
+    static Plan plan( int n, Real *in, Real *out, fftw_r2r_kind kind, unsigned flags ) {
+        return fftwf_plan_r2r_1d( n, in, out, kind, flags );
+    }
+    static void execute( Plan p, Real *in, Real *out ) { fftwf_execute_r2r( p, in, out ); }
+    static void executeOnce( Plan p ) { fftwf_execute( p ); }
+    static void destroy( Plan p ) { fftwf_destroy_plan( p ); }
+};
+#endif
+
+
 // besseli0() and Kaiser calculation from "SigPack - the C++ signal processing library"
 // http://sigpack.sourceforge.net/window_8h_source.html
 static double besseli0( double x ) {
@@ -54,390 +202,734 @@ static double besseli0( double x ) {
 }
 
 
-void SpectrumGenerator::process( PPresult *result ) {
-    // Calculate frequencies and spectrums
-
-    if ( scope->verboseLevel > 4 )
-        qDebug() << "    SpectrumGenerator::process()" << result->tag;
-
-    // we use correctly aligned input and output data structures for fft
-    // we use "fftw_alloc_real()" and "fftw_free()" to handle these arrays dynamically
-    // these pointers are used during "process()"
-    double *fftWindowedValues = nullptr;
-    double *fftHcSpectrum = nullptr;
-    double *fftPowerSpectrum = nullptr;
-    double *fftAutoCorrelation = nullptr;
-
-    for ( ChannelID channel = 0; channel < result->channelCount(); ++channel ) {
-        DataChannel *const channelData = result->modifiableData( channel );
-
-        if ( channelData->voltage.samples.empty() ) {
-            // Clear unused channels
-            channelData->spectrum.interval = 0;
-            channelData->spectrum.samples.clear();
-            continue;
+/// \brief The precision independent core of the spectrum calculation: strip the DC
+/// bias and window the AC component, transform to the half-complex spectrum and
+/// build the power spectrum for display. A normalized copy of the power spectrum is
+/// left in the first scratch buffer for the lazy autocorrelation (correlateChannel()).
+/// When the configured FFT length is shorter than the record, half overlapping
+/// segments slide over the record and their power spectra are averaged (Welch's
+/// method) - lower variance and faster updates for less frequency resolution.
+/// Only the FFT scratch buffers and plans use the precision of the Fftw wrapper, the
+/// displayed spectrum and all accumulators for the dB conversion stay double.
+template < typename Fftw >
+void SpectrumGenerator::transformChannel( typename Fftw::Plan &fftPlanR2HC, typename Fftw::Real *fftWindowedValues,
+                                          typename Fftw::Real *fftHcSpectrum, DataChannel *channelData, int sampleCount,
+                                          double dc, double &ac2 ) {
+    typedef typename Fftw::Real Real;
+    const int length = transformLength; // set in process(), <= sampleCount
+    int dftLength = length / 2;         // number of real/complex samples
+    const int step = dftLength;         // Welch segments overlap by half
+    const int segments = length < sampleCount ? 1 + ( sampleCount - length ) / step : 1;
+    const double *voltage = channelData->voltage.samples->data();
+    const double *windowData = window.data();
+
+    ac2 = 0.0;
+    if ( length < sampleCount ) { // the rms measurement always covers the whole record
+        for ( int sample = 0; sample < sampleCount; ++sample ) {
+            double ac_sample = voltage[ sample ] - dc;
+            ac2 += ac_sample * ac_sample;
         }
-        int sampleCount = int( channelData->voltage.samples.size() );
-        if ( scope->verboseLevel > 5 )
-            qDebug() << "     SpectrumGenerator::process()" << channel << "sampleCount:" << sampleCount;
-
-        // persistent window function, (re)build in case of changes only
-        if ( previousWindowFunction != analysis->spectrumWindow || window.size() != size_t( sampleCount ) ) {
-            // Calculate new window vector
-            if ( scope->verboseLevel > 5 )
-                qDebug() << "     SpectrumGenerator::process() calculate new window";
-            previousWindowFunction = analysis->spectrumWindow;
-            window.resize( size_t( sampleCount ) );
-
-            // Theory:
-            // Harris, Fredric J. (Jan 1978):
-            // "On the use of Windows for Harmonic Analysis with the Discrete Fourier Transform".
-            // Proceedings of the IEEE. 66 (1): 51–83. Bibcode:1978IEEEP..66...51H.
-            // CiteSeerX 10.1.1.649.9880. doi:10.1109/PROC.1978.10837. S2CID 426548.
-            // The fundamental 1978 paper on FFT windows by Harris, which specified many windows
-            // and introduced key metrics used to compare them.
-            // http://web.mit.edu/xiphmont/Public/windows.pdf
-
-            double N = sampleCount - 1; // most window functions work for 0 <= n <= N
-            // scale all windows to display 1 Veff as 0 dBu reference level.
-            double area = 0.0; // calculate area under window fkt
-            auto pW = window.begin();
-            switch ( analysis->spectrumWindow ) {
-            case Dso::WindowFunction::HANN:
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 0.5 * ( 1.0 - cos( 2.0 * M_PI * n / N ) );
-                break;
-            case Dso::WindowFunction::HAMMING: {
-                double a0 = 0.54; // approximation of a0 = 25.0 / 46.0
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = a0 - ( 1 - a0 ) * cos( 2.0 * M_PI * n / N );
-                break;
+        ac2 /= double( sampleCount ); // AC²
+    }
+
+    double *displaySpectrum = channelData->spectrum.samples->data();
+    if ( segments > 1 ) // the segment loop below accumulates onto the display bins
+        std::fill( displaySpectrum, displaySpectrum + dftLength + 1, 0.0 );
+    for ( int segment = 0; segment < segments; ++segment ) {
+        // now strip DC bias and apply window for fft to AC component
+        const double *segmentVoltage = voltage + segment * step;
+        Real *pfftW = fftWindowedValues;
+        if ( length == sampleCount ) { // full record: fuse the AC² measurement into the window pass
+            for ( int sample = 0; sample < length; ++sample ) {
+                double ac_sample = segmentVoltage[ sample ] - dc;
+                ac2 += ac_sample * ac_sample;
+                *pfftW++ = Real( windowData[ sample ] * ac_sample );
             }
-            case Dso::WindowFunction::COSINE:
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = sin( M_PI * n / N );
-                break;
-            case Dso::WindowFunction::LANCZOS:
-                for ( int n = 0; n < sampleCount; ++n ) {
-                    double sincParameter = ( 2.0 * n / N - 1.0 ) * M_PI;
-                    if ( bool( sincParameter ) )
-                        area += *pW++ = sin( sincParameter ) / sincParameter;
-                    else
-                        area += *pW++ = 1;
-                }
-                break;
-            case Dso::WindowFunction::TRIANGULAR: // same with N+1
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 2.0 / sampleCount * ( sampleCount / 2 - std::abs( n - N / 2.0 ) );
-                break;
-            case Dso::WindowFunction::BARTLETT: // the original triangle
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 2.0 / N * ( N / 2 - std::abs( n - N / 2.0 ) );
-                break;
-            case Dso::WindowFunction::BARTLETT_HANN:
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 0.62 - 0.48 * std::abs( n / N - 0.5 ) - 0.38 * cos( 2.0 * M_PI * n / N );
-                break;
-            case Dso::WindowFunction::GAUSS: {
-                const double sigma = 0.3;
-                for ( int n = 0; n < sampleCount; ++n ) {
-                    double w = ( n - N / 2.0 ) / ( sigma * N / 2.0 );
-                    w *= w;
-                    area += *pW++ = exp( -w / 2 );
+            ac2 /= double( length ); // AC²
+        } else {
+            for ( int sample = 0; sample < length; ++sample )
+                *pfftW++ = Real( windowData[ sample ] * ( segmentVoltage[ sample ] - dc ) );
+        }
+
+        // Do discrete real to half-complex transformation
+        // Record length should be multiple of 2, 3, 5: done, is 10000 = 2^a * 5^b
+        if ( analysis->reuseFftPlan ) { // build one optimized plan and reuse it for all transformations
+            {                           // the planner is not thread safe, serialize the one-time creation
+                std::lock_guard< std::mutex > planLock( planMutex );
+                if ( nullptr == fftPlanR2HC ) { // not yet created, do it now (instant with wisdom, else this takes some time)
+                    fftPlanR2HC = Fftw::plan( length, fftWindowedValues, fftHcSpectrum, FFTW_R2HC, FFTW_MEASURE );
+                    saveWisdom(); // remember the measured plan for the next sessions
                 }
-                break;
             }
-            case Dso::WindowFunction::KAISER: {
-                const double beta = M_PI * 2.75; // β = πα
-                double bb = besseli0( beta );
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = besseli0( beta * sqrt( 4.0 * n * ( N - n ) ) / ( N ) ) / bb;
-                break;
+            Fftw::execute( fftPlanR2HC, fftWindowedValues, fftHcSpectrum ); // but it will run faster
+        } else { // build a more generic plan, this takes much less time than the optimized plan
+            typename Fftw::Plan oncePlan;
+            {
+                std::lock_guard< std::mutex > planLock( planMutex );
+                oncePlan = Fftw::plan( length, fftWindowedValues, fftHcSpectrum, FFTW_R2HC, FFTW_ESTIMATE );
             }
-            case Dso::WindowFunction::BLACKMAN: {
-                const double alpha = 0.16;
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = ( 1 - alpha ) / 2 - 0.5 * cos( 2.0 * M_PI * n / N ) + alpha / 2 * cos( 4.0 * M_PI * n / N );
-                break;
+            Fftw::executeOnce( oncePlan ); // use it once
+            {
+                std::lock_guard< std::mutex > planLock( planMutex );
+                Fftw::destroy( oncePlan ); // and destroy it
             }
-            case Dso::WindowFunction::NUTTALL:
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 0.355768 - 0.487396 * cos( 2 * M_PI * n / N ) + 0.144232 * cos( 4 * M_PI * n / N ) -
-                                    0.012604 * cos( 6 * M_PI * n / N );
-                break;
-            case Dso::WindowFunction::BLACKMAN_HARRIS:
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 0.35875 - 0.48829 * cos( 2 * M_PI * n / N ) + 0.14128 * cos( 4 * M_PI * n / N ) -
-                                    0.01168 * cos( 6 * M_PI * n / N );
-                break;
-            case Dso::WindowFunction::BLACKMAN_NUTTALL:
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 0.3635819 - 0.4891775 * cos( 2 * M_PI * n / N ) + 0.1365995 * cos( 4 * M_PI * n / N ) -
-                                    0.0106411 * cos( 6 * M_PI * n / N );
-                break;
-            case Dso::WindowFunction::FLATTOP: // wikipedia.de
-                for ( int n = 0; n < sampleCount; ++n )
-                    area += *pW++ = 0.216 - 0.417 * cos( 2 * M_PI * n / N ) + 0.277 * cos( 4 * M_PI * n / N ) -
-                                    0.084 * cos( 6 * M_PI * n / N ) + 0.007 * cos( 8 * M_PI * n / N );
-                break;
-            default: // Dso::WINDOW_RECTANGULAR
-                for ( auto &w : window )
-                    area += w = 1.0;
+        }
+        if ( 1 == segments ) {
+            // create powerSpectrum in spectrum.samples (display) and a copy of it in powerSpectrum (for the lazy iDFT)
+            // because hc2r iDFT destroys spectrum input
+            const double norm = 1.0 / dftLength / dftLength;
+            Real *fftPowerSpectrum = fftWindowedValues; // "rename" the fftw array, will be reused as input for the iDFT
+
+            // convert half-complex to magnitude square into spectrum.samples (display) and
+            // normalized into powerSpectrum, vectorized over the mirrored bin pairs
+            hcPowerSimd( fftHcSpectrum, unsigned( length ), displaySpectrum, fftPowerSpectrum, Real( norm ) );
+        } else {
+            // accumulate the segment power onto the display bins; half-complex layout:
+            // bin i (real) pairs with bin length - i (imaginary)
+            displaySpectrum[ 0 ] += double( fftHcSpectrum[ 0 ] ) * fftHcSpectrum[ 0 ];
+            for ( int bin = 1; bin < dftLength; ++bin ) {
+                double re = fftHcSpectrum[ bin ];
+                double im = fftHcSpectrum[ length - bin ];
+                displaySpectrum[ bin ] += re * re + im * im;
             }
-            // weight is the area below the window function
-            double windowScale = sampleCount / area; // normalise all windows equal to the rectangular window
-
-            // DFT transforms a 1V sin(ωt) signal to 1 = 0 dB, RMS = 0.707 V = sqrt(0.5) V (-3dBV)
-            // If we want to scale to 0 dBu = 0 dBm @ 600 Ω, RMS = 0.775V = sqrt(1 mW * 600 Ω)
-            // we must scale by sqrt(0.5/0.6) = -2.2 dB
-            windowScale *= sqrt( 0.5 ); // scale display to 0 dBV -> 1V RMS = 0dB
-            // printf( "window %u, weight %g\n", (unsigned)postprocessing->spectrumWindow, weight );
-            // scale the windowed samples
-            for ( auto &w : window )
-                w *= windowScale;
+            displaySpectrum[ dftLength ] += double( fftHcSpectrum[ dftLength ] ) * fftHcSpectrum[ dftLength ];
+        }
+    }
+    if ( segments > 1 ) {
+        // average the segments and build the normalized power copy that feeds the
+        // lazy autocorrelation, replacing the single segment hcPowerSimd() outputs
+        const double norm = 1.0 / dftLength / dftLength;
+        const double average = 1.0 / segments;
+        Real *fftPowerSpectrum = fftWindowedValues;
+        for ( int bin = 0; bin <= dftLength; ++bin ) {
+            displaySpectrum[ bin ] *= average;
+            fftPowerSpectrum[ bin ] = Real( displaySpectrum[ bin ] * norm );
         }
+        std::fill( fftPowerSpectrum + dftLength + 1, fftPowerSpectrum + length, Real( 0 ) );
+    }
+
+    // skip mirrored 2nd half (-1) of result spectrum
+    channelData->spectrum.samples->resize( size_t( dftLength + 1 ) );
+}
 
-        // Allocate the sample buffer (16byte aligned)
-        fftWindowedValues = fftw_alloc_real( size_t( qMax( SAMPLESIZE, sampleCount ) ) );
-        if ( nullptr == fftWindowedValues )
-            break;
 
-        // Set sampling interval
-        channelData->spectrum.interval = 1.0 / channelData->voltage.interval / double( sampleCount );
-
-        // Number of real/complex samples
-        int dftLength = sampleCount / 2;
-
-        // Reallocate memory for samples if the sample count has changed
-        channelData->spectrum.samples.resize( size_t( sampleCount ) );
-
-        // calculate the peak-to-peak value of the displayed part of trace
-        double min = INT_MAX;
-        double max = INT_MIN;
-        double horizontalFactor = result->data( channel )->voltage.interval / scope->horizontal.timebase;
-        unsigned dotsOnScreen = unsigned( DIVS_TIME / horizontalFactor + 0.99 ); // round up
-        unsigned preTrigSamples = unsigned( scope->trigger.position * dotsOnScreen );
-        int left = int( result->triggeredPosition ) - int( preTrigSamples ); // 1st sample to show
-        int right = left + int( dotsOnScreen );                              // last sample to show
-        if ( left < 0 )                                                      // trig pos or time/div was increased
-            left = 0;                                                        // show as much as we have on left side
-        // unsigned right = result->triggerPosition + DIVS_TIME * scope->horizontal.timebase / channelData->voltage.interval;
-        if ( right >= sampleCount )
-            right = sampleCount - 1;
-        for ( int position = left; // left side of trace
-              position <= right;   // right side
-              ++position ) {
-            if ( channelData->voltage.samples[ unsigned( position ) ] < min )
-                min = channelData->voltage.samples[ unsigned( position ) ];
-            if ( channelData->voltage.samples[ unsigned( position ) ] > max )
-                max = channelData->voltage.samples[ unsigned( position ) ];
+/// \brief The lazy second half of the transform: inverse transform the normalized
+/// power spectrum (left in the first scratch buffer by transformChannel()) into the
+/// autocorrelation and scan it for the leftmost significant peak.
+/// Only called when the spectrum peak alone is too coarse for the frequency
+/// readout; skipping the HC2R transform otherwise saves roughly half of the
+/// spectrum path CPU time.
+/// \return The sample position of the leftmost autocorrelation peak.
+template < typename Fftw >
+int SpectrumGenerator::correlateChannel( typename Fftw::Plan &fftPlanHC2R, typename Fftw::Real *fftPowerSpectrum,
+                                         typename Fftw::Real *fftAutoCorrelation, int sampleCount ) {
+    // Do an autocorrelation to get the frequency of the signal
+    // fft: f(t) o-- F(ω); calculate power spectrum |F(ω)|²
+    // ifft: F(ω) ∙ F(ω) --o f(t) ⊗ f(t) (convolution of f(t) with f(t), i.e. autocorrelation)
+    // HORO:
+    // This is quite inaccurate at high frequencies due to the used algorithm:
+    // as we do a autocorrelation the resolution at high frequencies is limited by voltagestep interval
+    // e.g. at 6 MHz sampled with 30 MS/s we get correlation at time shift
+    // of either 6 or 5 or 4 samples -> 30 MHz / 6 = 5.0 MHz ; 30 / 5 = 6.0 ; 30 / 4 = 7.5
+    // in these cases use spectrum instead if peak position is too small.
+
+    // Do half-complex to real inverse transformation -> autocorrelation
+    if ( analysis->reuseFftPlan ) { // same as for time -> spectrum
+        {
+            std::lock_guard< std::mutex > planLock( planMutex );
+            if ( nullptr == fftPlanHC2R ) {
+                fftPlanHC2R = Fftw::plan( sampleCount, fftPowerSpectrum, fftAutoCorrelation, FFTW_HC2R, FFTW_MEASURE );
+                saveWisdom();
+            }
         }
-        channelData->vmin = min;
-        channelData->vmax = max;
-        // channelData->vpp = max - min;
-
-        // calculate the average value
-        double dc = 0.0;
-        for ( auto &oneSample : channelData->voltage.samples )
-            dc += oneSample;
-        dc /= double( sampleCount );
-        channelData->dc = dc;
+        Fftw::execute( fftPlanHC2R, fftPowerSpectrum, fftAutoCorrelation );
+    } else {
+        typename Fftw::Plan oncePlan;
+        {
+            std::lock_guard< std::mutex > planLock( planMutex );
+            oncePlan = Fftw::plan( sampleCount, fftPowerSpectrum, fftAutoCorrelation, FFTW_HC2R, FFTW_ESTIMATE );
+        }
+        Fftw::executeOnce( oncePlan );
+        {
+            std::lock_guard< std::mutex > planLock( planMutex );
+            Fftw::destroy( oncePlan );
+        }
+    }
 
-        // now strip DC bias, calculate rms of AC component and apply window for fft to AC component
-        double ac2 = 0.0;
-        auto voltageIterator = channelData->voltage.samples.begin();
-        auto windowIterator = window.begin();
-        double *pfftW = fftWindowedValues;
-        for ( int position = 0; position < sampleCount; ++position ) {
-            double ac_sample = *voltageIterator++ - dc;
-            ac2 += ac_sample * ac_sample;
-            *pfftW++ = *windowIterator++ * ac_sample;
+    // Get the frequency from the correlation results
+    int peakCorrPos = 0;
+    double minCorr = 0;
+    double maxCorr = 0;
+    int maxCorrPos = 0;
+    // search from right to left for a max and remember this if a following min corr (<0) is found
+    for ( int position = sampleCount / 2; position > 1; --position ) { // go down to get leftmost peak (= max freq)
+        if ( fftAutoCorrelation[ position ] > maxCorr ) {              // find (local) max
+            maxCorr = fftAutoCorrelation[ position ];
+            maxCorrPos = position;
+            minCorr = 0; // reset minimum to start new min search
+            // printf( "max %d: %g\n", position, maxCorr );
+        } else if ( fftAutoCorrelation[ position ] < minCorr ) { // search for local min
+            minCorr = fftAutoCorrelation[ position ];
+            maxCorr = 0; // reset max to start new max search
+            peakCorrPos = maxCorrPos;
+            // printf( "min %d: %g\n", position, minCorr );
         }
-        ac2 /= double( sampleCount );             // AC²
-        channelData->ac = sqrt( ac2 );            // rms of AC component
-        channelData->rms = sqrt( dc * dc + ac2 ); // total rms = U eff
-        channelData->dB = 20.0 * log10( channelData->rms ) - scope->analysis.spectrumReference;
-        channelData->pulseWidth1 = result->pulseWidth1;
-        channelData->pulseWidth2 = result->pulseWidth2;
+    }
+    return peakCorrPos;
+}
 
-        // Do discrete real to half-complex transformation
-        // Record length should be multiple of 2, 3, 5: done, is 10000 = 2^a * 5^b
-        fftHcSpectrum = fftw_alloc_real( size_t( std::max( SAMPLESIZE, sampleCount ) ) );
-        if ( nullptr == fftHcSpectrum ) // error
-            break;
-        if ( analysis->reuseFftPlan ) {    // build one optimized plan and reuse it for all transformations
-            if ( nullptr == fftPlan_R2HC ) // not yet created, do it now (this takes some time)
-                fftPlan_R2HC = fftw_plan_r2r_1d( sampleCount, fftWindowedValues, fftHcSpectrum, FFTW_R2HC, FFTW_MEASURE );
-            fftw_execute_r2r( fftPlan_R2HC, fftWindowedValues, fftHcSpectrum ); // but it will run faster
-        } else { // build a more generic plan, this takes much less time than the optimized plan
-            fftPlan_R2HC = fftw_plan_r2r_1d( sampleCount, fftWindowedValues, fftHcSpectrum, FFTW_R2HC, FFTW_ESTIMATE );
-            fftw_execute( fftPlan_R2HC );      // use it once
-            fftw_destroy_plan( fftPlan_R2HC ); // and destroy it
-            fftPlan_R2HC = nullptr;            // no plan available;
+
+/// \brief Zoom FFT for narrowband analysis: mix the record to baseband around the
+/// center frequency with a recursive complex oscillator, decimate with a boxcar
+/// lowpass and transform the short decimated record with a complex DFT. This
+/// delivers span / zoomCount frequency resolution for a fraction of the cost of
+/// growing the record length (which SAMPLESIZE caps anyway).
+/// Fills spectrum.samples with the power bins of the band (lowest frequency first)
+/// and adjusts spectrum.interval and dftLength for the shared dB conversion.
+/// The short DFT always runs in double precision, its cost is negligible.
+/// \return The frequency of the first bin (left edge of the zoomed band).
+double SpectrumGenerator::zoomTransform( DataChannel *channelData, FftScratch &scratch, int sampleCount, double dc,
+                                         double &ac2, int &dftLength ) {
+    double samplerate = 1.0 / channelData->voltage.interval;
+    double center = qBound( 0.0, scope->analysis.spectrumZoomCenter, samplerate / 2 );
+    // mix to baseband and decimate, the boxcar average over zoomFactor samples is
+    // the (simple) lowpass; the oscillator e^(-j 2π center t) is advanced by one
+    // complex multiplication per sample instead of two trig calls
+    const double *voltage = channelData->voltage.samples->data();
+    fftw_complex *zoomed = scratch.z[ 0 ];
+    const double phaseStep = 2.0 * M_PI * center / samplerate;
+    const double stepRe = cos( phaseStep ), stepIm = -sin( phaseStep );
+    double oscRe = 1.0, oscIm = 0.0;
+    double accRe = 0.0, accIm = 0.0;
+    ac2 = 0.0;
+    int decimated = 0;
+    for ( int sample = 0; sample < sampleCount && decimated < zoomCount; ++sample ) {
+        double ac_sample = voltage[ sample ] - dc;
+        ac2 += ac_sample * ac_sample;
+        accRe += ac_sample * oscRe;
+        accIm += ac_sample * oscIm;
+        double rotated = oscRe * stepRe - oscIm * stepIm; // advance the oscillator
+        oscIm = oscRe * stepIm + oscIm * stepRe;
+        oscRe = rotated;
+        if ( 0 == ( sample + 1 ) % zoomFactor ) { // one decimated output sample is complete
+            double weight = zoomWindow[ size_t( decimated ) ] / zoomFactor;
+            zoomed[ decimated ][ 0 ] = accRe * weight;
+            zoomed[ decimated ][ 1 ] = accIm * weight;
+            accRe = accIm = 0.0;
+            if ( 0 == ( ++decimated & 0x3f ) ) { // counter the amplitude drift of the recursion
+                double scale = 1.0 / sqrt( oscRe * oscRe + oscIm * oscIm );
+                oscRe *= scale;
+                oscIm *= scale;
+            }
         }
-        // Do an autocorrelation to get the frequency of the signal
-        // fft: f(t) o-- F(ω); calculate power spectrum |F(ω)|²
-        // ifft: F(ω) ∙ F(ω) --o f(t) ⊗ f(t) (convolution of f(t) with f(t), i.e. autocorrelation)
-        // HORO:
-        // This is quite inaccurate at high frequencies due to the used algorithm:
-        // as we do a autocorrelation the resolution at high frequencies is limited by voltagestep interval
-        // e.g. at 6 MHz sampled with 30 MS/s we get correlation at time shift
-        // of either 6 or 5 or 4 samples -> 30 MHz / 6 = 5.0 MHz ; 30 / 5 = 6.0 ; 30 / 4 = 7.5
-        // in these cases use spectrum instead if peak position is too small.
-
-        // create powerSpectrum in spectrum.samples (display) and a copy of it in powerSpectrum (for iDFT)
-        // because hc2r iDFT destroys spectrum input
-        const double norm = 1.0 / dftLength / dftLength;
-        fftPowerSpectrum = fftWindowedValues; // "rename" the fftw array, will be reused as input for the iDFT
-        fftWindowedValues = nullptr;          // invalidate the old pointer
-
-        int position;
-        // correct the (half-)complex values in hcSpectrum
-        // (1st part real forward), (2nd part imag backwards) -> magnitude
-        double const *fwd = fftHcSpectrum;                   // forward "iterator"
-        double const *rev = fftHcSpectrum + sampleCount - 1; // reverse "iterator"
-        double *powerIterator = fftPowerSpectrum;
-        auto spectrumIterator = channelData->spectrum.samples.begin(); // this shall be displayed later
-        // convert half-complex to magnitude square into spectrum.samples and into powerSpectrum
-        *spectrumIterator = *fwd * *fwd;
-        *powerIterator++ = *spectrumIterator++ * norm;
-        ++fwd; // spectrum[0] is only real
-        for ( position = 1; position < dftLength; ++position ) {
-            *spectrumIterator = ( *fwd * *fwd + *rev * *rev );
-            *powerIterator++ = *spectrumIterator++ * norm;
-            ++fwd;
-            --rev;
+    }
+    ac2 /= double( sampleCount ); // AC²
+
+    // complex DFT of the decimated record; the plan is kept across blocks because
+    // the execution with changing buffers goes through fftw_execute_dft()
+    fftw_complex *bins = scratch.z[ 1 ];
+    {
+        std::lock_guard< std::mutex > planLock( planMutex ); // the planner is not thread safe
+        if ( fftPlan_zoom && zoomPlanLength != zoomCount ) { // decimated length changed
+            fftw_destroy_plan( fftPlan_zoom );
+            fftPlan_zoom = nullptr;
         }
-        *spectrumIterator = *fwd * *fwd;
-        *powerIterator++ = *spectrumIterator++ * norm;
+        if ( nullptr == fftPlan_zoom ) {
+            fftPlan_zoom =
+                fftw_plan_dft_1d( zoomCount, zoomed, bins, FFTW_FORWARD, analysis->reuseFftPlan ? FFTW_MEASURE : FFTW_ESTIMATE );
+            zoomPlanLength = zoomCount;
+            if ( analysis->reuseFftPlan )
+                saveWisdom();
+        }
+    }
+    fftw_execute_dft( fftPlan_zoom, zoomed, bins );
+
+    // power bins, shifted so that the lowest frequency of the band comes first;
+    // the complex mix leaves A/2 of a real sine of amplitude A, scale the power
+    // by 4 so that dftLength = zoomCount matches the dB offset of the real path
+    std::vector< double > &spectrum = channelData->spectrum.modifiableSamples();
+    spectrum.resize( size_t( zoomCount ) );
+    auto spectrumIterator = spectrum.begin();
+    for ( int bin = 0; bin < zoomCount; ++bin ) {
+        int source = ( bin + zoomCount / 2 ) % zoomCount;
+        double re = bins[ source ][ 0 ];
+        double im = bins[ source ][ 1 ];
+        *spectrumIterator++ = 4.0 * ( re * re + im * im );
+    }
+    channelData->spectrum.interval = samplerate / zoomFactor / zoomCount;
+    dftLength = zoomCount;
+    return center - zoomCount / 2 * channelData->spectrum.interval;
+}
 
-        // skip mirrored 2nd half (-1) of result spectrum
-        channelData->spectrum.samples.resize( size_t( dftLength + 1 ) );
 
-        // Complex values, all zero for autocorrelation
-        for ( ++position; position < sampleCount; ++position ) {
-            *powerIterator++ = 0;
-        }
+/// Coefficients a0..a4 of the cosine sum windows
+/// w( n ) = a0 - a1 cos( x ) + a2 cos( 2x ) - a3 cos( 3x ) + a4 cos( 4x ), x = 2πn/N.
+/// Returns nullptr for the window functions that are not of this family.
+static const double *cosineSumCoefficients( Dso::WindowFunction function ) {
+    static constexpr double hann[ 5 ] = { 0.5, 0.5, 0.0, 0.0, 0.0 };
+    static constexpr double hamming[ 5 ] = { 0.54, 0.46, 0.0, 0.0, 0.0 }; // a0 approximates 25.0 / 46.0
+    static constexpr double blackman[ 5 ] = { 0.42, 0.5, 0.08, 0.0, 0.0 }; // alpha = 0.16
+    static constexpr double nuttall[ 5 ] = { 0.355768, 0.487396, 0.144232, 0.012604, 0.0 };
+    static constexpr double blackmanHarris[ 5 ] = { 0.35875, 0.48829, 0.14128, 0.01168, 0.0 };
+    static constexpr double blackmanNuttall[ 5 ] = { 0.3635819, 0.4891775, 0.1365995, 0.0106411, 0.0 };
+    static constexpr double flattop[ 5 ] = { 0.216, 0.417, 0.277, 0.084, 0.007 }; // wikipedia.de
+    switch ( function ) {
+    case Dso::WindowFunction::HANN:
+        return hann;
+    case Dso::WindowFunction::HAMMING:
+        return hamming;
+    case Dso::WindowFunction::BLACKMAN:
+        return blackman;
+    case Dso::WindowFunction::NUTTALL:
+        return nuttall;
+    case Dso::WindowFunction::BLACKMAN_HARRIS:
+        return blackmanHarris;
+    case Dso::WindowFunction::BLACKMAN_NUTTALL:
+        return blackmanNuttall;
+    case Dso::WindowFunction::FLATTOP:
+        return flattop;
+    default:
+        return nullptr;
+    }
+}
 
-        // reuse the array, but "rename" it
-        fftAutoCorrelation = fftHcSpectrum;
-        fftHcSpectrum = nullptr;
 
-        // Do half-complex to real inverse transformation -> autocorrelation
-        if ( analysis->reuseFftPlan ) { // same as above for time -> spectrum
-            if ( nullptr == fftPlan_HC2R )
-                fftPlan_HC2R = fftw_plan_r2r_1d( sampleCount, fftPowerSpectrum, fftAutoCorrelation, FFTW_HC2R, FFTW_MEASURE );
-            fftw_execute_r2r( fftPlan_HC2R, fftPowerSpectrum, fftAutoCorrelation );
-        } else {
-            fftw_plan fftPlan_HC2R =
-                fftw_plan_r2r_1d( sampleCount, fftPowerSpectrum, fftAutoCorrelation, FFTW_HC2R, FFTW_ESTIMATE );
-            fftw_execute( fftPlan_HC2R );
-            fftw_destroy_plan( fftPlan_HC2R );
-            fftPlan_HC2R = nullptr;
+/// \brief Build the tapering window for one (function, length) pair into dest,
+/// scaled to display 1 Veff as 0 dB reference level.
+static void buildWindow( Dso::WindowFunction function, int sampleCount, std::vector< double > &dest ) {
+    // Theory:
+    // Harris, Fredric J. (Jan 1978):
+    // "On the use of Windows for Harmonic Analysis with the Discrete Fourier Transform".
+    // Proceedings of the IEEE. 66 (1): 51–83. Bibcode:1978IEEEP..66...51H.
+    // CiteSeerX 10.1.1.649.9880. doi:10.1109/PROC.1978.10837. S2CID 426548.
+    // The fundamental 1978 paper on FFT windows by Harris, which specified many windows
+    // and introduced key metrics used to compare them.
+    // http://web.mit.edu/xiphmont/Public/windows.pdf
+
+    dest.resize( size_t( sampleCount ) );
+    double N = sampleCount - 1; // most window functions work for 0 <= n <= N
+    // scale all windows to display 1 Veff as 0 dBu reference level.
+    double area = 0.0; // calculate area under window fkt
+    auto pW = dest.begin();
+    const double *cs = cosineSumCoefficients( function );
+    if ( cs ) { // all cosine sum windows share one generation loop
+        for ( int n = 0; n < sampleCount; ++n ) {
+            double x = 2.0 * M_PI * n / N;
+            area += *pW++ = cs[ 0 ] - cs[ 1 ] * cos( x ) + cs[ 2 ] * cos( 2 * x ) - cs[ 3 ] * cos( 3 * x ) + cs[ 4 ] * cos( 4 * x );
         }
-        // content was destroyed during iFFT, free the memory
-        fftw_free( fftPowerSpectrum );
-        fftPowerSpectrum = nullptr;
-
-        // Get the frequency from the correlation results
-        int peakCorrPos = 0;
-        double minCorr = 0;
-        double maxCorr = 0;
-        int maxCorrPos = 0;
-        // search from right to left for a max and remember this if a following min corr (<0) is found
-        for ( position = unsigned( sampleCount ) / 2; position > 1; --position ) { // go down to get leftmost peak (= max freq)
-            if ( fftAutoCorrelation[ position ] > maxCorr ) {                      // find (local) max
-                maxCorr = fftAutoCorrelation[ position ];
-                maxCorrPos = position;
-                minCorr = 0; // reset minimum to start new min search
-                // printf( "max %d: %g\n", position, maxCorr );
-            } else if ( fftAutoCorrelation[ position ] < minCorr ) { // search for local min
-                minCorr = fftAutoCorrelation[ position ];
-                maxCorr = 0; // reset max to start new max search
-                peakCorrPos = maxCorrPos;
-                // printf( "min %d: %g\n", position, minCorr );
+    } else {
+        switch ( function ) {
+        case Dso::WindowFunction::COSINE:
+            for ( int n = 0; n < sampleCount; ++n )
+                area += *pW++ = sin( M_PI * n / N );
+            break;
+        case Dso::WindowFunction::LANCZOS:
+            for ( int n = 0; n < sampleCount; ++n ) {
+                double sincParameter = ( 2.0 * n / N - 1.0 ) * M_PI;
+                if ( bool( sincParameter ) )
+                    area += *pW++ = sin( sincParameter ) / sincParameter;
+                else
+                    area += *pW++ = 1;
             }
-        }
-        fftw_free( fftAutoCorrelation );
-        fftAutoCorrelation = nullptr;
-
-        // Finally calculate the real spectrum (it's also used for frequency calculation)
-        // Convert values into dB (Relative to the reference level 0 dBV = 1V eff)
-        double offset = -scope->analysis.spectrumReference - 20 * log10( dftLength );
-        double offsetLimit = analysis->spectrumLimit; // - scope->analysis.spectrumReference;
-        double peakSpectrum = offsetLimit;            // get a start value for peak search
-        int peakFreqPos = 0;                          // initial position of max spectrum peak
-        position = 0;
-        min = INT_MAX;
-        max = INT_MIN;
-        for ( auto &oneSample : channelData->spectrum.samples ) {
-            // spectrum is power spectrum, but show amplitude spectrum -> 10 * log...
-            double value = 10 * log10( oneSample ) + offset;
-            // Check if this value has to be limited
-            if ( value < offsetLimit )
-                value = offsetLimit;
-            oneSample = value;
-            // detect frequency peak
-            if ( value > peakSpectrum ) {
-                peakSpectrum = value;
-                peakFreqPos = position;
+            break;
+        case Dso::WindowFunction::TRIANGULAR: // same with N+1
+            for ( int n = 0; n < sampleCount; ++n )
+                area += *pW++ = 2.0 / sampleCount * ( sampleCount / 2 - std::abs( n - N / 2.0 ) );
+            break;
+        case Dso::WindowFunction::BARTLETT: // the original triangle
+            for ( int n = 0; n < sampleCount; ++n )
+                area += *pW++ = 2.0 / N * ( N / 2 - std::abs( n - N / 2.0 ) );
+            break;
+        case Dso::WindowFunction::BARTLETT_HANN:
+            for ( int n = 0; n < sampleCount; ++n )
+                area += *pW++ = 0.62 - 0.48 * std::abs( n / N - 0.5 ) - 0.38 * cos( 2.0 * M_PI * n / N );
+            break;
+        case Dso::WindowFunction::GAUSS: {
+            const double sigma = 0.3;
+            for ( int n = 0; n < sampleCount; ++n ) {
+                double w = ( n - N / 2.0 ) / ( sigma * N / 2.0 );
+                w *= w;
+                area += *pW++ = exp( -w / 2 );
             }
-            if ( value < min )
-                min = value;
-            if ( value > max )
-                max = value;
-            ++position;
+            break;
         }
-        channelData->dBmin = min;
-        channelData->dBmax = max;
-
-        // Calculate both peak frequencies (correlation and spectrum) in Hz
-        double pF = channelData->spectrum.interval * peakFreqPos;
-        double pC = 1.0 / ( channelData->voltage.interval * peakCorrPos );
-        if ( scope->verboseLevel > 5 )
-            qDebug() << "     SpectrumGenerator::process()" << channel << "freq:" << peakFreqPos << pF << "corr:" << peakCorrPos
-                     << pC;
-        if ( peakFreqPos > peakCorrPos // use frequency result if it is more granular than correlation
-             || peakFreqPos > 100      // or at least if it is granular enough (+- 1% resolution)
-             || peakCorrPos < 100 || peakCorrPos > sampleCount / 4 ) { // or if correlation is out of safe range
-            channelData->frequency = pF;
-        } else { // otherwise fall back to correlation
-            channelData->frequency = pC;
+        case Dso::WindowFunction::KAISER: {
+            const double beta = M_PI * 2.75; // β = πα
+            double bb = besseli0( beta );
+            for ( int n = 0; n < sampleCount; ++n )
+                area += *pW++ = besseli0( beta * sqrt( 4.0 * n * ( N - n ) ) / ( N ) ) / bb;
+            break;
+        }
+        default: // Dso::WINDOW_RECTANGULAR
+            for ( auto &w : dest )
+                area += w = 1.0;
         }
-        if ( scope->analysis.showNoteValue )
-            channelData->note = calculateNote( channelData->frequency );
+    }
+    // weight is the area below the window function
+    double windowScale = sampleCount / area; // normalise all windows equal to the rectangular window
+
+    // DFT transforms a 1V sin(ωt) signal to 1 = 0 dB, RMS = 0.707 V = sqrt(0.5) V (-3dBV)
+    // If we want to scale to 0 dBu = 0 dBm @ 600 Ω, RMS = 0.775V = sqrt(1 mW * 600 Ω)
+    // we must scale by sqrt(0.5/0.6) = -2.2 dB
+    windowScale *= sqrt( 0.5 ); // scale display to 0 dBV -> 1V RMS = 0dB
+    // scale the windowed samples
+    for ( auto &w : dest )
+        w *= windowScale;
+}
+
+
+/// \brief Put a freshly built window table at the front of the small LRU cache.
+void SpectrumGenerator::cacheWindow( Dso::WindowFunction function, std::vector< double > &&samples ) {
+    windowCache.push_front( { function, std::move( samples ) } );
+    if ( windowCache.size() > windowCacheLimit )
+        windowCache.pop_back();
+}
+
+
+/// \brief Provide the tapering window for the requested record length, rebuilt in
+/// case of changes only. Recently used tables are served from a small LRU cache;
+/// when only the window function changes the new table is built on a background
+/// worker while the previous one keeps serving, so a window switch no longer
+/// stalls the post-processing thread (Kaiser at long records takes a visible beat).
+/// All channels share one window vector because they have the same record length;
+/// process() calls this once before the channels are dispatched to the workers.
+void SpectrumGenerator::updateWindow( int sampleCount ) {
+    Dso::WindowFunction function = analysis->spectrumWindow;
+    if ( windowPending && windowReady ) { // a background build has finished, adopt it
+        windowWorker.wait();
+        cacheWindow( pendingFunction, std::move( pendingWindow ) );
+        windowPending = false;
+    }
+    if ( previousWindowFunction == function && window.size() == size_t( sampleCount ) )
+        return; // the current window still fits
+    tracePost( scope->verboseLevel > 5, "     SpectrumGenerator::updateWindow()" << int( function ) << sampleCount );
+    // look for the (function, length) pair in the cache
+    for ( auto entry = windowCache.begin(); entry != windowCache.end(); ++entry ) {
+        if ( entry->function == function && entry->samples.size() == size_t( sampleCount ) ) {
+            windowCache.splice( windowCache.begin(), windowCache, entry ); // move to front
+            window = windowCache.front().samples;
+            previousWindowFunction = function;
+            return;
+        }
+    }
+    if ( window.size() == size_t( sampleCount ) ) {
+        // Same record length, only the function changed: keep serving the previous
+        // window and build the new one in the background; it is adopted through the
+        // cache as soon as it is ready. A second switch while a build is running is
+        // picked up on a later block, after the pending table was adopted.
+        if ( !windowPending ) {
+            windowPending = true;
+            windowReady = false;
+            pendingFunction = function;
+            windowWorker.start( [ this, function, sampleCount ]() {
+                buildWindow( function, sampleCount, pendingWindow );
+                windowReady = true;
+            } );
+        }
+        return;
+    }
+    // no window of this record length available at all, build it now
+    buildWindow( function, sampleCount, window );
+    previousWindowFunction = function;
+    cacheWindow( function, std::vector< double >( window ) );
+}
+
+
+/// \brief Merge the fresh power spectrum of one channel into its persistent
+/// accumulator and write the merged bins back for display, one fused pass.
+/// AVERAGE fades new blocks in exponentially to integrate the noise floor,
+/// MAXHOLD keeps the maximum of every bin; a mode or record length change
+/// restarts the accumulation with the fresh spectrum.
+void SpectrumGenerator::accumulateSpectrum( DataChannel *channelData, ChannelID channel ) {
+    if ( channel >= scope->spectrum.size() )
+        return;
+    SpectrumMode mode = scope->spectrum[ channel ].mode;
+    SpectrumAccu &accu = spectrumAccu[ channel ];
+    if ( SpectrumMode::SINGLE == mode ) { // no accumulation, drop the history
+        accu.power.clear();
+        accu.mode = mode;
+        return;
+    }
+    if ( mode != accu.mode || accu.power.size() != channelData->spectrum.samples->size() ) {
+        accu.power = *channelData->spectrum.samples; // (re)start with the fresh spectrum
+        accu.mode = mode;
+        return;
+    }
+    auto accuIt = accu.power.begin();
+    if ( SpectrumMode::AVERAGE == mode ) {
+        const double weight = 0.125; // a new block fades in with 1/8, i.e. ~8 blocks of history
+        for ( double &power : *channelData->spectrum.samples ) {
+            *accuIt += weight * ( power - *accuIt );
+            power = *accuIt;
+            ++accuIt;
+        }
+    } else { // SpectrumMode::MAXHOLD
+        for ( double &power : *channelData->spectrum.samples ) {
+            if ( power > *accuIt )
+                *accuIt = power;
+            else
+                power = *accuIt;
+            ++accuIt;
+        }
+    }
+}
+
+
+/// \brief Calculate spectrum, autocorrelation and the derived measurements of one
+/// channel. The channels are independent and process() runs them concurrently, so
+/// everything in here touches shared members only in a read-only way (the planner
+/// calls in transformChannel() are serialized by planMutex).
+void SpectrumGenerator::processChannel( PPresult *result, ChannelID channel ) {
+    DataChannel *const channelData = result->modifiableData( channel );
+
+    if ( channelData->voltage.samples->empty() ) {
+        // Clear unused channels
+        channelData->spectrum.interval = 0;
+        channelData->spectrum.modifiableSamples().clear();
+        return;
+    }
+    int sampleCount = int( channelData->voltage.samples->size() );
+    tracePost( scope->verboseLevel > 5, "     SpectrumGenerator::processChannel()" << channel << "sampleCount:" << sampleCount
+                                            << "transformLength:" << transformLength );
+    FftScratch &scratch = fftScratch[ channel ];
+
+    // Set sampling interval; the FFT length may be decoupled from the record length
+    channelData->spectrum.interval = 1.0 / channelData->voltage.interval / double( transformLength );
+
+    // Number of real/complex samples
+    int dftLength = transformLength / 2;
+
+    // Reallocate memory for samples if the sample count has changed
+    channelData->spectrum.modifiableSamples().resize( size_t( transformLength ) );
+
+    // calculate the peak-to-peak value of the displayed part of trace;
+    // the measurement scans honor the configurable stride (menu Settings/Analysis),
+    // the display rounds to 3 significant digits anyway - ac/rms come for free from
+    // the full resolution FFT window pass and are not affected
+    const int stride = int( qMax( 1u, analysis->measurementStride ) );
+    double min = INT_MAX;
+    double max = INT_MIN;
+    double horizontalFactor = result->data( channel )->voltage.interval / scope->horizontal.timebase;
+    unsigned dotsOnScreen = unsigned( DIVS_TIME / horizontalFactor + 0.99 ); // round up
+    unsigned preTrigSamples = unsigned( scope->trigger.position * dotsOnScreen );
+    int left = int( result->triggeredPosition ) - int( preTrigSamples ); // 1st sample to show
+    int right = left + int( dotsOnScreen );                              // last sample to show
+    if ( left < 0 )                                                      // trig pos or time/div was increased
+        left = 0;                                                        // show as much as we have on left side
+    // unsigned right = result->triggerPosition + DIVS_TIME * scope->horizontal.timebase / channelData->voltage.interval;
+    if ( right >= sampleCount )
+        right = sampleCount - 1;
+    for ( int position = left; // left side of trace
+          position <= right;   // right side
+          position += stride ) {
+        if ( ( *channelData->voltage.samples )[ unsigned( position ) ] < min )
+            min = ( *channelData->voltage.samples )[ unsigned( position ) ];
+        if ( ( *channelData->voltage.samples )[ unsigned( position ) ] > max )
+            max = ( *channelData->voltage.samples )[ unsigned( position ) ];
+    }
+    channelData->vmin = min;
+    channelData->vmax = max;
+    // channelData->vpp = max - min;
+
+    // the average value, prefilled from the conversion statistics when available
+    double dc = channelData->dc;
+    if ( !channelData->dcValid ) { // e.g. the MATH channel, average its samples here
+        dc = 0.0;
+        int scanned = 0;
+        const double *voltage = channelData->voltage.samples->data();
+        for ( int position = 0; position < sampleCount; position += stride, ++scanned )
+            dc += voltage[ position ];
+        dc /= double( scanned );
+        channelData->dc = dc;
+    }
+
+    // transform the samples into the half-complex spectrum and autocorrelation;
+    // the single precision path halves the memory traffic of both FFTs and of
+    // the spectrum loops, the displayed spectrum and dB conversion stay double
+    double ac2 = 0.0;
+    double spectrumLeft = 0.0; // frequency of the first spectrum bin, != 0 for the zoom FFT
+    const bool zoom = scope->analysis.spectrumZoom && zoomCount > 0;
+    if ( zoom ) { // narrowband analysis around the center frequency
+        if ( !ensureZoomBuffers( scratch, size_t( zoomCount ) ) )
+            return;
+        spectrumLeft = zoomTransform( channelData, scratch, sampleCount, dc, ac2, dftLength );
+    } else
+#ifdef HAVE_FFTWF
+        if ( analysis->singlePrecisionFft ) {
+        if ( !ensureFftBuffersF( scratch, size_t( qMax( SAMPLESIZE, sampleCount ) ) ) )
+            return;
+        transformChannel< FftwFloat >( fftPlanF_R2HC, scratch.f[ 0 ], scratch.f[ 1 ], channelData, sampleCount, dc, ac2 );
+    } else
+#endif
+    {
+        if ( !ensureFftBuffers( scratch, size_t( qMax( SAMPLESIZE, sampleCount ) ) ) )
+            return;
+        transformChannel< FftwDouble >( fftPlan_R2HC, scratch.d[ 0 ], scratch.d[ 1 ], channelData, sampleCount, dc, ac2 );
+    }
+    channelData->ac = sqrt( ac2 );            // rms of AC component
+    channelData->rms = sqrt( dc * dc + ac2 ); // total rms = U eff
+    channelData->dB = 20.0 * log10( channelData->rms ) - scope->analysis.spectrumReference;
+    channelData->pulseWidth1 = result->pulseWidth1;
+    channelData->pulseWidth2 = result->pulseWidth2;
+
+    // merge the fresh power spectrum into the persistent accumulator (average / max hold)
+    accumulateSpectrum( channelData, channel );
+
+    // Finally calculate the real spectrum (it's also used for frequency calculation)
+    // Convert values into dB (Relative to the reference level 0 dBV = 1V eff)
+    // spectrum is power spectrum, but show amplitude spectrum -> 10 * log...
+    // vectorized with a fast log10, the limit clamp and the peak / min / max scan
+    // are fused into the same pass (scalar log10 rivaled the FFT in the profiles)
+    double offset = -scope->analysis.spectrumReference - 20 * log10( dftLength );
+    double offsetLimit = analysis->spectrumLimit; // - scope->analysis.spectrumReference;
+    int peakFreqPos = spectrumDbSimd( channelData->spectrum.samples->data(), unsigned( channelData->spectrum.samples->size() ),
+                                      offset, offsetLimit, min, max );
+    channelData->dBmin = min;
+    channelData->dBmax = max;
+
+    // The frequency selection below prefers the spectrum peak whenever it is
+    // granular enough (peakFreqPos > 100), the autocorrelation result would be
+    // unused then - run the expensive inverse transform only when it is needed.
+    // The THD harmonics are read directly from the spectrum bins either way.
+    // The zoom FFT leaves no half-complex spectrum and its bins are fine anyway.
+    int peakCorrPos = 0;
+    if ( !zoom && peakFreqPos <= 100 ) {
+#ifdef HAVE_FFTWF
+        if ( analysis->singlePrecisionFft )
+            peakCorrPos = correlateChannel< FftwFloat >( fftPlanF_HC2R, scratch.f[ 0 ], scratch.f[ 1 ], transformLength );
         else
-            channelData->note = "";
-        // calculate the total harmonic distortion of the signal (optional)
-        // according IEEE method: THD = sqrt( power_of_harmonics / power_of_fundamental )
-        if ( scope->analysis.calculateTHD ) { // set in menu Oscilloscope/Settings/Analysis
-            channelData->thd = -1;            // invalid unless calculation is ok
-            double f1 = channelData->frequency / channelData->spectrum.interval;
-            if ( f1 >= 1 ) { // position of fundamental frequency is usable
-                // get power of fundamental frequency
-                double p1 = pow( 10, channelData->spectrum.samples[ unsigned( round( f1 ) ) ] / 10 );
-                if ( p1 > 0 ) {
-                    double pn = 0.0;                                     // sum of power of harmonics
-                    for ( double fn = 2 * f1; fn < dftLength; fn += f1 ) // iterate over all harmonics
-                        pn += pow( 10, channelData->spectrum.samples[ unsigned( round( fn ) ) ] / 10 );
-                    channelData->thd = sqrt( pn / p1 );
-                    if ( scope->verboseLevel > 5 )
-                        qDebug() << "     SpectrumGenerator::process() THD" << channel << p1 << pn << channelData->thd;
-                    // printf( "%g %g %g %% THD\n", p1, pn, channelData->thd );
+#endif
+            peakCorrPos = correlateChannel< FftwDouble >( fftPlan_HC2R, scratch.d[ 0 ], scratch.d[ 1 ], transformLength );
+    }
+
+    // Calculate both peak frequencies (correlation and spectrum) in Hz
+    double pF = spectrumLeft + channelData->spectrum.interval * peakFreqPos;
+    double pC = 1.0 / ( channelData->voltage.interval * peakCorrPos );
+    tracePost( scope->verboseLevel > 5, "     SpectrumGenerator::processChannel()" << channel << "freq:" << peakFreqPos << pF
+                                            << "corr:" << peakCorrPos << pC );
+    if ( peakFreqPos > peakCorrPos // use frequency result if it is more granular than correlation
+         || peakFreqPos > 100      // or at least if it is granular enough (+- 1% resolution)
+         || peakCorrPos < 100 || peakCorrPos > transformLength / 4 ) { // or if correlation is out of safe range
+        channelData->frequency = pF;
+    } else { // otherwise fall back to correlation
+        channelData->frequency = pC;
+    }
+    // The continuous zero crossing counter (HantekDsoControl) resolves mHz over its
+    // one second gate where spectrum and correlation are limited to bin resolution.
+    // Use it whenever it roughly agrees with the estimate above; the agreement check
+    // guards against signals where counter and peak disagree structurally (noise
+    // crossing the zero line several times per period, strong subharmonics).
+    if ( channelData->counterFrequency > 0.0 && channelData->frequency > 0.0 &&
+         fabs( channelData->counterFrequency - channelData->frequency ) < 0.3 * channelData->frequency )
+        channelData->frequency = channelData->counterFrequency;
+    if ( scope->analysis.showNoteValue )
+        channelData->note = calculateNote( channelData->frequency );
+    else
+        channelData->note = "";
+    // calculate the total harmonic distortion of the signal (optional)
+    // according IEEE method: THD = sqrt( power_of_harmonics / power_of_fundamental )
+    if ( scope->analysis.calculateTHD ) { // set in menu Oscilloscope/Settings/Analysis
+        channelData->thd = -1;            // invalid unless calculation is ok
+        double f1 = channelData->frequency / channelData->spectrum.interval;
+        if ( !zoom && f1 >= 1 ) { // position of fundamental frequency is usable (harmonics are outside the zoomed band)
+            // get power of fundamental frequency
+            double p1 = pow( 10, ( *channelData->spectrum.samples )[ unsigned( round( f1 ) ) ] / 10 );
+            if ( p1 > 0 ) {
+                double pn = 0.0;                                     // sum of power of harmonics
+                for ( double fn = 2 * f1; fn < dftLength; fn += f1 ) // iterate over all harmonics
+                    pn += pow( 10, ( *channelData->spectrum.samples )[ unsigned( round( fn ) ) ] / 10 );
+                channelData->thd = sqrt( pn / p1 );
+                tracePost( scope->verboseLevel > 5,
+                           "     SpectrumGenerator::processChannel() THD" << channel << p1 << pn << channelData->thd );
+                // printf( "%g %g %g %% THD\n", p1, pn, channelData->thd );
+            }
+        }
+    }
+}
+
+
+void SpectrumGenerator::process( PPresult *result ) {
+    // Calculate frequencies and spectrums
+
+    tracePost( scope->verboseLevel > 4, "    SpectrumGenerator::process()" << result->tag );
+
+    if ( 0 == result->channelCount() )
+        return;
+
+    if ( wisdomLoader.joinable() ) // the startup wisdom import must finish before any planner call
+        wisdomLoader.join();
+
+    // the channels share one tapering window, (re)build it before they are dispatched
+    zoomCount = 0; // also the shared zoom FFT parameters, all channels have the same record length
+    for ( ChannelID channel = 0; channel < result->channelCount(); ++channel )
+        if ( !result->data( channel )->voltage.samples->empty() ) {
+            int sampleCount = int( result->data( channel )->voltage.samples->size() );
+            // the FFT length may be decoupled from the record length (menu
+            // Settings/Analysis): shorter transforms are averaged Welch segments
+            transformLength = sampleCount;
+            if ( analysis->spectrumLength && int( analysis->spectrumLength ) < sampleCount )
+                transformLength = int( analysis->spectrumLength );
+            else if ( overBudget.load( std::memory_order_relaxed ) && sampleCount >= 2 * SAMPLESIZE )
+                transformLength = sampleCount / 2; // budget hint: halve the FFT length of deep records
+            if ( analysis->reuseFftPlan && transformLength != reusePlanLength ) {
+                // the reused plans are bound to one length, rebuild them on change
+                std::lock_guard< std::mutex > planLock( planMutex );
+                if ( fftPlan_R2HC ) {
+                    fftw_destroy_plan( fftPlan_R2HC );
+                    fftPlan_R2HC = nullptr;
+                }
+                if ( fftPlan_HC2R ) {
+                    fftw_destroy_plan( fftPlan_HC2R );
+                    fftPlan_HC2R = nullptr;
+                }
+#ifdef HAVE_FFTWF
+                if ( fftPlanF_R2HC ) {
+                    fftwf_destroy_plan( fftPlanF_R2HC );
+                    fftPlanF_R2HC = nullptr;
+                }
+                if ( fftPlanF_HC2R ) {
+                    fftwf_destroy_plan( fftPlanF_HC2R );
+                    fftPlanF_HC2R = nullptr;
+                }
+#endif
+                reusePlanLength = transformLength;
+            }
+            updateWindow( transformLength );
+            if ( scope->analysis.spectrumZoom ) {
+                double samplerate = 1.0 / result->data( channel )->voltage.interval;
+                // decimate so that the complex baseband rate just covers the requested span,
+                // but keep at least 16 decimated samples for a usable short DFT
+                double span = qBound( samplerate / sampleCount, scope->analysis.spectrumZoomSpan, samplerate / 2 );
+                zoomFactor = qMax( 1, qMin( int( samplerate / span ), sampleCount / 16 ) );
+                zoomCount = sampleCount / zoomFactor;
+                if ( zoomWindow.size() != size_t( zoomCount ) || zoomWindowFunction != analysis->spectrumWindow ) {
+                    buildWindow( analysis->spectrumWindow, zoomCount, zoomWindow ); // short record, build synchronously
+                    zoomWindowFunction = analysis->spectrumWindow;
                 }
             }
+            break;
         }
+    if ( fftScratch.size() < result->channelCount() )
+        fftScratch.resize( result->channelCount() );
+    if ( spectrumAccu.size() < result->channelCount() )
+        spectrumAccu.resize( result->channelCount() );
+
+    // the channels are independent, process them concurrently: the first one on this
+    // thread, the other channels on the reusable workers
+    unsigned dispatched = 0;
+    for ( ChannelID channel = 1; channel < result->channelCount() && dispatched < 2; ++channel ) {
+        spectrumWorker[ dispatched++ ].start( [ this, result, channel ]() { processChannel( result, channel ); } );
     }
-    // free the memory used for fft unless already done ("fftw_free( nullptr )" is a no-op)
-    fftw_free( fftWindowedValues );
-    fftw_free( fftHcSpectrum );
-    fftw_free( fftPowerSpectrum );
-    fftw_free( fftAutoCorrelation );
+    processChannel( result, 0 );
+    for ( ChannelID channel = 1 + dispatched; channel < result->channelCount(); ++channel )
+        processChannel( result, channel ); // more channels than workers, handle the rest here too
+    for ( unsigned worker = 0; worker < dispatched; ++worker )
+        spectrumWorker[ worker ].wait();
 }
 
 
-const QString &SpectrumGenerator::calculateNote( double frequency ) {
-    note = "";
+QString SpectrumGenerator::calculateNote( double frequency ) const {
+    QString note = "";
     if ( frequency > 10 && frequency < 24000 ) { // audio frequencies
         const std::vector< QString > notes = { "A", "A#", "B", "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#" };
         double f = fmod( 12 * log2( frequency / 440.0 ) + 120, 12.0 );
@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include <QMutex>
@@ -11,14 +15,15 @@
 #include <fftw3.h>
 
 #include "analysissettings.h"
+#include "convertworker.h"
 #include "dsosamples.h"
 #include "ppresult.h"
+#include "scopesettings.h"
 #include "utils/printutils.h"
 
 #include "processor.h"
 
 class DsoSettings;
-struct DsoSettingsScope;
 
 /// \brief Analyzes the data from the dso.
 /// Calculates the spectrum and various data about the signal and saves the
@@ -28,16 +33,94 @@ class SpectrumGenerator : public Processor {
   public:
     SpectrumGenerator( const DsoSettingsScope *scope, const DsoSettingsAnalysis *postprocessing );
     ~SpectrumGenerator() override;
+    const char *name() const override { return "spectrum"; }
+    /// Budget hint: when set, the FFT length of deep records is halved.
+    void setOverBudget( bool over ) override { overBudget = over; }
 
   private:
+    std::atomic< bool > overBudget{ false }; ///< written by the budget evaluation, read in processChannel()
     const DsoSettingsScope *scope;
     const DsoSettingsAnalysis *analysis;
     Dso::WindowFunction previousWindowFunction = Dso::WindowFunction( -1 ); ///< The previously used dft window function
-    std::vector< double > window;                                           ///< storage for the tapering window
+    std::vector< double > window;                                           ///< the currently served tapering window
+    /// One entry of the small window LRU cache, keyed on (function, record length).
+    struct WindowTable {
+        Dso::WindowFunction function; ///< the window function the table was built for
+        std::vector< double > samples; ///< the scaled window values
+    };
+    std::list< WindowTable > windowCache;     ///< most recently used window tables, front = newest
+    static const size_t windowCacheLimit = 4; ///< a handful of tables, ~160 kB each at 20 kS
+    void cacheWindow( Dso::WindowFunction function, std::vector< double > &&samples );
+    void updateWindow( int sampleCount );
+    bool windowPending = false;                                      ///< a background build is running or not yet adopted
+    std::atomic< bool > windowReady{ false };                        ///< the background build has finished
+    Dso::WindowFunction pendingFunction = Dso::WindowFunction( -1 ); ///< function of the background build
+    std::vector< double > pendingWindow;                             ///< result of the background build
+    ConvertWorker windowWorker; ///< builds a switched window in the background, after pendingWindow (destruction order)
+    /// FFT length of the current block, set in process() before the channels are
+    /// dispatched; shorter than the record length when a decoupled length is
+    /// configured (Welch segment averaging) or the budget hint is active.
+    int transformLength = 0;
+    int reusePlanLength = 0; ///< length the reused R2HC/HC2R plans were created for
     fftw_plan fftPlan_R2HC = nullptr;
     fftw_plan fftPlan_HC2R = nullptr;
-    QString note;
-    const QString &calculateNote( double frequency );
+    std::mutex planMutex; ///< serializes all FFTW planner calls, the planner is not thread safe
+    QString wisdomFile;   ///< persisted FFTW wisdom in the config directory, empty = don't persist
+    /// Imports the persisted wisdom concurrently with the remaining session startup
+    /// (scope window, OpenGL setup); joined before the first planner call.
+    std::thread wisdomLoader;
+    void saveWisdom();
+    /// The aligned FFT scratch buffers of one channel, reallocated only when the
+    /// record length grows; each concurrently processed channel owns its own pair.
+    struct FftScratch {
+        double *d[ 2 ] = { nullptr, nullptr }; ///< double precision buffers
+        size_t dSize = 0;                      ///< allocated double precision size
+#ifdef HAVE_FFTWF
+        float *f[ 2 ] = { nullptr, nullptr }; ///< single precision buffers
+        size_t fSize = 0;                     ///< allocated single precision size
+#endif
+        fftw_complex *z[ 2 ] = { nullptr, nullptr }; ///< complex buffers of the zoom FFT
+        size_t zSize = 0;                            ///< allocated complex size
+    };
+    std::vector< FftScratch > fftScratch; ///< one scratch buffer pair per channel
+    bool ensureFftBuffers( FftScratch &scratch, size_t size );
+#ifdef HAVE_FFTWF // single precision path, needs libfftw3f
+    fftwf_plan fftPlanF_R2HC = nullptr;
+    fftwf_plan fftPlanF_HC2R = nullptr;
+    QString wisdomFileF; ///< persisted wisdom of the single precision plans
+    bool ensureFftBuffersF( FftScratch &scratch, size_t size );
+#endif
+    /// The precision independent transform core, Fftw wraps either the fftw_ or the fftwf_ API.
+    template < typename Fftw >
+    void transformChannel( typename Fftw::Plan &fftPlanR2HC, typename Fftw::Real *fftWindowedValues,
+                           typename Fftw::Real *fftHcSpectrum, DataChannel *channelData, int sampleCount, double dc,
+                           double &ac2 );
+    /// The lazy second half of the transform: inverse transform of the power spectrum
+    /// into the autocorrelation, only run when the spectrum peak is too coarse.
+    template < typename Fftw >
+    int correlateChannel( typename Fftw::Plan &fftPlanHC2R, typename Fftw::Real *fftPowerSpectrum,
+                          typename Fftw::Real *fftAutoCorrelation, int sampleCount );
+    // zoom FFT: narrowband analysis around a center frequency
+    int zoomFactor = 1;  ///< decimation factor of the current block
+    int zoomCount = 0;   ///< decimated record length, 0 = zoom FFT not active
+    std::vector< double > zoomWindow; ///< tapering window of the decimated record
+    Dso::WindowFunction zoomWindowFunction = Dso::WindowFunction( -1 ); ///< function zoomWindow was built with
+    fftw_plan fftPlan_zoom = nullptr; ///< complex DFT plan of the zoomed record
+    int zoomPlanLength = 0;           ///< record length fftPlan_zoom was created for
+    bool ensureZoomBuffers( FftScratch &scratch, size_t size );
+    double zoomTransform( DataChannel *channelData, FftScratch &scratch, int sampleCount, double dc, double &ac2,
+                          int &dftLength );
+    /// Persistent power spectrum accumulator of one channel for the average and
+    /// max hold modes, merged with one fused pass over the fresh bins.
+    struct SpectrumAccu {
+        SpectrumMode mode = SpectrumMode::SINGLE; ///< the mode its content was built with
+        std::vector< double > power;              ///< accumulated power spectrum bins
+    };
+    std::vector< SpectrumAccu > spectrumAccu; ///< one accumulator per channel
+    void accumulateSpectrum( DataChannel *channelData, ChannelID channel );
+    void processChannel( PPresult *result, ChannelID channel );
+    ConvertWorker spectrumWorker[ 2 ]; ///< up to two channels run concurrently with the caller's one
+    QString calculateNote( double frequency ) const;
     // Processor interface
     void process( PPresult *data ) override;
 };
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QDebug>
+#include <QHostAddress>
+
+#include "scpiserver.h"
+
+#include "dsomodel.h"
+#include "hantekdso/enums.h"
+#include "hantekdso/hantekdsocontrol.h"
+#include "usb/scopedevice.h"
+
+#include "OH_VERSION.h"
+
+
+ScpiServer::ScpiServer( HantekDsoControl *dsoControl, quint16 port, int verboseLevel, QObject *parent )
+    : QObject( parent ), dsoControl( dsoControl ), verboseLevel( verboseLevel ) {
+    if ( !commandServer.listen( QHostAddress::Any, port ) )
+        qWarning() << "SCPI: cannot listen on command port" << port << commandServer.errorString();
+    else if ( verboseLevel )
+        qDebug() << "SCPI: command port" << port << "- streaming port" << port + 1;
+    if ( !streamServer.listen( QHostAddress::Any, quint16( port + 1 ) ) )
+        qWarning() << "SCPI: cannot listen on streaming port" << port + 1 << streamServer.errorString();
+
+    connect( &commandServer, &QTcpServer::newConnection, this, [ this ]() {
+        while ( QTcpSocket *client = commandServer.nextPendingConnection() ) {
+            if ( this->verboseLevel > 1 )
+                qDebug() << " SCPI: command client" << client->peerAddress().toString();
+            connect( client, &QTcpSocket::disconnected, client, &QTcpSocket::deleteLater );
+            connect( client, &QTcpSocket::readyRead, this, [ this, client ]() {
+                while ( client->canReadLine() )
+                    handleLine( client, QString::fromLatin1( client->readLine() ).trimmed() );
+            } );
+        }
+    } );
+    connect( &streamServer, &QTcpServer::newConnection, this, [ this ]() {
+        while ( QTcpSocket *client = streamServer.nextPendingConnection() ) {
+            if ( this->verboseLevel > 1 )
+                qDebug() << " SCPI: streaming client" << client->peerAddress().toString();
+            streamClients.push_back( client );
+            connect( client, &QTcpSocket::disconnected, this, [ this, client ]() {
+                streamClients.remove( client );
+                client->deleteLater();
+            } );
+        }
+    } );
+}
+
+
+void ScpiServer::handleLine( QTcpSocket *client, const QString &line ) {
+    if ( line.isEmpty() )
+        return;
+    if ( verboseLevel > 2 )
+        qDebug() << "  SCPI:" << line;
+    QString response = handleCommand( line );
+    if ( !response.isEmpty() )
+        client->write( ( response + '\n' ).toLatin1() );
+}
+
+
+/// \brief Execute one remote command and build its response.
+/// Commands are case insensitive; queries end with '?'. Setters answer "OK" on
+/// success and "ERR <code>" (the numeric Dso::ErrorCode) on failure, unknown
+/// commands go through the stringCommand() passthrough of the scope control.
+QString ScpiServer::handleCommand( const QString &line ) {
+    auto code = []( Dso::ErrorCode errorCode ) {
+        return errorCode == Dso::ErrorCode::NONE ? QString( "OK" ) : QString( "ERR %1" ).arg( int( errorCode ) );
+    };
+    const QString command = line.section( ' ', 0, 0 ).toUpper();
+    const QString parameter = line.section( ' ', 1, -1 ).trimmed();
+    const QString value = parameter.toUpper();
+
+    if ( command == "*IDN?" )
+        return QString( "OpenHantek6022,%1,%2,%3" )
+            .arg( dsoControl->getModel()->name, dsoControl->getDevice()->getSerialNumber(), VERSION );
+    if ( command == "SAMPLERATE?" || command == "SAMP?" )
+        return QString::number( dsoControl->getSamplerate() );
+    if ( command == "SAMPLERATE:MEAS?" || command == "SAMP:MEAS?" ) // drift corrected rate, 0.0 until settled
+        return QString::number( dsoControl->getMeasuredSamplerate(), 'f', 3 );
+    if ( command == "SAMPLERATE" || command == "SAMP" )
+        return code( dsoControl->setSamplerate( parameter.toDouble() ) );
+    if ( command == "CALFREQ" )
+        return code( dsoControl->setCalFreq( parameter.toDouble() ) );
+    if ( command == "START" ) {
+        dsoControl->enableSamplingUI( true );
+        return "OK";
+    }
+    if ( command == "STOP" ) {
+        dsoControl->enableSamplingUI( false );
+        return "OK";
+    }
+
+    // channel commands: CHAN<n>:<SUBJECT> <value>, channel number is 1 based
+    if ( command.startsWith( "CHAN" ) && command.contains( ':' ) ) {
+        const QString subject = command.section( ':', 1 );
+        ChannelID channel = ChannelID( command.section( ':', 0, 0 ).rightRef( 1 ).toUInt() );
+        if ( channel < 1 )
+            return "ERR " + QString::number( int( Dso::ErrorCode::PARAMETER ) );
+        --channel; // SCPI counts from 1
+        if ( subject == "USED" )
+            return code( dsoControl->setChannelUsed( channel, value.toUInt() != 0 ) );
+        if ( subject == "INVERT" )
+            return code( dsoControl->setChannelInverted( channel, value.toUInt() != 0 ) );
+        if ( subject == "GAIN" )
+            return code( dsoControl->setGain( channel, parameter.toDouble() ) );
+        if ( subject == "PROBE" )
+            return code( dsoControl->setProbe( channel, parameter.toDouble() ) );
+        if ( subject == "COUPLING" ) {
+            if ( value == "DC" )
+                return code( dsoControl->setCoupling( channel, Dso::Coupling::DC ) );
+            if ( value == "AC" )
+                return code( dsoControl->setCoupling( channel, Dso::Coupling::AC ) );
+            if ( value == "GND" )
+                return code( dsoControl->setCoupling( channel, Dso::Coupling::GND ) );
+            return "ERR " + QString::number( int( Dso::ErrorCode::PARAMETER ) );
+        }
+    }
+
+    // trigger commands: TRIG:<SUBJECT> <value>
+    if ( command.startsWith( "TRIG:" ) ) {
+        const QString subject = command.section( ':', 1 );
+        if ( subject == "MODE" ) {
+            if ( value == "AUTO" )
+                return code( dsoControl->setTriggerMode( Dso::TriggerMode::AUTO ) );
+            if ( value == "NORMAL" )
+                return code( dsoControl->setTriggerMode( Dso::TriggerMode::NORMAL ) );
+            if ( value == "SINGLE" )
+                return code( dsoControl->setTriggerMode( Dso::TriggerMode::SINGLE ) );
+            if ( value == "ROLL" )
+                return code( dsoControl->setTriggerMode( Dso::TriggerMode::ROLL ) );
+            return "ERR " + QString::number( int( Dso::ErrorCode::PARAMETER ) );
+        }
+        if ( subject == "SOURCE" )
+            return code( dsoControl->setTriggerSource( value.toInt() - 1 ) );
+        if ( subject == "SLOPE" ) {
+            if ( value.startsWith( "POS" ) )
+                return code( dsoControl->setTriggerSlope( Dso::Slope::Positive ) );
+            if ( value.startsWith( "NEG" ) )
+                return code( dsoControl->setTriggerSlope( Dso::Slope::Negative ) );
+            if ( value == "BOTH" )
+                return code( dsoControl->setTriggerSlope( Dso::Slope::Both ) );
+            return "ERR " + QString::number( int( Dso::ErrorCode::PARAMETER ) );
+        }
+        if ( subject.startsWith( "LEVEL" ) ) {
+            ChannelID channel = ChannelID( subject.rightRef( 1 ).toUInt() );
+            if ( channel < 1 )
+                return "ERR " + QString::number( int( Dso::ErrorCode::PARAMETER ) );
+            return code( dsoControl->setTriggerLevel( channel - 1, parameter.toDouble() ) );
+        }
+        if ( subject == "POSITION" )
+            return code( dsoControl->setTriggerPosition( parameter.toDouble() ) );
+        if ( subject == "SMOOTH" )
+            return code( dsoControl->setTriggerSmooth( parameter.toInt() ) );
+        if ( subject == "HOLDOFF" )
+            return code( dsoControl->setTriggerHoldoff( parameter.toDouble() ) );
+    }
+
+    return code( dsoControl->stringCommand( line ) ); // e.g. the low level "cc" commands
+}
+
+
+void ScpiServer::sendSamples( const std::shared_ptr< PPresult > &data ) {
+    if ( streamClients.empty() )
+        return;
+    // assemble the fixed size frame header, the sample payload below is written
+    // straight out of the shared result buffers without an intermediate copy
+    const unsigned channels = data->channelCount();
+    struct {
+        char magic[ 4 ];
+        quint32 tag;
+        quint16 channelCount;
+        quint16 flags;
+        quint32 triggeredPosition;
+        double samplerate;
+    } header = { { 'O', 'H', 'S', 'B' },
+                 quint32( data->tag ),
+                 quint16( channels ),
+                 quint16( data->softwareTriggerTriggered ? 1 : 0 ),
+                 quint32( data->triggeredPosition ),
+                 data->data( 0 )->voltage.interval > 0.0 ? 1.0 / data->data( 0 )->voltage.interval : 0.0 };
+    for ( QTcpSocket *client : streamClients ) {
+        if ( client->state() != QAbstractSocket::ConnectedState )
+            continue;
+        if ( client->bytesToWrite() > qint64( 1 << 22 ) )
+            continue; // a stalled client does not block or grow without bound, it skips blocks
+        client->write( reinterpret_cast< const char * >( &header ), sizeof header );
+        for ( ChannelID channel = 0; channel < channels; ++channel ) {
+            const std::vector< double > &samples = *data->data( channel )->voltage.samples;
+            quint32 count = quint32( samples.size() );
+            client->write( reinterpret_cast< const char * >( &count ), sizeof count );
+            if ( count )
+                client->write( reinterpret_cast< const char * >( samples.data() ), qint64( count ) * 8 );
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <list>
+#include <memory>
+
+#include "post/ppresult.h"
+
+class HantekDsoControl;
+
+/// \brief SCPI-ish TCP remote control with a binary streaming endpoint.
+/// Listening is enabled with the --scpiPort option. The command port accepts one
+/// newline terminated command per line (see handleCommand() for the full set);
+/// the commands map onto the HantekDsoControl setters, everything unknown goes
+/// through the existing stringCommand() passthrough. Queries end with '?', every
+/// other command answers "OK" or "ERR <code>" with the Dso::ErrorCode value.
+/// Port + 1 is the streaming endpoint: every connected client receives each
+/// processed block as one binary frame, written directly from the shared sample
+/// buffers of the result (no intermediate copy):
+///   "OHSB" magic, u32 tag, u16 channelCount, u16 flags (bit 0: triggered),
+///   u32 triggeredPosition, f64 samplerate, then per channel one u32 sample
+///   count followed by that many f64 samples; all little endian.
+class ScpiServer : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Start listening on the command and streaming ports.
+    /// \param dsoControl The scope control the commands are mapped onto.
+    /// \param port The command port, port + 1 becomes the streaming port.
+    ScpiServer( HantekDsoControl *dsoControl, quint16 port, int verboseLevel, QObject *parent = nullptr );
+
+  public slots:
+    /// \brief Push one processed block to all connected streaming clients.
+    /// Connect to PostProcessing::processingFinished.
+    void sendSamples( const std::shared_ptr< PPresult > &data );
+
+  private:
+    void handleLine( QTcpSocket *client, const QString &line );
+    QString handleCommand( const QString &line );
+    HantekDsoControl *dsoControl;
+    int verboseLevel;
+    QTcpServer commandServer;
+    QTcpServer streamServer;
+    std::list< QTcpSocket * > streamClients;
+};
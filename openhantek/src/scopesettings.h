@@ -36,17 +36,24 @@ struct DsoSettingsScopeHorizontal {
 #endif
     double samplerate = 1e6; ///< The samplerate of the oscilloscope in S
     int dotsOnScreen = 0;
-    double calfreq = 1e3; ///< The frequency of the calibration output
+    double calfreq = 1e3;    ///< The frequency of the calibration output
+    int captureHistory = 100; ///< Number of raw capture blocks kept for stepping back after stop (0 = off)
+    unsigned acquireAverage = 1; ///< Average this many trigger aligned frames (1 = off, up to 256)
+    bool acquireEnvelope = false; ///< Accumulate a per sample min/max band across trigger aligned frames
 };
 
 /// \brief Holds the settings for the trigger.
 /// TODO Use ControlSettingsTrigger
 struct DsoSettingsScopeTrigger {
-    Dso::TriggerMode mode = Dso::TriggerMode::AUTO; ///< Automatic, normal or single trigger
-    double position = 0.5;                          ///< Horizontal position for pretrigger (middle of screen)
-    Dso::Slope slope = Dso::Slope::Positive;        ///< Rising or falling edge causes trigger
-    int source = 0;                                 ///< Channel that is used as trigger source
-    int smooth = 0;                                 ///< Don't trigger on glitches
+    Dso::TriggerMode mode = Dso::TriggerMode::AUTO;             ///< Automatic, normal or single trigger
+    double position = 0.5;                                      ///< Horizontal position for pretrigger (middle of screen)
+    Dso::Slope slope = Dso::Slope::Positive;                    ///< Rising or falling edge causes trigger
+    int source = 0;                                             ///< Channel that is used as trigger source
+    int smooth = 0;                                             ///< Don't trigger on glitches
+    Dso::TriggerQualify qualify = Dso::TriggerQualify::Edge;    ///< Pulse width qualification of the edge
+    double pulseWidthMin = 1e-6;                                ///< Lower pulse width limit in s
+    double pulseWidthMax = 1e-3;                                ///< Upper pulse width limit in s
+    double holdoff = 0.0;                                       ///< Minimum time between two triggers in s (0 = off)
 };
 
 /// \brief Base for DsoSettingsScopeSpectrum and DsoSettingsScopeVoltage
@@ -57,10 +64,18 @@ struct DsoSettingsScopeChannel {
     DsoSettingsScopeCursor cursor;
 };
 
+/// \brief The accumulation of consecutive spectra of one channel.
+enum class SpectrumMode : int {
+    SINGLE,  ///< a fresh spectrum for every block
+    AVERAGE, ///< exponential average over consecutive blocks
+    MAXHOLD  ///< keep the maximum of every frequency bin
+};
+
 /// \brief Holds the settings for the spectrum analysis.
 struct DsoSettingsScopeSpectrum : public DsoSettingsScopeChannel {
-    double offset = 0.0;     ///< Vertical offset in divs
-    double magnitude = 20.0; ///< The vertical resolution in dB/div
+    double offset = 0.0;                      ///< Vertical offset in divs
+    double magnitude = 20.0;                  ///< The vertical resolution in dB/div
+    SpectrumMode mode = SpectrumMode::SINGLE; ///< Accumulation of consecutive spectra
 };
 
 /// \brief Holds the settings for the power and frequency analysis.
@@ -83,6 +98,9 @@ struct DsoSettingsScopeAnalysis {
     };
     bool calculateTHD = false;
     bool showNoteValue = false;
+    bool spectrumZoom = false;       ///< zoom FFT: analyze only a narrow band around the center frequency
+    double spectrumZoomCenter = 1e6; ///< center frequency of the zoomed band in Hz
+    double spectrumZoomSpan = 1e3;   ///< width of the zoomed band in Hz
 };
 
 /// \brief Holds the settings for the normal voltage graphs.
@@ -109,9 +127,12 @@ struct DsoSettingsScope {
     int verboseLevel = 0;
     int toolTipVisible = 1; // show hints for beginners, can be disabled in settings dialog
     bool histogram = false;
+    bool waterfall = false; ///< show the spectra history as a scrolling spectrogram
     bool hasACcoupling = false;
     bool hasACmodification = false;
     bool liveCalibrationActive = false;
+    int captureCpuCore = -1;      ///< pin the capture thread (incl. USB transfers) to this core, -1 = off
+    bool captureRealTime = false; ///< raise the capture thread to SCHED_FIFO where permitted
 
     double gain( unsigned channel ) const { return gainSteps[ voltage[ channel ].gainStepIndex ] * voltage[ channel ].probeAttn; }
 
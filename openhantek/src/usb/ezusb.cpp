@@ -27,6 +27,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 // No Qt header loaded -> do not use Q_OS_FREEBSD, use __FreeBSD__
 #ifdef __FreeBSD__
 #include <libusb.h>
@@ -419,6 +423,77 @@ static int ram_poke( void *context, uint32_t addr, bool external, const unsigned
     return rc;
 }
 
+/*****************************************************************************/
+
+/*
+ * Pre-parsed firmware cache.  Parsing the ihex image costs one fgets()
+ * and many strtoul() calls per 16 byte record and is repeated on every
+ * device plug-in.  Instead we parse each firmware once into a list of
+ * coalesced binary segments kept in memory and replay those segments
+ * with maximum-size control transfers on all further uploads.
+ */
+
+/* one contiguous memory region of the firmware image */
+struct firmware_segment {
+    uint32_t addr;
+    std::vector< unsigned char > data;
+};
+
+typedef std::vector< firmware_segment > firmware_segments;
+
+/* parsed images, keyed by the caller supplied firmware name */
+static std::map< std::string, firmware_segments > firmware_cache;
+
+/* largest control transfer used to replay a cached segment,
+ * same limit as the FX3 RAM upload below */
+#define MAX_CTRL_SIZE 4096
+
+/*
+ * poke() callback for parse_ihex() that appends the flushed chunks to a
+ * segment list instead of writing them to the device.  Chunks that
+ * continue the previous segment are merged, so most firmware images
+ * collapse into a handful of large segments.
+ */
+static int cache_poke( void *context, uint32_t addr, bool, const unsigned char *data, size_t len ) {
+    firmware_segments *segments = static_cast< firmware_segments * >( context );
+    if ( !segments->empty() ) {
+        firmware_segment &last = segments->back();
+        if ( addr == last.addr + last.data.size() ) { /* contiguous, merge */
+            last.data.insert( last.data.end(), data, data + len );
+            return 0;
+        }
+    }
+    firmware_segment segment;
+    segment.addr = addr;
+    segment.data.assign( data, data + len );
+    segments->push_back( segment );
+    return 0;
+}
+
+/*
+ * Write the cached segments to the device, sliced into maximum-size
+ * control transfers, using the same poke policy as the direct upload.
+ */
+static int upload_segments( const firmware_segments &segments, struct ram_poke_context *ctx,
+                            bool ( *is_external )( uint32_t addr, size_t len ) ) {
+    for ( firmware_segments::const_iterator segment = segments.begin(); segment != segments.end(); ++segment ) {
+        size_t offset = 0;
+        while ( offset < segment->data.size() ) {
+            size_t len = segment->data.size() - offset;
+            if ( len > MAX_CTRL_SIZE )
+                len = MAX_CTRL_SIZE;
+            uint32_t addr = segment->addr + uint32_t( offset );
+            bool external = is_external ? is_external( addr, len ) : false;
+            if ( ram_poke( ctx, addr, external, segment->data.data() + offset, len ) < 0 )
+                return -1;
+            offset += len;
+        }
+    }
+    return 0;
+}
+
+bool ezusb_firmware_cached( const char *name ) { return firmware_cache.find( name ) != firmware_cache.end(); }
+
 /*
  * Load a Cypress Image file into target RAM.
  * See http://www.cypress.com/?docID=41351 (AN76405 PDF) for more info.
@@ -672,3 +747,108 @@ exit:
     fclose( image );
     return ret;
 }
+
+/*
+ * Load a firmware into target RAM like ezusb_load_ram(), but parse the
+ * hex file only on the first upload for this "name" and replay the
+ * cached binary segments on all later ones.  "path" is only needed (and
+ * only opened) when the firmware is not in the cache yet.
+ */
+int ezusb_load_ram_cached( libusb_device_handle *device, const char *name, const char *path, int fx_type, int stage ) {
+    uint32_t cpucs_addr;
+    bool ( *is_external )( uint32_t off, size_t len );
+    struct ram_poke_context ctx;
+    int ret = 0;
+
+    if ( fx_type == FX_TYPE_FX3 ) /* binary image format, no hex parsing to cache */
+        return ezusb_load_ram( device, path, fx_type, stage );
+
+    std::map< std::string, firmware_segments >::iterator cached = firmware_cache.find( name );
+    if ( cached == firmware_cache.end() ) {
+        /* first upload of this firmware, parse the hex file into the cache */
+        FILE *image = fopen( path, "rb" );
+        if ( image == nullptr ) {
+            logerror( "%s: unable to open for input.\n", path );
+            return -2;
+        } else if ( verboseLevel > 6 )
+            logerror( "      parse firmware image %s into segment cache\n", path );
+        firmware_segments segments;
+        int status = parse_ihex( image, &segments, nullptr, cache_poke );
+        fclose( image );
+        if ( status < 0 ) {
+            logerror( "unable to parse %s\n", path );
+            return status;
+        }
+        cached = firmware_cache.insert( std::make_pair( std::string( name ), segments ) ).first;
+    } else if ( verboseLevel > 6 )
+        logerror( "      upload firmware %s from segment cache\n", name );
+
+    /* EZ-USB original/FX and FX2 devices differ, apart from the 8051 core */
+    switch ( fx_type ) {
+    case FX_TYPE_FX2LP:
+        cpucs_addr = 0xe600;
+        is_external = fx2lp_is_external;
+        break;
+    case FX_TYPE_FX2:
+        cpucs_addr = 0xe600;
+        is_external = fx2_is_external;
+        break;
+    default:
+        cpucs_addr = 0x7f92;
+        is_external = fx_is_external;
+        break;
+    }
+
+    /* use only first stage loader? */
+    if ( stage == 0 ) {
+        ctx.mode = internal_only;
+
+        /* if required, halt the CPU while we overwrite its code/data */
+        if ( cpucs_addr && !ezusb_cpucs( device, cpucs_addr, false ) )
+            return -1;
+
+        /* 2nd stage, first part? loader was already uploaded */
+    } else {
+        ctx.mode = skip_internal;
+
+        /* let CPU run; overwrite the 2nd stage loader later */
+        if ( verboseLevel > 6 )
+            logerror( "      2nd stage: write external memory\n" );
+    }
+
+    /* write the segments, first (maybe only) time */
+    ctx.device = device;
+    ctx.total = ctx.count = 0;
+    if ( upload_segments( cached->second, &ctx, is_external ) < 0 ) {
+        logerror( "unable to upload %s\n", name );
+        return -1;
+    }
+
+    /* second part of 2nd stage: replay the cached segments */
+    if ( stage ) {
+        ctx.mode = skip_external;
+
+        /* if needed, halt the CPU while we overwrite the 1st stage loader */
+        if ( cpucs_addr && !ezusb_cpucs( device, cpucs_addr, false ) )
+            return -1;
+
+        /* at least write the interrupt vectors (at 0x0000) for reset! */
+        if ( verboseLevel > 6 )
+            logerror( "      2nd stage: write on-chip memory\n" );
+        if ( upload_segments( cached->second, &ctx, is_external ) < 0 ) {
+            logerror( "unable to completely upload %s\n", name );
+            return -1;
+        }
+    }
+
+    if ( verboseLevel > 6 && ( ctx.count != 0 ) ) {
+        logerror( "      ... WROTE: %d bytes, %d segments, avg %d\n", int( ctx.total ), int( ctx.count ),
+                  int( ctx.total / ctx.count ) );
+    }
+
+    /* if required, reset the CPU so it runs what we just uploaded */
+    if ( cpucs_addr && !ezusb_cpucs( device, cpucs_addr, true ) )
+        ret = -1;
+
+    return ret;
+}
@@ -36,5 +36,22 @@ struct libusb_device_handle;
  */
 extern int ezusb_load_ram( libusb_device_handle *device, const char *path, int fx_type, int stage );
 
+/*
+ * Same as ezusb_load_ram(), but the ihex image is parsed only once per
+ * cache key "name" (e.g. the model's firmware token) into a coalesced
+ * binary segment list that is kept in memory.  Subsequent uploads for
+ * the same firmware skip the line-by-line hex parsing and write the
+ * cached segments with maximum-size control transfers - this shortens
+ * the device-ready time noticeably when several scopes re-enumerate.
+ * "path" may be empty if ezusb_firmware_cached( name ) returned true.
+ */
+extern int ezusb_load_ram_cached( libusb_device_handle *device, const char *name, const char *path, int fx_type, int stage );
+
+/*
+ * Return true if the firmware "name" was already parsed into the cache,
+ * the caller can then skip the creation of the temporary hex file.
+ */
+extern bool ezusb_firmware_cached( const char *name );
+
 // Verbosity level set by command line option --verbose
 extern int verboseLevel;
@@ -22,16 +22,50 @@
 FindDevices::FindDevices( libusb_context *context, int verboseLevel ) : context( context ), verboseLevel( verboseLevel ) {
     if ( verboseLevel > 1 )
         qDebug() << " FindDevices::FindDevices()";
+    // Let libusb report device arrival/removal, so that updateDeviceList() has to walk
+    // the bus only after an actual change instead of re-enumerating it once a second.
+    if ( libusb_has_capability( LIBUSB_CAP_HAS_HOTPLUG ) ) {
+        hotplugActive = LIBUSB_SUCCESS ==
+                        libusb_hotplug_register_callback( context,
+                                                          libusb_hotplug_event( LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                                                                LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT ),
+                                                          libusb_hotplug_flag( 0 ), LIBUSB_HOTPLUG_MATCH_ANY,
+                                                          LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY, hotplugCallback,
+                                                          this, &hotplugHandle );
+        if ( verboseLevel > 2 )
+            qDebug() << "  hotplug events" << ( hotplugActive ? "registered" : "not available" );
+    }
+}
+
+
+FindDevices::~FindDevices() {
+    if ( hotplugActive )
+        libusb_hotplug_deregister_callback( context, hotplugHandle );
+}
+
+
+// A device arrived or left, called from the libusb event handling context
+int LIBUSB_CALL FindDevices::hotplugCallback( libusb_context *, libusb_device *, libusb_hotplug_event, void *user_data ) {
+    static_cast< FindDevices * >( user_data )->busChanged = true;
+    return 0; // keep the callback registered
 }
 
 
 // Iterate all devices on USB and keep track of all supported scopes
 int FindDevices::updateDeviceList() {
+    if ( hotplugActive ) {
+        // dispatch pending hotplug events without blocking
+        struct timeval tv = { 0, 0 };
+        libusb_handle_events_timeout( context, &tv );
+        if ( !busChanged.exchange( false ) ) // bus layout unchanged, keep the current list
+            return 0;
+    }
     if ( verboseLevel > 2 )
         qDebug() << "  FindDevices::updateDeviceList()";
     libusb_device **deviceList;
     ssize_t deviceCount = libusb_get_device_list( context, &deviceList );
     if ( deviceCount < 0 ) {
+        busChanged = true; // scan failed, retry on the next call
         return int( deviceCount );
     }
 
@@ -40,9 +74,16 @@ int FindDevices::updateDeviceList() {
 
     for ( ssize_t deviceIndex = 0; deviceIndex < deviceCount; ++deviceIndex ) {
         libusb_device *device = deviceList[ deviceIndex ];
-        // Get device descriptor
-        struct libusb_device_descriptor descriptor;
-        libusb_get_device_descriptor( device, &descriptor );
+        // Probe the device once, later scans reuse the cached descriptor and USB id
+        ProbeCache::iterator probe = probeCache.find( device );
+        if ( probe == probeCache.end() ) {
+            DeviceProbe newProbe;
+            libusb_get_device_descriptor( device, &newProbe.descriptor );
+            newProbe.id = ScopeDevice::computeUSBdeviceID( device );
+            probe = probeCache.insert( std::make_pair( device, newProbe ) ).first;
+        }
+        probe->second.findIteration = findIteration;
+        const libusb_device_descriptor &descriptor = probe->second.descriptor;
 
         if ( 0x0000 == descriptor.idVendor ) // windows sometimes reports bogus value vid=0x0000
             continue;
@@ -50,7 +91,7 @@ int FindDevices::updateDeviceList() {
         if ( 0x1d6b == descriptor.idVendor ) // skip linux foundation devices, e.g. usb root hubs
             continue;
 
-        const UniqueUSBid USBid = ScopeDevice::computeUSBdeviceID( device );
+        const UniqueUSBid USBid = probe->second.id;
 
         DeviceList::const_iterator inList = devices.find( USBid );
         if ( inList != devices.end() ) { // already in list, update heartbeat only
@@ -69,7 +110,7 @@ int FindDevices::updateDeviceList() {
                 ++changes;
                 if ( verboseLevel > 2 )
                     qDebug() << "  +++" << QString( "0x%1" ).arg( USBid, 8, 16, QChar( '0' ) ) << model->name;
-                devices[ USBid ] = std::unique_ptr< ScopeDevice >( new ScopeDevice( model, device, findIteration ) );
+                devices[ USBid ] = std::unique_ptr< ScopeDevice >( new ScopeDevice( model, device, findIteration, context ) );
                 break; // stop after 1st supported model (there can be more models with identical VID/PID)
             }
         }
@@ -87,6 +128,13 @@ int FindDevices::updateDeviceList() {
             ++it;
         }
     }
+    // Drop cached probes of unplugged devices, their pointer may be reused by libusb
+    for ( ProbeCache::iterator it = probeCache.begin(); it != probeCache.end(); ) {
+        if ( it->second.findIteration != findIteration )
+            it = probeCache.erase( it );
+        else
+            ++it;
+    }
     libusb_free_device_list( deviceList, false );
     return changes; // report number of all detected bus changes (added + removed devices)
 }
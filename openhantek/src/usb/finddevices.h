@@ -3,6 +3,7 @@
 #pragma once
 
 #include <QString>
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -24,6 +25,7 @@ class FindDevices {
   public:
     typedef std::map< UniqueUSBid, std::unique_ptr< ScopeDevice > > DeviceList;
     explicit FindDevices( libusb_context *context, int verboseLevel = 0 );
+    ~FindDevices();
     /// Updates the device list. To clear the list, just dispose this object
     /// \return If negative it represents a libusb error code otherwise the amount of updates
     int updateDeviceList();
@@ -36,8 +38,25 @@ class FindDevices {
     std::unique_ptr< ScopeDevice > takeDevice( UniqueUSBid id );
 
   private:
+    /// Cached probe result of one device on the bus, avoids re-reading the
+    /// descriptor and the port tree of unchanged devices on every scan.
+    struct DeviceProbe {
+        UniqueUSBid id;
+        libusb_device_descriptor descriptor;
+        unsigned findIteration;
+    };
+    typedef std::map< libusb_device *, DeviceProbe > ProbeCache;
+
+    /// Called by libusb when a device arrives or leaves, just flags the bus change.
+    static int LIBUSB_CALL hotplugCallback( libusb_context *context, libusb_device *device, libusb_hotplug_event event,
+                                            void *user_data );
+
     libusb_context *context; ///< The usb context used for this device
     DeviceList devices;
+    ProbeCache probeCache;
+    libusb_hotplug_callback_handle hotplugHandle = 0;
+    bool hotplugActive = false;            ///< Hotplug events registered, scan only on bus changes
+    std::atomic< bool > busChanged{ true };///< A device arrived or left since the last scan
     unsigned findIteration = 0;
     int verboseLevel = 0;
 };
@@ -2,6 +2,7 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QList>
 #include <iostream>
 
@@ -53,8 +54,9 @@ UniqueUSBid ScopeDevice::computeUSBdeviceID( libusb_device *device ) {
 }
 
 
-ScopeDevice::ScopeDevice( DSOModel *model, libusb_device *device, unsigned findIteration )
-    : model( model ), device( device ), findIteration( findIteration ), uniqueUSBdeviceID( computeUSBdeviceID( device ) ) {
+ScopeDevice::ScopeDevice( DSOModel *model, libusb_device *device, unsigned findIteration, libusb_context *context )
+    : model( model ), context( context ), device( device ), findIteration( findIteration ),
+      uniqueUSBdeviceID( computeUSBdeviceID( device ) ) {
     libusb_ref_device( device );
     libusb_get_device_descriptor( device, &descriptor );
 }
@@ -63,6 +65,11 @@ ScopeDevice::ScopeDevice( DSOModel *model, libusb_device *device, unsigned findI
 ScopeDevice::ScopeDevice() : model( new ModelDEMO ), device( nullptr ), uniqueUSBdeviceID( 0 ), realHW( false ) {}
 
 
+ScopeDevice::ScopeDevice( const QString &replayFile, double replaySpeed )
+    : model( new ModelDEMO ), device( nullptr ), uniqueUSBdeviceID( 0 ), realHW( false ), replayFile( replayFile ),
+      replaySpeed( replaySpeed ) {}
+
+
 bool ScopeDevice::connectDevice( QString &errorMessage ) {
     if ( needsFirmware() )
         return false;
@@ -181,9 +188,12 @@ int ScopeDevice::bulkTransfer( unsigned char endpoint, const unsigned char *data
 
     int errorCode = LIBUSB_ERROR_TIMEOUT;
     int transferred = 0;
-    for ( int attempt = 0; ( attempt < attempts || attempts == -1 ) && errorCode == LIBUSB_ERROR_TIMEOUT; ++attempt )
+    for ( int attempt = 0; ( attempt < attempts || attempts == -1 ) && errorCode == LIBUSB_ERROR_TIMEOUT; ++attempt ) {
+        if ( attempt ) // a timed out transfer is repeated, count the silent retry
+            ++bulkRetryCount;
         errorCode =
             libusb_bulk_transfer( handle, endpoint, const_cast< unsigned char * >( data ), int( length ), &transferred, timeout );
+    }
 
     if ( errorCode == LIBUSB_ERROR_NO_DEVICE )
         disconnectFromDevice();
@@ -194,6 +204,117 @@ int ScopeDevice::bulkTransfer( unsigned char endpoint, const unsigned char *data
 }
 
 
+/// Shared state between asyncBulkRead() and its completion callbacks.
+struct AsyncBulkContext {
+    ScopeDevice *scopeDevice = nullptr;
+    unsigned char *data = nullptr; ///< Target buffer, transfers read directly into it (zero-copy)
+    unsigned length = 0;           ///< Total number of bytes requested
+    unsigned chunkSize = 0;        ///< Size of one queued transfer for this capture
+    unsigned submitted = 0;        ///< Offset of the next chunk to queue
+    unsigned received = 0;         ///< Bytes captured so far (in-order on one bulk endpoint)
+    unsigned transfers = 0;        ///< Number of completed transfers (latency measurement)
+    unsigned active = 0;           ///< Number of transfers currently in flight
+    bool finished = false;         ///< Short packet seen or all bytes in, stop resubmitting
+    int errorCode = LIBUSB_SUCCESS;
+};
+
+
+static void LIBUSB_CALL asyncReadCallback( libusb_transfer *transfer ) {
+    AsyncBulkContext *ctx = static_cast< AsyncBulkContext * >( transfer->user_data );
+    --ctx->active;
+    if ( transfer->status != LIBUSB_TRANSFER_COMPLETED ) {
+        ctx->finished = true;
+        if ( transfer->status == LIBUSB_TRANSFER_NO_DEVICE )
+            ctx->errorCode = LIBUSB_ERROR_NO_DEVICE;
+        else if ( transfer->status == LIBUSB_TRANSFER_TIMED_OUT )
+            ctx->errorCode = LIBUSB_ERROR_TIMEOUT;
+        else
+            ctx->errorCode = LIBUSB_ERROR_IO;
+        return;
+    }
+    ctx->received += unsigned( transfer->actual_length );
+    ++ctx->transfers;
+    if ( transfer->actual_length < transfer->length || ctx->received >= ctx->length ) {
+        ctx->finished = true; // short packet = end of scope data
+        return;
+    }
+    if ( ctx->submitted < ctx->length ) { // requeue this transfer for the next chunk
+        unsigned chunk = qMin( ctx->length - ctx->submitted, ctx->chunkSize );
+        transfer->buffer = ctx->data + ctx->submitted;
+        transfer->length = int( chunk );
+        ctx->submitted += chunk;
+        if ( libusb_submit_transfer( transfer ) == LIBUSB_SUCCESS )
+            ++ctx->active;
+        else
+            ctx->finished = true;
+    }
+}
+
+
+int ScopeDevice::asyncBulkRead( unsigned char *data, unsigned length, unsigned &received, unsigned timeout ) {
+    AsyncBulkContext ctx;
+    ctx.scopeDevice = this;
+    ctx.data = data;
+    ctx.length = length;
+    ctx.chunkSize = asyncTransferSize;
+    QElapsedTimer latencyTimer;
+    latencyTimer.start();
+    libusb_transfer *transfers[ asyncTransfersInFlight ] = { nullptr };
+    for ( unsigned iii = 0; iii < asyncTransfersInFlight && ctx.submitted < length; ++iii ) {
+        transfers[ iii ] = libusb_alloc_transfer( 0 );
+        if ( !transfers[ iii ] )
+            break;
+        unsigned chunk = qMin( length - ctx.submitted, ctx.chunkSize );
+        libusb_fill_bulk_transfer( transfers[ iii ], handle, HANTEK_EP_IN, data + ctx.submitted, int( chunk ), asyncReadCallback,
+                                   &ctx, timeout );
+        ctx.submitted += chunk;
+        if ( libusb_submit_transfer( transfers[ iii ] ) == LIBUSB_SUCCESS ) {
+            ++ctx.active;
+        } else {
+            libusb_free_transfer( transfers[ iii ] );
+            transfers[ iii ] = nullptr;
+            break;
+        }
+    }
+    if ( !ctx.active ) // fall back to the synchronous path
+        return LIBUSB_ERROR_OTHER;
+    while ( ctx.active ) { // pump events until all queued transfers drained
+        struct timeval tv = { 1, 0 };
+        int errorCode = libusb_handle_events_timeout( context, &tv );
+        if ( errorCode != LIBUSB_SUCCESS && errorCode != LIBUSB_ERROR_INTERRUPTED )
+            ctx.errorCode = errorCode;
+        if ( ( ctx.finished || stopTransfer ) && ctx.active ) { // cancel the remaining queued transfers
+            for ( unsigned iii = 0; iii < asyncTransfersInFlight; ++iii )
+                if ( transfers[ iii ] )
+                    libusb_cancel_transfer( transfers[ iii ] );
+        }
+        received = ctx.received;
+    }
+    for ( unsigned iii = 0; iii < asyncTransfersInFlight; ++iii )
+        if ( transfers[ iii ] )
+            libusb_free_transfer( transfers[ iii ] );
+    received = ctx.received;
+    // Adapt the chunk size to the measured completion latency of this host controller:
+    // grow until one chunk takes about asyncTargetLatency to complete, shrink again if
+    // single transfers become so long that cancellation gets sluggish.
+    if ( ctx.errorCode == LIBUSB_SUCCESS && ctx.transfers > 1 ) {
+        qint64 chunkLatency = latencyTimer.nsecsElapsed() / 1000 / ctx.transfers; // µs per completed chunk
+        if ( chunkLatency < asyncTargetLatency / 2 && asyncTransferSize < asyncTransferSizeMax )
+            asyncTransferSize *= 2;
+        else if ( chunkLatency > asyncTargetLatency * 2 && asyncTransferSize > asyncTransferSizeMin )
+            asyncTransferSize /= 2;
+        if ( verboseLevel > 6 )
+            qDebug() << "      ScopeDevice::asyncBulkRead() chunkLatency µs" << chunkLatency << "next chunk size"
+                     << asyncTransferSize;
+    }
+    if ( ctx.errorCode == LIBUSB_ERROR_NO_DEVICE )
+        disconnectFromDevice();
+    if ( ctx.errorCode < 0 && received == 0 )
+        return ctx.errorCode;
+    return int( received );
+}
+
+
 int ScopeDevice::bulkReadMulti( unsigned char *data, unsigned length, bool captureSmallBlocks, unsigned &received, int attempts ) {
     if ( !handle || disconnected )
         return LIBUSB_ERROR_NO_DEVICE;
@@ -222,14 +343,20 @@ int ScopeDevice::bulkReadMulti( unsigned char *data, unsigned length, bool captu
             retCode = int( received );
         return retCode;
     } else {
-        // more stable if fast data is read as one big block (up to 4 MB)
+        // fast data is read with a ring of queued transfers that keeps the bus saturated
         if ( hasStopped() )
             return 0;
-        retCode = bulkTransfer( HANTEK_EP_IN, data, length, attempts, HANTEK_TIMEOUT_MULTI * length / inPacketLength );
-        if ( retCode < 0 )
-            received = 0;
-        else
-            received = unsigned( retCode );
+        received = 0;
+        retCode = asyncBulkRead( data, length, received, HANTEK_TIMEOUT_MULTI * length / inPacketLength );
+        if ( retCode == LIBUSB_ERROR_OTHER ) { // async setup failed, use one big synchronous block
+            retCode = bulkTransfer( HANTEK_EP_IN, data, length, attempts, HANTEK_TIMEOUT_MULTI * length / inPacketLength );
+            if ( retCode < 0 )
+                received = 0;
+            else
+                received = unsigned( retCode );
+        }
+        if ( verboseLevel > 6 )
+            qDebug() << "      ScopeDevice::bulkReadMulti() async received" << received;
         stopTransfer = false;
         return retCode;
     }
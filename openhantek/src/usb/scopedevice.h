@@ -12,6 +12,7 @@
 #else
 #include <libusb-1.0/libusb.h>
 #endif
+#include <atomic>
 #include <memory>
 
 #include "models/modelDEMO.h"
@@ -34,8 +35,15 @@ class ScopeDevice : public QObject {
     Q_OBJECT
 
   public:
-    explicit ScopeDevice( DSOModel *model, libusb_device *device, unsigned findIteration = 0 );
+    explicit ScopeDevice( DSOModel *model, libusb_device *device, unsigned findIteration = 0,
+                          libusb_context *context = nullptr );
     explicit ScopeDevice();
+    /// \brief Construct a replay pseudo device, sibling of the demo device: instead of
+    /// capturing, the CapturingThread serves the blocks of a recorded raw stream
+    /// (written with --recordStream) through the unchanged processing pipeline.
+    /// \param replayFile The recorded raw stream file.
+    /// \param replaySpeed Pacing multiplier, >1 = faster than realtime, 0 = flat out.
+    explicit ScopeDevice( const QString &replayFile, double replaySpeed );
     ScopeDevice( const ScopeDevice & ) = delete;
     ~ScopeDevice() override;
     bool connectDevice( QString &errorMessage );
@@ -48,6 +56,9 @@ class ScopeDevice : public QObject {
     /// \brief Distinguish between real hw or demo device
     bool isRealHW() const { return realHW; }
     bool isDemoDevice() const { return !realHW; }
+    bool isReplayDevice() const { return !realHW && !replayFile.isEmpty(); }
+    const QString &replayFileName() const { return replayFile; }
+    double replaySpeedFactor() const { return replaySpeed; }
 
     /// \brief Stop a long running (interruptible) bulk transfer
     void stopSampling() { stopTransfer = true; }
@@ -155,6 +166,12 @@ class ScopeDevice : public QObject {
      */
     inline void overwriteInPacketLength( unsigned len ) { inPacketLength = len; }
 
+    /**
+     * @return Number of timed out bulk transfers that were silently retried,
+     * monotonic since connect; see HantekDsoControl::pipelineHealth().
+     */
+    inline unsigned bulkRetries() const { return bulkRetryCount; }
+
   protected:
     int claimInterface( const libusb_interface_descriptor *interfaceDescriptor );
 
@@ -163,7 +180,8 @@ class ScopeDevice : public QObject {
 
     // Libusb specific variables
     struct libusb_device_descriptor descriptor;
-    libusb_device *device; ///< The USB handle for the oscilloscope
+    libusb_context *context = nullptr; ///< The libusb session of this device, nullptr = default context
+    libusb_device *device;             ///< The USB handle for the oscilloscope
     libusb_device_handle *handle = nullptr;
     unsigned findIteration;
     const UniqueUSBid uniqueUSBdeviceID;
@@ -182,6 +200,27 @@ class ScopeDevice : public QObject {
     int bulkTransfer( unsigned char endpoint, const unsigned char *data, unsigned int length, int attempts = HANTEK_ATTEMPTS,
                       unsigned int timeout = HANTEK_TIMEOUT );
 
+    /// \brief Asynchronous multi packet bulk read from the oscilloscope.
+    /// Keeps several transfers queued on the IN endpoint so the bus stays
+    /// saturated at the highest sample rates instead of idling between the
+    /// synchronous one-packet round trips.
+    /// \param data Buffer for the received data.
+    /// \param length The total number of bytes to read.
+    /// \param received Continuously updated number of captured bytes.
+    /// \param timeout The timeout for one queued transfer in ms.
+    /// \return Number of received bytes on success, libusb error code on error.
+    int asyncBulkRead( unsigned char *data, unsigned length, unsigned &received, unsigned timeout );
+
+    friend struct AsyncBulkContext;
+    static const unsigned asyncTransfersInFlight = 6;    ///< queued transfers, 4..8 keeps the bus busy
+    static const unsigned asyncTransferSizeMin = 4096;   ///< lower chunk limit (slow EHCI hosts)
+    static const unsigned asyncTransferSizeMax = 262144; ///< upper chunk limit (fast xHCI hosts)
+    static const unsigned asyncTargetLatency = 4000;     ///< target completion time of one chunk in µs
+    /// Chunk size of one queued transfer, adapted to the measured completion latency
+    /// of the host controller: xHCI hosts sustain much larger transfers than the
+    /// old EHCI assumption and profit from fewer submissions per block.
+    unsigned asyncTransferSize = 16384;
+
     /// \brief Bulk write to the oscilloscope.
     /// \param data Buffer for the sent/received data.
     /// \param length The length of the packet.
@@ -201,9 +240,12 @@ class ScopeDevice : public QObject {
     }
 
     bool realHW = true;
+    QString replayFile;      ///< recorded raw stream served instead of capturing, empty = demo
+    double replaySpeed = 1.0; ///< replay pacing multiplier, 0 = flat out
     bool stopTransfer = false;
     bool disconnected = true;
     QString serialNumber = "0000";
+    std::atomic< unsigned > bulkRetryCount{ 0 }; ///< timed out bulk transfers that were retried
 
   signals:
     void deviceDisconnected(); ///< The device has been disconnected
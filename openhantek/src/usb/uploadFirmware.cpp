@@ -32,12 +32,21 @@ bool UploadFirmware::startUpload( ScopeDevice *scopeDevice ) {
         return false;
     }
 
-    // Write firmware from resources to temp files
-    QFile firmwareRes( QString( ":/firmware/%1-firmware.hex" ).arg( scopeDevice->getModel()->firmwareToken ) );
-    auto temp_firmware_path = std::unique_ptr< QTemporaryFile >( QTemporaryFile::createNativeFile( firmwareRes ) );
-    if ( !temp_firmware_path )
-        return false;
-    temp_firmware_path->open();
+    // The firmware is parsed into an in-memory segment cache on the first upload,
+    // the temp file with the hex image is only needed as long as it is not cached.
+    const QByteArray firmwareName = scopeDevice->getModel()->firmwareToken.toLocal8Bit();
+    QByteArray firmwarePath;
+    std::unique_ptr< QTemporaryFile > temp_firmware_path;
+    if ( !ezusb_firmware_cached( firmwareName.constData() ) ) {
+        // Write firmware from resources to temp files
+        QFile firmwareRes( QString( ":/firmware/%1-firmware.hex" ).arg( scopeDevice->getModel()->firmwareToken ) );
+        temp_firmware_path = std::unique_ptr< QTemporaryFile >( QTemporaryFile::createNativeFile( firmwareRes ) );
+        if ( !temp_firmware_path )
+            return false;
+        temp_firmware_path->open();
+        // use local 8bit encoding (utf8 for Linux, iso-8859-x for Windows)
+        firmwarePath = temp_firmware_path->fileName().toLocal8Bit();
+    }
 
 #ifdef Q_OS_LINUX
     // Detach kernel driver, reported to lead to an error on FreeBSD, MacOSX and Windows
@@ -58,8 +67,7 @@ bool UploadFirmware::startUpload( ScopeDevice *scopeDevice ) {
     }
 
     // Write firmware into internal RAM using first stage loader built into EZ-USB hardware
-    // use local 8bit encoding (utf8 for Linux, iso-8859-x for Windows)
-    status = ezusb_load_ram( handle, temp_firmware_path->fileName().toLocal8Bit().constData(), FX_TYPE_FX2LP, 0 );
+    status = ezusb_load_ram_cached( handle, firmwareName.constData(), firmwarePath.constData(), FX_TYPE_FX2LP, 0 );
     if ( status != LIBUSB_SUCCESS ) {
         errorMessage = TR( "Writing the main firmware failed: %1" ).arg( libusb_error_name( status ) );
         libusb_release_interface( handle, 0 );
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "bufferpool.h"
+
+#include <mutex>
+
+namespace {
+
+// The free list holds the raw vectors between two uses. ~16 buffers cover the
+// pipelined stages of both channels plus math and the saved trigger trace; more
+// than that signals a consumer leak, those buffers are dropped for real.
+const size_t poolLimit = 16;
+std::mutex poolMutex;
+std::vector< std::unique_ptr< std::vector< double > > > pool;
+
+void release( std::vector< double > *buffer ) {
+    std::lock_guard< std::mutex > lock( poolMutex );
+    if ( pool.size() < poolLimit )
+        pool.push_back( std::unique_ptr< std::vector< double > >( buffer ) );
+    else
+        delete buffer;
+}
+
+} // namespace
+
+
+std::shared_ptr< std::vector< double > > BufferPool::acquire() {
+    std::vector< double > *buffer = nullptr;
+    {
+        std::lock_guard< std::mutex > lock( poolMutex );
+        if ( !pool.empty() ) {
+            buffer = pool.back().release();
+            pool.pop_back();
+        }
+    }
+    if ( buffer )
+        buffer->clear(); // keep the capacity, drop the stale content
+    else
+        buffer = new std::vector< double >;
+    return std::shared_ptr< std::vector< double > >( buffer, release );
+}
+
+
+size_t BufferPool::pooledBytes() {
+    std::lock_guard< std::mutex > lock( poolMutex );
+    size_t bytes = 0;
+    for ( const auto &buffer : pool )
+        bytes += buffer->capacity() * sizeof( double );
+    return bytes;
+}
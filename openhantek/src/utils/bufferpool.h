@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+/// \brief Recycling pool for the big per-frame sample buffers.
+/// The conversion, math, spectrum and graph stages all start a frame by unsharing
+/// their 20 k double buffers (modifiableData() / modifiableSamples()), the old
+/// buffer stays with the consumers (display, saved trigger trace) and is freed a
+/// frame later - a steady malloc/free churn of ~160 kB vectors. Buffers acquired
+/// here carry a deleter that hands the vector back to a small free list instead,
+/// so after warmup the frames rotate through the same allocations: no allocator
+/// time in the signal path and a deterministic memory footprint on long sessions.
+/// The buffers keep their capacity while pooled; the free list is bounded, excess
+/// buffers (e.g. after shrinking the channel count) are really freed.
+namespace BufferPool {
+
+/// \brief Get an empty sample buffer, recycled with its capacity when available.
+/// The buffer returns to the pool automatically when the last owner drops it.
+/// Thread safe (one short lock), usable from any pipeline stage.
+std::shared_ptr< std::vector< double > > acquire();
+
+/// \brief Allocated bytes currently parked on the free list (memory telemetry).
+/// Buffers in use are accounted by their holders, see PPresult::memoryFootprint().
+size_t pooledBytes();
+
+} // namespace BufferPool
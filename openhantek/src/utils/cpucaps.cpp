@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpucaps.h"
+
+namespace CpuCaps {
+
+namespace {
+
+struct Caps {
+    bool avx2 = false;
+    QString features;
+};
+
+// function local static: thread safe one-time probing on first use
+const Caps &probe() {
+    static const Caps caps = []() {
+        Caps detected;
+#if ( defined( __x86_64__ ) || defined( _M_X64 ) ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+        detected.features = "sse2"; // part of the x86-64 baseline
+        detected.avx2 = __builtin_cpu_supports( "avx2" );
+        if ( detected.avx2 )
+            detected.features += " avx2";
+#elif defined( __aarch64__ )
+        detected.features = "neon"; // Advanced SIMD is mandatory on AArch64
+#else
+        detected.features = "scalar"; // the compiler may still auto-vectorize
+#endif
+        return detected;
+    }();
+    return caps;
+}
+
+} // namespace
+
+void detect() { probe(); }
+
+bool hasAVX2() { return probe().avx2; }
+
+QString summary() { return probe().features; }
+
+} // namespace CpuCaps
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QString>
+
+/// \file cpucaps.h
+/// \brief Shared runtime CPU capability detection for the SIMD kernel dispatch.
+///
+/// All vector kernels live in convertsimd.cpp, compiled for the platform
+/// baseline (SSE2 on x86-64, Advanced SIMD on AArch64) with wider variants
+/// dispatched at runtime, so a single binary serves SSE2-era boxes, AVX2
+/// desktops and ARM units at full speed each. The probing lives here instead
+/// of inside the kernels, so a stage that grows its own above-baseline
+/// variant asks this one facility instead of duplicating the cpuid logic,
+/// and the startup log can report what the dispatch decided.
+namespace CpuCaps {
+
+/// Probe the CPU once; cheap and idempotent, called early in main() so the
+/// first captured block does not pay for it. The accessors below probe
+/// lazily as well, a kernel called before main() stays correct.
+void detect();
+
+/// \return true if the 256 bit AVX2 kernel variants may be used.
+bool hasAVX2();
+
+/// \return Human readable summary of the detected features ("sse2 avx2",
+/// "neon", "scalar") for the --verbose startup log.
+QString summary();
+
+} // namespace CpuCaps
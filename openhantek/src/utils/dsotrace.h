@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QDebug>
+
+/// \file dsotrace.h
+/// \brief Compile-time filtered trace macros for the per-block hot paths.
+///
+/// The cold setup and UI paths keep their plain `if ( verboseLevel > N ) qDebug()`
+/// statements; the functions that run once (or more) per captured block route
+/// their tracing through these category macros instead, so a production build
+/// compiled with -DDSO_NO_TRACE drops the branch, the string formatting and the
+/// QDebug machinery from the hot functions entirely while the familiar
+/// --verbose gating stays available in a normal build. The fixed-cost pipeline
+/// timing does not live here: FrameTrace::record() writes fixed-size records
+/// into its ring and stays always-on (see utils/frametrace.h).
+///
+/// Per-category switches: -DDSO_NO_TRACE disables all categories (as does Qt's
+/// QT_NO_DEBUG_OUTPUT), -DDSO_NO_TRACE_CONTROL etc. disable one subsystem when
+/// only that path needs a lean build.
+
+#if defined( DSO_NO_TRACE ) || defined( QT_NO_DEBUG_OUTPUT )
+#ifndef DSO_NO_TRACE_CONTROL
+#define DSO_NO_TRACE_CONTROL
+#endif
+#ifndef DSO_NO_TRACE_CAPTURE
+#define DSO_NO_TRACE_CAPTURE
+#endif
+#ifndef DSO_NO_TRACE_POST
+#define DSO_NO_TRACE_POST
+#endif
+#endif
+
+/// HantekDsoControl: state machine, conversion and sampling control.
+#ifdef DSO_NO_TRACE_CONTROL
+#define traceControl( gate, ... ) \
+    do {                          \
+    } while ( 0 )
+#else
+#define traceControl( gate, ... )   \
+    do {                            \
+        if ( Q_UNLIKELY( gate ) )   \
+            qDebug() << __VA_ARGS__; \
+    } while ( 0 )
+#endif
+
+/// CapturingThread: USB block capture and the demo generator.
+#ifdef DSO_NO_TRACE_CAPTURE
+#define traceCapture( gate, ... ) \
+    do {                          \
+    } while ( 0 )
+#else
+#define traceCapture( gate, ... )   \
+    do {                            \
+        if ( Q_UNLIKELY( gate ) )   \
+            qDebug() << __VA_ARGS__; \
+    } while ( 0 )
+#endif
+
+/// Post processing: spectrum, decoder and graph generation.
+#ifdef DSO_NO_TRACE_POST
+#define tracePost( gate, ... ) \
+    do {                       \
+    } while ( 0 )
+#else
+#define tracePost( gate, ... )      \
+    do {                            \
+        if ( Q_UNLIKELY( gate ) )   \
+            qDebug() << __VA_ARGS__; \
+    } while ( 0 )
+#endif
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "frametrace.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/// One recorded stage completion or counter sample, 32 bytes.
+struct Event {
+    uint64_t ns = 0;             ///< steady clock timestamp
+    uint64_t value = 0;          ///< sampled counter value, unused for stage events
+    unsigned tag = 0;            ///< block the stage worked on
+    bool isCounter = false;      ///< stage holds a counter track name instead
+    const char *stage = nullptr; ///< stage name literal, nullptr = slot never written
+};
+
+/// The lock-free ring. 4096 events cover several minutes of the usual 5 events per
+/// block at typical block rates; writers claim a slot with one relaxed increment
+/// and fill it without further synchronization - the dump runs after the pipeline
+/// stopped, a wrapped-over slot during capture only garbles that single old event.
+const unsigned ringSlots = 4096; // power of two, the claim index wraps cheaply
+Event ring[ ringSlots ];
+std::atomic< unsigned > ringHead{ 0 };
+
+uint64_t now() {
+    return uint64_t( std::chrono::duration_cast< std::chrono::nanoseconds >( //
+                         std::chrono::steady_clock::now().time_since_epoch() )
+                         .count() );
+}
+
+} // namespace
+
+
+void FrameTrace::record( const char *stage, unsigned tag ) {
+    Event &event = ring[ ringHead.fetch_add( 1, std::memory_order_relaxed ) % ringSlots ];
+    event.ns = now();
+    event.tag = tag;
+    event.isCounter = false;
+    event.stage = stage;
+}
+
+
+#ifdef DSO_MEM_SENTINEL
+namespace {
+
+// Leak sentinel: once a counter has been sampled warmupSamples times its maximum is
+// taken as the steady state; every later sample above it is reported (and becomes
+// the new reference, so a creeping leak warns on every step instead of flooding).
+// Each counter is sampled from one thread, the mutex only guards the registration.
+const unsigned warmupSamples = 100;
+struct Sentinel {
+    unsigned samples = 0;
+    uint64_t maxSeen = 0;
+};
+std::mutex sentinelMutex;
+std::map< const char *, Sentinel > sentinels;
+
+void checkSentinel( const char *name, uint64_t value ) {
+    sentinelMutex.lock();
+    Sentinel &sentinel = sentinels[ name ];
+    sentinelMutex.unlock(); // map nodes are stable, the entry is now owned by one thread
+    if ( sentinel.samples < warmupSamples ) {
+        ++sentinel.samples;
+        if ( value > sentinel.maxSeen )
+            sentinel.maxSeen = value;
+    } else if ( value > sentinel.maxSeen ) {
+        qWarning() << "MemSentinel:" << name << "grew to" << value << "bytes, steady state was" << sentinel.maxSeen;
+        sentinel.maxSeen = value;
+    }
+}
+
+} // namespace
+#endif // DSO_MEM_SENTINEL
+
+
+void FrameTrace::counter( const char *name, uint64_t value ) {
+    Event &event = ring[ ringHead.fetch_add( 1, std::memory_order_relaxed ) % ringSlots ];
+    event.ns = now();
+    event.value = value;
+    event.tag = 0;
+    event.isCounter = true;
+    event.stage = name;
+#ifdef DSO_MEM_SENTINEL
+    checkSentinel( name, value );
+#endif
+}
+
+
+bool FrameTrace::dump( const QString &fileName ) {
+    // snapshot the written slots and order the events of each block by time
+    std::map< unsigned, std::vector< Event > > blocks;       // tag -> its stage events
+    std::map< const char *, std::vector< Event > > counters; // track name -> its samples
+    uint64_t firstNs = UINT64_MAX;
+    const unsigned written = std::min( ringHead.load(), ringSlots );
+    for ( unsigned slot = 0; slot < written; ++slot ) {
+        if ( !ring[ slot ].stage )
+            continue;
+        if ( ring[ slot ].isCounter )
+            counters[ ring[ slot ].stage ].push_back( ring[ slot ] );
+        else
+            blocks[ ring[ slot ].tag ].push_back( ring[ slot ] );
+        firstNs = std::min( firstNs, ring[ slot ].ns );
+    }
+    if ( blocks.empty() && counters.empty() )
+        return false;
+    const auto byTime = []( const Event &a, const Event &b ) { return a.ns < b.ns; };
+    for ( auto &block : blocks )
+        std::sort( block.second.begin(), block.second.end(), byTime );
+    for ( auto &track : counters )
+        std::sort( track.second.begin(), track.second.end(), byTime );
+
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) )
+        return false;
+    // Chrome trace-event format, one async "block" slice per tag from the first to
+    // the last recorded stage plus one instant marker per stage; the id ties the
+    // events of one block together, timestamps are µs relative to the first event.
+    QString separator = "[\n";
+    for ( auto &block : blocks ) {
+        const std::vector< Event > &events = block.second;
+        auto line = [ & ]( const char *ph, const char *name, uint64_t ns ) {
+            file.write( separator.toLatin1() );
+            separator = ",\n";
+            file.write( QString( "{\"name\":\"%1\",\"cat\":\"pipeline\",\"ph\":\"%2\",\"id\":%3,"
+                                 "\"ts\":%4,\"pid\":1,\"tid\":1,\"args\":{\"tag\":%3}}" )
+                            .arg( name )
+                            .arg( ph )
+                            .arg( block.first )
+                            .arg( double( ns - firstNs ) / 1e3, 0, 'f', 3 )
+                            .toLatin1() );
+        };
+        line( "b", "block", events.front().ns );
+        for ( const Event &event : events )
+            line( "n", event.stage, event.ns );
+        line( "e", "block", events.back().ns );
+    }
+    // one counter track per sampled name, e.g. the mem.* telemetry of the subsystems
+    for ( auto &track : counters ) {
+        for ( const Event &event : track.second ) {
+            file.write( separator.toLatin1() );
+            separator = ",\n";
+            file.write( QString( "{\"name\":\"%1\",\"cat\":\"memory\",\"ph\":\"C\",\"ts\":%2,\"pid\":1,"
+                                 "\"args\":{\"bytes\":%3}}" )
+                            .arg( track.first )
+                            .arg( double( event.ns - firstNs ) / 1e3, 0, 'f', 3 )
+                            .arg( event.value )
+                            .toLatin1() );
+        }
+    }
+    file.write( "\n]\n" );
+    return true;
+}
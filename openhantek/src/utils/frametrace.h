@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QString>
+
+/// \brief Always-on latency trace of the capture -> display pipeline.
+/// Every pipeline stage drops one timestamped event per sample block into a small
+/// lock-free ring: the USB block handover (xferSamples), the end of the raw sample
+/// conversion, the end of every post processor and the paintGL completion. One
+/// record costs a clock read plus a relaxed atomic increment, so the trace stays
+/// enabled in every build - unlike the compile-time TIMESTAMPDEBUG printf debugging.
+/// The ring can be dumped as Chrome trace-event JSON (open with chrome://tracing
+/// or https://ui.perfetto.dev), one async track slice per block with one marker
+/// per stage, which makes the end to end trigger-to-display latency measurable.
+namespace FrameTrace {
+
+/// \brief Record one pipeline stage completion for a block.
+/// Wait-free, safe from any thread; the oldest events are overwritten when the
+/// ring wraps. \a stage must be a string literal (it is stored by pointer).
+/// \param stage The completed stage, e.g. "capture", "convert", "paint".
+/// \param tag The block tag, links the events of one block across the stages.
+void record( const char *stage, unsigned tag );
+
+/// \brief Record one sampled counter value, e.g. the per subsystem memory telemetry.
+/// Wait-free like record(); the dump emits one Chrome counter track per \a name, so
+/// a slowly growing subsystem shows up as a rising staircase next to the pipeline
+/// slices. A build with -DDSO_MEM_SENTINEL additionally warns whenever a counter
+/// exceeds its previous maximum after the warmup phase - the leak sentinel that
+/// keeps the pooled buffers (BufferPool, result pool, capture pool, GL vertex
+/// rings) from silently regressing into per-frame allocations.
+/// \param name The counter track, a string literal (stored by pointer).
+/// \param value The sampled value, bytes for the memory telemetry.
+void counter( const char *name, uint64_t value );
+
+/// \brief Write the recorded events as a Chrome trace-event JSON file.
+/// Meant to be called after the pipeline has stopped (application exit); a dump
+/// while the producers are running may contain single torn events.
+/// \param fileName The target file, typically from the --traceFile option.
+/// \return true on success.
+bool dump( const QString &fileName );
+
+} // namespace FrameTrace
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+/// \file hotpath.h
+/// \brief Hot/cold split attributes for the per-block processing path.
+///
+/// The per-block functions (raw conversion, trigger scan, SIMD kernels) sit
+/// behind virtual and signal boundaries the optimizer cannot see through, so
+/// without profile feedback they get average code placement. DSO_HOT marks
+/// them for aggressive optimization and shared hot text placement; DSO_COLD
+/// keeps rare setup and error reporting out of line so it neither bloats a
+/// hot caller nor pollutes its instruction cache footprint. A PGO build
+/// (see the PGO cache variable in the top level CMakeLists.txt) supersedes
+/// these hints with measured counts; the attributes are the maintained
+/// baseline for the plain release build.
+///
+/// Branch likelihood inside the hot functions uses Qt's Q_LIKELY/Q_UNLIKELY,
+/// which is the pre-C++20 spelling of [[likely]] that this code base targets.
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define DSO_HOT __attribute__( ( hot ) )
+#define DSO_COLD __attribute__( ( cold, noinline ) )
+#else
+#define DSO_HOT
+#define DSO_COLD
+#endif
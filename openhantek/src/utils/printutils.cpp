@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <cmath>
+#include <cstdio>
+#include <functional>
 
 #include <QApplication>
 #include <QLocale>
@@ -8,7 +10,7 @@
 
 #include "utils/printutils.h"
 
-QString valueToString( double value, Unit unit, int precision ) {
+static QString formatValue( double value, Unit unit, int precision ) {
     char format = ( precision < 0 ) ? 'g' : 'f';
 
     switch ( unit ) {
@@ -153,6 +155,121 @@ QString valueToString( double value, Unit unit, int precision ) {
 }
 
 
+/// One slot of the per thread formatting memo, preallocated text included.
+namespace {
+struct FormatMemo {
+    double value = 0.0;
+    Unit unit = UNIT_NONE;
+    int precision = 0;
+    bool used = false;
+    QString text;
+};
+} // namespace
+
+QString valueToString( double value, Unit unit, int precision ) {
+    // The measurement, marker and cursor labels format the same (value, unit,
+    // precision) triple frame after frame; a small direct mapped memo returns
+    // the ready-made string and skips the float formatting, translation lookup
+    // and allocation for unchanged inputs.
+    const size_t memoSlots = 32;
+    static thread_local FormatMemo memo[ memoSlots ];
+    size_t slot = ( std::hash< double >()( value ) ^ ( size_t( unit ) << 3 ) ^ size_t( precision + 8 ) ) % memoSlots;
+    FormatMemo &entry = memo[ slot ];
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfloat-equal"
+#endif
+    if ( entry.used && entry.value == value && entry.unit == unit && entry.precision == precision )
+        return entry.text;
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    entry.value = value;
+    entry.unit = unit;
+    entry.precision = precision;
+    entry.used = true;
+    entry.text = formatValue( value, unit, precision );
+    return entry.text;
+}
+
+
+/// One scaling step of the non-allocating formatter. A step applies while the
+/// absolute value is below its limit; the last step of a table has limit 0 and
+/// catches everything else. The entry with scale 1 carries the plain base unit.
+namespace {
+struct PrefixStep {
+    double limit;       ///< upper bound for this step, 0 terminates the table
+    double scale;       ///< multiplier that converts the value into this prefix
+    const char *suffix; ///< prefix and unit, UTF-8, untranslated
+};
+
+const PrefixStep voltSteps[] = { { 1e-3, 1e6, " µV" }, { 1.0, 1e3, " mV" }, { 0.0, 1.0, " V" } };
+const PrefixStep voltSquareSteps[] = { { 1e-3, 1e6, " µV²" }, { 1.0, 1e3, " mV²" }, { 0.0, 1.0, " V²" } };
+const PrefixStep wattSteps[] = { { 1e-3, 1e6, " µW" }, { 1.0, 1e3, " mW" }, { 0.0, 1.0, " W" } };
+const PrefixStep decibelSteps[] = { { 0.0, 1.0, " dB" } };
+const PrefixStep secondSteps[] = { { 1e-9, 1e12, " ps" }, { 1e-6, 1e9, " ns" },        { 1e-3, 1e6, " µs" },
+                                   { 1.0, 1e3, " ms" },   { 60.0, 1.0, " s" },         { 3600.0, 1.0 / 60, " min" },
+                                   { 0.0, 1.0 / 3600, " h" } };
+const PrefixStep hertzSteps[] = { { 1e3, 1.0, " Hz" }, { 1e6, 1e-3, " kHz" }, { 1e9, 1e-6, " MHz" }, { 0.0, 1e-9, " GHz" } };
+const PrefixStep sampleSteps[] = { { 1e3, 1.0, " S" }, { 1e6, 1e-3, " kS" }, { 1e9, 1e-6, " MS" }, { 0.0, 1e-9, " GS" } };
+
+const PrefixStep *prefixSteps( Unit unit ) {
+    switch ( unit ) {
+    case UNIT_VOLTS:
+        return voltSteps;
+    case UNIT_VOLTSQUARE:
+        return voltSquareSteps;
+    case UNIT_WATTS:
+        return wattSteps;
+    case UNIT_DECIBEL:
+        return decibelSteps;
+    case UNIT_SECONDS:
+        return secondSteps;
+    case UNIT_HERTZ:
+        return hertzSteps;
+    case UNIT_SAMPLES:
+        return sampleSteps;
+    default:
+        return nullptr; // UNIT_NONE and UNIT_COUNT need no prefix table
+    }
+}
+} // namespace
+
+int valueToString( char *buffer, size_t bufferSize, double value, Unit unit, int precision ) {
+    if ( !buffer || !bufferSize )
+        return 0;
+    if ( unit == UNIT_COUNT )
+        return snprintf( buffer, bufferSize, "%d", int( round( value ) ) );
+    const char *suffix = "";
+    double scaled = value;
+    if ( const PrefixStep *step = prefixSteps( unit ) ) {
+        if ( bool( fabs( value ) ) ) {
+            while ( bool( step->limit ) && fabs( value ) >= step->limit )
+                ++step;
+            scaled = value * step->scale;
+            suffix = step->suffix;
+        } else { // zero is printed in the plain base unit, like the QString path
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfloat-equal"
+#endif
+            while ( step->scale != 1.0 )
+                ++step;
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+            return snprintf( buffer, bufferSize, "0%s", step->suffix );
+        }
+    }
+    if ( precision < 0 )
+        return snprintf( buffer, bufferSize, "%g%s", scaled, suffix );
+    int digits = precision;
+    if ( bool( fabs( scaled ) ) ) // significant digits -> decimals after the point
+        digits = qBound( 0, precision - 1 - int( floor( log10( fabs( scaled ) ) ) ), precision );
+    return snprintf( buffer, bufferSize, "%.*f%s", digits, scaled, suffix );
+}
+
+
 double stringToValue( const QString &text, Unit unit, bool *ok ) {
     // Check if the text is empty
     int totalSize = text.size();
@@ -162,9 +279,10 @@ double stringToValue( const QString &text, Unit unit, bool *ok ) {
         return 0.0;
     }
 
-    // Split value and unit apart
+    // Split value and unit apart. The default locale never changes at runtime,
+    // constructing it once saves the lookup on every spin box keystroke.
     int valueSize = 0;
-    QLocale locale;
+    static const QLocale locale;
     bool decimalFound = false;
     bool exponentFound = false;
     if ( text[ valueSize ] == locale.negativeSign() )
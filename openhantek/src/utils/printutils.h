@@ -19,6 +19,18 @@ enum Unit { UNIT_NONE, UNIT_VOLTS, UNIT_DECIBEL, UNIT_SECONDS, UNIT_HERTZ, UNIT_
 /// \return String with the value and unit.
 QString valueToString( double value, Unit unit, int precision = -1 );
 
+/// \brief Non-allocating counterpart of valueToString for hot paths.
+/// Writes value, metric prefix and unit into the caller supplied buffer using
+/// lookup tables and snprintf. The unit suffix is UTF-8 but not translated -
+/// user visible labels must keep the QString overload above.
+/// \param buffer The caller supplied output buffer.
+/// \param bufferSize The size of the buffer, the output is truncated to fit.
+/// \param value The value in prefixless units.
+/// \param unit The unit for the value.
+/// \param precision Significant digits, 0 for integer, -1 for auto.
+/// \return The number of characters written (excluding the terminating zero).
+int valueToString( char *buffer, size_t bufferSize, double value, Unit unit, int precision = -1 );
+
 /// \brief Converts string containing value and (prefix+)unit to double
 /// (Counterpart to valueToString).
 /// \param text The text containing the value and its unit.
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "samplecodec.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace SampleCodec {
+
+// One byte format marker at the start of every stream.
+static const unsigned char FormatRaw = 0;         // verbatim copy, count bytes follow
+static const unsigned char FormatDeltaNibble = 1; // zigzag deltas, nibble packed with byte escapes
+
+// Deltas are seeded with the ADC mid level, the first sample of each channel is
+// usually close to it and starts the stream with a small delta.
+static const unsigned char deltaSeed = 0x80;
+
+
+size_t compressBound( size_t count ) {
+    // marker + full nibble stream + every delta escaped; the raw fallback keeps the
+    // final result at count + 1, the bound only sizes the encoder scratch space
+    return 2 + ( count + 1 ) / 2 + count;
+}
+
+
+size_t compress( const unsigned char *in, size_t count, unsigned stride, unsigned char *out ) {
+    if ( !count ) {
+        out[ 0 ] = FormatRaw;
+        return 1;
+    }
+    if ( !stride )
+        stride = 1;
+    unsigned char *nibbles = out + 1;
+    const size_t nibbleBytes = ( count + 1 ) / 2; // fixed size, escapes go behind it
+    unsigned char *exception = nibbles + nibbleBytes;
+    unsigned char *const exceptionStart = exception;
+    for ( size_t index = 0; index < count; ++index ) {
+        const unsigned char previous = index >= stride ? in[ index - stride ] : deltaSeed;
+        const int delta = int8_t( in[ index ] - previous );               // mod 256, reconstructs exactly
+        const unsigned zigzag = uint8_t( ( delta << 1 ) ^ ( delta >> 7 ) ); // 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+        unsigned nibble = zigzag;
+        if ( zigzag >= 15 ) { // too big for a nibble, escape into the byte stream
+            nibble = 15;
+            *exception++ = uint8_t( zigzag );
+        }
+        if ( index & 1 )
+            nibbles[ index >> 1 ] |= uint8_t( nibble << 4 );
+        else
+            nibbles[ index >> 1 ] = uint8_t( nibble );
+    }
+    const size_t size = 1 + nibbleBytes + size_t( exception - exceptionStart );
+    if ( size > count ) { // incompressible (e.g. pure noise): store verbatim
+        out[ 0 ] = FormatRaw;
+        memmove( out + 1, in, count );
+        return count + 1;
+    }
+    out[ 0 ] = FormatDeltaNibble;
+    return size;
+}
+
+
+bool decompress( const unsigned char *in, size_t inSize, unsigned char *out, size_t count, unsigned stride ) {
+    if ( !inSize )
+        return false;
+    if ( !stride )
+        stride = 1;
+    if ( FormatRaw == in[ 0 ] ) {
+        if ( inSize != count + 1 )
+            return false;
+        memcpy( out, in + 1, count );
+        return true;
+    }
+    if ( FormatDeltaNibble != in[ 0 ] )
+        return false;
+    const size_t nibbleBytes = ( count + 1 ) / 2;
+    if ( inSize < 1 + nibbleBytes )
+        return false;
+    const unsigned char *nibbles = in + 1;
+    const unsigned char *exception = nibbles + nibbleBytes;
+    const unsigned char *const streamEnd = in + inSize;
+    for ( size_t index = 0; index < count; ++index ) {
+        unsigned zigzag = ( index & 1 ) ? nibbles[ index >> 1 ] >> 4 : nibbles[ index >> 1 ] & 0x0F;
+        if ( 15 == zigzag ) { // escaped delta
+            if ( exception >= streamEnd )
+                return false; // truncated stream
+            zigzag = *exception++;
+        }
+        const int delta = int( zigzag >> 1 ) ^ -int( zigzag & 1 );
+        const unsigned char previous = index >= stride ? out[ index - stride ] : deltaSeed;
+        out[ index ] = uint8_t( unsigned( previous ) + unsigned( delta ) );
+    }
+    return true;
+}
+
+} // namespace SampleCodec
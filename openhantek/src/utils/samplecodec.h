@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+
+/// \brief Fast lossless codec for 8 bit raw sample blocks.
+/// Consecutive samples of one channel differ by a few ADC counts most of the time,
+/// so each byte is stored as the delta to its stride-predecessor (stride = number
+/// of interleaved channels), zigzag mapped and packed into one nibble; the rare
+/// large deltas escape into a byte stream behind the nibbles. Typical scope signals
+/// shrink to 1/2 .. 1/3 of their raw size, and both directions run at several
+/// hundred MB/s on one core - far above the 60 MB/s peak capture rate, so the
+/// codec never throttles the capture path. White noise that does not compress
+/// falls back to a verbatim copy (one byte overhead), the codec never expands
+/// a block beyond compressBound().
+/// Used by the raw capture history ring and the continuous binary recorder; the
+/// caller keeps the uncompressed byte count and the stride, the stream itself
+/// only carries a one byte format marker.
+namespace SampleCodec {
+
+/// \brief Worst case compressed size for a block of \a count bytes.
+/// Size the output buffer of compress() with this bound.
+size_t compressBound( size_t count );
+
+/// \brief Compress one raw sample block.
+/// \param in The raw 8 bit samples, channel interleaved when stride == 2.
+/// \param count Number of input bytes.
+/// \param stride Number of interleaved channels, each byte is delta coded
+///        against its predecessor of the same channel.
+/// \param out The output buffer, at least compressBound( count ) bytes.
+/// \return The compressed size in bytes, at most count + 1.
+size_t compress( const unsigned char *in, size_t count, unsigned stride, unsigned char *out );
+
+/// \brief Decompress one block compressed by compress().
+/// \param in The compressed stream.
+/// \param inSize The compressed size returned by compress().
+/// \param out The output buffer for exactly \a count raw bytes.
+/// \param count The uncompressed byte count (kept by the caller).
+/// \param stride The stride that was used for compression.
+/// \return false if the stream is truncated or has an unknown format marker.
+bool decompress( const unsigned char *in, size_t inSize, unsigned char *out, size_t count, unsigned stride );
+
+} // namespace SampleCodec
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cmath>
+
+#include <QPainter>
+
+#include "colorpreview.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// class ColorPreview
+/// \brief Initializes the preview with the scheme that is edited.
+/// \param colorValues The initial color values shown by the preview.
+/// \param parent The parent widget.
+ColorPreview::ColorPreview( const DsoSettingsColorValues &colorValues, QWidget *parent )
+    : QWidget( parent ), colors( colorValues ) {
+    setMinimumSize( 160, 100 );
+}
+
+
+/// \brief The preferred size, about the shape of the real scope screen.
+QSize ColorPreview::sizeHint() const { return QSize( 240, 150 ); }
+
+
+void ColorPreview::setAxes( QColor color ) {
+    colors.axes = color;
+    update();
+}
+
+
+void ColorPreview::setBackground( QColor color ) {
+    colors.background = color;
+    update();
+}
+
+
+void ColorPreview::setBorder( QColor color ) {
+    colors.border = color;
+    update();
+}
+
+
+void ColorPreview::setGrid( QColor color ) {
+    colors.grid = color;
+    update();
+}
+
+
+void ColorPreview::setMarkers( QColor color ) {
+    colors.markers = color;
+    update();
+}
+
+
+void ColorPreview::setText( QColor color ) {
+    colors.text = color;
+    update();
+}
+
+
+void ColorPreview::setVoltage( ChannelID channel, QColor color ) {
+    if ( channel < colors.voltage.size() ) {
+        colors.voltage[ channel ] = color;
+        update();
+    }
+}
+
+
+void ColorPreview::setSpectrum( ChannelID channel, QColor color ) {
+    if ( channel < colors.spectrum.size() ) {
+        colors.spectrum[ channel ] = color;
+        update();
+    }
+}
+
+
+/// \brief Paint the demo screen: grid, axes, border, markers, one voltage and
+/// one spectrum trace per channel and a text sample, all in the candidate colors.
+void ColorPreview::paintEvent( QPaintEvent * ) {
+    QPainter painter( this );
+    painter.setRenderHint( QPainter::Antialiasing );
+    QRectF area = QRectF( rect() ).adjusted( 1, 1, -1, -1 );
+    painter.fillRect( area, colors.background );
+
+    const int hDivs = 10; // scaled down DIVS_TIME x DIVS_VOLTAGE raster
+    const int vDivs = 6;
+    const double divX = area.width() / hDivs;
+    const double divY = area.height() / vDivs;
+
+    // Grid dots at the div crossings
+    painter.setPen( QPen( colors.grid, 2 ) );
+    for ( int x = 1; x < hDivs; ++x )
+        for ( int y = 1; y < vDivs; ++y )
+            painter.drawPoint( QPointF( area.left() + x * divX, area.top() + y * divY ) );
+
+    // Axes through the center
+    painter.setPen( colors.axes );
+    painter.drawLine( QPointF( area.left(), area.center().y() ), QPointF( area.right(), area.center().y() ) );
+    painter.drawLine( QPointF( area.center().x(), area.top() ), QPointF( area.center().x(), area.bottom() ) );
+
+    // Two measurement markers
+    painter.setPen( colors.markers );
+    for ( double marker : { 0.35, 0.65 } ) {
+        double x = area.left() + marker * area.width();
+        painter.drawLine( QPointF( x, area.top() ), QPointF( x, area.bottom() ) );
+    }
+
+    // One period of a sine as voltage trace, shifted per channel
+    for ( ChannelID channel = 0; channel < colors.voltage.size(); ++channel ) {
+        painter.setPen( QPen( colors.voltage[ channel ], 1.5 ) );
+        QPolygonF trace;
+        for ( int step = 0; step <= 100; ++step ) {
+            double x = area.left() + step * area.width() / 100;
+            double y = area.center().y() - divY * ( 1.5 - channel ) * sin( step * 2 * M_PI / 100 );
+            trace << QPointF( x, y );
+        }
+        painter.drawPolyline( trace );
+    }
+
+    // A decaying peak in the lower half as spectrum trace
+    for ( ChannelID channel = 0; channel < colors.spectrum.size(); ++channel ) {
+        painter.setPen( QPen( colors.spectrum[ channel ], 1.5 ) );
+        QPolygonF trace;
+        double base = area.bottom() - ( channel + 1 ) * divY / 4;
+        for ( int step = 0; step <= 100; ++step ) {
+            double x = area.left() + step * area.width() / 100;
+            double peak = exp( -0.5 * pow( ( step - 20.0 * ( channel + 1 ) ) / 2, 2 ) );
+            trace << QPointF( x, base - divY * peak );
+        }
+        painter.drawPolyline( trace );
+    }
+
+    // Text sample in the top left corner
+    painter.setPen( colors.text );
+    painter.drawText( area.adjusted( 4, 2, -4, -2 ), Qt::AlignTop | Qt::AlignLeft, tr( "1 ms/div" ) );
+
+    // Border on top of everything at the edge
+    painter.setPen( colors.border );
+    painter.setBrush( Qt::NoBrush );
+    painter.drawRect( area );
+}
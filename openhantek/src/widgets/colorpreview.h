@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <QColor>
+#include <QWidget>
+
+#include "hantekprotocol/types.h"
+#include "viewsettings.h"
+
+/// \brief A static preview of a color scheme.
+/// Paints a demo grid and trace with the candidate colors inside the config
+/// dialog, so color tweaks can be judged without touching the live scope
+/// pipeline - the edited scheme reaches DsoWidget and GlScope only once,
+/// when the dialog applies its settings.
+class ColorPreview : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit ColorPreview( const DsoSettingsColorValues &colorValues, QWidget *parent = nullptr );
+
+    QSize sizeHint() const override;
+
+  public slots:
+    void setAxes( QColor color );
+    void setBackground( QColor color );
+    void setBorder( QColor color );
+    void setGrid( QColor color );
+    void setMarkers( QColor color );
+    void setText( QColor color );
+    void setVoltage( ChannelID channel, QColor color );
+    void setSpectrum( ChannelID channel, QColor color );
+
+  protected:
+    void paintEvent( QPaintEvent *event ) override;
+
+  private:
+    DsoSettingsColorValues colors; ///< The candidate scheme shown by the preview
+};
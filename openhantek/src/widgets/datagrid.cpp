@@ -127,22 +127,32 @@ void DataGrid::updateInfo( unsigned index, bool visible, const QString &strOnOff
     if ( index >= items.size() )
         return;
     CursorInfo &info = items.at( index );
-    info.selector->setEnabled( visible );
-    info.onOff->setEnabled( visible );
+    // Only touch the widgets whose content really changed - this runs per row
+    // at cursor move rate and unneeded setText calls relayout the whole grid.
+    if ( info.selector->isEnabled() != visible ) {
+        info.selector->setEnabled( visible );
+        info.onOff->setEnabled( visible );
+    }
     if ( visible ) {
-        if ( toolTipsVisible ) {
+        if ( toolTipsVisible && info.selector->toolTip().isEmpty() ) {
             info.selector->setToolTip( tr( "Select the active cursor" ) );
             info.onOff->setToolTip( tr( "Show cursor and measurement" ) );
         }
-        info.onOff->setText( strOnOff );
-        info.deltaXLabel->setText( strX );
-        info.deltaYLabel->setText( strY );
+        if ( info.onOff->text() != strOnOff )
+            info.onOff->setText( strOnOff );
+        if ( info.deltaXLabel->text() != strX )
+            info.deltaXLabel->setText( strX );
+        if ( info.deltaYLabel->text() != strY )
+            info.deltaYLabel->setText( strY );
     } else {
         info.selector->setToolTip( QString() );
         info.onOff->setToolTip( QString() );
-        info.onOff->setText( QString() );
-        info.deltaXLabel->setText( QString() );
-        info.deltaYLabel->setText( QString() );
+        if ( !info.onOff->text().isEmpty() )
+            info.onOff->setText( QString() );
+        if ( !info.deltaXLabel->text().isEmpty() )
+            info.deltaXLabel->setText( QString() );
+        if ( !info.deltaYLabel->text().isEmpty() )
+            info.deltaYLabel->setText( QString() );
     }
 }
 
@@ -134,6 +134,7 @@ void LevelSlider::setColor( unsigned index, QColor color ) {
         return;
 
     slider[ int( index ) ]->color = color;
+    slider[ int( index ) ]->cacheDirty = true;
     repaint();
 }
 
@@ -156,6 +157,7 @@ int LevelSlider::setText( int index, const QString &text ) {
         return -1;
 
     slider[ index ]->text = text;
+    slider[ index ]->cacheDirty = true;
     calculateWidth();
 
     return index;
@@ -291,6 +293,9 @@ int LevelSlider::setDirection( Qt::ArrowType direction ) {
 
     _direction = direction;
 
+    for ( LevelSliderParameters *parameters : slider )
+        parameters->cacheDirty = true;
+
     if ( _direction == Qt::RightArrow || _direction == Qt::LeftArrow ) {
         _preMargin = fontMetrics().lineSpacing();
         _postMargin = ( needleWidth );
@@ -369,6 +374,10 @@ void LevelSlider::mouseReleaseEvent( QMouseEvent *event ) {
 }
 
 /// \brief Paint the widget.
+/// The rendering of each needle and label is cached in a pixmap that is only
+/// refreshed on size, color, text or direction changes - a drag just blits the
+/// cache at the new position instead of redoing the QPainter vector and text
+/// work for every mouse move.
 /// \param event The paint event that should be handled.
 void LevelSlider::paintEvent( QPaintEvent *event ) {
     QPainter painter( this );
@@ -388,6 +397,12 @@ void LevelSlider::paintEvent( QPaintEvent *event ) {
         alignment = Qt::AlignRight | Qt::AlignBottom;
     }
 
+    if ( isEnabled() != cachedEnabled ) { // the needle fill follows the enabled state
+        cachedEnabled = isEnabled();
+        for ( LevelSliderParameters *parameters : slider )
+            parameters->cacheDirty = true;
+    }
+
     QList< LevelSliderParameters * >::iterator sliderIt = slider.end();
     while ( sliderIt != slider.begin() ) {
         --sliderIt;
@@ -395,76 +410,97 @@ void LevelSlider::paintEvent( QPaintEvent *event ) {
         if ( !( *sliderIt )->visible )
             continue;
 
-        painter.setPen( ( *sliderIt )->color );
-
-        if ( ( *sliderIt )->text.isEmpty() ) {
-            QVector< QPoint > needlePoints;
-            QRect &needleRect = ( *sliderIt )->rect;
-            const int peak = 1;                          // distance from slider to the tip of the needle
-            const int shoulder = peak + needleWidth / 2; // distance from slider to the straight part of the needle
-
-            switch ( _direction ) {
-            case Qt::LeftArrow:
-                needlePoints << QPoint( needleRect.left() + shoulder, needleRect.top() )
-                             << QPoint( needleRect.left() + peak, needleRect.top() + needleWidth / 2 )
-                             << QPoint( needleRect.left() + shoulder, needleRect.bottom() )
-                             << QPoint( needleRect.right(), needleRect.bottom() ) << QPoint( needleRect.right(), needleRect.top() );
-                break;
-            case Qt::UpArrow:
-                needlePoints << QPoint( needleRect.left(), needleRect.top() + shoulder )
-                             << QPoint( needleRect.left() + needleWidth / 2, needleRect.top() + peak )
-                             << QPoint( needleRect.right(), needleRect.top() + shoulder )
-                             << QPoint( needleRect.right(), needleRect.bottom() )
-                             << QPoint( needleRect.left(), needleRect.bottom() );
-                break;
-            case Qt::DownArrow:
-                needlePoints << QPoint( needleRect.left(), needleRect.bottom() - shoulder )
-                             << QPoint( needleRect.left() + needleWidth / 2, needleRect.bottom() - peak )
-                             << QPoint( needleRect.right(), needleRect.bottom() - shoulder )
-                             << QPoint( needleRect.right(), needleRect.top() ) << QPoint( needleRect.left(), needleRect.top() );
-                break;
-            case Qt::RightArrow:
-                needlePoints << QPoint( needleRect.right() - shoulder, needleRect.top() )
-                             << QPoint( needleRect.right() - peak, needleRect.top() + needleWidth / 2 )
-                             << QPoint( needleRect.right() - shoulder, needleRect.bottom() )
-                             << QPoint( needleRect.left(), needleRect.bottom() ) << QPoint( needleRect.left(), needleRect.top() );
-                break;
-            default:
-                break;
-            }
+        if ( ( *sliderIt )->cacheDirty || ( *sliderIt )->cache.size() != ( *sliderIt )->rect.size() * devicePixelRatio() )
+            renderCache( *sliderIt, alignment );
+        painter.drawPixmap( ( *sliderIt )->rect.topLeft(), ( *sliderIt )->cache );
+    }
 
-            painter.setBrush( QBrush( ( *sliderIt )->color, isEnabled() ? Qt::SolidPattern : Qt::NoBrush ) );
-            painter.drawPolygon( QPolygon( needlePoints ) );
-            painter.setBrush( Qt::NoBrush );
-        } else {
-            // Get rect for text and draw needle
-            QRect textRect = ( *sliderIt )->rect;
-            if ( _direction == Qt::UpArrow || _direction == Qt::DownArrow ) {
-                textRect.setRight( textRect.right() - 1 );
-                if ( _direction == Qt::UpArrow ) {
-                    textRect.setTop( textRect.top() + 1 );
-                    painter.drawLine( ( *sliderIt )->rect.right(), 0, ( *sliderIt )->rect.right(), 7 );
-                } else {
-                    textRect.setBottom( textRect.bottom() - 1 );
-                    painter.drawLine( ( *sliderIt )->rect.right(), sliderWidth - 8, ( *sliderIt )->rect.right(), sliderWidth - 1 );
-                }
+    event->accept();
+}
+
+/// \brief Render one slider into its cache pixmap.
+/// Drawing happens in widget coordinates, shifted so that the slider rect
+/// starts at the pixmap origin - the geometry matches the uncached rendering,
+/// only the blit position changes when the slider moves.
+/// \param parameters The slider whose cache should be rendered.
+/// \param alignment The text alignment for the current direction.
+void LevelSlider::renderCache( LevelSliderParameters *parameters, Qt::Alignment alignment ) {
+    int ratio = devicePixelRatio();
+    parameters->cache = QPixmap( parameters->rect.size() * ratio );
+    parameters->cache.setDevicePixelRatio( ratio );
+    parameters->cache.fill( Qt::transparent );
+    parameters->cacheDirty = false;
+
+    QPainter painter( &parameters->cache );
+    painter.translate( -parameters->rect.topLeft() );
+    painter.setPen( parameters->color );
+
+
+    if ( parameters->text.isEmpty() ) {
+        QVector< QPoint > needlePoints;
+        QRect &needleRect = parameters->rect;
+        const int peak = 1;                          // distance from slider to the tip of the needle
+        const int shoulder = peak + needleWidth / 2; // distance from slider to the straight part of the needle
+
+        switch ( _direction ) {
+        case Qt::LeftArrow:
+            needlePoints << QPoint( needleRect.left() + shoulder, needleRect.top() )
+                         << QPoint( needleRect.left() + peak, needleRect.top() + needleWidth / 2 )
+                         << QPoint( needleRect.left() + shoulder, needleRect.bottom() )
+                         << QPoint( needleRect.right(), needleRect.bottom() ) << QPoint( needleRect.right(), needleRect.top() );
+            break;
+        case Qt::UpArrow:
+            needlePoints << QPoint( needleRect.left(), needleRect.top() + shoulder )
+                         << QPoint( needleRect.left() + needleWidth / 2, needleRect.top() + peak )
+                         << QPoint( needleRect.right(), needleRect.top() + shoulder )
+                         << QPoint( needleRect.right(), needleRect.bottom() )
+                         << QPoint( needleRect.left(), needleRect.bottom() );
+            break;
+        case Qt::DownArrow:
+            needlePoints << QPoint( needleRect.left(), needleRect.bottom() - shoulder )
+                         << QPoint( needleRect.left() + needleWidth / 2, needleRect.bottom() - peak )
+                         << QPoint( needleRect.right(), needleRect.bottom() - shoulder )
+                         << QPoint( needleRect.right(), needleRect.top() ) << QPoint( needleRect.left(), needleRect.top() );
+            break;
+        case Qt::RightArrow:
+            needlePoints << QPoint( needleRect.right() - shoulder, needleRect.top() )
+                         << QPoint( needleRect.right() - peak, needleRect.top() + needleWidth / 2 )
+                         << QPoint( needleRect.right() - shoulder, needleRect.bottom() )
+                         << QPoint( needleRect.left(), needleRect.bottom() ) << QPoint( needleRect.left(), needleRect.top() );
+            break;
+        default:
+            break;
+        }
+
+        painter.setBrush( QBrush( parameters->color, isEnabled() ? Qt::SolidPattern : Qt::NoBrush ) );
+        painter.drawPolygon( QPolygon( needlePoints ) );
+        painter.setBrush( Qt::NoBrush );
+    } else {
+        // Get rect for text and draw needle
+        QRect textRect = parameters->rect;
+        if ( _direction == Qt::UpArrow || _direction == Qt::DownArrow ) {
+            textRect.setRight( textRect.right() - 1 );
+            if ( _direction == Qt::UpArrow ) {
+                textRect.setTop( textRect.top() + 1 );
+                painter.drawLine( parameters->rect.right(), 0, parameters->rect.right(), 7 );
             } else {
                 textRect.setBottom( textRect.bottom() - 1 );
-                if ( _direction == Qt::LeftArrow ) {
-                    textRect.setLeft( textRect.left() + 1 );
-                    painter.drawLine( 0, ( *sliderIt )->rect.bottom(), 7, ( *sliderIt )->rect.bottom() );
-                } else {
-                    textRect.setRight( textRect.right() - 1 );
-                    painter.drawLine( sliderWidth - 8, ( *sliderIt )->rect.bottom(), sliderWidth - 1,
-                                      ( *sliderIt )->rect.bottom() );
-                }
+                painter.drawLine( parameters->rect.right(), sliderWidth - 8, parameters->rect.right(), sliderWidth - 1 );
+            }
+        } else {
+            textRect.setBottom( textRect.bottom() - 1 );
+            if ( _direction == Qt::LeftArrow ) {
+                textRect.setLeft( textRect.left() + 1 );
+                painter.drawLine( 0, parameters->rect.bottom(), 7, parameters->rect.bottom() );
+            } else {
+                textRect.setRight( textRect.right() - 1 );
+                painter.drawLine( sliderWidth - 8, parameters->rect.bottom(), sliderWidth - 1,
+                                  parameters->rect.bottom() );
             }
-            // Draw text
-            painter.drawText( textRect, int( alignment ), ( *sliderIt )->text );
         }
+        // Draw text
+        painter.drawText( textRect, int( alignment ), parameters->text );
     }
-
-    event->accept();
 }
 
 /// \brief Resize the widget and adapt the slider positions.
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <QPixmap>
 #include <QWidget>
 
 class QColor;
@@ -18,7 +19,9 @@ struct LevelSliderParameters {
     double value;   ///< The current value of the slider
 
     // Needed for moving and drawing
-    QRect rect; ///< The area where the slider is drawn
+    QRect rect;             ///< The area where the slider is drawn
+    QPixmap cache;          ///< The rendered needle or label, blitted on repaint
+    bool cacheDirty = true; ///< Re-render the cache before the next blit
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -72,6 +75,7 @@ class LevelSlider : public QWidget {
     QRect calculateRect( int sliderId );
     int calculateWidth();
     void fixValue( int index );
+    void renderCache( LevelSliderParameters *parameters, Qt::Alignment alignment );
 
     QList< LevelSliderParameters * > slider; ///< The parameters for each slider
     int pressedSlider;                       ///< The currently pressed (moved) slider
@@ -82,6 +86,7 @@ class LevelSlider : public QWidget {
     Qt::ArrowType _direction; ///< The direction the sliders point to
     int _preMargin;           ///< The margin before the minimum slider position
     int _postMargin;          ///< The margin after the maximum slider position
+    bool cachedEnabled = true; ///< enabled state the caches were rendered with
 
   signals:
     void valueChanged( int index, double value, bool pressed = false,
@@ -21,6 +21,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 
@@ -53,15 +54,20 @@ SiSpinBox::~SiSpinBox() {}
 QValidator::State SiSpinBox::validate( QString &input, int &pos ) const {
     Q_UNUSED( pos )
 
+    // Qt validates the same text several times per keystroke or wheel step,
+    // return the memoized verdict for a repeated input.
+    if ( input == validatedInput )
+        return validatedState;
+
     bool ok;
     double value = stringToValue( input, unit, &ok );
 
-    if ( !ok )
-        return QValidator::Invalid;
-
-    if ( input == textFromValue( value ) )
-        return QValidator::Acceptable;
-    return QValidator::Intermediate;
+    QValidator::State state = QValidator::Invalid;
+    if ( ok )
+        state = ( input == textFromValue( value ) ) ? QValidator::Acceptable : QValidator::Intermediate;
+    validatedInput = input;
+    validatedState = state;
+    return state;
 }
 
 /// \brief Parse value from input text.
@@ -93,35 +99,31 @@ void SiSpinBox::stepBy( int doStep ) {
     }
     int stepsCount = steps.size() - 1;
     if ( 0 == mode ) { // this is a regular 1/2/5.. spinbox
-        double stepsSpan = steps.last() / steps.first();
-        double val = 0;
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfloat-equal"
+#endif
+        if ( ladder.isEmpty() || ladderMin != minimum() || ladderMax != maximum() )
+            updateStepLadder(); // limits changed, precompute the reachable steps once
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
         if ( !steppedTo ) { // No step done directly before this one,
-                            // ... so we need to check where we are
-            // Get how often the steps have to be fully ran through
-            int stepsFully = int( floor( log( value() / steps.first() ) / log( stepsSpan ) ) );
-            // And now the remaining multiple
-            double stepMultiple = value() / pow( stepsSpan, stepsFully );
-            // Now get the neighbours of the current value from our steps list
-            int remainingSteps = 0;
-            for ( ; remainingSteps <= stepsCount; ++remainingSteps ) {
-                if ( steps[ remainingSteps ] > stepMultiple )
-                    break;
-            }
-            if ( remainingSteps > 0 ) // Shouldn't happen, but double may have rounding errors
-                --remainingSteps;
-            stepId = stepsFully * stepsCount + remainingSteps;
-            // We need to do one step less down if we are in between two of them since
-            // our step is lower than the value
-            if ( doStep < 0 && steps[ remainingSteps ] < stepMultiple )
+                            // ... so we need to find the value in the ladder
+            stepId = int( std::upper_bound( ladder.cbegin(), ladder.cend(), value() * ( 1 + 1e-9 ) ) - ladder.cbegin() ) - 1;
+            stepId = qMax( 0, stepId ); // stepId is the step at or below the value
+            // We need to do one step less down if we are in between two of them
+            // since our step is lower than the value
+            if ( doStep < 0 && ladder[ stepId ] < value() * ( 1 - 1e-9 ) )
                 ++stepId;
         }
-        int subStep = doStep / abs( doStep );
+        // Walk the ladder and stop at the first value on or beyond a limit,
+        // setValue clamps that one - the same behavior as the old step math
+        int subStep = doStep > 0 ? 1 : -1;
+        double val = 0;
         for ( int i = 0; i != doStep; i += subStep ) {
-            stepId += subStep;
-            int stepsId = stepId % stepsCount;
-            if ( stepsId < 0 )
-                stepsId += stepsCount;
-            val = pow( stepsSpan, floor( double( stepId ) / stepsCount ) ) * steps[ stepsId ];
+            stepId = qBound( 0, stepId + subStep, int( ladder.size() ) - 1 );
+            val = ladder[ stepId ];
             if ( val <= minimum() || val >= maximum() )
                 break;
         }
@@ -146,17 +148,54 @@ bool SiSpinBox::setUnit( Unit newUnit ) {
         return false;
 
     unit = newUnit;
+    validatedInput.clear(); // the memoized verdict depends on the unit
     return true;
 }
 
 /// \brief Set the unit postfix for this spin box.
 /// \param postfix the string shown after the unit in the spin box.
-void SiSpinBox::setUnitPostfix( const QString &postfix ) { unitPostfix = postfix; }
+void SiSpinBox::setUnitPostfix( const QString &postfix ) {
+    unitPostfix = postfix;
+    validatedInput.clear(); // the memoized verdict depends on the postfix
+}
 
 /// \brief Set the steps the spin box will take.
 /// \param newSteps The steps, will be extended with the ratio from the start after
 /// the last element.
-void SiSpinBox::setSteps( const QList< double > &newSteps ) { steps = newSteps; }
+void SiSpinBox::setSteps( const QList< double > &newSteps ) {
+    steps = newSteps;
+    ladder.clear(); // rebuilt from the new steps on the next stepBy
+}
+
+/// \brief Precompute all reachable step values between the current limits.
+/// The 1/2/5.. step list repeats scaled by its span (e.g. a factor of 10) in
+/// both directions; this expands it into one ascending table, with one entry
+/// beyond each limit so that stepping onto a limit works. stepBy() then only
+/// looks up neighbours instead of redoing the log/pow math per wheel event.
+void SiSpinBox::updateStepLadder() {
+    ladder.clear();
+    double stepsSpan = steps.last() / steps.first();
+    int stepsCount = steps.size() - 1;
+    double lowest = qMax( minimum(), 1e-15 ); // the limits are always positive
+    // start one full span below the minimum so the boundary entries exist
+    int decade = int( floor( log( lowest / steps.first() ) / log( stepsSpan ) ) ) - 1;
+    for ( bool beyond = false; !beyond; ++decade ) {
+        double base = pow( stepsSpan, decade );
+        for ( int index = 0; index < stepsCount; ++index ) {
+            double val = base * steps[ index ];
+            ladder.append( val );
+            if ( val >= maximum() ) {
+                beyond = true;
+                break;
+            }
+        }
+    }
+    // keep a single entry below the minimum, the expansion overshoots by up to a span
+    while ( ladder.size() > 1 && ladder[ 1 ] < minimum() )
+        ladder.removeFirst();
+    ladderMin = minimum();
+    ladderMax = maximum();
+}
 
 /// \brief Set the mode.
 /// \param mode The mode, the value 0 will have fixed interval, otherwise the
@@ -32,6 +32,7 @@ class SiSpinBox : public QDoubleSpinBox {
   private:
     void init();
     void setBackground();
+    void updateStepLadder();
 
     Unit unit;             ///< The SI unit used for this spin box
     QString unitPostfix;   ///< Shown after the unit
@@ -41,6 +42,15 @@ class SiSpinBox : public QDoubleSpinBox {
     bool steppedTo; ///< true, if the current value was reached using stepBy
     int stepId;     ///< The index of the last step reached using stepBy
 
+    QList< double > ladder; ///< All step values between the limits, ascending
+    double ladderMin = 0.0; ///< The minimum the ladder was built for
+    double ladderMax = 0.0; ///< The maximum the ladder was built for
+
+    // Each keystroke and wheel event validates the same text several times,
+    // the verdict of the last validation is memoized.
+    mutable QString validatedInput;                                     ///< last validated text
+    mutable QValidator::State validatedState = QValidator::Invalid;     ///< its verdict
+
   signals:
 
   private slots: